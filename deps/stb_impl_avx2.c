@@ -0,0 +1,22 @@
+// Second build of stb_image_resize2 with its AVX2 code paths enabled (this file is compiled with /arch:AVX2, while stb_impl.c sticks to the SSE2 baseline)
+// All stbir_* symbols get internal linkage via 'STB_IMAGE_RESIZE_STATIC', so both builds can be linked together, with only the wrapper functions below exported
+// Which build to use is decided at runtime based on CPU support (see 'resize_image_data' in source\runtime.cpp)
+
+#define STB_IMAGE_RESIZE_IMPLEMENTATION
+#define STB_IMAGE_RESIZE_STATIC
+#define STBIR_AVX2
+
+#include "stb_image_resize2.h"
+
+int stbir_build_samplers_with_splits_avx2(STBIR_RESIZE *resize, int try_splits)
+{
+	return stbir_build_samplers_with_splits(resize, try_splits);
+}
+int stbir_resize_extended_split_avx2(STBIR_RESIZE *resize, int split_start, int split_count)
+{
+	return stbir_resize_extended_split(resize, split_start, split_count);
+}
+void stbir_free_samplers_avx2(STBIR_RESIZE *resize)
+{
+	stbir_free_samplers(resize);
+}
@@ -4,9 +4,14 @@
  */
 
 #include <reshade.hpp>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstring>
+#include <initializer_list>
 #include <sstream>
 #include <shared_mutex>
+#include <thread>
 #include <unordered_set>
 
 using namespace reshade::api;
@@ -337,6 +342,315 @@ namespace
 			return "unknown";
 		}
 	}
+
+	// Command identifiers of the binary trace records (text representation is produced offline by the trace thread, so the hot path never has to format strings)
+	enum class trace_op : uint32_t
+	{
+		frame_begin,
+		frame_end,
+		present,
+		barrier,
+		begin_render_pass,
+		end_render_pass,
+		bind_render_targets_and_depth_stencil,
+		bind_pipeline,
+		bind_pipeline_state,
+		bind_viewports,
+		bind_scissor_rects,
+		push_constants,
+		push_descriptors,
+		bind_descriptor_table,
+		bind_index_buffer,
+		bind_vertex_buffer,
+		draw,
+		draw_indexed,
+		dispatch,
+		dispatch_mesh,
+		dispatch_rays,
+		draw_or_dispatch_indirect,
+		copy_resource,
+		copy_buffer_region,
+		copy_buffer_to_texture,
+		copy_texture_region,
+		copy_texture_to_buffer,
+		resolve_texture_region,
+		clear_depth_stencil_view,
+		clear_render_target_view,
+		clear_unordered_access_view_uint,
+		clear_unordered_access_view_float,
+		copy_acceleration_structure,
+		build_acceleration_structure,
+		generate_mipmaps,
+		begin_query,
+		end_query,
+		copy_query_heap_results,
+	};
+
+	// Fixed-size binary trace record (large enough for the widest command, which is dispatch_rays with 18 arguments)
+	struct trace_record
+	{
+		std::atomic<uint64_t> sequence;
+		uint64_t timestamp;
+		trace_op op;
+		uint32_t arg_count;
+		uint64_t args[18];
+	};
+
+	constexpr uint64_t TRACE_RING_SIZE = 64 * 1024; // Has to be a power of two
+	trace_record s_trace_ring[TRACE_RING_SIZE];
+	std::atomic<uint64_t> s_trace_enqueue_pos = 0;
+	uint64_t s_trace_dequeue_pos = 0; // Only touched by the trace thread
+	std::atomic<uint64_t> s_trace_dropped = 0;
+	std::atomic<bool> s_trace_thread_stop = false;
+	std::thread s_trace_thread;
+	std::chrono::high_resolution_clock::time_point s_capture_start_time;
+
+	inline uint64_t float_bits(float value)
+	{
+		uint32_t bits = 0;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+	inline float bits_to_float(uint64_t value)
+	{
+		float result = 0.0f;
+		const uint32_t bits = static_cast<uint32_t>(value);
+		std::memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	// Appends a fixed-size record to the trace ring buffer (multiple producers, single consumer, bounded, records are dropped rather than blocking when the trace thread cannot keep up)
+	void trace(trace_op op, const uint64_t *args, uint32_t arg_count)
+	{
+		assert(arg_count <= std::size(s_trace_ring[0].args));
+
+		trace_record *record;
+		uint64_t pos = s_trace_enqueue_pos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			record = &s_trace_ring[pos & (TRACE_RING_SIZE - 1)];
+			const uint64_t sequence = record->sequence.load(std::memory_order_acquire);
+			const int64_t dif = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+
+			if (dif == 0)
+			{
+				if (s_trace_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (dif < 0)
+			{
+				// The ring buffer is full, count the dropped record instead of stalling the application
+				s_trace_dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			else
+			{
+				pos = s_trace_enqueue_pos.load(std::memory_order_relaxed);
+			}
+		}
+
+		record->timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - s_capture_start_time).count();
+		record->op = op;
+		record->arg_count = arg_count;
+		std::memcpy(record->args, args, arg_count * sizeof(uint64_t));
+
+		record->sequence.store(pos + 1, std::memory_order_release);
+	}
+	void trace(trace_op op, std::initializer_list<uint64_t> args)
+	{
+		trace(op, args.begin(), static_cast<uint32_t>(args.size()));
+	}
+
+	// Converts a single binary trace record back to text (this runs on the trace thread, off the application's critical path)
+	void format_trace_record(const trace_record &record)
+	{
+		const uint64_t *const args = record.args;
+
+		std::stringstream s;
+		switch (record.op)
+		{
+		case trace_op::frame_begin:
+			reshade::log::message(reshade::log::level::info, "--- Frame ---");
+			return;
+		case trace_op::frame_end:
+			reshade::log::message(reshade::log::level::info, "--- End Frame ---");
+			return;
+		case trace_op::present:
+			s << "present()";
+			break;
+		case trace_op::barrier:
+			s << "barrier(" << (void *)args[0] << ", " << to_string(static_cast<resource_usage>(args[1])) << ", " << to_string(static_cast<resource_usage>(args[2])) << ")";
+			break;
+		case trace_op::begin_render_pass:
+			s << "begin_render_pass(" << args[0] << ", { ";
+			for (uint64_t i = 0; i < args[0]; ++i)
+				s << (void *)args[1 + i] << ", ";
+			s << " }, " << (void *)args[1 + args[0]] << ")";
+			break;
+		case trace_op::end_render_pass:
+			s << "end_render_pass()";
+			break;
+		case trace_op::bind_render_targets_and_depth_stencil:
+			s << "bind_render_targets_and_depth_stencil(" << args[0] << ", { ";
+			for (uint64_t i = 0; i < args[0]; ++i)
+				s << (void *)args[1 + i] << ", ";
+			s << " }, " << (void *)args[1 + args[0]] << ")";
+			break;
+		case trace_op::bind_pipeline:
+			s << "bind_pipeline(" << to_string(static_cast<pipeline_stage>(args[0])) << ", " << (void *)args[1] << ")";
+			break;
+		case trace_op::bind_pipeline_state:
+			s << "bind_pipeline_state(" << to_string(static_cast<dynamic_state>(args[0])) << ", " << static_cast<uint32_t>(args[1]) << ")";
+			break;
+		case trace_op::bind_viewports:
+			s << "bind_viewports(" << args[0] << ", " << args[1] << ", { ... })";
+			break;
+		case trace_op::bind_scissor_rects:
+			s << "bind_scissor_rects(" << args[0] << ", " << args[1] << ", { ... })";
+			break;
+		case trace_op::push_constants:
+			s << "push_constants(" << to_string(static_cast<shader_stage>(args[0])) << ", " << (void *)args[1] << ", " << args[2] << ", " << args[3] << ", " << args[4] << ", { ";
+			for (uint32_t i = 5; i < record.arg_count; ++i)
+				s << std::hex << static_cast<uint32_t>(args[i]) << std::dec << ", ";
+			if (record.arg_count - 5 < args[4])
+				s << "..., ";
+			s << " })";
+			break;
+		case trace_op::push_descriptors:
+			s << "push_descriptors(" << to_string(static_cast<shader_stage>(args[0])) << ", " << (void *)args[1] << ", " << args[2] << ", { " << to_string(static_cast<descriptor_type>(args[3])) << ", " << args[4] << ", " << args[5] << " })";
+			break;
+		case trace_op::bind_descriptor_table:
+			s << "bind_descriptor_table(" << to_string(static_cast<shader_stage>(args[0])) << ", " << (void *)args[1] << ", " << args[2] << ", " << (void *)args[3] << ")";
+			break;
+		case trace_op::bind_index_buffer:
+			s << "bind_index_buffer(" << (void *)args[0] << ", " << args[1] << ", " << args[2] << ")";
+			break;
+		case trace_op::bind_vertex_buffer:
+			s << "bind_vertex_buffer(" << args[0] << ", " << (void *)args[1] << ", " << args[2] << ", " << args[3] << ")";
+			break;
+		case trace_op::draw:
+			s << "draw(" << args[0] << ", " << args[1] << ", " << args[2] << ", " << args[3] << ")";
+			break;
+		case trace_op::draw_indexed:
+			s << "draw_indexed(" << args[0] << ", " << args[1] << ", " << args[2] << ", " << static_cast<int32_t>(args[3]) << ", " << args[4] << ")";
+			break;
+		case trace_op::dispatch:
+			s << "dispatch(" << args[0] << ", " << args[1] << ", " << args[2] << ")";
+			break;
+		case trace_op::dispatch_mesh:
+			s << "dispatch_mesh(" << args[0] << ", " << args[1] << ", " << args[2] << ")";
+			break;
+		case trace_op::dispatch_rays:
+			s << "dispatch_rays(" << (void *)args[0] << ", " << args[1] << ", " << args[2] << ", " << (void *)args[3] << ", " << args[4] << ", " << args[5] << ", " << args[6] << ", " << (void *)args[7] << ", " << args[8] << ", " << args[9] << ", " << args[10] << ", " << (void *)args[11] << ", " << args[12] << ", " << args[13] << ", " << args[14] << ", " << args[15] << ", " << args[16] << ", " << args[17] << ")";
+			break;
+		case trace_op::draw_or_dispatch_indirect:
+			switch (static_cast<indirect_command>(args[0]))
+			{
+			case indirect_command::unknown:
+				s << "draw_or_dispatch_indirect(";
+				break;
+			case indirect_command::draw:
+				s << "draw_indirect(";
+				break;
+			case indirect_command::draw_indexed:
+				s << "draw_indexed_indirect(";
+				break;
+			case indirect_command::dispatch:
+				s << "dispatch_indirect(";
+				break;
+			case indirect_command::dispatch_mesh:
+				s << "dispatch_mesh_indirect(";
+				break;
+			case indirect_command::dispatch_rays:
+				s << "dispatch_rays_indirect(";
+				break;
+			}
+			s << (void *)args[1] << ", " << args[2] << ", " << args[3] << ", " << args[4] << ")";
+			break;
+		case trace_op::copy_resource:
+			s << "copy_resource(" << (void *)args[0] << ", " << (void *)args[1] << ")";
+			break;
+		case trace_op::copy_buffer_region:
+			s << "copy_buffer_region(" << (void *)args[0] << ", " << args[1] << ", " << (void *)args[2] << ", " << args[3] << ", " << args[4] << ")";
+			break;
+		case trace_op::copy_buffer_to_texture:
+			s << "copy_buffer_to_texture(" << (void *)args[0] << ", " << args[1] << ", " << args[2] << ", " << args[3] << ", " << (void *)args[4] << ", " << args[5] << ")";
+			break;
+		case trace_op::copy_texture_region:
+			s << "copy_texture_region(" << (void *)args[0] << ", " << args[1] << ", " << (void *)args[2] << ", " << args[3] << ", " << static_cast<uint32_t>(args[4]) << ")";
+			break;
+		case trace_op::copy_texture_to_buffer:
+			s << "copy_texture_to_buffer(" << (void *)args[0] << ", " << args[1] << ", " << (void *)args[2] << ", " << args[3] << ", " << args[4] << ", " << args[5] << ")";
+			break;
+		case trace_op::resolve_texture_region:
+			s << "resolve_texture_region(" << (void *)args[0] << ", " << args[1] << ", { ... }, " << (void *)args[2] << ", " << args[3] << ", " << static_cast<int32_t>(args[4]) << ", " << static_cast<int32_t>(args[5]) << ", " << static_cast<int32_t>(args[6]) << ", " << static_cast<uint32_t>(args[7]) << ")";
+			break;
+		case trace_op::clear_depth_stencil_view:
+			s << "clear_depth_stencil_view(" << (void *)args[0] << ", " << bits_to_float(args[1]) << ", " << args[2] << ")";
+			break;
+		case trace_op::clear_render_target_view:
+			s << "clear_render_target_view(" << (void *)args[0] << ", { " << bits_to_float(args[1]) << ", " << bits_to_float(args[2]) << ", " << bits_to_float(args[3]) << ", " << bits_to_float(args[4]) << " })";
+			break;
+		case trace_op::clear_unordered_access_view_uint:
+			s << "clear_unordered_access_view_uint(" << (void *)args[0] << ", { " << static_cast<uint32_t>(args[1]) << ", " << static_cast<uint32_t>(args[2]) << ", " << static_cast<uint32_t>(args[3]) << ", " << static_cast<uint32_t>(args[4]) << " })";
+			break;
+		case trace_op::clear_unordered_access_view_float:
+			s << "clear_unordered_access_view_float(" << (void *)args[0] << ", { " << bits_to_float(args[1]) << ", " << bits_to_float(args[2]) << ", " << bits_to_float(args[3]) << ", " << bits_to_float(args[4]) << " })";
+			break;
+		case trace_op::copy_acceleration_structure:
+			s << "copy_acceleration_structure(" << (void *)args[0] << ", " << (void *)args[1] << ", " << to_string(static_cast<acceleration_structure_copy_mode>(args[2])) << ")";
+			break;
+		case trace_op::build_acceleration_structure:
+			s << "build_acceleration_structure(" << to_string(static_cast<acceleration_structure_type>(args[0])) << ", " << std::hex << static_cast<uint32_t>(args[1]) << std::dec << ", " << args[2] << ", { ... }, " << (void *)args[3] << ", " << args[4] << ", " << (void *)args[5] << ", " << (void *)args[6] << ", " << to_string(static_cast<acceleration_structure_build_mode>(args[7])) << ")";
+			break;
+		case trace_op::generate_mipmaps:
+			s << "generate_mipmaps(" << (void *)args[0] << ")";
+			break;
+		case trace_op::begin_query:
+			s << "begin_query(" << (void *)args[0] << ", " << to_string(static_cast<query_type>(args[1])) << ", " << args[2] << ")";
+			break;
+		case trace_op::end_query:
+			s << "end_query(" << (void *)args[0] << ", " << to_string(static_cast<query_type>(args[1])) << ", " << args[2] << ")";
+			break;
+		case trace_op::copy_query_heap_results:
+			s << "copy_query_heap_results(" << (void *)args[0] << ", " << to_string(static_cast<query_type>(args[1])) << ", " << args[2] << ", " << args[3] << ", " << (void *)args[4] << ", " << args[5] << ", " << args[6] << ")";
+			break;
+		}
+
+		std::stringstream line;
+		line << "[+" << record.timestamp << " us] " << s.str();
+		reshade::log::message(reshade::log::level::info, line.str().c_str());
+	}
+
+	// Drains the ring buffer and converts records to text until told to stop and no records are left
+	void trace_thread_proc()
+	{
+		for (;;)
+		{
+			trace_record &record = s_trace_ring[s_trace_dequeue_pos & (TRACE_RING_SIZE - 1)];
+			if (record.sequence.load(std::memory_order_acquire) == s_trace_dequeue_pos + 1)
+			{
+				format_trace_record(record);
+
+				// Mark the slot free for the producers one lap ahead
+				record.sequence.store(s_trace_dequeue_pos + TRACE_RING_SIZE, std::memory_order_release);
+				s_trace_dequeue_pos++;
+				continue;
+			}
+
+			if (s_trace_thread_stop.load(std::memory_order_relaxed))
+				break;
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		if (const uint64_t dropped = s_trace_dropped.exchange(0, std::memory_order_relaxed))
+		{
+			std::stringstream s;
+			s << "Trace ring buffer overflowed, dropped " << dropped << " records!";
+			reshade::log::message(reshade::log::level::warning, s.str().c_str());
+		}
+	}
 }
 
 static void on_init_swapchain(swapchain *swapchain)
@@ -437,11 +751,7 @@ static void on_barrier(command_list *, uint32_t num_resources, const resource *r
 #endif
 
 	for (uint32_t i = 0; i < num_resources; ++i)
-	{
-		std::stringstream s;
-		s << "barrier(" << (void *)resources[i].handle << ", " << to_string(old_states[i]) << ", " << to_string(new_states[i]) << ")";
-		reshade::log::message(reshade::log::level::info, s.str().c_str());
-	}
+		trace(trace_op::barrier, { resources[i].handle, static_cast<uint64_t>(old_states[i]), static_cast<uint64_t>(new_states[i]) });
 }
 
 static void on_begin_render_pass(command_list *, uint32_t count, const render_pass_render_target_desc *rts, const render_pass_depth_stencil_desc *ds)
@@ -449,23 +759,21 @@ static void on_begin_render_pass(command_list *, uint32_t count, const render_pa
 	if (!s_do_capture)
 		return;
 
-	std::stringstream s;
-	s << "begin_render_pass(" << count << ", { ";
+	assert(count <= 8);
+
+	uint64_t args[10] = { count };
 	for (uint32_t i = 0; i < count; ++i)
-		s << (void *)rts[i].view.handle << ", ";
-	s << " }, " << (ds != nullptr ? (void *)ds->view.handle : 0) << ")";
+		args[1 + i] = rts[i].view.handle;
+	args[1 + count] = (ds != nullptr ? ds->view.handle : 0);
 
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::begin_render_pass, args, 2 + count);
 }
 static void on_end_render_pass(command_list *)
 {
 	if (!s_do_capture)
 		return;
 
-	std::stringstream s;
-	s << "end_render_pass()";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::end_render_pass, {});
 }
 static void on_bind_render_targets_and_depth_stencil(command_list *, uint32_t count, const resource_view *rtvs, resource_view dsv)
 {
@@ -481,13 +789,14 @@ static void on_bind_render_targets_and_depth_stencil(command_list *, uint32_t co
 	}
 #endif
 
-	std::stringstream s;
-	s << "bind_render_targets_and_depth_stencil(" << count << ", { ";
+	assert(count <= 8);
+
+	uint64_t args[10] = { count };
 	for (uint32_t i = 0; i < count; ++i)
-		s << (void *)rtvs[i].handle << ", ";
-	s << " }, " << (void *)dsv.handle << ")";
+		args[1 + i] = rtvs[i].handle;
+	args[1 + count] = dsv.handle;
 
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::bind_render_targets_and_depth_stencil, args, 2 + count);
 }
 
 static void on_bind_pipeline(command_list *, pipeline_stage type, pipeline pipeline)
@@ -502,10 +811,7 @@ static void on_bind_pipeline(command_list *, pipeline_stage type, pipeline pipel
 	}
 #endif
 
-	std::stringstream s;
-	s << "bind_pipeline(" << to_string(type) << ", " << (void *)pipeline.handle << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::bind_pipeline, { static_cast<uint64_t>(type), pipeline.handle });
 }
 static void on_bind_pipeline_states(command_list *, uint32_t count, const dynamic_state *states, const uint32_t *values)
 {
@@ -513,44 +819,34 @@ static void on_bind_pipeline_states(command_list *, uint32_t count, const dynami
 		return;
 
 	for (uint32_t i = 0; i < count; ++i)
-	{
-		std::stringstream s;
-		s << "bind_pipeline_state(" << to_string(states[i]) << ", " << values[i] << ")";
-		reshade::log::message(reshade::log::level::info, s.str().c_str());
-	}
+		trace(trace_op::bind_pipeline_state, { static_cast<uint64_t>(states[i]), values[i] });
 }
 static void on_bind_viewports(command_list *, uint32_t first, uint32_t count, const viewport *viewports)
 {
 	if (!s_do_capture)
 		return;
 
-	std::stringstream s;
-	s << "bind_viewports(" << first << ", " << count << ", { ... })";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::bind_viewports, { first, count });
 }
 static void on_bind_scissor_rects(command_list *, uint32_t first, uint32_t count, const rect *rects)
 {
 	if (!s_do_capture)
 		return;
 
-	std::stringstream s;
-	s << "bind_scissor_rects(" << first << ", " << count << ", { ... })";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::bind_scissor_rects, { first, count });
 }
 static void on_push_constants(command_list *, shader_stage stages, pipeline_layout layout, uint32_t param_index, uint32_t first, uint32_t count, const void *values)
 {
 	if (!s_do_capture)
 		return;
 
-	std::stringstream s;
-	s << "push_constants(" << to_string(stages) << ", " << (void *)layout.handle << ", " << param_index << ", " << first << ", " << count << ", { ";
-	for (uint32_t i = 0; i < count; ++i)
-		s << std::hex << static_cast<const uint32_t *>(values)[i] << std::dec << ", ";
-	s << " })";
+	// Only the first few constants fit a fixed-size record, the rest is elided in the converted text
+	uint64_t args[18] = { static_cast<uint64_t>(stages), layout.handle, param_index, first, count };
+	const uint32_t stored_count = count < 13 ? count : 13;
+	for (uint32_t i = 0; i < stored_count; ++i)
+		args[5 + i] = static_cast<const uint32_t *>(values)[i];
 
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::push_constants, args, 5 + stored_count);
 }
 static void on_push_descriptors(command_list *, shader_stage stages, pipeline_layout layout, uint32_t param_index, const descriptor_table_update &update)
 {
@@ -586,10 +882,7 @@ static void on_push_descriptors(command_list *, shader_stage stages, pipeline_la
 	}
 #endif
 
-	std::stringstream s;
-	s << "push_descriptors(" << to_string(stages) << ", " << (void *)layout.handle << ", " << param_index << ", { " << to_string(update.type) << ", " << update.binding << ", " << update.count << " })";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::push_descriptors, { static_cast<uint64_t>(stages), layout.handle, param_index, static_cast<uint64_t>(update.type), update.binding, update.count });
 }
 static void on_bind_descriptor_tables(command_list *, shader_stage stages, pipeline_layout layout, uint32_t first, uint32_t count, const descriptor_table *tables)
 {
@@ -597,11 +890,7 @@ static void on_bind_descriptor_tables(command_list *, shader_stage stages, pipel
 		return;
 
 	for (uint32_t i = 0; i < count; ++i)
-	{
-		std::stringstream s;
-		s << "bind_descriptor_table(" << to_string(stages) << ", " << (void *)layout.handle << ", " << (first + i) << ", " << (void *)tables[i].handle << ")";
-		reshade::log::message(reshade::log::level::info, s.str().c_str());
-	}
+		trace(trace_op::bind_descriptor_table, { static_cast<uint64_t>(stages), layout.handle, first + i, tables[i].handle });
 }
 static void on_bind_index_buffer(command_list *, resource buffer, uint64_t offset, uint32_t index_size)
 {
@@ -615,10 +904,7 @@ static void on_bind_index_buffer(command_list *, resource buffer, uint64_t offse
 	}
 #endif
 
-	std::stringstream s;
-	s << "bind_index_buffer(" << (void *)buffer.handle << ", " << offset << ", " << index_size << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::bind_index_buffer, { buffer.handle, offset, index_size });
 }
 static void on_bind_vertex_buffers(command_list *, uint32_t first, uint32_t count, const resource *buffers, const uint64_t *offsets, const uint32_t *strides)
 {
@@ -634,11 +920,7 @@ static void on_bind_vertex_buffers(command_list *, uint32_t first, uint32_t coun
 #endif
 
 	for (uint32_t i = 0; i < count; ++i)
-	{
-		std::stringstream s;
-		s << "bind_vertex_buffer(" << (first + i) << ", " << (void *)buffers[i].handle << ", " << (offsets != nullptr ? offsets[i] : 0) << ", " << (strides != nullptr ? strides[i] : 0) << ")";
-		reshade::log::message(reshade::log::level::info, s.str().c_str());
-	}
+		trace(trace_op::bind_vertex_buffer, { first + i, buffers[i].handle, offsets != nullptr ? offsets[i] : 0, strides != nullptr ? strides[i] : 0 });
 }
 
 static bool on_draw(command_list *, uint32_t vertices, uint32_t instances, uint32_t first_vertex, uint32_t first_instance)
@@ -646,10 +928,7 @@ static bool on_draw(command_list *, uint32_t vertices, uint32_t instances, uint3
 	if (!s_do_capture)
 		return false;
 
-	std::stringstream s;
-	s << "draw(" << vertices << ", " << instances << ", " << first_vertex << ", " << first_instance << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::draw, { vertices, instances, first_vertex, first_instance });
 
 	return false;
 }
@@ -658,10 +937,7 @@ static bool on_draw_indexed(command_list *, uint32_t indices, uint32_t instances
 	if (!s_do_capture)
 		return false;
 
-	std::stringstream s;
-	s << "draw_indexed(" << indices << ", " << instances << ", " << first_index << ", " << vertex_offset << ", " << first_instance << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::draw_indexed, { indices, instances, first_index, static_cast<uint64_t>(static_cast<uint32_t>(vertex_offset)), first_instance });
 
 	return false;
 }
@@ -670,10 +946,7 @@ static bool on_dispatch(command_list *, uint32_t group_count_x, uint32_t group_c
 	if (!s_do_capture)
 		return false;
 
-	std::stringstream s;
-	s << "dispatch(" << group_count_x << ", " << group_count_y << ", " << group_count_z << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::dispatch, { group_count_x, group_count_y, group_count_z });
 
 	return false;
 }
@@ -682,10 +955,7 @@ static bool on_dispatch_mesh(command_list *, uint32_t group_count_x, uint32_t gr
 	if (!s_do_capture)
 		return false;
 
-	std::stringstream s;
-	s << "dispatch_mesh(" << group_count_x << ", " << group_count_y << ", " << group_count_z << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::dispatch_mesh, { group_count_x, group_count_y, group_count_z });
 
 	return false;
 }
@@ -694,10 +964,7 @@ static bool on_dispatch_rays(command_list *, resource raygen, uint64_t raygen_of
 	if (!s_do_capture)
 		return false;
 
-	std::stringstream s;
-	s << "dispatch_rays(" << (void *)raygen.handle << ", " << raygen_offset << ", " << raygen_size << ", " << (void *)miss.handle << ", " << miss_offset << ", " << miss_size << ", " << miss_stride << (void *)hit_group.handle << ", " << hit_group_offset << ", " << hit_group_size << ", " << hit_group_stride << ", " << (void *)callable.handle << ", " << callable_offset << ", " << callable_size << ", " << callable_stride << ", " << width << ", " << height << ", " << depth << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::dispatch_rays, { raygen.handle, raygen_offset, raygen_size, miss.handle, miss_offset, miss_size, miss_stride, hit_group.handle, hit_group_offset, hit_group_size, hit_group_stride, callable.handle, callable_offset, callable_size, callable_stride, width, height, depth });
 
 	return false;
 }
@@ -706,30 +973,7 @@ static bool on_draw_or_dispatch_indirect(command_list *, indirect_command type,
 	if (!s_do_capture)
 		return false;
 
-	std::stringstream s;
-	switch (type)
-	{
-	case indirect_command::unknown:
-		s << "draw_or_dispatch_indirect(" << (void *)buffer.handle << ", " << offset << ", " << draw_count << ", " << stride << ")";
-		break;
-	case indirect_command::draw:
-		s << "draw_indirect(" << (void *)buffer.handle << ", " << offset << ", " << draw_count << ", " << stride << ")";
-		break;
-	case indirect_command::draw_indexed:
-		s << "draw_indexed_indirect(" << (void *)buffer.handle << ", " << offset << ", " << draw_count << ", " << stride << ")";
-		break;
-	case indirect_command::dispatch:
-		s << "dispatch_indirect(" << (void *)buffer.handle << ", " << offset << ", " << draw_count << ", " << stride << ")";
-		break;
-	case indirect_command::dispatch_mesh:
-		s << "dispatch_mesh_indirect(" << (void *)buffer.handle << ", " << offset << ", " << draw_count << ", " << stride << ")";
-		break;
-	case indirect_command::dispatch_rays:
-		s << "dispatch_rays_indirect(" << (void *)buffer.handle << ", " << offset << ", " << draw_count << ", " << stride << ")";
-		break;
-	}
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::draw_or_dispatch_indirect, { static_cast<uint64_t>(type), buffer.handle, offset, draw_count, stride });
 
 	return false;
 }
@@ -747,10 +991,7 @@ static bool on_copy_resource(command_list *, resource src, resource dst)
 	}
 #endif
 
-	std::stringstream s;
-	s << "copy_resource(" << (void *)src.handle << ", " << (void *)dst.handle << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::copy_resource, { src.handle, dst.handle });
 
 	return false;
 }
@@ -767,10 +1008,7 @@ static bool on_copy_buffer_region(command_list *, resource src, uint64_t src_off
 	}
 #endif
 
-	std::stringstream s;
-	s << "copy_buffer_region(" << (void *)src.handle << ", " << src_offset << ", " << (void *)dst.handle << ", " << dst_offset << ", " << size << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::copy_buffer_region, { src.handle, src_offset, dst.handle, dst_offset, size });
 
 	return false;
 }
@@ -787,10 +1025,7 @@ static bool on_copy_buffer_to_texture(command_list *, resource src, uint64_t src
 	}
 #endif
 
-	std::stringstream s;
-	s << "copy_buffer_to_texture(" << (void *)src.handle << ", " << src_offset << ", " << row_length << ", " << slice_height << ", " << (void *)dst.handle << ", " << dst_subresource << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::copy_buffer_to_texture, { src.handle, src_offset, row_length, slice_height, dst.handle, dst_subresource });
 
 	return false;
 }
@@ -807,10 +1042,7 @@ static bool on_copy_texture_region(command_list *, resource src, uint32_t src_su
 	}
 #endif
 
-	std::stringstream s;
-	s << "copy_texture_region(" << (void *)src.handle << ", " << src_subresource << ", " << (void *)dst.handle << ", " << dst_subresource << ", " << (uint32_t)filter << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::copy_texture_region, { src.handle, src_subresource, dst.handle, dst_subresource, static_cast<uint64_t>(filter) });
 
 	return false;
 }
@@ -827,10 +1059,7 @@ static bool on_copy_texture_to_buffer(command_list *, resource src, uint32_t src
 	}
 #endif
 
-	std::stringstream s;
-	s << "copy_texture_to_buffer(" << (void *)src.handle << ", " << src_subresource << ", " << (void *)dst.handle << ", " << dst_offset << ", " << row_length << ", " << slice_height << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::copy_texture_to_buffer, { src.handle, src_subresource, dst.handle, dst_offset, row_length, slice_height });
 
 	return false;
 }
@@ -847,10 +1076,7 @@ static bool on_resolve_texture_region(command_list *, resource src, uint32_t src
 	}
 #endif
 
-	std::stringstream s;
-	s << "resolve_texture_region(" << (void *)src.handle << ", " << src_subresource << ", { ... }, " << (void *)dst.handle << ", " << dst_subresource << ", " << dst_x << ", " << dst_y << ", " << dst_z << ", " << (uint32_t)format << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::resolve_texture_region, { src.handle, src_subresource, dst.handle, dst_subresource, static_cast<uint64_t>(static_cast<uint32_t>(dst_x)), static_cast<uint64_t>(static_cast<uint32_t>(dst_y)), static_cast<uint64_t>(static_cast<uint32_t>(dst_z)), static_cast<uint64_t>(format) });
 
 	return false;
 }
@@ -867,10 +1093,7 @@ static bool on_clear_depth_stencil_view(command_list *, resource_view dsv, const
 	}
 #endif
 
-	std::stringstream s;
-	s << "clear_depth_stencil_view(" << (void *)dsv.handle << ", " << (depth != nullptr ? *depth : 0.0f) << ", " << (stencil != nullptr ? *stencil : 0) << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::clear_depth_stencil_view, { dsv.handle, float_bits(depth != nullptr ? *depth : 0.0f), stencil != nullptr ? *stencil : 0 });
 
 	return false;
 }
@@ -886,10 +1109,7 @@ static bool on_clear_render_target_view(command_list *, resource_view rtv, const
 	}
 #endif
 
-	std::stringstream s;
-	s << "clear_render_target_view(" << (void *)rtv.handle << ", { " << color[0] << ", " << color[1] << ", " << color[2] << ", " << color[3] << " })";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::clear_render_target_view, { rtv.handle, float_bits(color[0]), float_bits(color[1]), float_bits(color[2]), float_bits(color[3]) });
 
 	return false;
 }
@@ -905,10 +1125,7 @@ static bool on_clear_unordered_access_view_uint(command_list *, resource_view ua
 	}
 #endif
 
-	std::stringstream s;
-	s << "clear_unordered_access_view_uint(" << (void *)uav.handle << ", { " << values[0] << ", " << values[1] << ", " << values[2] << ", " << values[3] << " })";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::clear_unordered_access_view_uint, { uav.handle, values[0], values[1], values[2], values[3] });
 
 	return false;
 }
@@ -924,10 +1141,7 @@ static bool on_clear_unordered_access_view_float(command_list *, resource_view u
 	}
 #endif
 
-	std::stringstream s;
-	s << "clear_unordered_access_view_float(" << (void *)uav.handle << ", { " << values[0] << ", " << values[1] << ", " << values[2] << ", " << values[3] << " })";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::clear_unordered_access_view_float, { uav.handle, float_bits(values[0]), float_bits(values[1]), float_bits(values[2]), float_bits(values[3]) });
 
 	return false;
 }
@@ -944,10 +1158,7 @@ static bool on_copy_acceleration_structure(command_list *, resource_view source,
 	}
 #endif
 
-	std::stringstream s;
-	s << "copy_acceleration_structure(" << (void *)source.handle << ", " << (void *)dest.handle << ", " << to_string(mode) << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::copy_acceleration_structure, { source.handle, dest.handle, static_cast<uint64_t>(mode) });
 
 	return false;
 }
@@ -963,10 +1174,7 @@ static bool on_build_acceleration_structure(command_list *, acceleration_structu
 	}
 #endif
 
-	std::stringstream s;
-	s << "build_acceleration_structure(" << to_string(type) << ", " << std::hex << static_cast<uint32_t>(flags) << std::dec << ", " << input_count << ", { ... }, " << (void *)scratch.handle << ", " << scratch_offset << ", " << (void *)source.handle << ", " << (void *)dest.handle << ", " << to_string(mode) << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::build_acceleration_structure, { static_cast<uint64_t>(type), static_cast<uint64_t>(flags), input_count, scratch.handle, scratch_offset, source.handle, dest.handle, static_cast<uint64_t>(mode) });
 
 	return false;
 }
@@ -983,10 +1191,7 @@ static bool on_generate_mipmaps(command_list *, resource_view srv)
 	}
 #endif
 
-	std::stringstream s;
-	s << "generate_mipmaps(" << (void *)srv.handle << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::generate_mipmaps, { srv.handle });
 
 	return false;
 }
@@ -996,10 +1201,7 @@ static bool on_begin_query(command_list *cmd_list, query_heap heap, query_type t
 	if (!s_do_capture)
 		return false;
 
-	std::stringstream s;
-	s << "begin_query(" << (void *)heap.handle << ", " << to_string(type) << ", " << index << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::begin_query, { heap.handle, static_cast<uint64_t>(type), index });
 
 	return false;
 }
@@ -1008,10 +1210,7 @@ static bool on_end_query(command_list *cmd_list, query_heap heap, query_type typ
 	if (!s_do_capture)
 		return false;
 
-	std::stringstream s;
-	s << "end_query(" << (void *)heap.handle << ", " << to_string(type) << ", " << index << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::end_query, { heap.handle, static_cast<uint64_t>(type), index });
 
 	return false;
 }
@@ -1027,10 +1226,7 @@ static bool on_copy_query_heap_results(command_list *cmd_list, query_heap heap,
 	}
 #endif
 
-	std::stringstream s;
-	s << "copy_query_heap_results(" << (void *)heap.handle << ", " << to_string(type) << ", " << first << ", " << count << (void *)dest.handle << ", " << dest_offset << ", " << stride << ")";
-
-	reshade::log::message(reshade::log::level::info, s.str().c_str());
+	trace(trace_op::copy_query_heap_results, { heap.handle, static_cast<uint64_t>(type), first, count, dest.handle, dest_offset, stride });
 
 	return false;
 }
@@ -1039,9 +1235,13 @@ static void on_present(effect_runtime *runtime)
 {
 	if (s_do_capture)
 	{
-		reshade::log::message(reshade::log::level::info, "present()");
-		reshade::log::message(reshade::log::level::info, "--- End Frame ---");
+		trace(trace_op::present, {});
+		trace(trace_op::frame_end, {});
 		s_do_capture = false;
+
+		// Wait for the trace thread to finish converting the remaining records (this happens on the application thread, not inside 'DllMain', so joining is safe)
+		s_trace_thread_stop = true;
+		s_trace_thread.join();
 	}
 	else
 	{
@@ -1049,7 +1249,12 @@ static void on_present(effect_runtime *runtime)
 		if (runtime->is_key_pressed(VK_F10))
 		{
 			s_do_capture = true;
-			reshade::log::message(reshade::log::level::info, "--- Frame ---");
+			s_capture_start_time = std::chrono::high_resolution_clock::now();
+
+			s_trace_thread_stop = false;
+			s_trace_thread = std::thread(trace_thread_proc);
+
+			trace(trace_op::frame_begin, {});
 		}
 	}
 }
@@ -1065,6 +1270,9 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 		if (!reshade::register_addon(hModule))
 			return FALSE;
 
+		for (uint64_t i = 0; i < TRACE_RING_SIZE; ++i)
+			s_trace_ring[i].sequence.store(i, std::memory_order_relaxed);
+
 		reshade::register_event<reshade::addon_event::init_swapchain>(on_init_swapchain);
 		reshade::register_event<reshade::addon_event::destroy_swapchain>(on_destroy_swapchain);
 		reshade::register_event<reshade::addon_event::init_sampler>(on_init_sampler);
@@ -1115,6 +1323,13 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 		reshade::register_event<reshade::addon_event::reshade_present>(on_present);
 		break;
 	case DLL_PROCESS_DETACH:
+		// Cannot join the trace thread under the loader lock, so just signal it to exit in case a capture is still running
+		if (s_trace_thread.joinable())
+		{
+			s_trace_thread_stop = true;
+			s_trace_thread.detach();
+		}
+
 		reshade::unregister_addon(hModule);
 		break;
 	}
@@ -44,6 +44,11 @@ static void save_shader_code(device_api device_type, const shader_desc &desc)
 	dump_path /= hash_string;
 	dump_path += extension;
 
+	// Hand the blob to ReShade's shared write-behind queue, so that pipeline creation storms are not serialized on disk I/O
+	if (reshade::write_file_async(dump_path.c_str(), desc.code, desc.code_size))
+		return;
+
+	// Fall back to writing synchronously when the queue is saturated or not available
 	std::ofstream file(dump_path, std::ios::binary);
 	file.write(static_cast<const char *>(desc.code), desc.code_size);
 }
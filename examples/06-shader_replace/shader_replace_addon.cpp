@@ -7,28 +7,30 @@
 #include "config.hpp"
 #include "crc32_hash.hpp"
 #include <cstring>
+#include <deque>
 #include <fstream>
 #include <filesystem>
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <condition_variable>
 
 using namespace reshade::api;
 
 constexpr uint32_t SPIRV_MAGIC = 0x07230203;
 
 static thread_local std::vector<std::vector<uint8_t>> s_data_to_delete;
+// Set while the worker thread below is creating a replacement pipeline, to avoid the pipeline events it triggers from queuing up additional work
+static thread_local bool s_is_creating_replacement = false;
 
-static bool load_shader_code(device_api device_type, shader_desc &desc, std::vector<std::vector<uint8_t>> &data_to_delete)
-{
-	if (desc.code_size == 0)
-		return false;
-
-	uint32_t shader_hash = compute_crc32(static_cast<const uint8_t *>(desc.code), desc.code_size);
-
-	const wchar_t *extension = L".cso";
-	if (device_type == device_api::vulkan || (device_type == device_api::opengl && desc.code_size > sizeof(uint32_t) && *static_cast<const uint32_t *>(desc.code) == SPIRV_MAGIC))
-		extension = L".spv"; // Vulkan uses SPIR-V (and sometimes OpenGL does too)
-	else if (device_type == device_api::opengl)
-		extension = desc.code_size > 5 && std::strncmp(static_cast<const char *>(desc.code), "!!ARB", 5) == 0 ? L".txt" : L".glsl"; // OpenGL otherwise uses plain text ARB assembly language or GLSL
+// Index over all replacement files found on disk, built once at start up, so that pipeline creation does not have to probe the filesystem for every shader hash
+static std::unordered_multimap<uint32_t, std::filesystem::path> s_replacement_index;
 
+static void build_replacement_index()
+{
 	// Prepend executable file name to image files
 	wchar_t file_prefix[MAX_PATH] = L"";
 	GetModuleFileNameW(nullptr, file_prefix, ARRAYSIZE(file_prefix));
@@ -37,20 +39,287 @@ static bool load_shader_code(device_api device_type, shader_desc &desc, std::vec
 	replace_path  = replace_path.parent_path();
 	replace_path /= RESHADE_ADDON_SHADER_LOAD_DIR;
 
-	wchar_t hash_string[11];
-	swprintf_s(hash_string, L"0x%08X", shader_hash);
+	std::error_code ec;
+	for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(replace_path, ec))
+	{
+		if (!entry.is_regular_file(ec))
+			continue;
 
-	replace_path /= hash_string;
-	replace_path += extension;
+		// Replacement files are named after the shader hash, in the "0x12345678" format the shader dump add-on writes them in
+		const std::wstring filename = entry.path().stem().wstring();
+		if (filename.size() != 10 || filename.compare(0, 2, L"0x") != 0)
+			continue;
 
-	// Check if a replacement file for this shader hash exists and if so, overwrite the shader code with its contents
-	if (!std::filesystem::exists(replace_path))
-		return false;
+		wchar_t *end = nullptr;
+		const uint32_t shader_hash = static_cast<uint32_t>(std::wcstoul(filename.c_str() + 2, &end, 16));
+		if (end == nullptr || *end != L'\0')
+			continue;
 
+		s_replacement_index.emplace(shader_hash, entry.path());
+	}
+}
+
+static const wchar_t *get_shader_extension(device_api device_type, const shader_desc &desc)
+{
+	if (device_type == device_api::vulkan || (device_type == device_api::opengl && desc.code_size > sizeof(uint32_t) && *static_cast<const uint32_t *>(desc.code) == SPIRV_MAGIC))
+		return L".spv"; // Vulkan uses SPIR-V (and sometimes OpenGL does too)
+	if (device_type == device_api::opengl)
+		return desc.code_size > 5 && std::strncmp(static_cast<const char *>(desc.code), "!!ARB", 5) == 0 ? L".txt" : L".glsl"; // OpenGL otherwise uses plain text ARB assembly language or GLSL
+	return L".cso";
+}
+
+static const std::filesystem::path *find_replacement_file(uint32_t shader_hash, const wchar_t *extension)
+{
+	const auto range = s_replacement_index.equal_range(shader_hash);
+	for (auto it = range.first; it != range.second; ++it)
+		if (it->second.extension() == extension)
+			return &it->second;
+	return nullptr;
+}
+
+static bool load_replacement_file(const std::filesystem::path &replace_path, std::vector<uint8_t> &shader_code)
+{
 	std::ifstream file(replace_path, std::ios::binary);
+	if (!file)
+		return false;
 	file.seekg(0, std::ios::end);
-	std::vector<uint8_t> shader_code(static_cast<size_t>(file.tellg()));
+	shader_code.resize(static_cast<size_t>(file.tellg()));
 	file.seekg(0, std::ios::beg).read(reinterpret_cast<char *>(shader_code.data()), shader_code.size());
+	return true;
+}
+
+static bool is_shader_stage(pipeline_subobject_type type)
+{
+	switch (type)
+	{
+	case pipeline_subobject_type::vertex_shader:
+	case pipeline_subobject_type::hull_shader:
+	case pipeline_subobject_type::domain_shader:
+	case pipeline_subobject_type::geometry_shader:
+	case pipeline_subobject_type::pixel_shader:
+	case pipeline_subobject_type::compute_shader:
+	case pipeline_subobject_type::amplification_shader:
+	case pipeline_subobject_type::mesh_shader:
+	case pipeline_subobject_type::raygen_shader:
+	case pipeline_subobject_type::any_hit_shader:
+	case pipeline_subobject_type::closest_hit_shader:
+	case pipeline_subobject_type::miss_shader:
+	case pipeline_subobject_type::intersection_shader:
+	case pipeline_subobject_type::callable_shader:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Creating pipelines from a different thread is only safe on APIs whose device objects are free-threaded
+// On those the original pipeline is used until the replacement one was created in the background, while the other APIs fall back to replacing the shader code synchronously at creation
+static bool is_replacement_async(device_api device_type)
+{
+	return device_type == device_api::d3d10 || device_type == device_api::d3d11 || device_type == device_api::d3d12 || device_type == device_api::vulkan;
+}
+
+static size_t get_subobject_data_size(pipeline_subobject_type type)
+{
+	switch (type)
+	{
+	case pipeline_subobject_type::vertex_shader:
+	case pipeline_subobject_type::hull_shader:
+	case pipeline_subobject_type::domain_shader:
+	case pipeline_subobject_type::geometry_shader:
+	case pipeline_subobject_type::pixel_shader:
+	case pipeline_subobject_type::compute_shader:
+	case pipeline_subobject_type::amplification_shader:
+	case pipeline_subobject_type::mesh_shader:
+	case pipeline_subobject_type::raygen_shader:
+	case pipeline_subobject_type::any_hit_shader:
+	case pipeline_subobject_type::closest_hit_shader:
+	case pipeline_subobject_type::miss_shader:
+	case pipeline_subobject_type::intersection_shader:
+	case pipeline_subobject_type::callable_shader:
+		return sizeof(shader_desc);
+	case pipeline_subobject_type::input_layout:
+		return sizeof(input_element);
+	case pipeline_subobject_type::stream_output_state:
+		return sizeof(stream_output_desc);
+	case pipeline_subobject_type::blend_state:
+		return sizeof(blend_desc);
+	case pipeline_subobject_type::rasterizer_state:
+		return sizeof(rasterizer_desc);
+	case pipeline_subobject_type::depth_stencil_state:
+		return sizeof(depth_stencil_desc);
+	case pipeline_subobject_type::primitive_topology:
+		return sizeof(primitive_topology);
+	case pipeline_subobject_type::depth_stencil_format:
+	case pipeline_subobject_type::render_target_formats:
+		return sizeof(format);
+	case pipeline_subobject_type::sample_mask:
+	case pipeline_subobject_type::sample_count:
+	case pipeline_subobject_type::viewport_count:
+	case pipeline_subobject_type::max_vertex_count:
+	case pipeline_subobject_type::max_payload_size:
+	case pipeline_subobject_type::max_attribute_size:
+	case pipeline_subobject_type::max_recursion_depth:
+		return sizeof(uint32_t);
+	case pipeline_subobject_type::dynamic_pipeline_states:
+		return sizeof(dynamic_state);
+	case pipeline_subobject_type::libraries:
+		return sizeof(pipeline);
+	case pipeline_subobject_type::shader_groups:
+		return sizeof(shader_group);
+	default:
+		// Unknown sub-object type that may contain pointers this add-on does not know how to deep copy
+		return 0;
+	}
+}
+
+// Deep copy of a pipeline description, so that a replacement pipeline can be created from it after the pipeline creation event callbacks have returned
+struct pipeline_replacement_job
+{
+	device *device = nullptr;
+	uint64_t pipeline_handle = 0;
+	pipeline_layout layout = {};
+	std::vector<pipeline_subobject> subobjects;
+	std::deque<std::vector<uint8_t>> data;
+	std::deque<std::string> strings;
+	// Shader descriptions inside the copied sub-objects above that should be overwritten with the contents of a replacement file
+	std::vector<std::pair<shader_desc *, std::filesystem::path>> replacements;
+
+	bool copy_subobjects(uint32_t subobject_count, const pipeline_subobject *source)
+	{
+		subobjects.assign(source, source + subobject_count);
+
+		for (pipeline_subobject &subobject : subobjects)
+		{
+			const size_t element_size = get_subobject_data_size(subobject.type);
+			if (element_size == 0)
+				return false;
+			if (subobject.data == nullptr || subobject.count == 0)
+				continue;
+
+			std::vector<uint8_t> &copy = data.emplace_back(static_cast<const uint8_t *>(subobject.data), static_cast<const uint8_t *>(subobject.data) + subobject.count * element_size);
+			subobject.data = copy.data();
+
+			if (is_shader_stage(subobject.type))
+			{
+				for (uint32_t k = 0; k < subobject.count; ++k)
+				{
+					shader_desc &desc = static_cast<shader_desc *>(subobject.data)[k];
+					if (desc.code != nullptr && desc.code_size != 0)
+						desc.code = data.emplace_back(static_cast<const uint8_t *>(desc.code), static_cast<const uint8_t *>(desc.code) + desc.code_size).data();
+					if (desc.entry_point != nullptr)
+						desc.entry_point = strings.emplace_back(desc.entry_point).c_str();
+					if (desc.spec_constant_ids != nullptr && desc.spec_constants != 0)
+						desc.spec_constant_ids = reinterpret_cast<const uint32_t *>(data.emplace_back(reinterpret_cast<const uint8_t *>(desc.spec_constant_ids), reinterpret_cast<const uint8_t *>(desc.spec_constant_ids + desc.spec_constants)).data());
+					if (desc.spec_constant_values != nullptr && desc.spec_constants != 0)
+						desc.spec_constant_values = reinterpret_cast<const uint32_t *>(data.emplace_back(reinterpret_cast<const uint8_t *>(desc.spec_constant_values), reinterpret_cast<const uint8_t *>(desc.spec_constant_values + desc.spec_constants)).data());
+				}
+			}
+			else if (subobject.type == pipeline_subobject_type::input_layout)
+			{
+				for (uint32_t k = 0; k < subobject.count; ++k)
+				{
+					input_element &element = static_cast<input_element *>(subobject.data)[k];
+					if (element.semantic != nullptr)
+						element.semantic = strings.emplace_back(element.semantic).c_str();
+				}
+			}
+		}
+
+		return true;
+	}
+};
+
+struct __declspec(uuid("2f124e38-08fa-4c2b-9f0e-6c2a65b0d2a1")) shader_replace_data
+{
+	std::shared_mutex mutex;
+	// Maps original pipeline handles to their replacement pipeline (or zero while the replacement is still being created in the background)
+	std::unordered_map<uint64_t, pipeline> replaced_pipelines;
+};
+
+static std::mutex s_worker_mutex;
+static std::condition_variable s_worker_cond;
+static std::thread s_worker_thread;
+static bool s_worker_exit = false;
+static std::deque<pipeline_replacement_job> s_worker_jobs;
+static const device *s_worker_active_device = nullptr;
+static unsigned int s_device_count = 0;
+
+static void execute_replacement_job(pipeline_replacement_job &job)
+{
+	// Load the replacement shader code from disk and substitute it into the copied pipeline description
+	std::deque<std::vector<uint8_t>> replacement_code;
+	for (const std::pair<shader_desc *, std::filesystem::path> &replacement : job.replacements)
+	{
+		std::vector<uint8_t> &shader_code = replacement_code.emplace_back();
+		if (!load_replacement_file(replacement.second, shader_code))
+			return;
+
+		replacement.first->code = shader_code.data();
+		replacement.first->code_size = shader_code.size();
+	}
+
+	s_is_creating_replacement = true;
+	pipeline replacement_pipeline = {};
+	const bool created = job.device->create_pipeline(job.layout, static_cast<uint32_t>(job.subobjects.size()), job.subobjects.data(), &replacement_pipeline);
+	s_is_creating_replacement = false;
+
+	if (!created)
+		return;
+
+	shader_replace_data &data = *job.device->get_private_data<shader_replace_data>();
+
+	std::unique_lock<std::shared_mutex> lock(data.mutex);
+	if (const auto it = data.replaced_pipelines.find(job.pipeline_handle);
+		it != data.replaced_pipelines.end())
+	{
+		it->second = replacement_pipeline;
+	}
+	else
+	{
+		// The original pipeline was destroyed in the meantime, so the replacement is no longer needed
+		lock.unlock();
+		job.device->destroy_pipeline(replacement_pipeline);
+	}
+}
+
+static void worker_thread_main()
+{
+	std::unique_lock<std::mutex> lock(s_worker_mutex);
+	while (true)
+	{
+		s_worker_cond.wait(lock, []() { return s_worker_exit || !s_worker_jobs.empty(); });
+		if (s_worker_exit)
+			break;
+
+		pipeline_replacement_job job = std::move(s_worker_jobs.front());
+		s_worker_jobs.pop_front();
+		s_worker_active_device = job.device;
+
+		lock.unlock();
+		execute_replacement_job(job);
+		lock.lock();
+
+		s_worker_active_device = nullptr;
+		s_worker_cond.notify_all();
+	}
+}
+
+static bool load_shader_code(device_api device_type, shader_desc &desc, std::vector<std::vector<uint8_t>> &data_to_delete)
+{
+	if (desc.code_size == 0)
+		return false;
+
+	const uint32_t shader_hash = compute_crc32(static_cast<const uint8_t *>(desc.code), desc.code_size);
+
+	// Check if a replacement file for this shader hash exists in the index and if so, overwrite the shader code with its contents
+	const std::filesystem::path *const replace_path = find_replacement_file(shader_hash, get_shader_extension(device_type, desc));
+	if (replace_path == nullptr)
+		return false;
+
+	std::vector<uint8_t> shader_code;
+	if (!load_replacement_file(*replace_path, shader_code))
+		return false;
 
 	// Keep the shader code memory alive after returning from this 'create_pipeline' event callback
 	// It may only be freed after the 'init_pipeline' event was called for this pipeline
@@ -63,40 +332,164 @@ static bool load_shader_code(device_api device_type, shader_desc &desc, std::vec
 
 static bool on_create_pipeline(device *device, pipeline_layout, uint32_t subobject_count, const pipeline_subobject *subobjects)
 {
-	bool replaced_stages = false;
+	if (s_replacement_index.empty() || s_is_creating_replacement)
+		return false;
+
 	const device_api device_type = device->get_api();
+	// On APIs with free-threaded pipeline creation the replacement is instead created asynchronously in 'on_init_pipeline' below, so that the application does not stall here
+	if (is_replacement_async(device_type))
+		return false;
+
+	bool replaced_stages = false;
 
 	// Go through all shader stages that are in this pipeline and potentially replace the associated shader code
 	for (uint32_t i = 0; i < subobject_count; ++i)
-	{
-		switch (subobjects[i].type)
-		{
-		case pipeline_subobject_type::vertex_shader:
-		case pipeline_subobject_type::hull_shader:
-		case pipeline_subobject_type::domain_shader:
-		case pipeline_subobject_type::geometry_shader:
-		case pipeline_subobject_type::pixel_shader:
-		case pipeline_subobject_type::compute_shader:
-		case pipeline_subobject_type::amplification_shader:
-		case pipeline_subobject_type::mesh_shader:
-		case pipeline_subobject_type::raygen_shader:
-		case pipeline_subobject_type::any_hit_shader:
-		case pipeline_subobject_type::closest_hit_shader:
-		case pipeline_subobject_type::miss_shader:
-		case pipeline_subobject_type::intersection_shader:
-		case pipeline_subobject_type::callable_shader:
+		if (is_shader_stage(subobjects[i].type))
 			replaced_stages |= load_shader_code(device_type, *static_cast<shader_desc *>(subobjects[i].data), s_data_to_delete);
-			break;
-		}
-	}
 
 	// Return whether any shader code was replaced
 	return replaced_stages;
 }
-static void on_after_create_pipeline(device *, pipeline_layout, uint32_t, const pipeline_subobject *, pipeline)
+static void on_after_create_pipeline(device *device, pipeline_layout layout, uint32_t subobject_count, const pipeline_subobject *subobjects, pipeline pipeline)
 {
 	// Free the memory allocated in the 'load_shader_code' call above
 	s_data_to_delete.clear();
+
+	if (s_replacement_index.empty() || s_is_creating_replacement)
+		return;
+
+	const device_api device_type = device->get_api();
+	if (!is_replacement_async(device_type))
+		return;
+
+	// Check if any of the shader stages in this pipeline have a replacement file before going through the trouble of copying the pipeline description
+	std::vector<std::pair<std::pair<uint32_t, uint32_t>, const std::filesystem::path *>> matches;
+	for (uint32_t i = 0; i < subobject_count; ++i)
+	{
+		if (!is_shader_stage(subobjects[i].type))
+			continue;
+
+		for (uint32_t k = 0; k < subobjects[i].count; ++k)
+		{
+			const shader_desc &desc = static_cast<const shader_desc *>(subobjects[i].data)[k];
+			if (desc.code_size == 0)
+				continue;
+
+			const uint32_t shader_hash = compute_crc32(static_cast<const uint8_t *>(desc.code), desc.code_size);
+
+			if (const std::filesystem::path *const replace_path = find_replacement_file(shader_hash, get_shader_extension(device_type, desc)))
+				matches.emplace_back(std::make_pair(i, k), replace_path);
+		}
+	}
+
+	if (matches.empty())
+		return;
+
+	pipeline_replacement_job job;
+	job.device = device;
+	job.pipeline_handle = pipeline.handle;
+	job.layout = layout;
+	if (!job.copy_subobjects(subobject_count, subobjects))
+		return;
+
+	// Resolve the sub-object indices found above to pointers into the copied pipeline description
+	job.replacements.reserve(matches.size());
+	for (const std::pair<std::pair<uint32_t, uint32_t>, const std::filesystem::path *> &match : matches)
+		job.replacements.emplace_back(static_cast<shader_desc *>(job.subobjects[match.first.first].data) + match.first.second, *match.second);
+
+	shader_replace_data &data = *device->get_private_data<shader_replace_data>();
+	{
+		const std::unique_lock<std::shared_mutex> lock(data.mutex);
+		// Mark the original pipeline as having a replacement pending, so that its destruction can be detected in 'execute_replacement_job'
+		data.replaced_pipelines.emplace(pipeline.handle, reshade::api::pipeline { 0 });
+	}
+
+	const std::unique_lock<std::mutex> lock(s_worker_mutex);
+	s_worker_jobs.push_back(std::move(job));
+	if (!s_worker_thread.joinable())
+		s_worker_thread = std::thread(worker_thread_main);
+	s_worker_cond.notify_one();
+}
+
+static void on_destroy_pipeline(device *device, pipeline pipeline)
+{
+	shader_replace_data *const data = device->get_private_data<shader_replace_data>();
+	if (data == nullptr || data->replaced_pipelines.empty())
+		return;
+
+	reshade::api::pipeline replacement = { 0 };
+	{
+		const std::unique_lock<std::shared_mutex> lock(data->mutex);
+		if (const auto it = data->replaced_pipelines.find(pipeline.handle);
+			it != data->replaced_pipelines.end())
+		{
+			replacement = it->second;
+			data->replaced_pipelines.erase(it);
+		}
+	}
+
+	if (replacement.handle != 0)
+		device->destroy_pipeline(replacement);
+}
+
+static void on_bind_pipeline(command_list *cmd_list, pipeline_stage stages, pipeline pipeline)
+{
+	device *const device = cmd_list->get_device();
+	shader_replace_data *const data = device->get_private_data<shader_replace_data>();
+	if (data == nullptr || data->replaced_pipelines.empty())
+		return;
+
+	reshade::api::pipeline replacement = { 0 };
+	{
+		const std::shared_lock<std::shared_mutex> lock(data->mutex);
+		if (const auto it = data->replaced_pipelines.find(pipeline.handle);
+			it != data->replaced_pipelines.end())
+			replacement = it->second;
+	}
+
+	// Use the replacement pipeline instead of the original one the application bound (this re-enters this callback, but the replacement pipeline is not in the map, so recursion stops there)
+	if (replacement.handle != 0)
+		cmd_list->bind_pipeline(stages, replacement);
+}
+
+static void on_init_device(device *device)
+{
+	device->create_private_data<shader_replace_data>();
+
+	const std::unique_lock<std::mutex> lock(s_worker_mutex);
+	s_device_count++;
+}
+static void on_destroy_device(device *device)
+{
+	{
+		std::unique_lock<std::mutex> lock(s_worker_mutex);
+
+		// Remove any pending replacement jobs for this device and wait for one that may currently be executing
+		s_worker_jobs.erase(std::remove_if(s_worker_jobs.begin(), s_worker_jobs.end(),
+			[device](const pipeline_replacement_job &job) { return job.device == device; }), s_worker_jobs.end());
+		s_worker_cond.wait(lock, [device]() { return s_worker_active_device != device; });
+
+		// Shut the worker thread down with the last device, since joining it during DLL unload would deadlock on the loader lock
+		if (--s_device_count == 0 && s_worker_thread.joinable())
+		{
+			s_worker_exit = true;
+			s_worker_cond.notify_all();
+			lock.unlock();
+			s_worker_thread.join();
+			lock.lock();
+			s_worker_thread = std::thread();
+			s_worker_exit = false;
+		}
+	}
+
+	shader_replace_data *const data = device->get_private_data<shader_replace_data>();
+
+	// Destroy any replacement pipelines the application did not destroy the original of
+	for (const std::pair<const uint64_t, pipeline> &replaced : data->replaced_pipelines)
+		if (replaced.second.handle != 0)
+			device->destroy_pipeline(replaced.second);
+
+	device->destroy_private_data<shader_replace_data>();
 }
 
 extern "C" __declspec(dllexport) const char *NAME = "Shader Replace";
@@ -109,8 +502,13 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 	case DLL_PROCESS_ATTACH:
 		if (!reshade::register_addon(hModule))
 			return FALSE;
+		build_replacement_index();
+		reshade::register_event<reshade::addon_event::init_device>(on_init_device);
+		reshade::register_event<reshade::addon_event::destroy_device>(on_destroy_device);
 		reshade::register_event<reshade::addon_event::create_pipeline>(on_create_pipeline);
 		reshade::register_event<reshade::addon_event::init_pipeline>(on_after_create_pipeline);
+		reshade::register_event<reshade::addon_event::destroy_pipeline>(on_destroy_pipeline);
+		reshade::register_event<reshade::addon_event::bind_pipeline>(on_bind_pipeline);
 		break;
 	case DLL_PROCESS_DETACH:
 		reshade::unregister_addon(hModule);
@@ -5,6 +5,12 @@
 
 #include <reshade.hpp>
 #include "config.hpp"
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <condition_variable>
 
 using namespace reshade::api;
 
@@ -17,6 +23,80 @@ extern bool save_texture_image(const resource_desc &desc, const subresource_data
 // - Via a copy operation from a buffer in host memory to the texture (common in D3D12 and Vulkan): See 'on_copy_buffer_to_texture' implementation below
 // - Via mapping and writing to texture that is accessible in host memory (common in D3D9): See 'on_map_texture' and 'on_unmap_texture' implementation below
 
+// Texture data captured from the application, waiting to be decoded and written to disk by the worker thread below
+struct texture_dump_job
+{
+	resource_desc desc = {};
+	uint32_t row_pitch = 0;
+	uint32_t slice_pitch = 0;
+	std::vector<uint8_t> pixel_data;
+};
+
+static std::mutex s_worker_mutex;
+static std::condition_variable s_worker_cond;
+static std::thread s_worker_thread;
+static bool s_worker_exit = false;
+static std::deque<texture_dump_job> s_worker_jobs;
+static size_t s_worker_queued_bytes = 0;
+static unsigned int s_device_count = 0;
+
+// Upper bound on the texture data waiting to be written, so that a level load dumping hundreds of textures cannot grow memory usage unchecked
+static constexpr size_t worker_queue_byte_limit = 256 * 1024 * 1024;
+
+static void worker_thread_main()
+{
+	std::unique_lock<std::mutex> lock(s_worker_mutex);
+	while (true)
+	{
+		s_worker_cond.wait(lock, []() { return s_worker_exit || !s_worker_jobs.empty(); });
+		if (s_worker_jobs.empty())
+			break; // Only exit after all queued images were written to disk
+
+		texture_dump_job job = std::move(s_worker_jobs.front());
+		s_worker_jobs.pop_front();
+		s_worker_queued_bytes -= job.pixel_data.size();
+
+		lock.unlock();
+
+		// Decode and encode the image on this worker thread, so that the application never blocks on it
+		subresource_data data;
+		data.data = job.pixel_data.data();
+		data.row_pitch = job.row_pitch;
+		data.slice_pitch = job.slice_pitch;
+
+		save_texture_image(job.desc, data);
+
+		lock.lock();
+	}
+}
+
+static void queue_texture_save(const resource_desc &desc, const subresource_data &data)
+{
+	texture_dump_job job;
+	job.desc = desc;
+	job.row_pitch = data.row_pitch;
+	job.slice_pitch = format_slice_pitch(desc.texture.format, data.row_pitch, desc.texture.height);
+
+	const std::unique_lock<std::mutex> lock(s_worker_mutex);
+
+	// Drop the texture when the queue is saturated, rather than stalling the application (textures are usually uploaded again on the next level load)
+	if (s_worker_queued_bytes + job.slice_pitch > worker_queue_byte_limit)
+	{
+		reshade::log::message(reshade::log::level::warning, "Skipped texture dump because the write queue is full.");
+		return;
+	}
+
+	// Only a copy of the raw texture data happens on the application thread, the expensive decoding and encoding is done on the worker thread
+	job.pixel_data.resize(job.slice_pitch);
+	std::memcpy(job.pixel_data.data(), data.data, job.slice_pitch);
+
+	s_worker_queued_bytes += job.pixel_data.size();
+	s_worker_jobs.push_back(std::move(job));
+	if (!s_worker_thread.joinable())
+		s_worker_thread = std::thread(worker_thread_main);
+	s_worker_cond.notify_one();
+}
+
 static inline bool filter_texture(device *device, const resource_desc &desc, const subresource_box *box)
 {
 	if (desc.type != resource_type::texture_2d || (desc.usage & resource_usage::shader_resource) == resource_usage::undefined || (desc.heap != memory_heap::gpu_only && desc.heap != memory_heap::unknown) || (desc.flags & resource_flags::dynamic) == resource_flags::dynamic)
@@ -48,7 +128,7 @@ static void on_init_texture(device *device, const resource_desc &desc, const sub
 	if (initial_data == nullptr || !filter_texture(device, desc, nullptr))
 		return;
 
-	save_texture_image(desc, *initial_data);
+	queue_texture_save(desc, *initial_data);
 }
 static bool on_update_texture(device *device, const subresource_data &data, resource dst, uint32_t dst_subresource, const subresource_box *dst_box)
 {
@@ -59,7 +139,7 @@ static bool on_update_texture(device *device, const subresource_data &data, reso
 	if (!filter_texture(device, dst_desc, dst_box))
 		return false;
 
-	save_texture_image(dst_desc, data);
+	queue_texture_save(dst_desc, data);
 
 	return false;
 }
@@ -90,7 +170,8 @@ static bool on_copy_buffer_to_texture(command_list *cmd_list, resource src, uint
 			mapped_data.row_pitch = (mapped_data.row_pitch + 255) & ~255;
 		mapped_data.slice_pitch = format_slice_pitch(dst_desc.texture.format, mapped_data.row_pitch, slice_height != 0 ? slice_height : dst_desc.texture.height);
 
-		save_texture_image(dst_desc, mapped_data);
+		// The data is copied out of the mapped buffer before it is unmapped below, only the encoding happens asynchronously
+		queue_texture_save(dst_desc, mapped_data);
 
 		device->unmap_buffer_region(src);
 	}
@@ -125,7 +206,31 @@ static void on_unmap_texture(device *, resource resource, uint32_t subresource)
 
 	s_current_mapping.res = { 0 };
 
-	save_texture_image(s_current_mapping.desc, s_current_mapping.data);
+	queue_texture_save(s_current_mapping.desc, s_current_mapping.data);
+}
+
+static void on_init_device(device *)
+{
+	const std::unique_lock<std::mutex> lock(s_worker_mutex);
+	s_device_count++;
+}
+static void on_destroy_device(device *)
+{
+	std::thread worker_thread;
+	{
+		const std::unique_lock<std::mutex> lock(s_worker_mutex);
+
+		// Shut the worker thread down with the last device (it finishes writing any queued images first), since joining it during DLL unload would deadlock on the loader lock
+		if (--s_device_count != 0 || !s_worker_thread.joinable())
+			return;
+
+		s_worker_exit = true;
+		worker_thread = std::move(s_worker_thread);
+		s_worker_cond.notify_all();
+	}
+
+	worker_thread.join();
+	s_worker_exit = false;
 }
 
 extern "C" __declspec(dllexport) const char *NAME = "Texture Dump";
@@ -138,6 +243,8 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 	case DLL_PROCESS_ATTACH:
 		if (!reshade::register_addon(hModule))
 			return FALSE;
+		reshade::register_event<reshade::addon_event::init_device>(on_init_device);
+		reshade::register_event<reshade::addon_event::destroy_device>(on_destroy_device);
 		reshade::register_event<reshade::addon_event::init_resource>(on_init_texture);
 		reshade::register_event<reshade::addon_event::update_texture_region>(on_update_texture);
 		reshade::register_event<reshade::addon_event::copy_buffer_to_texture>(on_copy_buffer_to_texture);
@@ -5,19 +5,160 @@
 
 #include <reshade.hpp>
 #include "config.hpp"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <algorithm>
 #include <vector>
+#include <filesystem>
+#include <unordered_map>
+#include <condition_variable>
 
 using namespace reshade::api;
 
-// When a resource is being created, ReShade will first call any registered 'create_resource' callbacks, then actually create the resource and finally call any registered 'init_resource' callbacks.
-// So to modify the initial data passed to resource creation, have to allocate and fill it in a 'create_resource' callback, which is then passed along to the actual resource creation and then have to free it again in a 'init_resource' callback.
-// The problem is that multiple threads can create resources simultaneously and as such the order in which these three things happen across multiple threads is not guaranteed (e.g. 'init_resource' may be called on one thread while another thread has only just called 'create_resource').
-// To ensure there is no race condition between the data being freed on one thread and another thread potentially still creating a different resource also referencing initial data, this variable is made thread-local.
-// This way each thread gets its own copy and the order it is being used on each thread is always correct, from it being set in the 'create_resource' callback, to it being used during resource creation, to it finally being freed in the 'init_resource' callback.
-static thread_local std::vector<std::vector<uint8_t>> s_data_to_delete;
-
 // See implementation in 'utils\load_texture_image.cpp'
-extern bool load_texture_image(const resource_desc &desc, subresource_data &data, std::vector<std::vector<uint8_t>> &data_to_delete);
+extern uint32_t compute_texture_hash(const resource_desc &desc, const subresource_data &data);
+extern bool decode_texture_image(const resource_desc &desc, const std::filesystem::path &replace_path, subresource_data &data, std::vector<uint8_t> &pixel_data);
+
+// Index over all replacement files found on disk, built once at start up, so that texture creation does not have to probe the filesystem for every texture hash
+// The texture hashes are precomputed in the file names (in the "0x12345678" format the texture dump add-on writes them in), so no file contents have to be touched to build it
+static std::unordered_map<uint32_t, std::filesystem::path> s_replacement_index;
+
+static void build_replacement_index()
+{
+	// Prepend executable directory to image files
+	wchar_t file_prefix[MAX_PATH] = L"";
+	GetModuleFileNameW(nullptr, file_prefix, ARRAYSIZE(file_prefix));
+
+	std::filesystem::path replace_path = file_prefix;
+	replace_path  = replace_path.parent_path();
+	replace_path /= RESHADE_ADDON_TEXTURE_LOAD_DIR;
+
+	std::error_code ec;
+	for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(replace_path, ec))
+	{
+		if (!entry.is_regular_file(ec) || entry.path().extension() != RESHADE_ADDON_TEXTURE_LOAD_FORMAT)
+			continue;
+
+		const std::wstring filename = entry.path().stem().wstring();
+		if (filename.size() != 10 || filename.compare(0, 2, L"0x") != 0)
+			continue;
+
+		wchar_t *end = nullptr;
+		const uint32_t texture_hash = static_cast<uint32_t>(std::wcstoul(filename.c_str() + 2, &end, 16));
+		if (end == nullptr || *end != L'\0')
+			continue;
+
+		s_replacement_index.emplace(texture_hash, entry.path());
+	}
+}
+
+// Replacement image decoded by the worker thread below, waiting to be uploaded to its target texture on the next present
+struct ready_upload
+{
+	uint64_t resource_handle = 0;
+	subresource_data data = {};
+	std::vector<uint8_t> pixel_data;
+};
+
+struct __declspec(uuid("43319e83-387c-448e-881c-7e68fc2e52c4")) texture_replace_data
+{
+	std::mutex mutex;
+	// Maps resources with a queued replacement decode to the generation counter of that request, so that stale results can be discarded after the resource was destroyed
+	std::unordered_map<uint64_t, uint64_t> pending_resources;
+	std::vector<ready_upload> ready_uploads;
+};
+
+struct texture_replace_job
+{
+	device *device = nullptr;
+	uint64_t resource_handle = 0;
+	uint64_t generation = 0;
+	resource_desc desc = {};
+	const std::filesystem::path *replace_path = nullptr;
+};
+
+static std::mutex s_worker_mutex;
+static std::condition_variable s_worker_cond;
+static std::thread s_worker_thread;
+static bool s_worker_exit = false;
+static std::deque<texture_replace_job> s_worker_jobs;
+static const device *s_worker_active_device = nullptr;
+static unsigned int s_device_count = 0;
+static std::atomic<uint64_t> s_next_generation = { 1 };
+
+static void execute_replace_job(texture_replace_job &job)
+{
+	// Decode the replacement image from disk on this worker thread, so that the application never blocks on it
+	ready_upload upload;
+	upload.resource_handle = job.resource_handle;
+	if (!decode_texture_image(job.desc, *job.replace_path, upload.data, upload.pixel_data))
+		return;
+
+	texture_replace_data &data = *job.device->get_private_data<texture_replace_data>();
+
+	const std::unique_lock<std::mutex> lock(data.mutex);
+	if (const auto it = data.pending_resources.find(job.resource_handle);
+		it != data.pending_resources.end() && it->second == job.generation)
+	{
+		data.pending_resources.erase(it);
+		data.ready_uploads.push_back(std::move(upload));
+	}
+	// Otherwise the target resource was destroyed in the meantime (and its handle potentially reused), so the decoded image is simply discarded
+}
+
+static void worker_thread_main()
+{
+	std::unique_lock<std::mutex> lock(s_worker_mutex);
+	while (true)
+	{
+		s_worker_cond.wait(lock, []() { return s_worker_exit || !s_worker_jobs.empty(); });
+		if (s_worker_exit)
+			break;
+
+		texture_replace_job job = std::move(s_worker_jobs.front());
+		s_worker_jobs.pop_front();
+		s_worker_active_device = job.device;
+
+		lock.unlock();
+		execute_replace_job(job);
+		lock.lock();
+
+		s_worker_active_device = nullptr;
+		s_worker_cond.notify_all();
+	}
+}
+
+static void queue_texture_replace(device *device, resource resource, const resource_desc &desc, const subresource_data &data)
+{
+	const uint32_t texture_hash = compute_texture_hash(desc, data);
+
+	// Resolve the lookup entirely from the in-memory index, rather than checking for file existence on disk
+	const auto it = s_replacement_index.find(texture_hash);
+	if (it == s_replacement_index.end())
+		return;
+
+	texture_replace_job job;
+	job.device = device;
+	job.resource_handle = resource.handle;
+	job.desc = desc;
+	job.replace_path = &it->second;
+
+	texture_replace_data &replace_data = *device->get_private_data<texture_replace_data>();
+	{
+		const std::unique_lock<std::mutex> lock(replace_data.mutex);
+		job.generation = s_next_generation++;
+		replace_data.pending_resources[resource.handle] = job.generation;
+	}
+
+	const std::unique_lock<std::mutex> lock(s_worker_mutex);
+	s_worker_jobs.push_back(std::move(job));
+	if (!s_worker_thread.joinable())
+		s_worker_thread = std::thread(worker_thread_main);
+	s_worker_cond.notify_one();
+}
 
 static inline bool filter_texture(device *device, const resource_desc &desc, const subresource_box *box)
 {
@@ -39,21 +180,30 @@ static inline bool filter_texture(device *device, const resource_desc &desc, con
 	return true;
 }
 
-static bool on_create_texture(device *device, resource_desc &desc, subresource_data *initial_data, resource_usage)
+static void on_init_texture(device *device, const resource_desc &desc, const subresource_data *initial_data, resource_usage, resource resource)
 {
-	if (!filter_texture(device, desc, nullptr))
-		return false;
+	if (s_replacement_index.empty() || initial_data == nullptr || !filter_texture(device, desc, nullptr))
+		return;
 
-	return initial_data != nullptr && load_texture_image(desc, *initial_data, s_data_to_delete);
+	// The texture is created with its original data and the replacement is uploaded over it once the worker thread finished decoding, so creation never blocks on disk
+	queue_texture_replace(device, resource, desc, *initial_data);
 }
-static void on_after_create_texture(device *, const resource_desc &, const subresource_data *, resource_usage, resource)
+static void on_destroy_texture(device *device, resource resource)
 {
-	// Free the memory allocated via the 'load_texture_image' call above during the preceding 'create_resource' event that called in the 'on_create_texture' callback
-	s_data_to_delete.clear();
+	texture_replace_data *const data = device->get_private_data<texture_replace_data>();
+	if (data == nullptr || s_replacement_index.empty())
+		return;
+
+	const std::unique_lock<std::mutex> lock(data->mutex);
+	data->pending_resources.erase(resource.handle);
+	for (auto it = data->ready_uploads.begin(); it != data->ready_uploads.end();)
+		it = (it->resource_handle == resource.handle) ? data->ready_uploads.erase(it) : it + 1;
 }
 
 static bool on_copy_texture(command_list *cmd_list, resource src, uint32_t src_subresource, const subresource_box *, resource dst, uint32_t dst_subresource, const subresource_box *dst_box, filter_mode)
 {
+	if (s_replacement_index.empty())
+		return false;
 	if (src_subresource != 0 || src_subresource != dst_subresource)
 		return false; // Ignore copies to mipmap levels other than the base level
 
@@ -67,31 +217,21 @@ static bool on_copy_texture(command_list *cmd_list, resource src, uint32_t src_s
 	if (!filter_texture(device, dst_desc, dst_box))
 		return false;
 
-	bool replace = false;
-
 	subresource_data new_data;
 	if (device->map_texture_region(src, src_subresource, nullptr, map_access::read_only, &new_data))
 	{
-		replace = load_texture_image(dst_desc, new_data, s_data_to_delete);
+		queue_texture_replace(device, dst, dst_desc, new_data);
 
 		device->unmap_texture_region(src, src_subresource);
 	}
 
-	if (replace)
-	{
-		// Update texture with the new data
-		device->update_texture_region(new_data, dst, dst_subresource, dst_box);
-
-		// Free the memory allocated via the 'load_texture_image' call above
-		s_data_to_delete.clear();
-
-		return true; // Texture was already updated now, so skip the original copy command from the application
-	}
-
+	// Let the original copy command proceed, the replacement data is uploaded over it once it finished decoding
 	return false;
 }
 static bool on_update_texture(device *device, const subresource_data &data, resource dst, uint32_t dst_subresource, const subresource_box *dst_box)
 {
+	if (s_replacement_index.empty())
+		return false;
 	if (dst_subresource != 0)
 		return false; // Ignore updates to mipmap levels other than the base level
 
@@ -99,23 +239,14 @@ static bool on_update_texture(device *device, const subresource_data &data, reso
 	if (!filter_texture(device, dst_desc, dst_box))
 		return false;
 
-	subresource_data new_data = data;
-	if (load_texture_image(dst_desc, new_data, s_data_to_delete))
-	{
-		// Update texture with the new data
-		device->update_texture_region(new_data, dst, dst_subresource, dst_box);
-
-		// Free the memory allocated via the 'load_texture_image' call above
-		s_data_to_delete.clear();
-
-		return true; // Texture was already updated now, so skip the original update command from the application
-	}
+	queue_texture_replace(device, dst, dst_desc, data);
 
+	// Let the original update command proceed, the replacement data is uploaded over it once it finished decoding
 	return false;
 }
 
 // Keep track of current resource between 'map_resource' and 'unmap_resource' event invocations
-// It's also thread-local, for similar reasons as 's_data_to_delete' above, just that the two events that could interact with multiple threads here are 'map_texture_region' and 'unmap_texture_region'.
+// It's also thread-local, since multiple threads can map different resources simultaneously, so each thread needs its own copy.
 static thread_local struct {
 	resource res = { 0 };
 	resource_desc desc;
@@ -124,6 +255,8 @@ static thread_local struct {
 
 static void on_map_texture(device *device, resource resource, uint32_t subresource, const subresource_box *box, map_access access, subresource_data *data)
 {
+	if (s_replacement_index.empty())
+		return;
 	if (subresource != 0 || access == map_access::read_only || data == nullptr)
 		return;
 
@@ -135,22 +268,65 @@ static void on_map_texture(device *device, resource resource, uint32_t subresour
 	s_current_mapping.desc = desc;
 	s_current_mapping.data = *data;
 }
-static void on_unmap_texture(device *, resource resource, uint32_t subresource)
+static void on_unmap_texture(device *device, resource resource, uint32_t subresource)
 {
 	if (subresource != 0 || resource != s_current_mapping.res)
 		return;
 
 	s_current_mapping.res = { 0 };
 
-	void *mapped_data = s_current_mapping.data.data;
+	queue_texture_replace(device, resource, s_current_mapping.desc, s_current_mapping.data);
+}
+
+static void on_present(command_queue *, swapchain *swapchain, const rect *, const rect *, uint32_t, const rect *)
+{
+	device *const device = swapchain->get_device();
+	texture_replace_data *const data = device->get_private_data<texture_replace_data>();
+	if (data == nullptr || data->ready_uploads.empty())
+		return;
 
-	if (load_texture_image(s_current_mapping.desc, s_current_mapping.data, s_data_to_delete))
+	// Upload all the replacement images the worker thread finished decoding since the last frame
+	std::vector<ready_upload> uploads;
 	{
-		std::memcpy(mapped_data, s_current_mapping.data.data, s_current_mapping.data.slice_pitch);
+		const std::unique_lock<std::mutex> lock(data->mutex);
+		uploads.swap(data->ready_uploads);
+	}
+
+	for (const ready_upload &upload : uploads)
+		device->update_texture_region(upload.data, resource { upload.resource_handle }, 0, nullptr);
+}
+
+static void on_init_device(device *device)
+{
+	device->create_private_data<texture_replace_data>();
 
-		// Free the memory allocated via the 'load_texture_image' call above
-		s_data_to_delete.clear();
+	const std::unique_lock<std::mutex> lock(s_worker_mutex);
+	s_device_count++;
+}
+static void on_destroy_device(device *device)
+{
+	{
+		std::unique_lock<std::mutex> lock(s_worker_mutex);
+
+		// Remove any pending decode jobs for this device and wait for one that may currently be executing
+		s_worker_jobs.erase(std::remove_if(s_worker_jobs.begin(), s_worker_jobs.end(),
+			[device](const texture_replace_job &job) { return job.device == device; }), s_worker_jobs.end());
+		s_worker_cond.wait(lock, [device]() { return s_worker_active_device != device; });
+
+		// Shut the worker thread down with the last device, since joining it during DLL unload would deadlock on the loader lock
+		if (--s_device_count == 0 && s_worker_thread.joinable())
+		{
+			s_worker_exit = true;
+			s_worker_cond.notify_all();
+			lock.unlock();
+			s_worker_thread.join();
+			lock.lock();
+			s_worker_thread = std::thread();
+			s_worker_exit = false;
+		}
 	}
+
+	device->destroy_private_data<texture_replace_data>();
 }
 
 extern "C" __declspec(dllexport) const char *NAME = "Texture Replace";
@@ -163,12 +339,16 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 	case DLL_PROCESS_ATTACH:
 		if (!reshade::register_addon(hModule))
 			return FALSE;
-		reshade::register_event<reshade::addon_event::create_resource>(on_create_texture);
-		reshade::register_event<reshade::addon_event::init_resource>(on_after_create_texture);
+		build_replacement_index();
+		reshade::register_event<reshade::addon_event::init_device>(on_init_device);
+		reshade::register_event<reshade::addon_event::destroy_device>(on_destroy_device);
+		reshade::register_event<reshade::addon_event::init_resource>(on_init_texture);
+		reshade::register_event<reshade::addon_event::destroy_resource>(on_destroy_texture);
 		reshade::register_event<reshade::addon_event::copy_texture_region>(on_copy_texture);
 		reshade::register_event<reshade::addon_event::update_texture_region>(on_update_texture);
 		reshade::register_event<reshade::addon_event::map_texture_region>(on_map_texture);
 		reshade::register_event<reshade::addon_event::unmap_texture_region>(on_unmap_texture);
+		reshade::register_event<reshade::addon_event::present>(on_present);
 		break;
 	case DLL_PROCESS_DETACH:
 		reshade::unregister_addon(hModule);
@@ -5,6 +5,7 @@
 
 #include <imgui.h>
 #include <reshade.hpp>
+#include <atomic>
 #include <vector>
 #include <shared_mutex>
 #include <unordered_map>
@@ -12,6 +13,7 @@
 #include <cstring> // std::strcmp
 #include <algorithm> // std::find_if, std::remove, std::sort
 #include <Unknwn.h>
+#include <d3dcompiler.h> // Only used for the 'pD3DCompile' and 'ID3DBlob' declarations, the compiler DLL itself is loaded dynamically
 
 using namespace reshade::api;
 
@@ -25,6 +27,23 @@ static unsigned int s_use_aspect_ratio_heuristics = 1;
 // Enable or disable the format check from 'check_depth_format' in the detection heuristic
 static unsigned int s_use_format_filtering = 0;
 static unsigned int s_custom_resolution_filtering[2] = {};
+// Enable or disable gathering vertex statistics on the GPU via pipeline statistics queries, instead of accumulating them on the CPU for every draw call
+static unsigned int s_gpu_statistics = 0;
+// Choose how multisampled depth-stencils are resolved by the compute shader fallback (0 = maximum over all samples, 1 = first sample only)
+static unsigned int s_msaa_resolve_mode = 0;
+
+// Fingerprint of the depth-stencil that was selected in a previous session, used to fast-match it again at startup without waiting for the full detection heuristics (see 'check_fingerprint' below)
+struct depth_fingerprint
+{
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t format = 0;
+	uint32_t drawcalls = 0;
+	uint32_t vertices = 0;
+};
+static depth_fingerprint s_fingerprint;
+// Set while the persisted fingerprint confirms the current selection, which enables a reduced per-draw tracking path (see 'on_draw' below)
+static bool s_fingerprint_confirmed = false;
 
 enum class clear_op : uint8_t
 {
@@ -46,6 +65,22 @@ struct clear_stats : public draw_stats
 	bool copied_during_frame = false;
 };
 
+// Layout of the results of a query of type 'query_type::pipeline_statistics'
+struct pipeline_statistics
+{
+	uint64_t ia_vertices;
+	uint64_t ia_primitives;
+	uint64_t vs_invocations;
+	uint64_t gs_invocations;
+	uint64_t gs_primitives;
+	uint64_t invocations;
+	uint64_t primitives;
+	uint64_t ps_invocations;
+	uint64_t hs_invocations;
+	uint64_t ds_invocations;
+	uint64_t cs_invocations;
+};
+
 struct depth_stencil_frame_stats
 {
 	draw_stats total_stats;
@@ -72,6 +107,12 @@ struct __declspec(uuid("43319e83-387c-448e-881c-7e68fc2e52c4")) state_tracking
 	std::unordered_map<resource, depth_stencil_frame_stats, resource_hash> counters_per_used_depth_stencil;
 	bool first_draw_since_bind = true;
 	draw_stats best_copy_stats;
+	// Slot in the query heap of the currently open pipeline statistics query, or the maximum value when there is none (see 'end_statistics_span')
+	uint32_t current_statistics_slot = std::numeric_limits<uint32_t>::max();
+	// Draw call counts since the currently open pipeline statistics query was begun
+	draw_stats current_statistics_span_stats;
+	// List of pipeline statistics queries that were ended in this command list, together with the depth-stencil they covered
+	std::vector<std::pair<resource, uint32_t>> statistics_queries;
 
 	state_tracking(bool is_queue) : is_queue(is_queue)
 	{
@@ -84,12 +125,16 @@ struct __declspec(uuid("43319e83-387c-448e-881c-7e68fc2e52c4")) state_tracking
 		best_copy_stats = { 0, 0 };
 		counters_per_used_depth_stencil.clear();
 		current_depth_stencil = { 0 };
+		current_statistics_slot = std::numeric_limits<uint32_t>::max();
+		current_statistics_span_stats = { 0, 0 };
+		statistics_queries.clear();
 	}
 	void reset_on_present()
 	{
 		assert(is_queue);
 		best_copy_stats = { 0, 0 };
 		counters_per_used_depth_stencil.clear();
+		statistics_queries.clear();
 	}
 
 	void merge(const state_tracking &source)
@@ -100,6 +145,9 @@ struct __declspec(uuid("43319e83-387c-448e-881c-7e68fc2e52c4")) state_tracking
 		if (source.best_copy_stats.vertices >= best_copy_stats.vertices)
 			best_copy_stats = source.best_copy_stats;
 
+		// Take over the pipeline statistics queries recorded in the executed command list, so that their results are read back after the frame finished
+		statistics_queries.insert(statistics_queries.end(), source.statistics_queries.begin(), source.statistics_queries.end());
+
 		if (source.counters_per_used_depth_stencil.empty())
 			return;
 
@@ -159,6 +207,10 @@ struct depth_stencil_backup
 	// Set to zero for automatic detection, otherwise will use the clear operation at the specific index within a frame
 	uint32_t force_clear_index = 0;
 	uint32_t current_clear_index = 0;
+
+	// Views used by the compute shader resolve fallback for multisampled depth-stencils (see 'resolve_depth_via_compute' below)
+	resource_view resolve_src_view = { 0 };
+	resource_view resolve_dest_view = { 0 };
 };
 
 struct depth_stencil_resource
@@ -183,6 +235,134 @@ struct __declspec(uuid("e006e162-33ac-4b9f-b10f-0e15335c7bdb")) generic_depth_de
 	// List of depth-stencils that should be tracked throughout each frame and potentially be backed up during clear operations
 	std::vector<depth_stencil_backup> depth_stencil_backups;
 
+	// Depth-stencil whose fingerprint is persisted once it stayed selected for a while, together with the frame its selection was first seen in (see 'on_begin_render_effects' below)
+	resource fingerprint_candidate = { 0 };
+	uint64_t fingerprint_candidate_since = 0;
+
+	// Query heap used to count vertices on the GPU when the GPU statistics mode is enabled (stays zero when the device does not support pipeline statistics queries)
+	query_heap statistics_heap = { 0 };
+	std::atomic<uint32_t> next_statistics_slot = { 0 };
+	// Pipeline statistics queries recorded in previous frames, kept around until their results should be available for readback without stalling
+	std::vector<std::pair<resource, uint32_t>> pending_statistics_queries[4];
+
+	// Compute pipelines used to resolve multisampled depth-stencils on devices that do not support 'device_caps::resolve_depth_stencil' (currently D3D11 only)
+	// The first pipeline takes the maximum over all samples, the second one takes the first sample only
+	pipeline_layout msaa_resolve_layout = { 0 };
+	pipeline msaa_resolve_pipelines[2] = {};
+
+	// Number of slots in the statistics query heap (slots are allocated from a ring, so this has to be large enough that a slot is not reused before its result was read back a couple of frames later)
+	static constexpr uint32_t num_statistics_slots = 4096;
+
+	uint32_t allocate_statistics_slot()
+	{
+		return next_statistics_slot++ % num_statistics_slots;
+	}
+
+	void create_statistics_heap(device *device)
+	{
+		if (statistics_heap != 0)
+			return;
+
+		if (!device->create_query_heap(query_type::pipeline_statistics, num_statistics_slots, &statistics_heap))
+			reshade::log::message(reshade::log::level::warning, "Failed to create pipeline statistics query heap! Falling back to gathering statistics on the CPU.");
+	}
+
+	void create_msaa_resolve_pipelines(device *device)
+	{
+		if (msaa_resolve_pipelines[0] != 0)
+			return;
+
+		// Only needed in D3D11, since all other modern APIs can resolve depth-stencil resources natively (see 'device_caps::resolve_depth_stencil')
+		if (device->get_api() != device_api::d3d11)
+			return;
+
+		// Load the shader compiler on demand, to compile the resolve shader at runtime rather than shipping precompiled shader binaries
+		const HMODULE compiler_module = LoadLibraryW(L"d3dcompiler_47.dll");
+		if (compiler_module == nullptr)
+			return;
+
+		const auto D3DCompile = reinterpret_cast<pD3DCompile>(GetProcAddress(compiler_module, "D3DCompile"));
+		if (D3DCompile == nullptr)
+		{
+			FreeLibrary(compiler_module);
+			return;
+		}
+
+		const char shader_code[] =
+			"Texture2DMS<float> src : register(t0);\n"
+			"RWTexture2D<float> dest : register(u0);\n"
+			"[numthreads(8, 8, 1)]\n"
+			"void resolve_max(uint3 id : SV_DispatchThreadID)\n"
+			"{\n"
+			"	uint width, height, samples;\n"
+			"	src.GetDimensions(width, height, samples);\n"
+			"	if (id.x >= width || id.y >= height)\n"
+			"		return;\n"
+			"	float depth = src.Load(id.xy, 0);\n"
+			"	for (uint s = 1; s < samples; ++s)\n"
+			"		depth = max(depth, src.Load(id.xy, s));\n"
+			"	dest[id.xy] = depth;\n"
+			"}\n"
+			"[numthreads(8, 8, 1)]\n"
+			"void resolve_first(uint3 id : SV_DispatchThreadID)\n"
+			"{\n"
+			"	uint width, height, samples;\n"
+			"	src.GetDimensions(width, height, samples);\n"
+			"	if (id.x >= width || id.y >= height)\n"
+			"		return;\n"
+			"	dest[id.xy] = src.Load(id.xy, 0);\n"
+			"}\n";
+
+		const descriptor_range src_range = { 0, 0, 0, 1, shader_stage::all_compute, 1, descriptor_type::shader_resource_view };
+		const descriptor_range dest_range = { 0, 0, 0, 1, shader_stage::all_compute, 1, descriptor_type::unordered_access_view };
+		const pipeline_layout_param layout_params[2] = { src_range, dest_range };
+
+		if (device->create_pipeline_layout(static_cast<uint32_t>(std::size(layout_params)), layout_params, &msaa_resolve_layout))
+		{
+			const char *const entry_points[2] = { "resolve_max", "resolve_first" };
+
+			for (size_t mode = 0; mode < std::size(msaa_resolve_pipelines); ++mode)
+			{
+				ID3DBlob *compiled = nullptr;
+				if (FAILED(D3DCompile(shader_code, sizeof(shader_code) - 1, nullptr, nullptr, nullptr, entry_points[mode], "cs_5_0", 0, 0, &compiled, nullptr)))
+					break;
+
+				shader_desc resolve_shader_desc = {};
+				resolve_shader_desc.code = compiled->GetBufferPointer();
+				resolve_shader_desc.code_size = compiled->GetBufferSize();
+
+				const pipeline_subobject subobjects[] = { { pipeline_subobject_type::compute_shader, 1, &resolve_shader_desc } };
+
+				device->create_pipeline(msaa_resolve_layout, static_cast<uint32_t>(std::size(subobjects)), subobjects, &msaa_resolve_pipelines[mode]);
+
+				compiled->Release();
+			}
+		}
+
+		FreeLibrary(compiler_module);
+
+		if (msaa_resolve_pipelines[0] == 0 || msaa_resolve_pipelines[1] == 0)
+		{
+			destroy_msaa_resolve_pipelines(device);
+
+			reshade::log::message(reshade::log::level::warning, "Failed to create compute pipelines for multisampled depth-stencil resolve! Multisampled depth buffers will be unavailable.");
+		}
+	}
+
+	void destroy_msaa_resolve_pipelines(device *device)
+	{
+		for (pipeline &resolve_pipeline : msaa_resolve_pipelines)
+		{
+			if (resolve_pipeline != 0)
+				device->destroy_pipeline(resolve_pipeline);
+			resolve_pipeline = { 0 };
+		}
+
+		if (msaa_resolve_layout != 0)
+			device->destroy_pipeline_layout(msaa_resolve_layout);
+		msaa_resolve_layout = { 0 };
+	}
+
 	depth_stencil_backup *find_depth_stencil_backup(resource resource)
 	{
 		for (depth_stencil_backup &backup : depth_stencil_backups)
@@ -220,14 +400,19 @@ struct __declspec(uuid("e006e162-33ac-4b9f-b10f-0e15335c7bdb")) generic_depth_de
 		desc.heap = memory_heap::gpu_only;
 		desc.usage = resource_usage::shader_resource | resource_usage::copy_dest;
 
+		// When native depth-stencil resolve is not supported, the resolve is instead done with a compute shader writing to the backup texture (see 'resolve_depth_via_compute' below)
+		const bool compute_resolve = desc.texture.samples > 1 && !device->check_capability(device_caps::resolve_depth_stencil);
+
 		if (desc.texture.samples > 1)
 		{
 			desc.texture.samples = 1;
-			desc.usage |= resource_usage::resolve_dest;
+			desc.usage |= compute_resolve ? resource_usage::unordered_access : resource_usage::resolve_dest;
 		}
 
 		if (api == device_api::d3d9)
 			desc.texture.format = format::r32_float; // D3DFMT_R32F, since INTZ does not support D3DUSAGE_RENDERTARGET which is required for copying
+		else if (compute_resolve)
+			desc.texture.format = format::r32_float; // The compute shader resolve writes through an unordered access view, which cannot be created with a typeless or depth-stencil format
 		// Use depth format as-is in OpenGL and Vulkan, since those are valid for shader resource views there
 		else if (api != device_api::opengl && api != device_api::vulkan)
 			desc.texture.format = format_to_typeless(desc.texture.format);
@@ -284,6 +469,19 @@ struct __declspec(uuid("e006e162-33ac-4b9f-b10f-0e15335c7bdb")) generic_depth_de
 		depth_stencil_backup &backup = *it;
 		backup.depth_stencil_resource = { 0 };
 
+		// Destroy the views used by the compute shader resolve fallback, since they reference the depth-stencil resource which may be destroyed after this (and the backup texture may be revived for a different depth-stencil)
+		// These views only exist in D3D11, where it is safe to release them immediately, because any in-flight command lists hold their own reference
+		if (backup.resolve_src_view != 0)
+		{
+			device->destroy_resource_view(backup.resolve_src_view);
+			backup.resolve_src_view = { 0 };
+		}
+		if (backup.resolve_dest_view != 0)
+		{
+			device->destroy_resource_view(backup.resolve_dest_view);
+			backup.resolve_dest_view = { 0 };
+		}
+
 		// Do not destroy backup texture immediately since it may still be referenced by a command list that is in flight or was prerecorded
 		// Instead mark it for delayed destruction in the future
 		backup.destroy_after_frame = frame_index + 50; // Destroy after 50 frames
@@ -297,6 +495,84 @@ struct __declspec(uuid("e006e162-33ac-4b9f-b10f-0e15335c7bdb")) generic_depth_de
 	}
 };
 
+// Checks whether depth information can be extracted from a multisampled depth-stencil on this device, either through a native resolve or the compute shader fallback
+static bool check_msaa_resolve_support(device *device)
+{
+	if (device->check_capability(device_caps::resolve_depth_stencil))
+		return true;
+
+	const auto &device_data = device->get_private_data<generic_depth_device_data>();
+	return std::addressof(device_data) != nullptr && device_data.msaa_resolve_pipelines[0] != 0;
+}
+
+// Resolves a multisampled depth-stencil into the associated backup texture with a compute shader, for devices that do not support 'device_caps::resolve_depth_stencil'
+static bool resolve_depth_via_compute(command_list *cmd_list, generic_depth_device_data &device_data, depth_stencil_backup &backup, resource depth_stencil, const resource_desc &desc, resource_usage old_state)
+{
+	device *const device = cmd_list->get_device();
+
+	const pipeline resolve_pipeline = device_data.msaa_resolve_pipelines[s_msaa_resolve_mode < 2 ? s_msaa_resolve_mode : 0];
+	if (resolve_pipeline == 0)
+		return false;
+
+	// Create the views used by the resolve shader on first use and cache them with the backup, since both the depth-stencil and the backup texture usually stay the same between frames
+	if (backup.resolve_src_view == 0 &&
+		!device->create_resource_view(depth_stencil, resource_usage::shader_resource, resource_view_desc(resource_view_type::texture_2d_multisample, format_to_default_typed(desc.texture.format), 0, 1, 0, 1), &backup.resolve_src_view))
+		return false;
+	if (backup.resolve_dest_view == 0 &&
+		!device->create_resource_view(backup.backup_texture, resource_usage::unordered_access, resource_view_desc(format::r32_float), &backup.resolve_dest_view))
+		return false;
+
+	cmd_list->barrier(depth_stencil, old_state, resource_usage::shader_resource);
+	cmd_list->barrier(backup.backup_texture, resource_usage::copy_dest, resource_usage::unordered_access);
+
+	cmd_list->bind_pipeline(pipeline_stage::all_compute, resolve_pipeline);
+	cmd_list->push_descriptors(shader_stage::all_compute, device_data.msaa_resolve_layout, 0, descriptor_table_update { {}, 0, 0, 1, descriptor_type::shader_resource_view, &backup.resolve_src_view });
+	cmd_list->push_descriptors(shader_stage::all_compute, device_data.msaa_resolve_layout, 1, descriptor_table_update { {}, 0, 0, 1, descriptor_type::unordered_access_view, &backup.resolve_dest_view });
+	cmd_list->dispatch((desc.texture.width + 7) / 8, (desc.texture.height + 7) / 8, 1);
+
+	cmd_list->barrier(backup.backup_texture, resource_usage::unordered_access, resource_usage::copy_dest);
+	cmd_list->barrier(depth_stencil, resource_usage::shader_resource, old_state);
+
+	return true;
+}
+
+static void end_statistics_span(command_list *cmd_list, state_tracking &state)
+{
+	const bool query_span = state.current_statistics_slot != std::numeric_limits<uint32_t>::max();
+
+	// Spans accumulated on the CPU via the fingerprint fast path in 'on_draw' below do not have a query associated with them
+	if (!query_span && state.current_statistics_span_stats.drawcalls == 0)
+		return;
+
+	if (query_span)
+	{
+		auto &device_data = cmd_list->get_device()->get_private_data<generic_depth_device_data>();
+
+		cmd_list->end_query(device_data.statistics_heap, query_type::pipeline_statistics, state.current_statistics_slot);
+	}
+
+	// If this is queue state (happens if this is a immediate command list), need to protect access to it, since another thread may be in a present call, which can reset it
+	std::shared_lock<std::shared_mutex> lock(s_mutex, std::defer_lock);
+	if (state.is_queue)
+		lock.lock();
+
+	// Fold the draw call counts of this binding span into the statistics of the depth-stencil it covered (a single map access per span, rather than one per draw call)
+	// The vertex count stays zero for query spans, since it is filled in from the query result a couple of frames later instead (see 'on_present' below)
+	depth_stencil_frame_stats &counters = state.counters_per_used_depth_stencil[state.current_depth_stencil];
+	counters.total_stats.vertices += state.current_statistics_span_stats.vertices;
+	counters.total_stats.drawcalls += state.current_statistics_span_stats.drawcalls;
+	counters.total_stats.drawcalls_indirect += state.current_statistics_span_stats.drawcalls_indirect;
+	counters.current_stats.vertices += state.current_statistics_span_stats.vertices;
+	counters.current_stats.drawcalls += state.current_statistics_span_stats.drawcalls;
+	counters.current_stats.drawcalls_indirect += state.current_statistics_span_stats.drawcalls_indirect;
+
+	if (query_span)
+		state.statistics_queries.emplace_back(state.current_depth_stencil, state.current_statistics_slot);
+
+	state.current_statistics_slot = std::numeric_limits<uint32_t>::max();
+	state.current_statistics_span_stats = { 0, 0 };
+}
+
 static bool check_depth_format(format format)
 {
 	switch (s_use_format_filtering)
@@ -338,6 +614,18 @@ static bool check_aspect_ratio(float width_to_check, float height_to_check, floa
 	return std::abs(aspect_ratio_delta) <= 0.1f && ((w_ratio <= 1.85f && w_ratio >= 0.5f && h_ratio <= 1.85f && h_ratio >= 0.5f) ||
 		(s_use_aspect_ratio_heuristics == 2 && std::modf(w_ratio, &w_ratio) <= 0.02f && std::modf(h_ratio, &h_ratio) <= 0.02f));
 }
+// Checks whether a depth-stencil matches the fingerprint persisted from a previous session
+static bool check_fingerprint(const resource_desc &desc, const depth_stencil_frame_stats &snapshot)
+{
+	if (s_fingerprint.width == 0 || s_fingerprint.height == 0)
+		return false; // No fingerprint was persisted yet
+
+	if (desc.texture.width != s_fingerprint.width || desc.texture.height != s_fingerprint.height || static_cast<uint32_t>(desc.texture.format) != s_fingerprint.format)
+		return false;
+
+	// The draw statistics signature is coarse by nature, so only require the workload to be in the same ballpark, to account for scene variation between sessions
+	return snapshot.total_stats.drawcalls >= (s_fingerprint.drawcalls / 4) && snapshot.total_stats.vertices >= (s_fingerprint.vertices / 4);
+}
 
 static void on_clear_depth_impl(command_list *cmd_list, state_tracking &state, resource depth_stencil, clear_op op)
 {
@@ -421,11 +709,19 @@ static void on_clear_depth_impl(command_list *cmd_list, state_tracking &state, r
 			const resource_desc desc = device->get_resource_desc(depth_stencil);
 			if (desc.texture.samples > 1)
 			{
-				assert(device->check_capability(device_caps::resolve_depth_stencil) && (desc.usage & resource_usage::resolve_source) != 0);
+				if (device->check_capability(device_caps::resolve_depth_stencil))
+				{
+					assert((desc.usage & resource_usage::resolve_source) != 0);
 
-				cmd_list->barrier(depth_stencil, resource_usage::depth_stencil_write, resource_usage::resolve_source);
-				cmd_list->resolve_texture_region(depth_stencil, 0, nullptr, depth_stencil_backup->backup_texture, 0, 0, 0, 0, format_to_default_typed(desc.texture.format));
-				cmd_list->barrier(depth_stencil, resource_usage::resolve_source, resource_usage::depth_stencil_write);
+					cmd_list->barrier(depth_stencil, resource_usage::depth_stencil_write, resource_usage::resolve_source);
+					cmd_list->resolve_texture_region(depth_stencil, 0, nullptr, depth_stencil_backup->backup_texture, 0, 0, 0, 0, format_to_default_typed(desc.texture.format));
+					cmd_list->barrier(depth_stencil, resource_usage::resolve_source, resource_usage::depth_stencil_write);
+				}
+				else
+				{
+					// This disturbs the compute pipeline state of the application mid-frame, which is acceptable since draw calls do not depend on it and applications rarely interleave dispatches with depth rendering
+					resolve_depth_via_compute(cmd_list, device->get_private_data<generic_depth_device_data>(), *depth_stencil_backup, depth_stencil, desc, resource_usage::depth_stencil_write);
+				}
 			}
 			else
 			{
@@ -466,8 +762,26 @@ static void on_init_device(device *device)
 	reshade::get_config_value(nullptr, "DEPTH", "FilterResolutionWidth", s_custom_resolution_filtering[0]);
 	reshade::get_config_value(nullptr, "DEPTH", "FilterResolutionHeight", s_custom_resolution_filtering[1]);
 
+	reshade::get_config_value(nullptr, "DEPTH", "GpuStatistics", s_gpu_statistics);
+
+	reshade::get_config_value(nullptr, "DEPTH", "MsaaResolveMode", s_msaa_resolve_mode);
+
+	reshade::get_config_value(nullptr, "DEPTH", "FingerprintWidth", s_fingerprint.width);
+	reshade::get_config_value(nullptr, "DEPTH", "FingerprintHeight", s_fingerprint.height);
+	reshade::get_config_value(nullptr, "DEPTH", "FingerprintFormat", s_fingerprint.format);
+	reshade::get_config_value(nullptr, "DEPTH", "FingerprintDrawCalls", s_fingerprint.drawcalls);
+	reshade::get_config_value(nullptr, "DEPTH", "FingerprintVertices", s_fingerprint.vertices);
+
 	if (s_use_aspect_ratio_heuristics > 4)
 		s_use_aspect_ratio_heuristics = 1;
+	if (s_msaa_resolve_mode > 1)
+		s_msaa_resolve_mode = 0;
+
+	if (s_gpu_statistics)
+		device->get_private_data<generic_depth_device_data>().create_statistics_heap(device);
+
+	// Create the compute pipelines used to resolve multisampled depth-stencils where native resolve is not supported (no-op on all devices other than D3D11)
+	device->get_private_data<generic_depth_device_data>().create_msaa_resolve_pipelines(device);
 }
 static void on_init_command_list(command_list *cmd_list)
 {
@@ -493,7 +807,19 @@ static void on_destroy_device(device *device)
 
 	// Destroy any remaining resources
 	for (depth_stencil_backup &backup : device_data.depth_stencil_backups)
+	{
+		if (backup.resolve_src_view != 0)
+			device->destroy_resource_view(backup.resolve_src_view);
+		if (backup.resolve_dest_view != 0)
+			device->destroy_resource_view(backup.resolve_dest_view);
+
 		device->destroy_resource(backup.backup_texture);
+	}
+
+	device_data.destroy_msaa_resolve_pipelines(device);
+
+	if (device_data.statistics_heap != 0)
+		device->destroy_query_heap(device_data.statistics_heap);
 
 	device->destroy_private_data<generic_depth_device_data>();
 }
@@ -530,8 +856,8 @@ static bool on_create_resource(device *device, resource_desc &desc, subresource_
 	if (desc.type != resource_type::surface && desc.type != resource_type::texture_2d)
 		return false; // Skip resources that are not 2D textures
 
-	if ((desc.texture.samples > 1 && !device->check_capability(device_caps::resolve_depth_stencil)) || (desc.usage & resource_usage::depth_stencil) == 0 || desc.texture.format == format::s8_uint)
-		return false; // Skip multisampled textures and resources that are not used as depth buffers
+	if ((desc.texture.samples > 1 && !check_msaa_resolve_support(device)) || (desc.usage & resource_usage::depth_stencil) == 0 || desc.texture.format == format::s8_uint)
+		return false; // Skip multisampled textures (unless they can be resolved) and resources that are not used as depth buffers
 
 	switch (device->get_api())
 	{
@@ -578,8 +904,8 @@ static bool on_create_resource_view(device *device, resource resource, resource_
 		return false;
 
 	const resource_desc texture_desc = device->get_resource_desc(resource);
-	// Only non-multisampled textures where modified, so skip all others
-	if ((texture_desc.texture.samples > 1 && !device->check_capability(device_caps::resolve_depth_stencil)) || (texture_desc.usage & resource_usage::depth_stencil) == 0)
+	// Only depth-stencil textures with resolve support where modified, so skip all others
+	if ((texture_desc.texture.samples > 1 && !check_msaa_resolve_support(device)) || (texture_desc.usage & resource_usage::depth_stencil) == 0)
 		return false;
 
 	switch (usage_type)
@@ -595,7 +921,9 @@ static bool on_create_resource_view(device *device, resource resource, resource_
 	// Only need to set the rest of the members if the application did not pass in a valid description already
 	if (desc.type == resource_view_type::unknown)
 	{
-		desc.type = texture_desc.texture.depth_or_layers > 1 ? resource_view_type::texture_2d_array : resource_view_type::texture_2d;
+		desc.type = texture_desc.texture.samples > 1 ?
+			(texture_desc.texture.depth_or_layers > 1 ? resource_view_type::texture_2d_multisample_array : resource_view_type::texture_2d_multisample) :
+			(texture_desc.texture.depth_or_layers > 1 ? resource_view_type::texture_2d_array : resource_view_type::texture_2d);
 		desc.texture.first_level = 0;
 		desc.texture.level_count = (usage_type == resource_usage::shader_resource) ? UINT32_MAX : 1;
 		desc.texture.first_layer = 0;
@@ -641,6 +969,33 @@ static bool on_draw(command_list *cmd_list, uint32_t vertices, uint32_t instance
 	if (state.current_depth_stencil == 0)
 		return false; // This is a draw call with no depth-stencil bound
 
+	// When GPU statistics are enabled, let a pipeline statistics query count the vertices of this binding span instead, so that the per-draw work is reduced to a counter increment
+	// This is not used together with the clear heuristics, since those need accurate vertex counts within the frame, whereas query results only become available a couple of frames later
+	if (s_gpu_statistics && s_preserve_depth_buffers == 0)
+	{
+		auto &device_data = cmd_list->get_device()->get_private_data<generic_depth_device_data>();
+		if (device_data.statistics_heap != 0)
+		{
+			if (state.current_statistics_slot == std::numeric_limits<uint32_t>::max())
+			{
+				state.current_statistics_slot = device_data.allocate_statistics_slot();
+				cmd_list->begin_query(device_data.statistics_heap, query_type::pipeline_statistics, state.current_statistics_slot);
+			}
+
+			state.current_statistics_span_stats.drawcalls += 1;
+			return false;
+		}
+	}
+
+	// While the persisted fingerprint confirms the current selection, exact per-draw tracking is unnecessary, so only accumulate statistics per binding span (folded into the per-depth-stencil counters in 'end_statistics_span')
+	// This is not used together with the clear heuristics, since those need per-clear statistics and viewport tracking within the frame
+	if (s_fingerprint_confirmed && s_preserve_depth_buffers == 0)
+	{
+		state.current_statistics_span_stats.vertices += vertices * instances;
+		state.current_statistics_span_stats.drawcalls += 1;
+		return false;
+	}
+
 	// Check if this draw call likely represets a fullscreen rectangle (two triangles), which would clear the depth-stencil
 	const bool fullscreen_draw = vertices == 6 && instances == 1;
 	if (fullscreen_draw &&
@@ -684,6 +1039,30 @@ static bool on_draw_indirect(command_list *cmd_list, indirect_command type, reso
 	if (state.current_depth_stencil == 0)
 		return false; // This is a draw call with no depth-stencil bound
 
+	if (s_gpu_statistics && s_preserve_depth_buffers == 0)
+	{
+		auto &device_data = cmd_list->get_device()->get_private_data<generic_depth_device_data>();
+		if (device_data.statistics_heap != 0)
+		{
+			if (state.current_statistics_slot == std::numeric_limits<uint32_t>::max())
+			{
+				state.current_statistics_slot = device_data.allocate_statistics_slot();
+				cmd_list->begin_query(device_data.statistics_heap, query_type::pipeline_statistics, state.current_statistics_slot);
+			}
+
+			state.current_statistics_span_stats.drawcalls += draw_count;
+			state.current_statistics_span_stats.drawcalls_indirect += draw_count;
+			return false;
+		}
+	}
+
+	if (s_fingerprint_confirmed && s_preserve_depth_buffers == 0)
+	{
+		state.current_statistics_span_stats.drawcalls += draw_count;
+		state.current_statistics_span_stats.drawcalls_indirect += draw_count;
+		return false;
+	}
+
 	// If this is queue state (happens if this is a immediate command list), need to protect access to it, since another thread may be in a present call, which can reset it
 	std::shared_lock<std::shared_mutex> lock(s_mutex, std::defer_lock);
 	if (state.is_queue)
@@ -715,6 +1094,9 @@ static void on_bind_depth_stencil(command_list *cmd_list, uint32_t, const resour
 
 	if (depth_stencil != state.current_depth_stencil)
 	{
+		// End any open pipeline statistics query, so that its result is attributed to the depth-stencil that was bound while it was recorded
+		end_statistics_span(cmd_list, state);
+
 		if (depth_stencil != 0)
 			state.first_draw_since_bind = true;
 
@@ -760,6 +1142,7 @@ static void on_begin_render_pass_with_depth_stencil(command_list *cmd_list, uint
 
 		// Prevent 'on_bind_depth_stencil' from copying depth buffer again
 		auto &state = cmd_list->get_private_data<state_tracking>();
+		end_statistics_span(cmd_list, state);
 		state.current_depth_stencil = { 0 };
 	}
 
@@ -768,11 +1151,26 @@ static void on_begin_render_pass_with_depth_stencil(command_list *cmd_list, uint
 	on_bind_depth_stencil(cmd_list, 0, nullptr, depth_stencil_desc != nullptr ? depth_stencil_desc->view : resource_view {});
 }
 
+static void on_end_render_pass(command_list *cmd_list)
+{
+	auto &state = cmd_list->get_private_data<state_tracking>();
+
+	// Queries cannot span render pass boundaries in Vulkan, so have to end any open one before the render pass does
+	end_statistics_span(cmd_list, state);
+}
+
 static void on_reset(command_list *cmd_list)
 {
 	auto &target_state = cmd_list->get_private_data<state_tracking>();
 	target_state.reset();
 }
+static void on_close(command_list *cmd_list)
+{
+	auto &target_state = cmd_list->get_private_data<state_tracking>();
+
+	// Queries have to be ended in the same command list they were begun in
+	end_statistics_span(cmd_list, target_state);
+}
 static void on_execute_primary(command_queue *queue, command_list *cmd_list)
 {
 	// Skip merging state when this execution event is just the immediate command list getting flushed
@@ -816,6 +1214,17 @@ static void on_present(command_queue *, swapchain *swapchain, const rect *, cons
 	device *const device = swapchain->get_device();
 	auto &device_data = device->get_private_data<generic_depth_device_data>();
 
+	// End any pipeline statistics query still open on an immediate command list, before the lock below is acquired ('end_statistics_span' acquires it in shared mode itself)
+	if (device_data.statistics_heap != 0)
+	{
+		for (command_queue *const queue : device_data.queues)
+		{
+			auto &state = queue->get_private_data<state_tracking>();
+			if (state.current_statistics_slot != std::numeric_limits<uint32_t>::max())
+				end_statistics_span(queue->get_immediate_command_list(), state);
+		}
+	}
+
 	const std::unique_lock<std::shared_mutex> lock(s_mutex);
 
 	state_tracking queue_state(true);
@@ -865,6 +1274,26 @@ static void on_present(command_queue *, swapchain *swapchain, const rect *, cons
 			info.first_used_in_frame = device_data.frame_index;
 	}
 
+	if (device_data.statistics_heap != 0)
+	{
+		// Read back the vertex counts of the pipeline statistics queries recorded a couple of frames ago, for which the GPU should have finished by now, and fold them into the statistics gathered this frame
+		// This means the vertex counts used by the detection heuristic lag behind by those frames, which is fine, since the main depth-stencil rarely changes from one frame to the next
+		std::vector<std::pair<resource, uint32_t>> &pending_queries = device_data.pending_statistics_queries[device_data.frame_index % std::size(device_data.pending_statistics_queries)];
+
+		for (const auto &[depth_stencil_handle, query_slot] : pending_queries)
+		{
+			pipeline_statistics results;
+			if (!device->get_query_heap_results(device_data.statistics_heap, query_slot, 1, &results, sizeof(results)))
+				continue;
+
+			if (const auto it = device_data.depth_stencil_resources.find(depth_stencil_handle);
+				it != device_data.depth_stencil_resources.end())
+				it->second.last_counters.total_stats.vertices += static_cast<uint32_t>(results.ia_vertices);
+		}
+
+		pending_queries = std::move(queue_state.statistics_queries);
+	}
+
 	// Destroy resources that were enqueued for delayed destruction and have reached the targeted number of passed frames
 	for (auto it = device_data.depth_stencil_backups.begin(); it != device_data.depth_stencil_backups.end();)
 	{
@@ -914,8 +1343,8 @@ static void on_begin_render_effects(effect_runtime *runtime, command_list *cmd_l
 			continue; // Skip resources not used this frame or those that only just appeared for the first time
 
 		const resource_desc desc = device->get_resource_desc(resource);
-		if (desc.texture.samples > 1 && !device->check_capability(device_caps::resolve_depth_stencil))
-			continue; // Ignore multisampled textures, since they would need to be resolved first
+		if (desc.texture.samples > 1 && !check_msaa_resolve_support(device))
+			continue; // Ignore multisampled textures when there is no way to resolve them
 
 		if (s_use_format_filtering && !check_depth_format(desc.texture.format))
 			continue;
@@ -923,6 +1352,16 @@ static void on_begin_render_effects(effect_runtime *runtime, command_list *cmd_l
 			continue; // Not a good fit
 
 		const depth_stencil_frame_stats &snapshot = info.last_counters;
+
+		// Prefer the depth-stencil matching the fingerprint persisted from a previous session, so that steady-state sessions settle on the same buffer immediately without contest between candidates
+		if (check_fingerprint(desc, snapshot))
+		{
+			best_match = resource;
+			best_match_desc = desc;
+			best_snapshot = &snapshot;
+			break;
+		}
+
 		if (best_snapshot == nullptr || (snapshot.total_stats.drawcalls_indirect < (snapshot.total_stats.drawcalls / 3) ?
 				// Choose snapshot with the most vertices, since that is likely to contain the main scene
 				snapshot.total_stats.vertices > best_snapshot->total_stats.vertices :
@@ -946,6 +1385,39 @@ static void on_begin_render_effects(effect_runtime *runtime, command_list *cmd_l
 		}
 	}
 
+	if (best_match != 0 && best_snapshot != nullptr)
+	{
+		if (device_data.fingerprint_candidate != best_match)
+		{
+			device_data.fingerprint_candidate = best_match;
+			device_data.fingerprint_candidate_since = device_data.frame_index;
+		}
+		else if (device_data.frame_index >= (device_data.fingerprint_candidate_since + 120) && !check_fingerprint(best_match_desc, *best_snapshot))
+		{
+			// Selection has been stable for a while, so persist its fingerprint for fast-matching in the next session
+			s_fingerprint.width = best_match_desc.texture.width;
+			s_fingerprint.height = best_match_desc.texture.height;
+			s_fingerprint.format = static_cast<uint32_t>(best_match_desc.texture.format);
+			s_fingerprint.drawcalls = best_snapshot->total_stats.drawcalls;
+			s_fingerprint.vertices = best_snapshot->total_stats.vertices;
+
+			reshade::set_config_value(nullptr, "DEPTH", "FingerprintWidth", s_fingerprint.width);
+			reshade::set_config_value(nullptr, "DEPTH", "FingerprintHeight", s_fingerprint.height);
+			reshade::set_config_value(nullptr, "DEPTH", "FingerprintFormat", s_fingerprint.format);
+			reshade::set_config_value(nullptr, "DEPTH", "FingerprintDrawCalls", s_fingerprint.drawcalls);
+			reshade::set_config_value(nullptr, "DEPTH", "FingerprintVertices", s_fingerprint.vertices);
+		}
+
+		// The reduced per-draw tracking path in 'on_draw' is only sound while the selection is stable, so re-evaluate the confirmation every frame
+		s_fingerprint_confirmed = check_fingerprint(best_match_desc, *best_snapshot);
+	}
+	else
+	{
+		device_data.fingerprint_candidate = { 0 };
+
+		s_fingerprint_confirmed = false;
+	}
+
 	const resource_view prev_shader_resource = data.selected_shader_resource;
 
 	if (best_match != 0) do
@@ -990,7 +1462,7 @@ static void on_begin_render_effects(effect_runtime *runtime, command_list *cmd_l
 				// Avoid recreating shader resource view when the backup texture did not change
 				if (prev_shader_resource == 0 || device->get_resource_from_view(prev_shader_resource) != depth_stencil_backup->backup_texture)
 				{
-					if (api == device_api::d3d9)
+					if (api == device_api::d3d9 || (best_match_desc.texture.samples > 1 && !device->check_capability(device_caps::resolve_depth_stencil)))
 						srv_desc.format = format::r32_float; // Same format as backup texture, as set in 'track_depth_stencil_for_backup'
 
 					if (!device->create_resource_view(depth_stencil_backup->backup_texture, resource_usage::shader_resource, srv_desc, &data.selected_shader_resource))
@@ -1036,13 +1508,19 @@ static void on_begin_render_effects(effect_runtime *runtime, command_list *cmd_l
 				{
 					if (best_match_desc.texture.samples > 1)
 					{
-						assert(device->check_capability(device_caps::resolve_depth_stencil));
-
-						cmd_list->barrier(best_match, old_state, resource_usage::resolve_source);
-						cmd_list->barrier(backup_texture, resource_usage::copy_dest, resource_usage::resolve_dest);
-						cmd_list->resolve_texture_region(best_match, 0, nullptr, backup_texture, 0, 0, 0, 0, format_to_default_typed(best_match_desc.texture.format));
-						cmd_list->barrier(backup_texture, resource_usage::resolve_dest, resource_usage::copy_dest);
-						cmd_list->barrier(best_match, resource_usage::resolve_source, old_state);
+						if (device->check_capability(device_caps::resolve_depth_stencil))
+						{
+							cmd_list->barrier(best_match, old_state, resource_usage::resolve_source);
+							cmd_list->barrier(backup_texture, resource_usage::copy_dest, resource_usage::resolve_dest);
+							cmd_list->resolve_texture_region(best_match, 0, nullptr, backup_texture, 0, 0, 0, 0, format_to_default_typed(best_match_desc.texture.format));
+							cmd_list->barrier(backup_texture, resource_usage::resolve_dest, resource_usage::copy_dest);
+							cmd_list->barrier(best_match, resource_usage::resolve_source, old_state);
+						}
+						else
+						{
+							// This is called within the effect runtime state block, so any compute pipeline state changed by the resolve shader is restored before the application continues rendering
+							resolve_depth_via_compute(cmd_list, device_data, *depth_stencil_backup, best_match, best_match_desc, old_state);
+						}
 					}
 					else
 					{
@@ -1197,6 +1675,28 @@ static void draw_settings_overlay(effect_runtime *runtime)
 		}
 	}
 
+	if (s_preserve_depth_buffers == 0)
+	{
+		if (bool gpu_statistics = s_gpu_statistics != 0;
+			ImGui::Checkbox("Gather statistics on the GPU", &gpu_statistics))
+		{
+			s_gpu_statistics = gpu_statistics ? 1 : 0;
+			reshade::set_config_value(nullptr, "DEPTH", "GpuStatistics", s_gpu_statistics);
+
+			if (s_gpu_statistics)
+				device->get_private_data<generic_depth_device_data>().create_statistics_heap(device);
+		}
+
+		ImGui::SetItemTooltip("Count vertices with pipeline statistics queries instead of on the CPU, which reduces overhead in draw call heavy scenes, but makes depth buffer detection lag behind by a couple of frames");
+	}
+
+	if (device->get_private_data<generic_depth_device_data>().msaa_resolve_pipelines[0] != 0)
+	{
+		const char *const resolve_mode_items[] = { "Maximum over all samples", "First sample only" };
+		if (ImGui::Combo("Multisample resolve mode", reinterpret_cast<int *>(&s_msaa_resolve_mode), resolve_mode_items, static_cast<int>(std::size(resolve_mode_items))))
+			reshade::set_config_value(nullptr, "DEPTH", "MsaaResolveMode", s_msaa_resolve_mode);
+	}
+
 	ImGui::Spacing();
 	ImGui::Separator();
 	ImGui::Spacing();
@@ -1247,7 +1747,7 @@ static void draw_settings_overlay(effect_runtime *runtime)
 	for (const depth_stencil_item &item : sorted_item_list)
 	{
 		bool disabled = item.unusable;
-		if (item.desc.texture.samples > 1 && !device->check_capability(device_caps::resolve_depth_stencil)) // Disable widget for multisampled textures
+		if (item.desc.texture.samples > 1 && !check_msaa_resolve_support(device)) // Disable widget for multisampled textures that cannot be resolved
 			has_msaa_depth_stencil = disabled = true;
 
 		const bool selected = item.resource == data.selected_depth_stencil;
@@ -1385,10 +1885,12 @@ void register_addon_depth()
 	reshade::register_event<reshade::addon_event::draw_or_dispatch_indirect>(on_draw_indirect);
 	reshade::register_event<reshade::addon_event::bind_viewports>(on_bind_viewport);
 	reshade::register_event<reshade::addon_event::begin_render_pass>(on_begin_render_pass_with_depth_stencil);
+	reshade::register_event<reshade::addon_event::end_render_pass>(on_end_render_pass);
 	reshade::register_event<reshade::addon_event::bind_render_targets_and_depth_stencil>(on_bind_depth_stencil);
 	reshade::register_event<reshade::addon_event::clear_depth_stencil_view>(on_clear_depth_stencil);
 
 	reshade::register_event<reshade::addon_event::reset_command_list>(on_reset);
+	reshade::register_event<reshade::addon_event::close_command_list>(on_close);
 	reshade::register_event<reshade::addon_event::execute_command_list>(on_execute_primary);
 	reshade::register_event<reshade::addon_event::execute_secondary_command_list>(on_execute_secondary);
 
@@ -1419,10 +1921,12 @@ void unregister_addon_depth()
 	reshade::unregister_event<reshade::addon_event::draw_or_dispatch_indirect>(on_draw_indirect);
 	reshade::unregister_event<reshade::addon_event::bind_viewports>(on_bind_viewport);
 	reshade::unregister_event<reshade::addon_event::begin_render_pass>(on_begin_render_pass_with_depth_stencil);
+	reshade::unregister_event<reshade::addon_event::end_render_pass>(on_end_render_pass);
 	reshade::unregister_event<reshade::addon_event::bind_render_targets_and_depth_stencil>(on_bind_depth_stencil);
 	reshade::unregister_event<reshade::addon_event::clear_depth_stencil_view>(on_clear_depth_stencil);
 
 	reshade::unregister_event<reshade::addon_event::reset_command_list>(on_reset);
+	reshade::unregister_event<reshade::addon_event::close_command_list>(on_close);
 	reshade::unregister_event<reshade::addon_event::execute_command_list>(on_execute_primary);
 	reshade::unregister_event<reshade::addon_event::execute_secondary_command_list>(on_execute_secondary);
 
@@ -9,6 +9,13 @@
 #include <imgui.h>
 #include <reshade.hpp>
 #include "obs_hook_info.hpp"
+#include <d3d11on12.h>
+#include <dxgi.h>
+
+#pragma comment(lib, "d3d11.lib")
+
+// Maximum number of back buffers a DXGI swap chain can have
+#define MAX_BACK_BUFFERS 16
 
 struct capture_data
 {
@@ -26,6 +33,12 @@ struct capture_data
 			shtex_data *shtex_info;
 			reshade::api::resource texture;
 			HANDLE handle;
+			/* Direct3D 11on12 bridge used to share the texture in Direct3D 12 (the OBS capture protocol transports a legacy shared handle, which Direct3D 12 cannot export directly) */
+			ID3D11Device *device11;
+			ID3D11DeviceContext *context11;
+			ID3D11On12Device *device11on12;
+			ID3D11Texture2D *texture11;
+			ID3D11Resource *wrapped_back_buffers[MAX_BACK_BUFFERS];
 		} shtex;
 		/* shared memory */
 		struct
@@ -43,8 +56,73 @@ struct capture_data
 
 static bool s_before_effects = false;
 
-static bool capture_impl_init(reshade::api::device *device, const reshade::api::resource_desc &desc, void *window)
+static void capture_impl_free_shtex_d3d12()
+{
+	for (int i = 0; i < MAX_BACK_BUFFERS; ++i)
+		if (data.shtex.wrapped_back_buffers[i] != nullptr)
+			data.shtex.wrapped_back_buffers[i]->Release();
+	if (data.shtex.texture11 != nullptr)
+		data.shtex.texture11->Release();
+	if (data.shtex.device11on12 != nullptr)
+		data.shtex.device11on12->Release();
+	if (data.shtex.context11 != nullptr)
+		data.shtex.context11->Release();
+	if (data.shtex.device11 != nullptr)
+		data.shtex.device11->Release();
+}
+
+static bool capture_impl_init_shtex_d3d12(reshade::api::effect_runtime *runtime, void *window)
+{
+	// Create a Direct3D 11 device on top of the application command queue, so that a texture with a legacy shared handle OBS can open can be created and the back buffer copied into it in queue order
+	ID3D12Device *const device12 = reinterpret_cast<ID3D12Device *>(runtime->get_device()->get_native());
+	IUnknown *const queue12 = reinterpret_cast<IUnknown *>(runtime->get_command_queue()->get_native());
+
+	if (FAILED(D3D11On12CreateDevice(device12, D3D11_CREATE_DEVICE_BGRA_SUPPORT, nullptr, 0, &queue12, 1, 0, &data.shtex.device11, &data.shtex.context11, nullptr)))
+		return false;
+	if (FAILED(data.shtex.device11->QueryInterface(&data.shtex.device11on12)))
+		return false;
+
+	D3D11_TEXTURE2D_DESC desc11 = {};
+	desc11.Width = data.cx;
+	desc11.Height = data.cy;
+	desc11.MipLevels = 1;
+	desc11.ArraySize = 1;
+	desc11.Format = static_cast<DXGI_FORMAT>(data.format);
+	desc11.SampleDesc = { 1, 0 };
+	desc11.Usage = D3D11_USAGE_DEFAULT;
+	desc11.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+	desc11.MiscFlags = D3D11_RESOURCE_MISC_SHARED;
+
+	if (FAILED(data.shtex.device11->CreateTexture2D(&desc11, nullptr, &data.shtex.texture11)))
+		return false;
+
+	IDXGIResource *dxgi_resource = nullptr;
+	if (FAILED(data.shtex.texture11->QueryInterface(&dxgi_resource)))
+		return false;
+	const HRESULT hr = dxgi_resource->GetSharedHandle(&data.shtex.handle);
+	dxgi_resource->Release();
+	if (FAILED(hr))
+		return false;
+
+	// Wrap all back buffers up front, so that per frame only an acquire, copy and release is necessary
+	for (uint32_t i = 0; i < runtime->get_back_buffer_count(); ++i)
+	{
+		ID3D12Resource *const back_buffer12 = reinterpret_cast<ID3D12Resource *>(runtime->get_back_buffer(i).handle);
+
+		D3D11_RESOURCE_FLAGS flags11 = {};
+		if (FAILED(data.shtex.device11on12->CreateWrappedResource(back_buffer12, &flags11, D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_COPY_SOURCE, IID_PPV_ARGS(&data.shtex.wrapped_back_buffers[i]))))
+			return false;
+	}
+
+	return capture_init_shtex(data.shtex.shtex_info, window, data.cx, data.cy, static_cast<uint32_t>(data.format), false, (uintptr_t)data.shtex.handle);
+}
+
+static bool capture_impl_init(reshade::api::effect_runtime *runtime)
 {
+	reshade::api::device *const device = runtime->get_device();
+	const reshade::api::resource_desc desc = device->get_resource_desc(runtime->get_back_buffer(0));
+	void *const window = runtime->get_hwnd();
+
 	data.format = reshade::api::format_to_default_typed(desc.texture.format, 0);
 	data.multisampled = desc.texture.samples > 1;
 	data.cx = desc.texture.width;
@@ -52,7 +130,21 @@ static bool capture_impl_init(reshade::api::device *device, const reshade::api::
 
 	const reshade::api::resource_usage copy_state = data.multisampled ? reshade::api::resource_usage::resolve_dest : reshade::api::resource_usage::copy_dest;
 
-	// Using shared texture with OBS only works in Direct3D 10/11
+	// Direct3D 12 shares the back buffer with OBS through a Direct3D 11on12 bridge, which avoids the full-resolution round trip through system memory the shared memory path would do
+	if (device->get_api() == reshade::api::device_api::d3d12 && !data.multisampled && !global_hook_info->force_shmem)
+	{
+		data.using_shtex = true;
+
+		if (capture_impl_init_shtex_d3d12(runtime, window))
+			return true;
+
+		// Clean up any partially created bridge objects and fall back to the shared memory path below
+		capture_impl_free_shtex_d3d12();
+		memset(&data.shtex, 0, sizeof(data.shtex));
+		data.using_shtex = false;
+	}
+
+	// Using a shared texture with OBS otherwise only works in Direct3D 10/11
 	if ((device->get_api() == reshade::api::device_api::d3d10 || device->get_api() == reshade::api::device_api::d3d11) && !global_hook_info->force_shmem)
 	{
 		data.using_shtex = true;
@@ -106,7 +198,10 @@ static void capture_impl_free(reshade::api::device *device)
 
 	if (data.using_shtex)
 	{
-		device->destroy_resource(data.shtex.texture);
+		if (data.shtex.device11 != nullptr)
+			capture_impl_free_shtex_d3d12();
+		else
+			device->destroy_resource(data.shtex.texture);
 	}
 	else
 	{
@@ -125,6 +220,26 @@ static void capture_impl_free(reshade::api::device *device)
 	memset(&data, 0, sizeof(data));
 }
 
+static void capture_impl_shtex_d3d12(reshade::api::effect_runtime *runtime, reshade::api::resource back_buffer, reshade::api::resource_usage back_buffer_state)
+{
+	reshade::api::command_queue *const queue = runtime->get_command_queue();
+	reshade::api::command_list *const cmd_list = queue->get_immediate_command_list();
+
+	// Transition the back buffer into the state the wrapped resource was created with and submit that transition to the queue before the copy recorded through Direct3D 11on12 below
+	cmd_list->barrier(back_buffer, back_buffer_state, reshade::api::resource_usage::copy_source);
+	queue->flush_immediate_command_list();
+
+	ID3D11Resource *const wrapped_back_buffer = data.shtex.wrapped_back_buffers[runtime->get_current_back_buffer_index()];
+
+	data.shtex.device11on12->AcquireWrappedResources(&wrapped_back_buffer, 1);
+	data.shtex.context11->CopyResource(data.shtex.texture11, wrapped_back_buffer);
+	data.shtex.device11on12->ReleaseWrappedResources(&wrapped_back_buffer, 1);
+	// Submit the copy to the application command queue now, so it happens in present order
+	data.shtex.context11->Flush();
+
+	cmd_list->barrier(back_buffer, reshade::api::resource_usage::copy_source, back_buffer_state);
+}
+
 static void capture_impl_shtex(reshade::api::command_queue *queue, reshade::api::resource back_buffer, reshade::api::resource_usage back_buffer_state)
 {
 	reshade::api::command_list *cmd_list = queue->get_immediate_command_list();
@@ -200,9 +315,16 @@ static void capture_impl_frame(reshade::api::effect_runtime *runtime, reshade::a
 		const reshade::api::resource back_buffer = runtime->get_current_back_buffer();
 
 		if (data.using_shtex)
-			capture_impl_shtex(runtime->get_command_queue(), back_buffer, back_buffer_state);
+		{
+			if (data.shtex.device11 != nullptr)
+				capture_impl_shtex_d3d12(runtime, back_buffer, back_buffer_state);
+			else
+				capture_impl_shtex(runtime->get_command_queue(), back_buffer, back_buffer_state);
+		}
 		else
+		{
 			capture_impl_shmem(runtime->get_command_queue(), back_buffer, back_buffer_state);
+		}
 	}
 }
 
@@ -227,7 +349,7 @@ static void on_present(reshade::api::effect_runtime *runtime)
 	}
 
 	if (capture_should_init())
-		capture_impl_init(runtime->get_device(), runtime->get_device()->get_resource_desc(runtime->get_back_buffer(0)), runtime->get_hwnd());
+		capture_impl_init(runtime);
 
 	if (!s_before_effects)
 		capture_impl_frame(runtime, reshade::api::resource_usage::present);
@@ -5,9 +5,11 @@
 
 #include <reshade.hpp>
 #include <chrono>
+#include <d3d11.h>
 
 extern "C" {
 #include <libavutil/hwcontext.h>
+#include <libavutil/hwcontext_d3d11va.h>
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
 }
@@ -18,6 +20,10 @@ struct __declspec(uuid("0d7525f9-c4e1-426e-bc99-15bbd5fd51f2")) video_capture
 	AVFormatContext *output_ctx = nullptr;
 	AVFrame *frame = nullptr;
 
+	// Hardware frame pool the swapchain image is copied into directly when a GPU encoder is used, so frames never have to be read back to the CPU
+	AVBufferRef *hw_device_ctx = nullptr;
+	AVBufferRef *hw_frames_ctx = nullptr;
+
 	// Create multiple host resources, to buffer copies from device to host over multiple frames
 	reshade::api::resource host_resources[3];
 	uint64_t copy_finished_fence_value = 1;
@@ -27,28 +33,77 @@ struct __declspec(uuid("0d7525f9-c4e1-426e-bc99-15bbd5fd51f2")) video_capture
 	std::chrono::system_clock::time_point last_time;
 	std::chrono::system_clock::time_point start_time;
 
-	bool init_codec_ctx(const reshade::api::resource_desc &buffer_desc);
+	bool init_codec_ctx(reshade::api::device *device, const reshade::api::resource_desc &buffer_desc);
+	bool init_hw_frames_ctx(reshade::api::device *device, const reshade::api::resource_desc &buffer_desc);
 	void destroy_codec_ctx();
 	bool init_format_ctx(const char *filename);
 	void destroy_format_ctx();
 };
 
-bool video_capture::init_codec_ctx(const reshade::api::resource_desc &buffer_desc)
+static bool codec_supports_format(const AVCodec *codec, AVPixelFormat format)
 {
+	if (codec->pix_fmts == nullptr)
+		return false;
+	for (const AVPixelFormat *fmt = codec->pix_fmts; *fmt != AV_PIX_FMT_NONE; ++fmt)
+		if (*fmt == format)
+			return true;
+	return false;
+}
+
+bool video_capture::init_hw_frames_ctx(reshade::api::device *device, const reshade::api::resource_desc &buffer_desc)
+{
+	hw_device_ctx = av_hwdevice_ctx_alloc(AV_HWDEVICE_TYPE_D3D11VA);
+	if (hw_device_ctx == nullptr)
+		return false;
+
+	// Create the encoder session on the application device, so that the swapchain image can be fed to it without any copy through another device or the CPU
+	const auto device_ctx = reinterpret_cast<AVHWDeviceContext *>(hw_device_ctx->data);
+	const auto d3d11_device_ctx = static_cast<AVD3D11VADeviceContext *>(device_ctx->hwctx);
+	d3d11_device_ctx->device = reinterpret_cast<ID3D11Device *>(device->get_native());
+	d3d11_device_ctx->device->AddRef();
+
+	if (av_hwdevice_ctx_init(hw_device_ctx) < 0)
+		return false;
+
+	hw_frames_ctx = av_hwframe_ctx_alloc(hw_device_ctx);
+	if (hw_frames_ctx == nullptr)
+		return false;
+
+	const auto frames_ctx = reinterpret_cast<AVHWFramesContext *>(hw_frames_ctx->data);
+	frames_ctx->format = AV_PIX_FMT_D3D11;
+	frames_ctx->sw_format = (buffer_desc.texture.format == reshade::api::format::b8g8r8a8_unorm || buffer_desc.texture.format == reshade::api::format::b8g8r8a8_unorm_srgb || buffer_desc.texture.format == reshade::api::format::b8g8r8x8_unorm || buffer_desc.texture.format == reshade::api::format::b8g8r8x8_unorm_srgb) ? AV_PIX_FMT_BGRA : AV_PIX_FMT_RGBA;
+	frames_ctx->width = buffer_desc.texture.width;
+	frames_ctx->height = buffer_desc.texture.height;
+	// Size of the queue of frames that can be in flight in the encoder simultaneously (the driver serializes access, so the copy into a frame from the pool is ordered with the encoder reading from it)
+	frames_ctx->initial_pool_size = 4;
+
+	return av_hwframe_ctx_init(hw_frames_ctx) >= 0;
+}
+
+bool video_capture::init_codec_ctx(reshade::api::device *device, const reshade::api::resource_desc &buffer_desc)
+{
+	const bool can_use_d3d11 = device->get_api() == reshade::api::device_api::d3d11;
+
 	const AVCodec *codec = nullptr;
-	void *i = nullptr;
-	while ((codec = av_codec_iterate(&i)) != nullptr)
+	// Prefer encoders that can consume Direct3D 11 textures directly, then hardware encoders fed from system memory, before falling back to software encoding
+	for (const int codec_pass : { 0, 1, 2 })
 	{
-		if (codec->id != AV_CODEC_ID_H264 || !av_codec_is_encoder(codec))
-			continue;
-
-		bool supports_rgb0 = false;
-		for (const AVPixelFormat *fmt = codec->pix_fmts; *fmt != AV_PIX_FMT_NONE; ++fmt)
-			if (*fmt == AV_PIX_FMT_0BGR32 || *fmt == AV_PIX_FMT_0RGB32)
-				supports_rgb0 = true;
+		void *i = nullptr;
+		while ((codec = av_codec_iterate(&i)) != nullptr)
+		{
+			if (codec->id != AV_CODEC_ID_H264 || !av_codec_is_encoder(codec))
+				continue;
+
+			if (codec_pass == 0 && can_use_d3d11 && codec_supports_format(codec, AV_PIX_FMT_D3D11))
+				break;
+			if (codec_pass == 1 && (codec->capabilities & AV_CODEC_CAP_HARDWARE) == 0)
+				continue;
+			if (codec_pass != 0 && (codec_supports_format(codec, AV_PIX_FMT_0BGR32) || codec_supports_format(codec, AV_PIX_FMT_0RGB32)))
+				break; // Found a codec that passes requirements
+		}
 
-		 if (supports_rgb0)
-			break; // Found a codec that passes requirements
+		if (codec != nullptr)
+			break;
 	}
 
 	if (codec == nullptr)
@@ -87,6 +142,21 @@ bool video_capture::init_codec_ctx(const reshade::api::resource_desc &buffer_des
 		return false;
 	}
 
+	if (can_use_d3d11 && codec_supports_format(codec, AV_PIX_FMT_D3D11))
+	{
+		if (init_hw_frames_ctx(device, buffer_desc))
+		{
+			codec_ctx->pix_fmt = AV_PIX_FMT_D3D11;
+			codec_ctx->hw_frames_ctx = av_buffer_ref(hw_frames_ctx);
+		}
+		else
+		{
+			// Fall back to encoding from system memory when the hardware frame pool could not be created
+			av_buffer_unref(&hw_frames_ctx);
+			av_buffer_unref(&hw_device_ctx);
+		}
+	}
+
 	if (int err = avcodec_open2(codec_ctx, codec, nullptr); err < 0)
 	{
 		destroy_codec_ctx();
@@ -110,14 +180,18 @@ bool video_capture::init_codec_ctx(const reshade::api::resource_desc &buffer_des
 	frame->format = codec_ctx->pix_fmt;
 	frame->color_range = codec_ctx->color_range;
 
-	if (int err = av_frame_get_buffer(frame, 0); err < 0)
+	// In the hardware case frame textures are instead acquired from the hardware frame pool each capture
+	if (hw_frames_ctx == nullptr)
 	{
-		destroy_codec_ctx();
+		if (int err = av_frame_get_buffer(frame, 0); err < 0)
+		{
+			destroy_codec_ctx();
 
-		char errbuf[32 + AV_ERROR_MAX_STRING_SIZE] = "Failed to get frame buffer: ";
-		av_make_error_string(errbuf + strlen(errbuf), sizeof(errbuf) - strlen(errbuf), err);
-		reshade::log::message(reshade::log::level::error, errbuf);
-		return false;
+			char errbuf[32 + AV_ERROR_MAX_STRING_SIZE] = "Failed to get frame buffer: ";
+			av_make_error_string(errbuf + strlen(errbuf), sizeof(errbuf) - strlen(errbuf), err);
+			reshade::log::message(reshade::log::level::error, errbuf);
+			return false;
+		}
 	}
 
 	return true;
@@ -135,6 +209,9 @@ void video_capture::destroy_codec_ctx()
 		avcodec_free_context(&codec_ctx);
 		codec_ctx = nullptr;
 	}
+
+	av_buffer_unref(&hw_frames_ctx);
+	av_buffer_unref(&hw_device_ctx);
 }
 
 bool video_capture::init_format_ctx(const char *filename)
@@ -262,31 +339,35 @@ static void on_reshade_finish_effects(reshade::api::effect_runtime *runtime, res
 		{
 			reshade::api::resource_desc desc = device->get_resource_desc(rtv_resource);
 
-			if (!data.init_codec_ctx(desc))
+			if (!data.init_codec_ctx(device, desc))
 				return;
 			if (!data.init_format_ctx("video.mp4"))
 				return;
 
-			desc.type = reshade::api::resource_type::texture_2d;
-			desc.heap = reshade::api::memory_heap::gpu_to_cpu;
-			desc.usage = reshade::api::resource_usage::copy_dest;
-			desc.flags = reshade::api::resource_flags::none;
-
-			for (size_t i = 0; i < std::size(data.host_resources); ++i)
+			// The hardware encoder reads directly from the frame pool textures, so no host resources are needed to read frames back to the CPU
+			if (data.hw_frames_ctx == nullptr)
 			{
-				if (!device->create_resource(desc, nullptr, reshade::api::resource_usage::copy_dest, &data.host_resources[i]))
-				{
-					reshade::log::message(reshade::log::level::error, "Failed to create host resource!");
+				desc.type = reshade::api::resource_type::texture_2d;
+				desc.heap = reshade::api::memory_heap::gpu_to_cpu;
+				desc.usage = reshade::api::resource_usage::copy_dest;
+				desc.flags = reshade::api::resource_flags::none;
 
-					for (size_t k = 0; k < i; ++k)
+				for (size_t i = 0; i < std::size(data.host_resources); ++i)
+				{
+					if (!device->create_resource(desc, nullptr, reshade::api::resource_usage::copy_dest, &data.host_resources[i]))
 					{
-						device->destroy_resource(data.host_resources[k]);
-						data.host_resources[k] = { 0 };
-					}
+						reshade::log::message(reshade::log::level::error, "Failed to create host resource!");
+
+						for (size_t k = 0; k < i; ++k)
+						{
+							device->destroy_resource(data.host_resources[k]);
+							data.host_resources[k] = { 0 };
+						}
 
-					data.destroy_format_ctx();
-					data.destroy_codec_ctx();
-					return;
+						data.destroy_format_ctx();
+						data.destroy_codec_ctx();
+						return;
+					}
 				}
 			}
 
@@ -296,7 +377,7 @@ static void on_reshade_finish_effects(reshade::api::effect_runtime *runtime, res
 		}
 	}
 
-	if (data.codec_ctx == nullptr || data.output_ctx == nullptr || data.host_resources[0] == 0)
+	if (data.codec_ctx == nullptr || data.output_ctx == nullptr || (data.hw_frames_ctx == nullptr && data.host_resources[0] == 0))
 		return;
 
 	// Only encode a frame every few frames, depending on the set codec framerate
@@ -305,6 +386,33 @@ static void on_reshade_finish_effects(reshade::api::effect_runtime *runtime, res
 		return;
 	data.last_time = time;
 
+	if (data.hw_frames_ctx != nullptr)
+	{
+		// Acquire a texture from the hardware frame pool and copy the frame into it entirely on the GPU, so the render thread only records a single copy command
+		av_frame_unref(data.frame);
+		if (av_hwframe_get_buffer(data.hw_frames_ctx, data.frame, 0) < 0)
+			return; // All textures in the pool are still in flight in the encoder, so skip this frame
+
+		reshade::api::command_list *const cmd_list = queue->get_immediate_command_list();
+		cmd_list->barrier(rtv_resource, reshade::api::resource_usage::render_target, reshade::api::resource_usage::copy_source);
+
+		// The immediate command list of a Direct3D 11 command queue is the native immediate device context
+		const auto context = reinterpret_cast<ID3D11DeviceContext *>(cmd_list->get_native());
+		context->CopySubresourceRegion(
+			reinterpret_cast<ID3D11Resource *>(data.frame->data[0]), static_cast<UINT>(reinterpret_cast<intptr_t>(data.frame->data[1])), 0, 0, 0,
+			reinterpret_cast<ID3D11Resource *>(rtv_resource.handle), 0, nullptr);
+
+		cmd_list->barrier(rtv_resource, reshade::api::resource_usage::copy_source, reshade::api::resource_usage::render_target);
+
+		data.frame->pts = av_rescale_q(
+			std::chrono::duration_cast<std::chrono::milliseconds>(time - data.start_time).count(),
+			AVRational { std::milli::num, std::milli::den },
+			data.codec_ctx->time_base);
+
+		encode_frame(data.codec_ctx, data.output_ctx, data.frame);
+		return;
+	}
+
 	// Copy frame to the host, but delay mapping and reading that copy for a few frames afterwards, so that the device has enough time to finish the copy to host memory (this is asynchronous and it can take a bit for the device to catch up)
 	reshade::api::command_list *const cmd_list = queue->get_immediate_command_list();
 	cmd_list->barrier(rtv_resource, reshade::api::resource_usage::render_target, reshade::api::resource_usage::copy_source);
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 
 inline uint32_t compute_crc32(const uint8_t *data, size_t size)
 {
@@ -44,8 +45,36 @@ inline uint32_t compute_crc32(const uint8_t *data, size_t size)
 		0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94, 0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
 	};
 
+	// Derive the additional lookup tables for the slice-by-8 variant below from the base table above on first use
+	struct slice_tables
+	{
+		uint32_t t[8][256];
+		slice_tables(const uint32_t(&base)[256])
+		{
+			for (int i = 0; i < 256; ++i)
+				t[0][i] = base[i];
+			for (int k = 1; k < 8; ++k)
+				for (int i = 0; i < 256; ++i)
+					t[k][i] = (t[k - 1][i] >> 8) ^ base[t[k - 1][i] & 0xFF];
+		}
+	};
+	static const slice_tables tables(crc32_table);
+
 	uint32_t crc = 0xFFFFFFFF;
+
+	// Process eight bytes per iteration, which is significantly faster than the byte-wise variant for large inputs like shader binaries
+	for (; size >= 8; size -= 8, data += 8)
+	{
+		uint32_t lo, hi;
+		std::memcpy(&lo, data, 4);
+		std::memcpy(&hi, data + 4, 4);
+		lo ^= crc;
+
+		crc = tables.t[7][lo & 0xFF] ^ tables.t[6][(lo >> 8) & 0xFF] ^ tables.t[5][(lo >> 16) & 0xFF] ^ tables.t[4][lo >> 24] ^
+		      tables.t[3][hi & 0xFF] ^ tables.t[2][(hi >> 8) & 0xFF] ^ tables.t[1][(hi >> 16) & 0xFF] ^ tables.t[0][hi >> 24];
+	}
+
 	for (; size != 0; --size, ++data)
-		crc = (crc >> 8) ^ crc32_table[(crc ^ (*data)) & 0xFF];
+		crc = (crc >> 8) ^ tables.t[0][(crc ^ (*data)) & 0xFF];
 	return ~crc;
 }
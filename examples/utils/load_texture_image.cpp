@@ -14,11 +14,11 @@
 
 using namespace reshade::api;
 
-bool load_texture_image(const resource_desc &desc, subresource_data &data, std::vector<std::vector<uint8_t>> &data_to_delete)
+uint32_t compute_texture_hash(const resource_desc &desc, const subresource_data &data)
 {
 #if RESHADE_ADDON_TEXTURE_LOAD_HASH_TEXMOD
 	// Behavior of the original TexMod (see https://github.com/codemasher/texmod/blob/master/uMod_DX9/uMod_TextureFunction.cpp#L41)
-	const uint32_t hash = ~compute_crc32(
+	return ~compute_crc32(
 		static_cast<const uint8_t *>(data.data),
 		desc.texture.height * static_cast<size_t>(
 			(desc.texture.format >= format::bc1_typeless && desc.texture.format <= format::bc1_unorm_srgb) || (desc.texture.format >= format::bc4_typeless && desc.texture.format <= format::bc4_snorm) ? (desc.texture.width * 4) / 8 :
@@ -26,35 +26,20 @@ bool load_texture_image(const resource_desc &desc, subresource_data &data, std::
 			format_row_pitch(desc.texture.format, desc.texture.width)));
 #else
 	// Correct hash calculation using entire resource data
-	const uint32_t hash = compute_crc32(
+	return compute_crc32(
 		static_cast<const uint8_t *>(data.data),
 		format_slice_pitch(desc.texture.format, data.row_pitch, desc.texture.height));
 #endif
+}
 
-	// Prepend executable directory to image files
-	wchar_t file_prefix[MAX_PATH] = L"";
-	GetModuleFileNameW(nullptr, file_prefix, ARRAYSIZE(file_prefix));
-
-	std::filesystem::path replace_path = file_prefix;
-	replace_path  = replace_path.parent_path();
-	replace_path /= RESHADE_ADDON_TEXTURE_LOAD_DIR;
-
-	wchar_t hash_string[11];
-	swprintf_s(hash_string, L"0x%08X", hash);
-
-	replace_path /= hash_string;
-	replace_path += RESHADE_ADDON_TEXTURE_LOAD_FORMAT;
-
-	// Check if a replacement file for this texture hash exists and if so, overwrite the texture data with its contents
-	if (!std::filesystem::exists(replace_path))
-		return false;
-
+bool decode_texture_image(const resource_desc &desc, const std::filesystem::path &replace_path, subresource_data &data, std::vector<uint8_t> &pixel_data)
+{
 	int width = 0, height = 0, channels = 0;
 	stbi_uc *const rgba_pixel_data_p = stbi_load(replace_path.u8string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
 	if (rgba_pixel_data_p == nullptr)
 		return false;
 
-	std::vector<uint8_t> pixel_data(rgba_pixel_data_p, rgba_pixel_data_p + static_cast<size_t>(width) * static_cast<size_t>(height) * 4);
+	pixel_data.assign(rgba_pixel_data_p, rgba_pixel_data_p + static_cast<size_t>(width) * static_cast<size_t>(height) * 4);
 
 	stbi_image_free(rgba_pixel_data_p);
 
@@ -143,7 +128,5 @@ bool load_texture_image(const resource_desc &desc, subresource_data &data, std::
 		return false;
 	}
 
-	data_to_delete.push_back(std::move(pixel_data));
-
 	return true;
 }
@@ -11,7 +11,7 @@
 #include <Windows.h>
 
 // Current version of the ReShade API
-#define RESHADE_API_VERSION 14
+#define RESHADE_API_VERSION 16
 
 // Optionally import ReShade API functions when 'RESHADE_API_LIBRARY' is defined instead of using header-only mode
 #if defined(RESHADE_API_LIBRARY) || defined(RESHADE_API_LIBRARY_EXPORT)
@@ -26,10 +26,15 @@
 RESHADE_API_LIBRARY_DECL void ReShadeLogMessage(HMODULE module, int level, const char *message);
 
 RESHADE_API_LIBRARY_DECL void ReShadeGetBasePath(char *path, size_t *path_size);
+RESHADE_API_LIBRARY_DECL bool ReShadeWriteFileAsync(const wchar_t *path, const void *data, size_t size);
 
 RESHADE_API_LIBRARY_DECL bool ReShadeGetConfigValue(HMODULE module, reshade::api::effect_runtime *runtime, const char *section, const char *key, char *value, size_t *value_size);
 RESHADE_API_LIBRARY_DECL void ReShadeSetConfigValue(HMODULE module, reshade::api::effect_runtime *runtime, const char *section, const char *key, const char *value);
 RESHADE_API_LIBRARY_DECL void ReShadeSetConfigArray(HMODULE module, reshade::api::effect_runtime *runtime, const char *section, const char *key, const char *value, size_t value_size);
+RESHADE_API_LIBRARY_DECL void *ReShadeCreateConfigSnapshot(HMODULE module, reshade::api::effect_runtime *runtime, const char *section, void(*callback)(void *user_data), void *user_data);
+RESHADE_API_LIBRARY_DECL void ReShadeDestroyConfigSnapshot(HMODULE module, void *snapshot);
+RESHADE_API_LIBRARY_DECL bool ReShadeUpdateConfigSnapshot(HMODULE module, void *snapshot);
+RESHADE_API_LIBRARY_DECL bool ReShadeGetConfigSnapshotValue(HMODULE module, void *snapshot, const char *key, char *value, size_t *value_size);
 
 RESHADE_API_LIBRARY_DECL bool ReShadeRegisterAddon(HMODULE module, uint32_t api_version);
 RESHADE_API_LIBRARY_DECL void ReShadeUnregisterAddon(HMODULE module);
@@ -38,6 +43,13 @@ RESHADE_API_LIBRARY_DECL void ReShadeRegisterEvent(reshade::addon_event ev, void
 RESHADE_API_LIBRARY_DECL void ReShadeRegisterEventForAddon(HMODULE module, reshade::addon_event ev, void *callback);
 RESHADE_API_LIBRARY_DECL void ReShadeUnregisterEvent(reshade::addon_event ev, void *callback);
 RESHADE_API_LIBRARY_DECL void ReShadeUnregisterEventForAddon(HMODULE module, reshade::addon_event ev, void *callback);
+RESHADE_API_LIBRARY_DECL void ReShadeSetEventProfiling(bool enabled);
+RESHADE_API_LIBRARY_DECL bool ReShadeGetEventProfiling(reshade::addon_event ev, void *callback, uint64_t *out_call_count, uint64_t *out_total_duration_ns);
+
+RESHADE_API_LIBRARY_DECL void ReShadeRegisterDescriptorTracking();
+RESHADE_API_LIBRARY_DECL void ReShadeUnregisterDescriptorTracking();
+RESHADE_API_LIBRARY_DECL bool ReShadeGetDescriptorState(reshade::api::descriptor_heap heap, uint32_t offset, reshade::api::descriptor_type *out_type, void *out_descriptor);
+RESHADE_API_LIBRARY_DECL bool ReShadeGetPipelineLayoutParam(reshade::api::pipeline_layout layout, uint32_t param_index, reshade::api::pipeline_layout_param *out_param);
 
 RESHADE_API_LIBRARY_DECL void ReShadeRegisterOverlay(const char *title, void(*callback)(reshade::api::effect_runtime *runtime));
 RESHADE_API_LIBRARY_DECL void ReShadeRegisterOverlayForAddon(HMODULE module, const char *title, void(*callback)(reshade::api::effect_runtime *runtime));
@@ -91,6 +103,18 @@ namespace reshade { namespace internal
 		static HMODULE handle = initial_handle;
 		return handle;
 	}
+
+#if defined(IMGUI_VERSION_NUM) && !defined(RESHADE_OVERLAY_FUNCTION_TABLE)
+	/// <summary>
+	/// Gets the function used to query the Dear ImGui context of the ReShade module.
+	/// </summary>
+	inline auto get_imgui_context_function(HMODULE reshade_module = nullptr) -> ImGuiContext *(*)(uint32_t, ImGuiMemAllocFunc *, ImGuiMemFreeFunc *, void **)
+	{
+		static const auto func = reinterpret_cast<ImGuiContext *(*)(uint32_t, ImGuiMemAllocFunc *, ImGuiMemFreeFunc *, void **)>(
+			GetProcAddress(reshade_module != nullptr ? reshade_module : get_reshade_module_handle(), "ReShadeGetImGuiContext"));
+		return func;
+	}
+#endif
 } }
 
 #endif
@@ -157,6 +181,27 @@ namespace reshade
 #endif
 	}
 
+	/// <summary>
+	/// Queues writing of the specified buffer to a file on ReShade's shared write-behind queue, so that the calling thread does not block on disk I/O.
+	/// The buffer is copied, so it only has to stay valid for the duration of this call.
+	/// </summary>
+	/// <param name="path">Path of the file to create or overwrite.</param>
+	/// <param name="data">Pointer to the data to write.</param>
+	/// <param name="size">Size of the data to write, in bytes.</param>
+	/// <returns><see langword="true"/> if the write was queued, <see langword="false"/> if the queue is saturated or this functionality is not available, in which case the caller should write the file itself.</returns>
+	inline bool write_file_async(const wchar_t *path, const void *data, size_t size)
+	{
+#if defined(RESHADE_API_LIBRARY)
+		return ReShadeWriteFileAsync(path, data, size);
+#else
+		static const auto func = reinterpret_cast<bool(*)(const wchar_t *, const void *, size_t)>(
+			GetProcAddress(internal::get_reshade_module_handle(), "ReShadeWriteFileAsync"));
+		if (func != nullptr)
+			return func(path, data, size);
+		return false;
+#endif
+	}
+
 	/// <summary>
 	/// Gets a value from one of ReShade's config files.
 	/// This can use either the global config file (ReShade.ini next to the application executable), or one local to an effect runtime (ReShade[index].ini in the base path).
@@ -240,6 +285,101 @@ namespace reshade
 #endif
 	}
 
+	/// <summary>
+	/// Creates a snapshot of an entire section in one of ReShade's config files, which values can afterwards be read from via <see cref="get_config_snapshot_value"/> without taking any locks.
+	/// This is preferable over calling <see cref="get_config_value"/> repeatedly every frame, since that has to lock and look up the config cache for every single value.
+	/// The snapshot is not refreshed automatically, call <see cref="update_config_snapshot"/> to bring it up to date again (which is cheap when nothing changed).
+	/// </summary>
+	/// <param name="runtime">Optional effect runtime to use the config file from, or <see langword="nullptr"/> to use the global config file.</param>
+	/// <param name="section">Name of the config section to snapshot.</param>
+	/// <param name="callback">Optional callback that is invoked whenever the underlying config file changed, or <see langword="nullptr"/> to not get change notifications. It may be invoked from arbitrary threads and potentially while internal locks are held, so it must not access the configuration itself and should only set a flag that triggers a <see cref="update_config_snapshot"/> call later.</param>
+	/// <param name="user_data">Optional pointer that is passed to the <paramref name="callback"/>.</param>
+	/// <returns>Opaque handle to the snapshot that has to be freed via <see cref="destroy_config_snapshot"/>, or <see langword="nullptr"/> on failure.</returns>
+	inline void *create_config_snapshot(api::effect_runtime *runtime, const char *section, void(*callback)(void *user_data) = nullptr, void *user_data = nullptr)
+	{
+#if defined(RESHADE_API_LIBRARY)
+		return ReShadeCreateConfigSnapshot(nullptr, runtime, section, callback, user_data);
+#else
+		static const auto func = reinterpret_cast<void *(*)(HMODULE, api::effect_runtime *, const char *, void(*)(void *), void *)>(
+			GetProcAddress(internal::get_reshade_module_handle(), "ReShadeCreateConfigSnapshot"));
+		if (func != nullptr)
+			return func(internal::get_current_module_handle(), runtime, section, callback, user_data);
+		return nullptr;
+#endif
+	}
+	/// <summary>
+	/// Destroys a config snapshot that was previously created via <see cref="create_config_snapshot"/> and unregisters its change notification callback.
+	/// </summary>
+	/// <param name="snapshot">Opaque handle of the snapshot to destroy.</param>
+	inline void destroy_config_snapshot(void *snapshot)
+	{
+#if defined(RESHADE_API_LIBRARY)
+		ReShadeDestroyConfigSnapshot(nullptr, snapshot);
+#else
+		static const auto func = reinterpret_cast<void(*)(HMODULE, void *)>(
+			GetProcAddress(internal::get_reshade_module_handle(), "ReShadeDestroyConfigSnapshot"));
+		if (func != nullptr)
+			func(internal::get_current_module_handle(), snapshot);
+#endif
+	}
+	/// <summary>
+	/// Updates a config snapshot to the current contents of its config section.
+	/// This only copies data when the underlying config file actually changed since the last update, so is cheap to call every frame. It is however not synchronized with <see cref="get_config_snapshot_value"/>, so update and reads should happen on the same thread.
+	/// </summary>
+	/// <param name="snapshot">Opaque handle of the snapshot to update.</param>
+	/// <returns><see langword="true"/> if the snapshot contents changed, <see langword="false"/> if they were already up to date.</returns>
+	inline bool update_config_snapshot(void *snapshot)
+	{
+#if defined(RESHADE_API_LIBRARY)
+		return ReShadeUpdateConfigSnapshot(nullptr, snapshot);
+#else
+		static const auto func = reinterpret_cast<bool(*)(HMODULE, void *)>(
+			GetProcAddress(internal::get_reshade_module_handle(), "ReShadeUpdateConfigSnapshot"));
+		if (func != nullptr)
+			return func(internal::get_current_module_handle(), snapshot);
+		return false;
+#endif
+	}
+	/// <summary>
+	/// Gets a value from a config snapshot that was previously created via <see cref="create_config_snapshot"/>, without touching the config cache or taking any locks.
+	/// </summary>
+	/// <param name="snapshot">Opaque handle of the snapshot to read from.</param>
+	/// <param name="key">Name of the config value.</param>
+	/// <param name="value">Pointer to a string buffer that is filled with the config value, or <see langword="nullptr"/> to query the necessary size.</param>
+	/// <param name="value_size">Pointer to an integer that contains the size of the string buffer and is set to the actual length of the string, including the null-terminator.</param>
+	/// <returns><see langword="true"/> if the specified config value exists, <see cref="false"/> otherwise.</returns>
+	inline bool get_config_snapshot_value(void *snapshot, const char *key, char *value, size_t *value_size)
+	{
+#if defined(RESHADE_API_LIBRARY)
+		return ReShadeGetConfigSnapshotValue(nullptr, snapshot, key, value, value_size);
+#else
+		static const auto func = reinterpret_cast<bool(*)(HMODULE, void *, const char *, char *, size_t *)>(
+			GetProcAddress(internal::get_reshade_module_handle(), "ReShadeGetConfigSnapshotValue"));
+		if (func != nullptr)
+			return func(internal::get_current_module_handle(), snapshot, key, value, value_size);
+		return false;
+#endif
+	}
+#if _HAS_CXX17
+	template <typename T>
+	inline bool get_config_snapshot_value(void *snapshot, const char *key, T &value)
+	{
+		char value_string[32]; size_t value_length = sizeof(value_string) - 1;
+		if (!get_config_snapshot_value(snapshot, key, value_string, &value_length))
+			return false;
+		return std::from_chars(value_string, value_string + value_length, value).ec == std::errc {};
+	}
+	template <>
+	inline bool get_config_snapshot_value<bool>(void *snapshot, const char *key, bool &value)
+	{
+		int value_int = 0;
+		if (!get_config_snapshot_value<int>(snapshot, key, value_int))
+			return false;
+		value = (value_int != 0);
+		return true;
+	}
+#endif
+
 	/// <summary>
 	/// Registers this module as an add-on with ReShade.
 	/// Call this in 'AddonInit' or 'DllMain' during process attach, before any of the other API functions!
@@ -264,11 +404,27 @@ namespace reshade
 			return false;
 
 #if defined(IMGUI_VERSION_NUM)
+#if defined(RESHADE_OVERLAY_FUNCTION_TABLE)
 		const auto imgui_func = reinterpret_cast<const imgui_function_table *(*)(uint32_t)>(
 			GetProcAddress(reshade_module, "ReShadeGetImGuiFunctionTable"));
 		// Check that the ReShade module was built with Dear ImGui support and supports the used version
 		if (imgui_func == nullptr || !(imgui_function_table_instance() = imgui_func(IMGUI_VERSION_NUM)))
 			return false;
+#else
+		// This add-on was built against the real Dear ImGui headers instead of the function table in "reshade_overlay.hpp", so negotiate direct access to the ImGui context of the ReShade module instead (see 'make_imgui_context_current')
+		const auto imgui_context_func = internal::get_imgui_context_function(reshade_module);
+		// Check that the ReShade module was built against the exact same Dear ImGui version, since the data layout is only guaranteed to be identical in that case
+		if (imgui_context_func == nullptr)
+			return false;
+		ImGuiMemAllocFunc alloc_func = nullptr;
+		ImGuiMemFreeFunc free_func = nullptr;
+		void *alloc_user_data = nullptr;
+		imgui_context_func(IMGUI_VERSION_NUM, &alloc_func, &free_func, &alloc_user_data);
+		if (alloc_func == nullptr || free_func == nullptr)
+			return false;
+		// Route all Dear ImGui allocations through the ReShade module, so that memory can pass freely between the two copies of the Dear ImGui code
+		ImGui::SetAllocatorFunctions(alloc_func, free_func, alloc_user_data);
+#endif
 #endif
 
 		return true;
@@ -298,6 +454,24 @@ namespace reshade
 #endif
 	}
 
+#if defined(IMGUI_VERSION_NUM) && !defined(RESHADE_OVERLAY_FUNCTION_TABLE) && !defined(RESHADE_API_LIBRARY)
+	/// <summary>
+	/// Makes the Dear ImGui context of the ReShade module current in the copy of Dear ImGui linked into this add-on.
+	/// Call this at the start of every overlay callback, before making any other ImGui calls, since the context can change between frames and effect runtimes.
+	/// This is only available to add-ons built against the exact Dear ImGui version the ReShade module uses (see <see cref="register_addon"/>), add-ons built against the function table in "reshade_overlay.hpp" do not need it.
+	/// </summary>
+	/// <returns><see langword="true"/> if a context was made current, <see langword="false"/> otherwise.</returns>
+	inline bool make_imgui_context_current()
+	{
+		const auto imgui_context_func = internal::get_imgui_context_function();
+		ImGuiContext *const imgui_context = imgui_context_func != nullptr ? imgui_context_func(IMGUI_VERSION_NUM, nullptr, nullptr, nullptr) : nullptr;
+		if (imgui_context == nullptr)
+			return false;
+		ImGui::SetCurrentContext(imgui_context);
+		return true;
+	}
+#endif
+
 	/// <summary>
 	/// Registers a callback for the specified event with ReShade.
 	/// <para>The callback function is then called whenever the application performs a task associated with this event (see also the <see cref="addon_event"/> enumeration).</para>
@@ -334,6 +508,114 @@ namespace reshade
 #endif
 	}
 
+	/// <summary>
+	/// Enables or disables recording of call counts and cumulative durations for all registered event callbacks.
+	/// <para>Previously recorded data is reset when profiling is enabled.</para>
+	/// </summary>
+	/// <param name="enabled">Set to <see langword="true"/> to start recording, <see langword="false"/> to stop it.</param>
+	inline void set_event_profiling(bool enabled)
+	{
+#if defined(RESHADE_API_LIBRARY)
+		ReShadeSetEventProfiling(enabled);
+#else
+		static const auto func = reinterpret_cast<void(*)(bool)>(
+			GetProcAddress(internal::get_reshade_module_handle(), "ReShadeSetEventProfiling"));
+		if (func != nullptr)
+			func(enabled);
+#endif
+	}
+	/// <summary>
+	/// Gets the call count and cumulative duration (in nanoseconds) recorded for an event callback while profiling was enabled via <see cref="set_event_profiling"/>.
+	/// </summary>
+	/// <param name="callback">Pointer to the callback function that was previously registered via <see cref="register_event"/>.</param>
+	/// <param name="out_call_count">Pointer to a variable that is set to the number of times the callback was invoked, or <see langword="nullptr"/>.</param>
+	/// <param name="out_total_duration_ns">Pointer to a variable that is set to the total time spent inside the callback in nanoseconds, or <see langword="nullptr"/>.</param>
+	/// <typeparam name="ev">Event the callback was registered for.</typeparam>
+	/// <returns><see langword="true"/> if profiling data for the callback exists, <see langword="false"/> otherwise.</returns>
+	template <addon_event ev>
+	inline bool get_event_profiling(typename addon_event_traits<ev>::decl callback, uint64_t *out_call_count, uint64_t *out_total_duration_ns)
+	{
+#if defined(RESHADE_API_LIBRARY)
+		return ReShadeGetEventProfiling(ev, static_cast<void *>(callback), out_call_count, out_total_duration_ns);
+#else
+		static const auto func = reinterpret_cast<bool(*)(addon_event, void *, uint64_t *, uint64_t *)>(
+			GetProcAddress(internal::get_reshade_module_handle(), "ReShadeGetEventProfiling"));
+		if (func != nullptr)
+			return func(ev, static_cast<void *>(callback), out_call_count, out_total_duration_ns);
+		return false;
+#endif
+	}
+
+	/// <summary>
+	/// Enables the descriptor tracking service built into ReShade, which shadows all descriptor table updates and copies.
+	/// <para>The tracker is shared between all add-ons that enabled it, so that the tracking cost is only paid once. Query the shadowed state via <see cref="get_descriptor_state"/> and <see cref="get_pipeline_layout_param"/>.</para>
+	/// </summary>
+	inline void register_descriptor_tracking()
+	{
+#if defined(RESHADE_API_LIBRARY)
+		ReShadeRegisterDescriptorTracking();
+#else
+		static const auto func = reinterpret_cast<void(*)()>(
+			GetProcAddress(internal::get_reshade_module_handle(), "ReShadeRegisterDescriptorTracking"));
+		if (func != nullptr)
+			func();
+#endif
+	}
+	/// <summary>
+	/// Disables the descriptor tracking service that was previously enabled via <see cref="register_descriptor_tracking"/>.
+	/// <para>Tracking only actually stops once all add-ons that enabled it have disabled it again.</para>
+	/// </summary>
+	inline void unregister_descriptor_tracking()
+	{
+#if defined(RESHADE_API_LIBRARY)
+		ReShadeUnregisterDescriptorTracking();
+#else
+		static const auto func = reinterpret_cast<void(*)()>(
+			GetProcAddress(internal::get_reshade_module_handle(), "ReShadeUnregisterDescriptorTracking"));
+		if (func != nullptr)
+			func();
+#endif
+	}
+	/// <summary>
+	/// Gets the descriptor that was last written to a descriptor heap at the specified offset (requires descriptor tracking to be enabled via <see cref="register_descriptor_tracking"/>).
+	/// </summary>
+	/// <param name="heap">Descriptor heap to query.</param>
+	/// <param name="offset">Offset from the start of the descriptor heap.</param>
+	/// <param name="out_type">Pointer to a variable that is set to the type of the descriptor, or <see langword="nullptr"/>.</param>
+	/// <param name="out_descriptor">Pointer to a variable that is filled with the descriptor data, which has to be large enough to fit a <see cref="api::buffer_range"/>, or <see langword="nullptr"/>.</param>
+	/// <returns><see langword="true"/> if a descriptor was tracked at the specified offset, <see langword="false"/> otherwise.</returns>
+	inline bool get_descriptor_state(api::descriptor_heap heap, uint32_t offset, api::descriptor_type *out_type, void *out_descriptor)
+	{
+#if defined(RESHADE_API_LIBRARY)
+		return ReShadeGetDescriptorState(heap, offset, out_type, out_descriptor);
+#else
+		static const auto func = reinterpret_cast<bool(*)(api::descriptor_heap, uint32_t, api::descriptor_type *, void *)>(
+			GetProcAddress(internal::get_reshade_module_handle(), "ReShadeGetDescriptorState"));
+		if (func != nullptr)
+			return func(heap, offset, out_type, out_descriptor);
+		return false;
+#endif
+	}
+	/// <summary>
+	/// Gets the description that was used to create the specified pipeline layout parameter (requires descriptor tracking to be enabled via <see cref="register_descriptor_tracking"/>).
+	/// </summary>
+	/// <param name="layout">Pipeline layout to query.</param>
+	/// <param name="param_index">Index of the parameter in the pipeline layout.</param>
+	/// <param name="out_param">Pointer to a variable that is set to the parameter description.</param>
+	/// <returns><see langword="true"/> if the pipeline layout parameter was tracked, <see langword="false"/> otherwise.</returns>
+	inline bool get_pipeline_layout_param(api::pipeline_layout layout, uint32_t param_index, api::pipeline_layout_param *out_param)
+	{
+#if defined(RESHADE_API_LIBRARY)
+		return ReShadeGetPipelineLayoutParam(layout, param_index, out_param);
+#else
+		static const auto func = reinterpret_cast<bool(*)(api::pipeline_layout, uint32_t, api::pipeline_layout_param *)>(
+			GetProcAddress(internal::get_reshade_module_handle(), "ReShadeGetPipelineLayoutParam"));
+		if (func != nullptr)
+			return func(layout, param_index, out_param);
+		return false;
+#endif
+	}
+
 	/// <summary>
 	/// Registers an overlay with ReShade.
 	/// <para>The callback function is then called when the overlay is visible and allows adding Dear ImGui widgets for user interaction.</para>
@@ -806,5 +806,66 @@ namespace reshade { namespace api
 		/// </summary>
 		/// <param name="effect_name">File name of the effect file that should be reloaded.</param>
 		virtual void reload_effect_next_frame(const char *effect_name) = 0;
+
+		/// <summary>
+		/// Gets the average GPU duration of the pass with the specified index in the specified technique.
+		/// This requires per-pass timestamp queries to be enabled via the "GatherGPUStatisticsPerPass" config option and only returns valid data while the statistics overlay is gathering GPU timings.
+		/// </summary>
+		/// <param name="technique">Opaque handle to the technique.</param>
+		/// <param name="pass_index">Index of the pass in the technique.</param>
+		/// <returns>Average GPU duration of the pass in nanoseconds, or zero when no timing data is available.</returns>
+		virtual uint64_t get_technique_pass_gpu_duration(effect_technique technique, size_t pass_index) const = 0;
+
+		/// <summary>
+		/// Captures a screenshot of the current back buffer resource and invokes the specified callback once the GPU has finished copying it, without blocking the calling thread.
+		/// The callback is invoked during a later present with the image data in 32 bits-per-pixel RGBA format, or with <c>pixels</c> set to <see langword="nullptr"/> if the capture failed.
+		/// </summary>
+		/// <param name="callback">Pointer to a function that is called with the captured image data.</param>
+		/// <param name="user_data">Opaque pointer that is passed through to <paramref name="callback"/> unchanged.</param>
+		/// <returns><see langword="true"/> if the capture was successfully started, <see langword="false"/> otherwise.</returns>
+		virtual bool capture_screenshot_async(void (*callback)(void *user_data, const uint8_t *pixels, uint32_t width, uint32_t height), void *user_data) = 0;
+
+		/// <summary>
+		/// Gets the handles of all uniform variables of loaded effects in a single call.
+		/// This is more efficient than <see cref="enumerate_uniform_variables"/> when the handles are stored anyway, since it avoids a callback invocation per variable.
+		/// </summary>
+		/// <param name="effect_name">File name of the effect file to get uniform variables from, or <see langword="nullptr"/> to get those of all loaded effects.</param>
+		/// <param name="out_variables">Pointer to an array that is filled with the uniform variable handles, or <see langword="nullptr"/> to query the number of variables.</param>
+		/// <param name="count">Pointer to an integer that contains the size of the array in <paramref name="out_variables"/> and is set to the number of handles written, or the total number of variables when <paramref name="out_variables"/> is <see langword="nullptr"/>.</param>
+		virtual void get_uniform_variables(const char *effect_name, effect_uniform_variable *out_variables, size_t *count) const = 0;
+
+		/// <summary>
+		/// Gets the handles of all techniques of loaded effects in a single call, in the order they are rendered in.
+		/// This is more efficient than <see cref="enumerate_techniques"/> when the handles are stored anyway, since it avoids a callback invocation per technique.
+		/// </summary>
+		/// <param name="effect_name">File name of the effect file to get techniques from, or <see langword="nullptr"/> to get those of all loaded effects.</param>
+		/// <param name="out_techniques">Pointer to an array that is filled with the technique handles, or <see langword="nullptr"/> to query the number of techniques.</param>
+		/// <param name="count">Pointer to an integer that contains the size of the array in <paramref name="out_techniques"/> and is set to the number of handles written, or the total number of techniques when <paramref name="out_techniques"/> is <see langword="nullptr"/>.</param>
+		virtual void get_techniques(const char *effect_name, effect_technique *out_techniques, size_t *count) = 0;
+
+		/// <summary>
+		/// Gets a percentile of the recent frame time distribution of the swap chain this effect runtime is operating on.
+		/// Unlike an average frame time, tail percentiles (like 95 or 99 percent) expose hitches that are otherwise hidden.
+		/// </summary>
+		/// <param name="percent">Percentile to query, between 0 and 100 (e.g. 99.0 for the 99th percentile).</param>
+		/// <returns>Upper bound on the frame duration in nanoseconds below which the specified percentage of recent frames finished, or zero when no frames were recorded yet.</returns>
+		virtual uint64_t get_frame_duration_percentile(float percent) const = 0;
+
+		/// <summary>
+		/// Gets a percentile of the recent GPU duration distribution of the specified technique.
+		/// This only returns valid data while the statistics overlay is gathering GPU timings.
+		/// </summary>
+		/// <param name="technique">Opaque handle to the technique.</param>
+		/// <param name="percent">Percentile to query, between 0 and 100 (e.g. 99.0 for the 99th percentile).</param>
+		/// <returns>Upper bound on the GPU duration in nanoseconds below which the specified percentage of recent executions of the technique finished, or zero when no timing data is available.</returns>
+		virtual uint64_t get_technique_gpu_duration_percentile(effect_technique technique, float percent) const = 0;
+
+		/// <summary>
+		/// Gets the amount of GPU memory in bytes occupied by the textures of the specified effect.
+		/// Pooled textures that are shared between multiple effects are counted towards each effect that references them, so summing over all effects may exceed the combined total.
+		/// </summary>
+		/// <param name="effect_name">File name of the effect file to query, or <see langword="nullptr"/> to get the combined memory usage of all loaded effects.</param>
+		/// <returns>Texture memory usage of the effect in bytes, or zero when the effect is not loaded.</returns>
+		virtual uint64_t get_effect_texture_memory_usage(const char *effect_name) const = 0;
 	};
 } }
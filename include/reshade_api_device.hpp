@@ -186,6 +186,11 @@ namespace reshade { namespace api
 		/// If this feature is not present, <see cref="resource_view_type::acceleration_structure"/>, <see cref="command_list::dispatch_rays"/>, <see cref="command_list::copy_acceleration_structure"/> and <see cref="command_list::build_acceleration_structure"/> must not be used.
 		/// </summary>
 		ray_tracing,
+		/// <summary>
+		/// Specifies whether mapping a sub-range of a constant buffer with <see cref="map_access::write_only"/> is supported.
+		/// If this feature is not present, constant buffers have to be mapped in their entirety with <see cref="map_access::write_discard"/>.
+		/// </summary>
+		partial_constant_buffer_updates,
 	};
 
 	/// <summary>
@@ -13,6 +13,9 @@
 // Check that the 'ImTextureID' type has the same size as 'reshade::api::resource_view'
 static_assert(sizeof(ImTextureID) == 8, "missing \"#define ImTextureID ImU64\" before \"#include <imgui.h>\"");
 
+// Signal to "reshade.hpp" that ImGui calls are dispatched through the function table defined below, rather than directly into a copy of Dear ImGui linked into the add-on
+#define RESHADE_OVERLAY_FUNCTION_TABLE 1
+
 struct imgui_function_table_19040
 {
 	ImGuiIO&(*GetIO)();
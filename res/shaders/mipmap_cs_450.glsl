@@ -0,0 +1,123 @@
+#version 450
+#extension GL_EXT_samplerless_texture_functions : require
+
+layout(binding = 0) uniform texture2DArray src;
+layout(binding = 1) uniform writeonly image2DArray mips[6];
+
+layout(push_constant) uniform cb0
+{
+	uint num_mips;
+};
+
+// Inspired by algorithm described in https://gpuopen.com/manuals/fidelityfx_sdk/fidelityfx_sdk-page_techniques_single-pass-downsampler/#algorithm-structure
+
+vec4 reduce(vec4 v0, vec4 v1, vec4 v2, vec4 v3)
+{
+	return (v0 + v1 + v2 + v3) * 0.25;
+}
+vec4 load_and_reduce(uvec2 location, uint slice)
+{
+	vec4 v0 = texelFetch(src, ivec3(location + uvec2(0u, 0u), slice), 0);
+	vec4 v1 = texelFetch(src, ivec3(location + uvec2(1u, 0u), slice), 0);
+	vec4 v2 = texelFetch(src, ivec3(location + uvec2(0u, 1u), slice), 0);
+	vec4 v3 = texelFetch(src, ivec3(location + uvec2(1u, 1u), slice), 0);
+	return reduce(v0, v1, v2, v3);
+}
+
+void store_mip(uint mip, uvec2 location, uint slice, vec4 v)
+{
+	imageStore(mips[mip - 1u], ivec3(location, slice), v);
+}
+
+uvec2 morton_to_xy(uint index)
+{
+	uvec2 xy = uvec2(index, index >> 1u);
+	xy &= 0x55555555u;
+	xy = (xy ^ (xy >> 1u)) & 0x33333333u;
+	xy = (xy ^ (xy >> 2u)) & 0x0F0F0F0Fu;
+	xy = (xy ^ (xy >> 4u)) & 0x00FF00FFu;
+	xy = (xy ^ (xy >> 8u)) & 0x0000FFFFu;
+	return xy;
+}
+
+shared vec4 intermediate[16 * 16];
+
+void downsample_mip_n(uint mip, uvec2 base_location, uint thread_index, uint slice)
+{
+	barrier();
+
+	const uint group = 1u << ((mip - 2u) * 2u);
+
+	if ((thread_index % group) == 0u)
+	{
+		vec4 v = reduce(
+			intermediate[thread_index + group * 0u / 4u],
+			intermediate[thread_index + group * 1u / 4u],
+			intermediate[thread_index + group * 2u / 4u],
+			intermediate[thread_index + group * 3u / 4u]);
+
+		intermediate[thread_index] = v;
+
+		store_mip(mip, base_location / (1u << mip), slice, v);
+	}
+}
+
+void downsample_mip_1_2(uvec2 base_location, uint thread_index, uint slice)
+{
+	// Each thread group downsamples a 64x64 tile, with each thread starting by loading 4x4 pixels
+	vec4 v[4];
+	v[0] = load_and_reduce(base_location + uvec2(0u, 0u), slice);
+	v[1] = load_and_reduce(base_location + uvec2(2u, 0u), slice);
+	v[2] = load_and_reduce(base_location + uvec2(0u, 2u), slice);
+	v[3] = load_and_reduce(base_location + uvec2(2u, 2u), slice);
+
+	// Downsample to 32x32 (each thread stores 2x2 pixels)
+	base_location /= 2u;
+	store_mip(1u, base_location + uvec2(0u, 0u), slice, v[0]);
+	store_mip(1u, base_location + uvec2(1u, 0u), slice, v[1]);
+	store_mip(1u, base_location + uvec2(0u, 1u), slice, v[2]);
+	store_mip(1u, base_location + uvec2(1u, 1u), slice, v[3]);
+
+	if (num_mips <= 2u)
+		return;
+
+	v[0] = reduce(v[0], v[1], v[2], v[3]);
+
+	intermediate[thread_index] = v[0];
+
+	// Downsample to 16x16 (each thread stores 1x1 pixels)
+	base_location /= 2u;
+	store_mip(2u, base_location, slice, v[0]);
+}
+void downsample_mip_3_6(uvec2 base_location, uint thread_index, uint slice)
+{
+	if (num_mips <= 3u)
+		return;
+	// Downsample to 8x8 (every 4th thread stores a pixel)
+	downsample_mip_n(3u, base_location, thread_index, slice);
+
+	if (num_mips <= 4u)
+		return;
+	// Downsample to 4x4 (every 16th thread stores a pixel)
+	downsample_mip_n(4u, base_location, thread_index, slice);
+
+	if (num_mips <= 5u)
+		return;
+	// Downsample to 2x2 (every 64th thread stores a pixel)
+	downsample_mip_n(5u, base_location, thread_index, slice);
+
+	if (num_mips <= 6u)
+		return;
+	// Downsample to 1x1 (every 256th thread stores a pixel)
+	downsample_mip_n(6u, base_location, thread_index, slice);
+}
+
+layout(local_size_x = 16 * 16, local_size_y = 1, local_size_z = 1) in;
+
+void main()
+{
+	uvec2 base_location = gl_WorkGroupID.xy * 64u + morton_to_xy(gl_LocalInvocationIndex) * (64u / 16u); // Each 16x16 thread group processes 64x64 pixels
+
+	downsample_mip_1_2(base_location, gl_LocalInvocationIndex, gl_WorkGroupID.z);
+	downsample_mip_3_6(base_location, gl_LocalInvocationIndex, gl_WorkGroupID.z);
+}
@@ -10,7 +10,11 @@
 #include "runtime.hpp"
 #include "dll_log.hpp"
 #include "ini_file.hpp"
+#include "file_write_queue.hpp"
+#include <mutex>
+#include <limits>
 #include <cstring> // std::strlen
+#include <algorithm> // std::find
 
 void ReShadeLogMessage([[maybe_unused]] HMODULE module, int level, const char *message)
 {
@@ -45,15 +49,26 @@ void ReShadeGetBasePath(char *path, size_t *size)
 	}
 }
 
+bool ReShadeWriteFileAsync(const wchar_t *path, const void *data, size_t size)
+{
+	if (path == nullptr || (data == nullptr && size != 0))
+		return false;
+
+	// The buffer has to be copied, since it only stays valid for the duration of this call, while the write happens later on a writer thread
+	std::vector<uint8_t> buffer(static_cast<const uint8_t *>(data), static_cast<const uint8_t *>(data) + size);
+
+	return reshade::get_file_write_queue().enqueue(std::filesystem::path(path), std::move(buffer));
+}
+
 bool ReShadeGetConfigValue(HMODULE, reshade::api::effect_runtime *runtime, const char *section, const char *key, char *value, size_t *size)
 {
 	ini_file &config = (runtime != nullptr) ? ini_file::load_cache(static_cast<reshade::runtime *>(runtime)->get_config_path()) : reshade::global_config();
 
-	const std::string section_string = section != nullptr ? section : std::string();
-	const std::string key_string = key != nullptr ? key : std::string();
+	const std::string_view section_view = section != nullptr ? std::string_view(section) : std::string_view();
+	const std::string_view key_view = key != nullptr ? std::string_view(key) : std::string_view();
 
 	std::vector<std::string> elements;
-	config.get(section_string, key_string, elements);
+	config.get(section_view, key_view, elements);
 
 	if (size != nullptr || value != nullptr)
 	{
@@ -93,12 +108,12 @@ void ReShadeSetConfigArray(HMODULE, reshade::api::effect_runtime *runtime, const
 {
 	ini_file &config = (runtime != nullptr) ? ini_file::load_cache(static_cast<reshade::runtime *>(runtime)->get_config_path()) : reshade::global_config();
 
-	const std::string section_string = section != nullptr ? section : std::string();
-	const std::string key_string = key != nullptr ? key : std::string();
+	const std::string_view section_view = section != nullptr ? std::string_view(section) : std::string_view();
+	const std::string_view key_view = key != nullptr ? std::string_view(key) : std::string_view();
 
 	if (size == 0)
 	{
-		config.remove_key(section_string, key_string);
+		config.remove_key(section_view, key_view);
 		return;
 	}
 
@@ -117,7 +132,137 @@ void ReShadeSetConfigArray(HMODULE, reshade::api::effect_runtime *runtime, const
 		elements[k] += value[i];
 	}
 
-	config.set(section_string, key_string, elements);
+	config.set(section_view, key_view, elements);
+}
+
+// Immutable copy of a single config section that add-ons can read from without taking the INI cache lock for every value (see 'ReShadeCreateConfigSnapshot')
+struct config_snapshot
+{
+	std::filesystem::path config_path;
+	std::string section;
+	// Generation of the source INI file at the time the values were copied, so that 'ReShadeUpdateConfigSnapshot' can skip rebuilding when nothing changed
+	size_t generation = std::numeric_limits<size_t>::max();
+	std::map<std::string, std::vector<std::string>, std::less<>> values;
+	void(*callback)(void *user_data) = nullptr;
+	void *user_data = nullptr;
+};
+
+static std::mutex s_config_snapshot_mutex;
+static std::vector<config_snapshot *> s_config_snapshots;
+
+static void on_ini_file_modified(const ini_file &file)
+{
+	const std::unique_lock<std::mutex> lock(s_config_snapshot_mutex);
+
+	for (config_snapshot *const snapshot : s_config_snapshots)
+		if (snapshot->callback != nullptr && snapshot->config_path == file.path())
+			snapshot->callback(snapshot->user_data);
+}
+
+void *ReShadeCreateConfigSnapshot(HMODULE, reshade::api::effect_runtime *runtime, const char *section, void(*callback)(void *user_data), void *user_data)
+{
+	if (section == nullptr)
+		return nullptr;
+
+	ini_file &config = (runtime != nullptr) ? ini_file::load_cache(static_cast<reshade::runtime *>(runtime)->get_config_path()) : reshade::global_config();
+
+	const auto snapshot = new config_snapshot();
+	// Store the resolved path of the cached INI file, so that it can be compared against the one passed to the modified callback
+	snapshot->config_path = config.path();
+	snapshot->section = section;
+	snapshot->callback = callback;
+	snapshot->user_data = user_data;
+
+	{	const std::unique_lock<std::mutex> lock(s_config_snapshot_mutex);
+
+		// Only hook into the INI modification tracking while snapshots actually exist
+		if (s_config_snapshots.empty())
+			ini_file::set_modified_callback(on_ini_file_modified);
+		s_config_snapshots.push_back(snapshot);
+	}
+
+	// Fill the snapshot with the current section contents
+	ReShadeUpdateConfigSnapshot(nullptr, snapshot);
+
+	return snapshot;
+}
+void ReShadeDestroyConfigSnapshot(HMODULE, void *snapshot_handle)
+{
+	if (snapshot_handle == nullptr)
+		return;
+
+	const auto snapshot = static_cast<config_snapshot *>(snapshot_handle);
+
+	{	const std::unique_lock<std::mutex> lock(s_config_snapshot_mutex);
+
+		if (const auto it = std::find(s_config_snapshots.begin(), s_config_snapshots.end(), snapshot);
+			it != s_config_snapshots.end())
+			s_config_snapshots.erase(it);
+		if (s_config_snapshots.empty())
+			ini_file::set_modified_callback(nullptr);
+	}
+
+	delete snapshot;
+}
+bool ReShadeUpdateConfigSnapshot(HMODULE, void *snapshot_handle)
+{
+	if (snapshot_handle == nullptr)
+		return false;
+
+	const auto snapshot = static_cast<config_snapshot *>(snapshot_handle);
+
+	ini_file &config = ini_file::load_cache(snapshot->config_path);
+
+	// Skip the costly section copy when the file contents have not changed since the last update
+	if (config.generation() == snapshot->generation)
+		return false;
+	snapshot->generation = config.generation();
+
+	config.get(snapshot->section, snapshot->values);
+
+	return true;
+}
+bool ReShadeGetConfigSnapshotValue(HMODULE, void *snapshot_handle, const char *key, char *value, size_t *size)
+{
+	if (snapshot_handle == nullptr)
+		return false;
+
+	const config_snapshot *const snapshot = static_cast<config_snapshot *>(snapshot_handle);
+
+	const auto it = snapshot->values.find(key != nullptr ? std::string_view(key) : std::string_view());
+	const bool exists = it != snapshot->values.end() && !it->second.empty();
+
+	if (size != nullptr || value != nullptr)
+	{
+		std::string value_string;
+		if (exists)
+		{
+			for (const std::string &element : it->second)
+			{
+				value_string += element;
+				value_string += '\0';
+			}
+		}
+
+		if (size != nullptr)
+		{
+			if (!exists)
+			{
+				*size = 0;
+			}
+			else if (value == nullptr)
+			{
+				*size = value_string.size() + 1;
+			}
+			else if (*size != 0)
+			{
+				*size = value_string.copy(value, *size - 1);
+				value[*size] = '\0';
+			}
+		}
+	}
+
+	return exists;
 }
 
 #if RESHADE_ADDON && RESHADE_FX
@@ -335,6 +480,22 @@ extern "C" __declspec(dllexport) const void *ReShadeGetImGuiFunctionTable(uint32
 	return nullptr;
 }
 
+extern "C" __declspec(dllexport) ImGuiContext *ReShadeGetImGuiContext(uint32_t version, ImGuiMemAllocFunc *out_alloc_func, ImGuiMemFreeFunc *out_free_func, void **out_alloc_user_data)
+{
+	// Only hand out the real context to add-ons built against the exact Dear ImGui version of this module, since any other version may have a different data layout (the function tables above exist as compatibility fallback for those)
+	if (version != IMGUI_VERSION_NUM)
+	{
+		reshade::log::message(reshade::log::level::error, "Failed to retrieve ImGui context, because the requested ImGui version (%u) does not exactly match the one built into this module (%u).", version, static_cast<unsigned int>(IMGUI_VERSION_NUM));
+		return nullptr;
+	}
+
+	if (out_alloc_func != nullptr && out_free_func != nullptr)
+		ImGui::GetAllocatorFunctions(out_alloc_func, out_free_func, out_alloc_user_data);
+
+	// This returns the context of the effect runtime whose overlay is currently being rendered, so is expected to be called from within an overlay callback (see 'reshade::make_imgui_context_current')
+	return ImGui::GetCurrentContext();
+}
+
 #endif
 
 #endif
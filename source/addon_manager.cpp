@@ -9,7 +9,13 @@
 #include "addon_manager.hpp"
 #include "dll_log.hpp"
 #include "ini_file.hpp"
-#include <algorithm> // std::find, std::find_if, std::remove, std::remove_if
+#include "lockfree_linear_map.hpp"
+#include <algorithm> // std::copy_n, std::find, std::find_if, std::remove, std::remove_if
+#include <atomic>
+#include <memory> // std::unique_ptr
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 
 extern void register_addon_depth();
 extern void register_addon_effect_runtime_sync();
@@ -20,8 +26,7 @@ extern HMODULE g_module_handle;
 
 extern std::filesystem::path get_module_path(HMODULE module);
 
-#if RESHADE_VERBOSE_LOG
-static const char *addon_event_to_string(reshade::addon_event ev)
+const char *reshade::addon_event_to_string(reshade::addon_event ev)
 {
 #define CASE(name) case reshade::addon_event::name: return #name
 	switch (ev)
@@ -125,15 +130,177 @@ static const char *addon_event_to_string(reshade::addon_event ev)
 #undef  CASE
 	return "unknown";
 }
-#endif
 
 #if RESHADE_ADDON == 1
 bool reshade::addon_enabled = true;
 #endif
 bool reshade::addon_all_loaded = true;
 std::vector<void *> reshade::addon_event_list[static_cast<uint32_t>(reshade::addon_event::max)];
+reshade::addon_event_table reshade::addon_event_tables[static_cast<uint32_t>(reshade::addon_event::max)] = {};
+std::atomic<uint64_t> reshade::addon_event_mask[2] = {};
+bool reshade::addon_event_profiling = false;
+reshade::addon_event_profile reshade::addon_event_profiles[static_cast<uint32_t>(reshade::addon_event::max)] = {};
 std::vector<reshade::addon_info> reshade::addon_loaded_info;
 static unsigned long s_reference_count = 0;
+// Serializes concurrent table rewrites (dispatch itself stays lock-free thanks to the seqlock in each table)
+static std::mutex s_addon_event_table_mutex;
+// Superseded overflow snapshots, kept alive until unload since frames in flight may still be dispatching from them
+static std::vector<std::unique_ptr<void *[]>> s_retired_event_callbacks;
+// Serializes add-on and event callback (un)registration, since add-on modules are loaded from multiple worker threads in parallel (see 'load_addons')
+// This has to be recursive because unloading an add-on in turn unregisters all its remaining event and overlay callbacks
+static std::recursive_mutex s_addon_registration_mutex;
+
+#if RESHADE_ADDON == 1
+// Subscription bitmask before the global add-on enabled state is applied, which is filtered into the published 'addon_event_mask' (see 'reshade::enable_addons')
+static std::atomic<uint64_t> s_subscribed_event_mask[2] = {};
+
+static constexpr uint64_t make_always_enabled_event_mask(size_t word)
+{
+	// Events that continue to be dispatched even while add-ons are disabled, to ensure object lifetime tracking continues working correctly
+	constexpr reshade::addon_event always_enabled_events[] = {
+		reshade::addon_event::init_device,
+		reshade::addon_event::destroy_device,
+		reshade::addon_event::init_command_list,
+		reshade::addon_event::destroy_command_list,
+		reshade::addon_event::init_command_queue,
+		reshade::addon_event::destroy_command_queue,
+		reshade::addon_event::init_swapchain,
+		reshade::addon_event::destroy_swapchain,
+		reshade::addon_event::init_effect_runtime,
+		reshade::addon_event::destroy_effect_runtime,
+		reshade::addon_event::init_sampler,
+		reshade::addon_event::destroy_sampler,
+		reshade::addon_event::init_resource,
+		reshade::addon_event::destroy_resource,
+		reshade::addon_event::init_resource_view,
+		reshade::addon_event::destroy_resource_view,
+		reshade::addon_event::init_pipeline,
+		reshade::addon_event::destroy_pipeline,
+		reshade::addon_event::init_pipeline_layout,
+		reshade::addon_event::destroy_pipeline_layout,
+		reshade::addon_event::init_query_heap,
+		reshade::addon_event::destroy_query_heap,
+	};
+
+	uint64_t mask = 0;
+	for (const reshade::addon_event ev : always_enabled_events)
+		if (static_cast<uint32_t>(ev) / 64 == word)
+			mask |= 1ull << (static_cast<uint32_t>(ev) % 64);
+	return mask;
+}
+static constexpr uint64_t s_always_enabled_event_mask[2] = { make_always_enabled_event_mask(0), make_always_enabled_event_mask(1) };
+
+void reshade::enable_addons(bool enabled)
+{
+	const std::unique_lock<std::mutex> lock(s_addon_event_table_mutex);
+
+	addon_enabled = enabled;
+
+	// Republish the event presence bitmask with the new enabled state folded in, so that dispatch only has to test a single bit per event
+	for (size_t word = 0; word < std::size(addon_event_mask); ++word)
+	{
+		uint64_t mask = s_subscribed_event_mask[word].load(std::memory_order_relaxed);
+		if (!enabled)
+			mask &= s_always_enabled_event_mask[word];
+		addon_event_mask[word].store(mask, std::memory_order_relaxed);
+	}
+}
+#endif
+
+void reshade::update_addon_event_table(reshade::addon_event ev)
+{
+	const std::unique_lock<std::mutex> lock(s_addon_event_table_mutex);
+
+	const std::vector<void *> &event_list = addon_event_list[static_cast<uint32_t>(ev)];
+	addon_event_table &event_table = addon_event_tables[static_cast<uint32_t>(ev)];
+
+	const uint32_t count = static_cast<uint32_t>(event_list.size());
+
+	// Build a new immutable snapshot before publishing anything when the list does not fit the inline table
+	void **overflow_callbacks = nullptr;
+	if (count > std::size(event_table.callbacks))
+	{
+		overflow_callbacks = new void *[count];
+		std::copy_n(event_list.begin(), count, overflow_callbacks);
+	}
+
+	void *const *const previous_overflow_callbacks = event_table.overflow_callbacks;
+
+	// Make the sequence number odd for the duration of the rewrite, so concurrent dispatch retries instead of reading a partially updated table
+	event_table.generation.fetch_add(1, std::memory_order_acq_rel);
+
+	event_table.count.store(count, std::memory_order_relaxed);
+	if (count <= std::size(event_table.callbacks))
+		std::copy_n(event_list.begin(), count, event_table.callbacks);
+	event_table.overflow_callbacks = overflow_callbacks;
+
+	// Reset the profiling accumulators, since slot assignment may have changed and stale data would be attributed to the wrong callback
+	addon_event_profile &event_profile = addon_event_profiles[static_cast<uint32_t>(ev)];
+	for (size_t cb = 0; cb < std::size(event_profile.call_count); ++cb)
+	{
+		event_profile.call_count[cb].store(0, std::memory_order_relaxed);
+		event_profile.total_duration[cb].store(0, std::memory_order_relaxed);
+	}
+
+	event_table.generation.fetch_add(1, std::memory_order_release);
+
+	// Defer reclamation of the previous snapshot, dispatch on another thread may still be walking it
+	if (previous_overflow_callbacks != nullptr)
+		s_retired_event_callbacks.emplace_back(const_cast<void **>(previous_overflow_callbacks));
+
+	// Update the global presence bitmask last, since it gates dispatch for this event
+	const uint64_t event_bit = 1ull << (static_cast<uint32_t>(ev) % 64);
+#if RESHADE_ADDON == 1
+	uint64_t mask;
+	if (event_list.empty())
+		mask = s_subscribed_event_mask[static_cast<uint32_t>(ev) / 64].fetch_and(~event_bit, std::memory_order_relaxed) & ~event_bit;
+	else
+		mask = s_subscribed_event_mask[static_cast<uint32_t>(ev) / 64].fetch_or(event_bit, std::memory_order_relaxed) | event_bit;
+	// The published bitmask has the global add-on enabled state folded in (see 'enable_addons')
+	if (!addon_enabled)
+		mask &= s_always_enabled_event_mask[static_cast<uint32_t>(ev) / 64];
+	addon_event_mask[static_cast<uint32_t>(ev) / 64].store(mask, std::memory_order_relaxed);
+#else
+	if (event_list.empty())
+		addon_event_mask[static_cast<uint32_t>(ev) / 64].fetch_and(~event_bit, std::memory_order_relaxed);
+	else
+		addon_event_mask[static_cast<uint32_t>(ev) / 64].fetch_or(event_bit, std::memory_order_relaxed);
+#endif
+}
+
+bool reshade::get_addon_event_profiling(reshade::addon_event ev, void *callback, uint64_t &call_count, uint64_t &total_duration)
+{
+	const addon_event_table &event_table = addon_event_tables[static_cast<uint32_t>(ev)];
+	const addon_event_profile &event_profile = addon_event_profiles[static_cast<uint32_t>(ev)];
+
+	const uint32_t count = event_table.count.load(std::memory_order_acquire);
+	if (count > std::size(event_table.callbacks))
+		return false; // No profiling data is recorded when the flat dispatch table overflowed
+
+	for (uint32_t cb = 0; cb < count; ++cb)
+	{
+		if (event_table.callbacks[cb] != callback)
+			continue;
+
+		call_count = event_profile.call_count[cb].load(std::memory_order_relaxed);
+		total_duration = event_profile.total_duration[cb].load(std::memory_order_relaxed);
+		return true;
+	}
+
+	return false;
+}
+void reshade::clear_addon_event_profiles()
+{
+	for (uint32_t ev = 0; ev < static_cast<uint32_t>(addon_event::max); ++ev)
+	{
+		addon_event_profile &event_profile = addon_event_profiles[ev];
+		for (size_t cb = 0; cb < std::size(event_profile.call_count); ++cb)
+		{
+			event_profile.call_count[cb].store(0, std::memory_order_relaxed);
+			event_profile.total_duration[cb].store(0, std::memory_order_relaxed);
+		}
+	}
+}
 
 void reshade::load_addons()
 {
@@ -195,6 +362,7 @@ void reshade::load_addons()
 		") in '%s' ...", addon_search_path.u8string().c_str());
 
 	std::error_code ec;
+	std::vector<std::filesystem::path> addon_files;
 	for (std::filesystem::path path : std::filesystem::directory_iterator(addon_search_path, std::filesystem::directory_options::skip_permission_denied, ec))
 	{
 		if (path.extension() != L".addon" &&
@@ -228,61 +396,99 @@ void reshade::load_addons()
 			continue;
 		}
 
+		addon_files.push_back(std::move(path));
+#endif
+	}
+
+	if (ec)
+		log::message(log::level::warning, "Failed to iterate all files in '%s' with error code %d!", addon_search_path.u8string().c_str(), ec.value());
+
+#if RESHADE_ADDON >= 2
+	const auto load_addon_file = [](const std::filesystem::path &path) -> bool {
 		log::message(log::level::info, "Loading add-on from '%s' ...", path.u8string().c_str());
 
+		// Check whether the add-on registered itself as disabled while it was loading (in which case a load failure is expected and should not be logged as an error)
+		const auto is_disabled_after_load = [&path]() {
+			const std::unique_lock<std::recursive_mutex> lock(s_addon_registration_mutex);
+
+			const std::string file_name = path.filename().u8string();
+			return std::find_if(addon_loaded_info.cbegin(), addon_loaded_info.cend(),
+				[&file_name](const addon_info &info) {
+					return info.handle == nullptr && info.file == file_name;
+				}) != addon_loaded_info.cend();
+		};
+
 		// Use 'LOAD_LIBRARY_SEARCH_DLL_LOAD_DIR' to temporarily add add-on search path to the list of directories 'LoadLibraryEx' will use to resolve DLL dependencies
 		const HMODULE module = LoadLibraryExW(path.c_str(), nullptr, LOAD_LIBRARY_SEARCH_DLL_LOAD_DIR | LOAD_LIBRARY_SEARCH_DEFAULT_DIRS);
 		if (module == nullptr)
 		{
 			const DWORD error_code = GetLastError();
 
-			if (error_code == ERROR_DLL_INIT_FAILED && !addon_loaded_info.empty() && path.filename().u8string() == addon_loaded_info.back().file)
+			if (error_code == ERROR_DLL_INIT_FAILED && is_disabled_after_load())
 			{
-				// Avoid logging an error if loading failed because the add-on is disabled
-				assert(addon_loaded_info.back().handle == nullptr);
-
 				log::message(log::level::warning, "> Add-on failed to initialize or is disabled. Skipped.");
+				return true;
 			}
-			else
-			{
-				addon_all_loaded = false;
-				log::message(log::level::error, "Failed to load add-on from '%s' with error code %lu!", path.u8string().c_str(), error_code);
-			}
-			continue;
+
+			log::message(log::level::error, "Failed to load add-on from '%s' with error code %lu!", path.u8string().c_str(), error_code);
+			return false;
 		}
 
 		// Call optional loading entry point (for add-ons wanting to do more complicated one-time initialization than possible in 'DllMain')
 		const auto init_func = reinterpret_cast<bool(*)(HMODULE addon_module, HMODULE reshade_module)>(GetProcAddress(module, "AddonInit"));
 		if (init_func != nullptr && !init_func(module, g_module_handle))
 		{
-			if (!addon_loaded_info.empty() && path.filename().u8string() == addon_loaded_info.back().file)
-			{
-				assert(addon_loaded_info.back().handle == nullptr);
-
+			const bool disabled = is_disabled_after_load();
+			if (disabled)
 				log::message(log::level::warning, "> Add-on failed to initialize or is disabled. Skipped.");
-			}
 			else
-			{
-				addon_all_loaded = false;
 				log::message(log::level::error, "Failed to load add-on from '%s' because initialization was not successful!", path.u8string().c_str());
-			}
 
 			FreeLibrary(module);
-			continue;
+			return disabled;
 		}
 
-		if (find_addon(module) == nullptr)
 		{
-			addon_all_loaded = false;
-			log::message(log::level::warning, "No add-on was registered by '%s'. Unloading again ...", path.u8string().c_str());
+			const std::unique_lock<std::recursive_mutex> lock(s_addon_registration_mutex);
 
-			FreeLibrary(module);
+			if (find_addon(module) != nullptr)
+				return true;
 		}
-#endif
-	}
 
-	if (ec)
-		log::message(log::level::warning, "Failed to iterate all files in '%s' with error code %d!", addon_search_path.u8string().c_str(), ec.value());
+		log::message(log::level::warning, "No add-on was registered by '%s'. Unloading again ...", path.u8string().c_str());
+
+		// Do not call 'FreeLibrary' while holding the registration mutex, since another thread may be inside 'DllMain' (so holding the loader lock) and attempting to acquire that mutex
+		FreeLibrary(module);
+		return false;
+	};
+
+	if (addon_files.size() > 1)
+	{
+		// Load add-on modules with multiple worker threads, so that startup is not gated on the sum of all their initialization times
+		// The OS loader serializes the 'DllMain' calls, but file I/O and the 'AddonInit' entry points overlap, while registration stays safe through 's_addon_registration_mutex'
+		std::atomic<size_t> next_file_index = 0;
+		std::atomic<bool> all_loaded = { true };
+
+		std::vector<std::thread> worker_threads(std::min<size_t>(addon_files.size(), std::thread::hardware_concurrency()));
+		for (std::thread &worker_thread : worker_threads)
+			worker_thread = std::thread([&addon_files, &next_file_index, &all_loaded, &load_addon_file]() {
+				for (size_t file_index; (file_index = next_file_index.fetch_add(1, std::memory_order_relaxed)) < addon_files.size();)
+					if (!load_addon_file(addon_files[file_index]))
+						all_loaded.store(false, std::memory_order_relaxed);
+			});
+		for (std::thread &worker_thread : worker_threads)
+			worker_thread.join();
+
+		if (!all_loaded)
+			addon_all_loaded = false;
+	}
+	else
+	{
+		for (const std::filesystem::path &path : addon_files)
+			if (!load_addon_file(path))
+				addon_all_loaded = false;
+	}
+#endif
 }
 void reshade::unload_addons()
 {
@@ -329,6 +535,12 @@ void reshade::unload_addons()
 		assert(event_info.empty());
 #endif
 
+	// All effect runtimes are gone at this point, so no event dispatch can still be walking a retired callback list snapshot
+	{
+		const std::unique_lock<std::mutex> lock(s_addon_event_table_mutex);
+		s_retired_event_callbacks.clear();
+	}
+
 	addon_loaded_info.clear();
 }
 
@@ -424,6 +636,9 @@ bool ReShadeRegisterAddon(HMODULE module, uint32_t api_version)
 	if (const char *const *description = reinterpret_cast<const char *const *>(GetProcAddress(module, "DESCRIPTION")))
 		info.description = *description;
 
+	// Only acquire the registration mutex after the loader calls above, since those acquire the loader lock, which a thread already holding this mutex must never wait on
+	const std::unique_lock<std::recursive_mutex> lock(s_addon_registration_mutex);
+
 	if (std::find_if(reshade::addon_loaded_info.cbegin(), reshade::addon_loaded_info.cend(),
 			[&info](const reshade::addon_info &existing_info) {
 				return existing_info.name == info.name;
@@ -460,6 +675,8 @@ void ReShadeUnregisterAddon(HMODULE module)
 	if (module == nullptr || module == g_module_handle)
 		return;
 
+	const std::unique_lock<std::recursive_mutex> lock(s_addon_registration_mutex);
+
 	reshade::addon_info *const info = reshade::find_addon(module);
 	if (info == nullptr)
 		return;
@@ -494,6 +711,8 @@ void ReShadeRegisterEventForAddon(HMODULE module, reshade::addon_event ev, void
 	if (ev >= reshade::addon_event::max)
 		return;
 
+	const std::unique_lock<std::recursive_mutex> lock(s_addon_registration_mutex);
+
 	reshade::addon_info *const info = reshade::find_addon(module != nullptr ? module : callback);
 	if (info == nullptr)
 	{
@@ -515,10 +734,12 @@ void ReShadeRegisterEventForAddon(HMODULE module, reshade::addon_event ev, void
 	std::vector<void *> &event_list = reshade::addon_event_list[static_cast<uint32_t>(ev)];
 	event_list.push_back(callback);
 
+	reshade::update_addon_event_table(ev);
+
 	info->event_callbacks.emplace_back(static_cast<uint32_t>(ev), callback);
 
 #if RESHADE_VERBOSE_LOG
-	reshade::log::message(reshade::log::level::debug, "Registered event callback %p for event %s.", callback, addon_event_to_string(ev));
+	reshade::log::message(reshade::log::level::debug, "Registered event callback %p for event %s.", callback, reshade::addon_event_to_string(ev));
 #endif
 }
 void ReShadeUnregisterEvent(reshade::addon_event ev, void *callback)
@@ -530,6 +751,8 @@ void ReShadeUnregisterEventForAddon(HMODULE module, reshade::addon_event ev, voi
 	if (ev >= reshade::addon_event::max)
 		return;
 
+	const std::unique_lock<std::recursive_mutex> lock(s_addon_registration_mutex);
+
 	reshade::addon_info *const info = reshade::find_addon(module != nullptr ? module : callback);
 	if (info == nullptr)
 		return; // Do not log an error here, since this may be called if an add-on failed to load
@@ -544,13 +767,299 @@ void ReShadeUnregisterEventForAddon(HMODULE module, reshade::addon_event ev, voi
 	std::vector<void *> &event_list = reshade::addon_event_list[static_cast<uint32_t>(ev)];
 	event_list.erase(std::remove(event_list.begin(), event_list.end(), callback), event_list.end());
 
+	reshade::update_addon_event_table(ev);
+
 	info->event_callbacks.erase(std::remove(info->event_callbacks.begin(), info->event_callbacks.end(), std::make_pair(static_cast<uint32_t>(ev), callback)), info->event_callbacks.end());
 
 #if RESHADE_VERBOSE_LOG
-	reshade::log::message(reshade::log::level::debug, "Unregistered event callback %p for event %s.", callback, addon_event_to_string(ev));
+	reshade::log::message(reshade::log::level::debug, "Unregistered event callback %p for event %s.", callback, reshade::addon_event_to_string(ev));
 #endif
 }
 
+void ReShadeSetEventProfiling(bool enabled)
+{
+	if (enabled && !reshade::addon_event_profiling)
+		reshade::clear_addon_event_profiles();
+
+	reshade::addon_event_profiling = enabled;
+}
+bool ReShadeGetEventProfiling(reshade::addon_event ev, void *callback, uint64_t *out_call_count, uint64_t *out_total_duration_ns)
+{
+	if (ev >= reshade::addon_event::max || callback == nullptr)
+		return false;
+
+	uint64_t call_count = 0, total_duration = 0;
+	if (!reshade::get_addon_event_profiling(ev, callback, call_count, total_duration))
+		return false;
+
+	if (out_call_count != nullptr)
+		*out_call_count = call_count;
+	if (out_total_duration_ns != nullptr)
+		*out_total_duration_ns = total_duration;
+	return true;
+}
+
+// Shadow copy of the descriptors in a descriptor heap, tracked on behalf of all add-ons that enabled descriptor tracking, so that the tracking cost is only paid once
+struct descriptor_heap_state
+{
+	struct descriptor
+	{
+		descriptor() : b() {}
+
+		reshade::api::descriptor_type type = {};
+		union
+		{
+			reshade::api::buffer_range b;
+			reshade::api::sampler_with_resource_view t;
+		};
+	};
+
+	std::shared_mutex mutex;
+	std::vector<descriptor> descriptors;
+};
+
+// Copy of the parameters a pipeline layout was created with, including the descriptor range data they point to
+struct pipeline_layout_state
+{
+	std::vector<reshade::api::pipeline_layout_param> params;
+	std::vector<std::vector<reshade::api::descriptor_range>> ranges;
+	std::vector<std::vector<reshade::api::descriptor_range_with_static_samplers>> ranges_with_static_samplers;
+};
+
+static std::mutex s_descriptor_tracking_mutex;
+static unsigned int s_descriptor_tracking_references = 0;
+// States are kept alive after tracking was disabled and across descriptor heap or pipeline layout destruction, since there are no events to clean heaps up by and a query may still be in flight on another thread (descriptor updates simply overwrite any stale data when a handle is reused)
+static lockfree_linear_map<uint64_t, descriptor_heap_state *, 128> s_descriptor_heap_states;
+static lockfree_linear_map<uint64_t, pipeline_layout_state *, 128> s_pipeline_layout_states;
+
+static descriptor_heap_state *get_descriptor_heap_state(reshade::api::descriptor_heap heap)
+{
+	descriptor_heap_state *state = s_descriptor_heap_states.at(heap.handle);
+	if (state == nullptr)
+	{
+		const std::unique_lock<std::mutex> lock(s_descriptor_tracking_mutex);
+
+		// Check again in case another thread created the state in the meantime
+		state = s_descriptor_heap_states.at(heap.handle);
+		if (state == nullptr)
+		{
+			state = new descriptor_heap_state();
+			s_descriptor_heap_states.emplace(heap.handle, state);
+		}
+	}
+
+	return state;
+}
+
+static void on_track_init_pipeline_layout(reshade::api::device *, uint32_t count, const reshade::api::pipeline_layout_param *params, reshade::api::pipeline_layout layout)
+{
+	pipeline_layout_state *state = s_pipeline_layout_states.at(layout.handle);
+	if (state == nullptr)
+	{
+		const std::unique_lock<std::mutex> lock(s_descriptor_tracking_mutex);
+
+		state = s_pipeline_layout_states.at(layout.handle);
+		if (state == nullptr)
+		{
+			state = new pipeline_layout_state();
+			s_pipeline_layout_states.emplace(layout.handle, state);
+		}
+	}
+
+	state->params.assign(params, params + count);
+	state->ranges.resize(count);
+	state->ranges_with_static_samplers.resize(count);
+
+	// Deep copy the descriptor range data, so that the parameter description stays valid for as long as the layout exists
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (params[i].type == reshade::api::pipeline_layout_param_type::descriptor_table)
+		{
+			state->ranges[i].assign(params[i].descriptor_table.ranges, params[i].descriptor_table.ranges + params[i].descriptor_table.count);
+			state->params[i].descriptor_table.ranges = state->ranges[i].data();
+		}
+		else
+		if (params[i].type == reshade::api::pipeline_layout_param_type::descriptor_table_with_static_samplers)
+		{
+			state->ranges_with_static_samplers[i].assign(params[i].descriptor_table_with_static_samplers.ranges, params[i].descriptor_table_with_static_samplers.ranges + params[i].descriptor_table_with_static_samplers.count);
+			state->params[i].descriptor_table_with_static_samplers.ranges = state->ranges_with_static_samplers[i].data();
+		}
+	}
+}
+static void on_track_destroy_pipeline_layout(reshade::api::device *, reshade::api::pipeline_layout layout)
+{
+	pipeline_layout_state *const state = s_pipeline_layout_states.at(layout.handle);
+	if (state != nullptr)
+	{
+		state->params.clear();
+		state->ranges.clear();
+		state->ranges_with_static_samplers.clear();
+	}
+}
+
+static bool on_track_copy_descriptor_tables(reshade::api::device *device, uint32_t count, const reshade::api::descriptor_table_copy *copies)
+{
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const reshade::api::descriptor_table_copy &copy = copies[i];
+
+		uint32_t src_offset;
+		reshade::api::descriptor_heap src_heap;
+		device->get_descriptor_heap_offset(copy.source_table, copy.source_binding, copy.source_array_offset, &src_heap, &src_offset);
+
+		uint32_t dst_offset;
+		reshade::api::descriptor_heap dst_heap;
+		device->get_descriptor_heap_offset(copy.dest_table, copy.dest_binding, copy.dest_array_offset, &dst_heap, &dst_offset);
+
+		descriptor_heap_state *const src_state = get_descriptor_heap_state(src_heap);
+		descriptor_heap_state *const dst_state = get_descriptor_heap_state(dst_heap);
+
+		std::unique_lock<std::shared_mutex> dst_lock(dst_state->mutex, std::defer_lock);
+		std::shared_lock<std::shared_mutex> src_lock(src_state->mutex, std::defer_lock);
+		if (src_state != dst_state)
+			std::lock(dst_lock, src_lock); // Lock both heaps without risking a deadlock with a copy in the opposite direction on another thread
+		else
+			dst_lock.lock();
+
+		if (dst_offset + copy.count > dst_state->descriptors.size())
+			dst_state->descriptors.resize(dst_offset + copy.count);
+
+		for (uint32_t k = 0; k < copy.count; ++k)
+		{
+			// The source heap may not contain tracked descriptors at this offset (e.g. when they were written before tracking was enabled)
+			if (src_offset + k < src_state->descriptors.size())
+				dst_state->descriptors[dst_offset + k] = src_state->descriptors[src_offset + k];
+			else
+				dst_state->descriptors[dst_offset + k] = {};
+		}
+	}
+
+	return false;
+}
+static bool on_track_update_descriptor_tables(reshade::api::device *device, uint32_t count, const reshade::api::descriptor_table_update *updates)
+{
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const reshade::api::descriptor_table_update &update = updates[i];
+
+		uint32_t offset;
+		reshade::api::descriptor_heap heap;
+		device->get_descriptor_heap_offset(update.table, update.binding, update.array_offset, &heap, &offset);
+
+		descriptor_heap_state *const state = get_descriptor_heap_state(heap);
+
+		const std::unique_lock<std::shared_mutex> lock(state->mutex);
+
+		if (offset + update.count > state->descriptors.size())
+			state->descriptors.resize(offset + update.count);
+
+		for (uint32_t k = 0; k < update.count; ++k)
+		{
+			descriptor_heap_state::descriptor &descriptor = state->descriptors[offset + k];
+
+			descriptor.type = update.type;
+
+			switch (update.type)
+			{
+			case reshade::api::descriptor_type::sampler:
+				descriptor.t.sampler = static_cast<const reshade::api::sampler *>(update.descriptors)[k];
+				break;
+			case reshade::api::descriptor_type::sampler_with_resource_view:
+				descriptor.t = static_cast<const reshade::api::sampler_with_resource_view *>(update.descriptors)[k];
+				break;
+			case reshade::api::descriptor_type::shader_resource_view:
+			case reshade::api::descriptor_type::unordered_access_view:
+				descriptor.t.view = static_cast<const reshade::api::resource_view *>(update.descriptors)[k];
+				break;
+			case reshade::api::descriptor_type::constant_buffer:
+			case reshade::api::descriptor_type::acceleration_structure:
+				descriptor.b = static_cast<const reshade::api::buffer_range *>(update.descriptors)[k];
+				break;
+			}
+		}
+	}
+
+	return false;
+}
+
+void ReShadeRegisterDescriptorTracking()
+{
+	const std::unique_lock<std::mutex> lock(s_descriptor_tracking_mutex);
+
+	// Only register the event callbacks once, so that multiple add-ons can share a single tracker
+	if (s_descriptor_tracking_references++ != 0)
+		return;
+
+	reshade::register_event<reshade::addon_event::init_pipeline_layout>(on_track_init_pipeline_layout);
+	reshade::register_event<reshade::addon_event::destroy_pipeline_layout>(on_track_destroy_pipeline_layout);
+
+	reshade::register_event<reshade::addon_event::copy_descriptor_tables>(on_track_copy_descriptor_tables);
+	reshade::register_event<reshade::addon_event::update_descriptor_tables>(on_track_update_descriptor_tables);
+}
+void ReShadeUnregisterDescriptorTracking()
+{
+	const std::unique_lock<std::mutex> lock(s_descriptor_tracking_mutex);
+
+	assert(s_descriptor_tracking_references != 0);
+	if (--s_descriptor_tracking_references != 0)
+		return;
+
+	reshade::unregister_event<reshade::addon_event::init_pipeline_layout>(on_track_init_pipeline_layout);
+	reshade::unregister_event<reshade::addon_event::destroy_pipeline_layout>(on_track_destroy_pipeline_layout);
+
+	reshade::unregister_event<reshade::addon_event::copy_descriptor_tables>(on_track_copy_descriptor_tables);
+	reshade::unregister_event<reshade::addon_event::update_descriptor_tables>(on_track_update_descriptor_tables);
+}
+
+bool ReShadeGetDescriptorState(reshade::api::descriptor_heap heap, uint32_t offset, reshade::api::descriptor_type *out_type, void *out_descriptor)
+{
+	descriptor_heap_state *const state = s_descriptor_heap_states.at(heap.handle);
+	if (state == nullptr)
+		return false;
+
+	const std::shared_lock<std::shared_mutex> lock(state->mutex);
+
+	if (offset >= state->descriptors.size())
+		return false;
+
+	const descriptor_heap_state::descriptor &descriptor = state->descriptors[offset];
+
+	if (out_type != nullptr)
+		*out_type = descriptor.type;
+
+	if (out_descriptor != nullptr)
+	{
+		switch (descriptor.type)
+		{
+		case reshade::api::descriptor_type::sampler:
+			*static_cast<reshade::api::sampler *>(out_descriptor) = descriptor.t.sampler;
+			break;
+		case reshade::api::descriptor_type::sampler_with_resource_view:
+			*static_cast<reshade::api::sampler_with_resource_view *>(out_descriptor) = descriptor.t;
+			break;
+		case reshade::api::descriptor_type::shader_resource_view:
+		case reshade::api::descriptor_type::unordered_access_view:
+			*static_cast<reshade::api::resource_view *>(out_descriptor) = descriptor.t.view;
+			break;
+		case reshade::api::descriptor_type::constant_buffer:
+		case reshade::api::descriptor_type::acceleration_structure:
+			*static_cast<reshade::api::buffer_range *>(out_descriptor) = descriptor.b;
+			break;
+		}
+	}
+
+	return true;
+}
+bool ReShadeGetPipelineLayoutParam(reshade::api::pipeline_layout layout, uint32_t param_index, reshade::api::pipeline_layout_param *out_param)
+{
+	pipeline_layout_state *const state = s_pipeline_layout_states.at(layout.handle);
+	if (state == nullptr || param_index >= state->params.size() || out_param == nullptr)
+		return false;
+
+	*out_param = state->params[param_index];
+	return true;
+}
+
 #if RESHADE_GUI
 
 void ReShadeRegisterOverlay(const char *title, void(*callback)(reshade::api::effect_runtime *runtime))
@@ -559,6 +1068,8 @@ void ReShadeRegisterOverlay(const char *title, void(*callback)(reshade::api::eff
 }
 void ReShadeRegisterOverlayForAddon(HMODULE module, const char *title, void(*callback)(reshade::api::effect_runtime *runtime))
 {
+	const std::unique_lock<std::recursive_mutex> lock(s_addon_registration_mutex);
+
 	reshade::addon_info *const info = reshade::find_addon(module != nullptr ? module : static_cast<void *>(callback));
 	if (info == nullptr)
 	{
@@ -586,6 +1097,8 @@ void ReShadeUnregisterOverlay(const char *title, void(*callback)(reshade::api::e
 }
 void ReShadeUnregisterOverlayForAddon(HMODULE module, const char *title, void(*callback)(reshade::api::effect_runtime *runtime))
 {
+	const std::unique_lock<std::recursive_mutex> lock(s_addon_registration_mutex);
+
 	reshade::addon_info *const info = reshade::find_addon(module != nullptr ? module : static_cast<void *>(callback));
 	if (info == nullptr)
 		return; // Do not log an error here, since this may be called if an add-on failed to load
@@ -7,6 +7,8 @@
 
 #include "addon.hpp"
 #include "reshade_events.hpp"
+#include <atomic>
+#include <chrono>
 
 #if RESHADE_ADDON
 
@@ -15,8 +17,15 @@ namespace reshade
 #if RESHADE_ADDON == 1
 	/// <summary>
 	/// Global switch to enable or disable all loaded add-ons.
+	/// Only change this via <see cref="enable_addons"/>, so that the event presence bitmask is updated along with it.
 	/// </summary>
 	extern bool addon_enabled;
+
+	/// <summary>
+	/// Enables or disables all loaded add-ons, by filtering the event presence bitmask down to the events that continue to be dispatched while add-ons are disabled.
+	/// Folding the disabled state into the bitmask keeps the fast path of <see cref="invoke_addon_event"/> a single bit test, instead of a separate enabled check on every call.
+	/// </summary>
+	void enable_addons(bool enabled);
 #endif
 	extern bool addon_all_loaded;
 
@@ -25,6 +34,75 @@ namespace reshade
 	/// </summary>
 	extern std::vector<void *> addon_event_list[];
 
+	/// <summary>
+	/// Fixed-capacity mirror of an entry in <see cref="addon_event_list"/>, aligned to cache line boundaries, so that the event dispatch in <see cref="invoke_addon_event"/> is a flat pointer-array walk without any vector indirection.
+	/// </summary>
+	struct alignas(64) addon_event_table
+	{
+		/// <summary>
+		/// Sequence number that is odd while the table is being rewritten.
+		/// Dispatch reads the table seqlock style, retrying when this changed or is odd, so callbacks can be registered and unregistered mid-frame without dispatch ever taking a lock.
+		/// </summary>
+		std::atomic<uint32_t> generation;
+		/// <summary>
+		/// Number of registered callbacks. When this exceeds the capacity of <see cref="callbacks"/>, dispatch walks <see cref="overflow_callbacks"/> instead.
+		/// </summary>
+		std::atomic<uint32_t> count;
+		/// <summary>
+		/// Immutable heap snapshot of the callback list, only valid while <see cref="count"/> exceeds the capacity of <see cref="callbacks"/>.
+		/// Superseded snapshots are retired and reclaimed in <see cref="unload_addons"/>, since frames in flight may still be dispatching from them.
+		/// </summary>
+		void *const *overflow_callbacks;
+		void *callbacks[14];
+	};
+
+	/// <summary>
+	/// Flat dispatch tables for each event, kept in sync with <see cref="addon_event_list"/>.
+	/// </summary>
+	extern addon_event_table addon_event_tables[];
+
+	/// <summary>
+	/// Bitmask with a bit set for every event that has at least one callback registered.
+	/// This fits into a single cache line, so that the presence checks scattered across all the backend hooks stay hot regardless of which events they test.
+	/// </summary>
+	extern std::atomic<uint64_t> addon_event_mask[2];
+	static_assert(static_cast<uint32_t>(addon_event::max) <= 128, "Add-on event presence bitmask needs to grow to cover all events");
+
+	/// <summary>
+	/// Rebuilds the flat dispatch table of the specified <paramref name="ev"/>ent from <see cref="addon_event_list"/>. Has to be called after modifying that list directly.
+	/// </summary>
+	void update_addon_event_table(addon_event ev);
+
+	/// <summary>
+	/// Set to record call counts and cumulative durations for every add-on event callback (see <see cref="addon_event_profiles"/>).
+	/// </summary>
+	extern bool addon_event_profiling;
+
+	/// <summary>
+	/// Profiling accumulators for the callbacks of a single event, with slots matching those of the corresponding <see cref="addon_event_table"/>.
+	/// Only updated while <see cref="addon_event_profiling"/> is enabled, and reset whenever the callbacks of the event change.
+	/// </summary>
+	struct addon_event_profile
+	{
+		std::atomic<uint64_t> call_count[14];
+		std::atomic<uint64_t> total_duration[14]; // In nanoseconds
+	};
+	extern addon_event_profile addon_event_profiles[];
+
+	/// <summary>
+	/// Gets the recorded call count and cumulative duration (in nanoseconds) of the specified event callback.
+	/// </summary>
+	bool get_addon_event_profiling(addon_event ev, void *callback, uint64_t &call_count, uint64_t &total_duration);
+	/// <summary>
+	/// Resets all recorded event profiling data.
+	/// </summary>
+	void clear_addon_event_profiles();
+
+	/// <summary>
+	/// Gets a human-readable name for the specified <paramref name="ev"/>ent.
+	/// </summary>
+	const char *addon_event_to_string(addon_event ev);
+
 	/// <summary>
 	/// List of currently loaded add-ons.
 	/// </summary>
@@ -56,7 +134,7 @@ namespace reshade
 	template <addon_event ev>
 	__forceinline bool has_addon_event()
 	{
-		return !addon_event_list[static_cast<uint32_t>(ev)].empty();
+		return (addon_event_mask[static_cast<uint32_t>(ev) / 64].load(std::memory_order_relaxed) & (1ull << (static_cast<uint32_t>(ev) % 64))) != 0;
 	}
 
 	/// <summary>
@@ -99,37 +177,56 @@ namespace reshade
 			ev != addon_event::copy_acceleration_structure &&
 			ev != addon_event::build_acceleration_structure,
 			"Event that is disabled with limited add-on support was used!");
-
-		// Allow a subset of events even when add-ons are disabled, to ensure they continue working correctly
-		if constexpr (
-			ev != addon_event::init_device &&
-			ev != addon_event::destroy_device &&
-			ev != addon_event::init_command_list &&
-			ev != addon_event::destroy_command_list &&
-			ev != addon_event::init_command_queue &&
-			ev != addon_event::destroy_command_queue &&
-			ev != addon_event::init_swapchain &&
-			ev != addon_event::destroy_swapchain &&
-			ev != addon_event::init_effect_runtime &&
-			ev != addon_event::destroy_effect_runtime &&
-			ev != addon_event::init_sampler &&
-			ev != addon_event::destroy_sampler &&
-			ev != addon_event::init_resource &&
-			ev != addon_event::destroy_resource &&
-			ev != addon_event::init_resource_view &&
-			ev != addon_event::destroy_resource_view &&
-			ev != addon_event::init_pipeline &&
-			ev != addon_event::destroy_pipeline &&
-			ev != addon_event::init_pipeline_layout &&
-			ev != addon_event::destroy_pipeline_layout &&
-			ev != addon_event::init_query_heap &&
-			ev != addon_event::destroy_query_heap)
-		if (!addon_enabled)
-			return;
 #endif
-		std::vector<void *> &event_list = addon_event_list[static_cast<uint32_t>(ev)];
-		for (size_t cb = 0, count = event_list.size(); cb < count; ++cb) // Generates better code than ranged-based for loop
-			reinterpret_cast<typename addon_event_traits<ev>::decl>(event_list[cb])(std::forward<Args>(args)...);
+		// Skip all argument and dispatch work when no callback is registered for this event
+		// The global add-on enabled state is folded into this bitmask as well, with a subset of events staying enabled even while add-ons are disabled (see 'enable_addons')
+		if (!has_addon_event<ev>())
+			return;
+
+		const addon_event_table &event_table = addon_event_tables[static_cast<uint32_t>(ev)];
+
+		// Grab a consistent snapshot of the callback list without taking a lock, by retrying while a registration is rewriting the table
+		void *local_callbacks[sizeof(event_table.callbacks) / sizeof(void *)];
+		void *const *callback_list;
+		uint32_t count, generation;
+		do
+		{
+			generation = event_table.generation.load(std::memory_order_acquire);
+			if (generation & 1)
+				continue; // A registration is rewriting the table right now
+
+			count = event_table.count.load(std::memory_order_relaxed);
+			if (count <= static_cast<uint32_t>(std::size(event_table.callbacks)))
+			{
+				for (uint32_t cb = 0; cb < count; ++cb)
+					local_callbacks[cb] = event_table.callbacks[cb];
+				callback_list = local_callbacks;
+			}
+			else
+			{
+				// More callbacks are registered than fit the flat table, so walk the immutable overflow snapshot instead
+				callback_list = event_table.overflow_callbacks;
+			}
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+		} while (event_table.generation.load(std::memory_order_relaxed) != generation);
+
+		if (!addon_event_profiling || count > static_cast<uint32_t>(std::size(event_table.callbacks)))
+		{
+			for (uint32_t cb = 0; cb < count; ++cb)
+				reinterpret_cast<typename addon_event_traits<ev>::decl>(callback_list[cb])(std::forward<Args>(args)...);
+		}
+		else
+		{
+			addon_event_profile &event_profile = addon_event_profiles[static_cast<uint32_t>(ev)];
+			for (uint32_t cb = 0; cb < count; ++cb)
+			{
+				const std::chrono::high_resolution_clock::time_point start_time = std::chrono::high_resolution_clock::now();
+				reinterpret_cast<typename addon_event_traits<ev>::decl>(callback_list[cb])(std::forward<Args>(args)...);
+				event_profile.total_duration[cb].fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start_time).count(), std::memory_order_relaxed);
+				event_profile.call_count[cb].fetch_add(1, std::memory_order_relaxed);
+			}
+		}
 	}
 	/// <summary>
 	/// Invokes registered callbacks for the specified <typeparamref name="ev"/>ent until a callback reports back as having handled this event by returning <see langword="true"/>.
@@ -137,14 +234,54 @@ namespace reshade
 	template <addon_event ev, typename... Args>
 	__forceinline std::enable_if_t<std::is_same_v<typename addon_event_traits<ev>::type, bool>, bool> invoke_addon_event(Args &&... args)
 	{
-#if RESHADE_ADDON == 1
-		if (!addon_enabled)
+		if (!has_addon_event<ev>())
 			return false;
-#endif
-		std::vector<void *> &event_list = addon_event_list[static_cast<uint32_t>(ev)];
-		for (size_t cb = 0, count = event_list.size(); cb < count; ++cb)
-			if (reinterpret_cast<typename addon_event_traits<ev>::decl>(event_list[cb])(std::forward<Args>(args)...))
-				return true;
+
+		const addon_event_table &event_table = addon_event_tables[static_cast<uint32_t>(ev)];
+
+		void *local_callbacks[sizeof(event_table.callbacks) / sizeof(void *)];
+		void *const *callback_list;
+		uint32_t count, generation;
+		do
+		{
+			generation = event_table.generation.load(std::memory_order_acquire);
+			if (generation & 1)
+				continue;
+
+			count = event_table.count.load(std::memory_order_relaxed);
+			if (count <= static_cast<uint32_t>(std::size(event_table.callbacks)))
+			{
+				for (uint32_t cb = 0; cb < count; ++cb)
+					local_callbacks[cb] = event_table.callbacks[cb];
+				callback_list = local_callbacks;
+			}
+			else
+			{
+				callback_list = event_table.overflow_callbacks;
+			}
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+		} while (event_table.generation.load(std::memory_order_relaxed) != generation);
+
+		if (!addon_event_profiling || count > static_cast<uint32_t>(std::size(event_table.callbacks)))
+		{
+			for (uint32_t cb = 0; cb < count; ++cb)
+				if (reinterpret_cast<typename addon_event_traits<ev>::decl>(callback_list[cb])(std::forward<Args>(args)...))
+					return true;
+		}
+		else
+		{
+			addon_event_profile &event_profile = addon_event_profiles[static_cast<uint32_t>(ev)];
+			for (uint32_t cb = 0; cb < count; ++cb)
+			{
+				const std::chrono::high_resolution_clock::time_point start_time = std::chrono::high_resolution_clock::now();
+				const bool handled = reinterpret_cast<typename addon_event_traits<ev>::decl>(callback_list[cb])(std::forward<Args>(args)...);
+				event_profile.total_duration[cb].fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start_time).count(), std::memory_order_relaxed);
+				event_profile.call_count[cb].fetch_add(1, std::memory_order_relaxed);
+				if (handled)
+					return true;
+			}
+		}
 		return false;
 	}
 }
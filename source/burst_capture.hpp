@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2025 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace reshade
+{
+	/// <summary>
+	/// Header at the start of a burst capture file (see <see cref="runtime::start_burst_capture"/> and the offline converter in tools\burstconv.cpp).
+	/// The header is followed by <see cref="frame_capacity"/> frame timestamps (in ticks of <see cref="ticks_per_second"/>) and then the frame data itself, stored as tightly packed 8-bit RGBA.
+	/// The file is used as a ring, so when <see cref="frame_count"/> exceeds <see cref="frame_capacity"/> it wrapped around and the oldest frame is in slot <c>frame_count % frame_capacity</c>.
+	/// </summary>
+	struct burst_capture_header
+	{
+		static constexpr uint32_t signature = 0x43425352; // "RSBC"
+		static constexpr uint32_t latest_version = 1;
+
+		uint32_t magic;
+		uint32_t version;
+		uint32_t width;
+		uint32_t height;
+		uint32_t frame_size;
+		uint32_t frame_capacity;
+		uint32_t frame_count;
+		uint32_t reserved;
+		uint64_t ticks_per_second;
+	};
+}
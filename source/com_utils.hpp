@@ -6,6 +6,107 @@
 #pragma once
 
 #include <Unknwn.h>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+/// <summary>
+/// Table associating native objects with the proxy objects wrapping them, so that hot hook code can resolve a proxy with a couple of loads, rather than a COM private data query per call.
+/// Proxies register themselves on creation and unregister on destruction. Lookups are lock-free and key on the exact interface pointer the proxy registered, so a miss (e.g. when passed a different interface of the same object) simply falls back to the private data query.
+/// </summary>
+template <typename U>
+class com_pointer_table
+{
+public:
+	static void insert(const IUnknown *object, U *pointer)
+	{
+		const std::unique_lock<std::mutex> lock(s_mutex);
+
+		for (size_t probe = 0; probe < CAPACITY; ++probe)
+		{
+			const size_t slot = (hash(object) + probe) % CAPACITY;
+			if (const IUnknown *const key = s_keys[slot].load(std::memory_order_relaxed);
+				key != nullptr && key != TOMBSTONE)
+				continue;
+
+			// Publish the value before the key, so that a concurrent lookup matching the key is guaranteed to read it
+			s_values[slot].store(pointer, std::memory_order_relaxed);
+			s_keys[slot].store(object, std::memory_order_release);
+			return;
+		}
+
+		// The table is full, so lookups for this object will fall back to the private data query
+	}
+	static void erase(const IUnknown *object)
+	{
+		const std::unique_lock<std::mutex> lock(s_mutex);
+
+		for (size_t probe = 0; probe < CAPACITY; ++probe)
+		{
+			const size_t slot = (hash(object) + probe) % CAPACITY;
+			const IUnknown *const key = s_keys[slot].load(std::memory_order_relaxed);
+			if (key == nullptr)
+				break;
+			if (key != object)
+				continue;
+
+			s_values[slot].store(nullptr, std::memory_order_relaxed);
+			// Leave a tombstone in place of the key, so that probe chains of other entries stay intact
+			s_keys[slot].store(TOMBSTONE, std::memory_order_release);
+			// Invalidate the per-thread caches of all threads
+			s_generation.fetch_add(1, std::memory_order_release);
+			return;
+		}
+	}
+
+	static bool lookup(const IUnknown *object, U **out_pointer)
+	{
+		static thread_local struct { const IUnknown *object; U *pointer; uint32_t generation; } t_last_hit = {};
+
+		const uint32_t generation = s_generation.load(std::memory_order_acquire);
+		if (t_last_hit.object == object && t_last_hit.generation == generation)
+		{
+			*out_pointer = t_last_hit.pointer;
+			return true;
+		}
+
+		for (size_t probe = 0; probe < CAPACITY; ++probe)
+		{
+			const size_t slot = (hash(object) + probe) % CAPACITY;
+			const IUnknown *const key = s_keys[slot].load(std::memory_order_acquire);
+			if (key == nullptr)
+				break; // An empty slot terminates the probe chain
+			if (key != object)
+				continue; // This skips tombstones as well
+
+			U *const pointer = s_values[slot].load(std::memory_order_relaxed);
+			if (pointer == nullptr)
+				break; // The entry is in the middle of being erased, let the caller take the slow path
+
+			t_last_hit = { object, pointer, generation };
+
+			*out_pointer = pointer;
+			return true;
+		}
+
+		return false;
+	}
+
+private:
+	static constexpr size_t CAPACITY = 32;
+	static inline const IUnknown *const TOMBSTONE = reinterpret_cast<const IUnknown *>(~static_cast<uintptr_t>(0));
+
+	static size_t hash(const IUnknown *object)
+	{
+		// Drop the alignment bits and mix with a Fibonacci constant, since consecutive allocations tend to share high bits
+		return ((reinterpret_cast<uintptr_t>(object) >> 4) * 2654435761u) % CAPACITY;
+	}
+
+	static inline std::mutex s_mutex; // Guards insertion and erasure only, lookups are unsynchronized
+	static inline std::atomic<const IUnknown *> s_keys[CAPACITY] = {};
+	static inline std::atomic<U *> s_values[CAPACITY] = {};
+	static inline std::atomic<uint32_t> s_generation = {};
+};
 
 /// <summary>
 /// Gets a pointer from the private data of the specified <paramref name="object"/>.
@@ -14,6 +115,8 @@ template <typename U, typename T>
 __forceinline U *get_private_pointer_d3dx(T *object)
 {
 	U *result = nullptr;
+	if (com_pointer_table<U>::lookup(object, &result))
+		return result;
 	UINT size = sizeof(result);
 	object->GetPrivateData(__uuidof(U), &size, reinterpret_cast<void **>(&result));
 	return result;
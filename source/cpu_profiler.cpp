@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2025 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "cpu_profiler.hpp"
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <cstring> // strncpy_s
+#include <Windows.h>
+#include <intrin.h> // __rdtsc
+
+static constexpr size_t spans_per_thread = 512;
+
+// Ring buffer of the most recent scopes recorded on a single thread
+struct thread_span_ring
+{
+	uint32_t thread_id = 0;
+	uint32_t current_depth = 0;
+	size_t next_index = 0;
+	reshade::profiling::cpu_span spans[spans_per_thread] = {};
+};
+
+static std::mutex s_mutex;
+// Use a deque so that pointers to the rings stay stable when new threads register themselves
+static std::deque<thread_span_ring> s_thread_rings;
+static std::atomic<bool> s_enabled = false;
+static std::atomic<bool> s_capture_requested = false;
+static uint64_t s_frame_begin_ticks = 0;
+static reshade::profiling::frame_snapshot s_last_frame;
+// Reference samples used to calibrate the time stamp counter frequency against the performance counter
+static uint64_t s_calibration_tsc = 0;
+static LONGLONG s_calibration_qpc = 0;
+static uint64_t s_ticks_per_second = 0;
+
+static thread_span_ring &get_thread_ring()
+{
+	// The rings are intentionally kept alive after their thread exited, since the last frame snapshot may still reference spans in them
+	thread_local thread_span_ring *const ring = [] {
+		const std::unique_lock<std::mutex> lock(s_mutex);
+		thread_span_ring &new_ring = s_thread_rings.emplace_back();
+		new_ring.thread_id = GetCurrentThreadId();
+		return &new_ring;
+	}();
+	return *ring;
+}
+
+void reshade::profiling::request_capture()
+{
+	s_capture_requested = true;
+}
+
+void reshade::profiling::mark_frame()
+{
+	const uint64_t now_ticks = __rdtsc();
+
+	const bool was_enabled = s_enabled;
+	// Only record scopes during the next frame when the overlay requested it during this one, so that the profiler costs no more than a branch per scope otherwise
+	s_enabled = s_capture_requested.exchange(false);
+
+	if (!was_enabled)
+	{
+		s_frame_begin_ticks = now_ticks;
+		return;
+	}
+
+	LARGE_INTEGER qpc = {}, qpf = {};
+	QueryPerformanceCounter(&qpc);
+	QueryPerformanceFrequency(&qpf);
+
+	const std::unique_lock<std::mutex> lock(s_mutex);
+
+	// Calibrate the time stamp counter frequency against the performance counter (accuracy improves as the measurement interval grows)
+	if (s_calibration_tsc == 0)
+	{
+		s_calibration_tsc = now_ticks;
+		s_calibration_qpc = qpc.QuadPart;
+	}
+	else if (qpc.QuadPart - s_calibration_qpc > qpf.QuadPart / 20) // Require at least 50ms between the samples
+	{
+		s_ticks_per_second = static_cast<uint64_t>((now_ticks - s_calibration_tsc) / (static_cast<double>(qpc.QuadPart - s_calibration_qpc) / qpf.QuadPart));
+	}
+
+	s_last_frame.begin_ticks = s_frame_begin_ticks;
+	s_last_frame.end_ticks = now_ticks;
+	s_last_frame.ticks_per_second = s_ticks_per_second;
+	s_last_frame.spans.clear();
+
+	for (const thread_span_ring &ring : s_thread_rings)
+	{
+		for (const cpu_span &span : ring.spans)
+		{
+			// Only keep completed scopes that intersect the frame that just ended
+			if (span.name[0] != '\0' && span.end_ticks > s_frame_begin_ticks && span.begin_ticks < now_ticks)
+				s_last_frame.spans.push_back(span);
+		}
+	}
+
+	s_frame_begin_ticks = now_ticks;
+}
+
+void reshade::profiling::get_last_frame(frame_snapshot &snapshot)
+{
+	const std::unique_lock<std::mutex> lock(s_mutex);
+
+	snapshot = s_last_frame;
+}
+
+reshade::profiling::scoped_cpu_timer::scoped_cpu_timer(const char *name)
+{
+	if (!s_enabled)
+		return;
+
+	get_thread_ring().current_depth++;
+
+	_name = name;
+	_begin_ticks = __rdtsc();
+}
+reshade::profiling::scoped_cpu_timer::~scoped_cpu_timer()
+{
+	if (_name == nullptr)
+		return;
+
+	const uint64_t end_ticks = __rdtsc();
+
+	thread_span_ring &ring = get_thread_ring();
+	ring.current_depth--;
+
+	const std::unique_lock<std::mutex> lock(s_mutex);
+
+	cpu_span &span = ring.spans[ring.next_index++ % spans_per_thread];
+	strncpy_s(span.name, _name, _TRUNCATE);
+	span.begin_ticks = _begin_ticks;
+	span.end_ticks = end_ticks;
+	span.thread_id = ring.thread_id;
+	span.depth = ring.current_depth;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2025 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace reshade::profiling
+{
+	/// <summary>
+	/// A single timed scope recorded by a <see cref="scoped_cpu_timer"/>.
+	/// </summary>
+	struct cpu_span
+	{
+		// Name of the scope (truncated if necessary), copied so that spans stay valid after e.g. an effect reload destroyed the technique the name came from
+		char name[40] = "";
+		// Start and end of the scope in time stamp counter ticks (see '__rdtsc')
+		uint64_t begin_ticks = 0;
+		uint64_t end_ticks = 0;
+		// Identifier of the thread the scope was recorded on
+		uint32_t thread_id = 0;
+		// Nesting depth of the scope within other scopes on the same thread
+		uint32_t depth = 0;
+	};
+
+	/// <summary>
+	/// All scopes that intersected the last completed frame, together with the frame boundaries.
+	/// </summary>
+	struct frame_snapshot
+	{
+		uint64_t begin_ticks = 0;
+		uint64_t end_ticks = 0;
+		// Calibrated time stamp counter frequency, or zero while calibration is still in progress
+		uint64_t ticks_per_second = 0;
+		std::vector<cpu_span> spans;
+	};
+
+	/// <summary>
+	/// Requests that scopes are recorded during the next frame. Recording automatically stops again when this was not called for a frame, so that the profiler costs nothing while its overlay is closed.
+	/// </summary>
+	void request_capture();
+
+	/// <summary>
+	/// Marks a frame boundary and snapshots the scopes of the frame that just completed. This is called once per frame at the start of the present path.
+	/// </summary>
+	void mark_frame();
+
+	/// <summary>
+	/// Copies the scopes of the last completed frame into <paramref name="snapshot"/>.
+	/// </summary>
+	void get_last_frame(frame_snapshot &snapshot);
+
+	/// <summary>
+	/// Records the enclosing scope into a per-thread ring buffer while a capture was requested, for display in the overlay profiler.
+	/// This complements the ETW provider in trace_events.hpp with self-contained visibility on machines without trace tooling.
+	/// </summary>
+	class scoped_cpu_timer
+	{
+	public:
+		explicit scoped_cpu_timer(const char *name);
+		~scoped_cpu_timer();
+
+		scoped_cpu_timer(const scoped_cpu_timer &) = delete;
+		scoped_cpu_timer &operator=(const scoped_cpu_timer &) = delete;
+
+	private:
+		// Name of the scope, or 'nullptr' when recording was disabled at construction
+		const char *_name = nullptr;
+		uint64_t _begin_ticks = 0;
+	};
+}
@@ -123,6 +123,7 @@ bool reshade::d3d10::device_impl::check_capability(api::device_caps capability)
 	case api::device_caps::shared_fence_nt_handle:
 	case api::device_caps::amplification_and_mesh_shader:
 	case api::device_caps::ray_tracing:
+	case api::device_caps::partial_constant_buffer_updates:
 	default:
 		return false;
 	}
@@ -5,10 +5,23 @@
 
 #include "d3d10_impl_type_convert.hpp"
 #include <cassert>
+#include <iterator> // std::size
 #include <algorithm> // std::copy_n
 
 auto reshade::d3d10::convert_format(api::format format) -> DXGI_FORMAT
 {
+	// 'api::format' deliberately mirrors 'DXGI_FORMAT', so that this conversion is an identity mapping
+	static_assert(
+		(DXGI_FORMAT)api::format::unknown == DXGI_FORMAT_UNKNOWN &&
+		(DXGI_FORMAT)api::format::r16g16b16a16_float == DXGI_FORMAT_R16G16B16A16_FLOAT &&
+		(DXGI_FORMAT)api::format::r10g10b10a2_unorm == DXGI_FORMAT_R10G10B10A2_UNORM &&
+		(DXGI_FORMAT)api::format::r8g8b8a8_unorm == DXGI_FORMAT_R8G8B8A8_UNORM &&
+		(DXGI_FORMAT)api::format::d32_float == DXGI_FORMAT_D32_FLOAT &&
+		(DXGI_FORMAT)api::format::r32_float == DXGI_FORMAT_R32_FLOAT &&
+		(DXGI_FORMAT)api::format::d24_unorm_s8_uint == DXGI_FORMAT_D24_UNORM_S8_UINT &&
+		(DXGI_FORMAT)api::format::bc1_unorm == DXGI_FORMAT_BC1_UNORM &&
+		(DXGI_FORMAT)api::format::bc7_unorm_srgb == DXGI_FORMAT_BC7_UNORM_SRGB);
+
 	if (static_cast<uint32_t>(format) >= 1000)
 		return DXGI_FORMAT_UNKNOWN;
 
@@ -968,95 +981,63 @@ auto reshade::d3d10::convert_blend_op(D3D10_BLEND_OP value) -> api::blend_op
 }
 auto reshade::d3d10::convert_blend_factor(api::blend_factor value) -> D3D10_BLEND
 {
-	switch (value)
-	{
-	default:
-		assert(false);
-		[[fallthrough]];
-	case api::blend_factor::zero:
-		return D3D10_BLEND_ZERO;
-	case api::blend_factor::one:
-		return D3D10_BLEND_ONE;
-	case api::blend_factor::source_color:
-		return D3D10_BLEND_SRC_COLOR;
-	case api::blend_factor::one_minus_source_color:
-		return D3D10_BLEND_INV_SRC_COLOR;
-	case api::blend_factor::dest_color:
-		return D3D10_BLEND_DEST_COLOR;
-	case api::blend_factor::one_minus_dest_color:
-		return D3D10_BLEND_INV_DEST_COLOR;
-	case api::blend_factor::source_alpha:
-		return D3D10_BLEND_SRC_ALPHA;
-	case api::blend_factor::one_minus_source_alpha:
-		return D3D10_BLEND_INV_SRC_ALPHA;
-	case api::blend_factor::dest_alpha:
-		return D3D10_BLEND_DEST_ALPHA;
-	case api::blend_factor::one_minus_dest_alpha:
-		return D3D10_BLEND_INV_DEST_ALPHA;
-	case api::blend_factor::constant_alpha:
-		assert(false);
-		[[fallthrough]];
-	case api::blend_factor::constant_color:
-		return D3D10_BLEND_BLEND_FACTOR;
-	case api::blend_factor::one_minus_constant_alpha:
-		assert(false);
-		[[fallthrough]];
-	case api::blend_factor::one_minus_constant_color:
-		return D3D10_BLEND_INV_BLEND_FACTOR;
-	case api::blend_factor::source_alpha_saturate:
-		return D3D10_BLEND_SRC_ALPHA_SAT;
-	case api::blend_factor::source1_color:
-		return D3D10_BLEND_SRC1_COLOR;
-	case api::blend_factor::one_minus_source1_color:
-		return D3D10_BLEND_INV_SRC1_COLOR;
-	case api::blend_factor::source1_alpha:
-		return D3D10_BLEND_SRC1_ALPHA;
-	case api::blend_factor::one_minus_source1_alpha:
-		return D3D10_BLEND_INV_SRC1_ALPHA;
-	}
+	// D3D10 does not distinguish between constant color and alpha blend factors
+	assert(value != api::blend_factor::constant_alpha && value != api::blend_factor::one_minus_constant_alpha);
+
+	// Lookup table indexed by 'api::blend_factor'
+	static constexpr D3D10_BLEND lookup[] = {
+		D3D10_BLEND_ZERO,             // api::blend_factor::zero
+		D3D10_BLEND_ONE,              // api::blend_factor::one
+		D3D10_BLEND_SRC_COLOR,        // api::blend_factor::source_color
+		D3D10_BLEND_INV_SRC_COLOR,    // api::blend_factor::one_minus_source_color
+		D3D10_BLEND_DEST_COLOR,       // api::blend_factor::dest_color
+		D3D10_BLEND_INV_DEST_COLOR,   // api::blend_factor::one_minus_dest_color
+		D3D10_BLEND_SRC_ALPHA,        // api::blend_factor::source_alpha
+		D3D10_BLEND_INV_SRC_ALPHA,    // api::blend_factor::one_minus_source_alpha
+		D3D10_BLEND_DEST_ALPHA,       // api::blend_factor::dest_alpha
+		D3D10_BLEND_INV_DEST_ALPHA,   // api::blend_factor::one_minus_dest_alpha
+		D3D10_BLEND_BLEND_FACTOR,     // api::blend_factor::constant_color
+		D3D10_BLEND_INV_BLEND_FACTOR, // api::blend_factor::one_minus_constant_color
+		D3D10_BLEND_BLEND_FACTOR,     // api::blend_factor::constant_alpha
+		D3D10_BLEND_INV_BLEND_FACTOR, // api::blend_factor::one_minus_constant_alpha
+		D3D10_BLEND_SRC_ALPHA_SAT,    // api::blend_factor::source_alpha_saturate
+		D3D10_BLEND_SRC1_COLOR,       // api::blend_factor::source1_color
+		D3D10_BLEND_INV_SRC1_COLOR,   // api::blend_factor::one_minus_source1_color
+		D3D10_BLEND_SRC1_ALPHA,       // api::blend_factor::source1_alpha
+		D3D10_BLEND_INV_SRC1_ALPHA,   // api::blend_factor::one_minus_source1_alpha
+	};
+
+	assert(static_cast<uint32_t>(value) < std::size(lookup));
+	return lookup[static_cast<uint32_t>(value)];
 }
 auto reshade::d3d10::convert_blend_factor(D3D10_BLEND value) -> api::blend_factor
 {
-	switch (value)
-	{
-	default:
-		assert(false);
-		[[fallthrough]];
-	case D3D10_BLEND_ZERO:
-		return api::blend_factor::zero;
-	case D3D10_BLEND_ONE:
-		return api::blend_factor::one;
-	case D3D10_BLEND_SRC_COLOR:
-		return api::blend_factor::source_color;
-	case D3D10_BLEND_INV_SRC_COLOR:
-		return api::blend_factor::one_minus_source_color;
-	case D3D10_BLEND_DEST_COLOR:
-		return api::blend_factor::dest_color;
-	case D3D10_BLEND_INV_DEST_COLOR:
-		return api::blend_factor::one_minus_dest_color;
-	case D3D10_BLEND_SRC_ALPHA:
-		return api::blend_factor::source_alpha;
-	case D3D10_BLEND_INV_SRC_ALPHA:
-		return api::blend_factor::one_minus_source_alpha;
-	case D3D10_BLEND_DEST_ALPHA:
-		return api::blend_factor::dest_alpha;
-	case D3D10_BLEND_INV_DEST_ALPHA:
-		return api::blend_factor::one_minus_dest_alpha;
-	case D3D10_BLEND_BLEND_FACTOR:
-		return api::blend_factor::constant_color;
-	case D3D10_BLEND_INV_BLEND_FACTOR:
-		return api::blend_factor::one_minus_constant_color;
-	case D3D10_BLEND_SRC_ALPHA_SAT:
-		return api::blend_factor::source_alpha_saturate;
-	case D3D10_BLEND_SRC1_COLOR:
-		return api::blend_factor::source1_color;
-	case D3D10_BLEND_INV_SRC1_COLOR:
-		return api::blend_factor::one_minus_source1_color;
-	case D3D10_BLEND_SRC1_ALPHA:
-		return api::blend_factor::source1_alpha;
-	case D3D10_BLEND_INV_SRC1_ALPHA:
-		return api::blend_factor::one_minus_source1_alpha;
-	}
+	// Lookup table indexed by 'D3D10_BLEND' (which has no values 0, 12 and 13)
+	static constexpr api::blend_factor lookup[] = {
+		api::blend_factor::zero,                       // 0
+		api::blend_factor::zero,                       // D3D10_BLEND_ZERO
+		api::blend_factor::one,                        // D3D10_BLEND_ONE
+		api::blend_factor::source_color,               // D3D10_BLEND_SRC_COLOR
+		api::blend_factor::one_minus_source_color,     // D3D10_BLEND_INV_SRC_COLOR
+		api::blend_factor::source_alpha,               // D3D10_BLEND_SRC_ALPHA
+		api::blend_factor::one_minus_source_alpha,     // D3D10_BLEND_INV_SRC_ALPHA
+		api::blend_factor::dest_alpha,                 // D3D10_BLEND_DEST_ALPHA
+		api::blend_factor::one_minus_dest_alpha,       // D3D10_BLEND_INV_DEST_ALPHA
+		api::blend_factor::dest_color,                 // D3D10_BLEND_DEST_COLOR
+		api::blend_factor::one_minus_dest_color,       // D3D10_BLEND_INV_DEST_COLOR
+		api::blend_factor::source_alpha_saturate,      // D3D10_BLEND_SRC_ALPHA_SAT
+		api::blend_factor::zero,                       // 12
+		api::blend_factor::zero,                       // 13
+		api::blend_factor::constant_color,             // D3D10_BLEND_BLEND_FACTOR
+		api::blend_factor::one_minus_constant_color,   // D3D10_BLEND_INV_BLEND_FACTOR
+		api::blend_factor::source1_color,              // D3D10_BLEND_SRC1_COLOR
+		api::blend_factor::one_minus_source1_color,    // D3D10_BLEND_INV_SRC1_COLOR
+		api::blend_factor::source1_alpha,              // D3D10_BLEND_SRC1_ALPHA
+		api::blend_factor::one_minus_source1_alpha,    // D3D10_BLEND_INV_SRC1_ALPHA
+	};
+
+	assert(value >= D3D10_BLEND_ZERO && static_cast<uint32_t>(value) < std::size(lookup));
+	return lookup[static_cast<uint32_t>(value)];
 }
 auto reshade::d3d10::convert_fill_mode(api::fill_mode value) -> D3D10_FILL_MODE
 {
@@ -23,6 +23,7 @@ D3D11Device::D3D11Device(IDXGIDevice1 *original_dxgi_device, ID3D11Device *origi
 	// Add proxy object to the private data of the device, so that it can be retrieved again when only the original device is available (as is the case in the OpenVR hooks)
 	D3D11Device *const device_proxy = this;
 	_orig->SetPrivateData(__uuidof(D3D11Device), sizeof(device_proxy), &device_proxy);
+	com_pointer_table<D3D11Device>::insert(_orig, this);
 
 #if RESHADE_ADDON
 	reshade::load_addons();
@@ -64,6 +65,7 @@ D3D11Device::~D3D11Device()
 #endif
 
 	// Remove pointer to this proxy object from the private data of the device (in case the device unexpectedly survives)
+	com_pointer_table<D3D11Device>::erase(_orig);
 	_orig->SetPrivateData(__uuidof(D3D11Device), 0, nullptr);
 }
 
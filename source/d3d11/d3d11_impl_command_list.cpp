@@ -8,6 +8,7 @@
 #include "d3d11_impl_type_convert.hpp"
 #include "dll_log.hpp"
 #include <cstring> // std::memcpy, std::strlen
+#include <iterator> // std::size
 #include <algorithm> // std::find
 #include <utf8/unchecked.h>
 
@@ -147,6 +148,9 @@ void reshade::d3d11::device_context_impl::barrier(uint32_t count, const api::res
 
 #undef UNBIND_UNORDERED_ACCESS_VIEWS
 	}
+
+	if (transitions_away_from_shader_resource_usage != 0 || transitions_away_from_unordered_access_usage != 0)
+		invalidate_bound_descriptor_tables(true);
 }
 
 void reshade::d3d11::device_context_impl::begin_render_pass(uint32_t count, const api::render_pass_render_target_desc *rts, const api::render_pass_depth_stencil_desc *ds)
@@ -182,6 +186,9 @@ void reshade::d3d11::device_context_impl::bind_render_targets_and_depth_stencil(
 {
 	assert(count <= D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT);
 
+	// The D3D11 runtime may unbind shader resource views referencing the new render targets to resolve binding hazards
+	invalidate_bound_descriptor_tables(true);
+
 #ifndef _WIN64
 	temp_mem<ID3D11RenderTargetView *, D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT> rtv_ptrs_mem(count);
 	for (uint32_t i = 0; i < count; ++i)
@@ -427,9 +434,7 @@ void reshade::d3d11::device_context_impl::bind_constant_buffers(api::shader_stag
 		}
 	}
 
-	com_ptr<ID3D11DeviceContext1> context1;
-	if (whole_range ||
-		FAILED(_orig->QueryInterface(&context1)))
+	if (whole_range || _orig1 == nullptr)
 	{
 		if ((stages & api::shader_stage::vertex) == api::shader_stage::vertex)
 			_orig->VSSetConstantBuffers(first, count, buffer_ptrs.p);
@@ -447,17 +452,17 @@ void reshade::d3d11::device_context_impl::bind_constant_buffers(api::shader_stag
 	else
 	{
 		if ((stages & api::shader_stage::vertex) == api::shader_stage::vertex)
-			context1->VSSetConstantBuffers1(first, count, buffer_ptrs.p, first_constant.p, constant_count.p);
+			_orig1->VSSetConstantBuffers1(first, count, buffer_ptrs.p, first_constant.p, constant_count.p);
 		if ((stages & api::shader_stage::hull) == api::shader_stage::hull)
-			context1->HSSetConstantBuffers1(first, count, buffer_ptrs.p, first_constant.p, constant_count.p);
+			_orig1->HSSetConstantBuffers1(first, count, buffer_ptrs.p, first_constant.p, constant_count.p);
 		if ((stages & api::shader_stage::domain) == api::shader_stage::domain)
-			context1->DSSetConstantBuffers1(first, count, buffer_ptrs.p, first_constant.p, constant_count.p);
+			_orig1->DSSetConstantBuffers1(first, count, buffer_ptrs.p, first_constant.p, constant_count.p);
 		if ((stages & api::shader_stage::geometry) == api::shader_stage::geometry)
-			context1->GSSetConstantBuffers1(first, count, buffer_ptrs.p, first_constant.p, constant_count.p);
+			_orig1->GSSetConstantBuffers1(first, count, buffer_ptrs.p, first_constant.p, constant_count.p);
 		if ((stages & api::shader_stage::pixel) == api::shader_stage::pixel)
-			context1->PSSetConstantBuffers1(first, count, buffer_ptrs.p, first_constant.p, constant_count.p);
+			_orig1->PSSetConstantBuffers1(first, count, buffer_ptrs.p, first_constant.p, constant_count.p);
 		if ((stages & api::shader_stage::compute) == api::shader_stage::compute)
-			context1->CSSetConstantBuffers1(first, count, buffer_ptrs.p, first_constant.p, constant_count.p);
+			_orig1->CSSetConstantBuffers1(first, count, buffer_ptrs.p, first_constant.p, constant_count.p);
 	}
 }
 
@@ -466,6 +471,9 @@ void reshade::d3d11::device_context_impl::push_constants(api::shader_stage stage
 	if (count == 0)
 		return;
 
+	// The constant buffer slot this writes to may overlap a binding of a previously applied descriptor table
+	invalidate_bound_descriptor_tables();
+
 	uint32_t push_constants_slot = 0;
 	if (layout != 0)
 	{
@@ -531,6 +539,13 @@ void reshade::d3d11::device_context_impl::push_constants(api::shader_stage stage
 		_orig->CSSetConstantBuffers(push_constants_slot, 1, &push_constants);
 }
 void reshade::d3d11::device_context_impl::push_descriptors(api::shader_stage stages, api::pipeline_layout layout, uint32_t layout_param, const api::descriptor_table_update &update)
+{
+	// The pushed descriptors may overwrite bindings of previously applied descriptor tables
+	invalidate_bound_descriptor_tables();
+
+	apply_descriptors(stages, layout, layout_param, update);
+}
+void reshade::d3d11::device_context_impl::apply_descriptors(api::shader_stage stages, api::pipeline_layout layout, uint32_t layout_param, const api::descriptor_table_update &update)
 {
 	assert(update.table == 0 && update.array_offset == 0);
 
@@ -572,14 +587,40 @@ void reshade::d3d11::device_context_impl::bind_descriptor_tables(api::shader_sta
 	{
 		const auto table_impl = reinterpret_cast<const descriptor_table_impl *>(tables[i].handle);
 
-		push_descriptors(
+		// The effect runtime binds the same static tables for every pass, so skip re-applying one that did not change since it was last applied to this layout parameter (entries are invalidated whenever the associated bindings may have changed elsewhere)
+		bound_descriptor_table *const bound = _bound_descriptor_table_cache_enabled && (first + i) < std::size(_bound_descriptor_tables) ? &_bound_descriptor_tables[first + i] : nullptr;
+		if (bound != nullptr &&
+			bound->layout == layout.handle &&
+			bound->table == tables[i].handle &&
+			bound->version == table_impl->version &&
+			bound->stages == stages)
+			continue;
+
+		apply_descriptors(
 			stages,
 			layout,
 			first + i,
 			api::descriptor_table_update { {}, table_impl->base_binding, 0, table_impl->count, table_impl->type, table_impl->descriptors.data() });
+
+		if (bound != nullptr)
+			*bound = { layout.handle, tables[i].handle, table_impl->version, stages, table_impl->type };
 	}
 }
 
+void reshade::d3d11::device_context_impl::enable_bound_descriptor_table_cache(bool enable)
+{
+	_bound_descriptor_table_cache_enabled = enable;
+
+	invalidate_bound_descriptor_tables();
+}
+void reshade::d3d11::device_context_impl::invalidate_bound_descriptor_tables(bool views_only)
+{
+	for (bound_descriptor_table &bound : _bound_descriptor_tables)
+		// Shader resource and unordered access views can be unbound behind the back of this implementation by the D3D11 runtime resolving binding hazards, sampler and constant buffer bindings cannot
+		if (!views_only || (bound.type != api::descriptor_type::sampler && bound.type != api::descriptor_type::constant_buffer))
+			bound = bound_descriptor_table {};
+}
+
 void reshade::d3d11::device_context_impl::bind_index_buffer(api::resource buffer, uint64_t offset, uint32_t index_size)
 {
 	assert(offset <= std::numeric_limits<UINT>::max());
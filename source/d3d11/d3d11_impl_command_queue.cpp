@@ -11,6 +11,7 @@ reshade::d3d11::device_context_impl::device_context_impl(device_impl *device, ID
 	api_object_impl(context),
 	_device_impl(device)
 {
+	context->QueryInterface(&_orig1);
 	context->QueryInterface(&_annotations);
 }
 
@@ -138,3 +139,39 @@ uint64_t reshade::d3d11::device_context_impl::get_timestamp_frequency() const
 
 	return 0;
 }
+
+reshade::api::command_list *reshade::d3d11::create_deferred_command_list(api::device *device)
+{
+	const auto device_impl = static_cast<reshade::d3d11::device_impl *>(device);
+
+	com_ptr<ID3D11DeviceContext> deferred_context;
+	if (FAILED(device_impl->_orig->CreateDeferredContext(0, &deferred_context)))
+		return nullptr;
+
+	// The implementation object does not hold a reference to the context it wraps, so keep the one from creation alive until 'destroy_deferred_command_list'
+	return new device_context_impl(device_impl, deferred_context.release());
+}
+void reshade::d3d11::destroy_deferred_command_list(api::command_list *cmd_list)
+{
+	const auto context_impl = static_cast<device_context_impl *>(cmd_list);
+
+	ID3D11DeviceContext *const deferred_context = context_impl->_orig;
+	delete context_impl;
+	deferred_context->Release();
+}
+bool reshade::d3d11::execute_deferred_command_list(api::command_queue *immediate_queue, api::command_list *cmd_list)
+{
+	const auto immediate_context_impl = static_cast<device_context_impl *>(immediate_queue->get_immediate_command_list());
+	const auto deferred_context_impl = static_cast<device_context_impl *>(cmd_list);
+	assert(deferred_context_impl->_orig->GetType() == D3D11_DEVICE_CONTEXT_DEFERRED);
+
+	com_ptr<ID3D11CommandList> command_list;
+	if (FAILED(deferred_context_impl->_orig->FinishCommandList(FALSE, &command_list)))
+		return false;
+
+	immediate_context_impl->_orig->ExecuteCommandList(command_list.get(), FALSE);
+
+	// Executing a command list clears the immediate context state
+	immediate_context_impl->invalidate_bound_descriptor_tables();
+	return true;
+}
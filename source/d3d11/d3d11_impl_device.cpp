@@ -136,6 +136,12 @@ bool reshade::d3d11::device_impl::check_capability(api::device_caps capability)
 			return true;
 		else
 			return false;
+	case api::device_caps::partial_constant_buffer_updates:
+		// Requires the D3D11.1 runtime, as well as driver support, see https://docs.microsoft.com/windows/win32/direct3d11/direct3d-11-1-features
+		if (D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+			SUCCEEDED(_orig->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))))
+			return options.MapNoOverwriteOnDynamicConstantBuffer;
+		return false;
 	case api::device_caps::amplification_and_mesh_shader:
 	case api::device_caps::ray_tracing:
 	default:
@@ -601,6 +607,10 @@ bool reshade::d3d11::device_impl::map_buffer_region(api::resource resource, uint
 	if ((internal_desc.BindFlags & (D3D11_BIND_VERTEX_BUFFER | D3D11_BIND_INDEX_BUFFER)) != 0 && (internal_desc.BindFlags & D3D11_BIND_CONSTANT_BUFFER) == 0 && map_type == D3D11_MAP_WRITE)
 		// Use no overwrite flag to simulate D3D12 behavior of there only being one allocation that backs a buffer (instead of the runtime managing multiple ones behind the scenes)
 		map_type = D3D11_MAP_WRITE_NO_OVERWRITE;
+	if ((internal_desc.BindFlags & D3D11_BIND_CONSTANT_BUFFER) != 0 && map_type == D3D11_MAP_WRITE)
+		// Partial constant buffer updates require the no overwrite flag, which needs driver support on the D3D11.1 runtime (see 'device_caps::partial_constant_buffer_updates')
+		// The map below simply fails on drivers without that support, same as it would have with the write flag
+		map_type = D3D11_MAP_WRITE_NO_OVERWRITE;
 
 	com_ptr<ID3D11DeviceContext> immediate_context;
 	_orig->GetImmediateContext(&immediate_context);
@@ -1302,6 +1312,8 @@ void reshade::d3d11::device_impl::copy_descriptor_tables(uint32_t count, const a
 			assert(false);
 			break;
 		}
+
+		dst_table_impl->version++;
 	}
 }
 void reshade::d3d11::device_impl::update_descriptor_tables(uint32_t count, const api::descriptor_table_update *updates)
@@ -1334,6 +1346,8 @@ void reshade::d3d11::device_impl::update_descriptor_tables(uint32_t count, const
 			assert(false);
 			break;
 		}
+
+		table_impl->version++;
 	}
 }
 
@@ -147,11 +147,36 @@ namespace reshade::d3d11
 
 		uint64_t get_timestamp_frequency() const final;
 
+		// Enables or disables skipping of redundant descriptor table binds, which is only safe while the application cannot change bindings, i.e. between state capture and restore (see 'bind_descriptor_tables')
+		void enable_bound_descriptor_table_cache(bool enable);
+		void invalidate_bound_descriptor_tables(bool views_only = false);
+
 	private:
+		void apply_descriptors(api::shader_stage stages, api::pipeline_layout layout, uint32_t layout_param, const api::descriptor_table_update &update);
+
 		device_impl *const _device_impl;
+		com_ptr<ID3D11DeviceContext1> _orig1;
 		com_ptr<ID3DUserDefinedAnnotation> _annotations;
 
 		com_ptr<ID3D11Buffer> _push_constants[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
 		std::vector<uint32_t> _push_constants_data[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+
+		// Most recently applied descriptor table per pipeline layout parameter, used to skip redundant binds of the static effect tables while the cache is enabled
+		struct bound_descriptor_table
+		{
+			uint64_t layout = 0;
+			uint64_t table = 0;
+			uint32_t version = 0;
+			api::shader_stage stages = {};
+			api::descriptor_type type = {};
+		};
+		bound_descriptor_table _bound_descriptor_tables[8];
+		bool _bound_descriptor_table_cache_enabled = false;
 	};
+
+	// Creates a command list implementation backed by a new deferred context, which can be recorded on a worker thread and submitted to the immediate context with 'execute_deferred_command_list'
+	api::command_list *create_deferred_command_list(api::device *device);
+	void destroy_deferred_command_list(api::command_list *cmd_list);
+	// Finishes recording on the deferred context behind the command list implementation and executes the result on the immediate context (this clears the immediate context state)
+	bool execute_deferred_command_list(api::command_queue *immediate_queue, api::command_list *cmd_list);
 }
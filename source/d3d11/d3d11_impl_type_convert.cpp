@@ -5,10 +5,23 @@
 
 #include "d3d11_impl_type_convert.hpp"
 #include <cassert>
+#include <iterator> // std::size
 #include <algorithm> // std::copy_n
 
 auto reshade::d3d11::convert_format(api::format format) -> DXGI_FORMAT
 {
+	// 'api::format' deliberately mirrors 'DXGI_FORMAT', so that this conversion is an identity mapping
+	static_assert(
+		(DXGI_FORMAT)api::format::unknown == DXGI_FORMAT_UNKNOWN &&
+		(DXGI_FORMAT)api::format::r16g16b16a16_float == DXGI_FORMAT_R16G16B16A16_FLOAT &&
+		(DXGI_FORMAT)api::format::r10g10b10a2_unorm == DXGI_FORMAT_R10G10B10A2_UNORM &&
+		(DXGI_FORMAT)api::format::r8g8b8a8_unorm == DXGI_FORMAT_R8G8B8A8_UNORM &&
+		(DXGI_FORMAT)api::format::d32_float == DXGI_FORMAT_D32_FLOAT &&
+		(DXGI_FORMAT)api::format::r32_float == DXGI_FORMAT_R32_FLOAT &&
+		(DXGI_FORMAT)api::format::d24_unorm_s8_uint == DXGI_FORMAT_D24_UNORM_S8_UINT &&
+		(DXGI_FORMAT)api::format::bc1_unorm == DXGI_FORMAT_BC1_UNORM &&
+		(DXGI_FORMAT)api::format::bc7_unorm_srgb == DXGI_FORMAT_BC7_UNORM_SRGB);
+
 	if (static_cast<uint32_t>(format) >= 1000)
 		return DXGI_FORMAT_UNKNOWN;
 
@@ -1363,85 +1376,53 @@ reshade::api::depth_stencil_desc reshade::d3d11::convert_depth_stencil_desc(cons
 
 auto reshade::d3d11::convert_logic_op(api::logic_op value) -> D3D11_LOGIC_OP
 {
-	switch (value)
-	{
-	default:
-		assert(false);
-		[[fallthrough]];
-	case api::logic_op::clear:
-		return D3D11_LOGIC_OP_CLEAR;
-	case api::logic_op::bitwise_and:
-		return D3D11_LOGIC_OP_AND;
-	case api::logic_op::bitwise_and_reverse:
-		return D3D11_LOGIC_OP_AND_REVERSE;
-	case api::logic_op::copy:
-		return D3D11_LOGIC_OP_COPY;
-	case api::logic_op::bitwise_and_inverted:
-		return D3D11_LOGIC_OP_AND_INVERTED;
-	case api::logic_op::noop:
-		return D3D11_LOGIC_OP_NOOP;
-	case api::logic_op::bitwise_xor:
-		return D3D11_LOGIC_OP_XOR;
-	case api::logic_op::bitwise_or:
-		return D3D11_LOGIC_OP_OR;
-	case api::logic_op::bitwise_nor:
-		return D3D11_LOGIC_OP_NOR;
-	case api::logic_op::equivalent:
-		return D3D11_LOGIC_OP_EQUIV;
-	case api::logic_op::invert:
-		return D3D11_LOGIC_OP_INVERT;
-	case api::logic_op::bitwise_or_reverse:
-		return D3D11_LOGIC_OP_OR_REVERSE;
-	case api::logic_op::copy_inverted:
-		return D3D11_LOGIC_OP_COPY_INVERTED;
-	case api::logic_op::bitwise_or_inverted:
-		return D3D11_LOGIC_OP_OR_INVERTED;
-	case api::logic_op::bitwise_nand:
-		return D3D11_LOGIC_OP_NAND;
-	case api::logic_op::set:
-		return D3D11_LOGIC_OP_SET;
-	}
+	// Lookup table indexed by 'api::logic_op'
+	static constexpr D3D11_LOGIC_OP lookup[] = {
+		D3D11_LOGIC_OP_CLEAR,         // api::logic_op::clear
+		D3D11_LOGIC_OP_AND,           // api::logic_op::bitwise_and
+		D3D11_LOGIC_OP_AND_REVERSE,   // api::logic_op::bitwise_and_reverse
+		D3D11_LOGIC_OP_COPY,          // api::logic_op::copy
+		D3D11_LOGIC_OP_AND_INVERTED,  // api::logic_op::bitwise_and_inverted
+		D3D11_LOGIC_OP_NOOP,          // api::logic_op::noop
+		D3D11_LOGIC_OP_XOR,           // api::logic_op::bitwise_xor
+		D3D11_LOGIC_OP_OR,            // api::logic_op::bitwise_or
+		D3D11_LOGIC_OP_NOR,           // api::logic_op::bitwise_nor
+		D3D11_LOGIC_OP_EQUIV,         // api::logic_op::equivalent
+		D3D11_LOGIC_OP_INVERT,        // api::logic_op::invert
+		D3D11_LOGIC_OP_OR_REVERSE,    // api::logic_op::bitwise_or_reverse
+		D3D11_LOGIC_OP_COPY_INVERTED, // api::logic_op::copy_inverted
+		D3D11_LOGIC_OP_OR_INVERTED,   // api::logic_op::bitwise_or_inverted
+		D3D11_LOGIC_OP_NAND,          // api::logic_op::bitwise_nand
+		D3D11_LOGIC_OP_SET,           // api::logic_op::set
+	};
+
+	assert(static_cast<uint32_t>(value) < std::size(lookup));
+	return lookup[static_cast<uint32_t>(value)];
 }
 auto reshade::d3d11::convert_logic_op(D3D11_LOGIC_OP value) -> api::logic_op
 {
-	switch (value)
-	{
-	default:
-		assert(false);
-		[[fallthrough]];
-	case D3D11_LOGIC_OP_CLEAR:
-		return api::logic_op::clear;
-	case D3D11_LOGIC_OP_AND:
-		return api::logic_op::bitwise_and;
-	case D3D11_LOGIC_OP_AND_REVERSE:
-		return api::logic_op::bitwise_and_reverse;
-	case D3D11_LOGIC_OP_COPY:
-		return api::logic_op::copy;
-	case D3D11_LOGIC_OP_AND_INVERTED:
-		return api::logic_op::bitwise_and_inverted;
-	case D3D11_LOGIC_OP_NOOP:
-		return api::logic_op::noop;
-	case D3D11_LOGIC_OP_XOR:
-		return api::logic_op::bitwise_xor;
-	case D3D11_LOGIC_OP_OR:
-		return api::logic_op::bitwise_or;
-	case D3D11_LOGIC_OP_NOR:
-		return api::logic_op::bitwise_nor;
-	case D3D11_LOGIC_OP_EQUIV:
-		return api::logic_op::equivalent;
-	case D3D11_LOGIC_OP_INVERT:
-		return api::logic_op::invert;
-	case D3D11_LOGIC_OP_OR_REVERSE:
-		return api::logic_op::bitwise_or_reverse;
-	case D3D11_LOGIC_OP_COPY_INVERTED:
-		return api::logic_op::copy_inverted;
-	case D3D11_LOGIC_OP_OR_INVERTED:
-		return api::logic_op::bitwise_or_inverted;
-	case D3D11_LOGIC_OP_NAND:
-		return api::logic_op::bitwise_nand;
-	case D3D11_LOGIC_OP_SET:
-		return api::logic_op::set;
-	}
+	// Lookup table indexed by 'D3D11_LOGIC_OP'
+	static constexpr api::logic_op lookup[] = {
+		api::logic_op::clear,                // D3D11_LOGIC_OP_CLEAR
+		api::logic_op::set,                  // D3D11_LOGIC_OP_SET
+		api::logic_op::copy,                 // D3D11_LOGIC_OP_COPY
+		api::logic_op::copy_inverted,        // D3D11_LOGIC_OP_COPY_INVERTED
+		api::logic_op::noop,                 // D3D11_LOGIC_OP_NOOP
+		api::logic_op::invert,               // D3D11_LOGIC_OP_INVERT
+		api::logic_op::bitwise_and,          // D3D11_LOGIC_OP_AND
+		api::logic_op::bitwise_nand,         // D3D11_LOGIC_OP_NAND
+		api::logic_op::bitwise_or,           // D3D11_LOGIC_OP_OR
+		api::logic_op::bitwise_nor,          // D3D11_LOGIC_OP_NOR
+		api::logic_op::bitwise_xor,          // D3D11_LOGIC_OP_XOR
+		api::logic_op::equivalent,           // D3D11_LOGIC_OP_EQUIV
+		api::logic_op::bitwise_and_reverse,  // D3D11_LOGIC_OP_AND_REVERSE
+		api::logic_op::bitwise_and_inverted, // D3D11_LOGIC_OP_AND_INVERTED
+		api::logic_op::bitwise_or_reverse,   // D3D11_LOGIC_OP_OR_REVERSE
+		api::logic_op::bitwise_or_inverted,  // D3D11_LOGIC_OP_OR_INVERTED
+	};
+
+	assert(static_cast<uint32_t>(value) < std::size(lookup));
+	return lookup[static_cast<uint32_t>(value)];
 }
 auto reshade::d3d11::convert_blend_op(api::blend_op value) -> D3D11_BLEND_OP
 {
@@ -1453,95 +1434,63 @@ auto reshade::d3d11::convert_blend_op(D3D11_BLEND_OP value) -> api::blend_op
 }
 auto reshade::d3d11::convert_blend_factor(api::blend_factor value) -> D3D11_BLEND
 {
-	switch (value)
-	{
-	default:
-		assert(false);
-		[[fallthrough]];
-	case api::blend_factor::zero:
-		return D3D11_BLEND_ZERO;
-	case api::blend_factor::one:
-		return D3D11_BLEND_ONE;
-	case api::blend_factor::source_color:
-		return D3D11_BLEND_SRC_COLOR;
-	case api::blend_factor::one_minus_source_color:
-		return D3D11_BLEND_INV_SRC_COLOR;
-	case api::blend_factor::dest_color:
-		return D3D11_BLEND_DEST_COLOR;
-	case api::blend_factor::one_minus_dest_color:
-		return D3D11_BLEND_INV_DEST_COLOR;
-	case api::blend_factor::source_alpha:
-		return D3D11_BLEND_SRC_ALPHA;
-	case api::blend_factor::one_minus_source_alpha:
-		return D3D11_BLEND_INV_SRC_ALPHA;
-	case api::blend_factor::dest_alpha:
-		return D3D11_BLEND_DEST_ALPHA;
-	case api::blend_factor::one_minus_dest_alpha:
-		return D3D11_BLEND_INV_DEST_ALPHA;
-	case api::blend_factor::constant_alpha:
-		assert(false);
-		[[fallthrough]];
-	case api::blend_factor::constant_color:
-		return D3D11_BLEND_BLEND_FACTOR;
-	case api::blend_factor::one_minus_constant_alpha:
-		assert(false);
-		[[fallthrough]];
-	case api::blend_factor::one_minus_constant_color:
-		return D3D11_BLEND_INV_BLEND_FACTOR;
-	case api::blend_factor::source_alpha_saturate:
-		return D3D11_BLEND_SRC_ALPHA_SAT;
-	case api::blend_factor::source1_color:
-		return D3D11_BLEND_SRC1_COLOR;
-	case api::blend_factor::one_minus_source1_color:
-		return D3D11_BLEND_INV_SRC1_COLOR;
-	case api::blend_factor::source1_alpha:
-		return D3D11_BLEND_SRC1_ALPHA;
-	case api::blend_factor::one_minus_source1_alpha:
-		return D3D11_BLEND_INV_SRC1_ALPHA;
-	}
+	// D3D11 does not distinguish between constant color and alpha blend factors
+	assert(value != api::blend_factor::constant_alpha && value != api::blend_factor::one_minus_constant_alpha);
+
+	// Lookup table indexed by 'api::blend_factor'
+	static constexpr D3D11_BLEND lookup[] = {
+		D3D11_BLEND_ZERO,             // api::blend_factor::zero
+		D3D11_BLEND_ONE,              // api::blend_factor::one
+		D3D11_BLEND_SRC_COLOR,        // api::blend_factor::source_color
+		D3D11_BLEND_INV_SRC_COLOR,    // api::blend_factor::one_minus_source_color
+		D3D11_BLEND_DEST_COLOR,       // api::blend_factor::dest_color
+		D3D11_BLEND_INV_DEST_COLOR,   // api::blend_factor::one_minus_dest_color
+		D3D11_BLEND_SRC_ALPHA,        // api::blend_factor::source_alpha
+		D3D11_BLEND_INV_SRC_ALPHA,    // api::blend_factor::one_minus_source_alpha
+		D3D11_BLEND_DEST_ALPHA,       // api::blend_factor::dest_alpha
+		D3D11_BLEND_INV_DEST_ALPHA,   // api::blend_factor::one_minus_dest_alpha
+		D3D11_BLEND_BLEND_FACTOR,     // api::blend_factor::constant_color
+		D3D11_BLEND_INV_BLEND_FACTOR, // api::blend_factor::one_minus_constant_color
+		D3D11_BLEND_BLEND_FACTOR,     // api::blend_factor::constant_alpha
+		D3D11_BLEND_INV_BLEND_FACTOR, // api::blend_factor::one_minus_constant_alpha
+		D3D11_BLEND_SRC_ALPHA_SAT,    // api::blend_factor::source_alpha_saturate
+		D3D11_BLEND_SRC1_COLOR,       // api::blend_factor::source1_color
+		D3D11_BLEND_INV_SRC1_COLOR,   // api::blend_factor::one_minus_source1_color
+		D3D11_BLEND_SRC1_ALPHA,       // api::blend_factor::source1_alpha
+		D3D11_BLEND_INV_SRC1_ALPHA,   // api::blend_factor::one_minus_source1_alpha
+	};
+
+	assert(static_cast<uint32_t>(value) < std::size(lookup));
+	return lookup[static_cast<uint32_t>(value)];
 }
 auto reshade::d3d11::convert_blend_factor(D3D11_BLEND value) -> api::blend_factor
 {
-	switch (value)
-	{
-	default:
-		assert(false);
-		[[fallthrough]];
-	case D3D11_BLEND_ZERO:
-		return api::blend_factor::zero;
-	case D3D11_BLEND_ONE:
-		return api::blend_factor::one;
-	case D3D11_BLEND_SRC_COLOR:
-		return api::blend_factor::source_color;
-	case D3D11_BLEND_INV_SRC_COLOR:
-		return api::blend_factor::one_minus_source_color;
-	case D3D11_BLEND_DEST_COLOR:
-		return api::blend_factor::dest_color;
-	case D3D11_BLEND_INV_DEST_COLOR:
-		return api::blend_factor::one_minus_dest_color;
-	case D3D11_BLEND_SRC_ALPHA:
-		return api::blend_factor::source_alpha;
-	case D3D11_BLEND_INV_SRC_ALPHA:
-		return api::blend_factor::one_minus_source_alpha;
-	case D3D11_BLEND_DEST_ALPHA:
-		return api::blend_factor::dest_alpha;
-	case D3D11_BLEND_INV_DEST_ALPHA:
-		return api::blend_factor::one_minus_dest_alpha;
-	case D3D11_BLEND_BLEND_FACTOR:
-		return api::blend_factor::constant_color;
-	case D3D11_BLEND_INV_BLEND_FACTOR:
-		return api::blend_factor::one_minus_constant_color;
-	case D3D11_BLEND_SRC_ALPHA_SAT:
-		return api::blend_factor::source_alpha_saturate;
-	case D3D11_BLEND_SRC1_COLOR:
-		return api::blend_factor::source1_color;
-	case D3D11_BLEND_INV_SRC1_COLOR:
-		return api::blend_factor::one_minus_source1_color;
-	case D3D11_BLEND_SRC1_ALPHA:
-		return api::blend_factor::source1_alpha;
-	case D3D11_BLEND_INV_SRC1_ALPHA:
-		return api::blend_factor::one_minus_source1_alpha;
-	}
+	// Lookup table indexed by 'D3D11_BLEND' (which has no values 0, 12 and 13)
+	static constexpr api::blend_factor lookup[] = {
+		api::blend_factor::zero,                       // 0
+		api::blend_factor::zero,                       // D3D11_BLEND_ZERO
+		api::blend_factor::one,                        // D3D11_BLEND_ONE
+		api::blend_factor::source_color,               // D3D11_BLEND_SRC_COLOR
+		api::blend_factor::one_minus_source_color,     // D3D11_BLEND_INV_SRC_COLOR
+		api::blend_factor::source_alpha,               // D3D11_BLEND_SRC_ALPHA
+		api::blend_factor::one_minus_source_alpha,     // D3D11_BLEND_INV_SRC_ALPHA
+		api::blend_factor::dest_alpha,                 // D3D11_BLEND_DEST_ALPHA
+		api::blend_factor::one_minus_dest_alpha,       // D3D11_BLEND_INV_DEST_ALPHA
+		api::blend_factor::dest_color,                 // D3D11_BLEND_DEST_COLOR
+		api::blend_factor::one_minus_dest_color,       // D3D11_BLEND_INV_DEST_COLOR
+		api::blend_factor::source_alpha_saturate,      // D3D11_BLEND_SRC_ALPHA_SAT
+		api::blend_factor::zero,                       // 12
+		api::blend_factor::zero,                       // 13
+		api::blend_factor::constant_color,             // D3D11_BLEND_BLEND_FACTOR
+		api::blend_factor::one_minus_constant_color,   // D3D11_BLEND_INV_BLEND_FACTOR
+		api::blend_factor::source1_color,              // D3D11_BLEND_SRC1_COLOR
+		api::blend_factor::one_minus_source1_color,    // D3D11_BLEND_INV_SRC1_COLOR
+		api::blend_factor::source1_alpha,              // D3D11_BLEND_SRC1_ALPHA
+		api::blend_factor::one_minus_source1_alpha,    // D3D11_BLEND_INV_SRC1_ALPHA
+	};
+
+	assert(value >= D3D11_BLEND_ZERO && static_cast<uint32_t>(value) < std::size(lookup));
+	return lookup[static_cast<uint32_t>(value)];
 }
 auto reshade::d3d11::convert_fill_mode(api::fill_mode value) -> D3D11_FILL_MODE
 {
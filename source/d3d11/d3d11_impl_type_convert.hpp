@@ -44,6 +44,8 @@ namespace reshade::d3d11
 		api::descriptor_type type;
 		uint32_t count;
 		uint32_t base_binding;
+		// Incremented whenever the descriptors change, so that contexts can detect stale entries in their bound table cache (see 'device_context_impl::bind_descriptor_tables')
+		uint32_t version = 0;
 		std::vector<uint64_t> descriptors;
 	};
 
@@ -165,6 +165,7 @@ HRESULT STDMETHODCALLTYPE D3D12GraphicsCommandList::Reset(ID3D12CommandAllocator
 #if RESHADE_ADDON >= 2
 	_previous_descriptor_heaps[0] = nullptr;
 	_previous_descriptor_heaps[1] = nullptr;
+	_last_descriptor_heap = nullptr;
 #endif
 
 	const HRESULT hr = _orig->Reset(pAllocator, pInitialState);
@@ -191,6 +192,7 @@ void STDMETHODCALLTYPE D3D12GraphicsCommandList::ClearState(ID3D12PipelineState
 #if RESHADE_ADDON >= 2
 	_previous_descriptor_heaps[0] = nullptr;
 	_previous_descriptor_heaps[1] = nullptr;
+	_last_descriptor_heap = nullptr;
 
 	reshade::invoke_addon_event<reshade::addon_event::bind_pipeline>(this, reshade::api::pipeline_stage::all, to_handle(pPipelineState));
 
@@ -168,7 +168,7 @@ void    STDMETHODCALLTYPE D3D12CommandQueue::ExecuteCommandLists(UINT NumCommand
 	// Synchronize access to this command queue while events are invoked and the immediate command list may be accessed
 	std::unique_lock<std::shared_mutex> lock(_mutex);
 
-	temp_mem<ID3D12CommandList *> command_lists(NumCommandLists);
+	temp_mem<ID3D12CommandList *> command_lists(1 + NumCommandLists);
 	for (UINT i = 0; i < NumCommandLists; ++i)
 	{
 		assert(ppCommandLists[i] != nullptr);
@@ -181,20 +181,30 @@ void    STDMETHODCALLTYPE D3D12CommandQueue::ExecuteCommandLists(UINT NumCommand
 #endif
 
 			// Get original command list pointer from proxy object
-			command_lists[i] = command_list_proxy->_orig;
+			command_lists[1 + i] = command_list_proxy->_orig;
 		}
 		else
 		{
 			// This can be a compute command list too, which have no proxy object
-			command_lists[i] = ppCommandLists[i];
+			command_lists[1 + i] = ppCommandLists[i];
 		}
 	}
 
-	flush_immediate_command_list();
+	// Batch any pending runtime commands into the same submission as the application command lists, which avoids the driver overhead and extra fence signal of a separate 'ExecuteCommandLists' call
+	if (ID3D12CommandList *const immediate_cmd_list = begin_immediate_command_list_flush())
+	{
+		command_lists[0] = immediate_cmd_list;
+
+		_orig->ExecuteCommandLists(1 + NumCommandLists, command_lists.p);
+
+		// The fence signal and command list reset must not happen until after the submission above
+		end_immediate_command_list_flush();
+		return;
+	}
 
 	lock.unlock();
 
-	_orig->ExecuteCommandLists(NumCommandLists, command_lists.p);
+	_orig->ExecuteCommandLists(NumCommandLists, command_lists.p + 1);
 }
 void    STDMETHODCALLTYPE D3D12CommandQueue::SetMarker(UINT Metadata, const void *pData, UINT Size)
 {
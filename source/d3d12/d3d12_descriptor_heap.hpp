@@ -44,6 +44,10 @@ struct DECLSPEC_UUID("8628AD68-6047-4D27-9D87-3E5F386E0231") D3D12DescriptorHeap
 	D3D12_CPU_DESCRIPTOR_HANDLE _orig_base_cpu_handle = { 0 };
 	D3D12_GPU_DESCRIPTOR_HANDLE _orig_base_gpu_handle = { 0 };
 	D3D12_CPU_DESCRIPTOR_HANDLE _internal_base_cpu_handle = { 0 };
+
+	// Heap type and size in bytes of the range starting at '_orig_base_gpu_handle', cached so that descriptor handle resolution does not have to query the heap description
+	D3D12_DESCRIPTOR_HEAP_TYPE _orig_heap_type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	UINT64 _orig_gpu_handle_range = 0;
 };
 
 #endif
@@ -31,6 +31,7 @@ D3D12Device::D3D12Device(ID3D12Device *original) :
 	// Add proxy object to the private data of the device, so that it can be retrieved again when only the original device is available
 	D3D12Device *const device_proxy = this;
 	_orig->SetPrivateData(__uuidof(D3D12Device), sizeof(device_proxy), &device_proxy);
+	com_pointer_table<D3D12Device>::insert(_orig, this);
 
 #if RESHADE_ADDON
 	reshade::load_addons();
@@ -47,6 +48,7 @@ D3D12Device::~D3D12Device()
 #endif
 
 	// Remove pointer to this proxy object from the private data of the device (in case the device unexpectedly survives)
+	com_pointer_table<D3D12Device>::erase(_orig);
 	_orig->SetPrivateData(__uuidof(D3D12Device), 0, nullptr);
 }
 
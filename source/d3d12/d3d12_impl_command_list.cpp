@@ -5,6 +5,7 @@
 
 #include "d3d12_impl_device.hpp"
 #include "d3d12_impl_command_list.hpp"
+#include "d3d12_descriptor_heap.hpp"
 #include "d3d12_impl_type_convert.hpp"
 #include "dll_log.hpp"
 #include <cstring> // std::strlen, std::strncpy
@@ -47,6 +48,15 @@ void reshade::d3d12::command_list_impl::on_init()
 		if (_orig->QueryInterface(s_command_list_ex_guid, reinterpret_cast<void **>(&cmd_list_ex)) != S_OK)
 			_supports_render_passes = true;
 	}
+
+	com_ptr<ID3D12GraphicsCommandList7> cmd_list7;
+	if (_device_impl->_supports_enhanced_barriers &&
+		SUCCEEDED(_orig->QueryInterface(&cmd_list7)))
+	{
+		_orig->Release();
+		_orig = cmd_list7.release();
+		_supports_enhanced_barriers = true;
+	}
 }
 
 reshade::api::device *reshade::d3d12::command_list_impl::get_device()
@@ -59,30 +69,183 @@ void reshade::d3d12::command_list_impl::barrier(uint32_t count, const api::resou
 	if (count == 0)
 		return;
 
+	if (!_batch_barriers)
+	{
+		submit_barriers(count, resources, old_states, new_states);
+		return;
+	}
+
 	_has_commands = true;
 
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (resources[i] != 0)
+		{
+			// Find the most recent pending barrier for this resource, so that transition chains are merged in order
+			size_t k = _pending_barrier_resources.size();
+			while (k != 0 && _pending_barrier_resources[k - 1] != resources[i])
+				--k;
+
+			if (k != 0)
+			{
+				const size_t pending = k - 1;
+
+				// A duplicate of an identical pending barrier has no additional effect, since no commands were recorded in between
+				if (_pending_barrier_old_states[pending] == old_states[i] && _pending_barrier_new_states[pending] == new_states[i])
+					continue;
+
+				// UAV and aliasing barriers have meaning beyond the state transition and must not take part in merging
+				const bool pending_is_special =
+					(_pending_barrier_old_states[pending] == api::resource_usage::unordered_access && _pending_barrier_new_states[pending] == api::resource_usage::unordered_access) ||
+					(_pending_barrier_old_states[pending] == api::resource_usage::undefined && _pending_barrier_new_states[pending] == api::resource_usage::general);
+				const bool current_is_special =
+					(old_states[i] == api::resource_usage::unordered_access && new_states[i] == api::resource_usage::unordered_access) ||
+					(old_states[i] == api::resource_usage::undefined && new_states[i] == api::resource_usage::general);
+
+				// Only the resulting state of a transition chain matters when no commands were recorded in between, so the intermediate state can be elided
+				if (!pending_is_special && !current_is_special && _pending_barrier_new_states[pending] == old_states[i])
+				{
+					if (_pending_barrier_old_states[pending] == new_states[i])
+					{
+						// The chain transitions back to the original state, which makes the barrier redundant altogether
+						_pending_barrier_resources.erase(_pending_barrier_resources.begin() + pending);
+						_pending_barrier_old_states.erase(_pending_barrier_old_states.begin() + pending);
+						_pending_barrier_new_states.erase(_pending_barrier_new_states.begin() + pending);
+					}
+					else
+					{
+						_pending_barrier_new_states[pending] = new_states[i];
+					}
+					continue;
+				}
+			}
+			else
+			{
+				// Skip transitions that do not change the state (but keep UAV barriers, which use identical states before and after)
+				if (old_states[i] == new_states[i] && old_states[i] != api::resource_usage::unordered_access)
+					continue;
+			}
+		}
+
+		_pending_barrier_resources.push_back(resources[i]);
+		_pending_barrier_old_states.push_back(old_states[i]);
+		_pending_barrier_new_states.push_back(new_states[i]);
+	}
+}
+void reshade::d3d12::command_list_impl::set_barrier_batching(bool enable)
+{
+	// Submit any accumulated barriers when batching is turned off
+	if (!enable)
+		flush_barriers();
+
+	_batch_barriers = enable;
+}
+void reshade::d3d12::command_list_impl::flush_barriers()
+{
+	if (_pending_barrier_resources.empty())
+		return;
+
+	submit_barriers(static_cast<uint32_t>(_pending_barrier_resources.size()), _pending_barrier_resources.data(), _pending_barrier_old_states.data(), _pending_barrier_new_states.data());
+
+	_pending_barrier_resources.clear();
+	_pending_barrier_old_states.clear();
+	_pending_barrier_new_states.clear();
+}
+void reshade::d3d12::command_list_impl::submit_barriers(uint32_t count, const api::resource *resources, const api::resource_usage *old_states, const api::resource_usage *new_states)
+{
+	_has_commands = true;
+
+	// Prefer enhanced barriers when supported, since they can express the precise synchronization scope of a transition, rather than the worst-case full pipeline synchronization of legacy resource barriers
+	if (_supports_enhanced_barriers)
+	{
+		temp_mem<D3D12_GLOBAL_BARRIER> global_barriers(count);
+		temp_mem<D3D12_BUFFER_BARRIER> buffer_barriers(count);
+		temp_mem<D3D12_TEXTURE_BARRIER> texture_barriers(count);
+		uint32_t num_global_barriers = 0, num_buffer_barriers = 0, num_texture_barriers = 0;
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (resources[i] == 0)
+			{
+				D3D12_GLOBAL_BARRIER &barrier = global_barriers[num_global_barriers++];
+				barrier.SyncBefore = D3D12_BARRIER_SYNC_ALL;
+				barrier.SyncAfter = D3D12_BARRIER_SYNC_ALL;
+				barrier.AccessBefore = convert_usage_to_access(old_states[i]);
+				barrier.AccessAfter = convert_usage_to_access(new_states[i]);
+				continue;
+			}
+
+			const auto resource = reinterpret_cast<ID3D12Resource *>(resources[i].handle);
+
+			if (resource->GetDesc().Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+			{
+				D3D12_BUFFER_BARRIER &barrier = buffer_barriers[num_buffer_barriers++];
+				barrier.SyncBefore = convert_usage_to_barrier_sync(old_states[i]);
+				barrier.SyncAfter = convert_usage_to_barrier_sync(new_states[i]);
+				barrier.AccessBefore = convert_usage_to_access(old_states[i]);
+				barrier.AccessAfter = convert_usage_to_access(new_states[i]);
+				barrier.pResource = resource;
+				barrier.Offset = 0;
+				barrier.Size = UINT64_MAX;
+			}
+			else
+			{
+				D3D12_TEXTURE_BARRIER &barrier = texture_barriers[num_texture_barriers++];
+				barrier.SyncBefore = convert_usage_to_barrier_sync(old_states[i]);
+				barrier.SyncAfter = convert_usage_to_barrier_sync(new_states[i]);
+				// The common and present layouts are not compatible with the specific accesses implied by those usages, so use common access for them instead
+				barrier.AccessBefore = (old_states[i] & api::resource_usage::general) != 0 ? D3D12_BARRIER_ACCESS_COMMON : convert_usage_to_access(old_states[i]);
+				barrier.AccessAfter = (new_states[i] & api::resource_usage::general) != 0 ? D3D12_BARRIER_ACCESS_COMMON : convert_usage_to_access(new_states[i]);
+				barrier.LayoutBefore = convert_usage_to_barrier_layout(old_states[i]);
+				barrier.LayoutAfter = convert_usage_to_barrier_layout(new_states[i]);
+				barrier.pResource = resource;
+				barrier.Subresources.IndexOrFirstMipLevel = 0xFFFFFFFF; // All subresources
+				barrier.Subresources.NumMipLevels = 0;
+				barrier.Subresources.FirstArraySlice = 0;
+				barrier.Subresources.NumArraySlices = 0;
+				barrier.Subresources.FirstPlane = 0;
+				barrier.Subresources.NumPlanes = 0;
+				barrier.Flags = D3D12_TEXTURE_BARRIER_FLAG_NONE;
+			}
+		}
+
+		uint32_t barrier_group_count = 0;
+		D3D12_BARRIER_GROUP barrier_groups[3];
+		if (num_global_barriers != 0)
+		{
+			barrier_groups[barrier_group_count].Type = D3D12_BARRIER_TYPE_GLOBAL;
+			barrier_groups[barrier_group_count].NumBarriers = num_global_barriers;
+			barrier_groups[barrier_group_count].pGlobalBarriers = global_barriers.p;
+			barrier_group_count++;
+		}
+		if (num_buffer_barriers != 0)
+		{
+			barrier_groups[barrier_group_count].Type = D3D12_BARRIER_TYPE_BUFFER;
+			barrier_groups[barrier_group_count].NumBarriers = num_buffer_barriers;
+			barrier_groups[barrier_group_count].pBufferBarriers = buffer_barriers.p;
+			barrier_group_count++;
+		}
+		if (num_texture_barriers != 0)
+		{
+			barrier_groups[barrier_group_count].Type = D3D12_BARRIER_TYPE_TEXTURE;
+			barrier_groups[barrier_group_count].NumBarriers = num_texture_barriers;
+			barrier_groups[barrier_group_count].pTextureBarriers = texture_barriers.p;
+			barrier_group_count++;
+		}
+
+		if (barrier_group_count != 0)
+			static_cast<ID3D12GraphicsCommandList7 *>(_orig)->Barrier(barrier_group_count, barrier_groups);
+		return;
+	}
+
 	uint32_t k = 0;
 	temp_mem<D3D12_RESOURCE_BARRIER> barriers(count);
 	for (uint32_t i = 0; i < count; ++i)
 	{
 		if (resources[i] == 0)
 		{
-			D3D12_GLOBAL_BARRIER barrier = {};
-			barrier.SyncBefore = D3D12_BARRIER_SYNC_ALL;
-			barrier.SyncAfter = D3D12_BARRIER_SYNC_ALL;
-			barrier.AccessBefore = convert_usage_to_access(old_states[i]);
-			barrier.AccessAfter = convert_usage_to_access(new_states[i]);
-
-			D3D12_BARRIER_GROUP barrier_group = {};
-			barrier_group.Type = D3D12_BARRIER_TYPE_GLOBAL;
-			barrier_group.NumBarriers = 1;
-			barrier_group.pGlobalBarriers = &barrier;
-
-			com_ptr<ID3D12GraphicsCommandList7> cmd_list7;
-			if (SUCCEEDED(_orig->QueryInterface(&cmd_list7)))
-				cmd_list7->Barrier(1, &barrier_group);
-			else
-				assert(false);
+			// Global barriers require enhanced barrier support
+			assert(false);
 			continue;
 		}
 
@@ -111,11 +274,14 @@ void reshade::d3d12::command_list_impl::barrier(uint32_t count, const api::resou
 		k++;
 	}
 
-	_orig->ResourceBarrier(k, barriers.p);
+	if (k != 0)
+		_orig->ResourceBarrier(k, barriers.p);
 }
 
 void reshade::d3d12::command_list_impl::begin_render_pass(uint32_t count, const api::render_pass_render_target_desc *rts, const api::render_pass_depth_stencil_desc *ds)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(count <= D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT);
@@ -513,7 +679,28 @@ void reshade::d3d12::command_list_impl::bind_descriptor_tables(api::shader_stage
 
 	for (uint32_t i = 0; i < count; ++i)
 	{
-		ID3D12DescriptorHeap *const heap = _device_impl->get_descriptor_heap(tables[i]);
+		ID3D12DescriptorHeap *heap = nullptr;
+#if RESHADE_ADDON >= 2
+		if ((tables[i].handle & 0xF000000000000000ull) != 0xF000000000000000ull)
+		{
+			const D3D12_GPU_DESCRIPTOR_HANDLE handle_gpu = { tables[i].handle };
+
+			// Fast path for the common case of consecutive tables coming from a single descriptor heap
+			if (_last_descriptor_heap == nullptr ||
+				handle_gpu.ptr < _last_descriptor_heap->_orig_base_gpu_handle.ptr ||
+				handle_gpu.ptr >= _last_descriptor_heap->_orig_base_gpu_handle.ptr + _last_descriptor_heap->_orig_gpu_handle_range)
+				_last_descriptor_heap = _device_impl->find_descriptor_heap(handle_gpu);
+
+			if (_last_descriptor_heap != nullptr)
+				heap = _last_descriptor_heap->_orig;
+		}
+		else
+		{
+			heap = _device_impl->get_descriptor_heap(tables[i]);
+		}
+#else
+		heap = _device_impl->get_descriptor_heap(tables[i]);
+#endif
 		if (heap == nullptr)
 			continue;
 
@@ -636,24 +823,32 @@ void reshade::d3d12::command_list_impl::bind_stream_output_buffers(uint32_t firs
 
 void reshade::d3d12::command_list_impl::draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	_orig->DrawInstanced(vertex_count, instance_count, first_vertex, first_instance);
 }
 void reshade::d3d12::command_list_impl::draw_indexed(uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	_orig->DrawIndexedInstanced(index_count, instance_count, first_index, vertex_offset, first_instance);
 }
 void reshade::d3d12::command_list_impl::dispatch(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	_orig->Dispatch(group_count_x, group_count_y, group_count_z);
 }
 void reshade::d3d12::command_list_impl::dispatch_mesh(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	com_ptr<ID3D12GraphicsCommandList6> cmd_list6;
@@ -664,6 +859,8 @@ void reshade::d3d12::command_list_impl::dispatch_mesh(uint32_t group_count_x, ui
 }
 void reshade::d3d12::command_list_impl::dispatch_rays(api::resource raygen, uint64_t raygen_offset, uint64_t raygen_size, api::resource miss, uint64_t miss_offset, uint64_t miss_size, uint64_t miss_stride, api::resource hit_group, uint64_t hit_group_offset, uint64_t hit_group_size, uint64_t hit_group_stride, api::resource callable, uint64_t callable_offset, uint64_t callable_size, uint64_t callable_stride, uint32_t width, uint32_t height, uint32_t depth)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	if (_supports_ray_tracing)
@@ -698,6 +895,8 @@ void reshade::d3d12::command_list_impl::draw_or_dispatch_indirect(api::indirect_
 
 void reshade::d3d12::command_list_impl::copy_resource(api::resource src, api::resource dst)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(src != 0 && dst != 0);
@@ -714,6 +913,8 @@ void reshade::d3d12::command_list_impl::copy_resource(api::resource src, api::re
 }
 void reshade::d3d12::command_list_impl::copy_buffer_region(api::resource src, uint64_t src_offset, api::resource dst, uint64_t dst_offset, uint64_t size)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(src != 0 && dst != 0);
@@ -725,6 +926,8 @@ void reshade::d3d12::command_list_impl::copy_buffer_region(api::resource src, ui
 }
 void reshade::d3d12::command_list_impl::copy_buffer_to_texture(api::resource src, uint64_t src_offset, uint32_t row_length, uint32_t slice_height, api::resource dst, uint32_t dst_subresource, const api::subresource_box *dst_box)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(src != 0 && dst != 0);
@@ -766,6 +969,8 @@ void reshade::d3d12::command_list_impl::copy_buffer_to_texture(api::resource src
 }
 void reshade::d3d12::command_list_impl::copy_texture_region(api::resource src, uint32_t src_subresource, const api::subresource_box *src_box, api::resource dst, uint32_t dst_subresource, const api::subresource_box *dst_box, api::filter_mode)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(src != 0 && dst != 0);
@@ -823,6 +1028,8 @@ void reshade::d3d12::command_list_impl::copy_texture_region(api::resource src, u
 }
 void reshade::d3d12::command_list_impl::copy_texture_to_buffer(api::resource src, uint32_t src_subresource, const api::subresource_box *src_box, api::resource dst, uint64_t dst_offset, uint32_t row_length, uint32_t slice_height)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(src != 0 && dst != 0);
@@ -850,6 +1057,8 @@ void reshade::d3d12::command_list_impl::copy_texture_to_buffer(api::resource src
 }
 void reshade::d3d12::command_list_impl::resolve_texture_region(api::resource src, uint32_t src_subresource, const api::subresource_box *src_box, api::resource dst, uint32_t dst_subresource, int32_t dst_x, int32_t dst_y, int32_t dst_z, api::format format)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(src != 0 && dst != 0);
@@ -927,6 +1136,8 @@ void reshade::d3d12::command_list_impl::resolve_texture_region(api::resource src
 
 void reshade::d3d12::command_list_impl::clear_depth_stencil_view(api::resource_view dsv, const float *depth, const uint8_t *stencil, uint32_t rect_count, const api::rect *rects)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(dsv != 0);
@@ -938,6 +1149,8 @@ void reshade::d3d12::command_list_impl::clear_depth_stencil_view(api::resource_v
 }
 void reshade::d3d12::command_list_impl::clear_render_target_view(api::resource_view rtv, const float color[4], uint32_t rect_count, const api::rect *rects)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(rtv != 0);
@@ -946,6 +1159,8 @@ void reshade::d3d12::command_list_impl::clear_render_target_view(api::resource_v
 }
 void reshade::d3d12::command_list_impl::clear_unordered_access_view_uint(api::resource_view uav, const uint32_t values[4], uint32_t rect_count, const api::rect *rects)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(uav != 0);
@@ -974,6 +1189,8 @@ void reshade::d3d12::command_list_impl::clear_unordered_access_view_uint(api::re
 }
 void reshade::d3d12::command_list_impl::clear_unordered_access_view_float(api::resource_view uav, const float values[4], uint32_t rect_count, const api::rect *rects)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(uav != 0);
@@ -1006,6 +1223,8 @@ void reshade::d3d12::command_list_impl::generate_mipmaps(api::resource_view srv)
 	if (_device_impl->_mipmap_pipeline == nullptr)
 		return;
 
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(srv != 0);
@@ -1098,6 +1317,8 @@ void reshade::d3d12::command_list_impl::generate_mipmaps(api::resource_view srv)
 
 void reshade::d3d12::command_list_impl::begin_query(api::query_heap heap, api::query_type type, uint32_t index)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(heap != 0);
@@ -1106,6 +1327,8 @@ void reshade::d3d12::command_list_impl::begin_query(api::query_heap heap, api::q
 }
 void reshade::d3d12::command_list_impl::end_query(api::query_heap heap, api::query_type type, uint32_t index)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(heap != 0);
@@ -1114,6 +1337,8 @@ void reshade::d3d12::command_list_impl::end_query(api::query_heap heap, api::que
 }
 void reshade::d3d12::command_list_impl::copy_query_heap_results(api::query_heap heap, api::query_type type, uint32_t first, uint32_t count, api::resource dst, uint64_t dst_offset, uint32_t stride)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(heap != 0);
@@ -1124,6 +1349,8 @@ void reshade::d3d12::command_list_impl::copy_query_heap_results(api::query_heap
 
 void reshade::d3d12::command_list_impl::copy_acceleration_structure(api::resource_view source, api::resource_view dest, api::acceleration_structure_copy_mode mode)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	if (_supports_ray_tracing)
@@ -1133,6 +1360,8 @@ void reshade::d3d12::command_list_impl::copy_acceleration_structure(api::resourc
 }
 void reshade::d3d12::command_list_impl::build_acceleration_structure(api::acceleration_structure_type type, api::acceleration_structure_build_flags flags, uint32_t input_count, const api::acceleration_structure_build_input *inputs, api::resource scratch, uint64_t scratch_offset, api::resource_view source, api::resource_view dest, api::acceleration_structure_build_mode mode)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	if (_supports_ray_tracing)
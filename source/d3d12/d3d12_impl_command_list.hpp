@@ -8,6 +8,8 @@
 #include <d3d12.h>
 #include "reshade_api_object_impl.hpp"
 
+struct D3D12DescriptorHeap;
+
 namespace reshade::d3d12
 {
 	class device_impl;
@@ -70,13 +72,28 @@ namespace reshade::d3d12
 		void end_debug_event() final;
 		void insert_debug_marker(const char *label, const float color[4]) final;
 
+		// Opt in to accumulating barriers across 'barrier' calls, to be submitted as a single merged batch right before the next action command
+		// This is only safe on command lists whose entire command stream is recorded through this implementation, since commands recorded directly on the underlying command list would not see pending barriers
+		void set_barrier_batching(bool enable);
+		// Submits any barriers accumulated while barrier batching is enabled
+		void flush_barriers();
+
 	protected:
 		void on_init();
 
+		void submit_barriers(uint32_t count, const api::resource *resources, const api::resource_usage *old_states, const api::resource_usage *new_states);
+
 		device_impl *const _device_impl;
 		bool _has_commands = false;
+		bool _batch_barriers = false;
+
+		// Barriers accumulated while barrier batching is enabled, kept in the layout of the 'barrier' arguments for submission
+		std::vector<api::resource> _pending_barrier_resources;
+		std::vector<api::resource_usage> _pending_barrier_old_states;
+		std::vector<api::resource_usage> _pending_barrier_new_states;
 		bool _supports_ray_tracing = false;
 		bool _supports_render_passes = false;
+		bool _supports_enhanced_barriers = false;
 
 		// Currently bound root signature (graphics at index 0, compute at index 1)
 		ID3D12RootSignature *_current_root_signature[2] = {};
@@ -84,6 +101,8 @@ namespace reshade::d3d12
 		ID3D12DescriptorHeap *_current_descriptor_heaps[2] = {};
 #if RESHADE_ADDON >= 2
 		ID3D12DescriptorHeap *_previous_descriptor_heaps[2] = {};
+		// Caches the descriptor heap the last bound descriptor table resolved to, since nearly all applications bind tables from a single heap per frame
+		D3D12DescriptorHeap *_last_descriptor_heap = nullptr;
 #endif
 	};
 }
@@ -7,6 +7,11 @@
 #include "d3d12_impl_command_list_immediate.hpp"
 #include "d3d12_impl_type_convert.hpp"
 #include "dll_log.hpp" // Include late to get 'hr_to_string' helper function
+#include "trace_events.hpp"
+#include <algorithm> // std::remove_if
+
+// Upload buffers larger than this are released back to the system once the GPU has finished with them, instead of being kept around for reuse
+static constexpr UINT64 UPLOAD_BUFFER_RECYCLE_LIMIT = 16 * 1024 * 1024;
 
 thread_local reshade::d3d12::command_list_immediate_impl *reshade::d3d12::command_list_immediate_impl::s_last_immediate_command_list = nullptr;
 
@@ -14,15 +19,16 @@ reshade::d3d12::command_list_immediate_impl::command_list_immediate_impl(device_
 	command_list_impl(device, nullptr),
 	_parent_queue(queue)
 {
+	if (FAILED(_device_impl->_orig->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&_fence))))
+		return;
+
 	// Create multiple command allocators to buffer for multiple frames
 	for (uint32_t i = 0; i < NUM_COMMAND_FRAMES; ++i)
 	{
-		_fence_value[i] = i;
-
-		if (FAILED(_device_impl->_orig->CreateFence(_fence_value[i], D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&_fence[i]))))
-			return;
-		if (FAILED(_device_impl->_orig->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&_cmd_alloc[i]))))
+		com_ptr<ID3D12CommandAllocator> cmd_alloc;
+		if (FAILED(_device_impl->_orig->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&cmd_alloc))))
 			return;
+		_free_cmd_allocs.push_back(std::move(cmd_alloc));
 	}
 
 	// Create auto-reset event for synchronization
@@ -30,13 +36,19 @@ reshade::d3d12::command_list_immediate_impl::command_list_immediate_impl(device_
 	if (_fence_event == nullptr)
 		return;
 
+	_current_cmd_alloc = std::move(_free_cmd_allocs.back());
+	_free_cmd_allocs.pop_back();
+
 	// Create and open the command list for recording
-	if (SUCCEEDED(_device_impl->_orig->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, _cmd_alloc[_cmd_index].get(), nullptr, IID_PPV_ARGS(&_orig))))
+	if (SUCCEEDED(_device_impl->_orig->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, _current_cmd_alloc.get(), nullptr, IID_PPV_ARGS(&_orig))))
 	{
 		_orig->SetName(L"ReShade immediate command list");
 		on_init();
 	}
 
+	// The entire command stream of this command list is recorded through this implementation, so barriers can safely be accumulated and merged
+	set_barrier_batching(true);
+
 	s_last_immediate_command_list = this;
 }
 reshade::d3d12::command_list_immediate_impl::~command_list_immediate_impl()
@@ -44,6 +56,12 @@ reshade::d3d12::command_list_immediate_impl::~command_list_immediate_impl()
 	if (this == s_last_immediate_command_list)
 		s_last_immediate_command_list = nullptr;
 
+	// Make sure all outstanding submissions have finished executing before releasing the command allocators and upload buffers still referenced by them
+	if (_fence != nullptr && _fence_event != nullptr &&
+		_fence->GetCompletedValue() < _fence_value &&
+		SUCCEEDED(_fence->SetEventOnCompletion(_fence_value, _fence_event)))
+		WaitForSingleObject(_fence_event, INFINITE);
+
 	if (_orig != nullptr)
 		_orig->Release();
 	if (_fence_event != nullptr)
@@ -70,77 +88,193 @@ void reshade::d3d12::command_list_immediate_impl::end_query(api::query_heap heap
 	}
 }
 
-bool reshade::d3d12::command_list_immediate_impl::flush()
+com_ptr<ID3D12Resource> reshade::d3d12::command_list_immediate_impl::acquire_upload_buffer(UINT64 size)
+{
+	// Round the size up to the next power of two, so that buffers are more likely to be reusable for differently sized uploads
+	UINT64 capacity = 4096;
+	while (capacity < size)
+		capacity <<= 1;
+
+	// Prefer reusing an existing buffer whose last upload has already finished executing on the GPU
+	const UINT64 completed_value = _fence != nullptr ? _fence->GetCompletedValue() : 0;
+	for (upload_buffer &buffer : _upload_buffers)
+	{
+		if (buffer.capacity >= capacity && buffer.fence_value <= completed_value)
+		{
+			// Mark the buffer as in use until the next submission has finished executing
+			buffer.fence_value = _fence_value + 1;
+			return buffer.resource;
+		}
+	}
+
+	D3D12_RESOURCE_DESC intermediate_desc = { D3D12_RESOURCE_DIMENSION_BUFFER };
+	intermediate_desc.Width = capacity;
+	intermediate_desc.Height = 1;
+	intermediate_desc.DepthOrArraySize = 1;
+	intermediate_desc.MipLevels = 1;
+	intermediate_desc.SampleDesc = { 1, 0 };
+	intermediate_desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	const D3D12_HEAP_PROPERTIES upload_heap_props = { D3D12_HEAP_TYPE_UPLOAD };
+
+	com_ptr<ID3D12Resource> intermediate;
+	if (FAILED(_device_impl->_orig->CreateCommittedResource(&upload_heap_props, D3D12_HEAP_FLAG_NONE, &intermediate_desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&intermediate))))
+	{
+		log::message(log::level::error, "Failed to create upload buffer (width = %llu)!", intermediate_desc.Width);
+		return nullptr;
+	}
+	intermediate->SetName(L"ReShade upload buffer");
+
+	_upload_buffers.push_back({ intermediate, capacity, _fence_value + 1 });
+
+	return intermediate;
+}
+
+ID3D12CommandList *reshade::d3d12::command_list_immediate_impl::begin_flush(bool blocking)
 {
 	s_last_immediate_command_list = this;
 
 	if (!_has_commands)
-		return true;
+		return nullptr;
+
+	const trace::scoped_event trace_scope("flush_immediate_command_list");
+
+	assert(_orig != nullptr);
+
+	// Recycle command allocators whose submissions have finished executing on the GPU
+	const UINT64 completed_value = _fence->GetCompletedValue();
+	while (!_in_flight_frames.empty() && _in_flight_frames.front().fence_value <= completed_value)
+	{
+		// Keep the number of idle command allocators bounded, the pool only grows while submissions actually overlap
+		if (_free_cmd_allocs.size() < NUM_COMMAND_FRAMES)
+			_free_cmd_allocs.push_back(std::move(_in_flight_frames.front().cmd_alloc));
+		_in_flight_frames.erase(_in_flight_frames.begin());
+	}
+
+	// Release large upload buffers back to the system once their uploads have finished, only small ones are worth keeping around for reuse
+	_upload_buffers.erase(std::remove_if(_upload_buffers.begin(), _upload_buffers.end(),
+		[completed_value](const upload_buffer &buffer) { return buffer.fence_value <= completed_value && buffer.capacity > UPLOAD_BUFFER_RECYCLE_LIMIT; }), _upload_buffers.end());
+
+	// Acquire the command allocator for the next frame before submitting, so that a saturated ring can be detected without closing the command list
+	assert(_next_cmd_alloc == nullptr);
+	if (!_free_cmd_allocs.empty())
+	{
+		_next_cmd_alloc = std::move(_free_cmd_allocs.back());
+		_free_cmd_allocs.pop_back();
+	}
+	else if (_in_flight_frames.size() < MAX_COMMAND_FRAMES)
+	{
+		// Grow the pool instead of blocking on the oldest submission
+		if (FAILED(_device_impl->_orig->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&_next_cmd_alloc))))
+		{
+			log::message(log::level::error, "Failed to create immediate command allocator!");
+			return nullptr;
+		}
+	}
+	else if (blocking)
+	{
+		// The ring is saturated, so wait for the oldest submission to finish and reuse its command allocator
+		command_frame &frame = _in_flight_frames.front();
+		if (SUCCEEDED(_fence->SetEventOnCompletion(frame.fence_value, _fence_event)))
+			WaitForSingleObject(_fence_event, INFINITE); // Event is automatically reset after this wait is released
+		_next_cmd_alloc = std::move(frame.cmd_alloc);
+		_in_flight_frames.erase(_in_flight_frames.begin());
+	}
+	else
+	{
+		return nullptr; // Let the caller defer the submission instead of stalling
+	}
+
+	// Submit any barriers that are still pending before closing the command list, so that tracked resource states stay correct across submissions
+	flush_barriers();
+
 	_has_commands = false;
 
 	_current_root_signature[0] = nullptr;
 	_current_root_signature[1] = nullptr;
 	_current_descriptor_heaps[0] = nullptr;
 	_current_descriptor_heaps[1] = nullptr;
-
-	assert(_orig != nullptr);
+#if RESHADE_ADDON >= 2
+	_last_descriptor_heap = nullptr;
+#endif
 
 	if (const HRESULT hr = _orig->Close(); FAILED(hr))
 	{
 		log::message(log::level::error, "Failed to close immediate command list with error code %s!", reshade::log::hr_to_string(hr).c_str());
 
 		_current_query_fences.clear();
+		_free_cmd_allocs.push_back(std::move(_next_cmd_alloc));
 
 		// A command list that failed to close can never be reset, so destroy it and create a new one
 		_orig->Release(); _orig = nullptr;
-		if (SUCCEEDED(_device_impl->_orig->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, _cmd_alloc[_cmd_index].get(), nullptr, IID_PPV_ARGS(&_orig))))
+		if (SUCCEEDED(_device_impl->_orig->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, _current_cmd_alloc.get(), nullptr, IID_PPV_ARGS(&_orig))))
 		{
 			_orig->SetName(L"ReShade immediate command list");
 			on_init();
 		}
 
-		return false;
+		return nullptr;
 	}
 
-	_parent_queue->ExecuteCommandLists(1, reinterpret_cast<ID3D12CommandList *const *>(&_orig));
-
-	if (const UINT64 sync_value = _fence_value[_cmd_index] + NUM_COMMAND_FRAMES;
-		SUCCEEDED(_parent_queue->Signal(_fence[_cmd_index].get(), sync_value)))
-		_fence_value[_cmd_index] = sync_value;
+	return _orig;
+}
+bool reshade::d3d12::command_list_immediate_impl::end_flush()
+{
+	if (SUCCEEDED(_parent_queue->Signal(_fence.get(), _fence_value + 1)))
+		_fence_value++;
 
 	// Signal all the fences associated with queries that ran with this command list
 	for (const std::pair<ID3D12Fence *, UINT64> &fence : _current_query_fences)
 		_parent_queue->Signal(fence.first, fence.second);
 	_current_query_fences.clear();
 
-	// Continue with next command list now that the current one was submitted
-	_cmd_index = (_cmd_index + 1) % NUM_COMMAND_FRAMES;
+	// The submitted command allocator can be reset and reused once the fence value just signaled has passed
+	_in_flight_frames.push_back({ std::move(_current_cmd_alloc), _fence_value });
+
+	// Continue with the next command allocator now that the current one was submitted
+	_current_cmd_alloc = std::move(_next_cmd_alloc);
+	_current_cmd_alloc->Reset();
 
-	// Make sure all commands for the next command allocator have finished executing before reseting it
-	if (_fence[_cmd_index]->GetCompletedValue() < _fence_value[_cmd_index])
+	// Reset command list using the new command allocator and put it into the recording state
+	return SUCCEEDED(_orig->Reset(_current_cmd_alloc.get(), nullptr));
+}
+
+bool reshade::d3d12::command_list_immediate_impl::flush(bool blocking)
+{
+	if (!_has_commands)
 	{
-		if (SUCCEEDED(_fence[_cmd_index]->SetEventOnCompletion(_fence_value[_cmd_index], _fence_event)))
-			WaitForSingleObject(_fence_event, INFINITE); // Event is automatically reset after this wait is released
+		s_last_immediate_command_list = this;
+		return true;
 	}
 
-	// Reset command allocator before using it this frame again
-	_cmd_alloc[_cmd_index]->Reset();
+	ID3D12CommandList *const cmd_list = begin_flush(blocking);
+	if (cmd_list == nullptr)
+		return false;
 
-	// Reset command list using current command allocator and put it into the recording state
-	return SUCCEEDED(_orig->Reset(_cmd_alloc[_cmd_index].get(), nullptr));
+	_parent_queue->ExecuteCommandLists(1, &cmd_list);
+
+	return end_flush();
+}
+bool reshade::d3d12::command_list_immediate_impl::flush()
+{
+	return flush(true);
+}
+bool reshade::d3d12::command_list_immediate_impl::try_flush()
+{
+	return flush(false);
 }
 bool reshade::d3d12::command_list_immediate_impl::flush_and_wait()
 {
 	if (!_has_commands)
 		return true;
 
-	// Index is updated during flush below, so keep track of the current one to wait on
-	const UINT cmd_index_to_wait_on = _cmd_index;
-
-	if (!flush())
+	if (!flush(true))
 		return false;
 
-	if (FAILED(_fence[cmd_index_to_wait_on]->SetEventOnCompletion(_fence_value[cmd_index_to_wait_on], _fence_event)))
+	// Wait for the submission that was just signaled above
+	if (_fence->GetCompletedValue() >= _fence_value)
+		return true;
+	if (FAILED(_fence->SetEventOnCompletion(_fence_value, _fence_event)))
 		return false;
 	return WaitForSingleObject(_fence_event, INFINITE) == WAIT_OBJECT_0;
 }
@@ -11,7 +11,8 @@ namespace reshade::d3d12
 {
 	class command_list_immediate_impl : public command_list_impl
 	{
-		static constexpr uint32_t NUM_COMMAND_FRAMES = 4; // Use power of two so that modulo can be replaced with bitwise operation
+		static constexpr uint32_t NUM_COMMAND_FRAMES = 4; // Number of command allocators to create upfront
+		static constexpr uint32_t MAX_COMMAND_FRAMES = 32; // Upper bound on in-flight command allocators before flushes start blocking on the oldest submission
 
 	public:
 		static thread_local command_list_immediate_impl *s_last_immediate_command_list;
@@ -22,15 +23,46 @@ namespace reshade::d3d12
 		void end_query(api::query_heap heap, api::query_type type, uint32_t index) final;
 
 		bool flush();
+		// Variant of 'flush' that fails instead of blocking when the ring of in-flight command allocators is saturated, so that callers able to defer the submission can do so
+		bool try_flush();
 		bool flush_and_wait();
 
+		// Closes the command list and hands it to the caller for submission, so that it can be batched into an application 'ExecuteCommandLists' call (see 'D3D12CommandQueue::ExecuteCommandLists')
+		// Returns 'nullptr' when there are no commands to submit or closing failed, in which case no submission should take place
+		ID3D12CommandList *begin_flush(bool blocking);
+		// Signals the fences for the previous 'begin_flush' and puts the command list back into the recording state, which must only happen after it was submitted to the parent queue
+		bool end_flush();
+
+		// Returns an upload buffer of at least 'size' bytes, which is recycled once the GPU has finished executing the commands currently being recorded
+		com_ptr<ID3D12Resource> acquire_upload_buffer(UINT64 size);
+
 	private:
+		bool flush(bool blocking);
+
+		// Command allocator that was submitted and can be reset once the associated fence value has passed
+		struct command_frame
+		{
+			com_ptr<ID3D12CommandAllocator> cmd_alloc;
+			UINT64 fence_value = 0;
+		};
+
+		struct upload_buffer
+		{
+			com_ptr<ID3D12Resource> resource;
+			UINT64 capacity = 0;
+			UINT64 fence_value = 0;
+		};
+
 		ID3D12CommandQueue *const _parent_queue;
-		UINT32 _cmd_index = 0;
 		HANDLE _fence_event = nullptr;
-		UINT64 _fence_value[NUM_COMMAND_FRAMES] = {};
-		com_ptr<ID3D12Fence> _fence[NUM_COMMAND_FRAMES];
-		com_ptr<ID3D12CommandAllocator> _cmd_alloc[NUM_COMMAND_FRAMES];
+		com_ptr<ID3D12Fence> _fence;
+		UINT64 _fence_value = 0; // Value last signaled on the parent queue
+		com_ptr<ID3D12CommandAllocator> _current_cmd_alloc;
+		// Command allocator already acquired for the next frame while a flush is in progress (between 'begin_flush' and 'end_flush')
+		com_ptr<ID3D12CommandAllocator> _next_cmd_alloc;
+		std::vector<command_frame> _in_flight_frames;
+		std::vector<com_ptr<ID3D12CommandAllocator>> _free_cmd_allocs;
+		std::vector<upload_buffer> _upload_buffers;
 
 		// List of query fences scheduled for signaling during next flush
 		std::vector<std::pair<ID3D12Fence *, UINT64>> _current_query_fences;
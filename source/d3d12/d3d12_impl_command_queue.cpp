@@ -93,6 +93,16 @@ void reshade::d3d12::command_queue_impl::flush_immediate_command_list() const
 		_immediate_cmd_list->flush();
 }
 
+ID3D12CommandList *reshade::d3d12::command_queue_impl::begin_immediate_command_list_flush()
+{
+	return _immediate_cmd_list != nullptr ? _immediate_cmd_list->begin_flush(true) : nullptr;
+}
+void reshade::d3d12::command_queue_impl::end_immediate_command_list_flush()
+{
+	assert(_immediate_cmd_list != nullptr);
+	_immediate_cmd_list->end_flush();
+}
+
 void reshade::d3d12::command_queue_impl::begin_debug_event(const char *label, const float color[4])
 {
 	assert(label != nullptr);
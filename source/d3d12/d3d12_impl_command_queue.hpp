@@ -24,6 +24,10 @@ namespace reshade::d3d12
 
 		void flush_immediate_command_list() const final;
 
+		// Variants of 'flush_immediate_command_list' used by 'D3D12CommandQueue::ExecuteCommandLists' to batch pending runtime commands into the same submission as the application command lists
+		ID3D12CommandList *begin_immediate_command_list_flush();
+		void end_immediate_command_list_flush();
+
 		api::command_list *get_immediate_command_list() final { return _immediate_cmd_list; }
 
 		void begin_debug_event(const char *label, const float color[4]) final;
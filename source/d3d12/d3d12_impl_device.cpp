@@ -10,14 +10,26 @@
 #include "d3d12_resource_call_vtable.inl"
 #include "dll_log.hpp"
 #include "dll_resources.hpp"
-#include <cwchar> // std::wcslen
+#include "ini_file.hpp" // global_config, g_reshade_base_path
+#include <cwchar> // std::swprintf, std::wcslen
 #include <cstring> // std::memcmp, std::memcpy, std::strlen
 #include <algorithm> // std::copy_n, std::find, std::find_if, std::max, std::min
+#include <string_view>
 #include <utf8/unchecked.h>
 #include <dxgi1_4.h>
 
 extern bool is_windows7();
 
+// Call 'ID3D12PipelineLibrary' methods through their virtual function table, to bypass any hooks installed on it (see 'd3d12_pipeline_library.cpp'), so that internal pipeline loads do not trigger add-on events
+#define ID3D12PipelineLibrary_LoadGraphicsPipeline_Internal reshade::hooks::call_vtable<9, HRESULT, ID3D12PipelineLibrary1, LPCWSTR, const D3D12_GRAPHICS_PIPELINE_STATE_DESC *, REFIID, void **>
+#define ID3D12PipelineLibrary_LoadComputePipeline_Internal reshade::hooks::call_vtable<10, HRESULT, ID3D12PipelineLibrary1, LPCWSTR, const D3D12_COMPUTE_PIPELINE_STATE_DESC *, REFIID, void **>
+
+static size_t hash_pipeline_state(size_t seed, const void *data, size_t size)
+{
+	// This matches the non-cryptographic hashing the effect cache already relies on for stable identifiers across runs
+	return seed ^ (std::hash<std::string_view>()(std::string_view(static_cast<const char *>(data), size)) + 0x9E3779B9 + (seed << 6) + (seed >> 2));
+}
+
 #ifdef _WIN64
 constexpr size_t heap_index_start = 28;
 #else
@@ -38,10 +50,21 @@ reshade::d3d12::device_impl::device_impl(ID3D12Device *device) :
 	for (UINT type = 0; type < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++type)
 		_descriptor_handle_size[type] = device->GetDescriptorHandleIncrementSize(static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(type));
 
+	if (D3D12_FEATURE_DATA_D3D12_OPTIONS12 options;
+		SUCCEEDED(device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS12, &options, sizeof(options))))
+		_supports_enhanced_barriers = options.EnhancedBarriersSupported != FALSE;
+
+	if (D3D12_FEATURE_DATA_D3D12_OPTIONS16 options;
+		SUCCEEDED(device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS16, &options, sizeof(options))))
+		_supports_gpu_upload_heap = options.GPUUploadHeapSupported != FALSE;
+
 #if RESHADE_ADDON >= 2
 	// Make some space in the descriptor heap array, so that it is unlikely to need reallocation
 	_descriptor_heaps.reserve(4096);
 
+	// Second-level tables are allocated on demand, the directory itself is zero-initialized
+	_descriptor_heap_page_dir = std::make_unique<std::atomic<descriptor_heap_page_table *>[]>(descriptor_heap_dir_size);
+
 	const auto gpu_view_heap = new D3D12DescriptorHeap(device, _gpu_view_heap.get());
 	register_descriptor_heap(gpu_view_heap);
 	const auto gpu_sampler_heap = new D3D12DescriptorHeap(device, _gpu_sampler_heap.get());
@@ -84,7 +107,103 @@ reshade::d3d12::device_impl::~device_impl()
 	delete gpu_sampler_heap;
 
 	assert(_descriptor_heaps.empty());
+
+	for (uint64_t i = 0; i < descriptor_heap_dir_size; ++i)
+		delete _descriptor_heap_page_dir[i].load(std::memory_order_relaxed);
 #endif
+
+	// The cache kept the cached root signatures alive past 'destroy_pipeline_layout', so free the descriptor range data attached to those it holds the last reference to
+	for (const auto &[layout_hash, signature] : _root_signature_cache)
+	{
+		pipeline_layout_extra_data extra_data;
+		UINT extra_data_size = sizeof(extra_data);
+		if (signature.ref_count() == 1 && SUCCEEDED(signature->GetPrivateData(extra_data_guid, &extra_data_size, &extra_data)))
+		{
+			delete[] extra_data.ranges;
+		}
+	}
+
+	// Serialize the pipeline library back to disk if any new pipelines were stored in it this run
+	if (_pipeline_library != nullptr && _pipeline_library_modified)
+	{
+		std::vector<uint8_t> data(_pipeline_library->GetSerializedSize());
+		if (SUCCEEDED(_pipeline_library->Serialize(data.data(), data.size())))
+		{
+			const HANDLE file = CreateFileW(_pipeline_library_path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file != INVALID_HANDLE_VALUE)
+			{
+				DWORD size_written = 0;
+				if (!WriteFile(file, data.data(), static_cast<DWORD>(data.size()), &size_written, nullptr) || size_written != data.size())
+					log::message(log::level::warning, "Failed to write pipeline library file '%s'!", _pipeline_library_path.u8string().c_str());
+				CloseHandle(file);
+			}
+		}
+	}
+}
+
+ID3D12PipelineLibrary1 *reshade::d3d12::device_impl::open_pipeline_library()
+{
+	if (_pipeline_library_opened)
+		return _pipeline_library.get();
+	_pipeline_library_opened = true;
+
+	com_ptr<ID3D12Device1> device1;
+	if (FAILED(_orig->QueryInterface(&device1)))
+		return nullptr;
+
+	// Mirror the intermediate cache path resolution in 'runtime::load_config', so that the serialized library ends up next to the effect cache
+	std::error_code ec;
+	std::filesystem::path cache_path;
+	global_config().get("GENERAL", "IntermediateCachePath", cache_path);
+	if (!cache_path.empty() && cache_path.is_relative())
+		cache_path = g_reshade_base_path / cache_path;
+	if (cache_path.empty() || !std::filesystem::is_directory(cache_path, ec))
+		cache_path = std::filesystem::temp_directory_path(ec) / "ReShade";
+
+	// The library contents are adapter and driver specific, so keep a separate file per adapter (mismatches are detected below, but this avoids constant invalidation on multi-GPU systems)
+	const LUID adapter_luid = _orig->GetAdapterLuid();
+	WCHAR file_name[64] = L"";
+	std::swprintf(file_name, std::size(file_name), L"reshade-pipelines-%08X%08X.bin", static_cast<UINT>(adapter_luid.HighPart), adapter_luid.LowPart);
+	_pipeline_library_path = cache_path / file_name;
+
+	if (const HANDLE file = CreateFileW(_pipeline_library_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		file != INVALID_HANDLE_VALUE)
+	{
+		LARGE_INTEGER file_size = {};
+		GetFileSizeEx(file, &file_size);
+		_pipeline_library_data.resize(static_cast<size_t>(file_size.QuadPart));
+		DWORD size_read = 0;
+		if (!ReadFile(file, _pipeline_library_data.data(), static_cast<DWORD>(_pipeline_library_data.size()), &size_read, nullptr) || size_read != _pipeline_library_data.size())
+			_pipeline_library_data.clear();
+		CloseHandle(file);
+	}
+
+	// The serialized blob has to stay valid for the lifetime of the library, hence it being kept in '_pipeline_library_data'
+	HRESULT hr = device1->CreatePipelineLibrary(_pipeline_library_data.data(), _pipeline_library_data.size(), IID_PPV_ARGS(&_pipeline_library));
+	if (hr == D3D12_ERROR_DRIVER_VERSION_MISMATCH || hr == D3D12_ERROR_ADAPTER_NOT_FOUND || hr == E_INVALIDARG)
+	{
+		// The existing file was created by a different driver version or is corrupted, so start over with an empty library
+		_pipeline_library_data.clear();
+		hr = device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&_pipeline_library));
+	}
+	if (FAILED(hr))
+	{
+		log::message(log::level::warning, "Failed to create pipeline library with error code %s.", log::hr_to_string(hr).c_str());
+		return nullptr;
+	}
+
+	return _pipeline_library.get();
+}
+void reshade::d3d12::device_impl::store_pipeline_in_library(LPCWSTR name, ID3D12PipelineState *pipeline)
+{
+	const std::unique_lock<std::mutex> lock(_pipeline_library_mutex);
+
+	if (_pipeline_library == nullptr)
+		return;
+
+	// Failure is non-fatal and usually means a pipeline with this name already exists in the library, in which case this pipeline is simply not cached
+	if (SUCCEEDED(_pipeline_library->StorePipeline(name, pipeline)))
+		_pipeline_library_modified = true;
 }
 
 static const com_ptr<IDXGIAdapter> get_adapter_for_device(ID3D12Device *device, DXGI_ADAPTER_DESC &adapter_desc)
@@ -241,6 +360,8 @@ bool reshade::d3d12::device_impl::check_capability(api::device_caps capability)
 			SUCCEEDED(_orig->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS5, &options, sizeof(options))))
 			return options.RaytracingTier != D3D12_RAYTRACING_TIER_NOT_SUPPORTED;
 		return false;
+	case api::device_caps::partial_constant_buffer_updates:
+		return true;
 	default:
 		return false;
 	}
@@ -325,6 +446,11 @@ bool reshade::d3d12::device_impl::create_resource(const api::resource_desc &desc
 	D3D12_HEAP_PROPERTIES heap_props = {};
 	convert_resource_desc(desc, internal_desc, heap_props, heap_flags);
 
+	// Place CPU-to-GPU memory in the GPU upload heap when supported (requires resizable BAR), so that per-frame-written data like the effect uniform buffers is read from GPU-local memory instead of across the PCIe bus
+	// CPU-only memory stays in the regular upload heap, since it is meant for data read back by the CPU
+	if (heap_props.Type == D3D12_HEAP_TYPE_UPLOAD && desc.heap == api::memory_heap::cpu_to_gpu && _supports_gpu_upload_heap)
+		heap_props.Type = D3D12_HEAP_TYPE_GPU_UPLOAD;
+
 	D3D12_SUBRESOURCE_FOOTPRINT footprint = {};
 
 	if (desc.type == api::resource_type::buffer)
@@ -696,24 +822,10 @@ void reshade::d3d12::device_impl::update_buffer_region(const void *data, api::re
 	if (immediate_command_list == nullptr)
 		return; // No point in creating upload buffer when it cannot be uploaded
 
-	// Allocate host memory for upload
-	D3D12_RESOURCE_DESC intermediate_desc = { D3D12_RESOURCE_DIMENSION_BUFFER };
-	intermediate_desc.Width = size;
-	intermediate_desc.Height = 1;
-	intermediate_desc.DepthOrArraySize = 1;
-	intermediate_desc.MipLevels = 1;
-	intermediate_desc.SampleDesc = { 1, 0 };
-	intermediate_desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-
-	const D3D12_HEAP_PROPERTIES upload_heap_props = { D3D12_HEAP_TYPE_UPLOAD };
-
-	com_ptr<ID3D12Resource> intermediate;
-	if (FAILED(_orig->CreateCommittedResource(&upload_heap_props, D3D12_HEAP_FLAG_NONE, &intermediate_desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&intermediate))))
-	{
-		log::message(log::level::error, "Failed to create upload buffer (width = %llu)!", intermediate_desc.Width);
+	// Allocate host memory for upload (this is recycled by the immediate command list once the copy below has finished executing)
+	const com_ptr<ID3D12Resource> intermediate = immediate_command_list->acquire_upload_buffer(size);
+	if (intermediate == nullptr)
 		return;
-	}
-	intermediate->SetName(L"ReShade upload buffer");
 
 	// Fill upload buffer with pixel data
 	uint8_t *mapped_data;
@@ -727,8 +839,9 @@ void reshade::d3d12::device_impl::update_buffer_region(const void *data, api::re
 	// Copy data from upload buffer into target texture using the first available immediate command list
 	immediate_command_list->copy_buffer_region(api::resource { reinterpret_cast<uintptr_t>(intermediate.get()) }, 0, resource, offset, size);
 
-	// Wait for command to finish executing before destroying the upload buffer
-	immediate_command_list->flush_and_wait();
+	// There is no need to wait for the copy to finish, since the upload buffer stays alive until it did
+	// Submission can even be deferred when the ring is saturated, because 'ID3D12CommandQueue::ExecuteCommandLists' flushes the immediate command list before any application submissions on this queue
+	immediate_command_list->try_flush();
 }
 void reshade::d3d12::device_impl::update_texture_region(const api::subresource_data &data, api::resource resource, uint32_t subresource, const api::subresource_box *box)
 {
@@ -769,24 +882,10 @@ void reshade::d3d12::device_impl::update_texture_region(const api::subresource_d
 	const auto slice_pitch = api::format_slice_pitch(convert_format(desc.Format), row_pitch, num_rows);
 	num_rows = slice_pitch / row_pitch;
 
-	// Allocate host memory for upload
-	D3D12_RESOURCE_DESC intermediate_desc = { D3D12_RESOURCE_DIMENSION_BUFFER };
-	intermediate_desc.Width = static_cast<UINT64>(num_slices) * static_cast<UINT64>(slice_pitch);
-	intermediate_desc.Height = 1;
-	intermediate_desc.DepthOrArraySize = 1;
-	intermediate_desc.MipLevels = 1;
-	intermediate_desc.SampleDesc = { 1, 0 };
-	intermediate_desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-
-	const D3D12_HEAP_PROPERTIES upload_heap_props = { D3D12_HEAP_TYPE_UPLOAD };
-
-	com_ptr<ID3D12Resource> intermediate;
-	if (FAILED(_orig->CreateCommittedResource(&upload_heap_props, D3D12_HEAP_FLAG_NONE, &intermediate_desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&intermediate))))
-	{
-		log::message(log::level::error, "Failed to create upload buffer (width = %llu)!", intermediate_desc.Width);
+	// Allocate host memory for upload (this is recycled by the immediate command list once the copy below has finished executing)
+	const com_ptr<ID3D12Resource> intermediate = immediate_command_list->acquire_upload_buffer(static_cast<UINT64>(num_slices) * static_cast<UINT64>(slice_pitch));
+	if (intermediate == nullptr)
 		return;
-	}
-	intermediate->SetName(L"ReShade upload buffer");
 
 	// Fill upload buffer with pixel data
 	uint8_t *mapped_data;
@@ -813,8 +912,9 @@ void reshade::d3d12::device_impl::update_texture_region(const api::subresource_d
 	// Copy data from upload buffer into target texture using the first available immediate command list
 	immediate_command_list->copy_buffer_to_texture(api::resource { reinterpret_cast<uintptr_t>(intermediate.get()) }, 0, 0, 0, resource, subresource, box);
 
-	// Wait for command to finish executing before destroying the upload buffer
-	immediate_command_list->flush_and_wait();
+	// There is no need to wait for the copy to finish, since the upload buffer stays alive until it did
+	// Submission can even be deferred when the ring is saturated, because 'ID3D12CommandQueue::ExecuteCommandLists' flushes the immediate command list before any application submissions on this queue
+	immediate_command_list->try_flush();
 }
 
 bool reshade::d3d12::device_impl::create_pipeline(api::pipeline_layout layout, uint32_t subobject_count, const api::pipeline_subobject *subobjects, api::pipeline *out_pipeline)
@@ -1186,9 +1286,31 @@ bool reshade::d3d12::device_impl::create_pipeline(api::pipeline_layout layout, u
 		internal_desc.pRootSignature = reinterpret_cast<ID3D12RootSignature *>(layout.handle);
 		convert_shader_desc(cs_desc, internal_desc.CS);
 
+		WCHAR library_entry_name[20] = L"";
+		{
+			const std::unique_lock<std::mutex> lock(_pipeline_library_mutex);
+
+			if (ID3D12PipelineLibrary1 *const library = open_pipeline_library())
+			{
+				const size_t entry_hash = hash_pipeline_state(0, cs_desc.code, cs_desc.code_size);
+				std::swprintf(library_entry_name, std::size(library_entry_name), L"C%zX", entry_hash);
+
+				// A mismatching description under the same name simply fails the load here and the pipeline is created normally below
+				if (com_ptr<ID3D12PipelineState> pipeline;
+					SUCCEEDED(ID3D12PipelineLibrary_LoadComputePipeline_Internal(library, library_entry_name, &internal_desc, IID_PPV_ARGS(&pipeline))))
+				{
+					*out_pipeline = to_handle(pipeline.release());
+					return true;
+				}
+			}
+		}
+
 		if (com_ptr<ID3D12PipelineState> pipeline;
 			SUCCEEDED(_orig->CreateComputePipelineState(&internal_desc, IID_PPV_ARGS(&pipeline))))
 		{
+			if (library_entry_name[0] != L'\0')
+				store_pipeline_in_library(library_entry_name, pipeline.get());
+
 			*out_pipeline = to_handle(pipeline.release());
 			return true;
 		}
@@ -1287,9 +1409,53 @@ bool reshade::d3d12::device_impl::create_pipeline(api::pipeline_layout layout, u
 
 		internal_desc.SampleDesc.Count = sample_count;
 
+		WCHAR library_entry_name[20] = L"";
+		// The input layout is referenced by pointer and therefore cannot be hashed into a stable entry name, so skip the pipeline library for pipelines that use one (effect pipelines do not)
+		if (input_layout_desc.count == 0)
+		{
+			const std::unique_lock<std::mutex> lock(_pipeline_library_mutex);
+
+			if (ID3D12PipelineLibrary1 *const library = open_pipeline_library())
+			{
+				size_t entry_hash = hash_pipeline_state(0, &stream_output_desc, sizeof(stream_output_desc));
+				entry_hash = hash_pipeline_state(entry_hash, &blend_desc, sizeof(blend_desc));
+				entry_hash = hash_pipeline_state(entry_hash, &rasterizer_desc, sizeof(rasterizer_desc));
+				entry_hash = hash_pipeline_state(entry_hash, &depth_stencil_desc, sizeof(depth_stencil_desc));
+				entry_hash = hash_pipeline_state(entry_hash, &topology, sizeof(topology));
+				entry_hash = hash_pipeline_state(entry_hash, &depth_stencil_format, sizeof(depth_stencil_format));
+				if (render_target_formats.count != 0)
+					entry_hash = hash_pipeline_state(entry_hash, render_target_formats.data, render_target_formats.count * sizeof(api::format));
+				entry_hash = hash_pipeline_state(entry_hash, &sample_mask, sizeof(sample_mask));
+				entry_hash = hash_pipeline_state(entry_hash, &sample_count, sizeof(sample_count));
+				for (const api::shader_desc *shader_desc : { &vs_desc, &hs_desc, &ds_desc, &gs_desc, &ps_desc })
+					if (shader_desc->code_size != 0)
+						entry_hash = hash_pipeline_state(entry_hash, shader_desc->code, shader_desc->code_size);
+
+				std::swprintf(library_entry_name, std::size(library_entry_name), L"G%zX", entry_hash);
+
+				// A mismatching description under the same name simply fails the load here and the pipeline is created normally below
+				if (com_ptr<ID3D12PipelineState> pipeline;
+					SUCCEEDED(ID3D12PipelineLibrary_LoadGraphicsPipeline_Internal(library, library_entry_name, &internal_desc, IID_PPV_ARGS(&pipeline))))
+				{
+					pipeline_extra_data extra_data;
+					extra_data.topology = convert_primitive_topology(topology);
+
+					std::copy_n(blend_desc.blend_constant, 4, extra_data.blend_constant);
+
+					pipeline->SetPrivateData(extra_data_guid, sizeof(extra_data), &extra_data);
+
+					*out_pipeline = to_handle(pipeline.release());
+					return true;
+				}
+			}
+		}
+
 		if (com_ptr<ID3D12PipelineState> pipeline;
 			SUCCEEDED(_orig->CreateGraphicsPipelineState(&internal_desc, IID_PPV_ARGS(&pipeline))))
 		{
+			if (library_entry_name[0] != L'\0')
+				store_pipeline_in_library(library_entry_name, pipeline.get());
+
 			pipeline_extra_data extra_data;
 			extra_data.topology = convert_primitive_topology(topology);
 
@@ -1467,43 +1633,71 @@ bool reshade::d3d12::device_impl::create_pipeline_layout(uint32_t param_count, c
 		options.second.ResourceBindingTier >= D3D12_RESOURCE_BINDING_TIER_3)
 		internal_desc.Flags |= D3D12_ROOT_SIGNATURE_FLAG_CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED | D3D12_ROOT_SIGNATURE_FLAG_SAMPLER_HEAP_DIRECTLY_INDEXED;
 
-	com_ptr<ID3DBlob> signature_blob, error_blob;
-	com_ptr<ID3D12RootSignature> signature;
-	if (SUCCEEDED(D3D12SerializeRootSignature(&internal_desc, D3D_ROOT_SIGNATURE_VERSION_1, &signature_blob, &error_blob)) &&
-		SUCCEEDED(_orig->CreateRootSignature(0, signature_blob->GetBufferPointer(), signature_blob->GetBufferSize(), IID_PPV_ARGS(&signature))))
+	// Hash the description to look up an existing root signature with the same shape, rather than serializing and creating a new one every time (pipeline layouts created for ReShade FX effects are all identical)
+	size_t layout_hash = hash_pipeline_state(0, &internal_desc.Flags, sizeof(internal_desc.Flags));
+	for (const D3D12_ROOT_PARAMETER &internal_param : internal_params)
 	{
-		pipeline_layout_extra_data extra_data;
-		extra_data.ranges = set_ranges;
-		UINT extra_data_size = sizeof(extra_data);
+		layout_hash = hash_pipeline_state(layout_hash, &internal_param.ParameterType, sizeof(internal_param.ParameterType));
+		layout_hash = hash_pipeline_state(layout_hash, &internal_param.ShaderVisibility, sizeof(internal_param.ShaderVisibility));
 
-		// D3D12 runtime returns the same root signature object for identical input blobs, just with the reference count increased
-		// Do not overwrite the existing attached extra data in this case
-		if (signature.ref_count() == 1 || FAILED(signature->GetPrivateData(extra_data_guid, &extra_data_size, &extra_data)))
-		{
-			signature->SetPrivateData(extra_data_guid, sizeof(extra_data), &extra_data);
-		}
+		// Hash the descriptor range data rather than the parameter body, since the parameter merely holds a pointer to it
+		if (internal_param.ParameterType == D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE)
+			layout_hash = hash_pipeline_state(layout_hash, internal_param.DescriptorTable.pDescriptorRanges, internal_param.DescriptorTable.NumDescriptorRanges * sizeof(D3D12_DESCRIPTOR_RANGE));
 		else
+			layout_hash = hash_pipeline_state(layout_hash, &internal_param.Constants, sizeof(internal_param.Constants));
+	}
+	if (!internal_static_samplers.empty())
+		layout_hash = hash_pipeline_state(layout_hash, internal_static_samplers.data(), internal_static_samplers.size() * sizeof(D3D12_STATIC_SAMPLER_DESC));
+
+	com_ptr<ID3D12RootSignature> signature;
+
+	{	const std::unique_lock<std::mutex> lock(_root_signature_cache_mutex);
+
+		if (const auto it = _root_signature_cache.find(layout_hash);
+			it != _root_signature_cache.end())
+			signature = it->second;
+	}
+
+	if (signature == nullptr)
+	{
+		com_ptr<ID3DBlob> signature_blob, error_blob;
+		if (FAILED(D3D12SerializeRootSignature(&internal_desc, D3D_ROOT_SIGNATURE_VERSION_1, &signature_blob, &error_blob)) ||
+			FAILED(_orig->CreateRootSignature(0, signature_blob->GetBufferPointer(), signature_blob->GetBufferSize(), IID_PPV_ARGS(&signature))))
 		{
-#ifndef NDEBUG
-			for (uint32_t i = 0; i < param_count; ++i)
-				assert(extra_data.ranges[i] == set_ranges[i]);
-#endif
+			if (error_blob != nullptr)
+				log::message(log::level::error, "Failed to create root signature: %s", static_cast<const char *>(error_blob->GetBufferPointer()));
+
 			delete[] set_ranges;
+
+			*out_layout = { 0 };
+			return false;
 		}
 
-		*out_layout = to_handle(signature.release());
-		return true;
+		const std::unique_lock<std::mutex> lock(_root_signature_cache_mutex);
+		_root_signature_cache.emplace(layout_hash, signature);
+	}
+
+	pipeline_layout_extra_data extra_data;
+	extra_data.ranges = set_ranges;
+	UINT extra_data_size = sizeof(extra_data);
+
+	// The root signature may already have extra data attached, either because it came out of the cache above, or because the D3D12 runtime returned an existing root signature object for an identical input blob
+	// Do not overwrite the existing attached extra data in this case
+	if (FAILED(signature->GetPrivateData(extra_data_guid, &extra_data_size, &extra_data)))
+	{
+		signature->SetPrivateData(extra_data_guid, sizeof(extra_data), &extra_data);
 	}
 	else
 	{
-		if (error_blob != nullptr)
-			log::message(log::level::error, "Failed to create root signature: %s", static_cast<const char *>(error_blob->GetBufferPointer()));
-
+#ifndef NDEBUG
+		for (uint32_t i = 0; i < param_count; ++i)
+			assert(extra_data.ranges[i] == set_ranges[i]);
+#endif
 		delete[] set_ranges;
-
-		*out_layout = { 0 };
-		return false;
 	}
+
+	*out_layout = to_handle(signature.release());
+	return true;
 }
 void reshade::d3d12::device_impl::destroy_pipeline_layout(api::pipeline_layout layout)
 {
@@ -1603,19 +1797,12 @@ void reshade::d3d12::device_impl::get_descriptor_heap_offset(api::descriptor_tab
 	const D3D12_GPU_DESCRIPTOR_HANDLE handle_gpu = { table.handle };
 
 #if RESHADE_ADDON >= 2
-	for (D3D12DescriptorHeap *const heap_impl : _descriptor_heaps)
+	if (D3D12DescriptorHeap *const heap_impl = find_descriptor_heap(handle_gpu))
 	{
-		if (heap_impl == nullptr || handle_gpu.ptr < heap_impl->_orig_base_gpu_handle.ptr)
-			continue;
-
-		D3D12_DESCRIPTOR_HEAP_DESC desc = heap_impl->_orig->GetDesc();
-		if (handle_gpu.ptr >= offset_descriptor_handle(heap_impl->_orig_base_gpu_handle, desc.NumDescriptors, desc.Type).ptr)
-			continue;
-
 		*heap = to_handle(heap_impl->_orig);
 
 		if (offset != nullptr)
-			*offset = static_cast<uint32_t>((handle_gpu.ptr - heap_impl->_orig_base_gpu_handle.ptr) / _descriptor_handle_size[desc.Type]) + binding;
+			*offset = static_cast<uint32_t>((handle_gpu.ptr - heap_impl->_orig_base_gpu_handle.ptr) / _descriptor_handle_size[heap_impl->_orig_heap_type]) + binding;
 		return;
 	}
 #else
@@ -2144,9 +2331,48 @@ void reshade::d3d12::device_impl::register_descriptor_heap(D3D12DescriptorHeap *
 	const auto it = _descriptor_heaps.push_back(heap);
 
 	heap->initialize_descriptor_base_handle(std::distance(_descriptor_heaps.begin(), it));
+
+	// Insert the heap into the page table, so that GPU descriptor handles can be resolved back to it in constant time (see 'find_descriptor_heap')
+	if (heap->_orig_base_gpu_handle.ptr != 0)
+	{
+		const uint64_t first_page = heap->_orig_base_gpu_handle.ptr >> descriptor_heap_page_shift;
+		const uint64_t last_page = (heap->_orig_base_gpu_handle.ptr + heap->_orig_gpu_handle_range - 1) >> descriptor_heap_page_shift;
+
+		for (uint64_t page = first_page; page <= last_page; ++page)
+		{
+			std::atomic<descriptor_heap_page_table *> &dir_entry = _descriptor_heap_page_dir[(page >> descriptor_heap_table_shift) & (descriptor_heap_dir_size - 1)];
+			descriptor_heap_page_table *table = dir_entry.load(std::memory_order_acquire);
+			if (table == nullptr)
+			{
+				const auto new_table = new descriptor_heap_page_table();
+				if (dir_entry.compare_exchange_strong(table, new_table, std::memory_order_acq_rel))
+					table = new_table;
+				else
+					delete new_table; // Another thread allocated this table concurrently
+			}
+
+			table->pages[page & ((1ull << descriptor_heap_table_shift) - 1)].store(heap, std::memory_order_release);
+		}
+	}
 }
 void reshade::d3d12::device_impl::unregister_descriptor_heap(D3D12DescriptorHeap *heap)
 {
+	if (heap->_orig_base_gpu_handle.ptr != 0)
+	{
+		const uint64_t first_page = heap->_orig_base_gpu_handle.ptr >> descriptor_heap_page_shift;
+		const uint64_t last_page = (heap->_orig_base_gpu_handle.ptr + heap->_orig_gpu_handle_range - 1) >> descriptor_heap_page_shift;
+
+		for (uint64_t page = first_page; page <= last_page; ++page)
+		{
+			if (descriptor_heap_page_table *const table = _descriptor_heap_page_dir[(page >> descriptor_heap_table_shift) & (descriptor_heap_dir_size - 1)].load(std::memory_order_acquire))
+			{
+				// Only clear entries that still point to this heap (boundary pages may have been taken over by a neighboring heap in the meantime)
+				D3D12DescriptorHeap *expected = heap;
+				table->pages[page & ((1ull << descriptor_heap_table_shift) - 1)].compare_exchange_strong(expected, nullptr, std::memory_order_relaxed);
+			}
+		}
+	}
+
 	size_t num_heaps = _descriptor_heaps.size();
 
 	for (size_t heap_index = 0; heap_index < num_heaps; ++heap_index)
@@ -2186,6 +2412,7 @@ void D3D12DescriptorHeap::initialize_descriptor_base_handle(size_t heap_index)
 
 	const D3D12_DESCRIPTOR_HEAP_DESC heap_desc = _orig->GetDesc();
 	assert(heap_desc.Type <= 0x3);
+	_orig_heap_type = heap_desc.Type;
 	_internal_base_cpu_handle.ptr |= heap_desc.Type;
 	assert(heap_desc.Flags <= 0x1);
 	_internal_base_cpu_handle.ptr |= static_cast<SIZE_T>(heap_desc.Flags) << 2;
@@ -2212,8 +2439,37 @@ void D3D12DescriptorHeap::initialize_descriptor_base_handle(size_t heap_index)
 	if (heap_desc.Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE)
 	{
 		_orig_base_gpu_handle = _orig->GetGPUDescriptorHandleForHeapStart();
+		_orig_gpu_handle_range = static_cast<UINT64>(heap_desc.NumDescriptors) * _device->GetDescriptorHandleIncrementSize(heap_desc.Type);
 	}
 }
+
+D3D12DescriptorHeap *reshade::d3d12::device_impl::find_descriptor_heap(D3D12_GPU_DESCRIPTOR_HANDLE handle) const
+{
+	const uint64_t page = handle.ptr >> descriptor_heap_page_shift;
+
+	if (const descriptor_heap_page_table *const table = _descriptor_heap_page_dir[(page >> descriptor_heap_table_shift) & (descriptor_heap_dir_size - 1)].load(std::memory_order_acquire))
+	{
+		D3D12DescriptorHeap *const heap_impl = table->pages[page & ((1ull << descriptor_heap_table_shift) - 1)].load(std::memory_order_acquire);
+		// A page at a heap boundary can be shared with a neighboring heap, so verify the handle is actually within range
+		if (heap_impl != nullptr &&
+			handle.ptr >= heap_impl->_orig_base_gpu_handle.ptr &&
+			handle.ptr < heap_impl->_orig_base_gpu_handle.ptr + heap_impl->_orig_gpu_handle_range)
+			return heap_impl;
+	}
+
+	// Fall back to searching all registered heaps, for handles in a boundary page that was taken over by a neighboring heap
+	for (D3D12DescriptorHeap *const heap_impl : _descriptor_heaps)
+	{
+		if (heap_impl == nullptr || heap_impl->_orig_base_gpu_handle.ptr == 0 ||
+			handle.ptr < heap_impl->_orig_base_gpu_handle.ptr ||
+			handle.ptr >= heap_impl->_orig_base_gpu_handle.ptr + heap_impl->_orig_gpu_handle_range)
+			continue;
+
+		return heap_impl;
+	}
+
+	return nullptr;
+}
 #endif
 
 D3D12_CPU_DESCRIPTOR_HANDLE reshade::d3d12::device_impl::convert_to_original_cpu_descriptor_handle(api::descriptor_table table, D3D12_DESCRIPTOR_HEAP_TYPE *type) const
@@ -2235,20 +2491,12 @@ D3D12_CPU_DESCRIPTOR_HANDLE reshade::d3d12::device_impl::convert_to_original_cpu
 	const D3D12_GPU_DESCRIPTOR_HANDLE handle_gpu = { table.handle };
 
 #if RESHADE_ADDON >= 2
-	for (D3D12DescriptorHeap *const heap_impl : _descriptor_heaps)
+	if (D3D12DescriptorHeap *const heap_impl = find_descriptor_heap(handle_gpu))
 	{
-		if (heap_impl == nullptr || handle_gpu.ptr < heap_impl->_orig_base_gpu_handle.ptr)
-			continue;
-
-		D3D12_DESCRIPTOR_HEAP_DESC desc = heap_impl->_orig->GetDesc();
-		if (handle_gpu.ptr >= offset_descriptor_handle(heap_impl->_orig_base_gpu_handle, desc.NumDescriptors, desc.Type).ptr)
-			continue;
-
 		handle.ptr = heap_impl->_orig_base_cpu_handle.ptr + static_cast<SIZE_T>(handle_gpu.ptr - heap_impl->_orig_base_gpu_handle.ptr);
 
 		if (type != nullptr)
-			*type = desc.Type;
-		break;
+			*type = heap_impl->_orig_heap_type;
 	}
 #else
 	if (_gpu_view_heap.contains(handle_gpu))
@@ -7,6 +7,10 @@
 
 #include "descriptor_heap.hpp"
 #include "reshade_api_object_impl.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <filesystem>
 #include <unordered_map>
 #include <concurrent_vector.h>
 
@@ -116,6 +120,11 @@ namespace reshade::d3d12
 		D3D12_CPU_DESCRIPTOR_HANDLE convert_to_original_cpu_descriptor_handle(api::descriptor_table set, D3D12_DESCRIPTOR_HEAP_TYPE *type = nullptr) const;
 		D3D12_GPU_DESCRIPTOR_HANDLE convert_to_original_gpu_descriptor_handle(api::descriptor_table set) const;
 
+#if RESHADE_ADDON >= 2
+		// Finds the descriptor heap a GPU descriptor handle was allocated from, via a page table lookup keyed by the handle's address bits
+		D3D12DescriptorHeap *find_descriptor_heap(D3D12_GPU_DESCRIPTOR_HANDLE handle) const;
+#endif
+
 		__forceinline D3D12_CPU_DESCRIPTOR_HANDLE offset_descriptor_handle(D3D12_CPU_DESCRIPTOR_HANDLE handle, SIZE_T offset, D3D12_DESCRIPTOR_HEAP_TYPE type) const
 		{
 			handle.ptr += offset * _descriptor_handle_size[type];
@@ -140,10 +149,19 @@ namespace reshade::d3d12
 #endif
 
 	private:
+		// Opens the persistent pipeline library on first use, expects '_pipeline_library_mutex' to be held
+		ID3D12PipelineLibrary1 *open_pipeline_library();
+		void store_pipeline_in_library(LPCWSTR name, ID3D12PipelineState *pipeline);
+
 		std::vector<command_queue_impl *> _queues;
 
 		UINT _descriptor_handle_size[D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES];
 
+		// Whether the device supports enhanced barriers (see 'command_list_impl::submit_barriers')
+		bool _supports_enhanced_barriers = false;
+		// Whether the device supports CPU-visible video memory via the GPU upload heap, which requires resizable BAR (see 'create_resource')
+		bool _supports_gpu_upload_heap = false;
+
 		descriptor_heap_cpu _view_heaps[D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES];
 		descriptor_heap_gpu<D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, 128, 128> _gpu_sampler_heap;
 		descriptor_heap_gpu<D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 50000, 2048> _gpu_view_heap;
@@ -151,10 +169,34 @@ namespace reshade::d3d12
 		mutable std::shared_mutex _resource_mutex;
 #if RESHADE_ADDON >= 2
 		concurrency::concurrent_vector<D3D12DescriptorHeap *> _descriptor_heaps;
+
+		// Flat two-level page table mapping the address bits of GPU descriptor handles to the owning descriptor heap, so that resolution on the per-draw path is two dependent loads instead of a search over all registered heaps
+		static constexpr uint64_t descriptor_heap_page_shift = 16; // 64 KB pages
+		static constexpr uint64_t descriptor_heap_table_shift = 15; // 32768 pages (2 GB of address space) per second-level table
+		static constexpr uint64_t descriptor_heap_dir_size = 1ull << 17; // Number of second-level tables needed to cover the entire 48-bit address space
+
+		struct descriptor_heap_page_table
+		{
+			std::atomic<D3D12DescriptorHeap *> pages[1ull << descriptor_heap_table_shift];
+		};
+
+		std::unique_ptr<std::atomic<descriptor_heap_page_table *>[]> _descriptor_heap_page_dir;
 		std::vector<std::tuple<ID3D12Resource *, D3D12_GPU_VIRTUAL_ADDRESS_RANGE, bool>> _buffer_gpu_addresses; // TODO: Replace with interval tree
 #endif
 		std::unordered_map<SIZE_T, std::pair<ID3D12Resource *, api::resource_view_desc>> _views;
 
+		// Persistent driver pipeline library internal pipelines are loaded from and stored to, so that driver compilation is skipped for them across application runs (serialized to the effect cache directory)
+		std::mutex _pipeline_library_mutex;
+		com_ptr<ID3D12PipelineLibrary1> _pipeline_library;
+		std::vector<uint8_t> _pipeline_library_data; // Backing memory for the serialized blob the library was created from, which has to stay valid for the lifetime of the library
+		std::filesystem::path _pipeline_library_path;
+		bool _pipeline_library_opened = false;
+		bool _pipeline_library_modified = false;
+
+		// Root signatures cached by a hash of their description, so that pipeline layouts with identical shape (like those of all ReShade FX effects) share a single root signature object
+		std::mutex _root_signature_cache_mutex;
+		std::unordered_map<size_t, com_ptr<ID3D12RootSignature>> _root_signature_cache;
+
 		com_ptr<ID3D12PipelineState> _mipmap_pipeline;
 		com_ptr<ID3D12RootSignature> _mipmap_signature;
 	};
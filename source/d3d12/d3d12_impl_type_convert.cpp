@@ -205,6 +205,79 @@ auto reshade::d3d12::convert_usage_to_access(api::resource_usage state) -> D3D12
 
 	return result;
 }
+auto reshade::d3d12::convert_usage_to_barrier_sync(api::resource_usage state) -> D3D12_BARRIER_SYNC
+{
+	// The undefined usage converts to no access, which is only allowed to pair with no synchronization
+	if (state == api::resource_usage::undefined)
+		return D3D12_BARRIER_SYNC_NONE;
+	if (state == api::resource_usage::general || state == api::resource_usage::present)
+		return D3D12_BARRIER_SYNC_ALL;
+
+	D3D12_BARRIER_SYNC result = D3D12_BARRIER_SYNC_NONE;
+	if ((state & api::resource_usage::index_buffer) != 0)
+		result |= D3D12_BARRIER_SYNC_INDEX_INPUT;
+	if ((state & (api::resource_usage::vertex_buffer | api::resource_usage::stream_output)) != 0)
+		result |= D3D12_BARRIER_SYNC_VERTEX_SHADING;
+	if ((state & (api::resource_usage::constant_buffer | api::resource_usage::unordered_access)) != 0)
+		result |= D3D12_BARRIER_SYNC_ALL_SHADING;
+	if ((state & api::resource_usage::indirect_argument) != 0)
+		result |= D3D12_BARRIER_SYNC_EXECUTE_INDIRECT;
+	if ((state & api::resource_usage::depth_stencil) != 0)
+		result |= D3D12_BARRIER_SYNC_DEPTH_STENCIL;
+	if ((state & api::resource_usage::render_target) != 0)
+		result |= D3D12_BARRIER_SYNC_RENDER_TARGET;
+	if ((state & api::resource_usage::shader_resource_pixel) != 0)
+		result |= D3D12_BARRIER_SYNC_PIXEL_SHADING;
+	if ((state & api::resource_usage::shader_resource_non_pixel) != 0)
+		result |= D3D12_BARRIER_SYNC_NON_PIXEL_SHADING;
+	if ((state & (api::resource_usage::copy_dest | api::resource_usage::copy_source)) != 0)
+		result |= D3D12_BARRIER_SYNC_COPY;
+	if ((state & (api::resource_usage::resolve_dest | api::resource_usage::resolve_source)) != 0)
+		result |= D3D12_BARRIER_SYNC_RESOLVE;
+	if ((state & api::resource_usage::acceleration_structure) != 0)
+		result |= D3D12_BARRIER_SYNC_RAYTRACING | D3D12_BARRIER_SYNC_BUILD_RAYTRACING_ACCELERATION_STRUCTURE | D3D12_BARRIER_SYNC_COPY_RAYTRACING_ACCELERATION_STRUCTURE;
+
+	// Fall back to full synchronization for any usage not covered above
+	return result != D3D12_BARRIER_SYNC_NONE ? result : D3D12_BARRIER_SYNC_ALL;
+}
+auto reshade::d3d12::convert_usage_to_barrier_layout(api::resource_usage state) -> D3D12_BARRIER_LAYOUT
+{
+	if (state == api::resource_usage::undefined)
+		return D3D12_BARRIER_LAYOUT_UNDEFINED;
+	if (state == api::resource_usage::present)
+		return D3D12_BARRIER_LAYOUT_PRESENT;
+	if ((state & api::resource_usage::general) != 0)
+		return D3D12_BARRIER_LAYOUT_COMMON;
+
+	// A texture can only be in a single layout, so the write usages take precedence over any additional read usages
+	if ((state & api::resource_usage::depth_stencil_write) != 0)
+		return D3D12_BARRIER_LAYOUT_DEPTH_STENCIL_WRITE;
+	if ((state & api::resource_usage::render_target) != 0)
+		return D3D12_BARRIER_LAYOUT_RENDER_TARGET;
+	if ((state & api::resource_usage::unordered_access) != 0)
+		return D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS;
+	if ((state & api::resource_usage::copy_dest) != 0)
+		return D3D12_BARRIER_LAYOUT_COPY_DEST;
+	if ((state & api::resource_usage::resolve_dest) != 0)
+		return D3D12_BARRIER_LAYOUT_RESOLVE_DEST;
+
+	switch (state)
+	{
+	case api::resource_usage::depth_stencil_read:
+		return D3D12_BARRIER_LAYOUT_DEPTH_STENCIL_READ;
+	case api::resource_usage::shader_resource:
+	case api::resource_usage::shader_resource_pixel:
+	case api::resource_usage::shader_resource_non_pixel:
+		return D3D12_BARRIER_LAYOUT_SHADER_RESOURCE;
+	case api::resource_usage::copy_source:
+		return D3D12_BARRIER_LAYOUT_COPY_SOURCE;
+	case api::resource_usage::resolve_source:
+		return D3D12_BARRIER_LAYOUT_RESOLVE_SOURCE;
+	default:
+		// Any other combination of read-only usages is covered by the generic read layout
+		return D3D12_BARRIER_LAYOUT_GENERIC_READ;
+	}
+}
 auto reshade::d3d12::convert_usage_to_resource_states(api::resource_usage state) -> D3D12_RESOURCE_STATES
 {
 	// Undefined resource state does not exist in D3D12
@@ -499,6 +572,7 @@ reshade::api::resource_desc reshade::d3d12::convert_resource_desc(const D3D12_RE
 		desc.heap = api::memory_heap::gpu_only;
 		break;
 	case D3D12_HEAP_TYPE_UPLOAD:
+	case D3D12_HEAP_TYPE_GPU_UPLOAD:
 		desc.heap = api::memory_heap::cpu_to_gpu;
 		break;
 	case D3D12_HEAP_TYPE_READBACK:
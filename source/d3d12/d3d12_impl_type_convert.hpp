@@ -48,6 +48,8 @@ namespace reshade::d3d12
 	auto convert_resource_states_to_usage(D3D12_RESOURCE_STATES states) -> api::resource_usage;
 
 	auto convert_usage_to_access(api::resource_usage usage) -> D3D12_BARRIER_ACCESS;
+	auto convert_usage_to_barrier_sync(api::resource_usage usage) -> D3D12_BARRIER_SYNC;
+	auto convert_usage_to_barrier_layout(api::resource_usage usage) -> D3D12_BARRIER_LAYOUT;
 	auto convert_usage_to_resource_states(api::resource_usage usage) -> D3D12_RESOURCE_STATES;
 
 	void convert_sampler_desc(const api::sampler_desc &desc, D3D12_SAMPLER_DESC &internal_desc);
@@ -48,6 +48,11 @@ HRESULT STDMETHODCALLTYPE ID3D12Resource_Map(ID3D12Resource *pResource, UINT Sub
 	if (FAILED(hr))
 		return hr;
 
+	// This hook is only installed while an add-on is subscribed to the map events, but it stays in the vtable after the last one unsubscribes, so skip the event marshalling overhead then
+	if (!reshade::has_addon_event<reshade::addon_event::map_buffer_region>() &&
+		!reshade::has_addon_event<reshade::addon_event::map_texture_region>())
+		return hr;
+
 	com_ptr<ID3D12Device> device;
 	pResource->GetDevice(IID_PPV_ARGS(&device));
 	assert(device != nullptr);
@@ -105,6 +110,11 @@ HRESULT STDMETHODCALLTYPE ID3D12Resource_Map(ID3D12Resource *pResource, UINT Sub
 }
 HRESULT STDMETHODCALLTYPE ID3D12Resource_Unmap(ID3D12Resource *pResource, UINT Subresource, const D3D12_RANGE *pWrittenRange)
 {
+	// This hook is only installed while an add-on is subscribed to the unmap events, but it stays in the vtable after the last one unsubscribes, so skip the event marshalling overhead then
+	if (!reshade::has_addon_event<reshade::addon_event::unmap_buffer_region>() &&
+		!reshade::has_addon_event<reshade::addon_event::unmap_texture_region>())
+		return reshade::hooks::call(ID3D12Resource_Unmap, reshade::hooks::vtable_from_instance(pResource) + 9)(pResource, Subresource, pWrittenRange);
+
 	com_ptr<ID3D12Device> device;
 	pResource->GetDevice(IID_PPV_ARGS(&device));
 	assert(device != nullptr);
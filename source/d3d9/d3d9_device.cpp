@@ -1593,6 +1593,9 @@ HRESULT STDMETHODCALLTYPE Direct3DDevice9::DrawPrimitive(D3DPRIMITIVETYPE Primit
 
 	if (reshade::invoke_addon_event<reshade::addon_event::draw>(this, reshade::d3d9::calc_vertex_from_prim_count(PrimitiveType, PrimitiveCount), 1, StartVertex, 0))
 		return D3D_OK;
+
+	// Apply any shader constants an add-on pushed during the event above, so they take effect for this draw call
+	flush_shader_constants();
 #endif
 
 	return _orig->DrawPrimitive(PrimitiveType, StartVertex, PrimitiveCount);
@@ -1615,6 +1618,9 @@ HRESULT STDMETHODCALLTYPE Direct3DDevice9::DrawIndexedPrimitive(D3DPRIMITIVETYPE
 
 	if (reshade::invoke_addon_event<reshade::addon_event::draw_indexed>(this, reshade::d3d9::calc_vertex_from_prim_count(PrimitiveType, PrimitiveCount), 1, StartIndex, BaseVertexIndex, 0))
 		return D3D_OK;
+
+	// Apply any shader constants an add-on pushed during the event above, so they take effect for this draw call
+	flush_shader_constants();
 #endif
 
 	return _orig->DrawIndexedPrimitive(PrimitiveType, BaseVertexIndex, MinVertexIndex, NumVertices, StartIndex, PrimitiveCount);
@@ -1668,6 +1674,9 @@ HRESULT STDMETHODCALLTYPE Direct3DDevice9::DrawPrimitiveUP(D3DPRIMITIVETYPE Prim
 
 	if (reshade::invoke_addon_event<reshade::addon_event::draw>(this, vertex_count, 1, 0, 0))
 		return D3D_OK;
+
+	// Apply any shader constants an add-on pushed during the event above, so they take effect for this draw call
+	flush_shader_constants();
 #endif
 
 	const HRESULT hr = _orig->DrawPrimitiveUP(PrimitiveType, PrimitiveCount, pVertexStreamZeroData, VertexStreamZeroStride);
@@ -1752,6 +1761,9 @@ HRESULT STDMETHODCALLTYPE Direct3DDevice9::DrawIndexedPrimitiveUP(D3DPRIMITIVETY
 
 	if (reshade::invoke_addon_event<reshade::addon_event::draw_indexed>(this, index_count, 1, 0, 0, 0))
 		return D3D_OK;
+
+	// Apply any shader constants an add-on pushed during the event above, so they take effect for this draw call
+	flush_shader_constants();
 #endif
 
 	const HRESULT hr = _orig->DrawIndexedPrimitiveUP(PrimitiveType, MinVertexIndex, NumVertices, PrimitiveCount, pIndexData, IndexDataFormat, pVertexStreamZeroData, VertexStreamZeroStride);
@@ -1791,7 +1803,12 @@ HRESULT STDMETHODCALLTYPE Direct3DDevice9::ProcessVertices(UINT SrcStartIndex, U
 
 	HRESULT hr = D3D_OK;
 	if (reshade::invoke_addon_event<reshade::addon_event::draw>(this, VertexCount, 1, SrcStartIndex, 0) == false)
+	{
+		// Apply any shader constants an add-on pushed during the event above, so they take effect for this call
+		flush_shader_constants();
+
 		hr = _orig->ProcessVertices(SrcStartIndex, _current_stream_output_offset, VertexCount, _current_stream_output, pVertexDecl, Flags);
+	}
 
 	const reshade::api::resource prev_buffer = { 0 };
 	const uint64_t prev_offset_64 = 0;
@@ -2196,10 +2213,18 @@ HRESULT STDMETHODCALLTYPE Direct3DDevice9::GetPixelShaderConstantB(UINT StartReg
 }
 HRESULT STDMETHODCALLTYPE Direct3DDevice9::DrawRectPatch(UINT Handle, const float *pNumSegs, const D3DRECTPATCH_INFO *pRectPatchInfo)
 {
+#if RESHADE_ADDON
+	flush_shader_constants();
+#endif
+
 	return _orig->DrawRectPatch(Handle, pNumSegs, pRectPatchInfo);
 }
 HRESULT STDMETHODCALLTYPE Direct3DDevice9::DrawTriPatch(UINT Handle, const float *pNumSegs, const D3DTRIPATCH_INFO *pTriPatchInfo)
 {
+#if RESHADE_ADDON
+	flush_shader_constants();
+#endif
+
 	return _orig->DrawTriPatch(Handle, pNumSegs, pTriPatchInfo);
 }
 HRESULT STDMETHODCALLTYPE Direct3DDevice9::DeletePatch(UINT Handle)
@@ -5,8 +5,9 @@
 
 #include "d3d9_impl_device.hpp"
 #include "d3d9_impl_type_convert.hpp"
-#include <cstring> // std::strlen
-#include <algorithm> // std::max
+#include <cstring> // std::memcpy, std::strlen
+#include <iterator> // std::size
+#include <algorithm> // std::max, std::min
 #include <utf8/unchecked.h>
 
 static void convert_cube_uv_to_vec(D3DCUBEMAP_FACES face, float u, float v, float &x, float &y, float &z)
@@ -289,16 +290,62 @@ void reshade::d3d9::device_impl::push_constants(api::shader_stage stages, api::p
 	{
 		// https://learn.microsoft.com/windows/win32/direct3dhlsl/dx9-graphics-reference-asm-vs-registers-vs-3-0#input-registers
 		assert((first + count) <= _caps.MaxVertexShaderConst);
-		_orig->SetVertexShaderConstantF(first, static_cast<const float *>(values), count);
+		if ((first + count) <= static_cast<uint32_t>(std::size(_vs_constant_shadow.data) / 4))
+			update_shader_constants(_vs_constant_shadow, first, count, static_cast<const float *>(values));
+		else
+			_orig->SetVertexShaderConstantF(first, static_cast<const float *>(values), count);
 	}
 	if ((stages & api::shader_stage::pixel) == api::shader_stage::pixel)
 	{
 		// https://learn.microsoft.com/windows/win32/direct3dhlsl/dx9-graphics-reference-asm-ps-registers-ps-3-0#input-register-types
 		// Technically limited based on the pixel shader version, but more seem to work on modern hardware and drivers, so do not check:
 		//   assert((first + count) <= (_caps.PixelShaderVersion < D3DPS_VERSION(2, 0) ? 8 : _caps.PixelShaderVersion < D3DPS_VERSION(3, 0) ? 32 : 224));
-		_orig->SetPixelShaderConstantF(first, static_cast<const float *>(values), count);
+		if ((first + count) <= static_cast<uint32_t>(std::size(_ps_constant_shadow.data) / 4))
+			update_shader_constants(_ps_constant_shadow, first, count, static_cast<const float *>(values));
+		else
+			_orig->SetPixelShaderConstantF(first, static_cast<const float *>(values), count);
 	}
 }
+
+void reshade::d3d9::device_impl::update_shader_constants(shader_constant_shadow &shadow, uint32_t first, uint32_t count, const float *values)
+{
+	std::memcpy(&shadow.data[first * 4], values, count * 4 * sizeof(float));
+
+	// Merge with an existing dirty range when overlapping or adjacent, so contiguous updates end up in a single driver call
+	for (uint32_t i = 0; i < shadow.range_count; ++i)
+	{
+		auto &range = shadow.ranges[i];
+		if (first <= range.first + range.count && first + count >= range.first)
+		{
+			const uint32_t range_end = std::max(range.first + range.count, first + count);
+			range.first = std::min(range.first, first);
+			range.count = range_end - range.first;
+			return;
+		}
+	}
+
+	// In the unlikely case of many disjoint updates, make room by flushing what has accumulated so far (cannot merge disjoint ranges instead, since the registers between them may hold application data the shadow copy does not know about)
+	if (shadow.range_count == static_cast<uint32_t>(std::size(shadow.ranges)))
+		flush_shader_constants();
+
+	shadow.ranges[shadow.range_count++] = { first, count };
+}
+void reshade::d3d9::device_impl::flush_shader_constants()
+{
+	for (uint32_t i = 0; i < _vs_constant_shadow.range_count; ++i)
+	{
+		const auto &range = _vs_constant_shadow.ranges[i];
+		_orig->SetVertexShaderConstantF(range.first, &_vs_constant_shadow.data[range.first * 4], range.count);
+	}
+	_vs_constant_shadow.range_count = 0;
+
+	for (uint32_t i = 0; i < _ps_constant_shadow.range_count; ++i)
+	{
+		const auto &range = _ps_constant_shadow.ranges[i];
+		_orig->SetPixelShaderConstantF(range.first, &_ps_constant_shadow.data[range.first * 4], range.count);
+	}
+	_ps_constant_shadow.range_count = 0;
+}
 void reshade::d3d9::device_impl::push_descriptors(api::shader_stage stages, api::pipeline_layout layout, uint32_t layout_param, const api::descriptor_table_update &update)
 {
 	assert(update.table == 0 && update.array_offset == 0);
@@ -427,6 +474,8 @@ void reshade::d3d9::device_impl::draw(uint32_t vertex_count, uint32_t instance_c
 	assert(instance_count == 1 && first_instance == 0);
 	assert(_current_prim_type != 0); // Need to bind a primitive topology before performing draw call
 
+	flush_shader_constants();
+
 	if (_current_stream_output != nullptr)
 	{
 		com_ptr<IDirect3DVertexDeclaration9> decl;
@@ -443,6 +492,8 @@ void reshade::d3d9::device_impl::draw_indexed(uint32_t index_count, uint32_t ins
 	assert(instance_count == 1 && first_instance == 0);
 	assert(_current_prim_type != 0);
 
+	flush_shader_constants();
+
 	// Estimate maximum vertex count based on the size of the current vertex buffer
 	// This is needed for D3D9On12, which uses the vertex count to update deferred input buffers
 	UINT vertex_count = 0;
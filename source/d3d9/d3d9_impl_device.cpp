@@ -132,9 +132,14 @@ void reshade::d3d9::device_impl::on_init()
 }
 void reshade::d3d9::device_impl::on_reset()
 {
+	_backup_state.release_state_block();
 	_copy_state.reset();
 	_default_input_stream.reset();
 	_default_input_layout.reset();
+
+	// Drop any accumulated shader constant updates, since the register contents do not survive a device reset
+	_vs_constant_shadow.range_count = 0;
+	_ps_constant_shadow.range_count = 0;
 }
 
 bool reshade::d3d9::device_impl::get_property(api::device_properties property, void *data) const
@@ -226,6 +231,7 @@ bool reshade::d3d9::device_impl::check_capability(api::device_caps capability) c
 	case api::device_caps::shared_fence_nt_handle:
 	case api::device_caps::amplification_and_mesh_shader:
 	case api::device_caps::ray_tracing:
+	case api::device_caps::partial_constant_buffer_updates:
 	default:
 		return false;
 	}
@@ -156,6 +156,9 @@ namespace reshade::d3d9
 
 		HRESULT create_surface_replacement(const D3DSURFACE_DESC &desc, IDirect3DSurface9 **out_surface, HANDLE *out_shared_handle = nullptr);
 
+		// Applies any accumulated shader constant updates to the device, which the hooked draw methods have to do before application draw calls, so that constants pushed by add-ons outside the interface draw path keep their immediate semantics
+		void flush_shader_constants();
+
 		com_ptr<IDirect3D9> _d3d;
 		D3DDEVICE_CREATION_PARAMETERS _cp = {};
 		D3DCAPS9 _caps = {};
@@ -165,9 +168,21 @@ namespace reshade::d3d9
 		IDirect3DVertexBuffer9 *_current_stream_output = nullptr;
 
 	private:
+		// Shadowed floating-point shader constant registers of one stage, which accumulate 'push_constants' updates, so they can be flushed to the device with the minimum number of driver calls on the next draw (see 'flush_shader_constants')
+		struct shader_constant_shadow
+		{
+			uint32_t range_count = 0;
+			struct { uint32_t first, count; } ranges[8] = {};
+			float data[256 * 4] = {};
+		};
+
+		void update_shader_constants(shader_constant_shadow &shadow, uint32_t first, uint32_t count, const float *values);
+
 		state_block _backup_state;
 		com_ptr<IDirect3DStateBlock9> _copy_state;
 		com_ptr<IDirect3DVertexBuffer9> _default_input_stream;
 		com_ptr<IDirect3DVertexDeclaration9> _default_input_layout;
+		shader_constant_shadow _vs_constant_shadow;
+		shader_constant_shadow _ps_constant_shadow;
 	};
 }
@@ -29,9 +29,8 @@ reshade::d3d9::state_block::~state_block()
 
 void reshade::d3d9::state_block::capture()
 {
-	assert(_state_block == nullptr);
-
-	if (SUCCEEDED(_device->CreateStateBlock(D3DSBT_ALL, &_state_block)))
+	// Create the state block object once and reuse it for subsequent captures, since creation is the expensive part (it is released again on device reset, see 'release_state_block')
+	if (_state_block != nullptr || SUCCEEDED(_device->CreateStateBlock(D3DSBT_ALL, &_state_block)))
 		_state_block->Capture();
 	else
 		assert(false);
@@ -56,8 +55,8 @@ void reshade::d3d9::state_block::apply_and_release()
 	if (_state_block != nullptr)
 		_state_block->Apply();
 
-	// Release state block every time, so that all references to captured vertex and index buffers, textures, etc. are released again
-	_state_block.reset();
+	// The state block object is kept alive for reuse, which also keeps the references to captured vertex and index buffers, textures, etc. alive
+	// That is fine, since those references are replaced on the next capture and the state block is released before a device reset could be blocked by them
 
 	if (0 != (_vertex_processing & D3DCREATE_MIXED_VERTEXPROCESSING))
 	{
@@ -81,3 +80,8 @@ void reshade::d3d9::state_block::apply_and_release()
 		render_target.reset();
 	_depth_stencil.reset();
 }
+
+void reshade::d3d9::state_block::release_state_block()
+{
+	_state_block.reset();
+}
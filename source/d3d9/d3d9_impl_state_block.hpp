@@ -19,6 +19,9 @@ namespace reshade::d3d9
 		void capture();
 		void apply_and_release();
 
+		// Releases the cached state block object, so that it is recreated on the next capture (required before a device reset, since it holds references to device resources)
+		void release_state_block();
+
 	private:
 		com_ptr<IDirect3DDevice9> _device;
 		com_ptr<IDirect3DStateBlock9> _state_block;
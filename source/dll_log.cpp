@@ -4,6 +4,10 @@
  */
 
 #include "dll_log.hpp"
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 #include <Windows.h>
 
 struct scoped_file_handle
@@ -27,6 +31,81 @@ private:
 
 static scoped_file_handle s_file_handle;
 
+static void write_message(const std::string &line_string)
+{
+	// Write line to the log file
+	if (s_file_handle != INVALID_HANDLE_VALUE)
+	{
+		DWORD written = 0;
+		WriteFile(s_file_handle, line_string.data(), static_cast<DWORD>(line_string.size()), &written, nullptr);
+		assert(written == line_string.size());
+	}
+
+#ifndef NDEBUG
+	// Write line to the debug output
+	OutputDebugStringA(line_string.c_str());
+#endif
+}
+
+// Queue of formatted lines that have not yet been written to the log file, drained by a background writer thread, so that the file writes (which are flushed to disk and can stall for a long time e.g. on network drives) do not happen on performance-critical threads
+static std::mutex s_message_mutex;
+static std::condition_variable s_message_signal;
+static std::deque<std::string> s_message_queue;
+static size_t s_message_drop_count = 0;
+static bool s_message_writer_exit = false;
+static std::thread s_message_writer;
+
+static void write_queued_messages()
+{
+	std::unique_lock<std::mutex> lock(s_message_mutex);
+
+	while (!s_message_queue.empty())
+	{
+		const std::string line_string = std::move(s_message_queue.front());
+		s_message_queue.pop_front();
+
+		// Do not hold the lock during the file write, so that logging threads are never blocked on it
+		lock.unlock();
+		write_message(line_string);
+		lock.lock();
+	}
+
+	if (s_message_drop_count != 0)
+	{
+		const size_t drop_count = s_message_drop_count;
+		s_message_drop_count = 0;
+		lock.unlock();
+
+		char drop_string[64];
+		const int drop_string_length = std::snprintf(drop_string, std::size(drop_string), "| WARN  | Dropped %zu log message(s) under pressure!\r\n", drop_count);
+		write_message(std::string(drop_string, drop_string_length));
+	}
+}
+
+static const struct scoped_message_writer
+{
+	~scoped_message_writer()
+	{
+		{	const std::unique_lock<std::mutex> lock(s_message_mutex);
+			s_message_writer_exit = true;
+		}
+		s_message_signal.notify_all();
+
+		// Cannot join the writer thread here, since this may run under the loader lock during DLL detach, which the exiting thread would need to acquire as well
+		if (s_message_writer.joinable())
+			s_message_writer.detach();
+
+		// Instead write out any remaining messages on this thread (only attempt to lock, since during process exit the writer thread may have been terminated while holding the lock)
+		if (s_message_mutex.try_lock())
+		{
+			for (const std::string &line_string : s_message_queue)
+				write_message(line_string);
+			s_message_queue.clear();
+			s_message_mutex.unlock();
+		}
+	}
+} s_message_writer_scope;
+
 bool reshade::log::open_log_file(const std::filesystem::path &path, std::error_code &ec)
 {
 	// Close the previous file first
@@ -39,6 +118,23 @@ bool reshade::log::open_log_file(const std::filesystem::path &path, std::error_c
 
 	if (s_file_handle != INVALID_HANDLE_VALUE)
 	{
+		// Start the background writer thread that drains the message queue (it begins executing only after the current thread left 'DllMain', so is safe to create under the loader lock)
+		if (!s_message_writer.joinable())
+		{
+			s_message_writer = std::thread([]() {
+				std::unique_lock<std::mutex> lock(s_message_mutex);
+				while (true)
+				{
+					s_message_signal.wait(lock, []() { return s_message_writer_exit || !s_message_queue.empty(); });
+					if (s_message_writer_exit)
+						break; // Remaining messages are written out during shutdown (see 'scoped_message_writer')
+					lock.unlock();
+					write_queued_messages();
+					lock.lock();
+				}
+			});
+		}
+
 		// Last error may be ERROR_ALREADY_EXISTS if an existing file was overwritten, which can be ignored
 		ec.clear();
 		return true;
@@ -97,16 +193,24 @@ void reshade::log::message(level level, const char *format, ...)
 	for (size_t offset = 0; (offset = line_string.find('\n', offset)) != std::string::npos; offset += 2)
 		line_string.replace(offset, 1, "\r\n", 2);
 
-	// Write line to the log file
-	if (s_file_handle != INVALID_HANDLE_VALUE)
-	{
-		DWORD written = 0;
-		WriteFile(s_file_handle, line_string.data(), static_cast<DWORD>(line_string.size()), &written, nullptr);
-		assert(written == line_string.size());
+	// Queue the line for the background writer thread, rather than stalling this thread on the file write
+	// Errors are additionally flushed right away below, so that they are not lost if the application crashes shortly after
+	const bool flush = level == level::error || !s_message_writer.joinable();
+
+	{	const std::unique_lock<std::mutex> lock(s_message_mutex);
+
+		// Drop the oldest message when the queue grows faster than the writer thread can drain it (e.g. during device creation storms in some applications), since the most recent messages are the most valuable for diagnostics
+		if (s_message_queue.size() >= 1024)
+		{
+			s_message_queue.pop_front();
+			s_message_drop_count++;
+		}
+
+		s_message_queue.push_back(std::move(line_string));
 	}
 
-#ifndef NDEBUG
-	// Write line to the debug output
-	OutputDebugStringA(line_string.c_str());
-#endif
+	if (flush)
+		write_queued_messages();
+	else
+		s_message_signal.notify_one();
 }
@@ -8,6 +8,7 @@
 #include "ini_file.hpp"
 #include "hook_manager.hpp"
 #include "addon_manager.hpp"
+#include "trace_events.hpp"
 #include <Windows.h>
 #include <Psapi.h>
 #ifndef NDEBUG
@@ -274,7 +275,11 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 				GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_PIN | GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, reinterpret_cast<LPCWSTR>(hModule), &hModule);
 			}
 
-			// Register modules to hook
+			// Register the ETW provider, so that external profilers can capture the events emitted around the internal phases
+			reshade::trace::register_provider();
+
+			// Register modules to hook, batched into a single hook transaction, so that the threads of the process are only suspended and resumed once, rather than once per module
+			reshade::hooks::enter_transaction();
 			{
 				if (!GetEnvironmentVariableW(L"RESHADE_DISABLE_INPUT_HOOK", nullptr, 0))
 				{
@@ -299,7 +304,7 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 					// Disable network hooks when requested through an environment variable and always disable add-ons in that case
 					extern volatile long g_network_traffic;
 					g_network_traffic = std::numeric_limits<long>::max(); // Special value to indicate that add-ons should never be enabled
-					reshade::addon_enabled = false;
+					reshade::enable_addons(false);
 				}
 #endif
 
@@ -336,6 +341,7 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 #endif
 				}
 			}
+			reshade::hooks::leave_transaction();
 
 			reshade::log::message(reshade::log::level::info, "Initialized.");
 			break;
@@ -367,6 +373,8 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 				RemoveVectoredExceptionHandler(s_exception_handler_handle);
 #endif
 
+			reshade::trace::unregister_provider();
+
 			reshade::log::message(reshade::log::level::info, "Finished exiting.");
 			break;
 		}
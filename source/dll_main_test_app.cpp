@@ -9,8 +9,10 @@
 #include "dll_log.hpp"
 #include "hook_manager.hpp"
 #include "addon_manager.hpp"
+#include "runtime_internal.hpp"
 #include "com_ptr.hpp"
 #include "ini_file.hpp"
+#include <chrono>
 #include <d3d9.h>
 #include <d3d11.h>
 #include <d3d12.h>
@@ -48,6 +50,77 @@ struct scoped_module_handle
 	const HMODULE module;
 };
 
+#if RESHADE_ADDON && RESHADE_FX
+
+// Benchmark mode measures the cost of effect rendering over a fixed number of frames and writes machine-readable results to disk afterwards
+static struct benchmark_state
+{
+	const char *api_name = "unknown";
+	unsigned int target_frame_count = 0;
+	unsigned int warmup_frame_count = 0;
+	unsigned int frame_count = 0;
+	uint64_t total_cpu_time_ns = 0;
+	std::chrono::high_resolution_clock::time_point frame_begin_time;
+} s_benchmark;
+
+static void on_benchmark_begin_effects(reshade::api::effect_runtime *, reshade::api::command_list *, reshade::api::resource_view, reshade::api::resource_view)
+{
+	s_benchmark.frame_begin_time = std::chrono::high_resolution_clock::now();
+}
+static void on_benchmark_finish_effects(reshade::api::effect_runtime *runtime, reshade::api::command_list *, reshade::api::resource_view, reshade::api::resource_view)
+{
+	s_benchmark.total_cpu_time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - s_benchmark.frame_begin_time).count();
+
+	// Skip the first frames after effects finished loading, so that the moving averages and in-flight timestamp queries have settled before measuring begins
+	if (s_benchmark.warmup_frame_count != 0)
+	{
+		s_benchmark.warmup_frame_count--;
+		s_benchmark.total_cpu_time_ns = 0;
+		return;
+	}
+
+	if (++s_benchmark.frame_count != s_benchmark.target_frame_count)
+		return;
+
+	const std::filesystem::path result_path = g_reshade_base_path / L"ReShade_benchmark.csv";
+
+	if (FILE *const file = _wfsopen(result_path.c_str(), L"wb", SH_DENYNO))
+	{
+		fprintf(file, "api,name,frames,average_cpu_ns,average_gpu_ns\n");
+
+		uint64_t total_gpu_time_ns = 0;
+		runtime->enumerate_techniques(nullptr,
+			[file, &total_gpu_time_ns](reshade::api::effect_runtime *, reshade::api::effect_technique handle) {
+				// This is running in the same module as ReShade itself, so can access the technique statistics directly
+				const auto tech = reinterpret_cast<const reshade::technique *>(handle.handle);
+				if (!tech->enabled)
+					return;
+
+				total_gpu_time_ns += tech->average_gpu_duration;
+
+				fprintf(file, "%s,%s,%u,%llu,%llu\n", s_benchmark.api_name, tech->name.c_str(), s_benchmark.frame_count,
+					static_cast<unsigned long long>(tech->average_cpu_duration),
+					static_cast<unsigned long long>(tech->average_gpu_duration));
+			});
+
+		fprintf(file, "%s,render_effects,%u,%llu,%llu\n", s_benchmark.api_name, s_benchmark.frame_count,
+			static_cast<unsigned long long>(s_benchmark.total_cpu_time_ns / s_benchmark.frame_count),
+			static_cast<unsigned long long>(total_gpu_time_ns));
+
+		fclose(file);
+
+		reshade::log::message(reshade::log::level::info, "Benchmark finished after %u frames. Results were written to '%s'.", s_benchmark.frame_count, result_path.u8string().c_str());
+	}
+	else
+	{
+		reshade::log::message(reshade::log::level::error, "Failed to write benchmark results to '%s'!", result_path.u8string().c_str());
+	}
+
+	PostQuitMessage(EXIT_SUCCESS);
+}
+
+#endif
+
 static LONG APIENTRY HookD3DKMTQueryAdapterInfo(const void *pData)
 {
 	struct D3DKMT_QUERYADAPTERINFO { UINT hAdapter; UINT Type; VOID *pPrivateDriverData; UINT PrivateDriverDataSize; };
@@ -148,6 +221,45 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR lpCmdLine, int nCmdShow
 
 	const bool multisample = strstr(lpCmdLine, "-multisample") != nullptr;
 
+#if RESHADE_ADDON && RESHADE_FX
+	// Run in benchmark mode when a frame count was passed (e.g. "ReShade64.exe -d3d12 -benchmark 1000 -preset Preset.ini")
+	if (LPSTR benchmark_arg = std::strstr(lpCmdLine, "-benchmark "))
+		s_benchmark.target_frame_count = std::strtoul(benchmark_arg + 11, nullptr, 10);
+
+	if (s_benchmark.target_frame_count != 0)
+	{
+		switch (api)
+		{
+		case reshade::api::device_api::d3d9: s_benchmark.api_name = "d3d9"; break;
+		case reshade::api::device_api::d3d10: s_benchmark.api_name = "d3d10"; break;
+		case reshade::api::device_api::d3d11: s_benchmark.api_name = "d3d11"; break;
+		case reshade::api::device_api::d3d12: s_benchmark.api_name = "d3d12"; break;
+		case reshade::api::device_api::opengl: s_benchmark.api_name = "opengl"; break;
+		case reshade::api::device_api::vulkan: s_benchmark.api_name = "vulkan"; break;
+		}
+
+		// Give the moving averages (60 samples) and delayed timestamp queries time to settle before measurement starts
+		s_benchmark.warmup_frame_count = 120;
+
+		if (LPSTR preset_arg = std::strstr(lpCmdLine, "-preset "))
+		{
+			preset_arg += 8;
+			const LPSTR preset_arg_end = std::strchr(preset_arg, ' ');
+			reshade::global_config().set("GENERAL", "PresetPath",
+				std::filesystem::u8path(std::string(preset_arg, preset_arg_end != nullptr ? preset_arg_end : preset_arg + std::strlen(preset_arg))));
+		}
+
+		// Gather GPU timings even though the statistics overlay is not open
+		reshade::global_config().set("GENERAL", "GatherGPUStatistics", true);
+
+		// The add-on events invoked around effect rendering are the measurement points (this is running in the same module as ReShade, so callbacks can be added to the event lists directly)
+		reshade::addon_event_list[static_cast<uint32_t>(reshade::addon_event::reshade_begin_effects)].push_back(reinterpret_cast<void *>(&on_benchmark_begin_effects));
+		reshade::update_addon_event_table(reshade::addon_event::reshade_begin_effects);
+		reshade::addon_event_list[static_cast<uint32_t>(reshade::addon_event::reshade_finish_effects)].push_back(reinterpret_cast<void *>(&on_benchmark_finish_effects));
+		reshade::update_addon_event_table(reshade::addon_event::reshade_finish_effects);
+	}
+#endif
+
 	switch (api)
 	{
 	#pragma region D3D9 Implementation
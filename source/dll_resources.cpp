@@ -6,6 +6,8 @@
 #include "dll_resources.hpp"
 #include <cassert>
 #include <algorithm> // std::find
+#include <shared_mutex>
+#include <unordered_map>
 #include <utf8/unchecked.h>
 #include <Windows.h>
 
@@ -13,6 +15,17 @@ extern HMODULE g_module_handle;
 
 reshade::resources::data_resource reshade::resources::load_data_resource(unsigned short id)
 {
+	// Cache resolved resources process-wide, so that repeated loads (e.g. of the renderer shaders during every swap chain initialization) do not have to walk the module resource directory again
+	// The returned pointers reference the mapped module image directly and therefore stay valid for the lifetime of the process
+	static std::shared_mutex s_resource_cache_mutex;
+	static std::unordered_map<unsigned short, data_resource> s_resource_cache;
+
+	{	const std::shared_lock<std::shared_mutex> lock(s_resource_cache_mutex);
+		if (const auto it = s_resource_cache.find(id);
+			it != s_resource_cache.end())
+			return it->second;
+	}
+
 	const HRSRC info = FindResource(g_module_handle, MAKEINTRESOURCE(id), RT_RCDATA);
 	assert(info != nullptr);
 	const HGLOBAL handle = LoadResource(g_module_handle, info);
@@ -21,6 +34,9 @@ reshade::resources::data_resource reshade::resources::load_data_resource(unsigne
 	result.data = LockResource(handle);
 	result.data_size = SizeofResource(g_module_handle, info);
 
+	const std::unique_lock<std::shared_mutex> lock(s_resource_cache_mutex);
+	s_resource_cache.emplace(id, result);
+
 	return result;
 }
 
@@ -38,6 +54,8 @@ std::string reshade::resources::load_string(unsigned short id)
 }
 
 #if RESHADE_LOCALIZATION
+thread_local unsigned int reshade::resources::current_language_serial = 0;
+
 std::string reshade::resources::get_current_language()
 {
 	ULONG num = 0, size = 0;
@@ -83,6 +101,18 @@ std::string reshade::resources::set_current_language(const std::string &language
 
 	SetThreadPreferredUILanguages(MUI_LANGUAGE_NAME, languages.data(), &num);
 
+	// Assign a stable serial to each language this thread has used, so that strings cached in 'load_string' become valid again when switching back to a language used before
+	static thread_local std::vector<std::string> s_languages_used;
+	if (const auto it = std::find(s_languages_used.begin(), s_languages_used.end(), language); it != s_languages_used.end())
+	{
+		current_language_serial = static_cast<unsigned int>(1 + std::distance(s_languages_used.begin(), it));
+	}
+	else
+	{
+		s_languages_used.push_back(language);
+		current_language_serial = static_cast<unsigned int>(s_languages_used.size());
+	}
+
 	return prev_language;
 }
 
@@ -8,6 +8,7 @@
 #include "resource.h"
 #include <string>
 #include <vector>
+#include <limits>
 
 namespace reshade::resources
 {
@@ -28,8 +29,31 @@ namespace reshade::resources
 	/// </summary>
 	/// <param name="id">Resource identifier of the string resource.</param>
 	std::string load_string(unsigned short id);
+
+#if RESHADE_LOCALIZATION
+	/// <summary>
+	/// Serial number identifying the language currently used to look up resources for this thread, updated by <see cref="set_current_language"/>.
+	/// </summary>
+	extern thread_local unsigned int current_language_serial;
+#endif
+
 	template <unsigned short id>
-	inline std::string load_string() { return load_string(id); }
+	inline const std::string &load_string()
+	{
+#if RESHADE_LOCALIZATION
+		// Cache the resolved string, so that drawing the overlay does not have to resolve it through the resource tables again every frame, and only refresh it after a language switch
+		static thread_local unsigned int cached_language_serial = std::numeric_limits<unsigned int>::max();
+		static thread_local std::string cached_string;
+		if (cached_language_serial != current_language_serial)
+		{
+			cached_string = load_string(id);
+			cached_language_serial = current_language_serial;
+		}
+#else
+		static const std::string cached_string = load_string(id);
+#endif
+		return cached_string;
+	}
 
 #if RESHADE_LOCALIZATION
 	/// <summary>
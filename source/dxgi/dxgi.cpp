@@ -8,6 +8,7 @@
 #include "d3d11/d3d11_device.hpp"
 #include "d3d12/d3d12_command_queue.hpp"
 #include "dll_log.hpp" // Include late to get 'hr_to_string' helper function
+#include "ini_file.hpp"
 #include "com_utils.hpp"
 #include "hook_manager.hpp"
 #include "addon_manager.hpp"
@@ -17,6 +18,9 @@ extern bool is_windows7();
 // Needs to be set whenever a DXGI call can end up in 'CDXGISwapChain::EnsureChildDeviceInternal', to avoid hooking internal D3D device creation
 extern thread_local bool g_in_dxgi_runtime;
 
+// Set when the frame latency waitable object flag was forced onto a swap chain during creation, in which case the swap chain proxy takes over waiting on it (see 'DXGISwapChain::on_init')
+thread_local bool g_forced_frame_latency_waitable_object = false;
+
 #if RESHADE_ADDON
 static auto floating_point_to_rational(float value) -> DXGI_RATIONAL
 {
@@ -217,6 +221,19 @@ static void dump_and_modify_swapchain_desc(DXGI_SWAP_CHAIN_DESC &desc)
 #if RESHADE_ADDON
 	modify_swapchain_desc(desc);
 #endif
+
+	// Optionally force creation of a frame latency waitable swap chain, so that the swap chain proxy can wait for a presentation slot to become available before the application starts its next frame (see 'DXGISwapChain::Present')
+	// This only works for windowed flip model swap chains and prevents entering exclusive fullscreen mode
+	g_forced_frame_latency_waitable_object = false;
+	if ((desc.SwapEffect == DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL || desc.SwapEffect == DXGI_SWAP_EFFECT_FLIP_DISCARD) && desc.Windowed &&
+		(desc.Flags & DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT) == 0 &&
+		reshade::global_config().get("APP", "ForceWaitableSwapChain"))
+	{
+		desc.Flags |= DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+		g_forced_frame_latency_waitable_object = true;
+
+		reshade::log::message(reshade::log::level::info, "> Forcing frame latency waitable swap chain. This prevents exclusive fullscreen mode!");
+	}
 }
 static void dump_and_modify_swapchain_desc(DXGI_SWAP_CHAIN_DESC1 &desc, DXGI_SWAP_CHAIN_FULLSCREEN_DESC *fullscreen_desc = nullptr, [[maybe_unused]] HWND window = nullptr)
 {
@@ -253,6 +270,18 @@ static void dump_and_modify_swapchain_desc(DXGI_SWAP_CHAIN_DESC1 &desc, DXGI_SWA
 #if RESHADE_ADDON
 	modify_swapchain_desc(desc, fullscreen_desc, window);
 #endif
+
+	// See the 'DXGI_SWAP_CHAIN_DESC' overload above
+	g_forced_frame_latency_waitable_object = false;
+	if ((desc.SwapEffect == DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL || desc.SwapEffect == DXGI_SWAP_EFFECT_FLIP_DISCARD) && (fullscreen_desc == nullptr || fullscreen_desc->Windowed) &&
+		(desc.Flags & DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT) == 0 &&
+		reshade::global_config().get("APP", "ForceWaitableSwapChain"))
+	{
+		desc.Flags |= DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+		g_forced_frame_latency_waitable_object = true;
+
+		reshade::log::message(reshade::log::level::info, "> Forcing frame latency waitable swap chain. This prevents exclusive fullscreen mode!");
+	}
 }
 
 UINT query_device(IUnknown *&device, com_ptr<IUnknown> &device_proxy)
@@ -26,6 +26,9 @@ extern UINT query_device(IUnknown *&device, com_ptr<IUnknown> &device_proxy);
 // Needs to be set whenever a DXGI call can end up in 'CDXGISwapChain::EnsureChildDeviceInternal', to avoid hooking internal D3D device creation
 thread_local bool g_in_dxgi_runtime = false;
 
+// Set when the frame latency waitable object flag was forced onto a swap chain during creation (see 'dump_and_modify_swapchain_desc' in dxgi.cpp)
+extern thread_local bool g_forced_frame_latency_waitable_object;
+
 DXGISwapChain::DXGISwapChain(D3D10Device *device, IDXGISwapChain  *original) :
 	_orig(original),
 	_interface_version(0),
@@ -107,6 +110,9 @@ DXGISwapChain::~DXGISwapChain()
 	on_reset();
 	reshade::destroy_effect_runtime(_impl);
 
+	if (_frame_latency_waitable_object != nullptr)
+		CloseHandle(_frame_latency_waitable_object);
+
 	// Destroy effect runtime first to release all internal references to device objects
 	switch (_direct3d_version)
 	{
@@ -252,6 +258,11 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::Present(UINT SyncInterval, UINT Flags)
 
 	handle_device_loss(hr);
 
+	// Wait on the frame latency waitable object here, right before the application starts recording its next frame, so that CPU work only begins once a presentation slot is available
+	// This minimizes the latency between input sampling and presentation, compared to the default behavior of blocking inside 'IDXGISwapChain::Present' once the present queue is full
+	if (_frame_latency_waitable_object != nullptr && SUCCEEDED(hr) && (Flags & (DXGI_PRESENT_TEST | DXGI_PRESENT_DO_NOT_WAIT)) == 0)
+		WaitForSingleObjectEx(_frame_latency_waitable_object, 1000, TRUE);
+
 	return hr;
 }
 HRESULT STDMETHODCALLTYPE DXGISwapChain::GetBuffer(UINT Buffer, REFIID riid, void **ppSurface)
@@ -352,6 +363,10 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::ResizeBuffers(UINT BufferCount, UINT Wi
 	}
 #endif
 
+	// The frame latency waitable object flag cannot be added or removed after creation, so keep it set when it was forced onto this swap chain (the application does not know to pass it)
+	if (_frame_latency_waitable_object != nullptr)
+		SwapChainFlags |= DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+
 	g_in_dxgi_runtime = true;
 	const HRESULT hr = _orig->ResizeBuffers(BufferCount, Width, Height, NewFormat, SwapChainFlags);
 	g_in_dxgi_runtime = false;
@@ -428,6 +443,10 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::Present1(UINT SyncInterval, UINT Presen
 
 	handle_device_loss(hr);
 
+	// See 'DXGISwapChain::Present' above
+	if (_frame_latency_waitable_object != nullptr && SUCCEEDED(hr) && (PresentFlags & (DXGI_PRESENT_TEST | DXGI_PRESENT_DO_NOT_WAIT)) == 0)
+		WaitForSingleObjectEx(_frame_latency_waitable_object, 1000, TRUE);
+
 	return hr;
 }
 BOOL    STDMETHODCALLTYPE DXGISwapChain::IsTemporaryMonoSupported()
@@ -615,6 +634,10 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::ResizeBuffers1(UINT BufferCount, UINT W
 	}
 #endif
 
+	// See 'DXGISwapChain::ResizeBuffers' above
+	if (_frame_latency_waitable_object != nullptr)
+		SwapChainFlags |= DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+
 	// Need to extract the original command queue object from the proxies passed in
 	assert(ppPresentQueue != nullptr);
 	temp_mem<IUnknown *> present_queues(BufferCount);
@@ -700,6 +723,20 @@ void DXGISwapChain::on_init()
 {
 	assert(!_is_initialized);
 
+	// Take over waiting on the frame latency waitable object when that flag was forced onto this swap chain during creation
+	// The application is unaware of the flag in that case, so there is no risk of it waiting on the object as well (which would deadlock)
+	if (g_forced_frame_latency_waitable_object && _frame_latency_waitable_object == nullptr)
+	{
+		g_forced_frame_latency_waitable_object = false;
+
+		if (com_ptr<IDXGISwapChain2> swapchain2;
+			SUCCEEDED(_orig->QueryInterface(&swapchain2)))
+		{
+			swapchain2->SetMaximumFrameLatency(1);
+			_frame_latency_waitable_object = swapchain2->GetFrameLatencyWaitableObject();
+		}
+	}
+
 	const unique_direct3d_device_lock lock(_direct3d_device, _direct3d_version, _direct3d_version == 12 ? static_cast<D3D12CommandQueue *>(_direct3d_command_queue)->_mutex : _impl_mutex);
 
 #if RESHADE_ADDON
@@ -108,4 +108,6 @@ struct DECLSPEC_UUID("1F445F9F-9887-4C4C-9055-4E3BADAFCCA8") DXGISwapChain final
 	bool _is_initialized = false;
 	bool _was_still_drawing_last_frame = false;
 	BOOL _current_fullscreen_state = -1;
+	// Only non-null when the frame latency waitable object flag was forced onto this swap chain during creation, in which case waiting on it is handled in 'Present', since the application is unaware of its existence
+	HANDLE _frame_latency_waitable_object = nullptr;
 };
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2025 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <new>
+#include <memory> // std::unique_ptr
+#include <vector>
+#include <cstdint>
+#include <utility> // std::forward
+#include <type_traits> // std::is_trivially_destructible_v
+
+namespace reshadefx
+{
+	/// <summary>
+	/// A bump allocator that hands out memory from large chunks and releases it wholesale on destruction.
+	/// Groups the many short-lived allocations of a single effect compilation, so they do not contend on the global heap when many effects are compiled in parallel.
+	/// </summary>
+	class arena
+	{
+	public:
+		arena() = default;
+		arena(const arena &) = delete;
+		~arena()
+		{
+			// Destroy objects in reverse order of construction
+			for (auto it = _destructors.rbegin(); it != _destructors.rend(); ++it)
+				it->destroy(it->object);
+		}
+
+		arena &operator=(const arena &) = delete;
+
+		/// <summary>
+		/// Allocates uninitialized memory with the specified size and alignment from the current chunk, growing it as necessary.
+		/// </summary>
+		void *allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+		{
+			const size_t padding = (alignment - reinterpret_cast<uintptr_t>(_next) % alignment) % alignment;
+
+			if (padding + size > _remaining)
+			{
+				const size_t chunk_size = size > default_chunk_size ? size : default_chunk_size;
+				_chunks.push_back(std::make_unique<uint8_t[]>(chunk_size));
+				_next = _chunks.back().get();
+				_remaining = chunk_size;
+				return allocate(size, alignment);
+			}
+
+			uint8_t *const result = _next + padding;
+			_next = result + size;
+			_remaining -= padding + size;
+			return result;
+		}
+
+		/// <summary>
+		/// Constructs an object of the specified type in memory allocated from this arena.
+		/// The object is destroyed together with the arena, so the returned pointer must not outlive it.
+		/// </summary>
+		template <typename T, typename... Args>
+		T *construct(Args &&... args)
+		{
+			T *const object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+			if constexpr (!std::is_trivially_destructible_v<T>)
+				_destructors.push_back({ object, [](void *object) { static_cast<T *>(object)->~T(); } });
+			return object;
+		}
+
+	private:
+		static constexpr size_t default_chunk_size = 65536;
+
+		struct destructor_entry
+		{
+			void *object;
+			void (*destroy)(void *);
+		};
+
+		std::vector<std::unique_ptr<uint8_t[]>> _chunks;
+		std::vector<destructor_entry> _destructors;
+		uint8_t *_next = nullptr;
+		size_t _remaining = 0;
+	};
+}
@@ -0,0 +1,488 @@
+/*
+ * Copyright (C) 2025 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "effect_cache.hpp"
+#include "dll_log.hpp"
+#include <cstdio> // fclose, fread, fseek, ftell, fwrite
+#include <cstdint> // UINT16_MAX, UINT32_MAX
+#include <cstring> // std::memcpy
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <Windows.h>
+
+static constexpr uint32_t RECORD_MAGIC = 0x4B434652; // "RFCK"
+static constexpr uint32_t COMPRESSED_MAGIC = 0x5A434652; // "RFCZ"
+
+// Compact the packed cache file when at least this many bytes (and more than half of the file) are occupied by superseded records
+static constexpr uint64_t COMPACTION_THRESHOLD = 16 * 1024 * 1024;
+
+namespace
+{
+	struct record_header
+	{
+		uint32_t magic;
+		uint32_t key_size;
+		uint32_t data_size;
+	};
+
+	struct compressed_header
+	{
+		uint32_t magic;
+		uint32_t uncompressed_size;
+	};
+
+	struct packed_cache
+	{
+		~packed_cache()
+		{
+			if (view != nullptr)
+				UnmapViewOfFile(view);
+			if (mapping != nullptr)
+				CloseHandle(mapping);
+		}
+
+		std::mutex mutex;
+		std::filesystem::path file_path;
+		HANDLE mapping = nullptr;
+		const uint8_t *view = nullptr;
+		size_t view_size = 0;
+		// Maps entry keys to the offset and size of the most recent record with that key in the mapped view
+		std::unordered_map<std::string, std::pair<size_t, size_t>> index;
+		// Entries that were added after the file was mapped (these were appended to the file, but are not part of the view)
+		std::unordered_map<std::string, std::string> overlay;
+	};
+}
+
+static std::mutex s_packed_cache_mutex;
+static std::unordered_map<std::wstring, std::unique_ptr<packed_cache>> s_packed_caches;
+
+// Process-wide cache for effect runtimes that have the disk cache disabled (entries are keyed the same way as in the packed cache file)
+static std::mutex s_memory_cache_mutex;
+static std::unordered_map<std::string, std::string> s_memory_cache;
+
+// Compresses the entry data with a byte-oriented LZ77 scheme (token with literal and match length nibbles, optional length extension bytes, 16-bit match offsets), using a greedy hash table search
+// This is self-contained because no compression library is available in this code base, and entries (preprocessed source, shader byte code, disassembly) compress well even with a simple matcher
+static void compress_cache_entry(const std::string &data, std::string &compressed)
+{
+	compressed.clear();
+	if (data.size() < 64 || data.size() > UINT32_MAX)
+		return; // Very small entries are not worth compressing, so are stored uncompressed
+
+	const auto emit_length = [&compressed](size_t len) {
+		for (; len >= 255; len -= 255)
+			compressed.push_back(static_cast<char>(255));
+		compressed.push_back(static_cast<char>(len));
+	};
+	const auto read_value = [](const uint8_t *p) {
+		uint32_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	};
+
+	const uint8_t *const src = reinterpret_cast<const uint8_t *>(data.data());
+	const size_t size = data.size();
+
+	const compressed_header header = { COMPRESSED_MAGIC, static_cast<uint32_t>(size) };
+	compressed.reserve(sizeof(header) + size / 2);
+	compressed.append(reinterpret_cast<const char *>(&header), sizeof(header));
+
+	// Hash table mapping four-byte sequences to the most recent input position they occured at
+	std::vector<uint32_t> table(1 << 13);
+
+	size_t pos = 0, literal_start = 0;
+	while (pos + sizeof(uint32_t) * 3 < size)
+	{
+		const uint32_t value = read_value(src + pos);
+		const uint32_t hash = (value * 2654435761u) >> (32 - 13);
+		const size_t candidate = table[hash];
+		table[hash] = static_cast<uint32_t>(pos);
+
+		// Matches are limited to a 16-bit offset, so the decompressor only needs small offset fields
+		if (candidate >= pos || pos - candidate > UINT16_MAX || read_value(src + candidate) != value)
+		{
+			pos++;
+			continue;
+		}
+
+		size_t match_len = sizeof(uint32_t);
+		while (pos + match_len < size && src[candidate + match_len] == src[pos + match_len])
+			match_len++;
+
+		const size_t literal_len = pos - literal_start;
+		const size_t match_extra = match_len - sizeof(uint32_t);
+		compressed.push_back(static_cast<char>((literal_len < 15 ? literal_len : 15) << 4 | (match_extra < 15 ? match_extra : 15)));
+		if (literal_len >= 15)
+			emit_length(literal_len - 15);
+		compressed.append(reinterpret_cast<const char *>(src + literal_start), literal_len);
+		const uint16_t offset = static_cast<uint16_t>(pos - candidate);
+		compressed.append(reinterpret_cast<const char *>(&offset), sizeof(offset));
+		if (match_extra >= 15)
+			emit_length(match_extra - 15);
+
+		pos += match_len;
+		literal_start = pos;
+	}
+
+	// The final sequence consists of literals only and has no match part
+	const size_t literal_len = size - literal_start;
+	compressed.push_back(static_cast<char>((literal_len < 15 ? literal_len : 15) << 4));
+	if (literal_len >= 15)
+		emit_length(literal_len - 15);
+	compressed.append(reinterpret_cast<const char *>(src + literal_start), literal_len);
+
+	if (compressed.size() >= size)
+		compressed.clear(); // Store the entry uncompressed when compression did not shrink it
+}
+// Decompresses an entry previously written by <see cref="compress_cache_entry"/>, with bounds checking throughout so corrupt cache data results in a cache miss rather than invalid memory access
+static bool decompress_cache_entry(const uint8_t *src, size_t src_size, std::string &data)
+{
+	compressed_header header;
+	std::memcpy(&header, src, sizeof(header));
+
+	// Each compressed byte can expand to at most 255 output bytes, so reject a corrupt size field before reserving memory based on it
+	if (header.uncompressed_size / 255 > src_size)
+		return false;
+
+	data.clear();
+	data.reserve(header.uncompressed_size);
+
+	size_t pos = sizeof(header);
+	const auto read_length = [src, src_size, &pos](size_t &len) {
+		uint8_t value;
+		do
+		{
+			if (pos >= src_size)
+				return false;
+			value = src[pos++];
+			len += value;
+		} while (value == 255);
+		return true;
+	};
+
+	while (pos < src_size)
+	{
+		const uint8_t sequence = src[pos++];
+
+		size_t literal_len = sequence >> 4;
+		if (literal_len == 15 && !read_length(literal_len))
+			return false;
+		if (literal_len > src_size - pos)
+			return false;
+		data.append(reinterpret_cast<const char *>(src + pos), literal_len);
+		pos += literal_len;
+
+		if (pos == src_size)
+			break; // Reached the final literal-only sequence
+
+		uint16_t offset;
+		if (sizeof(offset) > src_size - pos)
+			return false;
+		std::memcpy(&offset, src + pos, sizeof(offset));
+		pos += sizeof(offset);
+
+		size_t match_len = (sequence & 0xF) + sizeof(uint32_t);
+		if ((sequence & 0xF) == 15 && !read_length(match_len))
+			return false;
+		if (offset == 0 || offset > data.size())
+			return false;
+
+		// Copy the match byte by byte, since it may overlap with the bytes just appended
+		const size_t match_pos = data.size() - offset;
+		for (size_t i = 0; i < match_len; ++i)
+			data.push_back(data[match_pos + i]);
+	}
+
+	return data.size() == header.uncompressed_size;
+}
+// Extracts the entry data from a cache record, transparently decompressing it if it was written compressed (entries written by previous versions are stored verbatim)
+static bool read_cache_entry(const uint8_t *record_data, size_t record_size, std::string &data)
+{
+	compressed_header header;
+	if (record_size >= sizeof(header) &&
+		(std::memcpy(&header, record_data, sizeof(header)), header.magic == COMPRESSED_MAGIC))
+		return decompress_cache_entry(record_data, record_size, data);
+
+	data.assign(reinterpret_cast<const char *>(record_data), record_size);
+	return true;
+}
+
+static bool map_packed_cache(packed_cache &cache)
+{
+	const HANDLE file = CreateFileW(cache.file_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false; // The cache file not existing yet is not an error, simply leave the index empty
+
+	LARGE_INTEGER file_size = {};
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	cache.mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file); // The mapping keeps its own reference to the file
+	if (cache.mapping == nullptr)
+		return false;
+
+	cache.view = static_cast<const uint8_t *>(MapViewOfFile(cache.mapping, FILE_MAP_READ, 0, 0, 0));
+	if (cache.view == nullptr)
+	{
+		CloseHandle(cache.mapping);
+		cache.mapping = nullptr;
+		return false;
+	}
+
+	cache.view_size = static_cast<size_t>(file_size.QuadPart);
+	return true;
+}
+static void unmap_packed_cache(packed_cache &cache)
+{
+	if (cache.view != nullptr)
+	{
+		UnmapViewOfFile(cache.view);
+		cache.view = nullptr;
+		cache.view_size = 0;
+	}
+	if (cache.mapping != nullptr)
+	{
+		CloseHandle(cache.mapping);
+		cache.mapping = nullptr;
+	}
+
+	cache.index.clear();
+}
+
+static uint64_t build_packed_cache_index(packed_cache &cache)
+{
+	uint64_t live_size = 0;
+
+	size_t offset = 0;
+	while (offset + sizeof(record_header) <= cache.view_size)
+	{
+		record_header header;
+		std::memcpy(&header, cache.view + offset, sizeof(header));
+
+		const size_t record_size = sizeof(header) + header.key_size + header.data_size;
+		// Stop at the first corrupt or truncated record (e.g. left behind by an interrupted write), everything before it is still usable
+		if (header.magic != RECORD_MAGIC || header.key_size == 0 || record_size > cache.view_size - offset)
+			break;
+
+		std::string key(reinterpret_cast<const char *>(cache.view + offset + sizeof(header)), header.key_size);
+
+		const auto [it, inserted] = cache.index.try_emplace(std::move(key), offset + record_size - header.data_size, header.data_size);
+		if (!inserted)
+		{
+			// A later record with the same key supersedes the earlier one
+			live_size -= sizeof(header) + it->first.size() + it->second.second;
+			it->second = std::make_pair(offset + record_size - header.data_size, static_cast<size_t>(header.data_size));
+		}
+
+		live_size += record_size;
+		offset += record_size;
+	}
+
+	return live_size;
+}
+
+static void compact_packed_cache(packed_cache &cache)
+{
+	std::filesystem::path temp_path = cache.file_path;
+	temp_path += L".tmp";
+
+	FILE *const file = _wfsopen(temp_path.c_str(), L"wb", SH_DENYRW);
+	if (file == nullptr)
+		return;
+
+	// Write only the most recent record for every key to the new file
+	bool success = true;
+	for (const std::pair<const std::string, std::pair<size_t, size_t>> &entry : cache.index)
+	{
+		const record_header header = { RECORD_MAGIC, static_cast<uint32_t>(entry.first.size()), static_cast<uint32_t>(entry.second.second) };
+
+		success = fwrite(&header, 1, sizeof(header), file) == sizeof(header) &&
+			fwrite(entry.first.data(), 1, entry.first.size(), file) == entry.first.size() &&
+			fwrite(cache.view + entry.second.first, 1, entry.second.second, file) == entry.second.second;
+		if (!success)
+			break;
+	}
+
+	fclose(file);
+
+	std::error_code ec;
+	if (success)
+	{
+		unmap_packed_cache(cache);
+		std::filesystem::rename(temp_path, cache.file_path, ec);
+	}
+
+	if (!success || ec)
+	{
+		std::filesystem::remove(temp_path, ec);
+		return;
+	}
+
+	// Map the compacted file again and rebuild the index with the new record offsets
+	if (map_packed_cache(cache))
+		build_packed_cache_index(cache);
+}
+
+static packed_cache &open_packed_cache(const std::filesystem::path &cache_path)
+{
+	std::filesystem::path file_path = cache_path / L"reshade-cache.pak";
+
+	const std::unique_lock<std::mutex> lock(s_packed_cache_mutex);
+
+	const auto it = s_packed_caches.find(file_path.native());
+	if (it != s_packed_caches.end())
+		return *it->second;
+
+	const auto cache = s_packed_caches.emplace(file_path.native(), std::make_unique<packed_cache>()).first->second.get();
+	cache->file_path = std::move(file_path);
+
+	if (map_packed_cache(*cache))
+	{
+		const uint64_t live_size = build_packed_cache_index(*cache);
+
+		// Garbage collect superseded records once they make up the majority of the file, so the cache does not grow unboundedly
+		const uint64_t wasted_size = cache->view_size - live_size;
+		if (wasted_size > COMPACTION_THRESHOLD && wasted_size * 2 > cache->view_size)
+			compact_packed_cache(*cache);
+	}
+
+	return *cache;
+}
+
+bool reshade::effect_cache::load(const std::filesystem::path &cache_path, const std::string &id, const std::string &type, std::string &data)
+{
+	packed_cache &cache = open_packed_cache(cache_path);
+	const std::string key = id + '.' + type;
+
+	{	const std::unique_lock<std::mutex> lock(cache.mutex);
+
+		if (const auto it = cache.overlay.find(key);
+			it != cache.overlay.end())
+		{
+			data = it->second;
+			return true;
+		}
+
+		if (const auto it = cache.index.find(key);
+			it != cache.index.end())
+			return read_cache_entry(cache.view + it->second.first, it->second.second, data);
+	}
+
+	// Fall back to the legacy per-entry cache files written by previous versions
+	std::filesystem::path path = cache_path;
+	path /= std::filesystem::u8path("reshade-" + key);
+
+	FILE *const file = _wfsopen(path.c_str(), L"rb", SH_DENYNO);
+	if (file == nullptr)
+		return false;
+
+	fseek(file, 0, SEEK_END);
+	const size_t file_size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	data.resize(file_size, '\0');
+	const size_t file_size_read = fread(data.data(), 1, data.size(), file);
+	fclose(file);
+
+	if (file_size_read != data.size())
+		return false;
+
+	// Migrate the entry to the packed cache file, so the next start does not have to open the legacy file again
+	save(cache_path, id, type, data);
+	return true;
+}
+bool reshade::effect_cache::save(const std::filesystem::path &cache_path, const std::string &id, const std::string &type, const std::string &data)
+{
+	packed_cache &cache = open_packed_cache(cache_path);
+	const std::string key = id + '.' + type;
+
+	// Compress the entry data to keep the cache file small (it is decompressed again transparently in 'load')
+	std::string compressed;
+	compress_cache_entry(data, compressed);
+	const std::string &record_data = !compressed.empty() ? compressed : data;
+
+	const record_header header = { RECORD_MAGIC, static_cast<uint32_t>(key.size()), static_cast<uint32_t>(record_data.size()) };
+
+	// Combine the record into a single buffer, so it can be appended with a single atomic write (other processes sharing this cache file may be appending concurrently)
+	std::string record;
+	record.reserve(sizeof(header) + key.size() + record_data.size());
+	record.append(reinterpret_cast<const char *>(&header), sizeof(header));
+	record.append(key);
+	record.append(record_data);
+
+	const HANDLE file = CreateFileW(cache.file_path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	DWORD size_written = 0;
+	const bool success = WriteFile(file, record.data(), static_cast<DWORD>(record.size()), &size_written, nullptr) && size_written == record.size();
+	CloseHandle(file);
+
+	if (!success)
+		return false;
+
+	// Also keep the entry in memory (uncompressed, so loads within this process do not have to decompress it again), since the mapped view does not cover records appended after it was created
+	const std::unique_lock<std::mutex> lock(cache.mutex);
+	cache.overlay[key] = data;
+	return true;
+}
+bool reshade::effect_cache::load_from_memory(const std::string &id, const std::string &type, std::string &data)
+{
+	const std::unique_lock<std::mutex> lock(s_memory_cache_mutex);
+
+	const auto it = s_memory_cache.find(id + '.' + type);
+	if (it == s_memory_cache.end())
+		return false;
+
+	data = it->second;
+	return true;
+}
+bool reshade::effect_cache::save_to_memory(const std::string &id, const std::string &type, const std::string &data)
+{
+	const std::unique_lock<std::mutex> lock(s_memory_cache_mutex);
+
+	s_memory_cache[id + '.' + type] = data;
+	return true;
+}
+void reshade::effect_cache::clear(const std::filesystem::path &cache_path)
+{
+	std::error_code ec;
+
+	{	const std::unique_lock<std::mutex> lock(s_memory_cache_mutex);
+
+		s_memory_cache.clear();
+	}
+
+	{	packed_cache &cache = open_packed_cache(cache_path);
+		const std::unique_lock<std::mutex> lock(cache.mutex);
+
+		unmap_packed_cache(cache);
+		cache.overlay.clear();
+
+		std::filesystem::remove(cache.file_path, ec);
+	}
+
+	// Find all legacy cached effect files and delete them as well
+	for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(cache_path, std::filesystem::directory_options::skip_permission_denied, ec))
+	{
+		if (entry.is_directory(ec))
+			continue;
+
+		const std::filesystem::path filename = entry.path().filename();
+		const std::filesystem::path extension = entry.path().extension();
+		if (filename.native().compare(0, 8, L"reshade-") != 0 || (extension != L".i" && extension != L".cso" && extension != L".asm" && extension != L".mod"))
+			continue;
+
+		std::filesystem::remove(entry, ec);
+	}
+
+	if (ec)
+		log::message(log::level::error, "Failed to clear effect cache directory with error code %d!", ec.value());
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2025 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <string>
+#include <filesystem>
+
+namespace reshade::effect_cache
+{
+	/// <summary>
+	/// Loads the cache entry with the specified <paramref name="id"/> and <paramref name="type"/> from the packed cache file in the specified directory.
+	/// The packed cache file is memory-mapped on first access, so repeated loads do not open any additional file handles. Entries that were saved compressed are decompressed transparently.
+	/// </summary>
+	/// <param name="cache_path">Path to the directory containing the packed cache file.</param>
+	/// <param name="id">Unique name of the cache entry.</param>
+	/// <param name="type">Type of the cache entry (e.g. "i", "cso" or "asm").</param>
+	/// <param name="data">Buffer that is filled with the contents of the cache entry.</param>
+	/// <returns><see langword="true"/> if the cache entry exists and was loaded successfully, <see langword="false"/> otherwise.</returns>
+	bool load(const std::filesystem::path &cache_path, const std::string &id, const std::string &type, std::string &data);
+	/// <summary>
+	/// Saves a cache entry with the specified <paramref name="id"/> and <paramref name="type"/> by appending it to the packed cache file in the specified directory.
+	/// The entry data is compressed with a fast self-contained codec when that shrinks it, to keep the cache file small.
+	/// </summary>
+	/// <param name="cache_path">Path to the directory containing the packed cache file.</param>
+	/// <param name="id">Unique name of the cache entry.</param>
+	/// <param name="type">Type of the cache entry (e.g. "i", "cso" or "asm").</param>
+	/// <param name="data">Contents of the cache entry.</param>
+	/// <returns><see langword="true"/> if the cache entry was saved successfully, <see langword="false"/> otherwise.</returns>
+	bool save(const std::filesystem::path &cache_path, const std::string &id, const std::string &type, const std::string &data);
+	/// <summary>
+	/// Loads the cache entry with the specified <paramref name="id"/> and <paramref name="type"/> from the process-wide in-memory cache.
+	/// This cache is shared between all effect runtime instances in the process, so that effects compiled for one swapchain can be reused for additional swapchains even while the disk cache is disabled.
+	/// </summary>
+	/// <param name="id">Unique name of the cache entry.</param>
+	/// <param name="type">Type of the cache entry (e.g. "i", "cso" or "asm").</param>
+	/// <param name="data">Buffer that is filled with the contents of the cache entry.</param>
+	/// <returns><see langword="true"/> if the cache entry exists, <see langword="false"/> otherwise.</returns>
+	bool load_from_memory(const std::string &id, const std::string &type, std::string &data);
+	/// <summary>
+	/// Stores a cache entry with the specified <paramref name="id"/> and <paramref name="type"/> in the process-wide in-memory cache.
+	/// </summary>
+	/// <param name="id">Unique name of the cache entry.</param>
+	/// <param name="type">Type of the cache entry (e.g. "i", "cso" or "asm").</param>
+	/// <param name="data">Contents of the cache entry.</param>
+	/// <returns><see langword="true"/> always, so this can substitute a call to <see cref="save"/>.</returns>
+	bool save_to_memory(const std::string &id, const std::string &type, const std::string &data);
+	/// <summary>
+	/// Deletes the packed cache file (and any legacy per-entry cache files) in the specified directory and empties the process-wide in-memory cache.
+	/// </summary>
+	/// <param name="cache_path">Path to the directory containing the packed cache file.</param>
+	void clear(const std::filesystem::path &cache_path);
+}
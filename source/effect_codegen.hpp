@@ -6,7 +6,7 @@
 #pragma once
 
 #include "effect_module.hpp"
-#include <memory> // std::unique_ptr
+#include "effect_arena.hpp"
 #include <algorithm> // std::find_if
 
 namespace reshadefx
@@ -357,14 +357,14 @@ namespace reshadefx
 		function &get_function(id id)
 		{
 			const auto it = std::find_if(_functions.begin(), _functions.end(),
-				[id](const std::unique_ptr<function> &info) { return info->id == id; });
-			return *it->get();
+				[id](const function *info) { return info->id == id; });
+			return **it;
 		}
 		function *find_function(const std::string &unique_name)
 		{
 			const auto it = std::find_if(_functions.begin(), _functions.end(),
-				[&unique_name](const std::unique_ptr<function> &info) { return info->unique_name == unique_name; });
-			return it != _functions.end() ? it->get() : nullptr;
+				[&unique_name](const function *info) { return info->unique_name == unique_name; });
+			return it != _functions.end() ? *it : nullptr;
 		}
 		const function *find_function(const std::string &unique_name) const
 		{
@@ -373,9 +373,70 @@ namespace reshadefx
 
 		id make_id() { return _next_id++; }
 
+		/// <summary>
+		/// Allocates space for a uniform variable in the global uniform buffer, filling padding holes left behind by previous allocations where possible, to minimize the overall uniform buffer size.
+		/// Only call this from back-ends that can emit explicit member offsets, since the resulting layout does not follow implicit packing rules.
+		/// </summary>
+		/// <param name="size">Size of the uniform variable in bytes.</param>
+		/// <param name="alignment">Base alignment of the uniform variable in bytes.</param>
+		/// <returns>Offset of the uniform variable in the uniform buffer.</returns>
+		uint32_t allocate_uniform_offset(uint32_t size, uint32_t alignment)
+		{
+			const auto adjust_offset = [size, alignment](uint32_t offset) {
+				offset = (offset + alignment - 1) & ~(alignment - 1);
+				// Ensure the data does not cross a 16-byte boundary, which constant buffer packing rules do not allow
+				const uint32_t remaining = 16 - (offset & 15);
+				if (remaining != 16 && size > remaining)
+					offset += remaining;
+				return offset;
+			};
+
+			for (auto it = _uniform_holes.begin(); it != _uniform_holes.end(); ++it)
+			{
+				const uint32_t offset = adjust_offset(it->offset);
+				const uint32_t hole_end = it->offset + it->size;
+				if (offset + size > hole_end)
+					continue;
+
+				// Return any space that was skipped over for alignment, as well as any remaining space at the end, back to the hole list
+				if (offset != it->offset)
+				{
+					it->size = offset - it->offset;
+					if (offset + size < hole_end)
+						_uniform_holes.insert(std::next(it), { offset + size, hole_end - (offset + size) });
+				}
+				else if (offset + size < hole_end)
+				{
+					*it = { offset + size, hole_end - (offset + size) };
+				}
+				else
+				{
+					_uniform_holes.erase(it);
+				}
+
+				return offset;
+			}
+
+			const uint32_t offset = adjust_offset(_module.total_uniform_size);
+			if (offset != _module.total_uniform_size)
+				_uniform_holes.push_back({ _module.total_uniform_size, offset - _module.total_uniform_size });
+			_module.total_uniform_size = offset + size;
+			return offset;
+		}
+
+		// Padding area in the uniform buffer that future allocations in <see cref="allocate_uniform_offset"/> may still fill
+		struct uniform_hole
+		{
+			uint32_t offset;
+			uint32_t size;
+		};
+
 		effect_module _module;
+		std::vector<uniform_hole> _uniform_holes;
+		// Arena all function definitions (and any other allocations tied to the lifetime of this compilation) are allocated from, so they are released wholesale with this code generator
+		arena _arena;
 		std::vector<struct_type> _structs;
-		std::vector<std::unique_ptr<function>> _functions;
+		std::vector<function *> _functions;
 
 		id _next_id = 1;
 		id _last_block = 0;
@@ -407,5 +468,6 @@ namespace reshadefx
 	/// <param name="uniforms_to_spec_constants">Whether to convert uniform variables to specialization constants.</param>
 	/// <param name="enable_16bit_types">Use real 16-bit types for the minimum precision types "min16int", "min16uint" and "min16float".</param>
 	/// <param name="flip_vert_y">Insert code to flip the Y component of the output position in vertex shaders.</param>
-	codegen *create_codegen_spirv(bool vulkan_semantics, bool debug_info, bool uniforms_to_spec_constants, bool enable_16bit_types = false, bool flip_vert_y = false);
+	/// <param name="relaxed_precision">Automatically decorate operations on values originating from texture reads with "RelaxedPrecision", so that drivers may evaluate them at 16-bit precision.</param>
+	codegen *create_codegen_spirv(bool vulkan_semantics, bool debug_info, bool uniforms_to_spec_constants, bool enable_16bit_types = false, bool flip_vert_y = false, bool relaxed_precision = false);
 }
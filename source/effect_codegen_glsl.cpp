@@ -132,6 +132,20 @@ private:
 	{
 		std::string code = finalize_preamble();
 
+		// Gather the total output size up front, so that appending the blocks below only allocates once
+		size_t total_size = code.size() + _blocks.at(0).size();
+		for (const sampler &info : _module.samplers)
+			total_size += _blocks.at(info.id).size();
+		for (const storage &info : _module.storages)
+			total_size += _blocks.at(info.id).size();
+		for (const function *const func : _functions)
+		{
+			total_size += _blocks.at(func->id).size();
+			if (func->unique_name[0] == 'E')
+				total_size += 7 + func->unique_name.size() + 1 + 7; // "#ifdef " and "#endif\n" guards added below
+		}
+		code.reserve(total_size);
+
 		// Add sampler definitions
 		for (const sampler &info : _module.samplers)
 			code += _blocks.at(info.id);
@@ -144,7 +158,7 @@ private:
 		code += _blocks.at(0);
 
 		// Add function definitions
-		for (const std::unique_ptr<function> &func : _functions)
+		for (const function *const func : _functions)
 		{
 			assert(func->unique_name[0] == 'F' || func->unique_name[0] == 'E');
 			const bool is_entry_point = func->unique_name[0] == 'E';
@@ -200,6 +214,20 @@ private:
 				code.replace(beg, end - beg, std::to_string(binding));
 			};
 
+		// Gather the approximate total output size up front, so that appending the blocks below does not have to reallocate repeatedly (the binding replacement may still alter the size slightly)
+		size_t total_size = code.size() + _blocks.at(0).size();
+		for (const id block : entry_point->referenced_samplers)
+			if (block != 0)
+				total_size += _blocks.at(block).size();
+		for (const id block : entry_point->referenced_storages)
+			if (block != 0)
+				total_size += _blocks.at(block).size();
+		for (const function *const func : _functions)
+			if (func->id == entry_point->id ||
+				std::find(entry_point->referenced_functions.begin(), entry_point->referenced_functions.end(), func->id) != entry_point->referenced_functions.end())
+				total_size += _blocks.at(func->id).size();
+		code.reserve(total_size);
+
 		// Add referenced sampler definitions
 		for (uint32_t binding = 0; binding < entry_point->referenced_samplers.size(); ++binding)
 		{
@@ -226,7 +254,7 @@ private:
 		code += _blocks.at(0);
 
 		// Add referenced function definitions
-		for (const std::unique_ptr<function> &func : _functions)
+		for (const function *const func : _functions)
 		{
 			if (func->id != entry_point->id &&
 				std::find(entry_point->referenced_functions.begin(), entry_point->referenced_functions.end(), func->id) == entry_point->referenced_functions.end())
@@ -949,8 +977,7 @@ private:
 
 		code += ")\n";
 
-		_functions.push_back(std::make_unique<function>(info));
-		_current_function = _functions.back().get();
+		_current_function = _functions.emplace_back(_arena.construct<function>(info));
 
 		return res;
 	}
@@ -1613,7 +1640,7 @@ private:
 					});
 				it != _constant_lookup.end())
 				return std::get<2>(*it); // Reuse existing constant instead of duplicating the definition
-			else if (data_type.is_array())
+			else
 				_constant_lookup.push_back({ data_type, data, res });
 
 			// Put constant variable into global scope, so that it can be reused in different blocks
@@ -2321,7 +2348,14 @@ private:
 	{
 		assert(_current_function != nullptr && _last_block != 0);
 
-		_blocks.emplace(_current_function->id, _current_function_declaration + "{\n" + _blocks.at(_last_block) + "}\n");
+		// Assemble the function block by moving the declaration into place and appending the body with the final size reserved, to avoid the extra copies a chained string concatenation would make
+		const std::string &body = _blocks.at(_last_block);
+		std::string &block = _blocks[_current_function->id];
+		block = std::move(_current_function_declaration);
+		block.reserve(block.size() + 2 + body.size() + 2);
+		block += "{\n";
+		block += body;
+		block += "}\n";
 
 		_current_function = nullptr;
 		_current_function_declaration.clear();
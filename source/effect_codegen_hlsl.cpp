@@ -278,6 +278,16 @@ private:
 	{
 		std::string code = finalize_preamble();
 
+		// Gather the total output size up front, so that appending the blocks below only allocates once
+		size_t total_size = code.size() + _blocks.at(0).size();
+		for (const sampler &info : _module.samplers)
+			total_size += _blocks.at(info.id).size();
+		for (const storage &info : _module.storages)
+			total_size += _blocks.at(info.id).size();
+		for (const function *const func : _functions)
+			total_size += _blocks.at(func->id).size();
+		code.reserve(total_size);
+
 		// Add global definitions (struct types, global variables, sampler state declarations, ...)
 		code += _blocks.at(0);
 
@@ -290,7 +300,7 @@ private:
 			code += _blocks.at(info.id);
 
 		// Add function definitions
-		for (const std::unique_ptr<function> &func : _functions)
+		for (const function *const func : _functions)
 			code += _blocks.at(func->id);
 
 		return code;
@@ -307,6 +317,20 @@ private:
 			// Overwrite position semantic in pixel shaders
 			code += "#define POSITION VPOS\n";
 
+		// Gather the approximate total output size up front, so that appending the blocks below does not have to reallocate repeatedly (the binding replacement may still alter the size slightly)
+		size_t total_size = code.size() + _blocks.at(0).size();
+		for (const id block : entry_point->referenced_samplers)
+			if (block != 0)
+				total_size += _blocks.at(block).size();
+		for (const id block : entry_point->referenced_storages)
+			if (block != 0)
+				total_size += _blocks.at(block).size();
+		for (const function *const func : _functions)
+			if (func->id == entry_point->id ||
+				std::find(entry_point->referenced_functions.begin(), entry_point->referenced_functions.end(), func->id) != entry_point->referenced_functions.end())
+				total_size += _blocks.at(func->id).size();
+		code.reserve(total_size);
+
 		// Add global definitions (struct types, global variables, sampler state declarations, ...)
 		code += _blocks.at(0);
 
@@ -340,7 +364,7 @@ private:
 		}
 
 		// Add referenced function definitions
-		for (const std::unique_ptr<function> &func : _functions)
+		for (const function *const func : _functions)
 		{
 			if (func->id != entry_point->id &&
 				std::find(entry_point->referenced_functions.begin(), entry_point->referenced_functions.end(), func->id) == entry_point->referenced_functions.end())
@@ -962,17 +986,24 @@ private:
 			if (info.type.is_array())
 				info.size = align_up(info.size, 16, info.type.array_length);
 
-			if (_shader_model < 40)
+			if (_shader_model >= 40)
+			{
+				// Matrices and arrays have to start on a 16-byte boundary, everything else is only packed into 4-byte boundaries (see https://docs.microsoft.com/windows/win32/direct3dhlsl/dx-graphics-hlsl-packing-rules)
+				// The chosen offset is communicated to the compiler via a "packoffset" modifier below, so padding holes left by these alignment rules can be filled by later uniforms
+				info.offset = allocate_uniform_offset(info.size, info.type.is_matrix() || info.type.is_array() ? 16 : 4);
+			}
+			else
+			{
 				_module.total_uniform_size /= 4;
 
-			// Data is packed into 4-byte boundaries (see https://docs.microsoft.com/windows/win32/direct3dhlsl/dx-graphics-hlsl-packing-rules)
-			// This is already guaranteed, since all types are at least 4-byte in size
-			info.offset = _module.total_uniform_size;
-			// Additionally, HLSL packs data so that it does not cross a 16-byte boundary
-			const uint32_t remaining = 16 - (info.offset & 15);
-			if (remaining != 16 && info.size > remaining)
-				info.offset += remaining;
-			_module.total_uniform_size = info.offset + info.size;
+				// Constant registers cannot be addressed with an explicit offset, so pack sequentially in declaration order
+				info.offset = _module.total_uniform_size;
+				// HLSL packs data so that it does not cross a 16-byte boundary
+				const uint32_t remaining = 16 - (info.offset & 15);
+				if (remaining != 16 && info.size > remaining)
+					info.offset += remaining;
+				_module.total_uniform_size = info.offset + info.size;
+			}
 
 			write_location<true>(_cbuffer_block, loc);
 
@@ -1005,6 +1036,17 @@ private:
 				// Note: All uniforms are floating-point in shader model 3, even if the uniform type says different!!
 				_cbuffer_block += " : register(c" + std::to_string(info.offset / 16) + ')';
 			}
+			else
+			{
+				// Pin the member to the offset chosen above (when "packoffset" is used on one member of a constant buffer it has to be used on all of them)
+				_cbuffer_block += " : packoffset(c" + std::to_string(info.offset / 16);
+				if ((info.offset & 15) != 0)
+				{
+					_cbuffer_block += '.';
+					_cbuffer_block += "xyzw"[(info.offset & 15) / 4];
+				}
+				_cbuffer_block += ')';
+			}
 
 			_cbuffer_block += ";\n";
 
@@ -1092,8 +1134,7 @@ private:
 
 		code += '\n';
 
-		_functions.push_back(std::make_unique<function>(info));
-		_current_function = _functions.back().get();
+		_current_function = _functions.emplace_back(_arena.construct<function>(info));
 
 		return res;
 	}
@@ -2106,7 +2147,14 @@ private:
 	{
 		assert(_current_function != nullptr && _last_block != 0);
 
-		_blocks.emplace(_current_function->id, _current_function_declaration + "{\n" + _blocks.at(_last_block) + "}\n");
+		// Assemble the function block by moving the declaration into place and appending the body with the final size reserved, to avoid the extra copies a chained string concatenation would make
+		const std::string &body = _blocks.at(_last_block);
+		std::string &block = _blocks[_current_function->id];
+		block = std::move(_current_function_declaration);
+		block.reserve(block.size() + 2 + body.size() + 2);
+		block += "{\n";
+		block += body;
+		block += "}\n";
 
 		_current_function = nullptr;
 		_current_function_declaration.clear();
@@ -8,6 +8,7 @@
 #include <cassert>
 #include <cstring> // std::memcmp
 #include <charconv> // std::from_chars
+#include <iterator> // std::make_move_iterator
 #include <algorithm> // std::find_if, std::max, std::sort
 #include <unordered_set>
 
@@ -131,6 +132,18 @@ struct spirv_basic_block
 	{
 		instructions.insert(instructions.end(), block.instructions.begin(), block.instructions.end());
 	}
+	/// <summary>
+	/// Append another basic block the end of this one, leaving the appended block empty.
+	/// This avoids copying the operand vector of every appended instruction, which adds up over the repeated merges nested control flow performs.
+	/// </summary>
+	void append(spirv_basic_block &&block)
+	{
+		if (instructions.empty())
+			instructions = std::move(block.instructions);
+		else
+			instructions.insert(instructions.end(), std::make_move_iterator(block.instructions.begin()), std::make_move_iterator(block.instructions.end()));
+		block.instructions.clear();
+	}
 };
 
 class codegen_spirv final : public codegen
@@ -138,12 +151,13 @@ class codegen_spirv final : public codegen
 	static_assert(sizeof(id) == sizeof(spv::Id), "unexpected SPIR-V id type size");
 
 public:
-	codegen_spirv(bool vulkan_semantics, bool debug_info, bool uniforms_to_spec_constants, bool enable_16bit_types, bool flip_vert_y) :
+	codegen_spirv(bool vulkan_semantics, bool debug_info, bool uniforms_to_spec_constants, bool enable_16bit_types, bool flip_vert_y, bool relaxed_precision) :
 		_debug_info(debug_info),
 		_vulkan_semantics(vulkan_semantics),
 		_uniforms_to_spec_constants(uniforms_to_spec_constants),
 		_enable_16bit_types(enable_16bit_types),
-		_flip_vert_y(flip_vert_y)
+		_flip_vert_y(flip_vert_y),
+		_relaxed_precision(relaxed_precision)
 	{
 		_glsl_ext = make_id();
 	}
@@ -185,6 +199,7 @@ private:
 	bool _uniforms_to_spec_constants = false;
 	bool _enable_16bit_types = false;
 	bool _flip_vert_y = false;
+	bool _relaxed_precision = false;
 
 	spirv_basic_block _entries;
 	spirv_basic_block _execution_modes;
@@ -214,6 +229,13 @@ private:
 	std::unordered_set<spv::Id> _spec_constants;
 	std::unordered_set<spv::Capability> _capabilities;
 
+	// Only used when automatic relaxed precision propagation is enabled (see 'make_relaxed_precision' below)
+	std::unordered_set<spv::Id> _relaxed_ids;
+	std::unordered_set<spv::Id> _constant_ids;
+	std::unordered_set<spv::Id> _full_precision_variables;
+	std::unordered_map<spv::Id, std::unordered_set<spv::Id>> _relaxed_origins;
+	std::unordered_map<spv::Id, std::vector<spv::Id>> _dependent_relaxed_ids;
+
 	void add_location(const location &loc, spirv_basic_block &block)
 	{
 		if (loc.source.empty() || !_debug_info)
@@ -335,9 +357,27 @@ private:
 			.write(spirv);
 	}
 
+	static size_t block_word_count(const spirv_basic_block &block)
+	{
+		size_t words = 0;
+		for (const spirv_instruction &inst : block.instructions)
+			words += 1 + (inst.type != 0) + (inst.result != 0) + inst.operands.size();
+		return words;
+	}
+
 	std::basic_string<char> finalize_code() const override
 	{
+		// Gather the approximate module size up front, so that writing out the instructions below does not have to reallocate repeatedly
+		size_t total_words = 64 + _capabilities.size() * 2 + _global_ubo_types.size(); // Small constant covering the header and the fixed instructions written by the finalize helpers
+		total_words += block_word_count(_entries) + block_word_count(_execution_modes);
+		if (_debug_info)
+			total_words += block_word_count(_debug_a) + block_word_count(_debug_b);
+		total_words += block_word_count(_annotations) + block_word_count(_types_and_constants) + block_word_count(_variables);
+		for (const function_blocks &func : _functions_blocks)
+			total_words += block_word_count(func.declaration) + block_word_count(func.variables) + block_word_count(func.definition);
+
 		std::basic_string<char> spirv;
+		spirv.reserve(total_words * sizeof(uint32_t));
 		finalize_header_section(spirv);
 
 		// All entry point declarations
@@ -887,6 +927,73 @@ private:
 			.add(decoration)
 			.add(values.begin(), values.end());
 	}
+	void remove_decoration(id id, spv::Decoration decoration)
+	{
+		std::vector<spirv_instruction> &instructions = _annotations.instructions;
+		const auto it = std::find_if(instructions.begin(), instructions.end(),
+			[id, decoration](const spirv_instruction &inst) {
+				return inst.op == spv::OpDecorate && inst.operands[0] == id && inst.operands[1] == static_cast<uint32_t>(decoration);
+			});
+		if (it != instructions.end())
+			instructions.erase(it);
+	}
+	bool has_relaxed_precision(id id) const
+	{
+		return _relaxed_ids.find(id) != _relaxed_ids.end();
+	}
+	// Constants adapt to the precision of the operation consuming them, so they do not prevent that operation from being relaxed, but cannot seed relaxation on their own either
+	bool allows_relaxed_precision(id id) const
+	{
+		return has_relaxed_precision(id) || _constant_ids.find(id) != _constant_ids.end();
+	}
+	// Decorates an operation result known to carry low bit depth color data with 'RelaxedPrecision', so that drivers may evaluate it at 16-bit precision
+	// This is seeded at texture reads in 'emit_call_intrinsic' and conservatively propagated through floating-point operations whose operands all carry such data (coordinate and other full precision math is left untouched)
+	void make_relaxed_precision(id id, std::initializer_list<spv::Id> sources = {})
+	{
+		add_decoration(id, spv::DecorationRelaxedPrecision);
+		_relaxed_ids.insert(id);
+
+		for (const spv::Id source : sources)
+			inherit_relaxed_origins(id, source);
+	}
+	// Ties the relaxed precision status of a result to all the variables a source value was derived from, so that the decoration can be stripped again should one of them later turn out to be full precision (see 'make_full_precision' below)
+	void inherit_relaxed_origins(id id, spv::Id source)
+	{
+		const auto it = _relaxed_origins.find(source);
+		if (it == _relaxed_origins.end())
+			return;
+
+		// Copy the source set, since adding entries below may rehash the map and invalidate the iterator
+		const std::unordered_set<spv::Id> variables = it->second;
+		for (const spv::Id variable : variables)
+			if (_relaxed_origins[id].insert(variable).second)
+				_dependent_relaxed_ids[variable].push_back(id);
+	}
+	// Forces a variable to full precision and strips the decoration from every result whose relaxed precision status depended on loads of it
+	// This leaves the module as if the full precision store that triggered this had already been known when those loads were emitted, which keeps the propagation sound when a loop back edge makes a store reach a load emitted earlier
+	void make_full_precision(id variable)
+	{
+		if (!_full_precision_variables.insert(variable).second)
+			return;
+		_relaxed_ids.erase(variable);
+
+		const auto it = _dependent_relaxed_ids.find(variable);
+		if (it == _dependent_relaxed_ids.end())
+			return;
+		const std::vector<spv::Id> dependents = std::move(it->second);
+		_dependent_relaxed_ids.erase(it);
+
+		for (const spv::Id dependent : dependents)
+		{
+			if (_relaxed_ids.erase(dependent) == 0)
+				continue; // Was already stripped through another variable
+
+			remove_decoration(dependent, spv::DecorationRelaxedPrecision); // This does nothing for variables, which are never decorated themselves (see 'emit_store')
+
+			// A dependent may itself be a variable that was only marked relaxed because of values derived from this one, so continue stripping transitively
+			make_full_precision(dependent);
+		}
+	}
 	void add_member_name(id id, uint32_t member_index, const char *name)
 	{
 		if (!_debug_info)
@@ -1100,9 +1207,8 @@ private:
 				info.size = array_stride * info.type.array_length;
 			}
 
-			info.offset = _module.total_uniform_size;
-			info.offset = align_up(info.offset, alignment);
-			_module.total_uniform_size = info.offset + info.size;
+			// Members of the uniform buffer block get explicit offset decorations, so padding holes left by the alignment rules can be filled by later uniforms
+			info.offset = allocate_uniform_offset(info.size, alignment);
 
 			type ubo_type = info.type;
 			// Convert boolean uniform variables to integer type so that they have a defined size
@@ -1213,8 +1319,7 @@ private:
 			add_name(param.id, param.name.c_str());
 		}
 
-		_functions.push_back(std::make_unique<function>(info));
-		_current_function = _functions.back().get();
+		_current_function = _functions.emplace_back(_arena.construct<function>(info));
 		_current_function_blocks = &func;
 
 		return res;
@@ -1826,12 +1931,26 @@ private:
 			}
 		}
 
+		// Swizzles and other operations on a relaxed precision value stay relaxed, as do loads from variables that were only ever assigned such values (see 'emit_store' below)
+		if (_relaxed_precision && result != exp.base && exp.type.is_floating_point() && has_relaxed_precision(exp.base))
+		{
+			make_relaxed_precision(result, { exp.base });
+
+			// A load from a variable may additionally be reached by a store that is only emitted later (via a loop back edge), so remember it, in case the variable turns out to be full precision after all
+			if (exp.is_lvalue && _relaxed_origins[result].insert(exp.base).second)
+				_dependent_relaxed_ids[exp.base].push_back(result);
+		}
+
 		return result;
 	}
 	void emit_store(const expression &exp, id value) override
 	{
 		assert(value != 0 && exp.is_lvalue && !exp.is_constant && !exp.type.is_sampler());
 
+		// Evaluate before the access chain handling below, since that can replace 'value' with a merged composite
+		const bool relaxed_value = _relaxed_precision && exp.type.is_floating_point() && has_relaxed_precision(value);
+		const bool constant_value = _relaxed_precision && _constant_ids.find(value) != _constant_ids.end();
+
 		add_location(exp.location, *_current_block_data);
 
 		size_t i = 0;
@@ -1910,6 +2029,26 @@ private:
 		add_instruction_without_result(spv::OpStore)
 			.add(target)
 			.add(value);
+
+		// Keep track of variables that are only ever assigned relaxed precision values, so that loads from them can be relaxed as well
+		// Any other non-constant assignment permanently forces the variable to full precision, even retroactively, since a loop back edge may make this store reach a load that was already emitted
+		if (_relaxed_precision && exp.type.is_floating_point())
+		{
+			if (relaxed_value)
+			{
+				if (exp.chain.empty() && _full_precision_variables.find(exp.base) == _full_precision_variables.end())
+				{
+					_relaxed_ids.insert(exp.base); // Do not decorate the variable itself, only the loads from it
+
+					// The relaxed precision status of this variable now also depends on all the variables the stored value was derived from
+					inherit_relaxed_origins(exp.base, value);
+				}
+			}
+			else if (!constant_value)
+			{
+				make_full_precision(exp.base);
+			}
+		}
 	}
 	id   emit_access_chain(const expression &exp, size_t &i) override
 	{
@@ -2055,6 +2194,9 @@ private:
 		else
 			_constant_lookup.push_back({ data_type, data, result });
 
+		if (_relaxed_precision && !spec_constant)
+			_constant_ids.insert(result);
+
 		return result;
 	}
 
@@ -2082,6 +2224,9 @@ private:
 		spirv_instruction &inst = add_instruction(spv_op, convert_type(res_type));
 		inst.add(val); // Operand
 
+		if (_relaxed_precision && res_type.is_floating_point() && has_relaxed_precision(val))
+			make_relaxed_precision(inst, { val });
+
 		return inst;
 	}
 	id   emit_binary_op(const location &loc, tokenid op, const type &res_type, const type &exp_type, id lhs, id rhs) override
@@ -2202,6 +2347,10 @@ private:
 			spirv_instruction &inst = add_instruction(spv::OpCompositeConstruct, convert_type(res_type));
 			inst.add(ids.begin(), ids.end());
 
+			if (_relaxed_precision && res_type.is_floating_point() &&
+				(has_relaxed_precision(lhs) || has_relaxed_precision(rhs)) && allows_relaxed_precision(lhs) && allows_relaxed_precision(rhs))
+				make_relaxed_precision(inst, { lhs, rhs });
+
 			return inst;
 		}
 		else
@@ -2215,6 +2364,11 @@ private:
 			if (!_enable_16bit_types && res_type.precision() < 32)
 				add_decoration(inst, spv::DecorationRelaxedPrecision);
 
+			// Comparison results are excluded implicitly, since their result type is boolean
+			if (_relaxed_precision && res_type.is_floating_point() &&
+				(has_relaxed_precision(lhs) || has_relaxed_precision(rhs)) && allows_relaxed_precision(lhs) && allows_relaxed_precision(rhs))
+				make_relaxed_precision(inst, { lhs, rhs });
+
 			return inst;
 		}
 	}
@@ -2230,6 +2384,10 @@ private:
 		inst.add(true_value); // Object 1
 		inst.add(false_value); // Object 2
 
+		if (_relaxed_precision && res_type.is_floating_point() &&
+			(has_relaxed_precision(true_value) || has_relaxed_precision(false_value)) && allows_relaxed_precision(true_value) && allows_relaxed_precision(false_value))
+			make_relaxed_precision(inst, { true_value, false_value });
+
 		return inst;
 	}
 	id   emit_call(const location &loc, id function, const type &res_type, const std::vector<expression> &args) override
@@ -2262,13 +2420,51 @@ private:
 			#include "effect_symbol_table_intrinsics.inl"
 		};
 
-		switch (intrinsic)
+		const id res = [&]() -> id {
+			switch (intrinsic)
+			{
+			#define IMPLEMENT_INTRINSIC_SPIRV(name, i, code) case name##i: code
+				#include "effect_symbol_table_intrinsics.inl"
+			default:
+				return assert(false), 0;
+			}
+		}();
+
+		if (_relaxed_precision && res != 0 && res_type.is_floating_point())
 		{
-		#define IMPLEMENT_INTRINSIC_SPIRV(name, i, code) case name##i: code
-			#include "effect_symbol_table_intrinsics.inl"
-		default:
-			return assert(false), 0;
+			// Texture reads return low bit depth color data, so they seed the relaxed precision propagation
+			if (!args.empty() && args[0].type.is_sampler())
+			{
+				make_relaxed_precision(res);
+			}
+			else
+			{
+				// Otherwise propagate through the intrinsic like through any other operation, when all floating-point arguments carry relaxed precision data
+				bool relaxed = false;
+				for (const expression &arg : args)
+				{
+					if (!arg.type.is_floating_point())
+						continue;
+					if (has_relaxed_precision(arg.base))
+						relaxed = true;
+					else if (!allows_relaxed_precision(arg.base))
+					{
+						relaxed = false;
+						break;
+					}
+				}
+
+				if (relaxed)
+				{
+					make_relaxed_precision(res);
+
+					for (const expression &arg : args)
+						inherit_relaxed_origins(res, arg.base);
+				}
+			}
 		}
+
+		return res;
 	}
 	id   emit_construct(const location &loc, const type &res_type, const std::vector<expression> &args) override
 	{
@@ -2310,6 +2506,29 @@ private:
 		spirv_instruction &inst = add_instruction(spv::OpCompositeConstruct, convert_type(res_type));
 		inst.add(ids.begin(), ids.end());
 
+		if (_relaxed_precision && res_type.is_floating_point())
+		{
+			bool relaxed = false;
+			for (const expression &arg : args)
+			{
+				if (has_relaxed_precision(arg.base))
+					relaxed = true;
+				else if (!allows_relaxed_precision(arg.base))
+				{
+					relaxed = false;
+					break;
+				}
+			}
+
+			if (relaxed)
+			{
+				make_relaxed_precision(inst);
+
+				for (const expression &arg : args)
+					inherit_relaxed_origins(inst, arg.base);
+			}
+		}
+
 		return inst;
 	}
 
@@ -2320,7 +2539,7 @@ private:
 		_current_block_data->instructions.pop_back();
 
 		// Add previous block containing the condition value first
-		_current_block_data->append(_block_data[condition_block]);
+		_current_block_data->append(std::move(_block_data[condition_block]));
 
 		spirv_instruction branch_inst = _current_block_data->instructions.back();
 		assert(branch_inst.op == spv::OpBranchConditional);
@@ -2334,8 +2553,8 @@ private:
 
 		// Append all blocks belonging to the branch
 		_current_block_data->instructions.push_back(branch_inst);
-		_current_block_data->append(_block_data[true_statement_block]);
-		_current_block_data->append(_block_data[false_statement_block]);
+		_current_block_data->append(std::move(_block_data[true_statement_block]));
+		_current_block_data->append(std::move(_block_data[false_statement_block]));
 
 		_current_block_data->instructions.push_back(merge_label);
 	}
@@ -2346,12 +2565,12 @@ private:
 		_current_block_data->instructions.pop_back();
 
 		// Add previous block containing the condition value first
-		_current_block_data->append(_block_data[condition_block]);
+		_current_block_data->append(std::move(_block_data[condition_block]));
 
 		if (true_statement_block != condition_block)
-			_current_block_data->append(_block_data[true_statement_block]);
+			_current_block_data->append(std::move(_block_data[true_statement_block]));
 		if (false_statement_block != condition_block)
-			_current_block_data->append(_block_data[false_statement_block]);
+			_current_block_data->append(std::move(_block_data[false_statement_block]));
 
 		_current_block_data->instructions.push_back(merge_label);
 
@@ -2364,6 +2583,10 @@ private:
 			.add(false_value) // Variable 1
 			.add(false_statement_block); // Parent 1
 
+		if (_relaxed_precision && res_type.is_floating_point() &&
+			(has_relaxed_precision(true_value) || has_relaxed_precision(false_value)) && allows_relaxed_precision(true_value) && allows_relaxed_precision(false_value))
+			make_relaxed_precision(inst, { true_value, false_value });
+
 		return inst;
 	}
 	void emit_loop(const location &loc, id, id prev_block, id header_block, id condition_block, id loop_block, id continue_block, unsigned int loop_control) override
@@ -2373,7 +2596,7 @@ private:
 		_current_block_data->instructions.pop_back();
 
 		// Add previous block first
-		_current_block_data->append(_block_data[prev_block]);
+		_current_block_data->append(std::move(_block_data[prev_block]));
 
 		// Fill header block
 		assert(_block_data[header_block].instructions.size() == 2);
@@ -2392,11 +2615,11 @@ private:
 
 		// Add condition block if it exists
 		if (condition_block != 0)
-			_current_block_data->append(_block_data[condition_block]);
+			_current_block_data->append(std::move(_block_data[condition_block]));
 
 		// Append loop body block before continue block
-		_current_block_data->append(_block_data[loop_block]);
-		_current_block_data->append(_block_data[continue_block]);
+		_current_block_data->append(std::move(_block_data[loop_block]));
+		_current_block_data->append(std::move(_block_data[continue_block]));
 
 		_current_block_data->instructions.push_back(merge_label);
 	}
@@ -2409,7 +2632,7 @@ private:
 		_current_block_data->instructions.pop_back();
 
 		// Add previous block containing the selector value first
-		_current_block_data->append(_block_data[selector_block]);
+		_current_block_data->append(std::move(_block_data[selector_block]));
 
 		spirv_instruction switch_inst = _current_block_data->instructions.back();
 		assert(switch_inst.op == spv::OpSwitch);
@@ -2435,7 +2658,7 @@ private:
 		std::sort(blocks.begin(), blocks.end());
 		blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
 		for (const id case_block : blocks)
-			_current_block_data->append(_block_data[case_block]);
+			_current_block_data->append(std::move(_block_data[case_block]));
 
 		_current_block_data->instructions.push_back(merge_label);
 	}
@@ -2539,7 +2762,7 @@ private:
 	{
 		assert(is_in_function()); // Can only leave if there was a function to begin with
 
-		_current_function_blocks->definition = _block_data[_last_block];
+		_current_function_blocks->definition = std::move(_block_data[_last_block]);
 
 		// Append function end instruction
 		add_instruction_without_result(spv::OpFunctionEnd, _current_function_blocks->definition);
@@ -2549,7 +2772,7 @@ private:
 	}
 };
 
-codegen *reshadefx::create_codegen_spirv(bool vulkan_semantics, bool debug_info, bool uniforms_to_spec_constants, bool enable_16bit_types, bool flip_vert_y)
+codegen *reshadefx::create_codegen_spirv(bool vulkan_semantics, bool debug_info, bool uniforms_to_spec_constants, bool enable_16bit_types, bool flip_vert_y, bool relaxed_precision)
 {
-	return new codegen_spirv(vulkan_semantics, debug_info, uniforms_to_spec_constants, enable_16bit_types, flip_vert_y);
+	return new codegen_spirv(vulkan_semantics, debug_info, uniforms_to_spec_constants, enable_16bit_types, flip_vert_y, relaxed_precision);
 }
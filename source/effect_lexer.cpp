@@ -8,8 +8,31 @@
 #include <string_view>
 #include <unordered_map> // Used for static lookup tables
 
+// SSE2 is part of the baseline instruction set on both x86 and x64 targets, so can use it unconditionally there to scan multiple characters at once
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+	#define RESHADEFX_LEXER_SSE2 1
+	#include <emmintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h> // _BitScanForward
+	#endif
+#endif
+
 using namespace reshadefx;
 
+#if RESHADEFX_LEXER_SSE2
+static inline unsigned int first_bit_set(unsigned int mask)
+{
+	assert(mask != 0);
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+#endif
+
 enum token_type
 {
 	DIGIT = '0',
@@ -797,6 +820,31 @@ void reshadefx::lexer::skip_space()
 	// Skip each character until a space is found
 	while (_cur < _end)
 	{
+#if RESHADEFX_LEXER_SSE2
+		// Skip over whole chunks of space characters at a time (this stops at backslashes, so that line continuations are still handled by the scalar code below)
+		while (_cur + 16 <= _end)
+		{
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_cur));
+			__m128i space = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' '));
+			space = _mm_or_si128(space, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')));
+			space = _mm_or_si128(space, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\v')));
+			space = _mm_or_si128(space, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\f')));
+			space = _mm_or_si128(space, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')));
+
+			const unsigned int mask = _mm_movemask_epi8(space) ^ 0xFFFF;
+			if (mask == 0)
+			{
+				skip(16);
+				continue;
+			}
+
+			skip(first_bit_set(mask));
+			break;
+		}
+
+		if (_cur >= _end)
+			break;
+#endif
 		if (_cur[0] == '\\' && (_cur[1] == '\n' || (_cur[1] == '\r' && _cur[2] == '\n')))
 		{
 			skip(_cur[1] == '\r' ? 3 : 2);
@@ -813,6 +861,23 @@ void reshadefx::lexer::skip_space()
 }
 void reshadefx::lexer::skip_to_next_line()
 {
+#if RESHADEFX_LEXER_SSE2
+	// Compare 16 characters at a time against the new line feed
+	while (_cur + 16 <= _end)
+	{
+		const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_cur));
+
+		const unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+		if (mask != 0)
+		{
+			skip(first_bit_set(mask));
+			return;
+		}
+
+		skip(16);
+	}
+#endif
+
 	// Skip each character until a new line feed is found
 	while (*_cur != '\n' && _cur < _end)
 	{
@@ -829,6 +894,79 @@ void reshadefx::lexer::skip_to_next_line()
 		skip(1);
 	}
 }
+void reshadefx::lexer::skip_to_next_pp_directive()
+{
+	while (_cur < _end)
+	{
+		// Check if the current line begins a preprocessor directive (optionally behind leading whitespace) and leave it for normal lexing if so
+		if (_cur_location.column <= 1)
+		{
+			const std::string::value_type *c = _cur;
+			while (c < _end && s_type_lookup[uint8_t(*c)] == SPACE)
+				c++;
+			if (c < _end && *c == '#')
+				return;
+		}
+
+		// Advance over the rest of this line, but keep track of comments, so that a directive inside one is not mistaken for a real one
+		while (_cur < _end && *_cur != '\n')
+		{
+#if RESHADEFX_LEXER_SSE2
+			// Compare 16 characters at a time against the new line feed and comment begin characters
+			while (_cur + 16 <= _end)
+			{
+				const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_cur));
+
+				const unsigned int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('/'))));
+				if (mask != 0)
+				{
+					skip(first_bit_set(mask));
+					break;
+				}
+
+				skip(16);
+			}
+
+			if (_cur >= _end || *_cur == '\n')
+				break;
+#endif
+			if (_cur[0] == '/' && _cur[1] == '*')
+			{
+				while (_cur < _end)
+				{
+					if (*_cur == '\n')
+					{
+						_cur_location.line++;
+						_cur_location.column = 1;
+					}
+					else if (_cur[0] == '*' && _cur[1] == '/')
+					{
+						skip(2);
+						break;
+					}
+					skip(1);
+				}
+				continue;
+			}
+
+			if (_cur[0] == '/' && _cur[1] == '/')
+			{
+				skip_to_next_line();
+				break;
+			}
+
+			skip(1);
+		}
+
+		if (_cur >= _end)
+			return;
+
+		// Skip the new line feed
+		_cur++;
+		_cur_location.line++;
+		_cur_location.column = 1;
+	}
+}
 
 void reshadefx::lexer::reset_to_offset(size_t offset)
 {
@@ -840,6 +978,32 @@ void reshadefx::lexer::parse_identifier(token &tok) const
 {
 	auto *const begin = _cur, *end = begin;
 
+#if RESHADEFX_LEXER_SSE2
+	// Skip to the end of the identifier sequence 16 characters at a time (identifier characters are letters, digits and underscores)
+	while (end + 16 <= _end)
+	{
+		const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(end));
+		const __m128i chunk_lower = _mm_or_si128(chunk, _mm_set1_epi8(0x20)); // Force letters to lower case for a single range comparison
+
+		const __m128i letter = _mm_and_si128(
+			_mm_cmpeq_epi8(_mm_max_epu8(chunk_lower, _mm_set1_epi8('a')), chunk_lower),
+			_mm_cmpeq_epi8(_mm_min_epu8(chunk_lower, _mm_set1_epi8('z')), chunk_lower));
+		const __m128i digit = _mm_and_si128(
+			_mm_cmpeq_epi8(_mm_max_epu8(chunk, _mm_set1_epi8('0')), chunk),
+			_mm_cmpeq_epi8(_mm_min_epu8(chunk, _mm_set1_epi8('9')), chunk));
+		const __m128i ident = _mm_or_si128(_mm_or_si128(letter, digit), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('_')));
+
+		const unsigned int mask = _mm_movemask_epi8(ident) ^ 0xFFFF;
+		if (mask != 0)
+		{
+			end += first_bit_set(mask);
+			break;
+		}
+
+		end += 16;
+	}
+#endif
+
 	// Skip to the end of the identifier sequence
 	while (s_type_lookup[uint8_t(*end)] == IDENT || s_type_lookup[uint8_t(*end)] == DIGIT)
 		end++;
@@ -79,6 +79,10 @@ namespace reshadefx
 		/// Advances to the next new line, ignoring all tokens.
 		/// </summary>
 		void skip_to_next_line();
+		/// <summary>
+		/// Advances to the next line that starts a preprocessor directive, scanning over the raw input instead of lexing the tokens in between.
+		/// </summary>
+		void skip_to_next_pp_directive();
 
 		/// <summary>
 		/// Resets position to the specified <paramref name="offset"/>.
@@ -12,6 +12,19 @@
 
 #define RESHADEFX_SHORT_CIRCUIT 0
 
+// Checks whether every component of a constant has the specified scalar value, to detect constants that form an algebraic identity with the other operand of a binary operation
+static bool is_constant_splat(const reshadefx::type &type, const reshadefx::constant &constant, unsigned int value)
+{
+	if (!type.is_numeric() || type.is_array())
+		return false;
+
+	for (unsigned int i = 0; i < type.components(); ++i)
+		if (type.is_floating_point() ? constant.as_float[i] != static_cast<float>(value) : constant.as_uint[i] != value)
+			return false;
+
+	return true;
+}
+
 reshadefx::parser::parser()
 {
 }
@@ -110,7 +123,7 @@ bool reshadefx::parser::accept_symbol(std::string &identifier, scoped_symbol &sy
 	}
 
 	// Figure out which scope to start searching in
-	scope scope = { "::", 0, 0 };
+	scope scope = global_scope();
 	if (!exclusive)
 		scope = current_scope();
 
@@ -1571,6 +1584,23 @@ bool reshadefx::parser::parse_expression_multary(expression &lhs_exp, unsigned i
 			if (rhs_exp.is_constant && lhs_exp.evaluate_constant_expression(op, rhs_exp.constant))
 				continue;
 
+			// Apply algebraic identities when only one operand is a matching constant ('x * 1', 'x + 0', ...), so that no instruction is emitted for them
+			if (!is_bool_result && op != tokenid::ampersand_ampersand && op != tokenid::pipe_pipe)
+			{
+				if (rhs_exp.is_constant && (
+						((op == tokenid::star || op == tokenid::slash) && is_constant_splat(type, rhs_exp.constant, 1)) ||
+						((op == tokenid::plus || op == tokenid::minus || op == tokenid::pipe || op == tokenid::caret || op == tokenid::less_less || op == tokenid::greater_greater) && is_constant_splat(type, rhs_exp.constant, 0))))
+					continue;
+				// The mirrored cases only hold for commutative operators
+				if (lhs_exp.is_constant && (
+						(op == tokenid::star && is_constant_splat(type, lhs_exp.constant, 1)) ||
+						((op == tokenid::plus || op == tokenid::pipe || op == tokenid::caret) && is_constant_splat(type, lhs_exp.constant, 0))))
+				{
+					lhs_exp = std::move(rhs_exp);
+					continue;
+				}
+			}
+
 			const codegen::id lhs_value = _codegen->emit_load(lhs_exp);
 
 #if RESHADEFX_SHORT_CIRCUIT
@@ -2131,7 +2131,7 @@ bool reshadefx::parser::parse_technique_pass(pass &info)
 						error(state_location, 3020, "type mismatch, expected function name");
 					}
 					else if (std::count_if(_codegen->_functions.begin(), _codegen->_functions.end(),
-						[&unique_name = symbol.function->unique_name](const std::unique_ptr<function> &info) { return info->unique_name == unique_name; }) > 1)
+						[&unique_name = symbol.function->unique_name](const function *info) { return info->unique_name == unique_name; }) > 1)
 					{
 						parse_success = false;
 						error(state_location, 3067, "ambiguous function '" + identifier + '\'');
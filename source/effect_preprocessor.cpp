@@ -7,7 +7,13 @@
 #include "effect_preprocessor.hpp"
 #include <cstdio> // fclose, fopen, fread, fseek
 #include <cassert>
+#include <cstring> // std::memcpy
 #include <algorithm> // std::find_if
+#include <mutex> // std::unique_lock
+#include <shared_mutex>
+#ifdef _WIN32
+#include <Windows.h>
+#endif
 
 #ifndef _WIN32
 	// On Linux systems the native path encoding is UTF-8 already, so no conversion necessary
@@ -66,9 +72,6 @@ static bool read_file(const std::filesystem::path &path, std::string &file_data)
 	// Read file contents into memory
 #ifndef _WIN32
 	FILE *const file = fopen(path.c_str(), "rb");
-#else
-	FILE *const file = _wfsopen(path.c_str(), L"rb", SH_DENYWR);
-#endif
 	if (file == nullptr)
 		return false;
 
@@ -84,6 +87,46 @@ static bool read_file(const std::filesystem::path &path, std::string &file_data)
 
 	if (file_size_read != file_size)
 		return false;
+#else
+	// Memory-map the file instead of streaming it, so the contents materialize with a single copy and the threads preprocessing effects in parallel share the cached pages when they read the same file
+	const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER file_size = {};
+	if (!GetFileSizeEx(file, &file_size) || static_cast<ULONGLONG>(file_size.QuadPart) >= SIZE_MAX)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	file_data.resize(static_cast<size_t>(file_size.QuadPart) + 1, '\0'); // One additional character at the end for new line feed set below
+
+	if (file_size.QuadPart != 0)
+	{
+		const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		const void *const view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping); // The view keeps its own reference to the mapping
+		if (view == nullptr)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		std::memcpy(file_data.data(), view, static_cast<size_t>(file_size.QuadPart));
+
+		UnmapViewOfFile(view);
+	}
+
+	// No longer need to have a handle open to the file, since all data was read, so can safely close it
+	CloseHandle(file);
+#endif
 
 	// Append a new line feed to the end of the input string to avoid issues with parsing
 	file_data.back() = '\n';
@@ -98,6 +141,53 @@ static bool read_file(const std::filesystem::path &path, std::string &file_data)
 	return true;
 }
 
+// Process-wide cache of pre-tokenized include files, which is shared across all preprocessor instances (and therefore across the threads compiling effects in parallel)
+static std::shared_mutex s_pre_tokenized_file_cache_mutex;
+static std::unordered_map<std::string, std::shared_ptr<const reshadefx::pre_tokenized_file>> s_pre_tokenized_file_cache;
+
+static std::shared_ptr<const reshadefx::pre_tokenized_file> load_pre_tokenized_file(const std::filesystem::path &path, const std::string &path_string)
+{
+	std::error_code ec;
+	const std::filesystem::file_time_type modified = std::filesystem::last_write_time(path, ec);
+
+	{	const std::shared_lock<std::shared_mutex> lock(s_pre_tokenized_file_cache_mutex);
+
+		if (const auto it = s_pre_tokenized_file_cache.find(path_string);
+			it != s_pre_tokenized_file_cache.end() && it->second->modified == modified)
+			return it->second;
+	}
+
+	const auto file = std::make_shared<reshadefx::pre_tokenized_file>();
+	file->modified = modified;
+
+	if (!read_file(path, file->source))
+		return nullptr;
+
+	// Tokenize the entire file once, so that subsequent inclusions can replay the token stream without going through the lexer again
+	// This has to use the same lexer options as the 'push' overload below
+	reshadefx::lexer lexer(
+		file->source,
+		true  /* ignore_comments */,
+		false /* ignore_whitespace */,
+		false /* ignore_pp_directives */,
+		false /* ignore_line_directives */,
+		true  /* ignore_keywords */,
+		false /* escape_string_literals */,
+		reshadefx::location(path_string, 1));
+	do
+	{
+		file->tokens.push_back(lexer.lex());
+	}
+	while (file->tokens.back() != reshadefx::tokenid::end_of_file);
+
+	{	const std::unique_lock<std::shared_mutex> lock(s_pre_tokenized_file_cache_mutex);
+
+		s_pre_tokenized_file_cache[path_string] = file;
+	}
+
+	return file;
+}
+
 template <char ESCAPE_CHAR = '\\'>
 static std::string escape_string(std::string s)
 {
@@ -217,6 +307,29 @@ void reshadefx::preprocessor::push(std::string input, const std::string &name)
 	// Advance into the input stack to update next token
 	consume();
 }
+void reshadefx::preprocessor::push(std::shared_ptr<const pre_tokenized_file> file, const std::string &name)
+{
+	const location start_location = !name.empty() ?
+		// Start at the beginning of the file when pushing a new file
+		location(name, 1) :
+		// Start with last known token location when pushing a memoized macro expansion
+		_token.location;
+
+	input_level level = { name };
+	level.file = std::move(file);
+	level.next_token.id = tokenid::unknown;
+	level.next_token.location = start_location; // This is used in 'consume' to initialize the output location
+
+	// Inherit hidden macros from parent
+	if (!_input_stack.empty())
+		level.hidden_macros = _input_stack.back().hidden_macros;
+
+	_input_stack.push_back(std::move(level));
+	_next_input_index = _input_stack.size() - 1;
+
+	// Advance into the input stack to update next token
+	consume();
+}
 
 bool reshadefx::preprocessor::peek(tokenid tokid) const
 {
@@ -252,10 +365,25 @@ void reshadefx::preprocessor::consume()
 
 	// Set current token
 	_token = std::move(input.next_token);
-	_current_token_raw_data = input.lexer->input_string().substr(_token.offset, _token.length);
 
-	// Get the next token
-	input.next_token = input.lexer->lex();
+	if (input.file != nullptr)
+	{
+		_current_token_raw_data = input.file->source.substr(_token.offset, _token.length);
+
+		// Get the next token by replaying the pre-tokenized stream (the last token is the end of file token, which is repeated indefinitely)
+		input.next_token = input.file->tokens[input.next_file_token < input.file->tokens.size() ? input.next_file_token++ : input.file->tokens.size() - 1];
+
+		// Tokens of a memoized macro expansion carry the location they were lexed with at the first expansion, so overwrite that with the location of the current expansion (which the 'push' overload above initialized the first token with)
+		if (input.name.empty())
+			input.next_token.location = _token.location;
+	}
+	else
+	{
+		_current_token_raw_data = input.lexer->input_string().substr(_token.offset, _token.length);
+
+		// Get the next token
+		input.next_token = input.lexer->lex();
+	}
 
 	// Verify string literals (since the lexer cannot throw errors itself)
 	if (_token == tokenid::string_literal && _current_token_raw_data.back() != '\"')
@@ -288,6 +416,33 @@ void reshadefx::preprocessor::consume_until(tokenid tokid)
 		consume();
 	}
 }
+void reshadefx::preprocessor::skip_to_next_pp_directive()
+{
+	if (_input_stack.empty())
+		return;
+
+	input_level &input = _input_stack[_next_input_index];
+
+	const auto is_conditional_directive = [](tokenid id) {
+		return id == tokenid::hash_if || id == tokenid::hash_ifdef || id == tokenid::hash_ifndef || id == tokenid::hash_else || id == tokenid::hash_elif || id == tokenid::hash_endif;
+	};
+
+	// Do not fast-forward when the next token is relevant to the conditional block handling or ends this input level
+	if (is_conditional_directive(input.next_token.id) || input.next_token == tokenid::end_of_file)
+		return;
+
+	// Only advance the underlying input here and leave the already fetched next token in place (it is part of the disabled section and ignored by the caller), so that the next call to 'consume' picks up the directive through the usual path, including its end of input handling
+	if (input.file != nullptr)
+	{
+		// The pre-tokenized stream can simply be replayed forward until the next conditional directive
+		while (input.next_file_token + 1 < input.file->tokens.size() && !is_conditional_directive(input.file->tokens[input.next_file_token].id))
+			input.next_file_token++;
+	}
+	else
+	{
+		input.lexer->skip_to_next_pp_directive();
+	}
+}
 
 bool reshadefx::preprocessor::accept(tokenid tokid, bool ignore_whitespace)
 {
@@ -317,11 +472,14 @@ bool reshadefx::preprocessor::expect(tokenid tokid)
 		token actual_token = _input_stack[_next_input_index].next_token;
 		actual_token.location.source = _output_location.source;
 
+		const input_level &input = _input_stack[_next_input_index];
+		const std::string &input_string = input.file != nullptr ? input.file->source : input.lexer->input_string();
+
 		if (actual_token == tokenid::end_of_line)
 			error(actual_token.location, "syntax error: unexpected new line");
 		else
 			error(actual_token.location, "syntax error: unexpected token '" +
-				_input_stack[_next_input_index].lexer->input_string().substr(actual_token.offset, actual_token.length) + '\'');
+				input_string.substr(actual_token.offset, actual_token.length) + '\'');
 
 		return false;
 	}
@@ -380,8 +538,11 @@ void reshadefx::preprocessor::parse()
 		}
 
 		if (skip)
-			// Ignore token since the current section is disabled
+		{
+			// Ignore token since the current section is disabled and fast-forward to the next preprocessor directive that may end it, rather than lexing every token in between
+			skip_to_next_pp_directive();
 			continue;
+		}
 
 		switch (_token)
 		{
@@ -731,18 +892,13 @@ void reshadefx::preprocessor::parse_include()
 			[&file_path_string](const input_level &level) { return level.name == file_path_string; }) != _input_stack.end())
 		return error(_token.location, "recursive #include");
 
-	std::string input;
-	if (const auto it = _file_cache.find(file_path_string); it != _file_cache.end())
-	{
-		input = it->second;
-	}
-	else
-	{
-		if (!read_file(file_path, input))
-			return error(keyword_location, "could not open included file '" + file_name.u8string() + '\'');
+	// Load the include from the process-wide cache (which also verifies that it has not been modified on disk), so that it is only read and tokenized once, no matter how many effects include it
+	std::shared_ptr<const pre_tokenized_file> file = load_pre_tokenized_file(file_path, file_path_string);
+	if (file == nullptr)
+		return error(keyword_location, "could not open included file '" + file_name.u8string() + '\'');
 
-		_file_cache.emplace(file_path_string, input);
-	}
+	// Keep a copy of the source in the per-instance file cache, since it is used for error context and to enumerate included files
+	_file_cache.emplace(file_path_string, file->source);
 
 	// Skip end of line character following the include statement before pushing, so that the line number is already pointing to the next line when popping out of it again
 	if (!expect(tokenid::end_of_line))
@@ -752,7 +908,7 @@ void reshadefx::preprocessor::parse_include()
 	while (_input_stack.size() > (_next_input_index + 1))
 		_input_stack.pop_back();
 
-	push(std::move(input), file_path_string);
+	push(std::move(file), file_path_string);
 }
 
 bool reshadefx::preprocessor::evaluate_expression()
@@ -935,11 +1091,17 @@ bool reshadefx::preprocessor::evaluate_expression()
 				if (has_parentheses && !expect(tokenid::parenthesis_close))
 					return false;
 
+				// Only add to used macro list if the macro was not defined in effect code itself
+				if (const auto it = _macros.find(macro_name); it == _macros.end() || it->second.is_predefined)
+					_used_macros.emplace(macro_name);
+
 				rpn[rpn_index++] = { is_defined(macro_name) ? 1 : 0, false };
 				continue;
 			}
 
 			// An identifier that cannot be replaced with a number becomes zero
+			// Keep track of it regardless, since defining it later changes the result of this expression
+			_used_macros.emplace(_token.literal_as_string);
 			rpn[rpn_index++] = { 0, false };
 			break;
 		case tokenid::int_literal:
@@ -1125,6 +1287,10 @@ bool reshadefx::preprocessor::evaluate_identifier_as_macro()
 	if (it == _macros.end())
 		return false;
 
+	// Keep track of predefined macro usage, so that effects can be reloaded selectively when such a definition is changed externally
+	if (it->second.is_predefined)
+		_used_macros.emplace(_token.literal_as_string);
+
 	if (!_input_stack.empty())
 	{
 		const std::unordered_set<std::string> &hidden_macros = _input_stack[_current_input_index].hidden_macros;
@@ -1213,62 +1379,96 @@ void reshadefx::preprocessor::expand_macro(const std::string &name, const macro
 		return warning(_token.location, "too many arguments for function-like macro invocation '" + name + "'");
 
 	std::string input;
-	input.reserve(macro.replacement_list.size());
-
-	for (size_t offset = 0; offset < macro.replacement_list.size(); ++offset)
+	if (macro.is_function_like)
 	{
-		if (macro.replacement_list[offset] != macro_replacement_start)
-		{
-			input += macro.replacement_list[offset];
-			continue;
-		}
+		input.reserve(macro.replacement_list.size());
 
-		// This is a special replacement sequence
-		const char type = macro.replacement_list[++offset];
-		const char index = macro.replacement_list[++offset];
-		if (static_cast<size_t>(index) >= arguments.size())
+		for (size_t offset = 0; offset < macro.replacement_list.size(); ++offset)
 		{
-			if (macro.is_variadic)
+			if (macro.replacement_list[offset] != macro_replacement_start)
 			{
-				// The concatenation operator has a special meaning when placed between a comma and a variable argument, deleting the preceding comma
-				if (type == macro_replacement_concat && input.back() == ',')
-					input.pop_back();
-				if (type == macro_replacement_stringize)
-					input += "\"\"";
+				input += macro.replacement_list[offset];
+				continue;
 			}
-			continue;
-		}
 
-		switch (type)
-		{
-		case macro_replacement_argument:
-			// Argument prescan
-			push(arguments[index] + static_cast<char>(macro_replacement_argument));
-			while (true)
+			// This is a special replacement sequence
+			const char type = macro.replacement_list[++offset];
+			const char index = macro.replacement_list[++offset];
+			if (static_cast<size_t>(index) >= arguments.size())
 			{
-				// Consume all tokens of the argument (until the end marker is reached)
-				consume();
+				if (macro.is_variadic)
+				{
+					// The concatenation operator has a special meaning when placed between a comma and a variable argument, deleting the preceding comma
+					if (type == macro_replacement_concat && input.back() == ',')
+						input.pop_back();
+					if (type == macro_replacement_stringize)
+						input += "\"\"";
+				}
+				continue;
+			}
 
-				if (_token == tokenid::unknown) // 'macro_replacement_argument' is 'tokenid::unknown'
-					break;
-				if (_token == tokenid::identifier && evaluate_identifier_as_macro())
-					continue;
+			switch (type)
+			{
+			case macro_replacement_argument:
+				// Argument prescan
+				push(arguments[index] + static_cast<char>(macro_replacement_argument));
+				while (true)
+				{
+					// Consume all tokens of the argument (until the end marker is reached)
+					consume();
 
-				input += _current_token_raw_data;
+					if (_token == tokenid::unknown) // 'macro_replacement_argument' is 'tokenid::unknown'
+						break;
+					if (_token == tokenid::identifier && evaluate_identifier_as_macro())
+						continue;
+
+					input += _current_token_raw_data;
+				}
+				assert(_current_token_raw_data[0] == macro_replacement_argument);
+				break;
+			case macro_replacement_concat:
+				input += arguments[index];
+				break;
+			case macro_replacement_stringize:
+				// Adds backslashes to escape quotes
+				input += escape_string<'\"'>(arguments[index]);
+				break;
 			}
-			assert(_current_token_raw_data[0] == macro_replacement_argument);
-			break;
-		case macro_replacement_concat:
-			input += arguments[index];
-			break;
-		case macro_replacement_stringize:
-			// Adds backslashes to escape quotes
-			input += escape_string<'\"'>(arguments[index]);
-			break;
 		}
 	}
+	else
+	{
+		// Object-like macros cannot contain special replacement sequences, so their replacement list is the expansion already
+		input = macro.replacement_list;
+	}
+
+	// Identical expansions to the same string occur frequently (object-like helper macros in particular expand thousands of times per effect), so lex each unique expansion just once and replay the memoized token run on subsequent expansions
+	// This is safe because tokenization does not depend on macro state and the replayed token locations are overwritten with those of the current expansion in 'consume' above
+	auto cache_it = _macro_expansion_cache.find(input);
+	if (cache_it == _macro_expansion_cache.end())
+	{
+		const auto expansion = std::make_shared<pre_tokenized_file>();
+		expansion->source = std::move(input);
+
+		// This has to use the same lexer options as the string 'push' overload above
+		lexer lexer(
+			expansion->source,
+			true  /* ignore_comments */,
+			false /* ignore_whitespace */,
+			false /* ignore_pp_directives */,
+			false /* ignore_line_directives */,
+			true  /* ignore_keywords */,
+			false /* escape_string_literals */);
+		do
+		{
+			expansion->tokens.push_back(lexer.lex());
+		}
+		while (expansion->tokens.back() != tokenid::end_of_file);
+
+		cache_it = _macro_expansion_cache.emplace(expansion->source, expansion).first;
+	}
 
-	push(std::move(input));
+	push(cache_it->second);
 
 	// Avoid expanding macros again that are referencing themselves
 	_input_stack[_current_input_index].hidden_macros.insert(name);
@@ -13,6 +13,16 @@
 
 namespace reshadefx
 {
+	/// <summary>
+	/// An include file that was tokenized once and can be replayed by any number of preprocessor instances (tokenization does not depend on macro state, so the token stream is shared across threads).
+	/// </summary>
+	struct pre_tokenized_file
+	{
+		std::filesystem::file_time_type modified;
+		std::string source;
+		std::vector<token> tokens;
+	};
+
 	/// <summary>
 	/// A C-style preprocessor implementation.
 	/// </summary>
@@ -89,6 +99,12 @@ namespace reshadefx
 		/// </summary>
 		std::vector<std::pair<std::string, std::string>> used_macro_definitions() const;
 
+		/// <summary>
+		/// Gets a list of all macro names that were queried during preprocessing (including ones that were not defined).
+		/// This is the set of definitions that can alter the preprocessed output when changed externally.
+		/// </summary>
+		std::vector<std::string> used_macro_names() const { return std::vector<std::string>(_used_macros.begin(), _used_macros.end()); }
+
 		/// <summary>
 		/// Gets a list of pragma directives that occured.
 		/// </summary>
@@ -106,6 +122,9 @@ namespace reshadefx
 		{
 			std::string name;
 			std::unique_ptr<class lexer> lexer;
+			// When set, tokens are replayed from this pre-tokenized file instead of pulled from the lexer
+			std::shared_ptr<const pre_tokenized_file> file;
+			size_t next_file_token = 0;
 			token next_token;
 			std::unordered_set<std::string> hidden_macros;
 		};
@@ -114,10 +133,12 @@ namespace reshadefx
 		void warning(const location &location, const std::string &message);
 
 		void push(std::string input, const std::string &name = std::string());
+		void push(std::shared_ptr<const pre_tokenized_file> file, const std::string &name = std::string());
 
 		bool peek(tokenid tokid) const;
 		void consume();
 		void consume_until(tokenid tokid);
+		void skip_to_next_pp_directive();
 		bool accept(tokenid tokid, bool ignore_whitespace = true);
 		bool expect(tokenid tokid);
 
@@ -159,6 +180,8 @@ namespace reshadefx
 
 		std::vector<std::filesystem::path> _include_paths;
 		std::unordered_map<std::string, std::string> _file_cache;
+		// Macro expansions that were lexed before, keyed by the expanded string, so that repeated identical expansions can replay the token run instead of going through the lexer again
+		std::unordered_map<std::string, std::shared_ptr<const pre_tokenized_file>> _macro_expansion_cache;
 
 		std::vector<std::pair<std::string, std::string>> _used_pragmas;
 	};
@@ -0,0 +1,433 @@
+/*
+ * Copyright (C) 2025 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "effect_serialization.hpp"
+#include <cstring> // std::memcpy
+#include <type_traits> // std::is_trivially_copyable_v
+
+// Magic number and version of the serialization format, bump the version whenever the layout of any serialized type changes
+static constexpr uint32_t MODULE_MAGIC = 0x4D584652; // 'RFXM'
+static constexpr uint32_t MODULE_VERSION = 1;
+
+namespace
+{
+	struct binary_writer
+	{
+		std::string &data;
+
+		template <typename T>
+		void write(const T &value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			data.append(reinterpret_cast<const char *>(&value), sizeof(T));
+		}
+		void write(const std::string &value)
+		{
+			write(static_cast<uint32_t>(value.size()));
+			data.append(value);
+		}
+	};
+
+	struct binary_reader
+	{
+		std::string_view data;
+		size_t offset = 0;
+		bool failed = false;
+
+		template <typename T>
+		void read(T &value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			if (offset + sizeof(T) > data.size())
+			{
+				failed = true; // Leave the value default-initialized when the data is truncated
+				return;
+			}
+			std::memcpy(&value, data.data() + offset, sizeof(T));
+			offset += sizeof(T);
+		}
+		void read(std::string &value)
+		{
+			uint32_t size = 0;
+			read(size);
+			if (failed || offset + size > data.size())
+			{
+				failed = true;
+				value.clear();
+				return;
+			}
+			value.assign(data.data() + offset, size);
+			offset += size;
+		}
+	};
+
+	void write_constant(binary_writer &s, const reshadefx::constant &value)
+	{
+		s.write(value.as_uint);
+		s.write(value.string_data);
+		s.write(static_cast<uint32_t>(value.array_data.size()));
+		for (const reshadefx::constant &element : value.array_data)
+			write_constant(s, element);
+	}
+	void read_constant(binary_reader &s, reshadefx::constant &value)
+	{
+		s.read(value.as_uint);
+		s.read(value.string_data);
+		uint32_t array_size = 0;
+		s.read(array_size);
+		if (s.failed || array_size > s.data.size() - s.offset)
+		{
+			s.failed = true;
+			return;
+		}
+		value.array_data.resize(array_size);
+		for (reshadefx::constant &element : value.array_data)
+			read_constant(s, element);
+	}
+
+	void write_annotations(binary_writer &s, const std::vector<reshadefx::annotation> &annotations)
+	{
+		s.write(static_cast<uint32_t>(annotations.size()));
+		for (const reshadefx::annotation &annotation : annotations)
+		{
+			s.write(annotation.type);
+			s.write(annotation.name);
+			write_constant(s, annotation.value);
+		}
+	}
+	void read_annotations(binary_reader &s, std::vector<reshadefx::annotation> &annotations)
+	{
+		uint32_t count = 0;
+		s.read(count);
+		if (s.failed || count > s.data.size() - s.offset)
+		{
+			s.failed = true;
+			return;
+		}
+		annotations.resize(count);
+		for (reshadefx::annotation &annotation : annotations)
+		{
+			s.read(annotation.type);
+			s.read(annotation.name);
+			read_constant(s, annotation.value);
+		}
+	}
+
+	template <typename T>
+	void write_bindings(binary_writer &s, const std::vector<T> &bindings)
+	{
+		s.write(static_cast<uint32_t>(bindings.size()));
+		for (const T &binding : bindings)
+		{
+			s.write(static_cast<uint32_t>(binding.index));
+			s.write(binding.entry_point_binding);
+		}
+	}
+	template <typename T>
+	void read_bindings(binary_reader &s, std::vector<T> &bindings)
+	{
+		uint32_t count = 0;
+		s.read(count);
+		if (s.failed || count > s.data.size() - s.offset)
+		{
+			s.failed = true;
+			return;
+		}
+		bindings.resize(count);
+		for (T &binding : bindings)
+		{
+			uint32_t index = 0;
+			s.read(index);
+			binding.index = index;
+			s.read(binding.entry_point_binding);
+		}
+	}
+
+	void write_pass(binary_writer &s, const reshadefx::pass &pass)
+	{
+		s.write(pass.name);
+		for (const std::string &render_target_name : pass.render_target_names)
+			s.write(render_target_name);
+		s.write(pass.vs_entry_point);
+		s.write(pass.ps_entry_point);
+		s.write(pass.cs_entry_point);
+		s.write(pass.generate_mipmaps);
+		s.write(pass.clear_render_targets);
+		s.write(pass.blend_enable);
+		s.write(pass.source_color_blend_factor);
+		s.write(pass.dest_color_blend_factor);
+		s.write(pass.color_blend_op);
+		s.write(pass.source_alpha_blend_factor);
+		s.write(pass.dest_alpha_blend_factor);
+		s.write(pass.alpha_blend_op);
+		s.write(pass.srgb_write_enable);
+		s.write(pass.render_target_write_mask);
+		s.write(pass.stencil_enable);
+		s.write(pass.stencil_read_mask);
+		s.write(pass.stencil_write_mask);
+		s.write(pass.stencil_reference_value);
+		s.write(pass.stencil_comparison_func);
+		s.write(pass.stencil_pass_op);
+		s.write(pass.stencil_fail_op);
+		s.write(pass.stencil_depth_fail_op);
+		s.write(pass.topology);
+		s.write(pass.num_vertices);
+		s.write(pass.viewport_width);
+		s.write(pass.viewport_height);
+		s.write(pass.viewport_dispatch_z);
+		write_bindings(s, pass.texture_bindings);
+		// The sRGB flag is the only field of the texture bindings not covered by the shared binding helper
+		for (const reshadefx::texture_binding &binding : pass.texture_bindings)
+			s.write(binding.srgb);
+		write_bindings(s, pass.sampler_bindings);
+		write_bindings(s, pass.storage_bindings);
+	}
+	void read_pass(binary_reader &s, reshadefx::pass &pass)
+	{
+		s.read(pass.name);
+		for (std::string &render_target_name : pass.render_target_names)
+			s.read(render_target_name);
+		s.read(pass.vs_entry_point);
+		s.read(pass.ps_entry_point);
+		s.read(pass.cs_entry_point);
+		s.read(pass.generate_mipmaps);
+		s.read(pass.clear_render_targets);
+		s.read(pass.blend_enable);
+		s.read(pass.source_color_blend_factor);
+		s.read(pass.dest_color_blend_factor);
+		s.read(pass.color_blend_op);
+		s.read(pass.source_alpha_blend_factor);
+		s.read(pass.dest_alpha_blend_factor);
+		s.read(pass.alpha_blend_op);
+		s.read(pass.srgb_write_enable);
+		s.read(pass.render_target_write_mask);
+		s.read(pass.stencil_enable);
+		s.read(pass.stencil_read_mask);
+		s.read(pass.stencil_write_mask);
+		s.read(pass.stencil_reference_value);
+		s.read(pass.stencil_comparison_func);
+		s.read(pass.stencil_pass_op);
+		s.read(pass.stencil_fail_op);
+		s.read(pass.stencil_depth_fail_op);
+		s.read(pass.topology);
+		s.read(pass.num_vertices);
+		s.read(pass.viewport_width);
+		s.read(pass.viewport_height);
+		s.read(pass.viewport_dispatch_z);
+		read_bindings(s, pass.texture_bindings);
+		for (reshadefx::texture_binding &binding : pass.texture_bindings)
+			s.read(binding.srgb);
+		read_bindings(s, pass.sampler_bindings);
+		read_bindings(s, pass.storage_bindings);
+	}
+}
+
+void reshadefx::serialize_effect_module(const effect_module &module, const std::string &code, const std::unordered_map<std::string, std::string> &entry_point_code, std::string &data)
+{
+	binary_writer s { data };
+
+	s.write(MODULE_MAGIC);
+	s.write(MODULE_VERSION);
+
+	s.write(static_cast<uint32_t>(module.textures.size()));
+	for (const texture &tex : module.textures)
+	{
+		s.write(static_cast<const texture_desc &>(tex));
+		s.write(tex.id);
+		s.write(tex.name);
+		s.write(tex.unique_name);
+		s.write(tex.semantic);
+		write_annotations(s, tex.annotations);
+		s.write(tex.render_target);
+		s.write(tex.storage_access);
+	}
+
+	s.write(static_cast<uint32_t>(module.samplers.size()));
+	for (const sampler &samp : module.samplers)
+	{
+		s.write(static_cast<const sampler_desc &>(samp));
+		s.write(samp.type);
+		s.write(samp.id);
+		s.write(samp.name);
+		s.write(samp.unique_name);
+		s.write(samp.texture_name);
+		write_annotations(s, samp.annotations);
+		s.write(samp.srgb);
+	}
+
+	s.write(static_cast<uint32_t>(module.storages.size()));
+	for (const storage &store : module.storages)
+	{
+		s.write(static_cast<const storage_desc &>(store));
+		s.write(store.type);
+		s.write(store.id);
+		s.write(store.name);
+		s.write(store.unique_name);
+		s.write(store.texture_name);
+	}
+
+	for (const std::vector<uniform> *uniforms : { &module.uniforms, &module.spec_constants })
+	{
+		s.write(static_cast<uint32_t>(uniforms->size()));
+		for (const uniform &var : *uniforms)
+		{
+			s.write(var.type);
+			s.write(var.name);
+			s.write(var.size);
+			s.write(var.offset);
+			write_annotations(s, var.annotations);
+			s.write(var.has_initializer_value);
+			write_constant(s, var.initializer_value);
+		}
+	}
+
+	s.write(module.total_uniform_size);
+
+	s.write(static_cast<uint32_t>(module.techniques.size()));
+	for (const technique &tech : module.techniques)
+	{
+		s.write(tech.name);
+		s.write(static_cast<uint32_t>(tech.passes.size()));
+		for (const pass &pass : tech.passes)
+			write_pass(s, pass);
+		write_annotations(s, tech.annotations);
+	}
+
+	s.write(static_cast<uint32_t>(module.entry_points.size()));
+	for (const std::pair<std::string, shader_type> &entry_point : module.entry_points)
+	{
+		s.write(entry_point.first);
+		s.write(entry_point.second);
+	}
+
+	s.write(code);
+
+	s.write(static_cast<uint32_t>(entry_point_code.size()));
+	for (const std::pair<const std::string, std::string> &entry_point : entry_point_code)
+	{
+		s.write(entry_point.first);
+		s.write(entry_point.second);
+	}
+}
+
+bool reshadefx::deserialize_effect_module(std::string_view data, effect_module &module, std::string &code, std::unordered_map<std::string, std::string> &entry_point_code)
+{
+	binary_reader s { data };
+
+	uint32_t magic = 0, version = 0;
+	s.read(magic);
+	s.read(version);
+	if (magic != MODULE_MAGIC || version != MODULE_VERSION)
+		return false;
+
+	const auto read_count = [&s](uint32_t &count) {
+		s.read(count);
+		if (count > s.data.size() - s.offset)
+			s.failed = true;
+		return !s.failed;
+	};
+
+	uint32_t count = 0;
+
+	if (!read_count(count))
+		return false;
+	module.textures.resize(count);
+	for (texture &tex : module.textures)
+	{
+		s.read(static_cast<texture_desc &>(tex));
+		s.read(tex.id);
+		s.read(tex.name);
+		s.read(tex.unique_name);
+		s.read(tex.semantic);
+		read_annotations(s, tex.annotations);
+		s.read(tex.render_target);
+		s.read(tex.storage_access);
+	}
+
+	if (!read_count(count))
+		return false;
+	module.samplers.resize(count);
+	for (sampler &samp : module.samplers)
+	{
+		s.read(static_cast<sampler_desc &>(samp));
+		s.read(samp.type);
+		s.read(samp.id);
+		s.read(samp.name);
+		s.read(samp.unique_name);
+		s.read(samp.texture_name);
+		read_annotations(s, samp.annotations);
+		s.read(samp.srgb);
+	}
+
+	if (!read_count(count))
+		return false;
+	module.storages.resize(count);
+	for (storage &store : module.storages)
+	{
+		s.read(static_cast<storage_desc &>(store));
+		s.read(store.type);
+		s.read(store.id);
+		s.read(store.name);
+		s.read(store.unique_name);
+		s.read(store.texture_name);
+	}
+
+	for (std::vector<uniform> *uniforms : { &module.uniforms, &module.spec_constants })
+	{
+		if (!read_count(count))
+			return false;
+		uniforms->resize(count);
+		for (uniform &var : *uniforms)
+		{
+			s.read(var.type);
+			s.read(var.name);
+			s.read(var.size);
+			s.read(var.offset);
+			read_annotations(s, var.annotations);
+			s.read(var.has_initializer_value);
+			read_constant(s, var.initializer_value);
+		}
+	}
+
+	s.read(module.total_uniform_size);
+
+	if (!read_count(count))
+		return false;
+	module.techniques.resize(count);
+	for (technique &tech : module.techniques)
+	{
+		s.read(tech.name);
+		uint32_t num_passes = 0;
+		if (!read_count(num_passes))
+			return false;
+		tech.passes.resize(num_passes);
+		for (pass &pass : tech.passes)
+			read_pass(s, pass);
+		read_annotations(s, tech.annotations);
+	}
+
+	if (!read_count(count))
+		return false;
+	module.entry_points.resize(count);
+	for (std::pair<std::string, shader_type> &entry_point : module.entry_points)
+	{
+		s.read(entry_point.first);
+		s.read(entry_point.second);
+	}
+
+	s.read(code);
+
+	if (!read_count(count))
+		return false;
+	entry_point_code.reserve(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		std::string name;
+		s.read(name);
+		s.read(entry_point_code[name]);
+	}
+
+	return !s.failed;
+}
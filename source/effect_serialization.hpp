@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) 2025 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include "effect_module.hpp"
+#include <string_view>
+#include <unordered_map>
+
+namespace reshadefx
+{
+	/// <summary>
+	/// Serializes an effect module (together with its generated code) into a compact binary representation that can be stored in the effect cache.
+	/// </summary>
+	/// <param name="module">Module to serialize.</param>
+	/// <param name="code">Generated code for the entire module (may be empty when only entry point code is used).</param>
+	/// <param name="entry_point_code">Generated code for each entry point, keyed by entry point name.</param>
+	/// <param name="data">String the binary representation is appended to.</param>
+	void serialize_effect_module(const effect_module &module, const std::string &code, const std::unordered_map<std::string, std::string> &entry_point_code, std::string &data);
+
+	/// <summary>
+	/// Restores an effect module from the binary representation created by <see cref="serialize_effect_module"/>.
+	/// </summary>
+	/// <returns><see langword="true"/> on success, <see langword="false"/> when the data is truncated or was written by an incompatible version of this serialization format.</returns>
+	bool deserialize_effect_module(std::string_view data, effect_module &module, std::string &code, std::unordered_map<std::string, std::string> &entry_point_code);
+}
@@ -6,8 +6,11 @@
 #include "effect_symbol_table.hpp"
 #include <cassert>
 #include <malloc.h> // alloca
+#include <iterator> // std::size
 #include <algorithm> // std::upper_bound, std::sort
 #include <functional> // std::greater
+#include <string_view>
+#include <unordered_map>
 
 enum class intrinsic_id
 {
@@ -129,6 +132,30 @@ static const intrinsic s_intrinsics[] =
 #undef float3
 #undef float4
 
+// Hash table mapping each intrinsic function name to the contiguous range of its overloads in 's_intrinsics', so that intrinsic resolution does not have to scan the entire array with string comparisons
+// This is built once on first use rather than at compile time, since the intrinsic entries hold non-literal data (see 'reshadefx::function')
+static const std::unordered_map<std::string_view, std::pair<uint32_t, uint32_t>> &intrinsic_overload_ranges()
+{
+	static const std::unordered_map<std::string_view, std::pair<uint32_t, uint32_t>> s_ranges = []() {
+		std::unordered_map<std::string_view, std::pair<uint32_t, uint32_t>> ranges;
+		ranges.reserve(std::size(s_intrinsics));
+
+		for (uint32_t i = 0; i < std::size(s_intrinsics); ++i)
+		{
+			std::pair<uint32_t, uint32_t> &range = ranges[std::string_view(s_intrinsics[i].name)];
+			if (range.second == 0)
+				range.first = i;
+			// Overloads of the same intrinsic have to be declared next to each other in "effect_symbol_table_intrinsics.inl" for the range to cover them all
+			assert(range.first + range.second == i);
+			range.second++;
+		}
+
+		return ranges;
+	}();
+
+	return s_ranges;
+}
+
 unsigned int reshadefx::type::rank(const type &src, const type &dst)
 {
 	if (src.is_array() != dst.is_array() || (src.array_length != dst.array_length && src.is_bounded_array() && dst.is_bounded_array()))
@@ -174,6 +201,20 @@ reshadefx::symbol_table::symbol_table()
 	_current_scope.name = "::";
 	_current_scope.level = 0;
 	_current_scope.namespace_level = 0;
+	_current_scope.name_id = intern_name(_current_scope.name);
+
+	_global_scope = _current_scope;
+}
+
+uint32_t reshadefx::symbol_table::intern_name(const std::string &name)
+{
+	// Hand out sequential non-zero handles, so that a zero handle can indicate an unknown name
+	return _interned_names.emplace(name, static_cast<uint32_t>(_interned_names.size() + 1)).first->second;
+}
+uint32_t reshadefx::symbol_table::find_name(const std::string &name) const
+{
+	const auto it = _interned_names.find(name);
+	return it != _interned_names.end() ? it->second : 0;
 }
 
 void reshadefx::symbol_table::enter_scope()
@@ -185,14 +226,16 @@ void reshadefx::symbol_table::enter_namespace(const std::string &name)
 	_current_scope.name += name + "::";
 	_current_scope.level++;
 	_current_scope.namespace_level++;
+	_current_scope.name_id = intern_name(_current_scope.name);
 }
 void reshadefx::symbol_table::leave_scope()
 {
 	assert(_current_scope.level > 0);
 
-	for (auto &symbol : _symbol_stack)
+	// Only the symbols that were inserted into the scopes being left can match below, so it is enough to visit those (they were recorded in 'insert_symbol')
+	while (!_local_symbols.empty() && _local_symbols.back().second >= _current_scope.level)
 	{
-		std::vector<scoped_symbol> &scope_list = symbol.second;
+		std::vector<scoped_symbol> &scope_list = _symbol_stack[_local_symbols.back().first];
 
 		for (auto scope_it = scope_list.begin(); scope_it != scope_list.end();)
 		{
@@ -206,6 +249,8 @@ void reshadefx::symbol_table::leave_scope()
 				++scope_it;
 			}
 		}
+
+		_local_symbols.pop_back();
 	}
 
 	_current_scope.level--;
@@ -218,6 +263,7 @@ void reshadefx::symbol_table::leave_namespace()
 	_current_scope.name.erase(_current_scope.name.substr(0, _current_scope.name.size() - 2).rfind("::") + 2);
 	_current_scope.level--;
 	_current_scope.namespace_level--;
+	_current_scope.name_id = intern_name(_current_scope.name);
 }
 
 bool reshadefx::symbol_table::insert_symbol(const std::string &name, const symbol &symbol, bool global)
@@ -247,10 +293,11 @@ bool reshadefx::symbol_table::insert_symbol(const std::string &name, const symbo
 		{
 			// Extract scope name
 			scope.name = _current_scope.name.substr(0, pos += 2);
+			scope.name_id = intern_name(scope.name);
 			const std::string previous_scope_name = _current_scope.name.substr(pos);
 
 			// Insert symbol into this scope
-			insert_sorted(_symbol_stack[previous_scope_name + name], scoped_symbol { symbol, scope });
+			insert_sorted(_symbol_stack[intern_name(previous_scope_name + name)], scoped_symbol { symbol, scope });
 
 			// Continue walking up the scope chain
 			scope.level = ++scope.namespace_level;
@@ -259,7 +306,13 @@ bool reshadefx::symbol_table::insert_symbol(const std::string &name, const symbo
 	else
 	{
 		// This is a local symbol so it's sufficient to update the symbol stack with just the current scope
-		insert_sorted(_symbol_stack[name], scoped_symbol { symbol, _current_scope });
+		const uint32_t name_id = intern_name(name);
+
+		insert_sorted(_symbol_stack[name_id], scoped_symbol { symbol, _current_scope });
+
+		// Record symbols inserted below the namespace level, so that 'leave_scope' can remove them again without visiting the entire symbol stack
+		if (_current_scope.level > _current_scope.namespace_level)
+			_local_symbols.push_back({ name_id, _current_scope.level });
 	}
 
 	return true;
@@ -272,7 +325,7 @@ reshadefx::scoped_symbol reshadefx::symbol_table::find_symbol(const std::string
 }
 reshadefx::scoped_symbol reshadefx::symbol_table::find_symbol(const std::string &name, const scope &scope, bool exclusive) const
 {
-	const auto stack_it = _symbol_stack.find(name);
+	const auto stack_it = _symbol_stack.find(find_name(name));
 
 	// Check if symbol does exist
 	if (stack_it == _symbol_stack.end() || stack_it->second.empty())
@@ -284,7 +337,7 @@ reshadefx::scoped_symbol reshadefx::symbol_table::find_symbol(const std::string
 	for (auto it = stack_it->second.rbegin(), end = stack_it->second.rend(); it != end; ++it)
 	{
 		if (it->scope.level > scope.level ||
-			it->scope.namespace_level > scope.namespace_level || (it->scope.namespace_level == scope.namespace_level && it->scope.name != scope.name))
+			it->scope.namespace_level > scope.namespace_level || (it->scope.namespace_level == scope.namespace_level && it->scope.name_id != scope.name_id))
 			continue;
 		if (exclusive && it->scope.level < scope.level)
 			continue;
@@ -356,7 +409,7 @@ bool reshadefx::symbol_table::resolve_function_call(const std::string &name, con
 	unsigned int overload_namespace = scope.namespace_level;
 
 	// Look up function name in the symbol stack and loop through the associated symbols
-	const auto stack_it = _symbol_stack.find(name);
+	const auto stack_it = _symbol_stack.find(find_name(name));
 
 	if (stack_it != _symbol_stack.end() && !stack_it->second.empty())
 	{
@@ -365,7 +418,7 @@ bool reshadefx::symbol_table::resolve_function_call(const std::string &name, con
 			if (it->op != symbol_type::function)
 				continue;
 			if (it->scope.level > scope.level ||
-				it->scope.namespace_level > scope.namespace_level || (it->scope.namespace_level == scope.namespace_level && it->scope.name != scope.name))
+				it->scope.namespace_level > scope.namespace_level || (it->scope.namespace_level == scope.namespace_level && it->scope.name_id != scope.name_id))
 				continue;
 
 			const function *const function = it->function;
@@ -414,9 +467,15 @@ bool reshadefx::symbol_table::resolve_function_call(const std::string &name, con
 	// Try matching against intrinsic functions if no matching user-defined function was found up to this point
 	if (num_overloads == 0)
 	{
-		for (const intrinsic &intrinsic : s_intrinsics)
+		const std::unordered_map<std::string_view, std::pair<uint32_t, uint32_t>> &ranges = intrinsic_overload_ranges();
+		const auto range_it = ranges.find(std::string_view(name));
+		const std::pair<uint32_t, uint32_t> range = range_it != ranges.end() ? range_it->second : std::make_pair(0u, 0u);
+
+		for (uint32_t intrinsic_index = range.first; intrinsic_index < range.first + range.second; ++intrinsic_index)
 		{
-			if (intrinsic.name != name || intrinsic.parameter_list.size() != arguments.size())
+			const intrinsic &intrinsic = s_intrinsics[intrinsic_index];
+
+			if (intrinsic.parameter_list.size() != arguments.size())
 				continue;
 
 			// A new possibly-matching intrinsic function was found, compare it against the current result
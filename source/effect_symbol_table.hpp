@@ -17,6 +17,8 @@ namespace reshadefx
 	{
 		std::string name;
 		uint32_t level, namespace_level;
+		// Interned handle of <see cref="name"/> (see <see cref="symbol_table::intern_name"/>), so that scopes can be compared without comparing strings
+		uint32_t name_id = 0;
 	};
 
 	/// <summary>
@@ -77,6 +79,10 @@ namespace reshadefx
 		/// Gets the current scope the symbol table operates in.
 		/// </summary>
 		const scope &current_scope() const { return _current_scope; }
+		/// <summary>
+		/// Gets the global scope at the root of the scope chain.
+		/// </summary>
+		const scope &global_scope() const { return _global_scope; }
 
 		/// <summary>
 		/// Inserts an new symbol in the symbol table.
@@ -96,8 +102,22 @@ namespace reshadefx
 		bool resolve_function_call(const std::string &name, const std::vector<expression> &args, const scope &scope, symbol &data, bool &ambiguous) const;
 
 	private:
+		/// <summary>
+		/// Returns the integer handle the specified name string is interned as, adding it to the name table on first use.
+		/// </summary>
+		uint32_t intern_name(const std::string &name);
+		/// <summary>
+		/// Returns the integer handle the specified name string was interned as, or zero if it was never interned (in which case no symbol by that name can exist either).
+		/// </summary>
+		uint32_t find_name(const std::string &name) const;
+
 		scope _current_scope;
-		// Lookup table from name to matching symbols
-		std::unordered_map<std::string, std::vector<scoped_symbol>> _symbol_stack;
+		scope _global_scope;
+		// Interning table mapping symbol and scope name strings to integer handles, so that each lookup only hashes its name string once and all further comparisons are on integers
+		std::unordered_map<std::string, uint32_t> _interned_names;
+		// Lookup table from interned name handle to matching symbols
+		std::unordered_map<uint32_t, std::vector<scoped_symbol>> _symbol_stack;
+		// Name handles and scope levels of the symbols inserted in currently open local scopes, so that <see cref="leave_scope"/> only visits those instead of the entire symbol stack
+		std::vector<std::pair<uint32_t, uint32_t>> _local_symbols;
 	};
 }
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2025 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "file_write_queue.hpp"
+#include "dll_log.hpp"
+#include <cstdio>
+#include <cassert>
+#include <share.h> // SH_DENYNO
+
+// Upper bound on the data waiting to be written, so that a burst of output cannot grow memory usage unchecked
+static constexpr size_t queue_byte_limit = 512 * 1024 * 1024;
+
+reshade::file_write_queue::file_write_queue(size_t num_threads)
+{
+	assert(num_threads != 0);
+
+	_threads.reserve(num_threads);
+	for (size_t thread_index = 0; thread_index < num_threads; ++thread_index)
+		_threads.emplace_back(&file_write_queue::run_worker, this);
+}
+reshade::file_write_queue::~file_write_queue()
+{
+	{	const std::unique_lock<std::mutex> lock(_mutex);
+		_exit_threads = true;
+	}
+
+	_wake_signal.notify_all();
+
+	for (std::thread &thread : _threads)
+		if (thread.joinable())
+			thread.join();
+}
+
+bool reshade::file_write_queue::enqueue(std::filesystem::path &&path, std::vector<uint8_t> &&data, std::function<void(bool success)> callback)
+{
+	{	const std::unique_lock<std::mutex> lock(_mutex);
+
+		// Apply backpressure instead of growing the queue unchecked when the writer threads cannot keep up
+		if (_num_pending_bytes + data.size() > queue_byte_limit)
+			return false;
+
+		_num_pending_jobs++;
+		_num_pending_bytes += data.size();
+		_jobs.push_back({ std::move(path), std::move(data), std::move(callback) });
+	}
+
+	_wake_signal.notify_one();
+
+	return true;
+}
+
+void reshade::file_write_queue::wait()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_finished_signal.wait(lock, [this]() { return _num_pending_jobs == 0; });
+}
+
+void reshade::file_write_queue::run_worker()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (true)
+	{
+		_wake_signal.wait(lock, [this]() { return _exit_threads || !_jobs.empty(); });
+		if (_jobs.empty())
+			break; // Only exit after all queued writes were drained
+
+		write_job job = std::move(_jobs.front());
+		_jobs.pop_front();
+		_num_pending_bytes -= job.data.size();
+
+		lock.unlock();
+
+		bool success = false;
+		// Open with write sharing, so that other applications that watch the output directory are not blocked out
+		if (FILE *const file = _wfsopen(job.path.c_str(), L"wb", SH_DENYNO))
+		{
+			success = fwrite(job.data.data(), 1, job.data.size(), file) == job.data.size() && ferror(file) == 0;
+			fclose(file);
+		}
+
+		if (!success)
+			log::message(log::level::error, "Failed to write file '%s'!", job.path.u8string().c_str());
+
+		if (job.callback != nullptr)
+			job.callback(success);
+
+		lock.lock();
+
+		_num_pending_jobs--;
+		if (_num_pending_jobs == 0)
+			_finished_signal.notify_all();
+	}
+}
+
+reshade::file_write_queue &reshade::get_file_write_queue()
+{
+	// Two writer threads keep the disk busy while one of them is blocked inside the filesystem, without spreading sequential writes too thin
+	// Intentionally leaked, so that writer threads are never joined during process shutdown while the loader lock is held
+	static file_write_queue *const queue = new file_write_queue(2);
+	return *queue;
+}
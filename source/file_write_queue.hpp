@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2025 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <filesystem>
+#include <condition_variable>
+
+namespace reshade
+{
+	/// <summary>
+	/// Write-behind file output queue shared by all effect runtime instances created in this module, so that bulk file output (screenshots, add-on dumps, ...) does not stall the submitting thread.
+	/// </summary>
+	class file_write_queue
+	{
+	public:
+		explicit file_write_queue(size_t num_threads);
+		file_write_queue(const file_write_queue &) = delete;
+		~file_write_queue();
+
+		file_write_queue &operator=(const file_write_queue &) = delete;
+
+		/// <summary>
+		/// Queues writing of the specified buffer to a file on one of the writer threads.
+		/// Fails without queuing anything when the pending data exceeds the queue limit, in which case the caller can fall back to a synchronous write or drop the data.
+		/// </summary>
+		/// <param name="path">Path of the file to create or overwrite.</param>
+		/// <param name="data">Buffer to write, which is consumed by this call on success and left untouched on failure.</param>
+		/// <param name="callback">Optional function that is executed on the writer thread after the write finished, with the success of the write operation.</param>
+		/// <returns><see langword="true"/> if the write was queued, <see langword="false"/> if the queue is saturated.</returns>
+		bool enqueue(std::filesystem::path &&path, std::vector<uint8_t> &&data, std::function<void(bool success)> callback = nullptr);
+
+		/// <summary>
+		/// Blocks the calling thread until all previously queued writes have finished.
+		/// </summary>
+		void wait();
+
+	private:
+		struct write_job
+		{
+			std::filesystem::path path;
+			std::vector<uint8_t> data;
+			std::function<void(bool success)> callback;
+		};
+
+		void run_worker();
+
+		std::vector<std::thread> _threads;
+		std::mutex _mutex;
+		std::condition_variable _wake_signal;
+		std::condition_variable _finished_signal;
+		std::deque<write_job> _jobs;
+		size_t _num_pending_jobs = 0;
+		size_t _num_pending_bytes = 0;
+		bool _exit_threads = false;
+	};
+
+	/// <summary>
+	/// Gets the file write queue shared across all effect runtimes of this module, creating it on first use.
+	/// </summary>
+	file_write_queue &get_file_write_queue();
+}
@@ -4,7 +4,9 @@
  */
 
 #include "dll_log.hpp"
+#include "ini_file.hpp"
 #include "hook_manager.hpp"
+#include "lockfree_linear_map.hpp"
 #include <vector>
 #include <shared_mutex>
 #include <cstring> // std::strcmp
@@ -38,9 +40,13 @@ extern std::filesystem::path g_reshade_dll_path;
 static std::filesystem::path s_export_hook_path;
 static std::shared_mutex s_hooks_mutex;
 static std::vector<named_hook> s_hooks;
+// Lock-free indexes into the hook list, keyed by target and replacement address respectively, so that the hot look ups in 'reshade::hooks::call' do not have to take a mutex and scan the entire list (see 'find_internal')
+static lockfree_linear_map<reshade::hook::address, reshade::hook *, 512> s_hooks_by_target;
+static lockfree_linear_map<reshade::hook::address, reshade::hook *, 512> s_hooks_by_replacement;
 static std::shared_mutex s_delayed_hook_paths_mutex;
 static std::vector<std::filesystem::path> s_delayed_hook_paths;
 static PVOID s_dll_notification_cookie = nullptr;
+static thread_local unsigned int s_transaction_depth = 0;
 
 static std::vector<module_export> enumerate_module_exports(HMODULE handle)
 {
@@ -124,6 +130,12 @@ static bool install_internal(const char *name, reshade::hook &hook, hook_method
 	// Protect access to hook list with a mutex
 	{ const std::unique_lock<std::shared_mutex> lock(s_hooks_mutex);
 		s_hooks.push_back({ hook, name, method });
+
+		// Index the hook by target and replacement address for fast look up (the first installation wins when the same replacement function is used to hook multiple targets, matching the list order above)
+		if (s_hooks_by_target.at(hook.target) == nullptr)
+			s_hooks_by_target.emplace(hook.target, new reshade::hook(hook));
+		if (s_hooks_by_replacement.at(hook.replacement) == nullptr)
+			s_hooks_by_replacement.emplace(hook.replacement, new reshade::hook(hook));
 	}
 
 #if RESHADE_VERBOSE_LOG
@@ -279,6 +291,20 @@ static reshade::hook find_internal(reshade::hook::address target, reshade::hook:
 {
 	assert(target != nullptr || replacement != nullptr);
 
+	// Check the lock-free index first, so that the common case resolves without taking a mutex or scanning the entire hook list
+	if (replacement == nullptr)
+	{
+		if (const reshade::hook *const hook = s_hooks_by_target.at(target))
+			return *hook;
+	}
+	else if (const reshade::hook *const hook = s_hooks_by_replacement.at(replacement))
+	{
+		// Optionally compare the target address too, in case the replacement function is used to hook multiple targets
+		if (target == nullptr || hook->target == target)
+			return *hook;
+	}
+
+	// Fall back to scanning the entire hook list, which also finds hooks sharing their replacement function with the one in the index
 	// Protect access to hook list with a mutex
 	const std::shared_lock<std::shared_mutex> lock(s_hooks_mutex);
 
@@ -313,6 +339,9 @@ static void install_delayed_hooks(const std::filesystem::path &loaded_path)
 	// Ignore this call if unable to acquire the mutex to avoid possible deadlock
 	if (std::unique_lock<std::shared_mutex> lock(s_delayed_hook_paths_mutex, std::try_to_lock); lock.owns_lock())
 	{
+		// Batch the hooks of all modules installed below into a single transaction, so that the threads of the process only need to be suspended and resumed once, rather than once per module
+		reshade::hooks::enter_transaction();
+
 		const auto remove = std::remove_if(s_delayed_hook_paths.begin(), s_delayed_hook_paths.end(),
 			[&loaded_path](const std::filesystem::path &path) {
 				// Pin the module so it cannot be unloaded by the application and cause problems when ReShade tries to call into it afterwards
@@ -322,9 +351,11 @@ static void install_delayed_hooks(const std::filesystem::path &loaded_path)
 
 				reshade::log::message(reshade::log::level::info, "Installing delayed hooks for '%s' (Just loaded via LoadLibrary('%s')) ...", path.u8string().c_str(), loaded_path.u8string().c_str());
 
-				return install_internal(delayed_handle, g_module_handle, hook_method::function_hook) && reshade::hook::apply_queued_actions();
+				return install_internal(delayed_handle, g_module_handle, hook_method::function_hook);
 			});
 
+		reshade::hooks::leave_transaction();
+
 		s_delayed_hook_paths.erase(remove, s_delayed_hook_paths.end());
 	}
 	else
@@ -414,7 +445,7 @@ bool reshade::hooks::install(const char *name, hook::address target, hook::addre
 	hook.replacement = replacement;
 
 	return install_internal(name, hook, hook_method::function_hook) &&
-		(queue_enable || hook::apply_queued_actions()); // Can optionally only queue up the hooks instead of installing them right away
+		(queue_enable || s_transaction_depth != 0 || hook::apply_queued_actions()); // Can optionally only queue up the hooks instead of installing them right away
 }
 bool reshade::hooks::install(const char *name, hook::address vtable[], size_t vtable_index, hook::address replacement)
 {
@@ -432,6 +463,21 @@ bool reshade::hooks::install(const char *name, hook::address vtable[], size_t vt
 
 	return install_internal(name, hook, hook_method::vtable_hook);
 }
+void reshade::hooks::enter_transaction()
+{
+	++s_transaction_depth;
+}
+bool reshade::hooks::leave_transaction()
+{
+	assert(s_transaction_depth != 0);
+
+	// Nested transactions are committed by the outermost one
+	if (--s_transaction_depth != 0)
+		return true;
+
+	return hook::apply_queued_actions();
+}
+
 void reshade::hooks::uninstall()
 {
 	log::message(log::level::info, "Uninstalling %zu hook(s) ...", s_hooks.size());
@@ -444,8 +490,14 @@ void reshade::hooks::uninstall()
 
 	// Afterwards uninstall and remove all hooks from the list
 	for (named_hook &hook_info : s_hooks)
+	{
 		uninstall_internal(hook_info.name, hook_info, hook_info.method);
 
+		// Remove the hook from the fast look up indexes too, deleting the copies stored in them
+		delete s_hooks_by_target.erase(hook_info.target);
+		delete s_hooks_by_replacement.erase(hook_info.replacement);
+	}
+
 	s_hooks.clear();
 
 #ifndef RESHADE_TEST_APPLICATION
@@ -529,13 +581,28 @@ void reshade::hooks::register_module(const std::filesystem::path &target_path)
 
 		s_delayed_hook_paths.push_back(target_path);
 	}
-	else // The target module is already loaded, so we can safely install hooks right away
+	else // The target module is already loaded, so hooks could be installed right away
 	{
+#ifndef RESHADE_TEST_APPLICATION
+		// With lazy hooking enabled, hooking of already loaded modules is also delayed to the first 'LoadLibrary' call the application performs, which moves the installation work out of 'DllMain' during process start
+		// This reduces injection latency, but means a device that is created before the application loads another module is missed, so it is opt-in
+		static const bool lazy_hooking = global_config().get("INSTALL", "LazyHooking");
+		if (lazy_hooking)
+		{
+			log::message(log::level::info, "> Delayed (lazy hooking is enabled).");
+
+			s_delayed_hook_paths.push_back(target_path);
+			return;
+		}
+#endif
+
 		log::message(log::level::info, "> Libraries loaded.");
 
 		install_internal(handle, g_module_handle, hook_method::function_hook);
 
-		hook::apply_queued_actions();
+		// Inside a transaction the enable actions stay queued, so that the hooks of multiple modules are applied in a single batch when it is committed
+		if (s_transaction_depth == 0)
+			hook::apply_queued_actions();
 	}
 }
 
@@ -35,6 +35,16 @@ namespace reshade::hooks
 	/// </summary>
 	void uninstall();
 
+	/// <summary>
+	/// Begins a hook transaction on the calling thread, so that all hooks installed until the matching <see cref="leave_transaction"/> call are only queued up, rather than each being enabled individually.
+	/// Transactions may be nested, in which case the outermost one performs the commit.
+	/// </summary>
+	void enter_transaction();
+	/// <summary>
+	/// Ends the hook transaction started with <see cref="enter_transaction"/> and enables all hooks that were queued during it in a single batch, which suspends and resumes the threads of the process only once.
+	/// </summary>
+	bool leave_transaction();
+
 	/// <summary>
 	/// Registers any matching exports in the specified module and installs or delays their hooking.
 	/// Only call this function while the loader lock is held, since it is not thread-safe.
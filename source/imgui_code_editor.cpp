@@ -10,7 +10,7 @@
 #include <cmath> // std::abs, std::floor, std::fmod
 #include <cctype> // std::isblank, std::tolower
 #include <cstdio> // std::snprintf
-#include <algorithm> // std::max, std::min
+#include <algorithm> // std::count, std::max, std::min
 #include <utf8/unchecked.h>
 #include <imgui.h>
 
@@ -97,6 +97,8 @@ static ImVec2 calc_text_size(const char *text, const char *text_end = nullptr)
 reshade::imgui::code_editor::code_editor()
 {
 	_lines.emplace_back();
+	_colorize_line_states.push_back(false);
+	_colorized_lines.push_back(false);
 }
 
 void reshade::imgui::code_editor::render(const char *title, const uint32_t palette[color_palette_max], bool border, ImFont *font)
@@ -348,6 +350,35 @@ void reshade::imgui::code_editor::render(const char *title, const uint32_t palet
 		}
 	}
 
+	// In on-demand mode only queue colorization for the lines around the visible region, once no other coloring range is pending (see 'set_text')
+	// This assumes the region does not start inside a block comment when it is first scrolled to, which is a reasonable trade-off for very large texts
+	if (_colorize_on_demand && _colorize_line_beg >= _colorize_line_end)
+	{
+		const size_t visible_beg = static_cast<size_t>(std::floor(ImGui::GetScrollY() / char_advance.y));
+		const size_t visible_count = static_cast<size_t>(std::floor(ImGui::GetWindowContentRegionMax().y / char_advance.y));
+
+		// Colorize some lines above and below the visible region too, so that scrolling does not immediately run into uncolored text
+		const size_t region_beg = visible_beg > 100 ? visible_beg - 100 : 0;
+		const size_t region_end = std::min(_lines.size(), visible_beg + visible_count + 500);
+
+		size_t uncolorized_beg = region_end;
+		size_t uncolorized_end = region_end;
+		for (size_t l = region_beg; l < region_end; ++l)
+		{
+			if (!_colorized_lines[l])
+			{
+				uncolorized_beg = std::min(uncolorized_beg, l);
+				uncolorized_end = l + 1;
+			}
+		}
+
+		if (uncolorized_beg < uncolorized_end)
+		{
+			_colorize_line_beg = uncolorized_beg;
+			_colorize_line_end = uncolorized_end;
+		}
+	}
+
 	// Update glyph colors
 	colorize();
 
@@ -756,6 +787,8 @@ void reshade::imgui::code_editor::set_text(const std::string_view text)
 	_undo_base_index = 0;
 	_errors.clear();
 
+	_lines.reserve(static_cast<size_t>(std::count(text.begin(), text.end(), '\n')) + 1);
+
 	std::string_view::const_iterator it = text.begin();
 	if (utf8::starts_with_bom(it, text.end()))
 		it += std::size(utf8::bom);
@@ -776,8 +809,21 @@ void reshade::imgui::code_editor::set_text(const std::string_view text)
 	_cursor_pos.line = std::min(_cursor_pos.line, _lines.size() - 1);
 	_cursor_pos.column = std::min(_cursor_pos.column, _lines[_cursor_pos.line].size());
 
-	_colorize_line_beg = 0;
-	_colorize_line_end = _lines.size();
+	_colorize_line_states.assign(_lines.size(), false);
+	_colorized_lines.assign(_lines.size(), false);
+
+	// For very large texts (e.g. the generated code viewer) stepping through the entire document would occupy many frames, so only colorize lines around the visible region on demand instead (see 'render')
+	_colorize_on_demand = _lines.size() > 10000;
+	if (_colorize_on_demand)
+	{
+		_colorize_line_beg = std::numeric_limits<size_t>::max();
+		_colorize_line_end = 0;
+	}
+	else
+	{
+		_colorize_line_beg = 0;
+		_colorize_line_end = _lines.size();
+	}
 }
 void reshade::imgui::code_editor::clear_text()
 {
@@ -919,6 +965,10 @@ void reshade::imgui::code_editor::insert_character(uint32_t c, bool auto_indent)
 		std::vector<glyph> &new_line = *_lines.emplace(_lines.begin() + _cursor_pos.line + 1);
 		std::vector<glyph> &line = _lines[_cursor_pos.line];
 
+		// The entry state of the new line is filled in when it is colorized below
+		_colorize_line_states.insert(_colorize_line_states.begin() + _cursor_pos.line + 1, false);
+		_colorized_lines.insert(_colorized_lines.begin() + _cursor_pos.line + 1, false);
+
 		// Auto indentation
 		if (auto_indent && _cursor_pos.column == line.size())
 		{
@@ -1256,6 +1306,8 @@ void reshade::imgui::code_editor::delete_lines(size_t first_line, size_t last_li
 	_errors = std::move(errors);
 
 	_lines.erase(_lines.begin() + first_line, _lines.begin() + last_line + 1);
+	_colorize_line_states.erase(_colorize_line_states.begin() + first_line, _colorize_line_states.begin() + last_line + 1);
+	_colorized_lines.erase(_colorized_lines.begin() + first_line, _colorized_lines.begin() + last_line + 1);
 }
 
 void reshade::imgui::code_editor::clipboard_copy()
@@ -1626,7 +1678,11 @@ void reshade::imgui::code_editor::move_lines_up()
 		return;
 
 	for (size_t line = _select_beg.line; line <= _select_end.line; ++line)
+	{
 		std::swap(_lines[line], _lines[line - 1]);
+		_colorize_line_states.swap(_colorize_line_states[line], _colorize_line_states[line - 1]);
+		_colorized_lines.swap(_colorized_lines[line], _colorized_lines[line - 1]);
+	}
 
 	_select_beg.line--;
 	_select_end.line--;
@@ -1638,7 +1694,11 @@ void reshade::imgui::code_editor::move_lines_down()
 		return;
 
 	for (size_t line = _select_end.line; line >= _select_beg.line && line < _lines.size(); --line)
+	{
 		std::swap(_lines[line], _lines[line + 1]);
+		_colorize_line_states.swap(_colorize_line_states[line], _colorize_line_states[line + 1]);
+		_colorized_lines.swap(_colorized_lines[line], _colorized_lines[line + 1]);
+	}
 
 	_select_beg.line++;
 	_select_end.line++;
@@ -1780,8 +1840,10 @@ void reshade::imgui::code_editor::colorize()
 	if (_colorize_line_beg >= _colorize_line_end)
 		return;
 
+	assert(_colorize_line_states.size() == _lines.size() && _colorized_lines.size() == _lines.size());
+
 	// Step through code incrementally rather than coloring everything at once
-	const size_t from = _colorize_line_beg, to = std::min(from + 1000, _colorize_line_end);
+	const size_t from = _colorize_line_beg, to = std::min(std::min(from + 1000, _colorize_line_end), _lines.size());
 	_colorize_line_beg = to;
 
 	// Reset coloring range if we have finished coloring it after this iteration
@@ -1793,9 +1855,27 @@ void reshade::imgui::code_editor::colorize()
 		_colorize_line_end = 0;
 	}
 
+	if (from >= to)
+		return; // The requested coloring range no longer exists (e.g. after lines were deleted)
+
+	// Mark all lines this window spans as colorized, so that on-demand colorization does not request them again (see 'render')
+	for (size_t l = from; l < to; ++l)
+		_colorized_lines[l] = true;
+
+	// The entry state of the first line decides whether lexing resumes inside a block comment (the first line of the text always starts outside of one)
+	const bool in_comment = _colorize_line_states[from];
+	// Remember the stored entry state of the line following this window, to check below whether this colorization changed it
+	const bool next_entry_state = to < _colorize_line_states.size() && _colorize_line_states[to];
+
+	// Reset the entry state of all lines this window spans, it is filled back in while painting comment tokens below
+	for (size_t l = from + 1; l <= to && l < _colorize_line_states.size(); ++l)
+		_colorize_line_states[l] = false;
+
 	// Copy lines into string for consumption by the lexer (needs to use the same offsets as the indices in '_lines', so strip any unicode characters which are multi-byte)
 	std::string input_string;
-	for (size_t l = from; l < to && l < _lines.size(); ++l, input_string.push_back('\n'))
+	if (in_comment)
+		input_string = "/*\n"; // Prepend a synthetic line that opens a block comment, so that the lexer starts out in the correct state
+	for (size_t l = from; l < to; ++l, input_string.push_back('\n'))
 		for (size_t k = 0; k < _lines[l].size(); ++k)
 			input_string += _lines[l][k].c < 0x80 ? static_cast<char>(_lines[l][k].c) : '?';
 
@@ -1808,6 +1888,8 @@ void reshade::imgui::code_editor::colorize()
 		false /* ignore_keywords */,
 		false /* escape_string_literals */);
 
+	bool exit_in_comment = false;
+
 	for (reshadefx::token tok; (tok = lexer.lex()).id != reshadefx::tokenid::end_of_file;)
 	{
 		color col = color_default;
@@ -2014,23 +2096,51 @@ void reshade::imgui::code_editor::colorize()
 			break;
 		case reshadefx::tokenid::multi_line_comment:
 			col = color_multiline_comment;
+			// The input always ends in a line feed, so a comment token that runs all the way to the end of it has to be missing its closing sequence and leaves the following lines inside the comment
+			if (tok.offset + tok.length == lexer.input_string().size())
+				exit_in_comment = true;
 			break;
 		}
 
 		// Update character range matching the current the token
-		size_t line = from + tok.location.line - 1;
+		size_t line = from + tok.location.line - (in_comment ? 2 : 1);
 		size_t column = tok.location.column - 1;
+		size_t k = 0;
 
-		for (size_t k = 0; k < tok.length; ++k)
+		if (in_comment && tok.location.line == 1)
+		{
+			// The only token that can start on the synthetic line prepended above is the block comment it opens, so skip over those prefix characters
+			assert(tok.id == reshadefx::tokenid::multi_line_comment && tok.offset == 0);
+			k = 3;
+			line = from;
+			column = 0;
+		}
+
+		for (; k < tok.length; ++k)
 		{
 			if (column >= _lines[line].size())
 			{
 				line++;
 				column = 0;
+				// Crossing a line feed while inside this token means a block comment is continuing onto the next line
+				if (col == color_multiline_comment && line < _colorize_line_states.size())
+					_colorize_line_states[line] = true;
 				continue;
 			}
 
 			_lines[line][column++].col = col;
 		}
 	}
+
+	// Propagate the exit state of this window and keep colorizing while the entry state of the following line changed, since its coloring was calculated based on the old state
+	if (to < _colorize_line_states.size())
+	{
+		_colorize_line_states[to] = exit_in_comment;
+
+		if (exit_in_comment != next_entry_state)
+		{
+			_colorize_line_beg = std::min(_colorize_line_beg, to);
+			_colorize_line_end = std::max(_colorize_line_end, to + 1);
+		}
+	}
 }
@@ -275,5 +275,10 @@ namespace reshade::imgui
 
 		size_t _colorize_line_beg = 0;
 		size_t _colorize_line_end = 0;
+		// Whether a line begins inside a block comment, so that colorization can resume mid-state and only continues into lines whose entry state changed (see 'colorize')
+		std::vector<bool> _colorize_line_states;
+		// Only colorize lines around the visible region on demand for very large texts, instead of stepping through the entire document (see 'set_text' and 'render')
+		bool _colorize_on_demand = false;
+		std::vector<bool> _colorized_lines;
 	};
 }
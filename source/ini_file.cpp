@@ -4,15 +4,94 @@
  */
 
 #include "ini_file.hpp"
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <shared_mutex>
+#include <unordered_map>
+#include <condition_variable>
 #include <cctype> // std::toupper
+#include <cstring> // std::memcmp
 #include <cassert>
-#include <algorithm> // std::min, std::sort, std::transform
+#include <algorithm> // std::find_if, std::min, std::sort, std::transform
 #include <utf8/core.h>
+#include <io.h> // _chsize_s
 
 static std::shared_mutex s_ini_cache_mutex;
 static std::unordered_map<std::wstring, std::unique_ptr<ini_file>> s_ini_cache;
 
+// Callback invoked whenever the contents of any INI file change (see 'ini_file::set_modified_callback')
+static void (*s_ini_modified_callback)(const ini_file &) = nullptr;
+
+// Serialized file contents waiting to be written to disk by a background writer thread, so that the periodic cache flush does not perform blocking file I/O inside 'on_present' (see 'ini_file::save')
+struct pending_ini_write
+{
+	std::filesystem::path path;
+	std::string data;
+	size_t patch_offset = 0;
+	size_t previous_size = 0;
+};
+
+static std::mutex s_ini_write_mutex;
+static std::condition_variable s_ini_write_signal;
+static std::deque<pending_ini_write> s_ini_write_queue;
+static bool s_ini_write_busy = false;
+static bool s_ini_write_failed = false;
+static bool s_ini_write_exit = false;
+static std::thread s_ini_writer;
+
+static bool write_ini_file(const pending_ini_write &pending_write)
+{
+	FILE *file = nullptr;
+	size_t patch_offset = pending_write.patch_offset;
+	if (patch_offset != 0)
+		file = _wfsopen(pending_write.path.c_str(), L"r+b", SH_DENYWR);
+	if (file != nullptr)
+	{
+		fseek(file, static_cast<long>(patch_offset), SEEK_SET);
+	}
+	else
+	{
+		// Fall back to rewriting the entire file when it cannot be patched (e.g. because it was deleted since the last save)
+		patch_offset = 0;
+		file = _wfsopen(pending_write.path.c_str(), L"wb", SH_DENYWR);
+		if (file == nullptr)
+			return false;
+	}
+
+	const size_t file_size_written = fwrite(pending_write.data.data() + patch_offset, 1, pending_write.data.size() - patch_offset, file);
+	// Remove any leftover data from the previous contents in case the file shrunk
+	if (pending_write.data.size() < pending_write.previous_size)
+		_chsize_s(_fileno(file), static_cast<long long>(pending_write.data.size()));
+	fclose(file);
+
+	return file_size_written == pending_write.data.size() - patch_offset;
+}
+
+static const struct scoped_ini_writer
+{
+	~scoped_ini_writer()
+	{
+		{	const std::unique_lock<std::mutex> lock(s_ini_write_mutex);
+			s_ini_write_exit = true;
+		}
+		s_ini_write_signal.notify_all();
+
+		// Cannot join the writer thread here, since this may run under the loader lock during DLL detach, which the exiting thread would need to acquire as well
+		if (s_ini_writer.joinable())
+			s_ini_writer.detach();
+
+		// Instead write out any remaining files on this thread (only attempt to lock, since during process exit the writer thread may have been terminated while holding the lock)
+		if (s_ini_write_mutex.try_lock())
+		{
+			for (const pending_ini_write &pending_write : s_ini_write_queue)
+				write_ini_file(pending_write);
+			s_ini_write_queue.clear();
+			s_ini_write_mutex.unlock();
+		}
+	}
+} s_ini_writer_scope;
+
 ini_file &reshade::global_config()
 {
 	return ini_file::load_cache(g_reshade_base_path / L"ReShade.ini");
@@ -23,6 +102,21 @@ ini_file::ini_file(const std::filesystem::path &path) : _path(path)
 	load();
 }
 
+void ini_file::mark_modified()
+{
+	_modified = true;
+	_modified_at = std::filesystem::file_time_type::clock::now();
+	++_generation;
+
+	if (s_ini_modified_callback != nullptr)
+		s_ini_modified_callback(*this);
+}
+
+void ini_file::set_modified_callback(void(*callback)(const ini_file &file))
+{
+	s_ini_modified_callback = callback;
+}
+
 bool ini_file::load()
 {
 	std::error_code ec;
@@ -32,31 +126,44 @@ bool ini_file::load()
 
 	// Clear when file does not exist too
 	_sections.clear();
+	// The file contents on disk may differ from the last saved data (different formatting, comments, ...), so a patch-based save is no longer possible (see 'save')
+	_save_data.clear();
+
+	// The contents are about to change, so advance the generation and notify (do this even when the file no longer exists and the sections stay empty)
+	++_generation;
+	if (s_ini_modified_callback != nullptr)
+		s_ini_modified_callback(*this);
 
-	FILE *const file = _wfsopen(_path.c_str(), L"r", SH_DENYWR);
+	FILE *const file = _wfsopen(_path.c_str(), L"rb", SH_DENYWR);
 	if (file == nullptr)
 		return false;
 
 	_modified = false;
 	_modified_at = modified_at;
 
+	// Read the entire file into memory in one go and parse it with views into that buffer, instead of reading it line by line into a temporary buffer that has to be grown to the longest line
+	fseek(file, 0, SEEK_END);
+	const long file_size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	std::string data(static_cast<size_t>(file_size), '\0');
+	const size_t file_size_read = fread(data.data(), 1, data.size(), file);
+	fclose(file);
+	if (file_size_read != data.size())
+		return false;
+
+	std::string_view remaining_data(data);
+
 	// Remove BOM (0xefbbbf means 0xfeff)
-	if (fgetc(file) != utf8::bom[0] || fgetc(file) != utf8::bom[1] || fgetc(file) != utf8::bom[2])
-		fseek(file, 0, SEEK_SET);
+	if (remaining_data.size() >= 3 && std::memcmp(remaining_data.data(), utf8::bom, 3) == 0)
+		remaining_data.remove_prefix(3);
 
-	std::string line_data, section;
-	line_data.resize(BUFSIZ);
-	while (fgets(line_data.data(), static_cast<int>(line_data.size() + 1), file))
+	std::string section;
+	while (!remaining_data.empty())
 	{
-		size_t line_length;
-		while ((line_length = std::strlen(line_data.data())) == line_data.size())
-		{
-			line_data.resize(line_data.size() + BUFSIZ);
-			if (!fgets(line_data.data() + line_length, static_cast<int>(line_data.size() - line_length + 1), file))
-				break;
-		}
-
-		const std::string_view line = trim(std::string_view(line_data.data(), line_length), " \t\r\n");
+		const size_t eol = remaining_data.find('\n');
+		const std::string_view line = trim(remaining_data.substr(0, eol), " \t\r\n");
+		remaining_data.remove_prefix(eol != std::string_view::npos ? eol + 1 : remaining_data.size());
 
 		if (line.empty() || line[0] == ';' || line[0] == '/' || line[0] == '#')
 			continue;
@@ -115,11 +222,9 @@ bool ini_file::load()
 		}
 	}
 
-	fclose(file);
-
 	return true;
 }
-bool ini_file::save()
+bool ini_file::save(bool async)
 {
 	if (!_modified)
 		return true;
@@ -203,13 +308,121 @@ bool ini_file::save()
 		}
 	}
 
-	FILE *const file = _wfsopen(_path.c_str(), L"w", SH_DENYWR);
-	if (file == nullptr)
-		return false;
-	const size_t file_size_written = fwrite(data.data(), 1, data.size(), file);
-	fclose(file);
-	if (file_size_written != data.size())
+	// Convert to CRLF line endings, so that the data matches the representation on disk and can be compared and patched with byte offsets below (files were previously written in text mode, which performed the same translation)
+	for (size_t offset = 0; (offset = data.find('\n', offset)) != std::string::npos; offset += 2)
+		data.replace(offset, 1, "\r\n", 2);
+
+	// Find the first byte that differs from the data written by the last save, so that only the changed tail of the file has to be rewritten
+	// Sections are always serialized in sorted order, so a change to a single value leaves everything before its section untouched
+	size_t patch_offset = 0;
+	if (!_save_data.empty())
+	{
+		const size_t common_size = std::min(data.size(), _save_data.size());
+		while (patch_offset < common_size && data[patch_offset] == _save_data[patch_offset])
+			patch_offset++;
+
+		if (patch_offset == data.size() && data.size() == _save_data.size())
+			return true; // Data did not effectively change, so can skip the file write entirely
+	}
+
+	pending_ini_write pending_write;
+	pending_write.path = _path;
+	pending_write.patch_offset = patch_offset;
+	pending_write.previous_size = _save_data.size();
+
+	if (async)
+	{
+		// Start the background writer thread that drains the write queue on first use (this is only ever requested from the periodic flush in 'on_present', so never under the loader lock)
+		if (!s_ini_writer.joinable())
+		{
+			s_ini_writer = std::thread([]() {
+				std::unique_lock<std::mutex> lock(s_ini_write_mutex);
+				while (true)
+				{
+					s_ini_write_signal.wait(lock, []() { return s_ini_write_exit || !s_ini_write_queue.empty(); });
+					if (s_ini_write_queue.empty())
+						break; // Only exit once all queued files were written (any remaining ones after a forced exit are written out during shutdown, see 'scoped_ini_writer')
+
+					const pending_ini_write pending_write = std::move(s_ini_write_queue.front());
+					s_ini_write_queue.pop_front();
+
+					// Do not hold the lock during the file write, so that saving threads are never blocked on it
+					s_ini_write_busy = true;
+					lock.unlock();
+					const bool success = write_ini_file(pending_write);
+					lock.lock();
+					s_ini_write_busy = false;
+
+					if (success)
+					{
+						// Re-stamp the modification time with the actual file time on disk, so that the next 'load' does not mistake this write for an external modification
+						std::error_code ec;
+						const std::filesystem::file_time_type modified_at = std::filesystem::last_write_time(pending_write.path, ec);
+
+						const std::shared_lock<std::shared_mutex> cache_lock(s_ini_cache_mutex);
+						if (const auto it = s_ini_cache.find(pending_write.path);
+							it != s_ini_cache.end() && !ec)
+							it->second->_modified_at = modified_at;
+					}
+					else
+					{
+						s_ini_write_failed = true;
+					}
+
+					// Wake up any thread waiting for the queue to drain in a synchronous save
+					s_ini_write_signal.notify_all();
+
+					if (s_ini_write_exit && s_ini_write_queue.empty())
+						break;
+				}
+			});
+		}
+
+		pending_write.data = data;
+		_save_data = std::move(data);
+
+		{	const std::unique_lock<std::mutex> lock(s_ini_write_mutex);
+
+			// Coalesce with a write to the same file that is still queued, keeping the patch range and truncation size that cover both
+			if (const auto it = std::find_if(s_ini_write_queue.begin(), s_ini_write_queue.end(),
+					[this](const pending_ini_write &queued_write) { return queued_write.path == _path; });
+				it != s_ini_write_queue.end())
+			{
+				it->data = std::move(pending_write.data);
+				it->patch_offset = std::min(it->patch_offset, pending_write.patch_offset);
+			}
+			else
+			{
+				s_ini_write_queue.push_back(std::move(pending_write));
+			}
+		}
+
+		s_ini_write_signal.notify_one();
+
+		// Assume the write will succeed shortly (failures are reported by the next 'flush_cache')
+		_modified_at = std::filesystem::file_time_type::clock::now();
+
+		return true;
+	}
+
+	if (s_ini_writer.joinable())
+	{
+		// Wait for the background writer to finish all pending writes first, so that writes to the same file stay ordered
+		std::unique_lock<std::mutex> lock(s_ini_write_mutex);
+		s_ini_write_signal.notify_all();
+		s_ini_write_signal.wait(lock, []() { return s_ini_write_queue.empty() && !s_ini_write_busy; });
+	}
+
+	pending_write.data = std::move(data);
+	const bool success = write_ini_file(pending_write);
+	_save_data = std::move(pending_write.data);
+
+	if (!success)
+	{
+		// The contents on disk are in an unknown state after a failed write, so force a full rewrite on the next save
+		_save_data.clear();
 		return false;
+	}
 
 	// Flush stream to disk before updating last write time
 	_modified_at = std::filesystem::last_write_time(_path, ec);
@@ -229,7 +442,14 @@ bool ini_file::flush_cache()
 	for (auto &file : s_ini_cache)
 		// Check modified status before requesting file time, since the latter is costly and therefore should be avoided when not necessary
 		if (file.second->_modified && (std::filesystem::file_time_type::clock::now() - file.second->_modified_at) > std::chrono::seconds(1))
-			success &= file.second->save();
+			// Hand the file write off to the background writer, since this is called every frame inside 'on_present'
+			success &= file.second->save(true);
+
+	// Report any background writes that have failed since the last flush
+	{	const std::unique_lock<std::mutex> write_lock(s_ini_write_mutex);
+		success &= !s_ini_write_failed;
+		s_ini_write_failed = false;
+	}
 
 	return success;
 }
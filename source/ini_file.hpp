@@ -5,10 +5,10 @@
 
 #pragma once
 
+#include <map>
 #include <string>
 #include <vector>
 #include <filesystem>
-#include <unordered_map>
 
 extern std::filesystem::path g_reshade_dll_path;
 extern std::filesystem::path g_reshade_base_path;
@@ -34,10 +34,15 @@ public:
 	/// </summary>
 	const std::filesystem::path &path() const { return _path; }
 
+	/// <summary>
+	/// Gets a counter that is incremented every time the contents of this INI file change (including reloads from disk), so that callers can cheaply detect changes without comparing values.
+	/// </summary>
+	size_t generation() const { return _generation; }
+
 	/// <summary>
 	/// Checks whether the specified <paramref name="section"/> and <paramref name="key"/> currently exist in the INI.
 	/// </summary>
-	bool has(const std::string &section, const std::string &key) const
+	bool has(std::string_view section, std::string_view key) const
 	{
 		const auto it1 = _sections.find(section);
 		if (it1 == _sections.end())
@@ -54,7 +59,7 @@ public:
 	/// <param name="value">Reference filled with the data of this INI entry.</param>
 	/// <returns><see langword="true"/> if the key exists, <see langword="false"/> otherwise.</returns>
 	template <typename T>
-	bool get(const std::string &section, const std::string &key, T &value) const
+	bool get(std::string_view section, std::string_view key, T &value) const
 	{
 		const auto it1 = _sections.find(section);
 		if (it1 == _sections.end())
@@ -66,7 +71,7 @@ public:
 		return true;
 	}
 	template <typename T, size_t SIZE>
-	bool get(const std::string &section, const std::string &key, T(&values)[SIZE]) const
+	bool get(std::string_view section, std::string_view key, T(&values)[SIZE]) const
 	{
 		const auto it1 = _sections.find(section);
 		if (it1 == _sections.end())
@@ -79,7 +84,7 @@ public:
 		return true;
 	}
 	template <typename T>
-	bool get(const std::string &section, const std::string &key, std::vector<T> &values) const
+	bool get(std::string_view section, std::string_view key, std::vector<T> &values) const
 	{
 		const auto it1 = _sections.find(section);
 		if (it1 == _sections.end())
@@ -93,7 +98,7 @@ public:
 		return true;
 	}
 	template <>
-	bool get(const std::string &section, const std::string &key, std::vector<std::pair<std::string, std::string>> &values) const
+	bool get(std::string_view section, std::string_view key, std::vector<std::pair<std::string, std::string>> &values) const
 	{
 		const auto it1 = _sections.find(section);
 		if (it1 == _sections.end())
@@ -114,11 +119,28 @@ public:
 		return true;
 	}
 
+	/// <summary>
+	/// Gets a copy of all key/value pairs of the specified <paramref name="section"/> from the INI.
+	/// </summary>
+	/// <param name="values">Reference filled with the data of this INI section.</param>
+	/// <returns><see langword="true"/> if the section exists, <see langword="false"/> otherwise.</returns>
+	bool get(std::string_view section, std::map<std::string, std::vector<std::string>, std::less<>> &values) const
+	{
+		const auto it1 = _sections.find(section);
+		if (it1 == _sections.end())
+		{
+			values.clear();
+			return false;
+		}
+		values = it1->second;
+		return true;
+	}
+
 	/// <summary>
 	/// Returns <see langword="true"/> only if the specified <paramref name="section"/> and <paramref name="key"/> exists and is not zero.
 	/// </summary>
 	/// <returns><see langword="true"/> if the key exists and is not zero, <see langword="false"/> otherwise.</returns>
-	bool get(const std::string &section, const std::string &key) const
+	bool get(std::string_view section, std::string_view key) const
 	{
 		bool value = false;
 		return get<bool>(section, key, value) && value;
@@ -129,95 +151,91 @@ public:
 	/// </summary>
 	/// <param name="value">Data to set this INI entry to.</param>
 	template <typename T>
-	void set(const std::string &section, const std::string &key, const T &value)
+	void set(std::string_view section, std::string_view key, const T &value)
 	{
 		set(section, key, std::to_string(value));
 	}
 	template <>
-	void set(const std::string &section, const std::string &key, const bool &value)
+	void set(std::string_view section, std::string_view key, const bool &value)
 	{
 		set<std::string>(section, key, value ? "1" : "0");
 	}
 	template <>
-	void set(const std::string &section, const std::string &key, const std::string &value)
+	void set(std::string_view section, std::string_view key, const std::string &value)
 	{
-		auto &v = _sections[section][key];
+		auto &v = insert_value(section, key);
+		if (v.size() == 1 && v[0] == value)
+			return; // Skip marking as modified when the value did not actually change, to avoid unnecessary file writes
 		v.assign(1, value);
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
+		mark_modified();
 	}
-	void set(const std::string &section, const std::string &key, std::string &&value)
+	void set(std::string_view section, std::string_view key, std::string &&value)
 	{
-		auto &v = _sections[section][key];
+		auto &v = insert_value(section, key);
+		if (v.size() == 1 && v[0] == value)
+			return;
 		v.resize(1);
 		v[0] = std::forward<std::string>(value);
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
+		mark_modified();
 	}
 	template <>
-	void set(const std::string &section, const std::string &key, const std::filesystem::path &value)
+	void set(std::string_view section, std::string_view key, const std::filesystem::path &value)
 	{
 		set(section, key, value.u8string());
 	}
 	template <typename T, size_t SIZE>
-	void set(const std::string &section, const std::string &key, const T(&values)[SIZE], const size_t size = SIZE)
+	void set(std::string_view section, std::string_view key, const T(&values)[SIZE], const size_t size = SIZE)
 	{
-		auto &v = _sections[section][key];
-		v.resize(size);
+		value_type elements(size);
 		for (size_t i = 0; i < size; ++i)
-			v[i] = std::to_string(values[i]);
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
+			elements[i] = std::to_string(values[i]);
+		set(section, key, std::move(elements));
 	}
 	template <typename T>
-	void set(const std::string &section, const std::string &key, const std::vector<T> &values)
+	void set(std::string_view section, std::string_view key, const std::vector<T> &values)
 	{
-		auto &v = _sections[section][key];
-		v.resize(values.size());
+		value_type elements(values.size());
 		for (size_t i = 0; i < values.size(); ++i)
-			v[i] = std::to_string(values[i]);
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
+			elements[i] = std::to_string(values[i]);
+		set(section, key, std::move(elements));
 	}
 	template <>
-	void set(const std::string &section, const std::string &key, const std::vector<std::string> &values)
+	void set(std::string_view section, std::string_view key, const std::vector<std::string> &values)
 	{
-		auto &v = _sections[section][key];
+		auto &v = insert_value(section, key);
+		if (v == values)
+			return;
 		v = values;
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
+		mark_modified();
 	}
-	void set(const std::string &section, const std::string &key, std::vector<std::string> &&values)
+	void set(std::string_view section, std::string_view key, std::vector<std::string> &&values)
 	{
-		auto &v = _sections[section][key];
+		auto &v = insert_value(section, key);
+		if (v == values)
+			return;
 		v = std::forward<std::vector<std::string>>(values);
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
+		mark_modified();
 	}
 	template <>
-	void set(const std::string &section, const std::string &key, const std::vector<std::pair<std::string, std::string>> &values)
+	void set(std::string_view section, std::string_view key, const std::vector<std::pair<std::string, std::string>> &values)
 	{
-		auto &v = _sections[section][key];
-		v.resize(values.size());
+		value_type elements(values.size());
 		for (size_t i = 0; i < values.size(); ++i)
 		{
 			const std::pair<std::string, std::string> &value = values[i];
-			v[i] = value.first;
+			elements[i] = value.first;
 			if (!value.second.empty())
-				v[i] += '=' + value.second;
+				elements[i] += '=' + value.second;
 		}
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
+		set(section, key, std::move(elements));
 	}
 	template <>
-	void set(const std::string &section, const std::string &key, const std::vector<std::filesystem::path> &values)
+	void set(std::string_view section, std::string_view key, const std::vector<std::filesystem::path> &values)
 	{
-		auto &v = _sections[section][key];
-		v.resize(values.size());
+		value_type elements(values.size());
 		for (size_t i = 0; i < values.size(); ++i)
-			v[i] = values[i].u8string();
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
+			elements[i] = values[i].u8string();
+		set(section, key, std::move(elements));
 	}
 
 	/// <summary>
@@ -226,14 +244,13 @@ public:
 	void clear()
 	{
 		_sections.clear();
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
+		mark_modified();
 	}
 
 	/// <summary>
 	/// Removes the specified <paramref name="key"/> from the <paramref name="section"/>.
 	/// </summary>
-	void remove_key(const std::string &section, const std::string &key)
+	void remove_key(std::string_view section, std::string_view key)
 	{
 		const auto it1 = _sections.find(section);
 		if (it1 == _sections.end())
@@ -242,8 +259,7 @@ public:
 		if (it2 == it1->second.end())
 			return;
 		it1->second.erase(it2);
-		_modified = true;
-		_modified_at = std::filesystem::file_time_type::clock::now();
+		mark_modified();
 	}
 
 	/// <summary>
@@ -253,7 +269,8 @@ public:
 	/// <summary>
 	/// Saves all changes to this INI file to disk.
 	/// </summary>
-	bool save();
+	/// <param name="async">Hand the file write off to a background writer thread, rather than blocking on it.</param>
+	bool save(bool async = false);
 
 	/// <summary>
 	/// Saves all changes to INI files that were loaded through <see cref="load_cache"/> to disk.
@@ -274,6 +291,12 @@ public:
 	/// <returns>Reference to the cached data.</returns>
 	static ini_file &load_cache(std::filesystem::path path);
 
+	/// <summary>
+	/// Installs a callback that is invoked whenever the contents of any INI file change (replacing any previously installed one), so that interested parties do not have to poll for changes.
+	/// The callback may be invoked from arbitrary threads and potentially while internal locks are held, so it must not access any INI files itself and should only set a flag or similar.
+	/// </summary>
+	static void set_modified_callback(void(*callback)(const ini_file &file));
+
 private:
 	template <typename T>
 	static const T convert(const std::vector<std::string> &values, size_t i) = delete;
@@ -340,12 +363,32 @@ private:
 	/// <summary>
 	/// Describes a section of multiple key/value pairs in an INI file.
 	/// </summary>
-	using section_type = std::unordered_map<std::string, value_type>;
+	// Use a transparent comparator, so that lookups can be performed with string views without materializing temporary key strings
+	using section_type = std::map<std::string, value_type, std::less<>>;
+
+	/// <summary>
+	/// Finds the value of the specified <paramref name="section"/> and <paramref name="key"/>, inserting them when they do not exist yet.
+	/// </summary>
+	value_type &insert_value(std::string_view section, std::string_view key)
+	{
+		const auto it1 = _sections.find(section);
+		section_type &keys = it1 != _sections.end() ? it1->second : _sections.emplace(section, section_type()).first->second;
+		const auto it2 = keys.find(key);
+		return it2 != keys.end() ? it2->second : keys.emplace(key, value_type()).first->second;
+	}
+
+	/// <summary>
+	/// Marks this INI file as modified, so that it is written to disk by the next cache flush, and notifies the modified callback.
+	/// </summary>
+	void mark_modified();
 
 	const std::filesystem::path _path;
-	std::unordered_map<std::string, section_type> _sections;
+	std::map<std::string, section_type, std::less<>> _sections;
+	size_t _generation = 0;
 	bool _modified = false;
 	std::filesystem::file_time_type _modified_at;
+	// Data written to disk by the last save, used to only write the changed tail of the file on subsequent saves (see 'save')
+	std::string _save_data;
 };
 
 namespace reshade
@@ -6,6 +6,7 @@
 #include "input.hpp"
 #include "dll_log.hpp"
 #include "hook_manager.hpp"
+#include <atomic>
 #include <shared_mutex>
 #include <unordered_map>
 #include <cstring> // std::memset
@@ -18,6 +19,8 @@ extern HANDLE g_exit_event;
 static std::shared_mutex s_windows_mutex;
 static std::unordered_map<HWND, unsigned int> s_raw_input_windows;
 static std::unordered_map<HWND, std::weak_ptr<reshade::input>> s_windows;
+// Incremented whenever the windows lists above are modified, to invalidate any cached look up results (see 'input::handle_window_message')
+static std::atomic<uint32_t> s_windows_version = { 0 };
 static RECT s_last_clip_cursor = {};
 static POINT s_last_cursor_position = {};
 
@@ -39,6 +42,8 @@ void reshade::input::register_window_with_raw_input(window_handle window, bool n
 	const auto insert = s_raw_input_windows.emplace(static_cast<HWND>(window), flags);
 
 	if (!insert.second) insert.first->second |= flags;
+
+	s_windows_version.fetch_add(1, std::memory_order_release);
 }
 std::shared_ptr<reshade::input> reshade::input::register_window(window_handle window)
 {
@@ -65,6 +70,8 @@ std::shared_ptr<reshade::input> reshade::input::register_window(window_handle wi
 		const auto instance = std::make_shared<input>(window);
 		insert.first->second = instance;
 
+		s_windows_version.fetch_add(1, std::memory_order_release);
+
 		return instance;
 	}
 	else
@@ -86,53 +93,79 @@ bool reshade::input::handle_window_message(const void *message_data)
 	if (details.message != WM_INPUT && !is_mouse_message && !is_keyboard_message)
 		return false;
 
-	// Guard access to windows list against race conditions
-	std::unique_lock<std::shared_mutex> lock(s_windows_mutex);
-
-	// Remove any expired entry from the list
-	for (auto it = s_windows.begin(); it != s_windows.end();)
-		if (it->second.expired())
-			it = s_windows.erase(it);
-		else
-			++it;
+	// Check the window this thread looked up last first, so that high-frequency input (e.g. from high polling rate mice) does not have to take the lock and walk the windows list for every message
+	// The cached result is only used when the windows lists were not modified since it was cached (see also 'lockfree_linear_map' which uses the same scheme)
+	thread_local struct { HWND window; uint32_t version; unsigned int raw_input_flags; std::weak_ptr<reshade::input> instance; } s_last_window_lookup;
+	const uint32_t version = s_windows_version.load(std::memory_order_acquire);
 
-	// Look up the window in the list of known input windows
-	auto input_window = s_windows.find(details.hwnd);
-	const auto raw_input_window = s_raw_input_windows.find(details.hwnd);
+	std::shared_ptr<input> input;
+	unsigned int raw_input_flags = 0;
 
-	if (input_window == s_windows.end())
+	if (s_last_window_lookup.window == details.hwnd && s_last_window_lookup.version == version)
 	{
-		// Walk through the window chain and until an known window is found
-		EnumChildWindows(details.hwnd, [](HWND hwnd, LPARAM lparam) -> BOOL {
-			auto &input_window = *reinterpret_cast<decltype(s_windows)::iterator *>(lparam);
-			// Return true to continue enumeration
-			return (input_window = s_windows.find(hwnd)) == s_windows.end();
-		}, reinterpret_cast<LPARAM>(&input_window));
-	}
-	if (input_window == s_windows.end())
-	{
-		// Some applications handle input in a child window to the main render window
-		if (const HWND parent = GetParent(details.hwnd); parent != NULL)
-			input_window = s_windows.find(parent);
+		input = s_last_window_lookup.instance.lock();
+		raw_input_flags = s_last_window_lookup.raw_input_flags;
 	}
 
-	if (input_window == s_windows.end() && raw_input_window != s_raw_input_windows.end())
+	if (input == nullptr)
 	{
-		// Reroute this raw input message to the window with the most rendering
-		input_window = std::max_element(s_windows.begin(), s_windows.end(),
-			[](auto lhs, auto rhs) { return lhs.second.lock()->_frame_count < rhs.second.lock()->_frame_count; });
-	}
+		// Guard access to windows list against race conditions
+		std::unique_lock<std::shared_mutex> lock(s_windows_mutex);
 
-	if (input_window == s_windows.end())
-		return false;
+		// Remove any expired entry from the list
+		for (auto it = s_windows.begin(); it != s_windows.end();)
+			if (it->second.expired())
+				it = s_windows.erase(it);
+			else
+				++it;
 
-	const std::shared_ptr<input> input = input_window->second.lock();
-	// It may happen that the input was destroyed between the removal of expired entries above and here, so need to abort in this case
-	if (input == nullptr)
-		return false;
+		// Look up the window in the list of known input windows
+		auto input_window = s_windows.find(details.hwnd);
+		const auto raw_input_window = s_raw_input_windows.find(details.hwnd);
+
+		if (raw_input_window != s_raw_input_windows.end())
+			raw_input_flags = raw_input_window->second;
 
-	// At this point we have a shared pointer to the input object and no longer reference any memory from the windows list, so can release the lock
-	lock.unlock();
+		if (input_window == s_windows.end())
+		{
+			// Walk through the window chain and until an known window is found
+			EnumChildWindows(details.hwnd, [](HWND hwnd, LPARAM lparam) -> BOOL {
+				auto &input_window = *reinterpret_cast<decltype(s_windows)::iterator *>(lparam);
+				// Return true to continue enumeration
+				return (input_window = s_windows.find(hwnd)) == s_windows.end();
+			}, reinterpret_cast<LPARAM>(&input_window));
+		}
+		if (input_window == s_windows.end())
+		{
+			// Some applications handle input in a child window to the main render window
+			if (const HWND parent = GetParent(details.hwnd); parent != NULL)
+				input_window = s_windows.find(parent);
+		}
+
+		bool rerouted = false;
+		if (input_window == s_windows.end() && raw_input_window != s_raw_input_windows.end())
+		{
+			// Reroute this raw input message to the window with the most rendering
+			input_window = std::max_element(s_windows.begin(), s_windows.end(),
+				[](auto lhs, auto rhs) { return lhs.second.lock()->_frame_count < rhs.second.lock()->_frame_count; });
+			rerouted = true;
+		}
+
+		if (input_window == s_windows.end())
+			return false;
+
+		input = input_window->second.lock();
+		// It may happen that the input was destroyed between the removal of expired entries above and here, so need to abort in this case
+		if (input == nullptr)
+			return false;
+
+		// At this point we have a shared pointer to the input object and no longer reference any memory from the windows list, so can release the lock
+		lock.unlock();
+
+		// Remember this look up result, except when it was reached by rerouting, since the window with the most rendering can change at any time
+		if (!rerouted)
+			s_last_window_lookup = { details.hwnd, version, raw_input_flags, input };
+	}
 
 	// Calculate window client mouse position
 	ScreenToClient(static_cast<HWND>(input->_window), &details.pt);
@@ -156,7 +189,7 @@ bool reshade::input::handle_window_message(const void *message_data)
 		case RIM_TYPEMOUSE:
 			is_mouse_message = true;
 
-			if (raw_input_window == s_raw_input_windows.end() || (raw_input_window->second & 0x2) == 0)
+			if ((raw_input_flags & 0x2) == 0)
 				break; // Input is already handled (since legacy mouse messages are enabled), so nothing to do here
 
 			if (raw_data.data.mouse.usButtonFlags & RI_MOUSE_LEFT_BUTTON_DOWN)
@@ -194,7 +227,7 @@ bool reshade::input::handle_window_message(const void *message_data)
 			if (input->_block_keyboard && (raw_data.data.keyboard.Flags & RI_KEY_BREAK) != 0 && raw_data.data.keyboard.VKey < 0xFF && (input->_keys[raw_data.data.keyboard.VKey] & 0x04) == 0)
 				is_keyboard_message = false;
 
-			if (raw_input_window == s_raw_input_windows.end() || (raw_input_window->second & 0x1) == 0)
+			if ((raw_input_flags & 0x1) == 0)
 				break; // Input is already handled by 'WM_KEYDOWN' and friends (since legacy keyboard messages are enabled), so nothing to do here
 
 			// Filter out prefix messages without a key code
@@ -86,6 +86,15 @@ bool reshade::input_gamepad::is_button_released(unsigned int button) const
 
 void reshade::input_gamepad::next_frame()
 {
+	// 'XInputGetState' enumerates devices anew every call while no controller is connected, which can cost milliseconds, so while disconnected only check for a new connection in intervals instead of every frame
+	if (_last_packet_num == 0)
+	{
+		const uint64_t time = GetTickCount64();
+		if (time < _next_connection_check)
+			return;
+		_next_connection_check = time + 2000;
+	}
+
 	XINPUT_STATE xstate;
 	if (static_cast<decltype(&XInputGetState)>(_xinput_get_state)(0, &xstate) != ERROR_SUCCESS)
 	{
@@ -74,5 +74,7 @@ namespace reshade
 		float _right_thumb_axis_x = 0.0f;
 		float _right_thumb_axis_y = 0.0f;
 		uint32_t _last_packet_num = 0;
+		// Tick count after which to check for a new controller connection again, since polling while disconnected is expensive (see 'next_frame')
+		uint64_t _next_connection_check = 0;
 	};
 }
@@ -8,9 +8,11 @@
 #include <atomic>
 #include <utility>
 #include <cassert>
+#include <functional> // std::hash
 
 /// <summary>
-/// A simple lock-free linear search table.
+/// A simple lock-free linear search table, which scans from a start index derived from the key hash.
+/// It grows by linking in additional fixed-size segments when all entries are occupied, so <typeparamref name="MAX_ENTRIES"/> only defines the segment size, not an upper limit.
 /// The key values "one" and "zero" hold a special meaning (see <see cref="no_value"/> and <see cref="update_value"/>), so do not use them.
 /// </summary>
 template <typename TKey, typename TValue, uint32_t MAX_ENTRIES>
@@ -38,7 +40,7 @@ public:
 			return *value;
 
 		assert(false);
-		return default_value(); // Fall back if table is key does not exist
+		return default_value(); // Fall back if key does not exist
 	}
 
 	/// <summary>
@@ -57,7 +59,7 @@ public:
 		delete new_value;
 
 		assert(false);
-		return default_value(); // Fall back if table is full
+		return default_value(); // Fall back if insertion failed
 	}
 
 	/// <summary>
@@ -100,18 +102,24 @@ public:
 	/// </summary>
 	void clear()
 	{
-		for (size_t i = 0; i < MAX_ENTRIES; ++i)
+		for (typename lockfree_linear_map<TKey, TValue *, MAX_ENTRIES>::segment *seg = &lockfree_linear_map<TKey, TValue *, MAX_ENTRIES>::_head; seg != nullptr; seg = seg->next.load(std::memory_order_acquire))
 		{
-			TValue *const old_value = lockfree_linear_map<TKey, TValue *, MAX_ENTRIES>::_data[i].second;
-
-			// Clear this entry so it can be used again
-			if (TKey current_key = lockfree_linear_map<TKey, TValue *, MAX_ENTRIES>::_data[i].first.exchange(no_value);
-				current_key != no_value && current_key != update_value) // If this in update mode, we can assume the thread updating will reset the key to its intended value
+			for (size_t i = 0; i < MAX_ENTRIES; ++i)
 			{
-				// Delete any value attached to the entry, but only if there was one to begin with
-				delete old_value;
+				TValue *const old_value = seg->data[i].second;
+
+				// Clear this entry so it can be used again
+				if (TKey current_key = seg->data[i].first.exchange(no_value);
+					current_key != no_value && current_key != update_value) // If this in update mode, we can assume the thread updating will reset the key to its intended value
+				{
+					// Delete any value attached to the entry, but only if there was one to begin with
+					delete old_value;
+				}
 			}
 		}
+
+		// Invalidate any cached look up results now that the values are deleted (see 'at')
+		lockfree_linear_map<TKey, TValue *, MAX_ENTRIES>::_version.fetch_add(1, std::memory_order_release);
 	}
 
 private:
@@ -134,6 +142,15 @@ public:
 	~lockfree_linear_map()
 	{
 		clear();
+
+		// Free the overflow segments the table grew by
+		// This is only safe because no other thread can still be accessing the table during destruction
+		for (segment *overflow = _head.next.load(std::memory_order_relaxed); overflow != nullptr;)
+		{
+			segment *const next = overflow->next.load(std::memory_order_relaxed);
+			delete overflow;
+			overflow = next;
+		}
 	}
 
 	/// <summary>
@@ -155,17 +172,27 @@ public:
 	{
 		assert(key != no_value && key != update_value);
 
-		// If the table is really big, reduce search time by using hash as start index
-		size_t start_index = 0;
-		if constexpr (MAX_ENTRIES > 512)
-			start_index = std::hash<TKey>()(key) % (MAX_ENTRIES / 2);
+		// Check the entry this thread looked up last first, which in the common case of an application using just a single device is almost always a hit
+		// The cached pointer is only used when the table was not modified since it was cached (the version counter is only ever incremented on removal, so a matching version guarantees the entry still exists)
+		thread_local struct { const void *table; TKey key; TValuePtr value; uint32_t version; } s_last_lookup = {};
+		const uint32_t version = _version.load(std::memory_order_acquire);
+		if (s_last_lookup.table == this && s_last_lookup.key == key && s_last_lookup.version == version)
+			return s_last_lookup.value;
 
-		for (size_t i = start_index; i < MAX_ENTRIES; ++i)
+		for (const segment *seg = &_head; seg != nullptr; seg = seg->next.load(std::memory_order_acquire))
 		{
-			if (_data[i].first.load(std::memory_order_acquire) == key)
+			for (size_t i = 0; i < MAX_ENTRIES; ++i)
 			{
-				// The pointer is guaranteed to be value at this point, or else key would have been in update mode
-				return _data[i].second;
+				// Start the search at an index derived from the key hash, so that the scan stays short even when many entries are in use
+				const size_t entry_index = (hash_index(key) + i) % MAX_ENTRIES;
+
+				if (seg->data[entry_index].first.load(std::memory_order_acquire) == key)
+				{
+					// The pointer is guaranteed to be valid at this point, or else the key would have been in update mode
+					const TValuePtr value = seg->data[entry_index].second;
+					s_last_lookup = { this, key, value, version };
+					return value;
+				}
 			}
 		}
 
@@ -173,38 +200,59 @@ public:
 	}
 
 	/// <summary>
-	/// Adds the specified key-pointer pair to the table.
+	/// Adds the specified key-pointer pair to the table, growing it by another segment if all existing entries are occupied.
 	/// </summary>
 	/// <param name="key">Key to add.</param>
 	/// <param name="value">Pointer to add.</param>
-	/// <returns><see langword="true"/> if the key-pointer pair was added successfully, or <see langword="false"/> if the table is full.</returns>
+	/// <returns><see langword="true"/> if the key-pointer pair was added successfully.</returns>
 	bool emplace(TKey key, TValuePtr value)
 	{
 		assert(key != no_value && key != update_value);
 
-		size_t start_index = 0;
-		if constexpr (MAX_ENTRIES > 512)
-			start_index = std::hash<TKey>()(key) % (MAX_ENTRIES / 2);
-
-		for (size_t i = start_index; i < MAX_ENTRIES; ++i)
+		for (segment *seg = &_head;;)
 		{
-			if (TKey test_key = _data[i].first.load(std::memory_order_relaxed);
-				test_key == no_value &&
-				_data[i].first.compare_exchange_strong(test_key, update_value, std::memory_order_relaxed))
+			for (size_t i = 0; i < MAX_ENTRIES; ++i)
 			{
-				_data[i].second = value;
+				const size_t entry_index = (hash_index(key) + i) % MAX_ENTRIES;
 
-				_data[i].first.store(key, std::memory_order_release);
+				if (TKey test_key = seg->data[entry_index].first.load(std::memory_order_relaxed);
+					test_key == no_value &&
+					seg->data[entry_index].first.compare_exchange_strong(test_key, update_value, std::memory_order_relaxed))
+				{
+					seg->data[entry_index].second = value;
 
-				return true;
+					seg->data[entry_index].first.store(key, std::memory_order_release);
+
+					return true;
+				}
 			}
-		}
 
-		return false;
+			// All entries of this segment are occupied, so move on to the next one, growing the table when at the end
+			if (segment *const next = seg->next.load(std::memory_order_acquire))
+			{
+				seg = next;
+				continue;
+			}
+
+			segment *const new_segment = new segment();
+
+			if (segment *expected = nullptr;
+				seg->next.compare_exchange_strong(expected, new_segment, std::memory_order_acq_rel))
+			{
+				seg = new_segment;
+			}
+			else
+			{
+				// Another thread linked in a new segment in the meantime, so use that one instead
+				delete new_segment;
+				seg = expected;
+			}
+		}
 	}
 
 	/// <summary>
 	/// Removes and returns the pointer associated with the specified <paramref name="key"/> from the table.
+	/// The entry is cleared for reuse by subsequent insertions, but segments the table grew by are only freed on destruction, so that concurrent look ups stay valid.
 	/// </summary>
 	/// <param name="key">Key to look up.</param>
 	/// <returns>Removed pointer if the key existed, <see langword="nullptr"/> otherwise.</returns>
@@ -213,22 +261,26 @@ public:
 		if (key == no_value || key == update_value) // Cannot remove special keys
 			return nullptr;
 
-		size_t start_index = 0;
-		if constexpr (MAX_ENTRIES > 512)
-			start_index = std::hash<TKey>()(key) % (MAX_ENTRIES / 2);
-
-		for (size_t i = start_index; i < MAX_ENTRIES; ++i)
+		for (segment *seg = &_head; seg != nullptr; seg = seg->next.load(std::memory_order_acquire))
 		{
-			// Load and check before doing an expensive CAS
-			if (TKey test_key = _data[i].first.load(std::memory_order_relaxed);
-				test_key == key)
+			for (size_t i = 0; i < MAX_ENTRIES; ++i)
 			{
-				// Get the value before freeing the entry up for other threads to fill again
-				const TValuePtr old_value = _data[i].second;
+				const size_t entry_index = (hash_index(key) + i) % MAX_ENTRIES;
 
-				if (_data[i].first.compare_exchange_strong(test_key, no_value, std::memory_order_relaxed))
+				// Load and check before doing an expensive CAS
+				if (TKey test_key = seg->data[entry_index].first.load(std::memory_order_relaxed);
+					test_key == key)
 				{
-					return old_value;
+					// Get the value before freeing the entry up for other threads to fill again
+					const TValuePtr old_value = seg->data[entry_index].second;
+
+					if (seg->data[entry_index].first.compare_exchange_strong(test_key, no_value, std::memory_order_relaxed))
+					{
+						// Invalidate any cached look up results now that the entry is gone (see 'at')
+						_version.fetch_add(1, std::memory_order_release);
+
+						return old_value;
+					}
 				}
 			}
 		}
@@ -241,12 +293,31 @@ public:
 	/// </summary>
 	void clear()
 	{
-		for (size_t i = 0; i < MAX_ENTRIES; ++i)
+		for (segment *seg = &_head; seg != nullptr; seg = seg->next.load(std::memory_order_acquire))
 		{
-			_data[i].first.exchange(no_value);
+			for (size_t i = 0; i < MAX_ENTRIES; ++i)
+			{
+				seg->data[i].first.exchange(no_value);
+			}
 		}
+
+		_version.fetch_add(1, std::memory_order_release);
 	}
 
 protected:
-	std::pair<std::atomic<TKey>, TValuePtr> _data[MAX_ENTRIES];
+	// Fixed-size table segment, with additional segments linked in when the existing ones run out of space
+	struct segment
+	{
+		std::pair<std::atomic<TKey>, TValuePtr> data[MAX_ENTRIES] = {};
+		std::atomic<segment *> next = { nullptr };
+	};
+
+	static size_t hash_index(TKey key)
+	{
+		// Derive the start index for scans from the key hash, so that entries are distributed over the table instead of clustering at the front
+		return std::hash<TKey>()(key) % MAX_ENTRIES;
+	}
+
+	segment _head;
+	std::atomic<uint32_t> _version = { 0 };
 };
@@ -5,6 +5,9 @@
 
 #pragma once
 
+#include <cstdint>
+#include <cstring> // std::memcpy
+
 template <typename T, size_t SAMPLES>
 class moving_average
 {
@@ -34,3 +37,196 @@ private:
 	size_t _index;
 	T _average, _tick_sum, _tick_list[SAMPLES];
 };
+
+// Log-scale histogram over duration values (in nanoseconds), which, unlike a moving average, makes it possible to extract percentiles and outlier counts
+// The fixed number of buckets is divided into power of two octaves with four linear sub-buckets each, so appending a value never allocates
+template <typename T, size_t BUCKETS>
+class duration_histogram
+{
+	static_assert(BUCKETS != 0 && BUCKETS % 4 == 0, "bucket count must be a multiple of the number of sub-buckets per octave");
+
+public:
+	duration_histogram() : _total_count(0), _bucket_counts() {}
+
+	void clear()
+	{
+		_total_count = 0;
+
+		for (size_t i = 0; i < BUCKETS; i++)
+			_bucket_counts[i] = 0;
+	}
+	void append(T value)
+	{
+		_bucket_counts[bucket_index(value)]++;
+
+		// Periodically halve all bucket counts, so that the distribution decays exponentially and keeps tracking recent application behavior
+		if (++_total_count >= DECAY_SAMPLE_COUNT)
+		{
+			_total_count = 0;
+			for (size_t i = 0; i < BUCKETS; i++)
+				_total_count += _bucket_counts[i] /= 2;
+		}
+	}
+
+	uint64_t total_count() const { return _total_count; }
+
+	// Gets an upper bound on the value below which the specified percentage of the appended values lie
+	T percentile(float percent) const
+	{
+		if (_total_count == 0)
+			return 0;
+
+		const uint64_t target_count = static_cast<uint64_t>(percent * static_cast<float>(_total_count) / 100);
+
+		uint64_t cumulative_count = 0;
+		for (size_t i = 0; i < BUCKETS; i++)
+			if ((cumulative_count += _bucket_counts[i]) > target_count)
+				return bucket_bound(i + 1);
+		return bucket_bound(BUCKETS);
+	}
+	// Gets the number of appended values that were at least as large as the specified value (rounded down to the bucket containing it)
+	uint64_t count_above(T value) const
+	{
+		uint64_t count = 0;
+		for (size_t i = bucket_index(value); i < BUCKETS; i++)
+			count += _bucket_counts[i];
+		return count;
+	}
+
+private:
+	// The first octave starts at 2^12 nanoseconds (about 4 microseconds), so that with 64 buckets the range extends to roughly 270 milliseconds
+	static constexpr unsigned int BASE_EXPONENT = 12;
+	static constexpr size_t SUB_BUCKETS = 4;
+	static constexpr uint64_t DECAY_SAMPLE_COUNT = 4096;
+
+	static size_t bucket_index(T value)
+	{
+		unsigned int log2_value = 0;
+		for (T v = value >> 1; v != 0; v >>= 1)
+			log2_value++;
+
+		if (log2_value < BASE_EXPONENT)
+			return 0;
+
+		const size_t octave = log2_value - BASE_EXPONENT;
+		// The two bits following the most significant one select the linear sub-bucket within the octave
+		const size_t sub_bucket = static_cast<size_t>(value >> (log2_value - 2)) & (SUB_BUCKETS - 1);
+		const size_t index = octave * SUB_BUCKETS + sub_bucket;
+
+		return index < BUCKETS ? index : BUCKETS - 1;
+	}
+	// Gets the lower bound of the value range the bucket with the specified index covers
+	static T bucket_bound(size_t index)
+	{
+		const T base = static_cast<T>(1) << (BASE_EXPONENT + index / SUB_BUCKETS);
+		return base + static_cast<T>(index % SUB_BUCKETS) * (base / SUB_BUCKETS);
+	}
+
+	uint64_t _total_count;
+	uint32_t _bucket_counts[BUCKETS];
+};
+
+// Fixed-capacity ring buffer over a stream of duration samples, for plotting a long time window with a bounded point count and without any allocations
+// Incoming samples are averaged in groups of a power of two stride before being stored, and whenever the full buffer covers less time than the requested window, adjacent points are merged and the stride doubled, so the window is eventually reached regardless of the sample rate
+template <typename T, size_t POINTS>
+class decimated_history
+{
+	static_assert(POINTS != 0 && POINTS % 2 == 0, "point count must be even so that adjacent points can be merged");
+
+public:
+	explicit decimated_history(T window) : _window(window), _stride(1), _count(0), _offset(0), _span(0), _accum(0), _accum_duration(0), _accum_count(0), _points(), _durations() {}
+
+	void clear()
+	{
+		_stride = 1;
+		_count = 0;
+		_offset = 0;
+		_span = 0;
+		_accum = 0;
+		_accum_duration = 0;
+		_accum_count = 0;
+	}
+	// Appends a sample whose value is itself the amount of time it covers (e.g. a frame time)
+	void append(T value)
+	{
+		append(value, value);
+	}
+	// Appends a sample together with the amount of time it covers, for series whose values are not durations of the time axis themselves (e.g. a GPU duration within a longer frame)
+	void append(T value, T duration)
+	{
+		_accum += value;
+		_accum_duration += duration;
+		if (++_accum_count < _stride)
+			return;
+
+		if (_count == POINTS && _span < _window)
+		{
+			// Buffer is full but does not cover the requested window yet, so halve it by merging adjacent points and double the stride (the pending accumulation simply continues, since it now covers only half of the new stride)
+			T merged_points[POINTS], merged_durations[POINTS];
+			for (size_t i = 0; i < POINTS / 2; ++i)
+			{
+				merged_points[i] = (_points[(_offset + 2 * i) % POINTS] + _points[(_offset + 2 * i + 1) % POINTS]) / 2;
+				merged_durations[i] = _durations[(_offset + 2 * i) % POINTS] + _durations[(_offset + 2 * i + 1) % POINTS];
+			}
+			std::memcpy(_points, merged_points, sizeof(T) * (POINTS / 2));
+			std::memcpy(_durations, merged_durations, sizeof(T) * (POINTS / 2));
+			_count = POINTS / 2;
+			_offset = 0;
+			_stride *= 2;
+			return;
+		}
+
+		const T point = _accum / static_cast<T>(_stride);
+		const T point_duration = _accum_duration;
+		_accum = 0;
+		_accum_duration = 0;
+		_accum_count = 0;
+
+		if (_count < POINTS)
+		{
+			_points[_count] = point;
+			_durations[_count] = point_duration;
+			_count++;
+		}
+		else
+		{
+			// Overwrite the oldest point, so that data older than the requested window falls out of the buffer
+			_span -= _durations[_offset];
+			_points[_offset] = point;
+			_durations[_offset] = point_duration;
+			_offset = (_offset + 1) % POINTS;
+		}
+
+		_span += point_duration;
+	}
+
+	// The stored points together with the count and ring offset below can be passed directly to 'ImGui::PlotLines'
+	const T *data() const { return _points; }
+	size_t size() const { return _count; }
+	size_t offset() const { return _offset; }
+
+	// Gets the amount of time the stored points currently cover, in the unit the sample durations were appended in
+	T span() const { return _span; }
+	// Gets the unweighted average of the stored points, for scaling a plot around the typical value
+	T average() const
+	{
+		if (_count == 0)
+			return 0;
+		T sum = 0;
+		for (size_t i = 0; i < _count; ++i)
+			sum += _points[i];
+		return sum / static_cast<T>(_count);
+	}
+
+private:
+	const T _window;
+	size_t _stride;
+	size_t _count;
+	size_t _offset;
+	T _span;
+	T _accum;
+	T _accum_duration;
+	size_t _accum_count;
+	T _points[POINTS];
+	T _durations[POINTS];
+};
@@ -5,6 +5,7 @@
 
 #include "opengl_impl_device.hpp"
 #include "opengl_impl_device_context.hpp"
+#include "opengl_impl_state_block.hpp"
 #include "opengl_impl_type_convert.hpp"
 #include "opengl_hooks.hpp" // Fix name clashes with gl3w
 #include "hook_manager.hpp"
@@ -29,8 +30,11 @@ struct DrawElementsIndirectCommand
 	GLuint baseinstance;
 };
 
-// Initialize thread local variable in this translation unit, to avoid the compiler generating calls to '__dyn_tls_on_demand_init' on every use in the frequently called functions below
+// Initialize thread local variables in this translation unit, to avoid the compiler generating calls to '__dyn_tls_on_demand_init' on every use in the frequently called functions below
 thread_local reshade::opengl::device_context_impl *g_opengl_context = nullptr;
+thread_local reshade::opengl::state_shadow g_current_gl_state;
+
+using reshade::opengl::state_shadow;
 
 #if RESHADE_ADDON
 reshade::api::pipeline_layout get_opengl_pipeline_layout();
@@ -880,6 +884,7 @@ extern "C" void APIENTRY glEnable(GLenum cap)
 {
 	static const auto trampoline = reshade::hooks::call(glEnable);
 	trampoline(cap);
+	g_current_gl_state.bump(state_shadow::group_enables);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -937,6 +942,7 @@ extern "C" void APIENTRY glDisable(GLenum cap)
 {
 	static const auto trampoline = reshade::hooks::call(glDisable);
 	trampoline(cap);
+	g_current_gl_state.bump(state_shadow::group_enables);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -995,6 +1001,7 @@ extern "C" void APIENTRY glCullFace(GLenum mode)
 {
 	static const auto trampoline = reshade::hooks::call(glCullFace);
 	trampoline(mode);
+	g_current_gl_state.bump(state_shadow::group_rasterizer_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -1011,6 +1018,7 @@ extern "C" void APIENTRY glFrontFace(GLenum mode)
 {
 	static const auto trampoline = reshade::hooks::call(glFrontFace);
 	trampoline(mode);
+	g_current_gl_state.bump(state_shadow::group_rasterizer_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -1042,6 +1050,7 @@ extern "C" void APIENTRY glPolygonMode(GLenum face, GLenum mode)
 {
 	static const auto trampoline = reshade::hooks::call(glPolygonMode);
 	trampoline(face, mode);
+	g_current_gl_state.bump(state_shadow::group_rasterizer_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context && face == GL_FRONT_AND_BACK &&
@@ -1075,6 +1084,7 @@ extern "C" void APIENTRY glBlendFunc(GLenum sfactor, GLenum dfactor)
 {
 	static const auto trampoline = reshade::hooks::call(glBlendFunc);
 	trampoline(sfactor, dfactor);
+	g_current_gl_state.bump(state_shadow::group_blend_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -1091,6 +1101,7 @@ extern "C" void APIENTRY glLogicOp(GLenum opcode)
 {
 	static const auto trampoline = reshade::hooks::call(glLogicOp);
 	trampoline(opcode);
+	g_current_gl_state.bump(state_shadow::group_blend_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -1107,6 +1118,7 @@ extern "C" void APIENTRY glColorMask(GLboolean red, GLboolean green, GLboolean b
 {
 	static const auto trampoline = reshade::hooks::call(glColorMask);
 	trampoline(red, green, blue, alpha);
+	g_current_gl_state.bump(state_shadow::group_blend_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -1124,6 +1136,7 @@ extern "C" void APIENTRY glDepthFunc(GLenum func)
 {
 	static const auto trampoline = reshade::hooks::call(glDepthFunc);
 	trampoline(func);
+	g_current_gl_state.bump(state_shadow::group_depth_stencil_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -1140,6 +1153,7 @@ extern "C" void APIENTRY glDepthMask(GLboolean flag)
 {
 	static const auto trampoline = reshade::hooks::call(glDepthMask);
 	trampoline(flag);
+	g_current_gl_state.bump(state_shadow::group_depth_stencil_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -1157,6 +1171,7 @@ extern "C" void APIENTRY glStencilFunc(GLenum func, GLint ref, GLuint mask)
 {
 	static const auto trampoline = reshade::hooks::call(glStencilFunc);
 	trampoline(func, ref, mask);
+	g_current_gl_state.bump(state_shadow::group_depth_stencil_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -1175,6 +1190,7 @@ extern "C" void APIENTRY glStencilOp(GLenum fail, GLenum zfail, GLenum zpass)
 {
 	static const auto trampoline = reshade::hooks::call(glStencilOp);
 	trampoline(fail, zfail, zpass);
+	g_current_gl_state.bump(state_shadow::group_depth_stencil_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -1195,6 +1211,7 @@ extern "C" void APIENTRY glStencilMask(GLuint mask)
 {
 	static const auto trampoline = reshade::hooks::call(glStencilMask);
 	trampoline(mask);
+	g_current_gl_state.bump(state_shadow::group_depth_stencil_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -1212,6 +1229,7 @@ extern "C" void APIENTRY glScissor(GLint left, GLint bottom, GLsizei width, GLsi
 {
 	static const auto trampoline = reshade::hooks::call(glScissor);
 	trampoline(left, bottom, width, height);
+	g_current_gl_state.bump(state_shadow::group_rasterizer_state);
 
 #if RESHADE_ADDON
 	if (g_opengl_context &&
@@ -1246,6 +1264,7 @@ extern "C" void APIENTRY glViewport(GLint x, GLint y, GLsizei width, GLsizei hei
 {
 	static const auto trampoline = reshade::hooks::call(glViewport);
 	trampoline(x, y, width, height);
+	g_current_gl_state.bump(state_shadow::group_viewport);
 
 #if RESHADE_ADDON
 	if (g_opengl_context &&
@@ -1280,6 +1299,11 @@ extern "C" void APIENTRY glDeleteTextures(GLsizei n, const GLuint *textures)
 
 	static const auto trampoline = reshade::hooks::call(glDeleteTextures);
 	trampoline(n, textures);
+
+	// Deleting a texture object unbinds it from all texture units of the current context
+	if (textures != nullptr)
+		for (GLsizei i = 0; i < n; ++i)
+			g_current_gl_state.remove_texture_binding(textures[i]);
 }
 
 extern "C" void APIENTRY glTexSubImage1D(GLenum target, GLint level, GLint xoffset, GLsizei width, GLenum format, GLenum type, const GLvoid *pixels)
@@ -1340,6 +1364,19 @@ extern "C" void APIENTRY glBindTexture(GLenum target, GLuint texture)
 	static const auto trampoline = reshade::hooks::call(glBindTexture);
 	trampoline(target, texture);
 
+	if (target == GL_TEXTURE_2D)
+	{
+		state_shadow &shadow = g_current_gl_state;
+		if (!shadow.active_texture_known)
+			// Do not know which texture unit this modified, so have to assume any of the shadowed bindings may be stale now
+			shadow.textures_2d_known = 0;
+		else if (const GLuint unit = static_cast<GLuint>(shadow.active_texture - GL_TEXTURE0); unit < 32)
+		{
+			shadow.textures_2d[unit] = texture;
+			shadow.textures_2d_known |= 1 << unit;
+		}
+	}
+
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
 		reshade::has_addon_event<reshade::addon_event::push_descriptors>())
@@ -1488,6 +1525,15 @@ void APIENTRY glDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei
 #endif
 
 #ifdef GL_VERSION_1_3
+void APIENTRY glActiveTexture(GLenum texture)
+{
+	static const auto trampoline = reshade::hooks::call(glActiveTexture);
+	trampoline(texture);
+
+	g_current_gl_state.active_texture = texture;
+	g_current_gl_state.active_texture_known = true;
+}
+
 void APIENTRY glCompressedTexImage1D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLint border, GLsizei imageSize, const void *data)
 {
 	static const auto trampoline = reshade::hooks::call(glCompressedTexImage1D);
@@ -1604,6 +1650,7 @@ void APIENTRY glBlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, GLenum s
 {
 	static const auto trampoline = reshade::hooks::call(glBlendFuncSeparate);
 	trampoline(sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha);
+	g_current_gl_state.bump(state_shadow::group_blend_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -1620,6 +1667,7 @@ void APIENTRY glBlendColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alp
 {
 	static const auto trampoline = reshade::hooks::call(glBlendColor);
 	trampoline(red, green, blue, alpha);
+	g_current_gl_state.bump(state_shadow::group_blend_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -1640,6 +1688,7 @@ void APIENTRY glBlendEquation(GLenum mode)
 {
 	static const auto trampoline = reshade::hooks::call(glBlendEquation);
 	trampoline(mode);
+	g_current_gl_state.bump(state_shadow::group_blend_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -1705,6 +1754,9 @@ void APIENTRY glDeleteBuffers(GLsizei n, const GLuint *buffers)
 
 	static const auto trampoline = reshade::hooks::call(glDeleteBuffers);
 	trampoline(n, buffers);
+	g_current_gl_state.bump(state_shadow::group_buffer_bindings);
+	g_current_gl_state.bump(state_shadow::group_vertex_array);
+	g_current_gl_state.bump(state_shadow::group_ubo_bindings);
 }
 
 void APIENTRY glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
@@ -1788,6 +1840,8 @@ void APIENTRY glBindBuffer(GLenum target, GLuint buffer)
 {
 	static const auto trampoline = reshade::hooks::call(glBindBuffer);
 	trampoline(target, buffer);
+	g_current_gl_state.bump(state_shadow::group_buffer_bindings);
+	g_current_gl_state.bump(state_shadow::group_vertex_array);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context)
@@ -1807,6 +1861,13 @@ void APIENTRY glBindBuffer(GLenum target, GLuint buffer)
 #endif
 
 #ifdef GL_VERSION_2_0
+void APIENTRY glDrawBuffers(GLsizei n, const GLenum *bufs)
+{
+	static const auto trampoline = reshade::hooks::call(glDrawBuffers);
+	trampoline(n, bufs);
+	g_current_gl_state.bump(state_shadow::group_framebuffer);
+}
+
 void APIENTRY glDeleteProgram(GLuint program)
 {
 #if RESHADE_ADDON
@@ -2000,6 +2061,7 @@ void APIENTRY glUseProgram(GLuint program)
 {
 	static const auto trampoline = reshade::hooks::call(glUseProgram);
 	trampoline(program);
+	g_current_gl_state.bump(state_shadow::group_program);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context)
@@ -2015,6 +2077,7 @@ void APIENTRY glBlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha)
 {
 	static const auto trampoline = reshade::hooks::call(glBlendEquationSeparate);
 	trampoline(modeRGB, modeAlpha);
+	g_current_gl_state.bump(state_shadow::group_blend_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -2032,6 +2095,7 @@ void APIENTRY glStencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint
 {
 	static const auto trampoline = reshade::hooks::call(glStencilFuncSeparate);
 	trampoline(face, func, ref, mask);
+	g_current_gl_state.bump(state_shadow::group_depth_stencil_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -2050,6 +2114,7 @@ void APIENTRY glStencilOpSeparate(GLenum face, GLenum fail, GLenum zfail, GLenum
 {
 	static const auto trampoline = reshade::hooks::call(glStencilOpSeparate);
 	trampoline(face, fail, zfail, zpass);
+	g_current_gl_state.bump(state_shadow::group_depth_stencil_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -2070,6 +2135,7 @@ void APIENTRY glStencilMaskSeparate(GLenum face, GLuint mask)
 {
 	static const auto trampoline = reshade::hooks::call(glStencilMaskSeparate);
 	trampoline(face, mask);
+	g_current_gl_state.bump(state_shadow::group_depth_stencil_state);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
@@ -2538,6 +2604,7 @@ void APIENTRY glDeleteVertexArrays(GLsizei n, const GLuint *arrays)
 
 	static const auto trampoline = reshade::hooks::call(glDeleteVertexArrays);
 	trampoline(n, arrays);
+	g_current_gl_state.bump(state_shadow::group_vertex_array);
 }
 
 void APIENTRY glFramebufferTexture1D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
@@ -2829,6 +2896,8 @@ void APIENTRY glBindBufferBase(GLenum target, GLuint index, GLuint buffer)
 {
 	static const auto trampoline = reshade::hooks::call(glBindBufferBase);
 	trampoline(target, index, buffer);
+	g_current_gl_state.bump(state_shadow::group_ubo_bindings);
+	g_current_gl_state.bump(state_shadow::group_buffer_bindings);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context)
@@ -2866,6 +2935,8 @@ void APIENTRY glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLin
 {
 	static const auto trampoline = reshade::hooks::call(glBindBufferRange);
 	trampoline(target, index, buffer, offset, size);
+	g_current_gl_state.bump(state_shadow::group_ubo_bindings);
+	g_current_gl_state.bump(state_shadow::group_buffer_bindings);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context)
@@ -2904,6 +2975,7 @@ void APIENTRY glBindFramebuffer(GLenum target, GLuint framebuffer)
 {
 	static const auto trampoline = reshade::hooks::call(glBindFramebuffer);
 	trampoline(target, framebuffer);
+	g_current_gl_state.bump(state_shadow::group_framebuffer);
 
 #if RESHADE_ADDON
 	update_framebuffer_object(target, framebuffer);
@@ -2914,6 +2986,7 @@ void APIENTRY glBindVertexArray(GLuint array)
 {
 	static const auto trampoline = reshade::hooks::call(glBindVertexArray);
 	trampoline(array);
+	g_current_gl_state.bump(state_shadow::group_vertex_array);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context)
@@ -3267,6 +3340,30 @@ void APIENTRY glMultiDrawElementsBaseVertex(GLenum mode, const GLsizei *count, G
 }
 #endif
 
+#ifdef GL_VERSION_3_3
+void APIENTRY glBindSampler(GLuint unit, GLuint sampler)
+{
+	static const auto trampoline = reshade::hooks::call(glBindSampler);
+	trampoline(unit, sampler);
+
+	if (unit < 32)
+	{
+		g_current_gl_state.samplers[unit] = sampler;
+		g_current_gl_state.samplers_known |= 1 << unit;
+	}
+}
+void APIENTRY glDeleteSamplers(GLsizei n, const GLuint *samplers)
+{
+	static const auto trampoline = reshade::hooks::call(glDeleteSamplers);
+	trampoline(n, samplers);
+
+	// Deleting a sampler object unbinds it from all texture units of the current context
+	if (samplers != nullptr)
+		for (GLsizei i = 0; i < n; ++i)
+			g_current_gl_state.remove_sampler_binding(samplers[i]);
+}
+#endif
+
 #ifdef GL_VERSION_4_0
 void APIENTRY glDrawArraysIndirect(GLenum mode, const GLvoid *indirect)
 {
@@ -3348,6 +3445,7 @@ void APIENTRY glScissorArrayv(GLuint first, GLsizei count, const GLint *v)
 {
 	static const auto trampoline = reshade::hooks::call(glScissorArrayv);
 	trampoline(first, count, v);
+	g_current_gl_state.bump(state_shadow::group_rasterizer_state);
 
 #if RESHADE_ADDON
 	if (g_opengl_context &&
@@ -3384,6 +3482,7 @@ void APIENTRY glScissorIndexed(GLuint index, GLint left, GLint bottom, GLsizei w
 {
 	static const auto trampoline = reshade::hooks::call(glScissorIndexed);
 	trampoline(index, left, bottom, width, height);
+	g_current_gl_state.bump(state_shadow::group_rasterizer_state);
 
 #if RESHADE_ADDON
 	if (g_opengl_context &&
@@ -3417,6 +3516,7 @@ void APIENTRY glScissorIndexedv(GLuint index, const GLint *v)
 {
 	static const auto trampoline = reshade::hooks::call(glScissorIndexedv);
 	trampoline(index, v);
+	g_current_gl_state.bump(state_shadow::group_rasterizer_state);
 
 #if RESHADE_ADDON
 	if (g_opengl_context &&
@@ -3451,6 +3551,7 @@ void APIENTRY glViewportArrayv(GLuint first, GLsizei count, const GLfloat *v)
 {
 	static const auto trampoline = reshade::hooks::call(glViewportArrayv);
 	trampoline(first, count, v);
+	g_current_gl_state.bump(state_shadow::group_viewport);
 
 #if RESHADE_ADDON
 	if (g_opengl_context &&
@@ -3475,6 +3576,7 @@ void APIENTRY glViewportIndexedf(GLuint index, GLfloat x, GLfloat y, GLfloat w,
 {
 	static const auto trampoline = reshade::hooks::call(glViewportIndexedf);
 	trampoline(index, x, y, w, h);
+	g_current_gl_state.bump(state_shadow::group_viewport);
 
 #if RESHADE_ADDON
 	if (g_opengl_context &&
@@ -3490,6 +3592,7 @@ void APIENTRY glViewportIndexedfv(GLuint index, const GLfloat *v)
 {
 	static const auto trampoline = reshade::hooks::call(glViewportIndexedfv);
 	trampoline(index, v);
+	g_current_gl_state.bump(state_shadow::group_viewport);
 
 #if RESHADE_ADDON
 	if (g_opengl_context)
@@ -3911,6 +4014,8 @@ void APIENTRY glBindBuffersBase(GLenum target, GLuint first, GLsizei count, cons
 {
 	static const auto trampoline = reshade::hooks::call(glBindBuffersBase);
 	trampoline(target, first, count, buffers);
+	g_current_gl_state.bump(state_shadow::group_ubo_bindings);
+	g_current_gl_state.bump(state_shadow::group_buffer_bindings);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context)
@@ -3972,6 +4077,8 @@ void APIENTRY glBindBuffersRange(GLenum target, GLuint first, GLsizei count, con
 {
 	static const auto trampoline = reshade::hooks::call(glBindBuffersRange);
 	trampoline(target, first, count, buffers, offsets, sizes);
+	g_current_gl_state.bump(state_shadow::group_ubo_bindings);
+	g_current_gl_state.bump(state_shadow::group_buffer_bindings);
 
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context)
@@ -4032,11 +4139,47 @@ void APIENTRY glBindBuffersRange(GLenum target, GLuint first, GLsizei count, con
 #endif
 }
 
+void APIENTRY glBindSamplers(GLuint first, GLsizei count, const GLuint *samplers)
+{
+	static const auto trampoline = reshade::hooks::call(glBindSamplers);
+	trampoline(first, count, samplers);
+
+	for (GLsizei i = 0; i < count; ++i)
+	{
+		const GLuint unit = first + i;
+		if (unit >= 32)
+			break;
+
+		g_current_gl_state.samplers[unit] = (samplers != nullptr) ? samplers[i] : 0;
+		g_current_gl_state.samplers_known |= 1 << unit;
+	}
+}
+
 void APIENTRY glBindTextures(GLuint first, GLsizei count, const GLuint *textures)
 {
 	static const auto trampoline = reshade::hooks::call(glBindTextures);
 	trampoline(first, count, textures);
 
+	for (GLsizei i = 0; i < count; ++i)
+	{
+		const GLuint unit = first + i;
+		if (unit >= 32)
+			break;
+
+		state_shadow &shadow = g_current_gl_state;
+		if (textures == nullptr || textures[i] == 0)
+		{
+			// Binding zero resets the bindings of all targets of this texture unit
+			shadow.textures_2d[unit] = 0;
+			shadow.textures_2d_known |= 1 << unit;
+		}
+		else
+		{
+			// The texture is bound to the target it was created with, which is not known here, so cannot tell whether this replaced the 2D binding
+			shadow.textures_2d_known &= ~(1u << unit);
+		}
+	}
+
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
 		reshade::has_addon_event<reshade::addon_event::push_descriptors>())
@@ -4670,6 +4813,22 @@ void APIENTRY glBindTextureUnit(GLuint unit, GLuint texture)
 	static const auto trampoline = reshade::hooks::call(glBindTextureUnit);
 	trampoline(unit, texture);
 
+	if (unit < 32)
+	{
+		state_shadow &shadow = g_current_gl_state;
+		if (texture == 0)
+		{
+			// Binding zero resets the bindings of all targets of this texture unit
+			shadow.textures_2d[unit] = 0;
+			shadow.textures_2d_known |= 1 << unit;
+		}
+		else
+		{
+			// The texture is bound to the target it was created with, which is not known here, so cannot tell whether this replaced the 2D binding
+			shadow.textures_2d_known &= ~(1u << unit);
+		}
+	}
+
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
 		reshade::has_addon_event<reshade::addon_event::push_descriptors>())
@@ -4800,6 +4959,7 @@ void APIENTRY glBindFramebufferEXT(GLenum target, GLuint framebuffer)
 {
 	static const auto trampoline = reshade::hooks::call(glBindFramebufferEXT);
 	trampoline(target, framebuffer);
+	g_current_gl_state.bump(state_shadow::group_framebuffer);
 
 #if RESHADE_ADDON
 	update_framebuffer_object(target, framebuffer);
@@ -4811,6 +4971,15 @@ void APIENTRY glBindMultiTextureEXT(GLenum texunit, GLenum target, GLuint textur
 	static const auto trampoline = reshade::hooks::call(glBindMultiTextureEXT);
 	trampoline(texunit, target, texture);
 
+	if (target == GL_TEXTURE_2D)
+	{
+		if (const GLuint unit = static_cast<GLuint>(texunit - GL_TEXTURE0); unit < 32)
+		{
+			g_current_gl_state.textures_2d[unit] = texture;
+			g_current_gl_state.textures_2d_known |= 1 << unit;
+		}
+	}
+
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context &&
 		reshade::has_addon_event<reshade::addon_event::push_descriptors>())
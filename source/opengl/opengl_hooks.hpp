@@ -5,6 +5,8 @@
 
 #include <GL/gl3w.h>
 
+#undef glActiveTexture
+extern "C" void APIENTRY glActiveTexture(GLenum texture);
 #undef glBindBuffer
 extern "C" void APIENTRY glBindBuffer(GLenum target, GLuint buffer);
 #undef glBindBufferBase
@@ -27,6 +29,10 @@ extern "C" void APIENTRY glBindImageTextures(GLuint first, GLsizei count, const
 extern "C" void APIENTRY glBindMultiTextureEXT(GLenum texunit, GLenum target, GLuint texture);
 #undef glBindProgramARB
 extern "C" void APIENTRY glBindProgramARB(GLenum target, GLuint program);
+#undef glBindSampler
+extern "C" void APIENTRY glBindSampler(GLuint unit, GLuint sampler);
+#undef glBindSamplers
+extern "C" void APIENTRY glBindSamplers(GLuint first, GLsizei count, const GLuint *samplers);
 #undef glBindTexture
 extern "C" void APIENTRY glBindTexture(GLenum target, GLuint texture);
 #undef glBindTextureUnit
@@ -135,6 +141,8 @@ extern "C" void APIENTRY glDeleteProgram(GLuint program);
 extern "C" void APIENTRY glDeleteProgramsARB(GLsizei n, const GLuint *programs);
 #undef glDeleteRenderbuffers
 extern "C" void APIENTRY glDeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers);
+#undef glDeleteSamplers
+extern "C" void APIENTRY glDeleteSamplers(GLsizei n, const GLuint *samplers);
 #undef glDeleteTextures
 extern "C" void APIENTRY glDeleteTextures(GLsizei n, const GLuint *textures);
 #undef glDeleteVertexArrays
@@ -161,6 +169,8 @@ extern "C" void APIENTRY glDrawArraysInstanced(GLenum mode, GLint first, GLsizei
 extern "C" void APIENTRY glDrawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei primcount, GLuint baseinstance);
 #undef glDrawBuffer
 extern "C" void APIENTRY glDrawBuffer(GLenum mode);
+#undef glDrawBuffers
+extern "C" void APIENTRY glDrawBuffers(GLsizei n, const GLenum *bufs);
 #undef glDrawElements
 extern "C" void APIENTRY glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices);
 #undef glDrawElementsBaseVertex
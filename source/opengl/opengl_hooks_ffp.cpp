@@ -5,6 +5,7 @@
 
 #include "opengl_impl_device.hpp"
 #include "opengl_impl_device_context.hpp"
+#include "opengl_impl_state_block.hpp"
 #include "opengl_impl_type_convert.hpp"
 #include "opengl_hooks.hpp" // Fix name clashes with gl3w
 #include "hook_manager.hpp"
@@ -12,6 +13,10 @@
 
 extern thread_local reshade::opengl::device_context_impl *g_opengl_context;
 
+// Number of vertices issued between a 'glBegin'/'glEnd' pair
+// This is accumulated in a plain thread-local variable, so that the high-frequency vertex hooks below get away with a single increment, rather than a context check and dereference per call
+static thread_local GLuint g_current_vertex_count = 0;
+
 // Fixed function pipeline hooks
 
 extern "C" void APIENTRY glAccum(GLenum op, GLfloat value)
@@ -37,12 +42,13 @@ extern "C" void APIENTRY glBegin(GLenum mode)
 	static const auto trampoline = reshade::hooks::call(glBegin);
 	trampoline(mode);
 
+	// Reset unconditionally, since the vertex hooks count even while no context is current
+	g_current_vertex_count = 0;
+
 	if (g_opengl_context != nullptr)
 	{
 		g_opengl_context->_current_prim_mode = mode;
 
-		assert(g_opengl_context->_current_vertex_count == 0);
-
 #if RESHADE_ADDON >= 2
 		const reshade::api::dynamic_state state = reshade::api::dynamic_state::primitive_topology;
 		uint32_t value = static_cast<uint32_t>(reshade::opengl::convert_primitive_topology(mode));
@@ -290,6 +296,7 @@ extern "C" void APIENTRY glDrawBuffer(GLenum mode)
 {
 	static const auto trampoline = reshade::hooks::call(glDrawBuffer);
 	trampoline(mode);
+	g_current_gl_state.bump(reshade::opengl::state_shadow::group_framebuffer);
 }
 
 extern "C" void APIENTRY glDrawPixels(GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid *pixels)
@@ -328,10 +335,11 @@ extern "C" void APIENTRY glEnd()
 	if (g_opengl_context)
 	{
 #if RESHADE_ADDON
-		reshade::invoke_addon_event<reshade::addon_event::draw>(g_opengl_context, g_opengl_context->_current_vertex_count, 1, 0, 0); // Cannot be skipped
+		reshade::invoke_addon_event<reshade::addon_event::draw>(g_opengl_context, g_current_vertex_count, 1, 0, 0); // Cannot be skipped
 #endif
-		g_opengl_context->_current_vertex_count = 0;
 	}
+
+	g_current_vertex_count = 0;
 }
 
 extern "C" void APIENTRY glEndList()
@@ -1001,6 +1009,9 @@ extern "C" void APIENTRY glPopAttrib()
 {
 	static const auto trampoline = reshade::hooks::call(glPopAttrib);
 	trampoline();
+
+	// This may have restored state from any of the attribute groups, so all shadowed state is potentially stale now
+	g_current_gl_state.invalidate();
 }
 extern "C" void APIENTRY glPopClientAttrib()
 {
@@ -1174,6 +1185,7 @@ extern "C" void APIENTRY glReadBuffer(GLenum mode)
 {
 	static const auto trampoline = reshade::hooks::call(glReadBuffer);
 	trampoline(mode);
+	g_current_gl_state.bump(reshade::opengl::state_shadow::group_framebuffer);
 }
 
 extern "C" void APIENTRY glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid *pixels)
@@ -1517,192 +1529,168 @@ extern "C" void APIENTRY glTranslatef(GLfloat x, GLfloat y, GLfloat z)
 
 extern "C" void APIENTRY glVertex2d(GLdouble x, GLdouble y)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 2;
+	g_current_vertex_count += 2;
 
 	static const auto trampoline = reshade::hooks::call(glVertex2d);
 	trampoline(x, y);
 }
 extern "C" void APIENTRY glVertex2dv(const GLdouble *v)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 2;
+	g_current_vertex_count += 2;
 
 	static const auto trampoline = reshade::hooks::call(glVertex2dv);
 	trampoline(v);
 }
 extern "C" void APIENTRY glVertex2f(GLfloat x, GLfloat y)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 2;
+	g_current_vertex_count += 2;
 
 	static const auto trampoline = reshade::hooks::call(glVertex2f);
 	trampoline(x, y);
 }
 extern "C" void APIENTRY glVertex2fv(const GLfloat *v)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 2;
+	g_current_vertex_count += 2;
 
 	static const auto trampoline = reshade::hooks::call(glVertex2fv);
 	trampoline(v);
 }
 extern "C" void APIENTRY glVertex2i(GLint x, GLint y)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 2;
+	g_current_vertex_count += 2;
 
 	static const auto trampoline = reshade::hooks::call(glVertex2i);
 	trampoline(x, y);
 }
 extern "C" void APIENTRY glVertex2iv(const GLint *v)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 2;
+	g_current_vertex_count += 2;
 
 	static const auto trampoline = reshade::hooks::call(glVertex2iv);
 	trampoline(v);
 }
 extern "C" void APIENTRY glVertex2s(GLshort x, GLshort y)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 2;
+	g_current_vertex_count += 2;
 
 	static const auto trampoline = reshade::hooks::call(glVertex2s);
 	trampoline(x, y);
 }
 extern "C" void APIENTRY glVertex2sv(const GLshort *v)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 2;
+	g_current_vertex_count += 2;
 
 	static const auto trampoline = reshade::hooks::call(glVertex2sv);
 	trampoline(v);
 }
 extern "C" void APIENTRY glVertex3d(GLdouble x, GLdouble y, GLdouble z)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 3;
+	g_current_vertex_count += 3;
 
 	static const auto trampoline = reshade::hooks::call(glVertex3d);
 	trampoline(x, y, z);
 }
 extern "C" void APIENTRY glVertex3dv(const GLdouble *v)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 3;
+	g_current_vertex_count += 3;
 
 	static const auto trampoline = reshade::hooks::call(glVertex3dv);
 	trampoline(v);
 }
 extern "C" void APIENTRY glVertex3f(GLfloat x, GLfloat y, GLfloat z)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 3;
+	g_current_vertex_count += 3;
 
 	static const auto trampoline = reshade::hooks::call(glVertex3f);
 	trampoline(x, y, z);
 }
 extern "C" void APIENTRY glVertex3fv(const GLfloat *v)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 3;
+	g_current_vertex_count += 3;
 
 	static const auto trampoline = reshade::hooks::call(glVertex3fv);
 	trampoline(v);
 }
 extern "C" void APIENTRY glVertex3i(GLint x, GLint y, GLint z)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 3;
+	g_current_vertex_count += 3;
 
 	static const auto trampoline = reshade::hooks::call(glVertex3i);
 	trampoline(x, y, z);
 }
 extern "C" void APIENTRY glVertex3iv(const GLint *v)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 3;
+	g_current_vertex_count += 3;
 
 	static const auto trampoline = reshade::hooks::call(glVertex3iv);
 	trampoline(v);
 }
 extern "C" void APIENTRY glVertex3s(GLshort x, GLshort y, GLshort z)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 3;
+	g_current_vertex_count += 3;
 
 	static const auto trampoline = reshade::hooks::call(glVertex3s);
 	trampoline(x, y, z);
 }
 extern "C" void APIENTRY glVertex3sv(const GLshort *v)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 3;
+	g_current_vertex_count += 3;
 
 	static const auto trampoline = reshade::hooks::call(glVertex3sv);
 	trampoline(v);
 }
 extern "C" void APIENTRY glVertex4d(GLdouble x, GLdouble y, GLdouble z, GLdouble w)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 4;
+	g_current_vertex_count += 4;
 
 	static const auto trampoline = reshade::hooks::call(glVertex4d);
 	trampoline(x, y, z, w);
 }
 extern "C" void APIENTRY glVertex4dv(const GLdouble *v)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 4;
+	g_current_vertex_count += 4;
 
 	static const auto trampoline = reshade::hooks::call(glVertex4dv);
 	trampoline(v);
 }
 extern "C" void APIENTRY glVertex4f(GLfloat x, GLfloat y, GLfloat z, GLfloat w)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 4;
+	g_current_vertex_count += 4;
 
 	static const auto trampoline = reshade::hooks::call(glVertex4f);
 	trampoline(x, y, z, w);
 }
 extern "C" void APIENTRY glVertex4fv(const GLfloat *v)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 4;
+	g_current_vertex_count += 4;
 
 	static const auto trampoline = reshade::hooks::call(glVertex4fv);
 	trampoline(v);
 }
 extern "C" void APIENTRY glVertex4i(GLint x, GLint y, GLint z, GLint w)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 4;
+	g_current_vertex_count += 4;
 
 	static const auto trampoline = reshade::hooks::call(glVertex4i);
 	trampoline(x, y, z, w);
 }
 extern "C" void APIENTRY glVertex4iv(const GLint *v)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 4;
+	g_current_vertex_count += 4;
 
 	static const auto trampoline = reshade::hooks::call(glVertex4iv);
 	trampoline(v);
 }
 extern "C" void APIENTRY glVertex4s(GLshort x, GLshort y, GLshort z, GLshort w)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 4;
+	g_current_vertex_count += 4;
 
 	static const auto trampoline = reshade::hooks::call(glVertex4s);
 	trampoline(x, y, z, w);
 }
 extern "C" void APIENTRY glVertex4sv(const GLshort *v)
 {
-	if (g_opengl_context)
-		g_opengl_context->_current_vertex_count += 4;
+	g_current_vertex_count += 4;
 
 	static const auto trampoline = reshade::hooks::call(glVertex4sv);
 	trampoline(v);
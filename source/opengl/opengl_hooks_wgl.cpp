@@ -5,6 +5,7 @@
 
 #include "opengl_impl_device.hpp"
 #include "opengl_impl_device_context.hpp"
+#include "opengl_impl_state_block.hpp"
 #include "opengl_impl_swapchain.hpp"
 #include "opengl_impl_type_convert.hpp"
 #include "opengl_hooks.hpp" // Fix name clashes with gl3w
@@ -227,6 +228,8 @@ public:
 		reshade::destroy_effect_runtime(this);
 	}
 
+	bool is_initialized(unsigned int width, unsigned int height) const { return _last_width == width && _last_height == height; }
+
 	void on_init(reshade::opengl::device_context_impl *context, unsigned int width, unsigned int height)
 	{
 		assert(width != 0 && height != 0);
@@ -1016,6 +1019,28 @@ extern "C" BOOL  WINAPI wglShareLists(HGLRC hglrc1, HGLRC hglrc2)
 	return TRUE;
 }
 
+static void get_default_framebuffer_dimensions(HWND hwnd, unsigned int &width, unsigned int &height)
+{
+	if (hwnd != nullptr)
+	{
+		RECT window_rect = {};
+		GetClientRect(hwnd, &window_rect);
+
+		width = static_cast<unsigned int>(window_rect.right);
+		height = static_cast<unsigned int>(window_rect.bottom);
+	}
+	else
+	{
+		// This may not be accurate, could instead e.g. use 'wglQueryPbufferARB'
+		GLint scissor_box[4] = {};
+		gl.GetIntegerv(GL_SCISSOR_BOX, scissor_box);
+		assert(scissor_box[0] == 0 && scissor_box[1] == 0);
+
+		width = scissor_box[2] - scissor_box[0];
+		height = scissor_box[3] - scissor_box[1];
+	}
+}
+
 extern "C" BOOL  WINAPI wglMakeCurrent(HDC hdc, HGLRC hglrc)
 {
 #if RESHADE_VERBOSE_LOG
@@ -1042,10 +1067,52 @@ extern "C" BOOL  WINAPI wglMakeCurrent(HDC hdc, HGLRC hglrc)
 	else if (hglrc == nullptr)
 	{
 		g_opengl_context = nullptr;
+		g_current_gl_state.invalidate();
 
 		return TRUE;
 	}
 
+	// A different context was made current on this thread, so the shadowed state no longer applies
+	g_current_gl_state.invalidate();
+
+	// Switching between contexts of share groups that were already made current before only reads the global state, so attempt that under a shared lock first, to avoid serializing threads that merely switch contexts
+	{ const std::shared_lock<std::shared_mutex> lock(s_global_mutex);
+		if (const auto it = s_shared_contexts.find(hglrc);
+			it != s_shared_contexts.end() && it->second != nullptr)
+			shared_hglrc = it->second;
+
+		const auto device_it = s_opengl_contexts.find(shared_hglrc);
+		const auto context_it = hglrc != shared_hglrc ? s_opengl_contexts.find(hglrc) : device_it;
+
+		if (device_it != s_opengl_contexts.end() && context_it != s_opengl_contexts.end())
+		{
+			const auto device = static_cast<wgl_device *>(device_it->second);
+
+			const HWND hwnd = WindowFromDC(hdc);
+
+			if (const auto swapchain_it = std::find_if(s_opengl_swapchains.begin(), s_opengl_swapchains.end(),
+					[hdc, hwnd, device](wgl_swapchain *const swapchain) {
+						const HDC swapchain_hdc = reinterpret_cast<HDC>(swapchain->_orig);
+						return (swapchain_hdc == hdc || (hwnd != nullptr && WindowFromDC(swapchain_hdc) == hwnd)) && swapchain->get_device() == device;
+					});
+				swapchain_it != s_opengl_swapchains.end())
+			{
+				unsigned int width = 0;
+				unsigned int height = 0;
+				get_default_framebuffer_dimensions(hwnd, width, height);
+
+				// Resizing the swap chain modifies shared state, so that has to take the exclusive lock below
+				if (width == 0 || height == 0 || (*swapchain_it)->is_initialized(width, height))
+				{
+					g_opengl_context = context_it->second;
+					g_opengl_context->update_default_framebuffer(width, height);
+
+					return TRUE;
+				}
+			}
+		}
+	}
+
 	const std::unique_lock<std::shared_mutex> lock(s_global_mutex);
 
 	if (const auto it = s_shared_contexts.find(hglrc);
@@ -1159,24 +1226,7 @@ extern "C" BOOL  WINAPI wglMakeCurrent(HDC hdc, HGLRC hglrc)
 
 	unsigned int width = 0;
 	unsigned int height = 0;
-	if (hwnd != nullptr)
-	{
-		RECT window_rect = {};
-		GetClientRect(hwnd, &window_rect);
-
-		width = static_cast<unsigned int>(window_rect.right);
-		height = static_cast<unsigned int>(window_rect.bottom);
-	}
-	else
-	{
-		// This may not be accurate, could instead e.g. use 'wglQueryPbufferARB'
-		GLint scissor_box[4] = {};
-		gl.GetIntegerv(GL_SCISSOR_BOX, scissor_box);
-		assert(scissor_box[0] == 0 && scissor_box[1] == 0);
-
-		width = scissor_box[2] - scissor_box[0];
-		height = scissor_box[3] - scissor_box[1];
-	}
+	get_default_framebuffer_dimensions(hwnd, width, height);
 
 	// Wolfenstein: The Old Blood creates a window with a height of zero that is later resized
 	if (swapchain != nullptr && width != 0 && height != 0)
@@ -1407,6 +1457,10 @@ extern "C" PROC  WINAPI wglGetProcAddress(LPCSTR lpszProc)
 		return nullptr;
 #if RESHADE_ADDON
 	// Redirect some old extension functions to their modern variants in core OpenGL
+	#pragma region GL_ARB_multitexture
+	else if (0 == std::strcmp(lpszProc, "glActiveTextureARB"))
+		lpszProc = "glActiveTexture";
+	#pragma endregion
 	#pragma region GL_ARB_draw_instanced
 	else if (0 == std::strcmp(lpszProc, "glDrawArraysInstancedARB"))
 		lpszProc = "glDrawArraysInstanced";
@@ -1627,6 +1681,7 @@ extern "C" PROC  WINAPI wglGetProcAddress(LPCSTR lpszProc)
 		HOOK_PROC(glDrawRangeElements);
 #endif
 #ifdef GL_VERSION_1_3
+		HOOK_PROC(glActiveTexture);
 		HOOK_PROC(glCompressedTexImage1D);
 		HOOK_PROC(glCompressedTexImage2D);
 		HOOK_PROC(glCompressedTexImage3D);
@@ -1650,6 +1705,7 @@ extern "C" PROC  WINAPI wglGetProcAddress(LPCSTR lpszProc)
 		HOOK_PROC(glBindBuffer);
 #endif
 #ifdef GL_VERSION_2_0
+		HOOK_PROC(glDrawBuffers);
 		HOOK_PROC(glDeleteProgram);
 		HOOK_PROC(glLinkProgram);
 		HOOK_PROC(glShaderSource);
@@ -1733,6 +1789,10 @@ extern "C" PROC  WINAPI wglGetProcAddress(LPCSTR lpszProc)
 		HOOK_PROC(glDrawElementsInstancedBaseVertex);
 		HOOK_PROC(glMultiDrawElementsBaseVertex);
 #endif
+#ifdef GL_VERSION_3_3
+		HOOK_PROC(glBindSampler);
+		HOOK_PROC(glDeleteSamplers);
+#endif
 #ifdef GL_VERSION_4_0
 		HOOK_PROC(glDrawArraysIndirect);
 		HOOK_PROC(glDrawElementsIndirect);
@@ -1771,6 +1831,7 @@ extern "C" PROC  WINAPI wglGetProcAddress(LPCSTR lpszProc)
 		HOOK_PROC(glBufferStorage);
 		HOOK_PROC(glBindBuffersBase);
 		HOOK_PROC(glBindBuffersRange);
+		HOOK_PROC(glBindSamplers);
 		HOOK_PROC(glBindTextures);
 		HOOK_PROC(glBindImageTextures);
 		HOOK_PROC(glBindVertexBuffers);
@@ -5,6 +5,7 @@
 
 #include "opengl_impl_device.hpp"
 #include "opengl_impl_device_context.hpp"
+#include "opengl_impl_state_block.hpp"
 #include "opengl_impl_type_convert.hpp"
 #include <cstring> // std::memcpy
 #include <algorithm> // std::copy_n, std::max
@@ -164,6 +165,9 @@ void reshade::opengl::device_context_impl::barrier(uint32_t count, const api::re
 
 void reshade::opengl::device_context_impl::begin_render_pass(uint32_t count, const api::render_pass_render_target_desc *rts, const api::render_pass_depth_stencil_desc *ds)
 {
+	// This modifies context state without going through the hooks in opengl_hooks.cpp, so the shadowed state is stale afterwards (same in the other bind methods below)
+	g_current_gl_state.invalidate();
+
 	temp_mem<api::resource_view, 8> rtv_handles(count);
 	for (uint32_t i = 0; i < count; ++i)
 		rtv_handles[i] = rts[i].view;
@@ -201,6 +205,8 @@ void reshade::opengl::device_context_impl::end_render_pass()
 }
 void reshade::opengl::device_context_impl::bind_render_targets_and_depth_stencil(uint32_t count, const api::resource_view *rtvs, api::resource_view dsv)
 {
+	g_current_gl_state.invalidate();
+
 	bind_framebuffer_with_resource_views(GL_FRAMEBUFFER, count, rtvs, dsv);
 
 	bool has_srgb_attachment = false;
@@ -234,6 +240,8 @@ void reshade::opengl::device_context_impl::bind_render_targets_and_depth_stencil
 
 void reshade::opengl::device_context_impl::bind_framebuffer_with_resource(GLenum target, GLenum attachment, api::resource dst, uint32_t dst_subresource, const api::resource_desc &dst_desc)
 {
+	g_current_gl_state.invalidate();
+
 	const GLenum dst_target = dst.handle >> 40;
 	const GLuint dst_object = dst.handle & 0xFFFFFFFF;
 
@@ -299,6 +307,8 @@ void reshade::opengl::device_context_impl::bind_framebuffer_with_resource(GLenum
 }
 void reshade::opengl::device_context_impl::bind_framebuffer_with_resource_views(GLenum target, uint32_t count, const api::resource_view *rtvs, api::resource_view dsv)
 {
+	g_current_gl_state.invalidate();
+
 	if ((count == 1 && (rtvs[0].handle >> 40) == GL_FRAMEBUFFER_DEFAULT) || (count == 0 && (dsv == 0 || (dsv.handle >> 40) == GL_FRAMEBUFFER_DEFAULT)))
 	{
 		assert(dsv == 0 || (dsv.handle >> 40) == GL_FRAMEBUFFER_DEFAULT);
@@ -478,6 +488,8 @@ void reshade::opengl::device_context_impl::update_current_window_height(api::res
 
 void reshade::opengl::device_context_impl::bind_pipeline(api::pipeline_stage stages, api::pipeline pipeline)
 {
+	g_current_gl_state.invalidate();
+
 	if (pipeline == 0)
 		return;
 
@@ -549,6 +561,8 @@ void reshade::opengl::device_context_impl::bind_pipeline(api::pipeline_stage sta
 }
 void reshade::opengl::device_context_impl::bind_pipeline_states(uint32_t count, const api::dynamic_state *states, const uint32_t *values)
 {
+	g_current_gl_state.invalidate();
+
 	for (uint32_t i = 0; i < count; ++i)
 	{
 		switch (states[i])
@@ -924,6 +938,8 @@ void reshade::opengl::device_context_impl::bind_pipeline_states(uint32_t count,
 }
 void reshade::opengl::device_context_impl::bind_viewports(uint32_t first, uint32_t count, const api::viewport *viewports)
 {
+	g_current_gl_state.invalidate();
+
 	for (uint32_t i = 0; i < count; ++i)
 	{
 		gl.ViewportIndexedf(first + i, viewports[i].x, viewports[i].y, viewports[i].width, viewports[i].height);
@@ -932,6 +948,8 @@ void reshade::opengl::device_context_impl::bind_viewports(uint32_t first, uint32
 }
 void reshade::opengl::device_context_impl::bind_scissor_rects(uint32_t first, uint32_t count, const api::rect *rects)
 {
+	g_current_gl_state.invalidate();
+
 	GLint clip_origin = GL_LOWER_LEFT;
 	if (gl.ClipControl != nullptr)
 		gl.GetIntegerv(GL_CLIP_ORIGIN, &clip_origin);
@@ -1075,6 +1093,8 @@ void reshade::opengl::device_context_impl::push_constants(api::shader_stage, api
 }
 void reshade::opengl::device_context_impl::push_descriptors(api::shader_stage, api::pipeline_layout layout, uint32_t layout_param, const api::descriptor_table_update &update)
 {
+	g_current_gl_state.invalidate();
+
 	assert(update.table == 0 && update.array_offset == 0);
 
 	const uint32_t first = update.binding;
@@ -1185,6 +1205,8 @@ void reshade::opengl::device_context_impl::push_descriptors(api::shader_stage, a
 }
 void reshade::opengl::device_context_impl::bind_descriptor_tables(api::shader_stage stages, api::pipeline_layout layout, uint32_t first, uint32_t count, const api::descriptor_table *tables)
 {
+	g_current_gl_state.invalidate();
+
 	for (uint32_t i = 0; i < count; ++i)
 	{
 		const auto table_impl = reinterpret_cast<const descriptor_table_impl *>(tables[i].handle);
@@ -1199,6 +1221,8 @@ void reshade::opengl::device_context_impl::bind_descriptor_tables(api::shader_st
 
 void reshade::opengl::device_context_impl::bind_index_buffer(api::resource buffer, uint64_t offset, uint32_t index_size)
 {
+	g_current_gl_state.invalidate();
+
 	assert(offset == 0);
 
 	gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.handle & 0xFFFFFFFF);
@@ -1223,6 +1247,8 @@ void reshade::opengl::device_context_impl::bind_index_buffer(api::resource buffe
 }
 void reshade::opengl::device_context_impl::bind_vertex_buffers(uint32_t first, uint32_t count, const api::resource *buffers, const uint64_t *offsets, const uint32_t *strides)
 {
+	g_current_gl_state.invalidate();
+
 	for (uint32_t i = 0; i < count; ++i)
 	{
 		if (buffers[i] == 0)
@@ -1237,6 +1263,8 @@ void reshade::opengl::device_context_impl::bind_vertex_buffers(uint32_t first, u
 }
 void reshade::opengl::device_context_impl::bind_stream_output_buffers(uint32_t first, uint32_t count, const api::resource *buffers, const uint64_t *offsets, const uint64_t *max_sizes, const api::resource *, const uint64_t *)
 {
+	g_current_gl_state.invalidate();
+
 	for (uint32_t i = 0; i < count; ++i)
 	{
 		if (offsets == nullptr || max_sizes == nullptr || max_sizes[i] == UINT64_MAX)
@@ -1477,9 +1505,12 @@ void reshade::opengl::device_context_impl::copy_buffer_to_texture(api::resource
 	else
 	{
 		GLuint prev_binding = 0;
-		gl.GetIntegerv(get_binding_for_target(dst_target), reinterpret_cast<GLint *>(&prev_binding));
-		if (dst_object != prev_binding)
-			gl.BindTexture(dst_target, dst_object);
+		if (!_device_impl->_supports_dsa)
+		{
+			gl.GetIntegerv(get_binding_for_target(dst_target), reinterpret_cast<GLint *>(&prev_binding));
+			if (dst_object != prev_binding)
+				gl.BindTexture(dst_target, dst_object);
+		}
 
 		const GLuint level = dst_subresource % dst_desc.texture.levels;
 		      GLuint layer = dst_subresource / dst_desc.texture.levels;
@@ -1492,8 +1523,9 @@ void reshade::opengl::device_context_impl::copy_buffer_to_texture(api::resource
 		}
 
 		GLenum level_target = dst_target;
-		if (depth == 1 && (dst_target == GL_TEXTURE_CUBE_MAP || dst_target == GL_TEXTURE_CUBE_MAP_ARRAY))
+		if (depth == 1 && (dst_target == GL_TEXTURE_CUBE_MAP || dst_target == GL_TEXTURE_CUBE_MAP_ARRAY) && !_device_impl->_supports_dsa)
 		{
+			// The DSA upload functions address cube map faces as layers, so this face target split is only needed for the classic upload path
 			const GLuint face = layer % 6;
 			layer /= 6;
 			level_target = GL_TEXTURE_CUBE_MAP_POSITIVE_X + face;
@@ -1509,9 +1541,15 @@ void reshade::opengl::device_context_impl::copy_buffer_to_texture(api::resource
 		{
 		case GL_TEXTURE_1D:
 			if (type != GL_COMPRESSED_TEXTURE_FORMATS)
-				gl.TexSubImage1D(level_target, level, xoffset, width, format, type, reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
+				if (_device_impl->_supports_dsa)
+					gl.TextureSubImage1D(dst_object, level, xoffset, width, format, type, reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
+				else
+					gl.TexSubImage1D(level_target, level, xoffset, width, format, type, reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
 			else
-				gl.CompressedTexSubImage1D(level_target, level, xoffset, width, format, static_cast<GLsizei>(total_image_size), reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
+				if (_device_impl->_supports_dsa)
+					gl.CompressedTextureSubImage1D(dst_object, level, xoffset, width, format, static_cast<GLsizei>(total_image_size), reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
+				else
+					gl.CompressedTexSubImage1D(level_target, level, xoffset, width, format, static_cast<GLsizei>(total_image_size), reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
 			break;
 		case GL_TEXTURE_1D_ARRAY:
 			yoffset += layer;
@@ -1525,9 +1563,15 @@ void reshade::opengl::device_context_impl::copy_buffer_to_texture(api::resource
 		case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
 		case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
 			if (type != GL_COMPRESSED_TEXTURE_FORMATS)
-				gl.TexSubImage2D(level_target, level, xoffset, yoffset, width, height, format, type, reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
+				if (_device_impl->_supports_dsa)
+					gl.TextureSubImage2D(dst_object, level, xoffset, yoffset, width, height, format, type, reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
+				else
+					gl.TexSubImage2D(level_target, level, xoffset, yoffset, width, height, format, type, reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
 			else
-				gl.CompressedTexSubImage2D(level_target, level, xoffset, yoffset, width, height, format, static_cast<GLsizei>(total_image_size), reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
+				if (_device_impl->_supports_dsa)
+					gl.CompressedTextureSubImage2D(dst_object, level, xoffset, yoffset, width, height, format, static_cast<GLsizei>(total_image_size), reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
+				else
+					gl.CompressedTexSubImage2D(level_target, level, xoffset, yoffset, width, height, format, static_cast<GLsizei>(total_image_size), reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
 			break;
 		case GL_TEXTURE_2D_ARRAY:
 		case GL_TEXTURE_CUBE_MAP:
@@ -1536,13 +1580,19 @@ void reshade::opengl::device_context_impl::copy_buffer_to_texture(api::resource
 			[[fallthrough]];
 		case GL_TEXTURE_3D:
 			if (type != GL_COMPRESSED_TEXTURE_FORMATS)
-				gl.TexSubImage3D(level_target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
+				if (_device_impl->_supports_dsa)
+					gl.TextureSubImage3D(dst_object, level, xoffset, yoffset, zoffset, width, height, depth, format, type, reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
+				else
+					gl.TexSubImage3D(level_target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
 			else
-				gl.CompressedTexSubImage3D(level_target, level, xoffset, yoffset, zoffset, width, height, depth, format, static_cast<GLsizei>(total_image_size), reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
+				if (_device_impl->_supports_dsa)
+					gl.CompressedTextureSubImage3D(dst_object, level, xoffset, yoffset, zoffset, width, height, depth, format, static_cast<GLsizei>(total_image_size), reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
+				else
+					gl.CompressedTexSubImage3D(level_target, level, xoffset, yoffset, zoffset, width, height, depth, format, static_cast<GLsizei>(total_image_size), reinterpret_cast<void *>(static_cast<uintptr_t>(src_offset)));
 			break;
 		}
 
-		if (dst_object != prev_binding)
+		if (!_device_impl->_supports_dsa && dst_object != prev_binding)
 			gl.BindTexture(dst_target, prev_binding);
 	}
 
@@ -1570,6 +1620,28 @@ void reshade::opengl::device_context_impl::copy_texture_region(api::resource src
 	const GLenum dst_target = dst.handle >> 40;
 	const GLuint dst_object = dst.handle & 0xFFFFFFFF;
 
+	// Copies involving textures that are backed by a pixel buffer object (see 'device_impl::create_resource') go through the pixel pack and unpack paths, so that the GPU packs pixel data into the buffer asynchronously
+	if (dst_target == GL_BUFFER)
+	{
+		assert(dst_box == nullptr);
+
+		const auto dst_row_pitch = api::format_row_pitch(dst_desc.texture.format, dst_desc.texture.width);
+		const auto dst_slice_pitch = api::format_slice_pitch(dst_desc.texture.format, dst_row_pitch, dst_desc.texture.height);
+
+		copy_texture_to_buffer(src, src_subresource, src_box, dst, static_cast<uint64_t>(dst_subresource) * dst_slice_pitch, dst_desc.texture.width, dst_desc.texture.height);
+		return;
+	}
+	if (src_target == GL_BUFFER)
+	{
+		assert(src_box == nullptr);
+
+		const auto src_row_pitch = api::format_row_pitch(src_desc.texture.format, src_desc.texture.width);
+		const auto src_slice_pitch = api::format_slice_pitch(src_desc.texture.format, src_row_pitch, src_desc.texture.height);
+
+		copy_buffer_to_texture(src, static_cast<uint64_t>(src_subresource) * src_slice_pitch, src_desc.texture.width, src_desc.texture.height, dst, dst_subresource, dst_box);
+		return;
+	}
+
 	GLint src_region[6] = {};
 	if (src_box != nullptr)
 	{
@@ -1757,10 +1829,16 @@ void reshade::opengl::device_context_impl::copy_texture_to_buffer(api::resource
 	}
 	else
 	{
+		// 'glGetTexImage' below requires the texture to be bound, but the DSA read path does not
+		const bool need_bind = !_device_impl->_supports_dsa || src_box == nullptr;
+
 		GLuint prev_binding = 0;
-		gl.GetIntegerv(get_binding_for_target(src_target), reinterpret_cast<GLint *>(&prev_binding));
-		if (src_object != prev_binding)
-			gl.BindTexture(src_target, src_object);
+		if (need_bind)
+		{
+			gl.GetIntegerv(get_binding_for_target(src_target), reinterpret_cast<GLint *>(&prev_binding));
+			if (src_object != prev_binding)
+				gl.BindTexture(src_target, src_object);
+		}
 
 		const GLuint level = src_subresource % src_desc.texture.levels;
 		      GLuint layer = src_subresource / src_desc.texture.levels;
@@ -1809,7 +1887,7 @@ void reshade::opengl::device_context_impl::copy_texture_to_buffer(api::resource
 			gl.GetTextureSubImage(src_object, level, xoffset, yoffset, zoffset, width, height, depth, format, type, static_cast<GLsizei>(total_image_size), reinterpret_cast<void *>(static_cast<uintptr_t>(dst_offset)));
 		}
 
-		if (src_object != prev_binding)
+		if (need_bind && src_object != prev_binding)
 			gl.BindTexture(src_target, prev_binding);
 	}
 
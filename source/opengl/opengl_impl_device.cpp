@@ -240,6 +240,9 @@ bool reshade::opengl::device_impl::check_capability(api::device_caps capability)
 		return false;
 	case api::device_caps::amplification_and_mesh_shader:
 	case api::device_caps::ray_tracing:
+		return false;
+	case api::device_caps::partial_constant_buffer_updates:
+		return true;
 	default:
 		return false;
 	}
@@ -381,6 +384,45 @@ bool reshade::opengl::device_impl::create_resource(const api::resource_desc &des
 {
 	*out_resource = { 0 };
 
+	// Textures in the upload or readback heap are created as pixel buffer objects instead, so that they can be mapped without stalling on a synchronous download (the GPU packs pixel data into the buffer during 'copy_texture_region' asynchronously)
+	if (desc.type != api::resource_type::buffer && desc.type != api::resource_type::surface && desc.texture.levels == 1 && desc.texture.samples == 1 &&
+		(desc.heap == api::memory_heap::gpu_to_cpu || desc.heap == api::memory_heap::cpu_only) &&
+		(desc.flags & api::resource_flags::shared) == 0 && initial_data == nullptr)
+	{
+		const auto row_pitch = api::format_row_pitch(desc.texture.format, desc.texture.width);
+		const auto slice_pitch = api::format_slice_pitch(desc.texture.format, row_pitch, desc.texture.height);
+		const GLsizeiptr buffer_size = static_cast<GLsizeiptr>(slice_pitch) * desc.texture.depth_or_layers;
+		if (buffer_size == 0)
+			return false;
+
+		GLuint object = 0;
+		GLuint prev_binding = 0;
+		gl.GetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, reinterpret_cast<GLint *>(&prev_binding));
+
+		// Clear any errors that may still be on the stack
+		while (gl.GetError() != GL_NO_ERROR)
+			continue;
+
+		gl.GenBuffers(1, &object);
+		gl.BindBuffer(GL_PIXEL_PACK_BUFFER, object);
+		gl.BufferStorage(GL_PIXEL_PACK_BUFFER, buffer_size, nullptr, desc.heap == api::memory_heap::gpu_to_cpu ? GL_MAP_READ_BIT : GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_CLIENT_STORAGE_BIT);
+
+		const GLenum pack_status = gl.GetError();
+
+		gl.BindBuffer(GL_PIXEL_PACK_BUFFER, prev_binding);
+
+		if (pack_status != GL_NO_ERROR)
+		{
+			gl.DeleteBuffers(1, &object);
+			return false;
+		}
+
+		_buffer_backed_textures.emplace(object, desc);
+
+		*out_resource = make_resource_handle(GL_BUFFER, object);
+		return true;
+	}
+
 	GLenum target = GL_NONE;
 	switch (desc.type)
 	{
@@ -505,11 +547,22 @@ bool reshade::opengl::device_impl::create_resource(const api::resource_desc &des
 			if (initial_data != nullptr)
 				storage_flags |= GL_DYNAMIC_STORAGE_BIT;
 
+			// Keep upload heap buffers persistently mapped, so that frequent uploads (effect uniform data, overlay vertices) do not have to map and unmap them every time
+			if (desc.heap == api::memory_heap::cpu_to_gpu)
+				storage_flags |= GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
 			gl.BufferStorage(target, buffer_size, nullptr, storage_flags);
 		}
 
 		status = gl.GetError();
 
+		// Map the buffer once for its entire lifetime, so that 'map_buffer_region' can hand out the pointer without another map call (the coherent flag makes writes visible without an explicit flush)
+		if (status == GL_NO_ERROR && (storage_flags & GL_MAP_PERSISTENT_BIT) != 0)
+		{
+			if (void *const mapped_data = gl.MapBufferRange(target, 0, buffer_size, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT))
+				_persistent_mappings.emplace(object, mapped_data);
+		}
+
 		if (initial_data != nullptr && status == GL_NO_ERROR)
 		{
 			update_buffer_region(initial_data->data, make_resource_handle(GL_BUFFER, object), 0, desc.buffer.size);
@@ -679,6 +732,9 @@ void reshade::opengl::device_impl::destroy_resource(api::resource resource)
 	switch (resource.handle >> 40)
 	{
 	case GL_BUFFER:
+		// Deleting the buffer implicitly unmaps any persistent mapping
+		_persistent_mappings.erase(object);
+		_buffer_backed_textures.erase(object);
 		gl.DeleteBuffers(1, &object);
 		break;
 	case GL_TEXTURE_BUFFER:
@@ -715,6 +771,11 @@ reshade::api::resource_desc reshade::opengl::device_impl::get_resource_desc(api:
 	{
 		case GL_BUFFER:
 		{
+			// Report the original texture description for textures that are backed by a pixel buffer object (see 'create_resource')
+			if (const auto it = _buffer_backed_textures.find(object);
+				it != _buffer_backed_textures.end())
+				return it->second;
+
 #ifndef _WIN64
 			GLint size = 0;
 #else
@@ -1359,6 +1420,17 @@ bool reshade::opengl::device_impl::map_buffer_region(api::resource resource, uin
 
 	const GLuint object = resource.handle & 0xFFFFFFFF;
 
+	// Buffers with a persistent mapping can only be mapped once, so hand out the existing pointer (note that this does not implement discard semantics, but upload heap buffers are multi-buffered by the callers)
+	if (const auto it = _persistent_mappings.find(object);
+		it != _persistent_mappings.end())
+	{
+		if (access == api::map_access::read_only || access == api::map_access::read_write)
+			return false; // The persistent mapping was created for writing only
+
+		*out_data = static_cast<uint8_t *>(it->second) + static_cast<GLintptr>(offset);
+		return true;
+	}
+
 	if (_supports_dsa)
 	{
 		if (size == UINT64_MAX)
@@ -1407,6 +1479,10 @@ void reshade::opengl::device_impl::unmap_buffer_region(api::resource resource)
 
 	const GLuint object = resource.handle & 0xFFFFFFFF;
 
+	// Persistent mappings stay valid for the lifetime of the buffer and the coherent flag makes an explicit flush unnecessary
+	if (_persistent_mappings.find(object) != _persistent_mappings.end())
+		return;
+
 	if (_supports_dsa)
 	{
 		gl.UnmapNamedBuffer(object);
@@ -1434,6 +1510,30 @@ bool reshade::opengl::device_impl::map_texture_region(api::resource resource, ui
 
 	assert(resource != 0);
 
+	// Textures that are backed by a pixel buffer object can hand out a pointer into that buffer directly, which does not stall when the GPU has already finished packing into it (see 'create_resource')
+	if ((resource.handle >> 40) == GL_BUFFER)
+	{
+		const auto it = _buffer_backed_textures.find(resource.handle & 0xFFFFFFFF);
+		if (it == _buffer_backed_textures.end())
+			return false;
+
+		assert(box == nullptr);
+
+		const api::resource_desc &buffer_desc = it->second;
+
+		const auto row_pitch = api::format_row_pitch(buffer_desc.texture.format, buffer_desc.texture.width);
+		const auto slice_pitch = api::format_slice_pitch(buffer_desc.texture.format, row_pitch, buffer_desc.texture.height);
+
+		assert(subresource < buffer_desc.texture.depth_or_layers);
+
+		if (!map_buffer_region(resource, static_cast<uint64_t>(subresource) * slice_pitch, slice_pitch, access, &out_data->data))
+			return false;
+
+		out_data->row_pitch = row_pitch;
+		out_data->slice_pitch = slice_pitch;
+		return true;
+	}
+
 	size_t hash = 0;
 	hash_combine(hash, resource.handle);
 	hash_combine(hash, subresource);
@@ -1590,6 +1690,13 @@ void reshade::opengl::device_impl::unmap_texture_region(api::resource resource,
 {
 	assert(resource != 0);
 
+	// Textures that are backed by a pixel buffer object only need to unmap that buffer again (see 'map_texture_region')
+	if ((resource.handle >> 40) == GL_BUFFER)
+	{
+		unmap_buffer_region(resource);
+		return;
+	}
+
 	size_t hash = 0;
 	hash_combine(hash, resource.handle);
 	hash_combine(hash, subresource);
@@ -1618,6 +1725,14 @@ void reshade::opengl::device_impl::update_buffer_region(const void *data, api::r
 
 	const GLuint object = resource.handle & 0xFFFFFFFF;
 
+	// Copy through the persistent mapping if one exists, which avoids the driver-internal synchronization of 'glBufferSubData'
+	if (const auto it = _persistent_mappings.find(object);
+		it != _persistent_mappings.end())
+	{
+		std::memcpy(static_cast<uint8_t *>(it->second) + static_cast<GLintptr>(offset), data, static_cast<size_t>(size));
+		return;
+	}
+
 	if (_supports_dsa)
 	{
 		gl.NamedBufferSubData(object, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
@@ -1664,7 +1779,8 @@ void reshade::opengl::device_impl::update_texture_region(const api::subresource_
 	gl.GetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, reinterpret_cast<GLint *>(&prev_unpack_binding));
 
 	GLuint prev_binding = 0;
-	gl.GetIntegerv(get_binding_for_target(target), reinterpret_cast<GLint *>(&prev_binding));
+	if (!_supports_dsa)
+		gl.GetIntegerv(get_binding_for_target(target), reinterpret_cast<GLint *>(&prev_binding));
 
 	// Unset any existing unpack buffer so pointer is not interpreted as an offset
 	if (prev_unpack_binding != 0)
@@ -1680,8 +1796,8 @@ void reshade::opengl::device_impl::update_texture_region(const api::subresource_
 	gl.PixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
 	gl.PixelStorei(GL_UNPACK_SKIP_IMAGES, 0);
 
-	// Bind and upload texture data
-	if (object != prev_binding)
+	// Bind and upload texture data (DSA can upload directly to the texture object without modifying the binding state below)
+	if (!_supports_dsa && object != prev_binding)
 		gl.BindTexture(target, object);
 
 	const api::resource_desc desc = get_resource_desc(resource);
@@ -1708,8 +1824,9 @@ void reshade::opengl::device_impl::update_texture_region(const api::subresource_
 	}
 
 	GLenum level_target = target;
-	if (depth == 1 && (target == GL_TEXTURE_CUBE_MAP || target == GL_TEXTURE_CUBE_MAP_ARRAY))
+	if (depth == 1 && (target == GL_TEXTURE_CUBE_MAP || target == GL_TEXTURE_CUBE_MAP_ARRAY) && !_supports_dsa)
 	{
+		// The DSA upload functions address cube map faces as layers, so this face target split is only needed for the classic upload path
 		const GLuint face = layer % 6;
 		layer /= 6;
 		level_target = GL_TEXTURE_CUBE_MAP_POSITIVE_X + face;
@@ -1743,9 +1860,15 @@ void reshade::opengl::device_impl::update_texture_region(const api::subresource_
 	{
 	case GL_TEXTURE_1D:
 		if (type != GL_COMPRESSED_TEXTURE_FORMATS)
-			gl.TexSubImage1D(level_target, level, xoffset, width, format, type, pixels);
+			if (_supports_dsa)
+				gl.TextureSubImage1D(object, level, xoffset, width, format, type, pixels);
+			else
+				gl.TexSubImage1D(level_target, level, xoffset, width, format, type, pixels);
 		else
-			gl.CompressedTexSubImage1D(level_target, level, xoffset, width, format, static_cast<GLsizei>(total_image_size), pixels);
+			if (_supports_dsa)
+				gl.CompressedTextureSubImage1D(object, level, xoffset, width, format, static_cast<GLsizei>(total_image_size), pixels);
+			else
+				gl.CompressedTexSubImage1D(level_target, level, xoffset, width, format, static_cast<GLsizei>(total_image_size), pixels);
 		break;
 	case GL_TEXTURE_1D_ARRAY:
 		yoffset += layer;
@@ -1759,9 +1882,15 @@ void reshade::opengl::device_impl::update_texture_region(const api::subresource_
 	case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
 	case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
 		if (type != GL_COMPRESSED_TEXTURE_FORMATS)
-			gl.TexSubImage2D(level_target, level, xoffset, yoffset, width, height, format, type, pixels);
+			if (_supports_dsa)
+				gl.TextureSubImage2D(object, level, xoffset, yoffset, width, height, format, type, pixels);
+			else
+				gl.TexSubImage2D(level_target, level, xoffset, yoffset, width, height, format, type, pixels);
 		else
-			gl.CompressedTexSubImage2D(level_target, level, xoffset, yoffset, width, height, format, static_cast<GLsizei>(total_image_size), pixels);
+			if (_supports_dsa)
+				gl.CompressedTextureSubImage2D(object, level, xoffset, yoffset, width, height, format, static_cast<GLsizei>(total_image_size), pixels);
+			else
+				gl.CompressedTexSubImage2D(level_target, level, xoffset, yoffset, width, height, format, static_cast<GLsizei>(total_image_size), pixels);
 		break;
 	case GL_TEXTURE_2D_ARRAY:
 	case GL_TEXTURE_CUBE_MAP:
@@ -1770,14 +1899,20 @@ void reshade::opengl::device_impl::update_texture_region(const api::subresource_
 		[[fallthrough]];
 	case GL_TEXTURE_3D:
 		if (type != GL_COMPRESSED_TEXTURE_FORMATS)
-			gl.TexSubImage3D(level_target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels);
+			if (_supports_dsa)
+				gl.TextureSubImage3D(object, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels);
+			else
+				gl.TexSubImage3D(level_target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels);
 		else
-			gl.CompressedTexSubImage3D(level_target, level, xoffset, yoffset, zoffset, width, height, depth, format, static_cast<GLsizei>(total_image_size), pixels);
+			if (_supports_dsa)
+				gl.CompressedTextureSubImage3D(object, level, xoffset, yoffset, zoffset, width, height, depth, format, static_cast<GLsizei>(total_image_size), pixels);
+			else
+				gl.CompressedTexSubImage3D(level_target, level, xoffset, yoffset, zoffset, width, height, depth, format, static_cast<GLsizei>(total_image_size), pixels);
 		break;
 	}
 
 	// Restore previous state from application
-	if (object != prev_binding)
+	if (!_supports_dsa && object != prev_binding)
 		gl.BindTexture(target, prev_binding);
 
 	if (prev_unpack_binding != 0)
@@ -113,6 +113,12 @@ namespace reshade::opengl
 		};
 		std::unordered_map<size_t, map_info> _map_lookup;
 
+		// Buffers created with 'GL_MAP_PERSISTENT_BIT' that are kept mapped for their entire lifetime, so that per-frame uploads do not pay for a map/unmap round-trip (see 'map_buffer_region')
+		std::unordered_map<GLuint, void *> _persistent_mappings;
+
+		// Textures in the upload or readback heap that are backed by a pixel buffer object rather than an actual texture, so that mapping them does not stall on a synchronous download (see 'create_resource')
+		std::unordered_map<GLuint, api::resource_desc> _buffer_backed_textures;
+
 		std::atomic<uint64_t> _fbo_lookup_version = 0;
 		std::atomic<uint64_t> _vao_lookup_version = 0;
 	};
@@ -4,6 +4,7 @@
  */
 
 #include "opengl_impl_state_block.hpp"
+#include <algorithm> // std::copy_n
 
 #define gl gl3wProcs.gl
 
@@ -21,96 +22,172 @@ reshade::opengl::state_block::state_block()
 
 void reshade::opengl::state_block::capture(bool compatibility)
 {
-	gl.GetIntegerv(GL_COPY_READ_BUFFER_BINDING, &_copy_read);
-	gl.GetIntegerv(GL_COPY_WRITE_BUFFER_BINDING, &_copy_write);
+#if RESHADE_ADDON
+	const bool refresh_all = !_captured_once;
+	_captured_once = true;
+#else
+	// The hooks feeding the state shadow are only fully installed when add-on support is enabled, so cannot rely on it in that case and have to assume all state was modified
+	const bool refresh_all = true;
+#endif
+	state_shadow &shadow = g_current_gl_state;
 
-	gl.GetIntegerv(GL_VERTEX_ARRAY_BINDING, &_vao);
-	gl.GetIntegerv(GL_ARRAY_BUFFER_BINDING, &_vbo);
-	gl.GetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &_ibo);
+	// Checks whether any state of the specified group was modified since the last capture, in which case it has to be queried fresh below (and the capture is synchronized with the current group version)
+	const auto needs_refresh = [&, this](state_shadow::group changed_group) {
+		if (!refresh_all && _synced_versions[changed_group] == shadow.modified[changed_group])
+			return false;
+		_synced_versions[changed_group] = shadow.modified[changed_group];
+		return true;
+	};
 
-	gl.GetIntegerv(GL_CURRENT_PROGRAM, &_program);
+	if (needs_refresh(state_shadow::group_buffer_bindings))
+	{
+		gl.GetIntegerv(GL_COPY_READ_BUFFER_BINDING, &_copy_read);
+		gl.GetIntegerv(GL_COPY_WRITE_BUFFER_BINDING, &_copy_write);
+		gl.GetIntegerv(GL_ARRAY_BUFFER_BINDING, &_vbo);
+		gl.GetIntegerv(GL_UNIFORM_BUFFER_BINDING, &_active_ubo);
+	}
 
-	// Save and restore individual UBO bindings (for compatibility with Yamagi Quake II)
-	gl.GetIntegerv(GL_UNIFORM_BUFFER_BINDING, &_active_ubo);
-	for (GLuint i = 0; i < 4; i++)
+	if (needs_refresh(state_shadow::group_vertex_array))
+	{
+		gl.GetIntegerv(GL_VERTEX_ARRAY_BINDING, &_vao);
+		gl.GetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &_ibo);
+	}
+
+	if (needs_refresh(state_shadow::group_program))
+	{
+		gl.GetIntegerv(GL_CURRENT_PROGRAM, &_program);
+	}
+
+	if (needs_refresh(state_shadow::group_ubo_bindings))
 	{
-		gl.GetIntegeri_v(GL_UNIFORM_BUFFER_BINDING, i, &_ubo[i]);
+		// Save and restore individual UBO bindings (for compatibility with Yamagi Quake II)
+		for (GLuint i = 0; i < 4; i++)
+		{
+			gl.GetIntegeri_v(GL_UNIFORM_BUFFER_BINDING, i, &_ubo[i]);
 #ifndef _WIN64
-		gl.GetIntegeri_v(GL_UNIFORM_BUFFER_SIZE, i, reinterpret_cast<GLint *>(&_ubo_sizes[i]));
-		gl.GetIntegeri_v(GL_UNIFORM_BUFFER_START, i, reinterpret_cast<GLint *>(&_ubo_offsets[i]));
+			gl.GetIntegeri_v(GL_UNIFORM_BUFFER_SIZE, i, reinterpret_cast<GLint *>(&_ubo_sizes[i]));
+			gl.GetIntegeri_v(GL_UNIFORM_BUFFER_START, i, reinterpret_cast<GLint *>(&_ubo_offsets[i]));
 #else
-		gl.GetInteger64i_v(GL_UNIFORM_BUFFER_SIZE, i, &_ubo_sizes[i]);
-		gl.GetInteger64i_v(GL_UNIFORM_BUFFER_START, i, &_ubo_offsets[i]);
+			gl.GetInteger64i_v(GL_UNIFORM_BUFFER_SIZE, i, &_ubo_sizes[i]);
+			gl.GetInteger64i_v(GL_UNIFORM_BUFFER_START, i, &_ubo_offsets[i]);
 #endif
+		}
 	}
 
 	// Technically should capture image bindings here as well ...
-	gl.GetIntegerv(GL_ACTIVE_TEXTURE, &_active_texture);
+	if (shadow.active_texture_known)
+	{
+		_active_texture = shadow.active_texture;
+	}
+	else
+	{
+		gl.GetIntegerv(GL_ACTIVE_TEXTURE, &_active_texture);
+		shadow.active_texture = _active_texture;
+		shadow.active_texture_known = true;
+	}
 	for (GLuint i = 0; i < 32; i++)
 	{
-		gl.GetIntegeri_v(GL_SAMPLER_BINDING, i, &_samplers[i]);
-		gl.GetIntegeri_v(GL_TEXTURE_BINDING_2D, i, &_textures2d[i]);
+		if ((shadow.samplers_known & (1 << i)) != 0)
+		{
+			_samplers[i] = shadow.samplers[i];
+		}
+		else
+		{
+			gl.GetIntegeri_v(GL_SAMPLER_BINDING, i, &_samplers[i]);
+			shadow.samplers[i] = _samplers[i];
+			shadow.samplers_known |= 1 << i;
+		}
+
+		if ((shadow.textures_2d_known & (1 << i)) != 0)
+		{
+			_textures2d[i] = shadow.textures_2d[i];
+		}
+		else
+		{
+			gl.GetIntegeri_v(GL_TEXTURE_BINDING_2D, i, &_textures2d[i]);
+			shadow.textures_2d[i] = _textures2d[i];
+			shadow.textures_2d_known |= 1 << i;
+		}
 	}
 
-	gl.GetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &_read_fbo);
-	gl.GetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &_draw_fbo);
+	if (needs_refresh(state_shadow::group_framebuffer))
+	{
+		gl.GetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &_read_fbo);
+		gl.GetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &_draw_fbo);
 
-	gl.GetIntegerv(GL_VIEWPORT, _viewport);
+		gl.GetIntegerv(GL_READ_BUFFER, &_read_buffer);
+		for (GLuint i = 0; i < 8; i++)
+		{
+			gl.GetIntegerv(GL_DRAW_BUFFER0 + i, &_draw_buffers[i]);
+		}
+	}
 
-	gl.GetIntegerv(GL_READ_BUFFER, &_read_buffer);
-	for (GLuint i = 0; i < 8; i++)
+	if (needs_refresh(state_shadow::group_viewport))
 	{
-		gl.GetIntegerv(GL_DRAW_BUFFER0 + i, &_draw_buffers[i]);
+		gl.GetIntegerv(GL_VIEWPORT, _viewport);
 	}
 
-	_srgb_enable = gl.IsEnabled(GL_FRAMEBUFFER_SRGB);
+	if (needs_refresh(state_shadow::group_enables))
+	{
+		_srgb_enable = gl.IsEnabled(GL_FRAMEBUFFER_SRGB);
+
+		if (compatibility)
+			_alpha_test = gl.IsEnabled(0x0BC0 /* GL_ALPHA_TEST */);
+
+		_sample_alpha_to_coverage = gl.IsEnabled(GL_SAMPLE_ALPHA_TO_COVERAGE);
+		_blend_enable = gl.IsEnabled(GL_BLEND);
+		_logic_op_enable = gl.IsEnabled(GL_COLOR_LOGIC_OP);
+		_cull_enable = gl.IsEnabled(GL_CULL_FACE);
+		_depth_clamp = gl.IsEnabled(GL_DEPTH_CLAMP);
+		_scissor_test = gl.IsEnabled(GL_SCISSOR_TEST);
+		_multisample_enable = gl.IsEnabled(GL_MULTISAMPLE);
+		_line_smooth_enable = gl.IsEnabled(GL_LINE_SMOOTH);
+		_depth_test = gl.IsEnabled(GL_DEPTH_TEST);
+		_stencil_test = gl.IsEnabled(GL_STENCIL_TEST);
+	}
 
-	if (compatibility)
-		_alpha_test = gl.IsEnabled(0x0BC0 /* GL_ALPHA_TEST */);
-
-	_sample_alpha_to_coverage = gl.IsEnabled(GL_SAMPLE_ALPHA_TO_COVERAGE);
-	_blend_enable = gl.IsEnabled(GL_BLEND);
-	_logic_op_enable = gl.IsEnabled(GL_COLOR_LOGIC_OP);
-	gl.GetIntegerv(GL_BLEND_SRC_RGB, &_blend_src);
-	gl.GetIntegerv(GL_BLEND_DST_RGB, &_blend_dst);
-	gl.GetIntegerv(GL_BLEND_SRC_ALPHA, &_blend_src_alpha);
-	gl.GetIntegerv(GL_BLEND_DST_ALPHA, &_blend_dst_alpha);
-	gl.GetIntegerv(GL_BLEND_EQUATION_RGB, &_blend_eq);
-	gl.GetIntegerv(GL_BLEND_EQUATION_ALPHA, &_blend_eq_alpha);
-	gl.GetIntegerv(GL_LOGIC_OP_MODE, &_logic_op);
-	gl.GetFloatv(GL_BLEND_COLOR, _blend_constant);
-	gl.GetBooleanv(GL_COLOR_WRITEMASK, _color_write_mask);
-
-	gl.GetIntegerv(GL_POLYGON_MODE, &_polygon_mode);
-	_cull_enable = gl.IsEnabled(GL_CULL_FACE);
-	gl.GetIntegerv(GL_CULL_FACE_MODE, &_cull_mode);
-	gl.GetIntegerv(GL_FRONT_FACE, &_front_face);
-
-	_depth_clamp = gl.IsEnabled(GL_DEPTH_CLAMP);
-	_scissor_test = gl.IsEnabled(GL_SCISSOR_TEST);
-	gl.GetIntegerv(GL_SCISSOR_BOX, _scissor_rect);
-	_multisample_enable = gl.IsEnabled(GL_MULTISAMPLE);
-	_line_smooth_enable = gl.IsEnabled(GL_LINE_SMOOTH);
-
-	_depth_test = gl.IsEnabled(GL_DEPTH_TEST);
-	gl.GetBooleanv(GL_DEPTH_WRITEMASK, &_depth_mask);
-	gl.GetIntegerv(GL_DEPTH_FUNC, &_depth_func);
-	_stencil_test = gl.IsEnabled(GL_STENCIL_TEST);
-	gl.GetIntegerv(GL_STENCIL_FUNC, &_stencil_func);
-	gl.GetIntegerv(GL_STENCIL_VALUE_MASK, &_stencil_read_mask);
-	gl.GetIntegerv(GL_STENCIL_WRITEMASK, &_stencil_write_mask);
-	gl.GetIntegerv(GL_STENCIL_REF, &_stencil_reference_value);
-	gl.GetIntegerv(GL_STENCIL_FAIL, &_stencil_op_fail);
-	gl.GetIntegerv(GL_STENCIL_PASS_DEPTH_FAIL, &_stencil_op_depth_fail);
-	gl.GetIntegerv(GL_STENCIL_PASS_DEPTH_PASS, &_stencil_op_depth_pass);
+	if (needs_refresh(state_shadow::group_blend_state))
+	{
+		gl.GetIntegerv(GL_BLEND_SRC_RGB, &_blend_src);
+		gl.GetIntegerv(GL_BLEND_DST_RGB, &_blend_dst);
+		gl.GetIntegerv(GL_BLEND_SRC_ALPHA, &_blend_src_alpha);
+		gl.GetIntegerv(GL_BLEND_DST_ALPHA, &_blend_dst_alpha);
+		gl.GetIntegerv(GL_BLEND_EQUATION_RGB, &_blend_eq);
+		gl.GetIntegerv(GL_BLEND_EQUATION_ALPHA, &_blend_eq_alpha);
+		gl.GetIntegerv(GL_LOGIC_OP_MODE, &_logic_op);
+		gl.GetFloatv(GL_BLEND_COLOR, _blend_constant);
+		gl.GetBooleanv(GL_COLOR_WRITEMASK, _color_write_mask);
+	}
+
+	if (needs_refresh(state_shadow::group_rasterizer_state))
+	{
+		gl.GetIntegerv(GL_POLYGON_MODE, &_polygon_mode);
+		gl.GetIntegerv(GL_CULL_FACE_MODE, &_cull_mode);
+		gl.GetIntegerv(GL_FRONT_FACE, &_front_face);
+		gl.GetIntegerv(GL_SCISSOR_BOX, _scissor_rect);
+	}
 
+	if (needs_refresh(state_shadow::group_depth_stencil_state))
+	{
+		gl.GetBooleanv(GL_DEPTH_WRITEMASK, &_depth_mask);
+		gl.GetIntegerv(GL_DEPTH_FUNC, &_depth_func);
+		gl.GetIntegerv(GL_STENCIL_FUNC, &_stencil_func);
+		gl.GetIntegerv(GL_STENCIL_VALUE_MASK, &_stencil_read_mask);
+		gl.GetIntegerv(GL_STENCIL_WRITEMASK, &_stencil_write_mask);
+		gl.GetIntegerv(GL_STENCIL_REF, &_stencil_reference_value);
+		gl.GetIntegerv(GL_STENCIL_FAIL, &_stencil_op_fail);
+		gl.GetIntegerv(GL_STENCIL_PASS_DEPTH_FAIL, &_stencil_op_depth_fail);
+		gl.GetIntegerv(GL_STENCIL_PASS_DEPTH_PASS, &_stencil_op_depth_pass);
+	}
+
+	// Clip control has no hook updating the shadow, but is also only two queries
 	if (gl.ClipControl != nullptr)
 	{
 		gl.GetIntegerv(GL_CLIP_ORIGIN, &_clip_origin);
 		gl.GetIntegerv(GL_CLIP_DEPTH_MODE, &_clip_depthmode);
 	}
 }
-void reshade::opengl::state_block::apply(bool compatibility) const
+void reshade::opengl::state_block::apply(bool compatibility)
 {
 	gl.BindBuffer(GL_COPY_READ_BUFFER, _copy_read);
 	gl.BindBuffer(GL_COPY_WRITE_BUFFER, _copy_write);
@@ -195,4 +272,20 @@ void reshade::opengl::state_block::apply(bool compatibility) const
 	{
 		gl.ClipControl(_clip_origin, _clip_depthmode);
 	}
+
+#if RESHADE_ADDON
+	// The state applied above is the current context state now, so bring the shadow back in sync with this capture (the internal effect and overlay rendering modified context state without going through the hooks, which invalidates it for any other capture)
+	state_shadow &shadow = g_current_gl_state;
+	shadow.invalidate();
+
+	for (uint32_t changed_group = 0; changed_group < state_shadow::group_count; ++changed_group)
+		_synced_versions[changed_group] = shadow.modified[changed_group];
+
+	shadow.active_texture = _active_texture;
+	shadow.active_texture_known = true;
+	std::copy_n(_textures2d, 32, shadow.textures_2d);
+	std::copy_n(_samplers, 32, shadow.samplers);
+	shadow.textures_2d_known = 0xFFFFFFFF;
+	shadow.samplers_known = 0xFFFFFFFF;
+#endif
 }
@@ -6,16 +6,79 @@
 #pragma once
 
 #include <GL/gl3w.h>
+#include <cstdint>
 
 namespace reshade::opengl
 {
+	/// <summary>
+	/// Shadow of the current render context state, which is kept up to date by the hooks in opengl_hooks.cpp, so that <see cref="state_block::capture"/> can skip expensive 'glGet*' round-trips for state that was not modified since the last capture.
+	/// </summary>
+	struct state_shadow
+	{
+		enum group : uint32_t
+		{
+			group_buffer_bindings = 0,
+			group_vertex_array,
+			group_program,
+			group_ubo_bindings,
+			group_framebuffer,
+			group_viewport,
+			group_enables,
+			group_blend_state,
+			group_rasterizer_state,
+			group_depth_stencil_state,
+			group_count
+		};
+
+		// Marks the specified state group as modified, so that it is queried fresh on the next capture
+		void bump(group changed_group)
+		{
+			modified[changed_group]++;
+		}
+		// Marks all state as modified and all shadowed texture bindings as unknown (e.g. after the current render context changed or state was modified without going through the hooks)
+		void invalidate()
+		{
+			for (uint32_t &group_version : modified)
+				group_version++;
+
+			active_texture_known = false;
+			textures_2d_known = 0;
+			samplers_known = 0;
+		}
+
+		// Deleting a texture or sampler object unbinds it from all texture units of the current context, so update the shadowed bindings accordingly
+		void remove_texture_binding(GLuint texture)
+		{
+			for (GLuint unit = 0; unit < 32; ++unit)
+				if ((textures_2d_known & (1 << unit)) != 0 && static_cast<GLuint>(textures_2d[unit]) == texture)
+					textures_2d[unit] = 0;
+		}
+		void remove_sampler_binding(GLuint sampler)
+		{
+			for (GLuint unit = 0; unit < 32; ++unit)
+				if ((samplers_known & (1 << unit)) != 0 && static_cast<GLuint>(samplers[unit]) == sampler)
+					samplers[unit] = 0;
+		}
+
+		// Version numbers that are incremented whenever state belonging to the corresponding group is modified
+		uint32_t modified[group_count] = {};
+
+		// Shadow copy of the active texture unit and the per-unit 2D texture and sampler bindings (each with a mask of the texture units the shadowed value is known for)
+		bool active_texture_known = false;
+		GLint active_texture = GL_TEXTURE0;
+		uint32_t textures_2d_known = 0;
+		uint32_t samplers_known = 0;
+		GLint textures_2d[32] = {};
+		GLint samplers[32] = {};
+	};
+
 	class state_block
 	{
 	public:
 		state_block();
 
 		void capture(bool compatibility);
-		void apply(bool compatibility) const;
+		void apply(bool compatibility);
 
 	private:
 		GLint _copy_read = 0;
@@ -78,5 +141,12 @@ namespace reshade::opengl
 
 		GLint _clip_origin = GL_NONE;
 		GLint _clip_depthmode = GL_NONE;
+
+		// State group versions this capture is synchronized with (see 'state_shadow::modified')
+		bool _captured_once = false;
+		uint32_t _synced_versions[state_shadow::group_count] = {};
 	};
 }
+
+// The shadow tracks the state of the render context that is current on this thread (and is invalidated whenever a different context is made current)
+extern thread_local reshade::opengl::state_shadow g_current_gl_state;
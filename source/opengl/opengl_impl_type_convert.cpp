@@ -4,19 +4,162 @@
  */
 
 #include "opengl_impl_type_convert.hpp"
+#include <array> // std::array
 #include <cassert>
 
+// Since 'api::format' uses the DXGI format ordinals, which occupy a contiguous value range, the conversion to a GL internal format is a bounds check plus indexed load from a table built at compile time (the FourCC-based format values fall outside that range and keep using a switch in 'convert_format')
+static constexpr auto s_format_to_internal_format_lookup = []() {
+	using reshade::api::format;
+	std::array<GLenum, static_cast<uint32_t>(format::b4g4r4a4_unorm) + 1> lookup = {}; // Formats not assigned below translate to 'GL_NONE'
+	lookup[static_cast<uint32_t>(format::r8_uint)] = GL_R8UI;
+	lookup[static_cast<uint32_t>(format::r8_sint)] = GL_R8I;
+	lookup[static_cast<uint32_t>(format::r8_typeless)] = GL_R8;
+	lookup[static_cast<uint32_t>(format::r8_unorm)] = GL_R8;
+	lookup[static_cast<uint32_t>(format::r8_snorm)] = GL_R8_SNORM;
+	lookup[static_cast<uint32_t>(format::r8g8_uint)] = GL_RG8UI;
+	lookup[static_cast<uint32_t>(format::r8g8_sint)] = GL_RG8I;
+	lookup[static_cast<uint32_t>(format::r8g8_typeless)] = GL_RG8;
+	lookup[static_cast<uint32_t>(format::r8g8_unorm)] = GL_RG8;
+	lookup[static_cast<uint32_t>(format::r8g8_snorm)] = GL_RG8_SNORM;
+	lookup[static_cast<uint32_t>(format::r8g8b8a8_uint)] = GL_RGBA8UI;
+	lookup[static_cast<uint32_t>(format::r8g8b8a8_sint)] = GL_RGBA8I;
+	lookup[static_cast<uint32_t>(format::r8g8b8a8_typeless)] = GL_RGBA8;
+	lookup[static_cast<uint32_t>(format::r8g8b8a8_unorm)] = GL_RGBA8;
+	lookup[static_cast<uint32_t>(format::b8g8r8a8_typeless)] = GL_RGBA8;
+	lookup[static_cast<uint32_t>(format::b8g8r8a8_unorm)] = GL_RGBA8;
+	lookup[static_cast<uint32_t>(format::r8g8b8a8_unorm_srgb)] = GL_SRGB8_ALPHA8;
+	lookup[static_cast<uint32_t>(format::b8g8r8a8_unorm_srgb)] = GL_SRGB8_ALPHA8;
+	lookup[static_cast<uint32_t>(format::r8g8b8a8_snorm)] = GL_RGBA8_SNORM;
+	lookup[static_cast<uint32_t>(format::b8g8r8x8_typeless)] = GL_RGB8;
+	lookup[static_cast<uint32_t>(format::b8g8r8x8_unorm)] = GL_RGB8;
+	lookup[static_cast<uint32_t>(format::b8g8r8x8_unorm_srgb)] = GL_SRGB8;
+	lookup[static_cast<uint32_t>(format::r10g10b10a2_uint)] = GL_RGB10_A2UI;
+	lookup[static_cast<uint32_t>(format::r10g10b10a2_typeless)] = GL_RGB10_A2;
+	lookup[static_cast<uint32_t>(format::r10g10b10a2_unorm)] = GL_RGB10_A2;
+	lookup[static_cast<uint32_t>(format::r16_uint)] = GL_R16UI;
+	lookup[static_cast<uint32_t>(format::r16_sint)] = GL_R16I;
+	lookup[static_cast<uint32_t>(format::r16_unorm)] = GL_R16;
+	lookup[static_cast<uint32_t>(format::r16_snorm)] = GL_R16_SNORM;
+	lookup[static_cast<uint32_t>(format::r16_typeless)] = GL_R16F;
+	lookup[static_cast<uint32_t>(format::r16_float)] = GL_R16F;
+	lookup[static_cast<uint32_t>(format::r16g16_uint)] = GL_RG16UI;
+	lookup[static_cast<uint32_t>(format::r16g16_sint)] = GL_RG16I;
+	lookup[static_cast<uint32_t>(format::r16g16_unorm)] = GL_RG16;
+	lookup[static_cast<uint32_t>(format::r16g16_snorm)] = GL_RG16_SNORM;
+	lookup[static_cast<uint32_t>(format::r16g16_typeless)] = GL_RG16F;
+	lookup[static_cast<uint32_t>(format::r16g16_float)] = GL_RG16F;
+	lookup[static_cast<uint32_t>(format::r16g16b16a16_uint)] = GL_RGBA16UI;
+	lookup[static_cast<uint32_t>(format::r16g16b16a16_sint)] = GL_RGBA16I;
+	lookup[static_cast<uint32_t>(format::r16g16b16a16_unorm)] = GL_RGBA16;
+	lookup[static_cast<uint32_t>(format::r16g16b16a16_snorm)] = GL_RGBA16_SNORM;
+	lookup[static_cast<uint32_t>(format::r16g16b16a16_typeless)] = GL_RGBA16F;
+	lookup[static_cast<uint32_t>(format::r16g16b16a16_float)] = GL_RGBA16F;
+	lookup[static_cast<uint32_t>(format::r32_uint)] = GL_R32UI;
+	lookup[static_cast<uint32_t>(format::r32_sint)] = GL_R32I;
+	lookup[static_cast<uint32_t>(format::r32_typeless)] = GL_R32F;
+	lookup[static_cast<uint32_t>(format::r32_float)] = GL_R32F;
+	lookup[static_cast<uint32_t>(format::r32g32_uint)] = GL_RG32UI;
+	lookup[static_cast<uint32_t>(format::r32g32_sint)] = GL_RG32I;
+	lookup[static_cast<uint32_t>(format::r32g32_typeless)] = GL_RG32F;
+	lookup[static_cast<uint32_t>(format::r32g32_float)] = GL_RG32F;
+	lookup[static_cast<uint32_t>(format::r32g32b32_uint)] = GL_RGB32UI;
+	lookup[static_cast<uint32_t>(format::r32g32b32_sint)] = GL_RGB32I;
+	lookup[static_cast<uint32_t>(format::r32g32b32_typeless)] = GL_RGB32F;
+	lookup[static_cast<uint32_t>(format::r32g32b32_float)] = GL_RGB32F;
+	lookup[static_cast<uint32_t>(format::r32g32b32a32_uint)] = GL_RGBA32UI;
+	lookup[static_cast<uint32_t>(format::r32g32b32a32_sint)] = GL_RGBA32I;
+	lookup[static_cast<uint32_t>(format::r32g32b32a32_typeless)] = GL_RGBA32F;
+	lookup[static_cast<uint32_t>(format::r32g32b32a32_float)] = GL_RGBA32F;
+	lookup[static_cast<uint32_t>(format::r9g9b9e5)] = GL_RGB9_E5;
+	lookup[static_cast<uint32_t>(format::r11g11b10_float)] = GL_R11F_G11F_B10F;
+	lookup[static_cast<uint32_t>(format::b5g6r5_unorm)] = GL_RGB565;
+	lookup[static_cast<uint32_t>(format::b5g5r5a1_unorm)] = GL_RGB5_A1;
+	lookup[static_cast<uint32_t>(format::b4g4r4a4_unorm)] = GL_RGBA4;
+	lookup[static_cast<uint32_t>(format::d16_unorm)] = GL_DEPTH_COMPONENT16;
+	lookup[static_cast<uint32_t>(format::r24_g8_typeless)] = GL_DEPTH24_STENCIL8;
+	lookup[static_cast<uint32_t>(format::r24_unorm_x8_uint)] = GL_DEPTH24_STENCIL8;
+	lookup[static_cast<uint32_t>(format::x24_unorm_g8_uint)] = GL_DEPTH24_STENCIL8;
+	lookup[static_cast<uint32_t>(format::d24_unorm_s8_uint)] = GL_DEPTH24_STENCIL8;
+	lookup[static_cast<uint32_t>(format::d32_float)] = GL_DEPTH_COMPONENT32F;
+	lookup[static_cast<uint32_t>(format::r32_g8_typeless)] = GL_DEPTH32F_STENCIL8;
+	lookup[static_cast<uint32_t>(format::r32_float_x8_uint)] = GL_DEPTH32F_STENCIL8;
+	lookup[static_cast<uint32_t>(format::x32_float_g8_uint)] = GL_DEPTH32F_STENCIL8;
+	lookup[static_cast<uint32_t>(format::d32_float_s8_uint)] = GL_DEPTH32F_STENCIL8;
+	lookup[static_cast<uint32_t>(format::bc1_typeless)] = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	lookup[static_cast<uint32_t>(format::bc1_unorm)] = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	lookup[static_cast<uint32_t>(format::bc1_unorm_srgb)] = 0x8C4D /* GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT */;
+	lookup[static_cast<uint32_t>(format::bc2_typeless)] = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+	lookup[static_cast<uint32_t>(format::bc2_unorm)] = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+	lookup[static_cast<uint32_t>(format::bc2_unorm_srgb)] = 0x8C4E /* GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT */;
+	lookup[static_cast<uint32_t>(format::bc3_typeless)] = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	lookup[static_cast<uint32_t>(format::bc3_unorm)] = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	lookup[static_cast<uint32_t>(format::bc3_unorm_srgb)] = 0x8C4F /* GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT */;
+	lookup[static_cast<uint32_t>(format::bc4_typeless)] = GL_COMPRESSED_RED_RGTC1;
+	lookup[static_cast<uint32_t>(format::bc4_unorm)] = GL_COMPRESSED_RED_RGTC1;
+	lookup[static_cast<uint32_t>(format::bc4_snorm)] = GL_COMPRESSED_SIGNED_RED_RGTC1;
+	lookup[static_cast<uint32_t>(format::bc5_typeless)] = GL_COMPRESSED_RG_RGTC2;
+	lookup[static_cast<uint32_t>(format::bc5_unorm)] = GL_COMPRESSED_RG_RGTC2;
+	lookup[static_cast<uint32_t>(format::bc5_snorm)] = GL_COMPRESSED_SIGNED_RG_RGTC2;
+	lookup[static_cast<uint32_t>(format::bc6h_typeless)] = GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB;
+	lookup[static_cast<uint32_t>(format::bc6h_ufloat)] = GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB;
+	lookup[static_cast<uint32_t>(format::bc6h_sfloat)] = GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB;
+	lookup[static_cast<uint32_t>(format::bc7_typeless)] = GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+	lookup[static_cast<uint32_t>(format::bc7_unorm)] = GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+	lookup[static_cast<uint32_t>(format::bc7_unorm_srgb)] = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB;
+	return lookup;
+}();
+// The sized internal format enumerants between 'GL_ALPHA8_EXT' and 'GL_RG32UI' form a dense cluster too, which covers the formats most commonly seen during texture streaming, so convert those with a table as well (the remaining internal formats are spread over many small disjoint enum ranges and stay in the switch in 'convert_format')
+static constexpr GLenum s_internal_format_to_format_lookup_base = GL_ALPHA8_EXT;
+static constexpr auto s_internal_format_to_format_lookup = []() {
+	using reshade::api::format;
+	std::array<format, (GL_RG32UI - GL_ALPHA8_EXT) + 1> lookup = {}; // Internal formats not assigned below translate to 'api::format::unknown'
+	const auto entry = [&lookup](GLenum internal_format) -> format & {
+		return lookup[internal_format - GL_ALPHA8_EXT];
+	};
+	entry(GL_ALPHA8_EXT) = format::a8_unorm;
+	entry(GL_LUMINANCE8_EXT) = format::l8_unorm; // { R, R, R, 1 }
+	entry(0x804B /* GL_INTENSITY8 */) = format::l8_unorm; // { R, R, R, R }
+	entry(0x8042 /* GL_LUMINANCE16 */) = format::l16_unorm; // { R, R, R, 1 }
+	entry(0x804D /* GL_INTENSITY16 */) = format::l16_unorm; // { R, R, R, R }
+	entry(GL_LUMINANCE8_ALPHA8_EXT) = format::l8a8_unorm; // { R, R, R, G }
+	entry(0x8048 /* GL_LUMINANCE16_ALPHA16 */) = format::l16a16_unorm; // { R, R, R, G }
+	entry(GL_R8UI) = format::r8_uint;
+	entry(GL_R8I) = format::r8_sint;
+	entry(GL_R8) = format::r8_unorm;
+	entry(GL_RG8UI) = format::r8g8_uint;
+	entry(GL_RG8I) = format::r8g8_sint;
+	entry(GL_RG8) = format::r8g8_unorm;
+	entry(GL_RGBA8) = format::r8g8b8a8_unorm;
+	entry(GL_RGB8) = format::r8g8b8x8_unorm;
+	entry(GL_RGB10_A2) = format::r10g10b10a2_unorm;
+	entry(GL_R16UI) = format::r16_uint;
+	entry(GL_R16I) = format::r16_sint;
+	entry(GL_R16) = format::r16_unorm;
+	entry(GL_R16F) = format::r16_float;
+	entry(GL_RG16UI) = format::r16g16_uint;
+	entry(GL_RG16I) = format::r16g16_sint;
+	entry(GL_RG16) = format::r16g16_unorm;
+	entry(GL_RG16F) = format::r16g16_float;
+	entry(GL_RGBA16) = format::r16g16b16a16_unorm;
+	entry(GL_R32UI) = format::r32_uint;
+	entry(GL_R32I) = format::r32_sint;
+	entry(GL_R32F) = format::r32_float;
+	entry(GL_RG32UI) = format::r32g32_uint;
+	entry(GL_RG32I) = format::r32g32_sint;
+	entry(GL_RG32F) = format::r32g32_float;
+	entry(GL_RGB5_A1) = format::b5g5r5a1_unorm;
+	entry(GL_RGB5) = format::b5g5r5x1_unorm;
+	entry(GL_RGBA4) = format::b4g4r4a4_unorm;
+	entry(GL_DEPTH_COMPONENT16) = format::d16_unorm;
+	entry(GL_DEPTH_COMPONENT24) = format::d24_unorm_x8_uint;
+	return lookup;
+}();
+
 auto reshade::opengl::convert_format(api::format format, GLint swizzle_mask[4]) -> GLenum
 {
+	// Handle formats that are emulated with a texture swizzle first, since they write to the swizzle mask in addition to returning an internal format
 	switch (format)
 	{
-	default:
-		assert(false);
-		[[fallthrough]];
-	case api::format::unknown:
-		break;
-	case api::format::r1_unorm:
-		break; // Unsupported
 	case api::format::l8_unorm:
 		if (swizzle_mask != nullptr)
 		{
@@ -37,15 +180,6 @@ auto reshade::opengl::convert_format(api::format format, GLint swizzle_mask[4])
 			return GL_R8;
 		}
 		return GL_ALPHA8_EXT;
-	case api::format::r8_uint:
-		return GL_R8UI;
-	case api::format::r8_sint:
-		return GL_R8I;
-	case api::format::r8_typeless:
-	case api::format::r8_unorm:
-		return GL_R8;
-	case api::format::r8_snorm:
-		return GL_R8_SNORM;
 	case api::format::l8a8_unorm:
 		if (swizzle_mask != nullptr)
 		{
@@ -56,56 +190,6 @@ auto reshade::opengl::convert_format(api::format format, GLint swizzle_mask[4])
 			return GL_RG8;
 		}
 		return GL_LUMINANCE8_ALPHA8_EXT;
-	case api::format::r8g8_uint:
-		return GL_RG8UI;
-	case api::format::r8g8_sint:
-		return GL_RG8I;
-	case api::format::r8g8_typeless:
-	case api::format::r8g8_unorm:
-		return GL_RG8;
-	case api::format::r8g8_snorm:
-		return GL_RG8_SNORM;
-	case api::format::r8g8b8a8_uint:
-		return GL_RGBA8UI;
-	case api::format::r8g8b8a8_sint:
-		return GL_RGBA8I;
-	case api::format::r8g8b8a8_typeless:
-	case api::format::r8g8b8a8_unorm:
-	case api::format::b8g8r8a8_typeless:
-	case api::format::b8g8r8a8_unorm:
-		return GL_RGBA8;
-	case api::format::r8g8b8a8_unorm_srgb:
-	case api::format::b8g8r8a8_unorm_srgb:
-		return GL_SRGB8_ALPHA8;
-	case api::format::r8g8b8a8_snorm:
-		return GL_RGBA8_SNORM;
-#if 0
-	case api::format::r8g8b8x8_uint:
-		return GL_RGB8UI;
-	case api::format::r8g8b8x8_sint:
-		return GL_RGB8I;
-#endif
-	case api::format::r8g8b8x8_unorm:
-	case api::format::b8g8r8x8_typeless:
-	case api::format::b8g8r8x8_unorm:
-		return GL_RGB8;
-	case api::format::r8g8b8x8_unorm_srgb:
-	case api::format::b8g8r8x8_unorm_srgb:
-		return GL_SRGB8;
-#if 0
-	case api::format::r8g8b8x8_snorm:
-		return GL_RGB8_SNORM;
-#endif
-	case api::format::r10g10b10a2_uint:
-	case api::format::b10g10r10a2_uint:
-		return GL_RGB10_A2UI;
-	case api::format::r10g10b10a2_typeless:
-	case api::format::r10g10b10a2_unorm:
-	case api::format::b10g10r10a2_typeless:
-	case api::format::b10g10r10a2_unorm:
-		return GL_RGB10_A2;
-	case api::format::r10g10b10a2_xr_bias:
-		break; // Unsupported
 	case api::format::l16_unorm:
 		if (swizzle_mask != nullptr)
 		{
@@ -116,23 +200,6 @@ auto reshade::opengl::convert_format(api::format format, GLint swizzle_mask[4])
 			return GL_R16;
 		}
 		return 0x8042 /* GL_LUMINANCE16 */;
-#if 0
-	case api::format::l16_float:
-		return GL_LUMINANCE16F_EXT;
-	case api::format::a16_float:
-		return GL_ALPHA16F_EXT;
-#endif
-	case api::format::r16_uint:
-		return GL_R16UI;
-	case api::format::r16_sint:
-		return GL_R16I;
-	case api::format::r16_unorm:
-		return GL_R16;
-	case api::format::r16_snorm:
-		return GL_R16_SNORM;
-	case api::format::r16_typeless:
-	case api::format::r16_float:
-		return GL_R16F;
 	case api::format::l16a16_unorm:
 		if (swizzle_mask != nullptr)
 		{
@@ -143,144 +210,40 @@ auto reshade::opengl::convert_format(api::format format, GLint swizzle_mask[4])
 			return GL_RG16;
 		}
 		return 0x8048 /* GL_LUMINANCE16_ALPHA16 */;
-#if 0
-	case api::format::l16a16_float:
-		return GL_LUMINANCE_ALPHA16F_EXT;
-#endif
-	case api::format::r16g16_uint:
-		return GL_RG16UI;
-	case api::format::r16g16_sint:
-		return GL_RG16I;
-	case api::format::r16g16_unorm:
-		return GL_RG16;
-	case api::format::r16g16_snorm:
-		return GL_RG16_SNORM;
-	case api::format::r16g16_typeless:
-	case api::format::r16g16_float:
-		return GL_RG16F;
-	case api::format::r16g16b16a16_uint:
-		return GL_RGBA16UI;
-	case api::format::r16g16b16a16_sint:
-		return GL_RGBA16I;
-	case api::format::r16g16b16a16_unorm:
-		return GL_RGBA16;
-	case api::format::r16g16b16a16_snorm:
-		return GL_RGBA16_SNORM;
-	case api::format::r16g16b16a16_typeless:
-	case api::format::r16g16b16a16_float:
-		return GL_RGBA16F;
-#if 0
-	case api::format::l32_float:
-		return GL_LUMINANCE32F_EXT;
-	case api::format::a32_float:
-		return GL_ALPHA32F_EXT;
-#endif
-	case api::format::r32_uint:
-		return GL_R32UI;
-	case api::format::r32_sint:
-		return GL_R32I;
-	case api::format::r32_typeless:
-	case api::format::r32_float:
-		return GL_R32F;
-#if 0
-	case api::format::l32a32_float:
-		return GL_LUMINANCE_ALPHA32F_EXT;
-#endif
-	case api::format::r32g32_uint:
-		return GL_RG32UI;
-	case api::format::r32g32_sint:
-		return GL_RG32I;
-	case api::format::r32g32_typeless:
-	case api::format::r32g32_float:
-		return GL_RG32F;
-	case api::format::r32g32b32_uint:
-		return GL_RGB32UI;
-	case api::format::r32g32b32_sint:
-		return GL_RGB32I;
-	case api::format::r32g32b32_typeless:
-	case api::format::r32g32b32_float:
-		return GL_RGB32F;
-	case api::format::r32g32b32a32_uint:
-		return GL_RGBA32UI;
-	case api::format::r32g32b32a32_sint:
-		return GL_RGBA32I;
-	case api::format::r32g32b32a32_typeless:
-	case api::format::r32g32b32a32_float:
-		return GL_RGBA32F;
-	case api::format::r9g9b9e5:
-		return GL_RGB9_E5;
-	case api::format::r11g11b10_float:
-		return GL_R11F_G11F_B10F;
-	case api::format::b5g6r5_unorm:
-		return GL_RGB565;
-	case api::format::b5g5r5a1_unorm:
-		return GL_RGB5_A1;
+	default:
+		break;
+	}
+
+	if (const uint32_t format_index = static_cast<uint32_t>(format);
+		format_index < s_format_to_internal_format_lookup.size())
+		return s_format_to_internal_format_lookup[format_index];
+
+	// Only the FourCC-based format values are left at this point
+	switch (format)
+	{
+	case api::format::r8g8b8x8_unorm:
+		return GL_RGB8;
+	case api::format::r8g8b8x8_unorm_srgb:
+		return GL_SRGB8;
+	case api::format::b10g10r10a2_uint:
+		return GL_RGB10_A2UI;
+	case api::format::b10g10r10a2_typeless:
+	case api::format::b10g10r10a2_unorm:
+		return GL_RGB10_A2;
 	case api::format::b5g5r5x1_unorm:
 		return GL_RGB5;
-	case api::format::b4g4r4a4_unorm:
 	case api::format::a4b4g4r4_unorm:
 		return GL_RGBA4;
 	case api::format::s8_uint:
 		return GL_STENCIL_INDEX8;
-	case api::format::d16_unorm:
-		return GL_DEPTH_COMPONENT16;
 	case api::format::d16_unorm_s8_uint:
-		break; // Unsupported
+		return GL_NONE; // Unsupported
 	case api::format::d24_unorm_x8_uint:
 		return GL_DEPTH_COMPONENT24;
-	case api::format::r24_g8_typeless:
-	case api::format::r24_unorm_x8_uint:
-	case api::format::x24_unorm_g8_uint:
-	case api::format::d24_unorm_s8_uint:
-		return GL_DEPTH24_STENCIL8;
-	case api::format::d32_float:
-		return GL_DEPTH_COMPONENT32F;
-	case api::format::r32_g8_typeless:
-	case api::format::r32_float_x8_uint:
-	case api::format::x32_float_g8_uint:
-	case api::format::d32_float_s8_uint:
-		return GL_DEPTH32F_STENCIL8;
-	case api::format::bc1_typeless:
-	case api::format::bc1_unorm:
-		return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
-	case api::format::bc1_unorm_srgb:
-		return 0x8C4D /* GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT */;
-	case api::format::bc2_typeless:
-	case api::format::bc2_unorm:
-		return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
-	case api::format::bc2_unorm_srgb:
-		return 0x8C4E /* GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT */;
-	case api::format::bc3_typeless:
-	case api::format::bc3_unorm:
-		return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
-	case api::format::bc3_unorm_srgb:
-		return 0x8C4F /* GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT */;
-	case api::format::bc4_typeless:
-	case api::format::bc4_unorm:
-		return GL_COMPRESSED_RED_RGTC1;
-	case api::format::bc4_snorm:
-		return GL_COMPRESSED_SIGNED_RED_RGTC1;
-	case api::format::bc5_typeless:
-	case api::format::bc5_unorm:
-		return GL_COMPRESSED_RG_RGTC2;
-	case api::format::bc5_snorm:
-		return GL_COMPRESSED_SIGNED_RG_RGTC2;
-	case api::format::bc6h_typeless:
-	case api::format::bc6h_ufloat:
-		return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB;
-	case api::format::bc6h_sfloat:
-		return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB;
-	case api::format::bc7_typeless:
-	case api::format::bc7_unorm:
-		return GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
-	case api::format::bc7_unorm_srgb:
-		return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB;
-	case api::format::r8g8_b8g8_unorm:
-	case api::format::g8r8_g8b8_unorm:
-		break; // Unsupported
+	default:
+		assert(false);
+		return GL_NONE;
 	}
-
-	return GL_NONE;
 }
 auto reshade::opengl::convert_format(GLenum internal_format, const GLint swizzle_mask[4]) -> api::format
 {
@@ -301,158 +264,85 @@ auto reshade::opengl::convert_format(GLenum internal_format, const GLint swizzle
 		internal_format != GL_DEPTH_COMPONENT &&
 		internal_format != GL_DEPTH_STENCIL);
 
+	if (swizzle_mask != nullptr)
+	{
+		// Check the texture swizzles that are used to emulate the luminance and alpha formats OpenGL has no sized equivalent for
+		switch (internal_format)
+		{
+		case GL_R8: // { R, 0, 0, 1 }
+			if (swizzle_mask[0] == GL_RED &&
+				swizzle_mask[1] == GL_RED &&
+				swizzle_mask[2] == GL_RED)
+				return api::format::l8_unorm;
+			if (swizzle_mask[0] == GL_ZERO &&
+				swizzle_mask[1] == GL_ZERO &&
+				swizzle_mask[2] == GL_ZERO &&
+				swizzle_mask[3] == GL_RED)
+				return api::format::a8_unorm;
+			break;
+		case GL_RG8: // { R, G, 0, 1 }
+			if (swizzle_mask[0] == GL_RED &&
+				swizzle_mask[1] == GL_RED &&
+				swizzle_mask[2] == GL_RED &&
+				swizzle_mask[3] == GL_GREEN)
+				return api::format::l8a8_unorm;
+			break;
+		case GL_R16: // { R, 0, 0, 1 }
+			if (swizzle_mask[0] == GL_RED &&
+				swizzle_mask[1] == GL_RED &&
+				swizzle_mask[2] == GL_RED)
+				return api::format::l16_unorm;
+			break;
+		case GL_RG16: // { R, G, 0, 1 }
+			if (swizzle_mask[0] == GL_RED &&
+				swizzle_mask[1] == GL_RED &&
+				swizzle_mask[2] == GL_RED &&
+				swizzle_mask[3] == GL_GREEN)
+				return api::format::l16a16_unorm;
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (internal_format >= s_internal_format_to_format_lookup_base &&
+		internal_format <  s_internal_format_to_format_lookup_base + s_internal_format_to_format_lookup.size())
+		return s_internal_format_to_format_lookup[internal_format - s_internal_format_to_format_lookup_base];
+
 	switch (internal_format)
 	{
 	default:
 		return api::format::unknown;
-	case GL_LUMINANCE8_EXT: // { R, R, R, 1 }
-	case 0x804B /* GL_INTENSITY8 */: // { R, R, R, R }
-		return api::format::l8_unorm;
-	case GL_ALPHA8_EXT:
-		return api::format::a8_unorm;
-	case GL_R8UI:
-		return api::format::r8_uint;
-	case GL_R8I:
-		return api::format::r8_sint;
-	case GL_R8: // { R, 0, 0, 1 }
-		if (swizzle_mask != nullptr &&
-			swizzle_mask[0] == GL_RED &&
-			swizzle_mask[1] == GL_RED &&
-			swizzle_mask[2] == GL_RED)
-			return api::format::l8_unorm;
-		if (swizzle_mask != nullptr &&
-			swizzle_mask[0] == GL_ZERO &&
-			swizzle_mask[1] == GL_ZERO &&
-			swizzle_mask[2] == GL_ZERO &&
-			swizzle_mask[3] == GL_RED)
-			return api::format::a8_unorm;
-		return api::format::r8_unorm;
 	case GL_R8_SNORM:
 		return api::format::r8_snorm;
-	case GL_LUMINANCE8_ALPHA8_EXT: // { R, R, R, G }
-		return api::format::l8a8_unorm;
-	case GL_RG8UI:
-		return api::format::r8g8_uint;
-	case GL_RG8I:
-		return api::format::r8g8_sint;
-	case GL_RG8: // { R, G, 0, 1 }
-		if (swizzle_mask != nullptr &&
-			swizzle_mask[0] == GL_RED &&
-			swizzle_mask[1] == GL_RED &&
-			swizzle_mask[2] == GL_RED &&
-			swizzle_mask[3] == GL_GREEN)
-			return api::format::l8a8_unorm;
-		return api::format::r8g8_unorm;
 	case GL_RG8_SNORM:
 		return api::format::r8g8_snorm;
 	case GL_RGBA8UI:
 		return api::format::r8g8b8a8_uint;
 	case GL_RGBA8I:
 		return api::format::r8g8b8a8_sint;
-	case GL_RGBA8:
-		return api::format::r8g8b8a8_unorm;
 	case GL_SRGB8_ALPHA8:
 		return api::format::r8g8b8a8_unorm_srgb;
 	case GL_RGBA8_SNORM:
 		return api::format::r8g8b8a8_snorm;
-#if 0
-	case GL_RGB8UI:
-		return api::format::r8g8b8x8_uint;
-	case GL_RGB8I:
-		return api::format::r8g8b8x8_sint;
-#endif
-	case GL_RGB8:
-		return api::format::r8g8b8x8_unorm;
 	case GL_SRGB8:
 		return api::format::r8g8b8x8_unorm_srgb;
-#if 0
-	case GL_RGB8_SNORM:
-		return api::format::r8g8b8x8_snorm;
-#endif
 	case GL_BGRA8_EXT:
 		return api::format::b8g8r8a8_unorm;
 	case GL_RGB10_A2UI:
 		return api::format::r10g10b10a2_uint;
-	case GL_RGB10_A2:
-		return api::format::r10g10b10a2_unorm;
-	case 0x8042 /* GL_LUMINANCE16 */: // { R, R, R, 1 }
-	case 0x804D /* GL_INTENSITY16 */: // { R, R, R, R }
-		return api::format::l16_unorm;
-#if 0
-	case GL_LUMINANCE16F_EXT:
-		return api::format::l16_float;
-	case GL_ALPHA16F_EXT:
-		return api::format::a16_float;
-#endif
-	case GL_R16UI:
-		return api::format::r16_uint;
-	case GL_R16I:
-		return api::format::r16_sint;
-	case GL_R16: // { R, 0, 0, 1 }
-		if (swizzle_mask != nullptr &&
-			swizzle_mask[0] == GL_RED &&
-			swizzle_mask[1] == GL_RED &&
-			swizzle_mask[2] == GL_RED)
-			return api::format::l16_unorm;
-		return api::format::r16_unorm;
 	case GL_R16_SNORM:
 		return api::format::r16_snorm;
-	case GL_R16F:
-		return api::format::r16_float;
-	case 0x8048 /* GL_LUMINANCE16_ALPHA16 */: // { R, R, R, G }
-		return api::format::l16a16_unorm;
-#if 0
-	case GL_LUMINANCE_ALPHA16F_EXT:
-		return api::format::l16a16_float;
-#endif
-	case GL_RG16UI:
-		return api::format::r16g16_uint;
-	case GL_RG16I:
-		return api::format::r16g16_sint;
-	case GL_RG16: // { R, G, 0, 1 }
-		if (swizzle_mask != nullptr &&
-			swizzle_mask[0] == GL_RED &&
-			swizzle_mask[1] == GL_RED &&
-			swizzle_mask[2] == GL_RED &&
-			swizzle_mask[3] == GL_GREEN)
-			return api::format::l16a16_unorm;
-		return api::format::r16g16_unorm;
 	case GL_RG16_SNORM:
 		return api::format::r16g16_snorm;
-	case GL_RG16F:
-		return api::format::r16g16_float;
 	case GL_RGBA16UI:
 		return api::format::r16g16b16a16_uint;
 	case GL_RGBA16I:
 		return api::format::r16g16b16a16_sint;
-	case GL_RGBA16:
-		return api::format::r16g16b16a16_unorm;
 	case GL_RGBA16_SNORM:
 		return api::format::r16g16b16a16_snorm;
 	case GL_RGBA16F:
 		return api::format::r16g16b16a16_float;
-#if 0
-	case GL_LUMINANCE32F_EXT:
-		return api::format::l32_float;
-	case GL_ALPHA32F_EXT:
-		return api::format::a32_float;
-#endif
-	case GL_R32UI:
-		return api::format::r32_uint;
-	case GL_R32I:
-		return api::format::r32_sint;
-	case GL_R32F:
-		return api::format::r32_float;
-#if 0
-	case GL_LUMINANCE_ALPHA32F_EXT:
-		return api::format::l32a32_float;
-#endif
-	case GL_RG32UI:
-		return api::format::r32g32_uint;
-	case GL_RG32I:
-		return api::format::r32g32_sint;
-	case GL_RG32F:
-		return api::format::r32g32_float;
 	case GL_RGB32UI:
 		return api::format::r32g32b32_uint;
 	case GL_RGB32I:
@@ -471,18 +361,8 @@ auto reshade::opengl::convert_format(GLenum internal_format, const GLint swizzle
 		return api::format::r11g11b10_float;
 	case GL_RGB565:
 		return api::format::b5g6r5_unorm;
-	case GL_RGB5_A1:
-		return api::format::b5g5r5a1_unorm;
-	case GL_RGB5:
-		return api::format::b5g5r5x1_unorm;
-	case GL_RGBA4:
-		return api::format::b4g4r4a4_unorm;
 	case GL_STENCIL_INDEX8:
 		return api::format::s8_uint;
-	case GL_DEPTH_COMPONENT16:
-		return api::format::d16_unorm;
-	case GL_DEPTH_COMPONENT24:
-		return api::format::d24_unorm_x8_uint;
 	case GL_DEPTH24_STENCIL8:
 		return api::format::d24_unorm_s8_uint;
 	case GL_DEPTH_COMPONENT32F:
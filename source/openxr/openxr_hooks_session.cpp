@@ -314,6 +314,9 @@ XrResult XRAPI_CALL xrEndFrame(XrSession session, const XrFrameEndInfo *frameEnd
 
 				assert(layer->viewCount != 0);
 
+				// Keep track of whether all views are submitted from the same swapchain, in which case effects may be applied to its images in place (see 'swapchain_impl::on_present')
+				XrSwapchain view_swapchain = XR_NULL_HANDLE;
+
 				for (; view_count < layer->viewCount; ++view_count)
 				{
 					XrSwapchainSubImage const &sub_image = layer->views[view_count].subImage;
@@ -323,6 +326,11 @@ XrResult XRAPI_CALL xrEndFrame(XrSession session, const XrFrameEndInfo *frameEnd
 					if ((swapchain_data.create_flags & XR_SWAPCHAIN_CREATE_STATIC_IMAGE_BIT) != 0)
 						break; // Cannot apply effects to a static image, since it would just stack on top of the previous result every frame
 
+					if (view_count == 0)
+						view_swapchain = sub_image.swapchain;
+					else if (sub_image.swapchain != view_swapchain)
+						view_swapchain = XR_NULL_HANDLE;
+
 					view_textures[view_count] = swapchain_data.surface_images[swapchain_data.last_released_index];
 
 					reshade::api::subresource_box &view_box = view_boxes[view_count];
@@ -338,7 +346,12 @@ XrResult XRAPI_CALL xrEndFrame(XrSession session, const XrFrameEndInfo *frameEnd
 
 				if (view_count == layer->viewCount)
 				{
-					data.swapchain_impl->on_present(view_count, view_textures.p, view_boxes.p, view_layers.p);
+					static const std::vector<reshade::api::resource> s_no_swapchain_images;
+					const openxr_swapchain_data *const swapchain_data = view_swapchain != XR_NULL_HANDLE ? &s_openxr_swapchains.at(view_swapchain) : nullptr;
+
+					data.swapchain_impl->on_present(view_count, view_textures.p, view_boxes.p, view_layers.p,
+						swapchain_data != nullptr ? swapchain_data->surface_images : s_no_swapchain_images,
+						swapchain_data != nullptr ? swapchain_data->last_released_index : 0);
 					break;
 				}
 			}
@@ -31,6 +31,9 @@ reshade::api::device *reshade::openxr::swapchain_impl::get_device()
 
 reshade::api::resource reshade::openxr::swapchain_impl::get_back_buffer(uint32_t index)
 {
+	if (!_direct_images.empty())
+		return _direct_images[index];
+
 	assert(index == 0);
 
 	return _side_by_side_texture;
@@ -38,7 +41,7 @@ reshade::api::resource reshade::openxr::swapchain_impl::get_back_buffer(uint32_t
 
 reshade::api::rect reshade::openxr::swapchain_impl::get_view_rect(uint32_t index, uint32_t view_count) const
 {
-	const api::resource_desc desc = _device->get_resource_desc(_side_by_side_texture);
+	const api::resource_desc desc = _device->get_resource_desc(_direct_images.empty() ? _side_by_side_texture : _direct_images[0]);
 
 	return api::rect {
 		static_cast<int32_t>(index * (desc.texture.width / view_count)), 0,
@@ -47,7 +50,7 @@ reshade::api::rect reshade::openxr::swapchain_impl::get_view_rect(uint32_t index
 }
 reshade::api::subresource_box reshade::openxr::swapchain_impl::get_view_subresource_box(uint32_t index, uint32_t view_count) const
 {
-	const api::resource_desc desc = _device->get_resource_desc(_side_by_side_texture);
+	const api::resource_desc desc = _device->get_resource_desc(_direct_images.empty() ? _side_by_side_texture : _direct_images[0]);
 
 	return api::subresource_box {
 		static_cast<int32_t>(index * (desc.texture.width / view_count)), 0, 0,
@@ -57,8 +60,8 @@ reshade::api::subresource_box reshade::openxr::swapchain_impl::get_view_subresou
 
 bool reshade::openxr::swapchain_impl::on_init()
 {
-	// Created in 'on_vr_submit' below
-	assert(_side_by_side_texture != 0);
+	// Created or adopted in 'on_present' below
+	assert(_side_by_side_texture != 0 || !_direct_images.empty());
 
 #if RESHADE_ADDON
 	invoke_addon_event<addon_event::init_swapchain>(this);
@@ -70,7 +73,7 @@ bool reshade::openxr::swapchain_impl::on_init()
 }
 void reshade::openxr::swapchain_impl::on_reset()
 {
-	if (_side_by_side_texture == 0)
+	if (_side_by_side_texture == 0 && _direct_images.empty())
 		return;
 
 	reset_effect_runtime(this);
@@ -79,11 +82,15 @@ void reshade::openxr::swapchain_impl::on_reset()
 	invoke_addon_event<addon_event::destroy_swapchain>(this);
 #endif
 
-	_device->destroy_resource(_side_by_side_texture);
+	if (_side_by_side_texture != 0)
+		_device->destroy_resource(_side_by_side_texture);
 	_side_by_side_texture = {};
+
+	// The swapchain images are owned by the OpenXR runtime, so are merely forgotten here
+	_direct_images.clear();
 }
 
-void reshade::openxr::swapchain_impl::on_present(uint32_t view_count, const api::resource *view_textures, const api::subresource_box *view_boxes, const uint32_t *view_layers)
+void reshade::openxr::swapchain_impl::on_present(uint32_t view_count, const api::resource *view_textures, const api::subresource_box *view_boxes, const uint32_t *view_layers, const std::vector<api::resource> &swapchain_images, uint32_t swapchain_image_index)
 {
 	const api::resource_desc source_desc = _device->get_resource_desc(view_textures[0]);
 
@@ -101,6 +108,56 @@ void reshade::openxr::swapchain_impl::on_present(uint32_t view_count, const api:
 	if (target_width == 0 || region_height == 0)
 		return;
 
+	const auto before_state = _device->get_api() == api::device_api::d3d12 ? api::resource_usage::shader_resource_pixel : api::resource_usage::copy_source;
+
+	// Check whether the views already tile a single swapchain image edge to edge in the side-by-side layout, in which case effects can be applied to that image in place, skipping the copies into and out of the side-by-side texture (which cost pure bandwidth at VR resolutions)
+	bool direct_present = !swapchain_images.empty() && swapchain_images[swapchain_image_index] == view_textures[0] &&
+		(source_desc.usage & api::resource_usage::render_target) != 0 &&
+		target_width == source_desc.texture.width && region_height == source_desc.texture.height;
+	for (uint32_t i = 0; direct_present && i < view_count; ++i)
+	{
+		direct_present = view_textures[i] == view_textures[0] && view_layers[i] == 0 &&
+			view_boxes[i].top == 0 && view_boxes[i].bottom == static_cast<int32_t>(region_height) &&
+			view_boxes[i].left == static_cast<int32_t>(i * (target_width / view_count)) &&
+			view_boxes[i].right == static_cast<int32_t>((i + 1) * (target_width / view_count));
+	}
+
+	if (direct_present)
+	{
+		if (_direct_images != swapchain_images)
+		{
+			reshade::log::message(reshade::log::level::info, "Resizing runtime %p in VR to %ux%u (rendering directly into the swapchain images) ...", this, target_width, region_height);
+
+			on_reset();
+
+			_direct_images = swapchain_images;
+
+			if (!on_init())
+				return;
+		}
+
+		_direct_image_index = swapchain_image_index;
+
+		api::command_list *const cmd_list = _graphics_queue->get_immediate_command_list();
+
+		cmd_list->barrier(view_textures[0], before_state, api::resource_usage::present);
+
+#if RESHADE_ADDON
+		invoke_addon_event<addon_event::present>(_graphics_queue, this, nullptr, nullptr, 0, nullptr);
+#endif
+
+		present_effect_runtime(this, _graphics_queue);
+
+		cmd_list->barrier(view_textures[0], api::resource_usage::present, before_state);
+
+		_graphics_queue->flush_immediate_command_list();
+		return;
+	}
+
+	// Fall back to copying through the side-by-side texture (e.g. when each eye is submitted from a separate swapchain)
+	if (!_direct_images.empty())
+		on_reset();
+
 	const api::resource_desc target_desc = _side_by_side_texture != 0 ? _device->get_resource_desc(_side_by_side_texture) : api::resource_desc();
 
 	if (target_width != target_desc.texture.width || region_height != target_desc.texture.height || api::format_to_typeless(source_desc.texture.format) != api::format_to_typeless(target_desc.texture.format))
@@ -130,8 +187,6 @@ void reshade::openxr::swapchain_impl::on_present(uint32_t view_count, const api:
 	api::command_list *const cmd_list = _graphics_queue->get_immediate_command_list();
 
 	// Copy source textures into side-by-side texture
-	const auto before_state = _device->get_api() == api::device_api::d3d12 ? api::resource_usage::shader_resource_pixel : api::resource_usage::copy_source;
-
 	cmd_list->barrier(_side_by_side_texture, api::resource_usage::general, api::resource_usage::copy_dest);
 
 	for (uint32_t i = 0; i < view_count; ++i)
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "reshade_api_object_impl.hpp"
+#include <vector>
 #include <Unknwn.h>
 #include <openxr/openxr.h>
 
@@ -23,8 +24,8 @@ namespace reshade::openxr
 
 		api::resource get_back_buffer(uint32_t index = 0) final;
 
-		uint32_t get_back_buffer_count() const final { return 1; }
-		uint32_t get_current_back_buffer_index() const final { return 0; }
+		uint32_t get_back_buffer_count() const final { return _direct_images.empty() ? 1 : static_cast<uint32_t>(_direct_images.size()); }
+		uint32_t get_current_back_buffer_index() const final { return _direct_images.empty() ? 0 : _direct_image_index; }
 
 		bool check_color_space_support(api::color_space color_space) const final { return color_space == api::color_space::srgb_nonlinear || color_space == api::color_space::extended_srgb_linear; }
 
@@ -36,11 +37,14 @@ namespace reshade::openxr
 		bool on_init();
 		void on_reset();
 
-		void on_present(uint32_t view_count, const api::resource *view_textures, const api::subresource_box *view_boxes, const uint32_t *view_layers);
+		void on_present(uint32_t view_count, const api::resource *view_textures, const api::subresource_box *view_boxes, const uint32_t *view_layers, const std::vector<api::resource> &swapchain_images, uint32_t swapchain_image_index);
 
 	private:
 		api::device *const _device;
 		api::command_queue *const _graphics_queue;
 		api::resource _side_by_side_texture = {};
+		// Swapchain images submitted by the application, exposed as back buffers directly when the views tile a single image edge to edge, so that effects can be applied in place without copying through the side-by-side texture (see 'on_present')
+		std::vector<api::resource> _direct_images;
+		uint32_t _direct_image_index = 0;
 	};
 }
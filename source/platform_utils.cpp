@@ -4,6 +4,7 @@
  */
 
 #include "platform_utils.hpp"
+#include <thread>
 #include <utf8/unchecked.h>
 #include <Windows.h>
 #include <Shellapi.h>
@@ -131,3 +132,110 @@ void reshade::utils::set_window_transparency(void *window, bool enabled)
 	blur_behind.fEnable = enabled;
 	DwmEnableBlurBehindWindow(GetAncestor(static_cast<HWND>(window), GA_ROOT), &blur_behind);
 }
+
+struct directory_watch
+{
+	std::thread thread;
+	HANDLE cancel_event = nullptr;
+	std::vector<HANDLE> change_handles;
+};
+
+void *reshade::utils::start_directory_watch(const std::vector<std::pair<std::filesystem::path, bool>> &directories, void (*callback)(void *user_data), void *user_data)
+{
+	std::vector<HANDLE> change_handles;
+	change_handles.reserve(directories.size());
+	for (const std::pair<std::filesystem::path, bool> &directory : directories)
+	{
+		const HANDLE change_handle = FindFirstChangeNotificationW(directory.first.c_str(), directory.second ? TRUE : FALSE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE);
+		if (change_handle != INVALID_HANDLE_VALUE)
+			change_handles.push_back(change_handle);
+	}
+
+	// The cancel event occupies one slot of the wait below, so at most one less than the maximum number of directories can be watched
+	if (change_handles.size() >= MAXIMUM_WAIT_OBJECTS)
+	{
+		for (size_t i = MAXIMUM_WAIT_OBJECTS - 1; i < change_handles.size(); ++i)
+			FindCloseChangeNotification(change_handles[i]);
+		change_handles.resize(MAXIMUM_WAIT_OBJECTS - 1);
+	}
+
+	if (change_handles.empty())
+		return nullptr;
+
+	const HANDLE cancel_event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+	if (cancel_event == nullptr)
+	{
+		for (const HANDLE change_handle : change_handles)
+			FindCloseChangeNotification(change_handle);
+		return nullptr;
+	}
+
+	const auto watch = new directory_watch();
+	watch->cancel_event = cancel_event;
+	watch->change_handles = std::move(change_handles);
+	watch->thread = std::thread([watch, callback, user_data]() {
+		std::vector<HANDLE> wait_handles;
+		wait_handles.reserve(1 + watch->change_handles.size());
+		wait_handles.push_back(watch->cancel_event);
+		wait_handles.insert(wait_handles.end(), watch->change_handles.cbegin(), watch->change_handles.cend());
+
+		for (;;)
+		{
+			const DWORD wait_result = WaitForMultipleObjects(static_cast<DWORD>(wait_handles.size()), wait_handles.data(), FALSE, INFINITE);
+			if (wait_result == WAIT_OBJECT_0 || wait_result >= WAIT_OBJECT_0 + wait_handles.size())
+				break; // The cancel event was signaled or waiting failed
+
+			callback(user_data);
+
+			if (!FindNextChangeNotification(wait_handles[wait_result - WAIT_OBJECT_0]))
+				break;
+		}
+	});
+
+	return watch;
+}
+void reshade::utils::stop_directory_watch(void *watch_handle)
+{
+	if (watch_handle == nullptr)
+		return;
+
+	const auto watch = static_cast<directory_watch *>(watch_handle);
+
+	SetEvent(watch->cancel_event);
+	watch->thread.join();
+
+	CloseHandle(watch->cancel_event);
+	for (const HANDLE change_handle : watch->change_handles)
+		FindCloseChangeNotification(change_handle);
+
+	delete watch;
+}
+
+void *reshade::utils::create_high_resolution_timer()
+{
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+	// High resolution waitable timers are only supported on Windows 10 version 1803 and newer, so fall back to a regular timer elsewhere
+	HANDLE timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_MANUAL_RESET | CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	if (timer == nullptr)
+		timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_MANUAL_RESET, TIMER_ALL_ACCESS);
+	return timer;
+}
+void reshade::utils::destroy_high_resolution_timer(void *timer)
+{
+	if (timer != nullptr)
+		CloseHandle(static_cast<HANDLE>(timer));
+}
+bool reshade::utils::high_resolution_sleep(void *timer, long long duration)
+{
+	if (timer == nullptr || duration <= 0)
+		return false;
+
+	LARGE_INTEGER due_time;
+	due_time.QuadPart = -duration; // Negative value means relative time
+	if (!SetWaitableTimer(static_cast<HANDLE>(timer), &due_time, 0, nullptr, nullptr, FALSE))
+		return false;
+	return WaitForSingleObject(static_cast<HANDLE>(timer), INFINITE) == WAIT_OBJECT_0;
+}
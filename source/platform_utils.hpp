@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <vector>
 #include <filesystem>
 
 namespace reshade::utils
@@ -29,4 +30,27 @@ namespace reshade::utils
 	/// Alpha values in the swap chain are only respected when the window is transparent.
 	/// </summary>
 	void set_window_transparency(void *window, bool enabled);
+
+	/// <summary>
+	/// Starts a background thread watching the specified directories (optionally recursively) for file changes and invoking the callback from that thread whenever one occurs.
+	/// Returns an opaque handle for use with <see cref="stop_directory_watch"/>, or <see langword="nullptr"/> when none of the directories could be watched.
+	/// </summary>
+	void *start_directory_watch(const std::vector<std::pair<std::filesystem::path, bool>> &directories, void (*callback)(void *user_data), void *user_data);
+	/// <summary>
+	/// Stops a directory watch previously started with <see cref="start_directory_watch"/> and joins its thread.
+	/// </summary>
+	void stop_directory_watch(void *watch);
+
+	/// <summary>
+	/// Creates a timer for use with <see cref="high_resolution_sleep"/>, with the highest resolution the system supports. Returns <see langword="nullptr"/> on failure.
+	/// </summary>
+	void *create_high_resolution_timer();
+	/// <summary>
+	/// Destroys a timer previously created with <see cref="create_high_resolution_timer"/>.
+	/// </summary>
+	void destroy_high_resolution_timer(void *timer);
+	/// <summary>
+	/// Blocks the calling thread on the specified timer for the specified duration (in 100-nanosecond units).
+	/// </summary>
+	bool high_resolution_sleep(void *timer, long long duration);
 }
@@ -5,9 +5,12 @@
 
 #include "runtime.hpp"
 #include "runtime_internal.hpp"
+#include "burst_capture.hpp"
 #include "effect_parser.hpp"
 #include "effect_codegen.hpp"
 #include "effect_preprocessor.hpp"
+#include "effect_serialization.hpp"
+#include "effect_cache.hpp"
 #include "version.h"
 #include "dll_log.hpp"
 #include "dll_resources.hpp"
@@ -17,6 +20,9 @@
 #include "input_gamepad.hpp"
 #include "com_ptr.hpp"
 #include "platform_utils.hpp"
+#include "trace_events.hpp"
+#include "cpu_profiler.hpp"
+#include "file_write_queue.hpp"
 #include "reshade_api_object_impl.hpp"
 #include <set>
 #include <thread>
@@ -27,13 +33,29 @@
 #include <cstdlib> // std::malloc, std::rand, std::strtod, std::strtol
 #include <cstring> // std::memcpy, std::memset, std::strlen
 #include <charconv> // std::to_chars
-#include <algorithm> // std::all_of, std::copy_n, std::equal, std::fill_n, std::find, std::find_if, std::for_each, std::max, std::min, std::replace, std::remove, std::remove_if, std::reverse, std::search, std::sort, std::stable_sort, std::swap, std::transform
+#include <algorithm> // std::all_of, std::copy_n, std::equal, std::fill_n, std::find, std::find_if, std::for_each, std::max, std::min, std::none_of, std::replace, std::remove, std::remove_if, std::reverse, std::search, std::sort, std::stable_sort, std::swap, std::transform
 #include <fpng.h>
 #include <stb_image.h>
 #include <stb_image_dds.h>
 #include <stb_image_write.h>
 #include <stb_image_resize2.h>
 #include <d3dcompiler.h>
+#include <intrin.h> // __cpuid, __cpuidex, _mm_crc32_u8, _mm_crc32_u64, _xgetbv
+
+// Second build of stb_image_resize2 with its AVX2 code paths enabled, which is selected at runtime when the CPU supports it (see 'deps\stb_impl_avx2.c')
+extern "C" int stbir_build_samplers_with_splits_avx2(STBIR_RESIZE *resize, int try_splits);
+extern "C" int stbir_resize_extended_split_avx2(STBIR_RESIZE *resize, int split_start, int split_count);
+extern "C" void stbir_free_samplers_avx2(STBIR_RESIZE *resize);
+
+#if RESHADE_FX
+namespace reshade::d3d11
+{
+	// Implemented in 'd3d11_impl_command_queue.cpp' and declared here to avoid pulling the D3D11 headers into this generic translation unit
+	extern api::command_list *create_deferred_command_list(api::device *device);
+	extern void destroy_deferred_command_list(api::command_list *cmd_list);
+	extern bool execute_deferred_command_list(api::command_queue *immediate_queue, api::command_list *cmd_list);
+}
+#endif
 
 bool resolve_path(std::filesystem::path &path, std::error_code &ec)
 {
@@ -76,6 +98,61 @@ static std::filesystem::path make_relative_path(const std::filesystem::path &pat
 	return proximate_path;
 }
 
+// Cached directory enumerations of the effect and texture search paths, so that every reload does not have to walk the same directory trees again (which alone can take over a second on network shares)
+struct search_path_cache_entry
+{
+	std::vector<std::filesystem::path> files;
+	// Write times of the search path and all sub-directories below it at the time of enumeration, starting with the search path itself
+	// A directory's write time changes whenever entries in it are added, renamed or removed, so comparing these detects any change that would alter the enumeration result
+	std::vector<std::pair<std::filesystem::path, std::filesystem::file_time_type>> directories;
+};
+static std::mutex s_search_path_cache_mutex;
+static std::unordered_map<std::wstring, search_path_cache_entry> s_search_path_cache;
+
+static const search_path_cache_entry &enumerate_search_path(const std::filesystem::path &search_path, bool recursive, std::error_code &ec)
+{
+	search_path_cache_entry &cache_entry = s_search_path_cache[search_path.native() + (recursive ? L"**" : L"")];
+
+	bool valid = !cache_entry.directories.empty();
+	for (const std::pair<std::filesystem::path, std::filesystem::file_time_type> &directory : cache_entry.directories)
+	{
+		if (std::filesystem::last_write_time(directory.first, ec) != directory.second || ec)
+		{
+			valid = false;
+			break;
+		}
+	}
+
+	if (valid)
+		return cache_entry;
+
+	cache_entry.files.clear();
+	cache_entry.directories.clear();
+
+	cache_entry.directories.emplace_back(search_path, std::filesystem::last_write_time(search_path, ec));
+
+	if (recursive)
+	{
+		for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator(search_path, std::filesystem::directory_options::skip_permission_denied, ec))
+		{
+			if (entry.is_directory(ec))
+				cache_entry.directories.emplace_back(entry, entry.last_write_time(ec));
+			else
+				cache_entry.files.emplace_back(entry); // Construct path from directory entry in-place
+		}
+	}
+	else
+	{
+		for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(search_path, std::filesystem::directory_options::skip_permission_denied, ec))
+		{
+			if (!entry.is_directory(ec))
+				cache_entry.files.emplace_back(entry);
+		}
+	}
+
+	return cache_entry;
+}
+
 static bool find_file(const std::vector<std::filesystem::path> &search_paths, std::filesystem::path &path)
 {
 	std::error_code ec;
@@ -101,12 +178,13 @@ static bool find_file(const std::vector<std::filesystem::path> &search_paths, st
 
 			if (recursive_search)
 			{
-				for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator(search_path, std::filesystem::directory_options::skip_permission_denied, ec))
-				{
-					if (!entry.is_directory(ec))
-						continue;
+				const std::unique_lock<std::mutex> lock(s_search_path_cache_mutex);
 
-					if (std::filesystem::path search_sub_path = entry / path;
+				// Walk the cached directory list instead of enumerating the entire directory tree for every file (the first entry is the search path itself, which was already checked above)
+				const search_path_cache_entry &cache_entry = enumerate_search_path(search_path, true, ec);
+				for (size_t i = 1; i < cache_entry.directories.size(); ++i)
+				{
+					if (std::filesystem::path search_sub_path = cache_entry.directories[i].first / path;
 						std::filesystem::exists(search_sub_path, ec))
 					{
 						path = std::move(search_sub_path);
@@ -153,22 +231,13 @@ static std::vector<std::filesystem::path> find_files(const std::vector<std::file
 		}
 	}
 
-	// Then iterate through all files in those search paths and add those with a matching extension
-	const auto check_and_add_file = [&extensions, &ec, &files](const std::filesystem::directory_entry &entry) {
-		if (!entry.is_directory(ec) &&
-			std::find(extensions.begin(), extensions.end(), entry.path().extension()) != extensions.end())
-			files.emplace_back(entry); // Construct path from directory entry in-place
-	};
+	// Then go over all files in those search paths and add those with a matching extension
+	const std::unique_lock<std::mutex> lock(s_search_path_cache_mutex);
 
 	for (const std::pair<std::filesystem::path, bool> &resolved_search_path : resolved_search_paths)
-	{
-		if (resolved_search_path.second)
-			for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator(resolved_search_path.first, std::filesystem::directory_options::skip_permission_denied, ec))
-				check_and_add_file(entry);
-		else
-			for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(resolved_search_path.first, std::filesystem::directory_options::skip_permission_denied, ec))
-				check_and_add_file(entry);
-	}
+		for (const std::filesystem::path &file : enumerate_search_path(resolved_search_path.first, resolved_search_path.second, ec).files)
+			if (std::find(extensions.begin(), extensions.end(), file.extension()) != extensions.end())
+				files.push_back(file);
 
 	return files;
 }
@@ -365,6 +434,15 @@ bool reshade::runtime::on_init()
 				log::message(log::level::error, "Failed to create copy pipeline!");
 				goto exit_failure;
 			}
+
+			// Additionally create a sampler with linear filtering for the scaling blits of techniques with a render scale (see 'render_technique')
+			sampler_desc.filter = api::filter_mode::min_mag_mip_linear;
+
+			if (!_device->create_sampler(sampler_desc, &_scale_sampler_state))
+			{
+				log::message(log::level::error, "Failed to create scale sampler!");
+				goto exit_failure;
+			}
 		}
 	}
 
@@ -465,10 +543,15 @@ bool reshade::runtime::on_init()
 
 	_is_initialized = true;
 	_last_reload_time = std::chrono::high_resolution_clock::now(); // Intentionally set to current time, so that duration to last reload is valid even when there is no reload on init
+	_last_performance_log_time = _last_reload_time;
 
 	_preset_save_successful = true;
 	_last_screenshot_save_successful = true;
 
+#if RESHADE_FX
+	start_effect_file_watcher();
+#endif
+
 #if RESHADE_ADDON
 	invoke_addon_event<addon_event::init_effect_runtime>(this);
 #endif
@@ -495,6 +578,8 @@ exit_failure:
 	_effect_stencil_tex = {};
 	_device->destroy_resource_view(_effect_stencil_dsv);
 	_effect_stencil_dsv = {};
+
+	destroy_scaled_render_targets();
 #endif
 
 	_device->destroy_pipeline(_copy_pipeline);
@@ -503,6 +588,8 @@ exit_failure:
 	_copy_pipeline_layout = {};
 	_device->destroy_sampler(_copy_sampler_state);
 	_copy_sampler_state = {};
+	_device->destroy_sampler(_scale_sampler_state);
+	_scale_sampler_state = {};
 
 	_device->destroy_resource(_back_buffer_resolved);
 	_back_buffer_resolved = {};
@@ -533,10 +620,22 @@ void reshade::runtime::on_reset()
 	else
 		return; // Nothing to do if the runtime was already destroyed or not successfully initialized in the first place
 
+	// Write out screenshot captures that are still in flight, before the readback textures they use are destroyed below
+	finish_pending_screenshots(true);
+
 #if RESHADE_FX
+	stop_effect_file_watcher();
+
 	// Already performs a wait for idle, so no need to do it again before destroying resources below
 	destroy_effects();
 
+	if (_deferred_effect_cmd_list != nullptr)
+	{
+		d3d11::destroy_deferred_command_list(_deferred_effect_cmd_list);
+		_deferred_effect_cmd_list = nullptr;
+		_deferred_effect_rendering_failed = false;
+	}
+
 	_device->destroy_resource(_empty_tex);
 	_empty_tex = {};
 	_device->destroy_resource_view(_empty_srv);
@@ -553,6 +652,8 @@ void reshade::runtime::on_reset()
 	_effect_stencil_tex = {};
 	_device->destroy_resource_view(_effect_stencil_dsv);
 	_effect_stencil_dsv = {};
+
+	destroy_scaled_render_targets();
 #else
 	for (std::thread &thread : _worker_threads)
 		if (thread.joinable())
@@ -560,12 +661,20 @@ void reshade::runtime::on_reset()
 	_worker_threads.clear();
 #endif
 
+	// Write out any remaining performance log data (the append job does not reference this runtime, so there is no need to wait for it to finish)
+	flush_performance_log();
+
+	// Wait for queued file writes after the worker threads that submit them were joined above, since their completion callbacks reference this runtime
+	get_file_write_queue().wait();
+
 	_device->destroy_pipeline(_copy_pipeline);
 	_copy_pipeline = {};
 	_device->destroy_pipeline_layout(_copy_pipeline_layout);
 	_copy_pipeline_layout = {};
 	_device->destroy_sampler(_copy_sampler_state);
 	_copy_sampler_state = {};
+	_device->destroy_sampler(_scale_sampler_state);
+	_scale_sampler_state = {};
 
 	_device->destroy_resource(_back_buffer_resolved);
 	_back_buffer_resolved = {};
@@ -582,9 +691,35 @@ void reshade::runtime::on_reset()
 	_device->destroy_fence(_queue_sync_fence);
 	_queue_sync_fence = {};
 
+	// Frame slots in the capture file have a fixed size, so an active burst capture cannot survive a resize
+	stop_burst_capture();
+
+	for (screenshot_readback &readback : _screenshot_readbacks)
+	{
+		_device->destroy_resource(readback.intermediate);
+		readback.intermediate = {};
+		readback.fence_value = 0;
+	}
+	_device->destroy_fence(_screenshot_fence);
+	_screenshot_fence = {};
+
 	_width = _height = 0;
 
 #if RESHADE_GUI
+	if (_present_latency_thread.joinable())
+	{
+		_present_latency_thread_exit = true;
+		// Signal the fence from the CPU past any value the monitoring thread may still be waiting on, so that it wakes up and exits
+		_device->signal(_present_latency_fence, _present_latency_fence_value + std::size(_present_latency_start_times) + 1);
+		_present_latency_thread.join();
+		_present_latency_thread = std::thread();
+		_present_latency_thread_exit = false;
+	}
+	_device->destroy_fence(_present_latency_fence);
+	_present_latency_fence = {};
+	_present_latency_fence_value = 0;
+	_present_latency_average = 0;
+
 	if (_is_vr)
 		deinit_gui_vr();
 
@@ -595,6 +730,9 @@ void reshade::runtime::on_reset()
 	invoke_addon_event<addon_event::destroy_effect_runtime>(this);
 #endif
 
+	utils::destroy_high_resolution_timer(_pacing_timer);
+	_pacing_timer = nullptr;
+
 	log::message(log::level::info, "Destroyed runtime environment on runtime %p ('%s').", this, _config_path.u8string().c_str());
 }
 void reshade::runtime::on_present(api::command_queue *present_queue)
@@ -604,9 +742,39 @@ void reshade::runtime::on_present(api::command_queue *present_queue)
 	if (!_is_initialized)
 		return;
 
+	const trace::scoped_event trace_scope("on_present");
+
+	// Snapshot the CPU timings of the frame that just completed and start the next one (see 'draw_gui_profiler')
+	profiling::mark_frame();
+	const profiling::scoped_cpu_timer profile_scope("on_present");
+
+#if RESHADE_GUI
+	const std::chrono::high_resolution_clock::time_point present_start_time = std::chrono::high_resolution_clock::now();
+#endif
+
+	// Lock input so it cannot be modified by other threads while we are reading it here (and in 'draw_gui' below)
+	std::unique_lock<std::recursive_mutex> input_lock;
+	if (_input != nullptr)
+		input_lock = _input->lock();
+
+	// Skip the expensive present path when ReShade will not modify the frame in any way, which avoids the application state capture and restore, the back buffer copies and the GPU work associated with them
+	bool skip_rendering = !_is_vr && !_should_save_screenshot;
+#if RESHADE_FX
+	skip_rendering = skip_rendering && (!_effects_enabled || _effects_rendered_this_frame);
+#endif
+#if RESHADE_GUI
+	skip_rendering = skip_rendering && !is_gui_draw_pending();
+#endif
+#if RESHADE_ADDON
+	// Addons may record commands in response to the present event below and rely on the application state being restored afterwards
+	skip_rendering = skip_rendering && !has_addon_event<addon_event::reshade_present>();
+#endif
+	// Remember the decision, since 'update_effects' below can start a reload (e.g. via the effect file watcher) or an addon callback can change the effects state mid-frame, after the application state capture was already skipped, so the rendering stages below have to stay consistent with this snapshot rather than the live state
+	_skip_rendering_this_frame = skip_rendering;
+
 	// If the application is presenting with a different queue than rendering, synchronize these two queues first
 	// This ensures that it has finished rendering before ReShade applies its own rendering
-	if (present_queue != _graphics_queue)
+	if (!skip_rendering && present_queue != _graphics_queue)
 	{
 		if (_queue_sync_fence == 0)
 		{
@@ -634,13 +802,14 @@ void reshade::runtime::on_present(api::command_queue *present_queue)
 
 	api::command_list *const cmd_list = _graphics_queue->get_immediate_command_list();
 
-	capture_state(cmd_list, _app_state);
+	if (!skip_rendering)
+		capture_state(cmd_list, _app_state);
 
 	uint32_t back_buffer_index = (_back_buffer_resolved != 0 ? 2 : 0) + get_current_back_buffer_index() * 2;
 	const api::resource back_buffer_resource = _device->get_resource_from_view(_back_buffer_targets[back_buffer_index]);
 
 	// Resolve MSAA back buffer if MSAA is active or copy when format conversion is required
-	if (_back_buffer_resolved != 0)
+	if (!skip_rendering && _back_buffer_resolved != 0)
 	{
 		if (_back_buffer_samples == 1)
 		{
@@ -656,27 +825,42 @@ void reshade::runtime::on_present(api::command_queue *present_queue)
 		}
 	}
 
-	// Lock input so it cannot be modified by other threads while we are reading it here
-	std::unique_lock<std::recursive_mutex> input_lock;
-	if (_input != nullptr)
-		input_lock = _input->lock();
+	// Map and encode screenshot captures from previous frames for which the GPU has finished the back buffer copy by now
+	finish_pending_screenshots(false);
 
 #if RESHADE_FX
 	update_effects();
 
-	if (_effects_enabled && !_effects_rendered_this_frame)
+	if (!skip_rendering && _effects_enabled && !_effects_rendered_this_frame)
 	{
 		if (_should_save_screenshot && _screenshot_save_before)
 			save_screenshot(" original");
 
-		if (_back_buffer_resolved != 0)
+		const api::resource_view rtv = _back_buffer_targets[_back_buffer_resolved != 0 ? 0 : back_buffer_index];
+		const api::resource_view rtv_srgb = _back_buffer_targets[_back_buffer_resolved != 0 ? 1 : back_buffer_index + 1];
+
+		if (prepare_deferred_effect_rendering())
+		{
+			// Update uniform variables that read input state on this thread, since the worker thread cannot do so safely
+			update_special_uniform_variables();
+
+			// Record effect rendering on a worker thread, so that it overlaps with the overlay rendering below, and execute the result in 'finish_deferred_effect_rendering'
+			_deferred_effect_back_buffer = _back_buffer_resolved == 0 ? back_buffer_resource : api::resource {};
+			_deferred_effect_recording_pending = true;
+
+			get_thread_pool().enqueue(_deferred_effect_job_group,
+				[this, rtv, rtv_srgb]() {
+					runtime::render_effects(_deferred_effect_cmd_list, rtv, rtv_srgb);
+				});
+		}
+		else if (_back_buffer_resolved != 0)
 		{
-			runtime::render_effects(cmd_list, _back_buffer_targets[0], _back_buffer_targets[1]);
+			runtime::render_effects(cmd_list, rtv, rtv_srgb);
 		}
 		else
 		{
 			cmd_list->barrier(back_buffer_resource, api::resource_usage::present, api::resource_usage::render_target);
-			runtime::render_effects(cmd_list, _back_buffer_targets[back_buffer_index], _back_buffer_targets[back_buffer_index + 1]);
+			runtime::render_effects(cmd_list, rtv, rtv_srgb);
 			cmd_list->barrier(back_buffer_resource, api::resource_usage::render_target, api::resource_usage::present);
 		}
 	}
@@ -688,6 +872,18 @@ void reshade::runtime::on_present(api::command_queue *present_queue)
 	_frame_count++;
 	const auto current_time = std::chrono::high_resolution_clock::now();
 	_last_frame_duration = current_time - _last_present_time; _last_present_time = current_time;
+	_frame_duration_histogram.append(std::chrono::duration_cast<std::chrono::nanoseconds>(_last_frame_duration).count());
+#if RESHADE_GUI
+	_frame_time_history.append(std::chrono::duration_cast<std::chrono::nanoseconds>(_last_frame_duration).count() * 1e-6f);
+#endif
+
+	if (_performance_log_interval != 0)
+	{
+		_performance_log_frame_count++;
+
+		if (current_time - _last_performance_log_time >= std::chrono::seconds(_performance_log_interval))
+			save_performance_log_sample();
+	}
 
 #if RESHADE_GUI
 	// Draw overlay
@@ -704,12 +900,23 @@ void reshade::runtime::on_present(api::command_queue *present_queue)
 		save_screenshot(" overlay");
 #endif
 
+#if RESHADE_FX
+	// Ensure the deferred effect rendering was executed, in case the overlay did not render anything this frame
+	finish_deferred_effect_rendering();
+#endif
+
+	// Append the current frame to the capture file while a burst capture is active
+	if (_burst_capture_view != nullptr)
+		capture_burst_frame();
+
 	// All screenshots were created at this point, so reset request
 	_should_save_screenshot = false;
 
 	// Handle keyboard shortcuts
 	if (!_ignore_shortcuts && _input != nullptr)
 	{
+		const profiling::scoped_cpu_timer profile_scope_shortcuts("handle_shortcuts");
+
 #if RESHADE_FX
 		if (_input->is_key_pressed(_effects_key_data, _force_shortcut_modifiers))
 		{
@@ -726,6 +933,15 @@ void reshade::runtime::on_present(api::command_queue *present_queue)
 			_should_save_screenshot = true; // Remember that we want to save a screenshot next frame
 		}
 
+		if (_input->is_key_pressed(_burst_capture_key_data, _force_shortcut_modifiers))
+		{
+			// Pressing the shortcut again while a burst capture is running stops it early
+			if (_burst_capture_view == nullptr)
+				start_burst_capture();
+			else
+				stop_burst_capture();
+		}
+
 #if RESHADE_FX
 		// Do not allow the following shortcuts while effects are being loaded or initialized (since they affect that state)
 		if (!is_loading())
@@ -835,7 +1051,7 @@ void reshade::runtime::on_present(api::command_queue *present_queue)
 	}
 
 	// Stretch main render target back into MSAA back buffer if MSAA is active or copy when format conversion is required
-	if (_back_buffer_resolved != 0)
+	if (!skip_rendering && _back_buffer_resolved != 0)
 	{
 		const api::resource resources[2] = { back_buffer_resource, _back_buffer_resolved };
 		const api::resource_usage state_old[2] = { api::resource_usage::copy_source | api::resource_usage::resolve_source, api::resource_usage::render_target };
@@ -883,12 +1099,14 @@ void reshade::runtime::on_present(api::command_queue *present_queue)
 #endif
 #if RESHADE_FX
 	_effects_rendered_this_frame = false;
+	_special_uniforms_updated_this_frame = false;
 #endif
 
 	// Apply previous state from application
-	apply_state(cmd_list, _app_state);
+	if (!skip_rendering)
+		apply_state(cmd_list, _app_state);
 
-	if (present_queue != _graphics_queue && _queue_sync_fence != 0)
+	if (!skip_rendering && present_queue != _graphics_queue && _queue_sync_fence != 0)
 	{
 		_queue_sync_value++;
 
@@ -918,7 +1136,7 @@ void reshade::runtime::on_present(api::command_queue *present_queue)
 	else
 	{
 		const bool was_enabled = addon_enabled;
-		addon_enabled = traffic < 10;
+		enable_addons(traffic < 10);
 		traffic = 0;
 		cooldown = 60;
 
@@ -942,7 +1160,72 @@ void reshade::runtime::on_present(api::command_queue *present_queue)
 	if (std::numeric_limits<long>::max() != g_network_traffic)
 		g_network_traffic = 0;
 #endif
+
+#if RESHADE_GUI
+	// Signal a fence now that all GPU work of this frame was submitted, to measure how long the GPU trails behind (see 'draw_gui_statistics')
+	if (_gather_present_latency)
+		update_present_latency(present_start_time);
+#endif
+
+	// Limit the frame rate by delaying the return from the present call
+	if (_fps_limit != 0)
+	{
+		const auto interval = std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(std::chrono::duration<double>(1.0 / _fps_limit));
+
+		const auto now = std::chrono::high_resolution_clock::now();
+		// Resynchronize the deadline after longer stalls or frame rate changes, rather than trying to catch up
+		if (_next_present_deadline < now || _next_present_deadline > now + interval)
+			_next_present_deadline = now;
+		_next_present_deadline += interval;
+
+		if (_pacing_timer == nullptr)
+			_pacing_timer = utils::create_high_resolution_timer();
+
+		// Sleep for the bulk of the wait on a timer, but leave a small margin that is finished with a spin loop, since timers may wake up slightly late
+		const auto sleep_duration = (_next_present_deadline - std::chrono::milliseconds(1)) - now;
+		if (sleep_duration > std::chrono::high_resolution_clock::duration::zero())
+			utils::high_resolution_sleep(_pacing_timer, std::chrono::duration_cast<std::chrono::duration<long long, std::ratio<1, 10000000>>>(sleep_duration).count());
+
+		while (std::chrono::high_resolution_clock::now() < _next_present_deadline)
+			; // Spin until the deadline is reached
+	}
+}
+
+#if RESHADE_GUI
+void reshade::runtime::update_present_latency(std::chrono::high_resolution_clock::time_point present_start_time)
+{
+	// Create the fence and monitoring thread on first use (these stay alive until the runtime is reset, since recreating them every time the statistics overlay is opened would be wasteful)
+	if (_present_latency_fence == 0)
+	{
+		if (_present_latency_thread.joinable() ||
+			!_device->create_fence(0, api::fence_flags::none, &_present_latency_fence))
+			return; // Fence creation failed before or is not supported by this device
+
+		// Wait for the fence values on a separate thread, so that the frame is never stalled on the GPU here
+		_present_latency_thread = std::thread([this]() {
+			uint64_t fence_value = 0;
+			while (_device->wait(_present_latency_fence, ++fence_value) && !_present_latency_thread_exit)
+			{
+				const uint64_t start_time = _present_latency_start_times[fence_value % std::size(_present_latency_start_times)].load(std::memory_order_acquire);
+				const uint64_t end_time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+				if (end_time <= start_time)
+					continue; // The start time slot was already overwritten because this thread fell too far behind
+
+				// Blend into a running average, since the per-frame values are noisy
+				const uint64_t average = _present_latency_average.load(std::memory_order_relaxed);
+				_present_latency_average.store(average != 0 ? (average * 15 + (end_time - start_time)) / 16 : (end_time - start_time), std::memory_order_relaxed);
+			}
+		});
+	}
+
+	const uint64_t fence_value = _present_latency_fence_value.load(std::memory_order_relaxed) + 1;
+	_present_latency_start_times[fence_value % std::size(_present_latency_start_times)].store(std::chrono::duration_cast<std::chrono::nanoseconds>(present_start_time.time_since_epoch()).count(), std::memory_order_release);
+
+	// Signaling flushes the immediate command list first, so the fence passes once the GPU finished executing all the work recorded during this frame
+	if (_graphics_queue->signal(_present_latency_fence, fence_value))
+		_present_latency_fence_value.store(fence_value, std::memory_order_relaxed);
 }
+#endif
 
 void reshade::runtime::load_config()
 {
@@ -961,6 +1244,7 @@ void reshade::runtime::load_config()
 	};
 
 	config_get("INPUT", "ForceShortcutModifiers", _force_shortcut_modifiers);
+	config_get("INPUT", "KeyBurstCapture", _burst_capture_key_data);
 	config_get("INPUT", "KeyScreenshot", _screenshot_key_data);
 #if RESHADE_FX
 	config_get("INPUT", "KeyEffects", _effects_key_data);
@@ -973,11 +1257,31 @@ void reshade::runtime::load_config()
 	config_get("GENERAL", "NoEffectCache", _no_effect_cache);
 	config_get("GENERAL", "NoReloadOnInit", _no_reload_on_init);
 
+	config_get("GENERAL", "PrecompilePresets", _precompile_presets);
+
+	config_get("GENERAL", "GatherGPUStatistics", _force_gather_gpu_statistics);
+	config_get("GENERAL", "GatherGPUStatisticsPerPass", _gather_gpu_statistics_per_pass);
+	config_get("GENERAL", "GPUTimestampFrames", _gpu_timestamp_frames);
+	// The query heaps are sized based on this, so keep it within a sane range
+	_gpu_timestamp_frames = std::max(2u, std::min(_gpu_timestamp_frames, 16u));
+
+	config_get("GENERAL", "EffectGPUBudget", _effect_gpu_budget);
+	_effect_gpu_budget = std::max(_effect_gpu_budget, 0.0f);
+
+	config_get("GENERAL", "EffectCreateBudget", _effect_create_budget);
+	_effect_create_budget = std::max(_effect_create_budget, 0.0f);
+
+	config_get("GENERAL", "DeferredEffectRendering", _deferred_effect_rendering);
+	config_get("GENERAL", "ShareUniformVariables", _share_uniform_variables);
+	config_get("GENERAL", "OptimizeTechniqueOrder", _optimize_technique_order);
+
 	config_get("GENERAL", "EffectSearchPaths", _effect_search_paths);
 	config_get("GENERAL", "PerformanceMode", _performance_mode);
 	config_get("GENERAL", "PreprocessorDefinitions", _global_preprocessor_definitions);
+	config_get("GENERAL", "RelaxedPrecision", _relaxed_precision);
 	config_get("GENERAL", "SkipLoadingDisabledEffects", _effect_load_skipping);
 	config_get("GENERAL", "TextureSearchPaths", _texture_search_paths);
+	config_get("GENERAL", "WatchEffectFiles", _watch_effect_files);
 	config_get("GENERAL", "IntermediateCachePath", _effect_cache_path);
 
 	config_get("GENERAL", "StartupPresetPath", _startup_preset_path);
@@ -1016,8 +1320,12 @@ void reshade::runtime::load_config()
 	}
 #endif
 
+	config_get("GENERAL", "FPSLimit", _fps_limit);
+	config_get("GENERAL", "PerformanceLogInterval", _performance_log_interval);
+
 	config_get("SCREENSHOT", "SavePath", _screenshot_path);
 	config_get("SCREENSHOT", "SoundPath", _screenshot_sound_path);
+	config_get("SCREENSHOT", "BurstDuration", _burst_capture_duration);
 	config_get("SCREENSHOT", "ClearAlpha", _screenshot_clear_alpha);
 	config_get("SCREENSHOT", "FileFormat", _screenshot_format);
 	config_get("SCREENSHOT", "FileNaming", _screenshot_name);
@@ -1043,6 +1351,7 @@ void reshade::runtime::save_config() const
 	ini_file &config = ini_file::load_cache(_config_path);
 
 	config.set("INPUT", "ForceShortcutModifiers", _force_shortcut_modifiers);
+	config.set("INPUT", "KeyBurstCapture", _burst_capture_key_data);
 	config.set("INPUT", "KeyScreenshot", _screenshot_key_data);
 #if RESHADE_FX
 	config.set("INPUT", "KeyEffects", _effects_key_data);
@@ -1055,11 +1364,23 @@ void reshade::runtime::save_config() const
 	config.set("GENERAL", "NoEffectCache", _no_effect_cache);
 	config.set("GENERAL", "NoReloadOnInit", _no_reload_on_init);
 
+	config.set("GENERAL", "PrecompilePresets", _precompile_presets);
+
+	config.set("GENERAL", "GatherGPUStatistics", _force_gather_gpu_statistics);
+	config.set("GENERAL", "GatherGPUStatisticsPerPass", _gather_gpu_statistics_per_pass);
+	config.set("GENERAL", "GPUTimestampFrames", _gpu_timestamp_frames);
+	config.set("GENERAL", "EffectGPUBudget", _effect_gpu_budget);
+	config.set("GENERAL", "EffectCreateBudget", _effect_create_budget);
+	config.set("GENERAL", "ShareUniformVariables", _share_uniform_variables);
+	config.set("GENERAL", "OptimizeTechniqueOrder", _optimize_technique_order);
+
 	config.set("GENERAL", "EffectSearchPaths", _effect_search_paths);
 	config.set("GENERAL", "PerformanceMode", _performance_mode);
 	config.set("GENERAL", "PreprocessorDefinitions", _global_preprocessor_definitions);
+	config.set("GENERAL", "RelaxedPrecision", _relaxed_precision);
 	config.set("GENERAL", "SkipLoadingDisabledEffects", _effect_load_skipping);
 	config.set("GENERAL", "TextureSearchPaths", _texture_search_paths);
+	config.set("GENERAL", "WatchEffectFiles", _watch_effect_files);
 	config.set("GENERAL", "IntermediateCachePath", _effect_cache_path);
 
 	config.set("GENERAL", "StartupPresetPath", make_relative_path(_startup_preset_path));
@@ -1084,8 +1405,12 @@ void reshade::runtime::save_config() const
 	config.set("GENERAL", "PresetShortcutPaths", preset_shortcut_paths);
 #endif
 
+	config.set("GENERAL", "FPSLimit", _fps_limit);
+	config.set("GENERAL", "PerformanceLogInterval", _performance_log_interval);
+
 	config.set("SCREENSHOT", "SavePath", _screenshot_path);
 	config.set("SCREENSHOT", "SoundPath", _screenshot_sound_path);
+	config.set("SCREENSHOT", "BurstDuration", _burst_capture_duration);
 	config.set("SCREENSHOT", "ClearAlpha", _screenshot_clear_alpha);
 	config.set("SCREENSHOT", "FileFormat", _screenshot_format);
 	config.set("SCREENSHOT", "FileNaming", _screenshot_name);
@@ -1112,6 +1437,40 @@ void reshade::runtime::load_current_preset()
 {
 	_preset_save_successful = true;
 
+	// Fast path for the update every frame during a preset transition: walk the values that were pre-resolved on the first frame of the transition, instead of re-parsing the preset and re-resolving uniform names each time
+	if (_is_in_preset_transition && _preset_transition_values_valid &&
+		_reload_remaining_effects == std::numeric_limits<size_t>::max() && _reload_required_effects.empty())
+	{
+		const auto transition_time = std::chrono::duration_cast<std::chrono::microseconds>(_last_present_time - _last_preset_switching_time).count();
+		const auto transition_ms_left = _preset_transition_duration - transition_time / 1000;
+		const auto transition_ms_left_from_last_frame = transition_ms_left + std::chrono::duration_cast<std::chrono::microseconds>(_last_frame_duration).count() / 1000;
+
+		if (transition_ms_left > 0)
+		{
+			for (const preset_transition_value &transition_value : _preset_transition_values)
+			{
+				uniform &variable = _effects[transition_value.effect_index].uniforms[transition_value.uniform_index];
+
+				reshadefx::constant values;
+				get_uniform_value(variable, values.as_float, variable.type.components());
+
+				// Perform smooth transition on floating point values
+				for (unsigned int i = 0; i < variable.type.components(); i++)
+				{
+					const float value_left = (transition_value.value[i] - values.as_float[i]);
+					values.as_float[i] = transition_value.value[i] - (value_left / transition_ms_left_from_last_frame) * transition_ms_left;
+				}
+
+				set_uniform_value(variable, values.as_float, variable.type.components());
+			}
+
+			return;
+		}
+
+		// The transition ended, so fall through to a full preset load below, which resets values of keys missing from the preset to their defaults
+		_preset_transition_values_valid = false;
+	}
+
 	const ini_file &preset = ini_file::load_cache(_current_preset_path);
 
 	std::vector<std::string> technique_list;
@@ -1119,35 +1478,148 @@ void reshade::runtime::load_current_preset()
 	std::vector<std::string> sorted_technique_list;
 	preset.get({}, "TechniqueSorting", sorted_technique_list);
 
+	// Set when this is called in the middle of a reload, in which case only effects that have already finished compiling may be referenced, the rest is applied again once the reload completed (see 'update_effects')
+	const bool partial_apply = _reload_priority_remaining_effects == 0;
+
 	std::unordered_map<std::string, std::vector<std::pair<std::string, std::string>>> preset_preprocessor_definitions;
-	preset.get({}, "PreprocessorDefinitions", preset_preprocessor_definitions[{}]);
-	for (const effect &effect : _effects)
-		preset.get(effect.source_file.filename().u8string(), "PreprocessorDefinitions", preset_preprocessor_definitions[effect.source_file.filename().u8string()]);
+	if (!partial_apply)
+	{
+		preset.get({}, "PreprocessorDefinitions", preset_preprocessor_definitions[{}]);
+		for (const effect &effect : _effects)
+			preset.get(effect.source_file.filename().u8string(), "PreprocessorDefinitions", preset_preprocessor_definitions[effect.source_file.filename().u8string()]);
+	}
 
 	// Recompile effects if preprocessor definitions have changed or running in performance mode (in which case all preset values are compile-time constants)
-	if (_reload_remaining_effects != 0 && (!_is_in_preset_transition || _last_preset_switching_time == _last_present_time)) // ... unless this is the 'load_current_preset' call in 'update_effects' or the call every frame during preset transition
+	if (!partial_apply && _reload_remaining_effects != 0 && (!_is_in_preset_transition || _last_preset_switching_time == _last_present_time)) // ... unless this is the 'load_current_preset' call in 'update_effects' or the call every frame during preset transition
 	{
-		if (_performance_mode || preset_preprocessor_definitions != _preset_preprocessor_definitions)
+		if (_performance_mode)
+		{
+			// In performance mode all preset values are compile-time constants, so schedule effects whose values the new preset changes for a reload, keeping the rest alive (effects affected by changed preprocessor definitions are handled below)
+			if (std::find(_reload_required_effects.cbegin(), _reload_required_effects.cend(), _effects.size()) == _reload_required_effects.cend())
+			{
+				for (size_t effect_index = 0; effect_index < _effects.size(); ++effect_index)
+				{
+					const effect &effect = _effects[effect_index];
+
+					// Effects that failed to compile may succeed with the changed values, so reload them as well
+					bool values_changed = !effect.compiled && !effect.skipped;
+
+					const std::string effect_name = effect.source_file.filename().u8string();
+
+					for (size_t i = 0; !values_changed && i < effect.module.spec_constants.size() && i < effect.spec_constant_values.size(); ++i)
+					{
+						const reshadefx::uniform &constant = effect.module.spec_constants[i];
+
+						// Compute the value this constant would have with the new preset, starting from the default value in the effect source
+						reshadefx::constant value = effect.spec_constant_values[i].first;
+						switch (constant.type.base)
+						{
+						case reshadefx::type::t_int:
+							preset.get(effect_name, constant.name, value.as_int);
+							break;
+						case reshadefx::type::t_bool:
+						case reshadefx::type::t_uint:
+							preset.get(effect_name, constant.name, value.as_uint);
+							break;
+						case reshadefx::type::t_float:
+							preset.get(effect_name, constant.name, value.as_float);
+							break;
+						}
+
+						values_changed = std::memcmp(value.as_uint, effect.spec_constant_values[i].second.as_uint, sizeof(value.as_uint)) != 0;
+					}
+
+					if (!values_changed)
+						continue;
+
+					// When the backend applies specialization constant values during pipeline creation, swap in the new values and recreate just the pipelines, which also keeps textures and uniform state alive, instead of recompiling from source
+					if (effect.compiled && respecialize_effect(effect_index, preset))
+						continue;
+
+					if (std::find(_reload_required_effects.cbegin(), _reload_required_effects.cend(), effect_index) == _reload_required_effects.cend())
+						_reload_required_effects.push_back(effect_index);
+				}
+			}
+		}
+
+		if (preset_preprocessor_definitions != _preset_preprocessor_definitions)
 		{
+			// Figure out which definitions changed, so that only the effects that queried them are reloaded, keeping everything else's pipelines and textures alive
+			std::vector<std::string> changed_definitions;
+			const auto diff_definitions = [&changed_definitions](const std::vector<std::pair<std::string, std::string>> &lhs, const std::vector<std::pair<std::string, std::string>> &rhs) {
+				for (const std::pair<std::string, std::string> &definition : lhs)
+				{
+					const auto it = std::find_if(rhs.cbegin(), rhs.cend(),
+						[&definition](const std::pair<std::string, std::string> &other) { return other.first == definition.first; });
+					if (it == rhs.cend() || it->second != definition.second)
+						changed_definitions.push_back(definition.first);
+				}
+			};
+
+			static const std::vector<std::pair<std::string, std::string>> s_empty_definitions;
+			for (const auto &[scope, definitions] : preset_preprocessor_definitions)
+			{
+				const auto previous_it = _preset_preprocessor_definitions.find(scope);
+				const std::vector<std::pair<std::string, std::string>> &previous_definitions = previous_it != _preset_preprocessor_definitions.end() ? previous_it->second : s_empty_definitions;
+				diff_definitions(definitions, previous_definitions);
+				diff_definitions(previous_definitions, definitions);
+			}
+			for (const auto &[scope, definitions] : _preset_preprocessor_definitions)
+				if (preset_preprocessor_definitions.find(scope) == preset_preprocessor_definitions.end())
+					diff_definitions(definitions, s_empty_definitions);
+
+			std::sort(changed_definitions.begin(), changed_definitions.end());
+			changed_definitions.erase(std::unique(changed_definitions.begin(), changed_definitions.end()), changed_definitions.end());
+
 			_preset_preprocessor_definitions = std::move(preset_preprocessor_definitions);
-			reload_effects();
-			return; // Preset values are loaded in 'update_effects' during effect loading
+
+			if (std::find(_reload_required_effects.cbegin(), _reload_required_effects.cend(), _effects.size()) == _reload_required_effects.cend())
+			{
+				for (size_t effect_index = 0; effect_index < _effects.size(); ++effect_index)
+				{
+					const effect &effect = _effects[effect_index];
+
+					// Effects that failed to compile may start compiling with the changed definitions, so reload them as well
+					if (effect.compiled && std::none_of(changed_definitions.cbegin(), changed_definitions.cend(),
+							[&effect](const std::string &definition_name) { return std::binary_search(effect.used_definitions.cbegin(), effect.used_definitions.cend(), definition_name); }))
+						continue;
+
+					if (std::find(_reload_required_effects.cbegin(), _reload_required_effects.cend(), effect_index) == _reload_required_effects.cend())
+						_reload_required_effects.push_back(effect_index);
+				}
+			}
+
+			// Fall through, so that preset values are still applied to all effects that are not scheduled for a reload
 		}
 
-		if (std::find_if(technique_list.cbegin(), technique_list.cend(),
-				[this](const std::string &technique_name) {
-					const size_t at_pos = technique_name.find('@');
-					if (at_pos == std::string::npos)
-						return true;
-					const auto it = std::find_if(_effects.cbegin(), _effects.cend(),
-						[effect_name = std::filesystem::u8path(technique_name.substr(at_pos + 1))](const effect &effect) {
-							return effect_name == effect.source_file.filename();
-						});
-					return it != _effects.cend() && it->skipped;
-				}) != technique_list.cend())
+		// Load any effects that were skipped but the new preset references techniques from, keeping the effects both presets have in common alive
+		if (std::find(_reload_required_effects.cbegin(), _reload_required_effects.cend(), _effects.size()) == _reload_required_effects.cend())
 		{
-			reload_effects();
-			return;
+			for (const std::string &technique_name : technique_list)
+			{
+				const size_t at_pos = technique_name.find('@');
+				if (at_pos == std::string::npos)
+				{
+					// Cannot tell which effect this technique belongs to, so have to fall back to loading all skipped effects to find it
+					if (std::any_of(_effects.cbegin(), _effects.cend(), [](const effect &effect) { return effect.skipped; }))
+					{
+						reload_effects();
+						return;
+					}
+					continue;
+				}
+
+				const auto it = std::find_if(_effects.cbegin(), _effects.cend(),
+					[effect_name = std::filesystem::u8path(technique_name.substr(at_pos + 1))](const effect &effect) {
+						return effect_name == effect.source_file.filename();
+					});
+				if (it == _effects.cend() || !it->skipped)
+					continue;
+
+				if (const size_t effect_index = static_cast<size_t>(std::distance(_effects.cbegin(), it));
+					std::find(_reload_required_effects.cbegin(), _reload_required_effects.cend(), effect_index) == _reload_required_effects.cend())
+					_reload_required_effects.push_back(effect_index);
+			}
 		}
 	}
 
@@ -1207,8 +1679,20 @@ void reshade::runtime::load_current_preset()
 	if (_is_in_preset_transition && transition_ms_left <= 0)
 		_is_in_preset_transition = false;
 
-	for (effect &effect : _effects)
+	// Pre-resolve the transition target values below when it is safe to reference all effects, so that subsequent frames of the transition can take the fast path above
+	_preset_transition_values.clear();
+	const bool build_transition_values = _is_in_preset_transition && !partial_apply &&
+		_reload_remaining_effects == std::numeric_limits<size_t>::max() && _reload_required_effects.empty();
+	_preset_transition_values_valid = build_transition_values;
+
+	for (size_t effect_index = 0; effect_index < _effects.size(); ++effect_index)
 	{
+		// Worker threads may still be writing to the remaining effects, so only touch those that were compiled with priority
+		if (partial_apply && !std::binary_search(_reload_priority_effect_indices.cbegin(), _reload_priority_effect_indices.cend(), effect_index))
+			continue;
+
+		effect &effect = _effects[effect_index];
+
 		const std::string effect_name = effect.source_file.filename().u8string();
 
 		for (uniform &variable : effect.uniforms)
@@ -1246,6 +1730,13 @@ void reshade::runtime::load_current_preset()
 				get_uniform_value(variable, values.as_float, variable.type.components());
 				values_old = values;
 				preset.get(effect_name, variable.name, values.as_float);
+				if (build_transition_values)
+				{
+					preset_transition_value &transition_value = _preset_transition_values.emplace_back();
+					transition_value.effect_index = effect_index;
+					transition_value.uniform_index = static_cast<size_t>(&variable - effect.uniforms.data());
+					std::memcpy(transition_value.value, values.as_float, sizeof(transition_value.value));
+				}
 				if (_is_in_preset_transition)
 				{
 					// Perform smooth transition on floating point values
@@ -1263,6 +1754,10 @@ void reshade::runtime::load_current_preset()
 
 	for (technique &tech : _techniques)
 	{
+		// Do not enable techniques of effects that were not applied above, they are enabled again once the reload completed and preset values were applied to them
+		if (partial_apply && !std::binary_search(_reload_priority_effect_indices.cbegin(), _reload_priority_effect_indices.cend(), tech.effect_index))
+			continue;
+
 		const std::string unique_name = tech.name + '@' + _effects[tech.effect_index].source_file.filename().u8string();
 
 		// Ignore preset if "enabled" annotation is set
@@ -1276,6 +1771,10 @@ void reshade::runtime::load_current_preset()
 		if (!preset.get({}, "Key" + unique_name, tech.toggle_key_data) &&
 			!preset.get({}, "Key" + tech.name, tech.toggle_key_data))
 			std::memset(tech.toggle_key_data, 0, sizeof(tech.toggle_key_data));
+
+		if (!preset.get({}, "RenderScale" + unique_name, tech.render_scale))
+			tech.render_scale = 1.0f;
+		tech.render_scale = std::max(0.25f, std::min(tech.render_scale, 1.0f));
 	}
 
 	// Reverse queue so that effects are enabled in the order they are defined in the preset (since the queue is worked from back to front)
@@ -1313,11 +1812,36 @@ void reshade::runtime::save_current_preset() const
 			preset.set({}, "Key" + unique_name, tech.toggle_key_data);
 		else
 			preset.remove_key({}, "Key" + unique_name);
+
+		if (tech.render_scale != 1.0f)
+			preset.set({}, "RenderScale" + unique_name, tech.render_scale);
+		else
+			preset.remove_key({}, "RenderScale" + unique_name);
 	}
 
 	if (preset.has({}, "TechniqueSorting") || !std::equal(technique_list.cbegin(), technique_list.cend(), sorted_technique_list.cbegin()))
 		preset.set({}, "TechniqueSorting", std::move(sorted_technique_list));
 
+	// Preserve entries of techniques that belong to effects which are not loaded (e.g. because they were skipped and are still scheduled for loading after a preset switch), so that their enabled state is not lost from the preset
+	if (std::vector<std::string> prev_technique_list;
+		preset.get({}, "Techniques", prev_technique_list))
+	{
+		for (std::string &technique_name : prev_technique_list)
+		{
+			const size_t at_pos = technique_name.find('@');
+			if (at_pos == std::string::npos)
+				continue;
+
+			const auto it = std::find_if(_effects.cbegin(), _effects.cend(),
+				[effect_name = std::filesystem::u8path(technique_name.substr(at_pos + 1))](const effect &effect) {
+					return effect_name == effect.source_file.filename();
+				});
+			if (it != _effects.cend() && it->skipped &&
+				std::find(technique_list.cbegin(), technique_list.cend(), technique_name) == technique_list.cend())
+				technique_list.push_back(std::move(technique_name));
+		}
+	}
+
 	preset.set({}, "Techniques", std::move(technique_list));
 
 	if (const auto preset_it = _preset_preprocessor_definitions.find({});
@@ -1457,32 +1981,130 @@ bool reshade::runtime::switch_to_next_preset(std::filesystem::path filter_path,
 	return true;
 }
 
-bool reshade::runtime::load_effect(const std::filesystem::path &source_file, const ini_file &preset, size_t effect_index, bool force_load, bool preprocess_required)
+/// <summary>
+/// Checks whether the contents of a texture provably do not carry over between technique invocations, meaning every technique referencing it writes it as a cleared render target before any read.
+/// Only such textures can safely be aliased between effects without an explicit "pooled" annotation, since anything else (history buffers, look-up textures, ...) may rely on its contents being preserved.
+/// </summary>
+static bool is_transient_texture(const reshadefx::effect_module &module, const reshadefx::texture &tex)
 {
-	const std::chrono::high_resolution_clock::time_point time_load_started = std::chrono::high_resolution_clock::now();
+	// Textures initialized from an image file have contents that need to be preserved
+	if (std::find_if(tex.annotations.cbegin(), tex.annotations.cend(),
+			[](const reshadefx::annotation &annotation) { return annotation.name == "source"; }) != tex.annotations.cend())
+		return false;
 
-	// Generate a unique string identifying this effect
-	std::string attributes;
-	attributes += "app=" + g_target_executable_path.stem().u8string() + ';';
-	attributes += "width=" + std::to_string(_effect_width) + ';';
-	attributes += "height=" + std::to_string(_effect_height) + ';';
-	attributes += "color_space=" + std::to_string(static_cast<uint32_t>(_back_buffer_color_space)) + ';';
-	attributes += "color_bit_depth=" + std::to_string(api::format_bit_depth(_effect_color_format)) + ';';
-	attributes += "version=" + std::to_string(VERSION_MAJOR * 10000 + VERSION_MINOR * 100 + VERSION_REVISION) + ';';
-	attributes += "performance_mode=" + std::string(_performance_mode ? "1" : "0") + ';';
-	attributes += "vendor=" + std::to_string(_vendor_id) + ';';
+	bool referenced = false;
+
+	for (const reshadefx::technique &technique_info : module.techniques)
+	{
+		bool cleared = false;
+
+		for (const reshadefx::pass &pass_info : technique_info.passes)
+		{
+			const bool sampled = std::find_if(pass_info.texture_bindings.cbegin(), pass_info.texture_bindings.cend(),
+				[&module, &tex](const reshadefx::texture_binding &binding) { return module.samplers[binding.index].texture_name == tex.unique_name; }) != pass_info.texture_bindings.cend();
+			// Unordered access may only write the texture partially, so treat it like a read
+			const bool storage_bound = std::find_if(pass_info.storage_bindings.cbegin(), pass_info.storage_bindings.cend(),
+				[&module, &tex](const reshadefx::storage_binding &binding) { return module.storages[binding.index].texture_name == tex.unique_name; }) != pass_info.storage_bindings.cend();
+
+			if ((sampled || storage_bound) && !cleared)
+				return false; // Texture is read before it was overwritten in this technique, so contents from a previous technique are observable
+			referenced |= sampled || storage_bound;
+
+			if (std::find(std::begin(pass_info.render_target_names), std::end(pass_info.render_target_names), tex.unique_name) != std::end(pass_info.render_target_names))
+			{
+				referenced = true;
+
+				// Only a cleared render target guarantees that stale contents can never show through (blending or partial geometry coverage would otherwise read them)
+				if (!cleared && !pass_info.clear_render_targets)
+					return false;
+				cleared = true;
+			}
+		}
+	}
+
+	return referenced;
+}
+
+// Hash used for effect cache keys, which uses the hardware CRC32 instructions where available, since these walk the attribute string many times faster than the byte-wise generic string hash
+static size_t compute_cache_hash(const std::string &data)
+{
+	static const bool has_sse42 = []() {
+		int cpu_info[4] = {};
+		__cpuid(cpu_info, 1);
+		return (cpu_info[2] & (1 << 20)) != 0;
+	}();
+
+	if (has_sse42)
+	{
+		const uint8_t *p = reinterpret_cast<const uint8_t *>(data.data());
+		size_t size = data.size();
+#ifdef _WIN64
+		uint64_t crc = 0xFFFFFFFF;
+		for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), p += sizeof(uint64_t))
+		{
+			uint64_t value;
+			std::memcpy(&value, p, sizeof(value));
+			crc = _mm_crc32_u64(crc, value);
+		}
+#else
+		// The 64-bit variant of the instruction is not available in 32-bit builds
+		uint32_t crc = 0xFFFFFFFF;
+		for (; size >= sizeof(uint32_t); size -= sizeof(uint32_t), p += sizeof(uint32_t))
+		{
+			uint32_t value;
+			std::memcpy(&value, p, sizeof(value));
+			crc = _mm_crc32_u32(crc, value);
+		}
+#endif
+		for (; size != 0; size--, p++)
+			crc = _mm_crc32_u8(static_cast<uint32_t>(crc), *p);
+		return static_cast<size_t>(crc ^ 0xFFFFFFFF);
+	}
+
+	return std::hash<std::string>()(data);
+}
+
+bool reshade::runtime::load_effect(const std::filesystem::path &source_file, const ini_file &preset, size_t effect_index, bool force_load, bool preprocess_required, bool cache_only)
+{
+	const trace::scoped_event trace_scope("load_effect");
+
+	const std::chrono::high_resolution_clock::time_point time_load_started = std::chrono::high_resolution_clock::now();
+
+	// Generate a unique string identifying this effect
+	std::string attributes;
+	attributes += "app=" + g_target_executable_path.stem().u8string() + ';';
+	attributes += "width=" + std::to_string(_effect_width) + ';';
+	attributes += "height=" + std::to_string(_effect_height) + ';';
+	attributes += "color_space=" + std::to_string(static_cast<uint32_t>(_back_buffer_color_space)) + ';';
+	attributes += "color_bit_depth=" + std::to_string(api::format_bit_depth(_effect_color_format)) + ';';
+	attributes += "version=" + std::to_string(VERSION_MAJOR * 10000 + VERSION_MINOR * 100 + VERSION_REVISION) + ';';
+	attributes += "performance_mode=" + std::string(_performance_mode ? "1" : "0") + ';';
+	attributes += "vendor=" + std::to_string(_vendor_id) + ';';
 	attributes += "device=" + std::to_string(_device_id) + ';';
 
 	const std::string effect_name = source_file.filename().u8string();
 
 	std::vector<std::pair<std::string, std::string>> preprocessor_definitions = _global_preprocessor_definitions;
 	// Insert preset preprocessor definitions before global ones, so that if there are duplicates, the preset ones are used (since 'add_macro_definition' succeeds only for the first occurance)
-	if (const auto preset_it = _preset_preprocessor_definitions.find({});
-		preset_it != _preset_preprocessor_definitions.end())
-		preprocessor_definitions.insert(preprocessor_definitions.begin(), preset_it->second.cbegin(), preset_it->second.cend());
-	if (const auto preset_it = _preset_preprocessor_definitions.find(effect_name);
-		preset_it != _preset_preprocessor_definitions.end())
-		preprocessor_definitions.insert(preprocessor_definitions.begin(), preset_it->second.cbegin(), preset_it->second.cend());
+	if (cache_only)
+	{
+		// The preset being compiled for is not the active one, so read its definitions from the preset file rather than from the applied state
+		std::vector<std::pair<std::string, std::string>> preset_definitions;
+		if (preset.get({}, "PreprocessorDefinitions", preset_definitions))
+			preprocessor_definitions.insert(preprocessor_definitions.begin(), preset_definitions.cbegin(), preset_definitions.cend());
+		preset_definitions.clear();
+		if (preset.get(effect_name, "PreprocessorDefinitions", preset_definitions))
+			preprocessor_definitions.insert(preprocessor_definitions.begin(), preset_definitions.cbegin(), preset_definitions.cend());
+	}
+	else
+	{
+		if (const auto preset_it = _preset_preprocessor_definitions.find({});
+			preset_it != _preset_preprocessor_definitions.end())
+			preprocessor_definitions.insert(preprocessor_definitions.begin(), preset_it->second.cbegin(), preset_it->second.cend());
+		if (const auto preset_it = _preset_preprocessor_definitions.find(effect_name);
+			preset_it != _preset_preprocessor_definitions.end())
+			preprocessor_definitions.insert(preprocessor_definitions.begin(), preset_it->second.cbegin(), preset_it->second.cend());
+	}
 
 #if RESHADE_ADDON
 	std::vector<std::string> addon_definitions;
@@ -1544,9 +2166,11 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 		}
 	}
 
-	effect &effect = _effects[effect_index];
+	// When only priming the effect cache for a different preset, compile into a scratch effect instead of a slot in the effects list, so none of the current state is touched (see 'precompile_presets')
+	effect scratch_effect;
+	effect &effect = cache_only ? scratch_effect : _effects[effect_index];
 
-	const size_t source_hash = std::hash<std::string>()(attributes);
+	const size_t source_hash = compute_cache_hash(attributes);
 	if (source_file != effect.source_file || source_hash != effect.source_hash)
 	{
 		// Source hash has changed, reset effect and load from scratch, rather than updating
@@ -1573,7 +2197,7 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 
 			if (effect.skipped)
 			{
-				if (_reload_remaining_effects != 0 && _reload_remaining_effects != std::numeric_limits<size_t>::max())
+				if (!cache_only && _reload_remaining_effects != 0 && _reload_remaining_effects != std::numeric_limits<size_t>::max())
 					_reload_remaining_effects--;
 				return false;
 			}
@@ -1669,6 +2293,14 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 
 			std::sort(effect.definitions.begin(), effect.definitions.end());
 
+			// Keep track of all queried definition names (not just the defined ones), since these determine whether an external definition change affects this effect
+			effect.used_definitions = pp.used_macro_names();
+			std::sort(effect.used_definitions.begin(), effect.used_definitions.end());
+
+			// Write queried definition names to the cached source as well, so they survive warm loads
+			for (const std::string &used_definition : effect.used_definitions)
+				source = "// ?" + used_definition + '\n' + source;
+
 			// Do not cache if any special pragma directives were used, to ensure they are read again next time
 			if (!skip_optimization)
 				source_cached = save_effect_cache(source_file.stem().u8string() + '-' + std::to_string(_renderer_id) + '-' + std::to_string(source_hash), "i", source);
@@ -1694,6 +2326,10 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 				{
 					code_preamble += source.substr(offset, (next + 1) - offset);
 				}
+				else if (source[offset] == '?')
+				{
+					effect.used_definitions.push_back(source.substr(offset + 1, next - (offset + 1)));
+				}
 				else if (const size_t equals_index = source.find('=', offset);
 					equals_index != std::string::npos)
 				{
@@ -1704,102 +2340,192 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 			}
 
 			std::sort(effect.definitions.begin(), effect.definitions.end());
+			std::sort(effect.used_definitions.begin(), effect.used_definitions.end());
 		}
 	}
 
 	std::unique_ptr<reshadefx::codegen> codegen;
+	std::unordered_map<std::string, std::string> entry_point_code;
+	// The serialized module additionally depends on the code generation options, so include them in the cache ID alongside the source hash
+	const std::string module_cache_id =
+		source_file.stem().u8string() + '-' + std::to_string(_renderer_id) + '-' +
+		std::to_string((_performance_mode ? 1u : 0u) | (_no_debug_info ? 2u : 0u) | (_relaxed_precision ? 4u : 0u)) + '-' + std::to_string(source_hash);
 	if (!effect.compiled && !source.empty())
 	{
-		unsigned shader_model;
-		if (_renderer_id == 0x9000)
-			shader_model = 30; // D3D9
-		else if (_renderer_id < 0xa100)
-			shader_model = 40; // D3D10 (including feature level 9)
-		else if (_renderer_id < 0xb000)
-			shader_model = 41; // D3D10.1
-		else if (_renderer_id < 0xc000)
-			shader_model = 50; // D3D11
+		// Try to restore the module from a serialized representation in the cache first, which skips the entire parse and code generation step on warm loads
+		if (std::string module_data;
+			!preprocess_required && load_effect_cache(module_cache_id, "mod", module_data) &&
+			reshadefx::deserialize_effect_module(module_data, effect.module, effect.generated_code, entry_point_code))
+		{
+			effect.compiled = true;
+			effect.module_cache_id = module_cache_id;
+
+			++_effect_cache_hits;
+		}
 		else
-			shader_model = 51; // D3D12
+		{
+			++_effect_cache_misses;
+
+			unsigned shader_model;
+			if (_renderer_id == 0x9000)
+				shader_model = 30; // D3D9
+			else if (_renderer_id < 0xa100)
+				shader_model = 40; // D3D10 (including feature level 9)
+			else if (_renderer_id < 0xb000)
+				shader_model = 41; // D3D10.1
+			else if (_renderer_id < 0xc000)
+				shader_model = 50; // D3D11
+			else
+				shader_model = 51; // D3D12
+
+			if ((_renderer_id & 0xF0000) == 0)
+				codegen.reset(reshadefx::create_codegen_hlsl(shader_model, !_no_debug_info, _performance_mode));
+			else if (_renderer_id < 0x20000)
+				codegen.reset(reshadefx::create_codegen_glsl(false, !_no_debug_info, _performance_mode, false, true));
+			else // Vulkan uses SPIR-V input
+				codegen.reset(reshadefx::create_codegen_spirv(true, !_no_debug_info, _performance_mode, false, false, _relaxed_precision));
+
+			reshadefx::parser parser;
 
-		if ((_renderer_id & 0xF0000) == 0)
-			codegen.reset(reshadefx::create_codegen_hlsl(shader_model, !_no_debug_info, _performance_mode));
-		else if (_renderer_id < 0x20000)
-			codegen.reset(reshadefx::create_codegen_glsl(false, !_no_debug_info, _performance_mode, false, true));
-		else // Vulkan uses SPIR-V input
-			codegen.reset(reshadefx::create_codegen_spirv(true, !_no_debug_info, _performance_mode, false, false));
+			// Compile the pre-processed source code (try the compile even if the preprocessor step failed to get additional error information)
+			effect.compiled = parser.parse(std::move(source), codegen.get());
 
-		reshadefx::parser parser;
+			// Append parser errors to the error list
+			effect.errors  += parser.errors();
 
-		// Compile the pre-processed source code (try the compile even if the preprocessor step failed to get additional error information)
-		effect.compiled = parser.parse(std::move(source), codegen.get());
+			// Write result to effect module
+			effect.module = codegen->module();
+			if (_device->get_api() != api::device_api::vulkan)
+				effect.generated_code = codegen->finalize_code();
 
-		// Append parser errors to the error list
-		effect.errors  += parser.errors();
+			if (effect.compiled)
+			{
+				// Finalize the code for all entry points now, so that a serialized representation of the module can be written to the cache for subsequent loads
+				entry_point_code.reserve(effect.module.entry_points.size());
+				for (const std::pair<std::string, reshadefx::shader_type> &entry_point : effect.module.entry_points)
+					entry_point_code[entry_point.first] = codegen->finalize_code_for_entry_point(entry_point.first);
 
-		// Write result to effect module
-		effect.module = codegen->module();
-		if (_device->get_api() != api::device_api::vulkan)
-			effect.generated_code = codegen->finalize_code();
+				if (!preprocess_required)
+				{
+					std::string module_data;
+					reshadefx::serialize_effect_module(effect.module, effect.generated_code, entry_point_code, module_data);
+					if (save_effect_cache(module_cache_id, "mod", module_data))
+						effect.module_cache_id = module_cache_id;
+				}
+			}
+		}
 
 		if (effect.compiled)
 		{
 			effect.uniforms.clear();
+			effect.special_uniforms.clear();
+			effect.uniform_index.clear();
 
-			// Create space for all variables (aligned to 16 bytes)
+			// Create space for all variables (aligned to 16 bytes) and mark it all dirty, so that the initial values are uploaded to the constant buffer
 			effect.uniform_data_storage.resize((effect.module.total_uniform_size + 15) & ~15);
+			effect.uniform_data_dirty_begin = 0;
+			effect.uniform_data_dirty_end = std::numeric_limits<size_t>::max();
 
-			for (uniform variable : effect.module.uniforms)
+			// No uniform variables are needed when only priming the effect cache
+			if (!cache_only)
 			{
-				variable.effect_index = effect_index;
-
-				const std::string_view special = variable.annotation_as_string("source");
-				if (special.empty()) /* Ignore if annotation is missing */
-					variable.special = special_uniform::none;
-				else if (special == "frametime")
-					variable.special = special_uniform::frame_time;
-				else if (special == "framecount")
-					variable.special = special_uniform::frame_count;
-				else if (special == "random")
-					variable.special = special_uniform::random;
-				else if (special == "pingpong")
-					variable.special = special_uniform::ping_pong;
-				else if (special == "date")
-					variable.special = special_uniform::date;
-				else if (special == "timer")
-					variable.special = special_uniform::timer;
-				else if (special == "key")
-					variable.special = special_uniform::key;
-				else if (special == "mousepoint")
-					variable.special = special_uniform::mouse_point;
-				else if (special == "mousedelta")
-					variable.special = special_uniform::mouse_delta;
-				else if (special == "mousebutton")
-					variable.special = special_uniform::mouse_button;
-				else if (special == "mousewheel")
-					variable.special = special_uniform::mouse_wheel;
-				else if (special == "ui_open" || special == "overlay_open")
-					variable.special = special_uniform::overlay_open;
-				else if (special == "ui_active" || special == "overlay_active")
-					variable.special = special_uniform::overlay_active;
-				else if (special == "ui_hovered" || special == "overlay_hovered")
-					variable.special = special_uniform::overlay_hovered;
-				else if (special == "screenshot")
-					variable.special = special_uniform::screenshot;
-				else
-					variable.special = special_uniform::unknown;
+				for (uniform variable : effect.module.uniforms)
+				{
+					variable.effect_index = effect_index;
+
+					const std::string_view special = variable.annotation_as_string("source");
+					if (special.empty()) /* Ignore if annotation is missing */
+						variable.special = special_uniform::none;
+					else if (special == "frametime")
+						variable.special = special_uniform::frame_time;
+					else if (special == "framecount")
+						variable.special = special_uniform::frame_count;
+					else if (special == "random")
+						variable.special = special_uniform::random;
+					else if (special == "pingpong")
+						variable.special = special_uniform::ping_pong;
+					else if (special == "date")
+						variable.special = special_uniform::date;
+					else if (special == "timer")
+						variable.special = special_uniform::timer;
+					else if (special == "key")
+						variable.special = special_uniform::key;
+					else if (special == "mousepoint")
+						variable.special = special_uniform::mouse_point;
+					else if (special == "mousedelta")
+						variable.special = special_uniform::mouse_delta;
+					else if (special == "mousebutton")
+						variable.special = special_uniform::mouse_button;
+					else if (special == "mousewheel")
+						variable.special = special_uniform::mouse_wheel;
+					else if (special == "ui_open" || special == "overlay_open")
+						variable.special = special_uniform::overlay_open;
+					else if (special == "ui_active" || special == "overlay_active")
+						variable.special = special_uniform::overlay_active;
+					else if (special == "ui_hovered" || special == "overlay_hovered")
+						variable.special = special_uniform::overlay_hovered;
+					else if (special == "screenshot")
+						variable.special = special_uniform::screenshot;
+					else if (special == "viewcount")
+						variable.special = special_uniform::view_count;
+					else
+						variable.special = special_uniform::unknown;
 
-				// Copy initial data into uniform storage area
-				reset_uniform_value(variable);
+					// Copy initial data into uniform storage area
+					reset_uniform_value(variable);
+
+					// Remember this variable if it has to be updated every frame and resolve its annotation parameters up front, so that the update does not have to scan the entire uniform list or its annotations (see 'update_effects')
+					if (variable.special != special_uniform::none && variable.special != special_uniform::unknown)
+					{
+						special_uniform_data &special_data = effect.special_uniforms.emplace_back();
+						special_data.special = variable.special;
+						special_data.uniform_index = effect.uniforms.size();
+
+						special_data.keycode = variable.annotation_as_int("keycode");
+						const std::string_view mode = variable.annotation_as_string("mode");
+						special_data.toggle = mode == "toggle" || variable.annotation_as_int("toggle");
+						special_data.press = mode == "press";
+
+						if (variable.special == special_uniform::random)
+						{
+							special_data.min_int = variable.annotation_as_int("min", 0, 0);
+							special_data.max_int = variable.annotation_as_int("max", 0, RAND_MAX);
+						}
+						else if (variable.special == special_uniform::ping_pong)
+						{
+							special_data.min = variable.annotation_as_float("min", 0, 0.0f);
+							special_data.max = variable.annotation_as_float("max", 0, 1.0f);
+						}
+						else
+						{
+							special_data.min = variable.annotation_as_float("min");
+							special_data.max = variable.annotation_as_float("max");
+						}
+
+						special_data.step[0] = variable.annotation_as_float("step", 0);
+						special_data.step[1] = variable.annotation_as_float("step", 1);
+						special_data.smoothing = variable.annotation_as_float("smoothing");
+					}
+
+					effect.uniforms.push_back(std::move(variable));
+				}
 
-				effect.uniforms.push_back(std::move(variable));
+				// Build the name index once all uniform variables were added, so that lookups by name do not have to scan the entire list
+				effect.uniform_index.reserve(effect.uniforms.size());
+				for (size_t variable_index = 0; variable_index < effect.uniforms.size(); ++variable_index)
+					effect.uniform_index.emplace(effect.uniforms[variable_index].name, variable_index);
 			}
 
 			// Fill all specialization constants with values from the current preset
 			if (_performance_mode)
 			{
+				effect.spec_constant_values.clear();
+
 				for (reshadefx::uniform &constant : effect.module.spec_constants)
 				{
+					// Remember the default value from the effect source, so that the value a different preset would produce can be computed without reloading (see 'load_current_preset')
+					const reshadefx::constant default_value = constant.initializer_value;
+
 					switch (constant.type.base)
 					{
 					case reshadefx::type::t_int:
@@ -1814,6 +2540,8 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 						break;
 					}
 
+					effect.spec_constant_values.push_back({ default_value, constant.initializer_value });
+
 					// Check if this is a split specialization constant and move data accordingly
 					if (constant.type.is_scalar() && constant.offset != 0)
 						constant.initializer_value.as_uint[0] = constant.initializer_value.as_uint[constant.offset];
@@ -1858,7 +2586,7 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 		{
 			assert(!preprocess_required);
 
-			return load_effect(source_file, preset, effect_index, force_load, true);
+			return load_effect(source_file, preset, effect_index, force_load, true, cache_only);
 		}
 	}
 
@@ -1866,324 +2594,196 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 	{
 		if (effect.assembly.empty())
 		{
-			// Compile shader modules
+			effect.code_preamble = std::move(code_preamble);
+			effect.skip_optimization = skip_optimization;
+
+			// Determine the techniques enabled in the preset, so that only the entry points they reference are compiled now (the remaining ones are compiled on demand when a technique using them is enabled, see 'create_effect')
+			std::vector<std::string> technique_list;
+			preset.get({}, "Techniques", technique_list);
+
+			const auto is_technique_enabled = [&technique_list, &effect_name](const reshadefx::technique &tech) {
+				// Ignore preset if "enabled" annotation is set (see 'load_current_preset')
+				if (const auto it = std::find_if(tech.annotations.cbegin(), tech.annotations.cend(),
+						[](const reshadefx::annotation &annotation) { return annotation.name == "enabled"; });
+					it != tech.annotations.cend() && (it->type.is_integral() ? it->value.as_int[0] : static_cast<int>(it->value.as_float[0])) != 0)
+					return true;
+				return
+					std::find(technique_list.cbegin(), technique_list.cend(), tech.name + '@' + effect_name) != technique_list.cend() ||
+					std::find(technique_list.cbegin(), technique_list.cend(), tech.name) != technique_list.cend();
+			};
+
+			// Compile shader modules for all entry points referenced by enabled techniques
 			for (const std::pair<std::string, reshadefx::shader_type> &entry_point : effect.module.entry_points)
 			{
-				if (entry_point.second == reshadefx::shader_type::compute && !_device->check_capability(api::device_caps::compute_shader))
-				{
-					effect.errors += "error: " + entry_point.first + ": compute shaders are not supported in D3D9/D3D10\n";
-					effect.compiled = false;
-					break;
-				}
-
-				std::string &cso = effect.assembly[entry_point.first];
-				std::string &cso_text = effect.assembly_text[entry_point.first];
-
-				if ((_renderer_id & 0xF0000) == 0)
+				bool referenced = false;
+				for (const reshadefx::technique &tech : effect.module.techniques)
 				{
-					assert(_d3d_compiler_module != nullptr);
-
-					// Copy string, since this has to be repeated for every entry point
-					std::string hlsl = code_preamble;
-
-					if (_renderer_id == 0x9000)
-					{
-						// Create SEMANTIC_PIXEL_SIZE constants
-						hlsl += "#define COLOR_PIXEL_SIZE 1.0 / " + std::to_string(_effect_width) + ", 1.0 / " + std::to_string(_effect_height) + '\n';
-
-						uint32_t semantic_index = 0;
-						for (const reshadefx::texture &tex : effect.module.textures)
-						{
-							if (tex.semantic.empty() || tex.semantic == "COLOR")
-								continue;
-
-							semantic_index++;
-							assert((effect.uniform_data_storage.size() / 16) <= (255 - semantic_index));
-
-							// Avoid duplicate declarations if the semantic was used multiple times
-							if (hlsl.find(tex.semantic + "_PIXEL_SIZE") == std::string::npos)
-								hlsl += "uniform float2 " + tex.semantic + "_PIXEL_SIZE : register(c" + std::to_string(255 - semantic_index) + ");\n";
-						}
-					}
-
-					hlsl += "#line 1\n"; // Reset line number, so it matches what is shown when viewing the generated code
-					hlsl += codegen->finalize_code_for_entry_point(entry_point.first);
-
-					std::string profile;
-					switch (entry_point.second)
-					{
-					case reshadefx::shader_type::vertex:
-						profile = "vs";
-						break;
-					case reshadefx::shader_type::pixel:
-						profile = "ps";
-						break;
-					case reshadefx::shader_type::compute:
-						profile = "cs";
-						break;
-					}
+					if (std::find_if(tech.passes.cbegin(), tech.passes.cend(),
+							[&entry_point](const reshadefx::pass &pass) {
+								return pass.vs_entry_point == entry_point.first || pass.ps_entry_point == entry_point.first || pass.cs_entry_point == entry_point.first;
+							}) == tech.passes.cend())
+						continue;
 
-					switch (_renderer_id)
+					if (is_technique_enabled(tech))
 					{
-					default:
-					case D3D_FEATURE_LEVEL_11_0:
-						profile += "_5_0";
-						break;
-					case D3D_FEATURE_LEVEL_10_1:
-						profile += "_4_1";
-						break;
-					case D3D_FEATURE_LEVEL_10_0:
-						profile += "_4_0";
-						break;
-					case D3D_FEATURE_LEVEL_9_1:
-					case D3D_FEATURE_LEVEL_9_2:
-						profile += "_4_0_level_9_1";
+						referenced = true;
 						break;
-					case D3D_FEATURE_LEVEL_9_3:
-						profile += "_4_0_level_9_3";
-						break;
-					case 0x9000:
-						profile += "_3_0";
-						break;
-					}
-
-					UINT compile_flags = 0;
-					if (skip_optimization)
-						compile_flags |= D3DCOMPILE_SKIP_OPTIMIZATION;
-					else if (_performance_mode)
-						compile_flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
-					if (_renderer_id >= D3D_FEATURE_LEVEL_10_0)
-						compile_flags |= D3DCOMPILE_ENABLE_STRICTNESS;
-#ifndef NDEBUG
-					compile_flags |= D3DCOMPILE_DEBUG;
-#endif
-
-					std::string hlsl_attributes;
-					hlsl_attributes += "entrypoint=" + entry_point.first + ';';
-					hlsl_attributes += "profile=" + profile + ';';
-					hlsl_attributes += "flags=" + std::to_string(compile_flags) + ';';
-
-					const std::string cache_id =
-						effect.source_file.stem().u8string() + '-' + entry_point.first + '-' + std::to_string(_renderer_id) + '-' +
-						std::to_string(std::hash<std::string_view>()(hlsl_attributes) ^ std::hash<std::string_view>()(hlsl));
-
-					if (!load_effect_cache(cache_id, "cso", cso))
-					{
-						const auto D3DCompile = reinterpret_cast<pD3DCompile>(GetProcAddress(static_cast<HMODULE>(_d3d_compiler_module), "D3DCompile"));
-						assert(D3DCompile != nullptr);
-
-						com_ptr<ID3DBlob> d3d_compiled, d3d_errors;
-						const HRESULT hr = D3DCompile(
-							hlsl.data(), hlsl.size(),
-							nullptr, nullptr, nullptr,
-							entry_point.first.c_str(),
-							profile.c_str(),
-							compile_flags, 0,
-							&d3d_compiled, &d3d_errors);
-
-						std::string d3d_errors_string;
-						if (d3d_errors != nullptr) // Append warnings to the output error string as well
-							d3d_errors_string.assign(static_cast<const char *>(d3d_errors->GetBufferPointer()), d3d_errors->GetBufferSize() - 1); // Subtracting one to not append the null-terminator as well
-						d3d_errors.reset();
-
-						// De-duplicate error lines (D3DCompiler sometimes repeats the same error multiple times)
-						for (size_t line_offset = 0, next_line_offset; (next_line_offset = d3d_errors_string.find('\n', line_offset)) != std::string::npos; line_offset = next_line_offset + 1)
-						{
-							const std::string_view cur_line(d3d_errors_string.data() + line_offset, next_line_offset - line_offset);
-
-							if (const size_t end_offset = d3d_errors_string.find('\n', next_line_offset + 1);
-								end_offset != std::string::npos)
-							{
-								const std::string_view next_line(d3d_errors_string.data() + next_line_offset + 1, end_offset - next_line_offset - 1);
-								if (cur_line == next_line)
-								{
-									d3d_errors_string.erase(next_line_offset, end_offset - next_line_offset);
-									next_line_offset = line_offset - 1;
-								}
-							}
-
-							// Also remove D3DCompiler warnings about 'groupshared' specifier used in VS/PS modules
-							if (cur_line.find("X3579") != std::string_view::npos)
-							{
-								d3d_errors_string.erase(line_offset, next_line_offset + 1 - line_offset);
-								next_line_offset = line_offset - 1;
-							}
-						}
-
-						if (FAILED(hr))
-						{
-							// Add a prefix with the offending entry point name for generic error messages like an out of memory notification
-							if (d3d_errors_string.find("error") == std::string::npos)
-								effect.errors += "error: " + entry_point.first + ": ";
-
-							effect.errors += d3d_errors_string;
-							effect.compiled = false;
-							break;
-						}
-						else
-						{
-							// Append warnings
-							effect.errors += d3d_errors_string;
-						}
-
-						cso.resize(d3d_compiled->GetBufferSize());
-						std::memcpy(cso.data(), d3d_compiled->GetBufferPointer(), cso.size());
-
-						save_effect_cache(cache_id, "cso", cso);
-					}
-
-					if (!load_effect_cache(cache_id, "asm", cso_text))
-					{
-						const auto D3DDisassemble = reinterpret_cast<pD3DDisassemble>(GetProcAddress(static_cast<HMODULE>(_d3d_compiler_module), "D3DDisassemble"));
-						assert(D3DDisassemble != nullptr);
-
-						com_ptr<ID3DBlob> d3d_disassembled;
-						if (SUCCEEDED(D3DDisassemble(cso.data(), cso.size(), 0, nullptr, &d3d_disassembled)))
-							cso_text.assign(static_cast<const char *>(d3d_disassembled->GetBufferPointer()), d3d_disassembled->GetBufferSize() - 1);
-
-						save_effect_cache(cache_id, "asm", cso_text);
 					}
 				}
-				else
-				{
-					cso = codegen->finalize_code_for_entry_point(entry_point.first);
 
-					if (_renderer_id < 0x20000)
-					{
-						cso.insert(std::size("#version 430\n") - 1, code_preamble);
+				if (!referenced)
+				{
+					// Defer compilation of this entry point until a technique referencing it is enabled
+					effect.deferred_entry_point_code.emplace(entry_point.first, std::move(entry_point_code[entry_point.first]));
+					continue;
+				}
 
-						cso_text = cso;
-					}
+				if (!compile_effect_entry_point(effect, entry_point, std::move(entry_point_code[entry_point.first])))
+				{
+					effect.compiled = false;
+					break;
 				}
 			}
 		}
 
-		const std::unique_lock<std::shared_mutex> lock(_reload_mutex);
-
-		for (texture new_texture : effect.module.textures)
+		// Nothing is registered with the runtime when only priming the effect cache
+		if (!cache_only)
 		{
-			new_texture.effect_index = effect_index;
+			const std::unique_lock<std::shared_mutex> lock(_reload_mutex);
 
-			if (!new_texture.semantic.empty() && (new_texture.render_target || new_texture.storage_access))
+			for (texture new_texture : effect.module.textures)
 			{
-				effect.errors += "error: " + new_texture.unique_name + ": texture with a semantic used as a render target or storage\n";
-				effect.compiled = false;
-				break;
-			}
+				new_texture.effect_index = effect_index;
 
-			// Try to share textures with the same name across effects
-			if (const auto existing_texture = std::find_if(_textures.begin(), _textures.end(),
-					[&new_texture](const texture &item) {
-						return item.unique_name == new_texture.unique_name;
-					});
-				existing_texture != _textures.end())
-			{
-				// Cannot share texture if this is a normal one, but the existing one is a reference and vice versa
-				if (new_texture.semantic != existing_texture->semantic)
+				if (!new_texture.semantic.empty() && (new_texture.render_target || new_texture.storage_access))
 				{
-					effect.errors += "error: " + new_texture.unique_name + ": another effect (";
-					effect.errors += _effects[existing_texture->effect_index].source_file.filename().u8string();
-					effect.errors += ") already created a texture with the same name but different semantic\n";
+					effect.errors += "error: " + new_texture.unique_name + ": texture with a semantic used as a render target or storage\n";
 					effect.compiled = false;
 					break;
 				}
 
-				if (new_texture.semantic.empty() && !existing_texture->matches_description(new_texture))
-				{
-					effect.errors += "warning: " + new_texture.unique_name + ": another effect (";
-					effect.errors += _effects[existing_texture->effect_index].source_file.filename().u8string();
-					effect.errors += ") already created a texture with the same name but different dimensions\n";
-				}
-				if (new_texture.semantic.empty() && (existing_texture->annotation_as_string("source") != new_texture.annotation_as_string("source")))
+				// Try to share textures with the same name across effects
+				if (const auto existing_texture = std::find_if(_textures.begin(), _textures.end(),
+						[&new_texture](const texture &item) {
+							return item.unique_name == new_texture.unique_name;
+						});
+					existing_texture != _textures.end())
 				{
-					effect.errors += "warning: " + new_texture.unique_name + ": another effect (";
-					effect.errors += _effects[existing_texture->effect_index].source_file.filename().u8string();
-					effect.errors += ") already created a texture with a different image file\n";
-				}
+					// Cannot share texture if this is a normal one, but the existing one is a reference and vice versa
+					if (new_texture.semantic != existing_texture->semantic)
+					{
+						effect.errors += "error: " + new_texture.unique_name + ": another effect (";
+						effect.errors += _effects[existing_texture->effect_index].source_file.filename().u8string();
+						effect.errors += ") already created a texture with the same name but different semantic\n";
+						effect.compiled = false;
+						break;
+					}
 
-				if (existing_texture->semantic == "COLOR" && api::format_bit_depth(_effect_color_format) != 8)
-				{
-					for (const reshadefx::sampler &sampler_info : effect.module.samplers)
+					if (new_texture.semantic.empty() && !existing_texture->matches_description(new_texture))
+					{
+						effect.errors += "warning: " + new_texture.unique_name + ": another effect (";
+						effect.errors += _effects[existing_texture->effect_index].source_file.filename().u8string();
+						effect.errors += ") already created a texture with the same name but different dimensions\n";
+					}
+					if (new_texture.semantic.empty() && (existing_texture->annotation_as_string("source") != new_texture.annotation_as_string("source")))
+					{
+						effect.errors += "warning: " + new_texture.unique_name + ": another effect (";
+						effect.errors += _effects[existing_texture->effect_index].source_file.filename().u8string();
+						effect.errors += ") already created a texture with a different image file\n";
+					}
+
+					if (existing_texture->semantic == "COLOR" && api::format_bit_depth(_effect_color_format) != 8)
 					{
-						if (sampler_info.srgb && sampler_info.texture_name == new_texture.unique_name)
+						for (const reshadefx::sampler &sampler_info : effect.module.samplers)
 						{
-							effect.errors += "warning: " + sampler_info.unique_name + ": texture does not support sRGB sampling (back buffer format is not RGBA8)\n";
+							if (sampler_info.srgb && sampler_info.texture_name == new_texture.unique_name)
+							{
+								effect.errors += "warning: " + sampler_info.unique_name + ": texture does not support sRGB sampling (back buffer format is not RGBA8)\n";
+							}
 						}
 					}
-				}
 
-				if (std::find(existing_texture->shared.begin(), existing_texture->shared.end(), effect_index) == existing_texture->shared.end())
-					existing_texture->shared.push_back(effect_index);
+					if (std::find(existing_texture->shared.begin(), existing_texture->shared.end(), effect_index) == existing_texture->shared.end())
+						existing_texture->shared.push_back(effect_index);
 
-				// Update render target and storage access flags of the existing shared texture, in case they are used as such in this effect
-				existing_texture->render_target |= new_texture.render_target;
-				existing_texture->storage_access |= new_texture.storage_access;
-				continue;
-			}
+					// Update render target and storage access flags of the existing shared texture, in case they are used as such in this effect
+					existing_texture->render_target |= new_texture.render_target;
+					existing_texture->storage_access |= new_texture.storage_access;
+					continue;
+				}
 
-			if (new_texture.annotation_as_int("pooled") && new_texture.semantic.empty())
-			{
-				// Try to find another pooled texture to share with (and do not share within the same effect)
-				if (const auto existing_texture = std::find_if(_textures.begin(), _textures.end(),
-						[&new_texture](const texture &item) {
-							return item.annotation_as_int("pooled") && std::find(item.shared.begin(), item.shared.end(), new_texture.effect_index) == item.shared.end() && item.matches_description(new_texture);
-						});
-					existing_texture != _textures.end())
+				// Intermediate textures that are overwritten before every read can be aliased between effects even without an explicit "pooled" annotation, since no effect can observe contents another effect left in them
+				new_texture.transient = new_texture.semantic.empty() && !new_texture.annotation_as_int("pooled") && is_transient_texture(effect.module, new_texture);
+
+				if ((new_texture.annotation_as_int("pooled") || new_texture.transient) && new_texture.semantic.empty())
 				{
-					// Overwrite referenced texture in samplers with the pooled one
-					for (reshadefx::sampler &sampler_info : effect.module.samplers)
-						if (sampler_info.texture_name == new_texture.unique_name)
-							sampler_info.texture_name = existing_texture->unique_name;
-					// Overwrite referenced texture in storages with the pooled one
-					for (reshadefx::storage &storage_info : effect.module.storages)
-						if (storage_info.texture_name == new_texture.unique_name)
-							storage_info.texture_name = existing_texture->unique_name;
-					// Overwrite referenced texture in render targets with the pooled one
-					for (reshadefx::technique &technique_info : effect.module.techniques)
+					// Try to find another pooled texture to share with (and do not share within the same effect)
+					// Transient textures are only shared with other transient textures, since explicitly pooled ones may intentionally communicate contents between effects
+					if (const auto existing_texture = std::find_if(_textures.begin(), _textures.end(),
+							[&new_texture](const texture &item) {
+								return (new_texture.transient ? item.transient : item.annotation_as_int("pooled") != 0) && std::find(item.shared.begin(), item.shared.end(), new_texture.effect_index) == item.shared.end() && item.matches_description(new_texture);
+							});
+						existing_texture != _textures.end())
 					{
-						for (reshadefx::pass &pass_info : technique_info.passes)
+						// Overwrite referenced texture in samplers with the pooled one
+						for (reshadefx::sampler &sampler_info : effect.module.samplers)
+							if (sampler_info.texture_name == new_texture.unique_name)
+								sampler_info.texture_name = existing_texture->unique_name;
+						// Overwrite referenced texture in storages with the pooled one
+						for (reshadefx::storage &storage_info : effect.module.storages)
+							if (storage_info.texture_name == new_texture.unique_name)
+								storage_info.texture_name = existing_texture->unique_name;
+						// Overwrite referenced texture in render targets with the pooled one
+						for (reshadefx::technique &technique_info : effect.module.techniques)
 						{
-							std::replace(std::begin(pass_info.render_target_names), std::end(pass_info.render_target_names),
-								new_texture.unique_name, existing_texture->unique_name);
+							for (reshadefx::pass &pass_info : technique_info.passes)
+							{
+								std::replace(std::begin(pass_info.render_target_names), std::end(pass_info.render_target_names),
+									new_texture.unique_name, existing_texture->unique_name);
+							}
 						}
-					}
 
-					if (std::find(existing_texture->shared.cbegin(), existing_texture->shared.cend(), effect_index) == existing_texture->shared.cend())
-						existing_texture->shared.push_back(effect_index);
+						if (std::find(existing_texture->shared.cbegin(), existing_texture->shared.cend(), effect_index) == existing_texture->shared.cend())
+							existing_texture->shared.push_back(effect_index);
 
-					existing_texture->render_target = true;
-					existing_texture->storage_access = true;
-					continue;
+						existing_texture->render_target = true;
+						existing_texture->storage_access = true;
+						continue;
+					}
 				}
-			}
 
-			// This is the first effect using this texture
-			new_texture.shared.push_back(effect_index);
+				// This is the first effect using this texture
+				new_texture.shared.push_back(effect_index);
 
-			_textures.push_back(std::move(new_texture));
-		}
+				_textures.push_back(std::move(new_texture));
+			}
 
-		for (technique new_technique : effect.module.techniques)
-		{
-			new_technique.effect_index = effect_index;
+			for (technique new_technique : effect.module.techniques)
+			{
+				new_technique.effect_index = effect_index;
 
-			new_technique.hidden = new_technique.annotation_as_int("hidden") != 0;
-			new_technique.enabled_in_screenshot = new_technique.annotation_as_int("enabled_in_screenshot", 0, true) != 0;
+				new_technique.hidden = new_technique.annotation_as_int("hidden") != 0;
+				new_technique.enabled_in_screenshot = new_technique.annotation_as_int("enabled_in_screenshot", 0, true) != 0;
 
-			if (new_technique.annotation_as_int("enabled"))
-				enable_technique(new_technique);
+				if (new_technique.annotation_as_int("enabled"))
+					enable_technique(new_technique);
 
-			_techniques.push_back(std::move(new_technique));
-			_technique_sorting.push_back(_techniques.size() - 1);
+				_techniques.push_back(std::move(new_technique));
+				_technique_sorting.push_back(_techniques.size() - 1);
+				effect.technique_index.emplace(_techniques.back().name, _techniques.size() - 1);
+			}
 		}
 	}
 
 	const std::chrono::high_resolution_clock::time_point time_load_finished = std::chrono::high_resolution_clock::now();
 
-	if (_reload_remaining_effects != 0 && _reload_remaining_effects != std::numeric_limits<size_t>::max())
-		_reload_remaining_effects--;
-	else
-		_reload_remaining_effects = 0; // Force effect initialization in 'update_effects'
+	if (!cache_only)
+	{
+		if (_reload_remaining_effects != 0 && _reload_remaining_effects != std::numeric_limits<size_t>::max())
+			_reload_remaining_effects--;
+		else
+			_reload_remaining_effects = 0; // Force effect initialization in 'update_effects'
+	}
 
 	if ( effect.compiled && (effect.preprocessed || source_cached))
 	{
@@ -2195,7 +2795,8 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 	}
 	else
 	{
-		_last_reload_successful = false;
+		if (!cache_only)
+			_last_reload_successful = false;
 
 		if (effect.errors.empty())
 			log::message(log::level::error, "Failed to compile '%s'!", source_file.u8string().c_str());
@@ -2204,50 +2805,257 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 		return false;
 	}
 }
-bool reshade::runtime::create_effect(size_t effect_index)
+bool reshade::runtime::compile_effect_entry_point(effect &effect, const std::pair<std::string, reshadefx::shader_type> &entry_point, std::string entry_point_code)
 {
-	effect &effect = _effects[effect_index];
-
-	// Create textures now, since they are referenced when building samplers below
-	for (texture &tex : _textures)
+	if (entry_point.second == reshadefx::shader_type::compute && !_device->check_capability(api::device_caps::compute_shader))
 	{
-		if (tex.resource != 0 || std::find(tex.shared.cbegin(), tex.shared.cend(), effect_index) == tex.shared.cend())
-			continue;
-
-		if (!create_texture(tex))
-		{
-			effect.errors += "Failed to create texture " + tex.unique_name + '.';
-			return false;
-		}
+		effect.errors += "error: " + entry_point.first + ": compute shaders are not supported in D3D9/D3D10\n";
+		return false;
 	}
 
-	// Build specialization constants
-	std::vector<uint32_t> spec_data;
-	std::vector<uint32_t> spec_constants;
-	for (const reshadefx::uniform &spec_constant : effect.module.spec_constants)
-	{
-		uint32_t id = static_cast<uint32_t>(spec_constants.size());
-		spec_data.push_back(spec_constant.initializer_value.as_uint[0]);
-		spec_constants.push_back(id);
-	}
+	std::string &cso = effect.assembly[entry_point.first];
+	std::string &cso_text = effect.assembly_text[entry_point.first];
 
-	// Create optional query heap for time measurements
-	if (!_device->create_query_heap(api::query_type::timestamp, static_cast<uint32_t>(effect.module.techniques.size() * 2 * 4), &effect.query_heap))
+	if ((_renderer_id & 0xF0000) == 0)
 	{
-		log::message(log::level::error, "Failed to create query heap for effect file '%s'!", effect.source_file.u8string().c_str());
-	}
+		assert(_d3d_compiler_module != nullptr);
 
-	// Initialize bindings
-	const bool sampler_with_resource_view = _device->check_capability(api::device_caps::sampler_with_resource_view);
+		// Copy string, since this has to be repeated for every entry point
+		std::string hlsl = effect.code_preamble;
 
-	api::descriptor_range cb_range;
-	cb_range.binding = 0;
-	cb_range.dx_register_index = 0; // b0 (global constant buffer)
-	cb_range.dx_register_space = 0;
-	cb_range.count = 1;
-	cb_range.array_size = 1;
-	cb_range.type = api::descriptor_type::constant_buffer;
-	cb_range.visibility = api::shader_stage::vertex | api::shader_stage::pixel | api::shader_stage::compute;
+		if (_renderer_id == 0x9000)
+		{
+			// Create SEMANTIC_PIXEL_SIZE constants
+			hlsl += "#define COLOR_PIXEL_SIZE 1.0 / " + std::to_string(_effect_width) + ", 1.0 / " + std::to_string(_effect_height) + '\n';
+
+			uint32_t semantic_index = 0;
+			for (const reshadefx::texture &tex : effect.module.textures)
+			{
+				if (tex.semantic.empty() || tex.semantic == "COLOR")
+					continue;
+
+				semantic_index++;
+				assert((effect.uniform_data_storage.size() / 16) <= (255 - semantic_index));
+
+				// Avoid duplicate declarations if the semantic was used multiple times
+				if (hlsl.find(tex.semantic + "_PIXEL_SIZE") == std::string::npos)
+					hlsl += "uniform float2 " + tex.semantic + "_PIXEL_SIZE : register(c" + std::to_string(255 - semantic_index) + ");\n";
+			}
+		}
+
+		hlsl += "#line 1\n"; // Reset line number, so it matches what is shown when viewing the generated code
+		hlsl += entry_point_code;
+
+		std::string profile;
+		switch (entry_point.second)
+		{
+		case reshadefx::shader_type::vertex:
+			profile = "vs";
+			break;
+		case reshadefx::shader_type::pixel:
+			profile = "ps";
+			break;
+		case reshadefx::shader_type::compute:
+			profile = "cs";
+			break;
+		}
+
+		switch (_renderer_id)
+		{
+		default:
+		case D3D_FEATURE_LEVEL_11_0:
+			profile += "_5_0";
+			break;
+		case D3D_FEATURE_LEVEL_10_1:
+			profile += "_4_1";
+			break;
+		case D3D_FEATURE_LEVEL_10_0:
+			profile += "_4_0";
+			break;
+		case D3D_FEATURE_LEVEL_9_1:
+		case D3D_FEATURE_LEVEL_9_2:
+			profile += "_4_0_level_9_1";
+			break;
+		case D3D_FEATURE_LEVEL_9_3:
+			profile += "_4_0_level_9_3";
+			break;
+		case 0x9000:
+			profile += "_3_0";
+			break;
+		}
+
+		UINT compile_flags = 0;
+		if (effect.skip_optimization)
+			compile_flags |= D3DCOMPILE_SKIP_OPTIMIZATION;
+		else if (_performance_mode)
+			compile_flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
+		if (_renderer_id >= D3D_FEATURE_LEVEL_10_0)
+			compile_flags |= D3DCOMPILE_ENABLE_STRICTNESS;
+#ifndef NDEBUG
+		compile_flags |= D3DCOMPILE_DEBUG;
+#endif
+
+		std::string hlsl_attributes;
+		hlsl_attributes += "entrypoint=" + entry_point.first + ';';
+		hlsl_attributes += "profile=" + profile + ';';
+		hlsl_attributes += "flags=" + std::to_string(compile_flags) + ';';
+
+		const std::string cache_id =
+			effect.source_file.stem().u8string() + '-' + entry_point.first + '-' + std::to_string(_renderer_id) + '-' +
+			std::to_string(std::hash<std::string_view>()(hlsl_attributes) ^ std::hash<std::string_view>()(hlsl));
+
+		// Remember the cache entry ID once the compiled shader blob is known to be present in the cache, so that it and the disassembly can be loaded back on demand after being released from memory (see 'create_effect' and 'get_effect_assembly_text')
+		if (load_effect_cache(cache_id, "cso", cso))
+		{
+			effect.assembly_cache_ids[entry_point.first] = cache_id;
+		}
+		else
+		{
+			const auto D3DCompile = reinterpret_cast<pD3DCompile>(GetProcAddress(static_cast<HMODULE>(_d3d_compiler_module), "D3DCompile"));
+			assert(D3DCompile != nullptr);
+
+			com_ptr<ID3DBlob> d3d_compiled, d3d_errors;
+			const HRESULT hr = D3DCompile(
+				hlsl.data(), hlsl.size(),
+				nullptr, nullptr, nullptr,
+				entry_point.first.c_str(),
+				profile.c_str(),
+				compile_flags, 0,
+				&d3d_compiled, &d3d_errors);
+
+			std::string d3d_errors_string;
+			if (d3d_errors != nullptr) // Append warnings to the output error string as well
+				d3d_errors_string.assign(static_cast<const char *>(d3d_errors->GetBufferPointer()), d3d_errors->GetBufferSize() - 1); // Subtracting one to not append the null-terminator as well
+			d3d_errors.reset();
+
+			// De-duplicate error lines (D3DCompiler sometimes repeats the same error multiple times)
+			for (size_t line_offset = 0, next_line_offset; (next_line_offset = d3d_errors_string.find('\n', line_offset)) != std::string::npos; line_offset = next_line_offset + 1)
+			{
+				const std::string_view cur_line(d3d_errors_string.data() + line_offset, next_line_offset - line_offset);
+
+				if (const size_t end_offset = d3d_errors_string.find('\n', next_line_offset + 1);
+					end_offset != std::string::npos)
+				{
+					const std::string_view next_line(d3d_errors_string.data() + next_line_offset + 1, end_offset - next_line_offset - 1);
+					if (cur_line == next_line)
+					{
+						d3d_errors_string.erase(next_line_offset, end_offset - next_line_offset);
+						next_line_offset = line_offset - 1;
+					}
+				}
+
+				// Also remove D3DCompiler warnings about 'groupshared' specifier used in VS/PS modules
+				if (cur_line.find("X3579") != std::string_view::npos)
+				{
+					d3d_errors_string.erase(line_offset, next_line_offset + 1 - line_offset);
+					next_line_offset = line_offset - 1;
+				}
+			}
+
+			if (FAILED(hr))
+			{
+				// Add a prefix with the offending entry point name for generic error messages like an out of memory notification
+				if (d3d_errors_string.find("error") == std::string::npos)
+					effect.errors += "error: " + entry_point.first + ": ";
+
+				effect.errors += d3d_errors_string;
+				return false;
+			}
+			else
+			{
+				// Append warnings
+				effect.errors += d3d_errors_string;
+			}
+
+			cso.resize(d3d_compiled->GetBufferSize());
+			std::memcpy(cso.data(), d3d_compiled->GetBufferPointer(), cso.size());
+
+			if (save_effect_cache(cache_id, "cso", cso))
+				effect.assembly_cache_ids[entry_point.first] = cache_id;
+
+			// The disassembly has to be created now while the D3D compiler module is still loaded (it is freed again after loading finished), but is then only kept in the effect cache
+			// When the shader module was loaded from the cache above, the matching disassembly is assumed to be cached as well, since the two entries are always saved together
+			const auto D3DDisassemble = reinterpret_cast<pD3DDisassemble>(GetProcAddress(static_cast<HMODULE>(_d3d_compiler_module), "D3DDisassemble"));
+			assert(D3DDisassemble != nullptr);
+
+			com_ptr<ID3DBlob> d3d_disassembled;
+			if (SUCCEEDED(D3DDisassemble(cso.data(), cso.size(), 0, nullptr, &d3d_disassembled)))
+				cso_text.assign(static_cast<const char *>(d3d_disassembled->GetBufferPointer()), d3d_disassembled->GetBufferSize() - 1);
+
+			if (save_effect_cache(cache_id, "asm", cso_text))
+				cso_text.clear(); // The disassembly can be loaded back from the cache on demand now, so no need to keep it in memory
+		}
+	}
+	else
+	{
+		cso = std::move(entry_point_code);
+
+		if (_renderer_id < 0x20000)
+		{
+			cso.insert(std::size("#version 430\n") - 1, effect.code_preamble);
+
+			cso_text = cso;
+		}
+	}
+	return true;
+}
+
+bool reshade::runtime::create_effect(size_t effect_index)
+{
+	effect &effect = _effects[effect_index];
+
+	// Create textures now, since they are referenced when building samplers below
+	for (texture &tex : _textures)
+	{
+		if (tex.resource != 0 || std::find(tex.shared.cbegin(), tex.shared.cend(), effect_index) == tex.shared.cend())
+			continue;
+
+		if (!create_texture(tex))
+		{
+			effect.errors += "Failed to create texture " + tex.unique_name + '.';
+			return false;
+		}
+	}
+
+	// Build specialization constants
+	std::vector<uint32_t> spec_data;
+	std::vector<uint32_t> spec_constants;
+	for (const reshadefx::uniform &spec_constant : effect.module.spec_constants)
+	{
+		uint32_t id = static_cast<uint32_t>(spec_constants.size());
+		spec_data.push_back(spec_constant.initializer_value.as_uint[0]);
+		spec_constants.push_back(id);
+	}
+
+	// This may be called multiple times for the same effect, since techniques are initialized on demand when they get enabled, in which case the resources shared by all techniques already exist
+	const bool first_init = (effect.layout == 0);
+
+	// Create optional query heap for time measurements
+	if (first_init)
+	{
+		size_t query_count = effect.module.techniques.size();
+		// Add additional queries for per-pass time measurements when those are enabled
+		if (_gather_gpu_statistics_per_pass)
+			for (const reshadefx::technique &tech : effect.module.techniques)
+				query_count += tech.passes.size();
+
+		if (query_count != 0 && !allocate_effect_query_pairs(effect, static_cast<uint32_t>(query_count)))
+		{
+			log::message(log::level::error, "Failed to allocate timestamp queries for effect file '%s'!", effect.source_file.u8string().c_str());
+		}
+	}
+
+	// Initialize bindings
+	const bool sampler_with_resource_view = _device->check_capability(api::device_caps::sampler_with_resource_view);
+
+	api::descriptor_range cb_range;
+	cb_range.binding = 0;
+	cb_range.dx_register_index = 0; // b0 (global constant buffer)
+	cb_range.dx_register_space = 0;
+	cb_range.count = 1;
+	cb_range.array_size = 1;
+	cb_range.type = api::descriptor_type::constant_buffer;
+	cb_range.visibility = api::shader_stage::vertex | api::shader_stage::pixel | api::shader_stage::compute;
 
 	api::descriptor_range sampler_range;
 	sampler_range.binding = 0;
@@ -2276,11 +3084,9 @@ bool reshade::runtime::create_effect(size_t effect_index)
 	uav_range.type = api::descriptor_type::unordered_access_view;
 	uav_range.visibility = api::shader_stage::vertex | api::shader_stage::pixel | api::shader_stage::compute;
 
-	size_t total_pass_count = 0;
+	// The pipeline layout is shared by all techniques, so the binding counts have to cover every technique in the module, including those not initialized by this call
 	for (const reshadefx::technique &tech : effect.module.techniques)
 	{
-		total_pass_count += tech.passes.size();
-
 		for (const reshadefx::pass &pass : tech.passes)
 		{
 			for (const reshadefx::sampler_binding &binding : pass.sampler_bindings)
@@ -2292,6 +3098,12 @@ bool reshade::runtime::create_effect(size_t effect_index)
 		}
 	}
 
+	// Only create pipelines and descriptor tables for those techniques that are actually used, the rest is initialized on demand when they get enabled (see 'enable_technique')
+	size_t pending_pass_count = 0;
+	for (const technique &tech : _techniques)
+		if (tech.effect_index == effect_index && tech.passes_data.empty() && (tech.enabled || tech.create_passes_requested))
+			pending_pass_count += tech.passes.size();
+
 	std::vector<api::descriptor_table_update> descriptor_writes;
 	descriptor_writes.reserve(
 		static_cast<size_t>(cb_range.count) +
@@ -2299,14 +3111,15 @@ bool reshade::runtime::create_effect(size_t effect_index)
 		static_cast<size_t>(srv_range.count) +
 		static_cast<size_t>(uav_range.count));
 
-	std::vector<api::descriptor_table> shader_resource_view_tables(total_pass_count);
-	std::vector<api::descriptor_table> unordered_access_view_tables(total_pass_count);
+	std::vector<api::descriptor_table> shader_resource_view_tables(pending_pass_count);
+	std::vector<api::descriptor_table> unordered_access_view_tables(pending_pass_count);
 
 	uint16_t sampler_list = 0;
 	std::vector<api::sampler_with_resource_view> sampler_descriptors;
-	sampler_descriptors.resize(std::max(sampler_range.count, srv_range.count) * total_pass_count);
+	sampler_descriptors.resize(std::max(sampler_range.count, srv_range.count) * pending_pass_count);
 
 	// Create pipeline layout for this effect
+	if (first_init)
 	{
 		api::pipeline_layout_param layout_params[4];
 		layout_params[0].type = api::pipeline_layout_param_type::descriptor_table;
@@ -2342,7 +3155,7 @@ bool reshade::runtime::create_effect(size_t effect_index)
 
 	// Create global constant buffer (except in D3D9, which does not have constant buffers)
 	api::buffer_range cb_buffer_range = {};
-	if (_renderer_id != 0x9000 && !effect.uniform_data_storage.empty())
+	if (first_init && _renderer_id != 0x9000 && !effect.uniform_data_storage.empty())
 	{
 		if (!_device->create_resource(
 				api::resource_desc(effect.uniform_data_storage.size(), api::memory_heap::cpu_to_gpu, api::resource_usage::constant_buffer),
@@ -2370,27 +3183,27 @@ bool reshade::runtime::create_effect(size_t effect_index)
 		write.descriptors = &cb_buffer_range;
 	}
 
-	if (sampler_range.count != 0)
+	if (sampler_range.count != 0 && (sampler_with_resource_view ? pending_pass_count != 0 : first_init))
 	{
-		if (!_device->allocate_descriptor_tables(static_cast<uint32_t>(sampler_with_resource_view ? total_pass_count : 1), effect.layout, 1, sampler_with_resource_view ? shader_resource_view_tables.data() : &effect.sampler_table))
+		if (!_device->allocate_descriptor_tables(static_cast<uint32_t>(sampler_with_resource_view ? pending_pass_count : 1), effect.layout, 1, sampler_with_resource_view ? shader_resource_view_tables.data() : &effect.sampler_table))
 		{
 			log::message(log::level::error, "Failed to create sampler descriptor table for effect file '%s'!", effect.source_file.u8string().c_str());
 			return false;
 		}
 	}
 
-	if (srv_range.count != 0 && !sampler_with_resource_view)
+	if (srv_range.count != 0 && !sampler_with_resource_view && pending_pass_count != 0)
 	{
-		if (!_device->allocate_descriptor_tables(static_cast<uint32_t>(total_pass_count), effect.layout, 2, shader_resource_view_tables.data()))
+		if (!_device->allocate_descriptor_tables(static_cast<uint32_t>(pending_pass_count), effect.layout, 2, shader_resource_view_tables.data()))
 		{
 			log::message(log::level::error, "Failed to create texture descriptor table for effect file '%s'!", effect.source_file.u8string().c_str());
 			return false;
 		}
 	}
 
-	if (uav_range.count != 0)
+	if (uav_range.count != 0 && pending_pass_count != 0)
 	{
-		if (!_device->allocate_descriptor_tables(static_cast<uint32_t>(total_pass_count), effect.layout, sampler_with_resource_view ? 2 : 3, unordered_access_view_tables.data()))
+		if (!_device->allocate_descriptor_tables(static_cast<uint32_t>(pending_pass_count), effect.layout, sampler_with_resource_view ? 2 : 3, unordered_access_view_tables.data()))
 		{
 			log::message(log::level::error, "Failed to create storage descriptor table for effect file '%s'!", effect.source_file.u8string().c_str());
 			return false;
@@ -2398,18 +3211,70 @@ bool reshade::runtime::create_effect(size_t effect_index)
 	}
 
 	// Initialize techniques and passes
-	for (size_t tech_index = 0, pass_index_in_effect = 0, tech_index_in_effect = 0; tech_index < _techniques.size(); ++tech_index)
+	for (size_t tech_index = 0, pass_index_in_effect = 0, tech_index_in_effect = 0, pass_query_index_in_effect_total = 0; tech_index < _techniques.size(); ++tech_index)
 	{
 		technique &tech = _techniques[tech_index];
 
-		if (!tech.passes_data.empty() || tech.effect_index != effect_index)
+		if (tech.effect_index != effect_index)
+			continue;
+
+		// Count all techniques and passes of this effect, so that the query indices stay stable when the remaining techniques are initialized by a later call
+		const size_t query_index_in_effect = tech_index_in_effect++;
+		const size_t pass_query_index_in_effect = pass_query_index_in_effect_total;
+		pass_query_index_in_effect_total += tech.passes.size();
+
+		if (!tech.passes_data.empty())
+			continue;
+		// Skip techniques that are not enabled, they are initialized on demand when they get enabled (see 'enable_technique')
+		if (!tech.enabled && !tech.create_passes_requested)
 			continue;
 
+		tech.create_passes_requested = false;
+
+		// Compile any entry points that were deferred during loading because this technique was not enabled in the preset at the time (see 'load_effect')
+		for (const reshadefx::pass &pass : tech.passes)
+		{
+			for (const std::string *const entry_point_name : { &pass.vs_entry_point, &pass.ps_entry_point, &pass.cs_entry_point })
+			{
+				if (entry_point_name->empty() || effect.assembly.find(*entry_point_name) != effect.assembly.end())
+					continue;
+
+				// The compiled shader blob may have been released after the initial pipeline creation, in which case it can simply be loaded back from the effect cache
+				if (const auto cache_id_it = effect.assembly_cache_ids.find(*entry_point_name);
+					cache_id_it != effect.assembly_cache_ids.end())
+				{
+					if (std::string cso; load_effect_cache(cache_id_it->second, "cso", cso))
+					{
+						effect.assembly.emplace(*entry_point_name, std::move(cso));
+						continue;
+					}
+				}
+
+				const auto entry_point_it = std::find_if(effect.module.entry_points.cbegin(), effect.module.entry_points.cend(),
+					[entry_point_name](const std::pair<std::string, reshadefx::shader_type> &entry_point) { return entry_point.first == *entry_point_name; });
+				const auto code_it = effect.deferred_entry_point_code.find(*entry_point_name);
+
+				if (entry_point_it == effect.module.entry_points.cend() || code_it == effect.deferred_entry_point_code.end() ||
+					!compile_effect_entry_point(effect, *entry_point_it, std::move(code_it->second)))
+				{
+					effect.assembly.erase(*entry_point_name);
+					effect.assembly_text.erase(*entry_point_name);
+					effect.assembly_cache_ids.erase(*entry_point_name);
+
+					log::message(log::level::error, "Failed to compile entry point '%s' in technique '%s' in '%s'!", entry_point_name->c_str(), tech.name.c_str(), effect.source_file.u8string().c_str());
+					return false;
+				}
+
+				effect.deferred_entry_point_code.erase(code_it);
+			}
+		}
+
 		tech.passes_data.resize(tech.passes.size());
 
-		// Offset index so that a query exists for each command frame and two subsequent ones are used for before/after stamps
-		tech.query_base_index = static_cast<uint32_t>(tech_index_in_effect * 2 * 4);
-		++tech_index_in_effect;
+		// Each technique owns a begin/end query pair in the effect's allocation from the pooled query heap
+		tech.query_base_index = static_cast<uint32_t>(effect.query_base + query_index_in_effect);
+		// The per-pass query pairs are laid out behind the technique pairs in the effect's allocation
+		tech.pass_query_base_index = static_cast<uint32_t>(effect.query_base + effect.module.techniques.size() + pass_query_index_in_effect);
 
 		for (size_t pass_index = 0; pass_index < tech.passes.size(); ++pass_index, ++pass_index_in_effect)
 		{
@@ -2637,8 +3502,41 @@ bool reshade::runtime::create_effect(size_t effect_index)
 					log::message(log::level::error, "Failed to create graphics pipeline for pass %zu in technique '%s' in '%s'!", pass_index, tech.name.c_str(), effect.source_file.u8string().c_str());
 					return false;
 				}
+
+				// Pre-build the static render state of this pass, so that it does not have to be recomputed every frame (see 'render_technique')
+				// Recording entire passes into D3D12 bundles or Vulkan secondary command buffers is not possible, since those cannot encode the resource barriers and render target changes the passes consist of, so only this state is cached
+				if (pass.render_target_names[0].empty())
+				{
+					// The back buffer can change between frames, so the view of this render target is filled in again every frame
+					pass_data.render_pass_target_count = 1;
+				}
+				else
+				{
+					for (int i = 0; i < 8 && pass_data.render_target_views[i] != 0; ++i, ++pass_data.render_pass_target_count)
+						pass_data.render_pass_targets[i].view = pass_data.render_target_views[i];
+				}
+
+				if (pass.clear_render_targets)
+				{
+					for (int i = 0; i < 8; ++i)
+						pass_data.render_pass_targets[i].load_op = api::render_pass_load_op::clear;
+				}
+
+				pass_data.viewport = {
+					0.0f, 0.0f,
+					static_cast<float>(pass.viewport_width),
+					static_cast<float>(pass.viewport_height),
+					0.0f, 1.0f
+				};
+				pass_data.scissor_rect = {
+					0, 0,
+					static_cast<int32_t>(pass.viewport_width),
+					static_cast<int32_t>(pass.viewport_height)
+				};
 			}
 
+			pass_data.debug_name = pass.name.empty() ? "Pass " + std::to_string(pass_index) : pass.name;
+
 			for (const reshadefx::sampler_binding &info : pass.sampler_bindings)
 			{
 				api::sampler &sampler_handle = sampler_descriptors[pass_index_in_effect * sampler_range.count + info.entry_point_binding].sampler;
@@ -2747,10 +3645,19 @@ bool reshade::runtime::create_effect(size_t effect_index)
 	if (!descriptor_writes.empty())
 		_device->update_descriptor_tables(static_cast<uint32_t>(descriptor_writes.size()), descriptor_writes.data());
 
-#if 0 // TODO: This no longer works, since assembly may be needed to recreate effect after reloading to get preprocessor text
-	// Clear effect assembly now that it was consumed
-	effect.assembly.clear();
-#endif
+	// Release the compiled shader blobs and generated code now that all pipelines were created, they are loaded back from the effect cache on demand when another technique is enabled later or the code viewer displays them (see 'get_effect_generated_code')
+	for (auto it = effect.assembly.begin(); it != effect.assembly.end();)
+	{
+		if (effect.assembly_cache_ids.find(it->first) != effect.assembly_cache_ids.end())
+			it = effect.assembly.erase(it);
+		else
+			++it;
+	}
+	if (!effect.module_cache_id.empty())
+	{
+		effect.generated_code.clear();
+		effect.generated_code.shrink_to_fit();
+	}
 
 	return true;
 }
@@ -2793,10 +3700,81 @@ bool reshade::runtime::create_effect_sampler_state(const reshadefx::sampler_desc
 		return false;
 	}
 }
+bool reshade::runtime::respecialize_effect(size_t effect_index, const ini_file &preset)
+{
+	effect &effect = _effects[effect_index];
+	assert(effect.compiled);
+
+	// Shader modules reference specialization constants by ID, so only work when the backend applies their values during pipeline creation, rather than baking them into the shader code up front
+	if (_renderer_id < 0x20000)
+		return false;
+
+	const std::string effect_name = effect.source_file.filename().u8string();
+
+	// Apply the values from the preset to the specialization constants, so that the pipelines created below pick them up
+	for (size_t i = 0; i < effect.module.spec_constants.size() && i < effect.spec_constant_values.size(); ++i)
+	{
+		reshadefx::uniform &constant = effect.module.spec_constants[i];
+
+		// Start from the default value in the effect source, in case the new preset does not contain an entry for this constant
+		reshadefx::constant value = effect.spec_constant_values[i].first;
+		switch (constant.type.base)
+		{
+		case reshadefx::type::t_int:
+			preset.get(effect_name, constant.name, value.as_int);
+			break;
+		case reshadefx::type::t_bool:
+		case reshadefx::type::t_uint:
+			preset.get(effect_name, constant.name, value.as_uint);
+			break;
+		case reshadefx::type::t_float:
+			preset.get(effect_name, constant.name, value.as_float);
+			break;
+		}
+
+		effect.spec_constant_values[i].second = value;
+
+		constant.initializer_value = value;
+		// Check if this is a split specialization constant and move data accordingly
+		if (constant.type.is_scalar() && constant.offset != 0)
+			constant.initializer_value.as_uint[0] = value.as_uint[constant.offset];
+	}
+
+	// Make sure no pipelines of this effect are currently in use on the GPU before destroying them
+	_graphics_queue->wait_idle();
+
+	// Destroy just the pass pipelines and descriptor tables, keeping textures, uniform state and layout objects alive, and let 'create_effect' build them again with the new values
+	for (technique &tech : _techniques)
+	{
+		if (tech.effect_index != effect_index || tech.passes_data.empty())
+			continue;
+
+		for (const technique::pass_data &pass : tech.passes_data)
+		{
+			_device->destroy_pipeline(pass.pipeline);
+
+			_device->free_descriptor_table(pass.texture_table);
+			_device->free_descriptor_table(pass.storage_table);
+		}
+
+		tech.passes_data.clear();
+
+		// Request pipeline creation even for techniques that are currently disabled, so that they do not end up with pipelines based on stale constant values when enabled later
+		tech.create_passes_requested = true;
+	}
+
+	if (std::find(_reload_create_queue.cbegin(), _reload_create_queue.cend(), effect_index) == _reload_create_queue.cend())
+		_reload_create_queue.push_back(effect_index);
+
+	return true;
+}
 void reshade::runtime::destroy_effect(size_t effect_index)
 {
 	assert(effect_index < _effects.size());
 
+	// Pre-resolved transition values reference effects by index, so are no longer safe to use (see 'load_current_preset')
+	_preset_transition_values_valid = false;
+
 	for (technique &tech : _techniques)
 	{
 		if (tech.effect_index != effect_index)
@@ -2826,10 +3804,15 @@ void reshade::runtime::destroy_effect(size_t effect_index)
 		_device->destroy_pipeline_layout(effect.layout);
 		effect.layout = {};
 
-		_device->destroy_query_heap(effect.query_heap);
-		effect.query_heap = {};
+		// Release the effect's allocation in the pooled query heap, so that it can be reused by the next effect that loads
+		effect.query_base = 0;
+		effect.query_count = 0;
 
 		effect.texture_semantic_to_binding.clear();
+
+		// Detach from the shared uniform block, so that it is re-attached with the new layout after a reload (see 'update_shared_uniform_variables')
+		effect.shared_uniforms.reset();
+		effect.shared_uniform_generation = 0;
 	}
 
 	// Lock here to be safe in case another effect is still loading
@@ -2873,190 +3856,452 @@ void reshade::runtime::destroy_effect(size_t effect_index)
 		}
 	}
 
+	_technique_render_order_invalidated = true;
+
+	// Rebuild the technique name indices of all effects, since the technique list indices shifted above
+	for (effect &other_effect : _effects)
+		other_effect.technique_index.clear();
+	for (size_t technique_index = 0; technique_index < _techniques.size(); ++technique_index)
+	{
+		const technique &tech = _techniques[technique_index];
+		_effects[tech.effect_index].technique_index.emplace(tech.name, technique_index);
+	}
+
 	// Do not clear effect here, since it is common to be reused immediately
 }
 
-void reshade::runtime::load_textures()
+// Parses the header of a DDS file and returns the format of its payload if it is a simple block-compressed 2D texture, or 'api::format::unknown' if it is anything else (in which case it goes through the usual stb_image decode path)
+static reshade::api::format parse_compressed_dds_header(const uint8_t *data, size_t data_size, uint32_t &width, uint32_t &height, uint32_t &levels, size_t &payload_offset)
 {
-	for (texture &tex : _textures)
+	const auto read_dword = [data](size_t offset) {
+		uint32_t value;
+		std::memcpy(&value, data + offset, sizeof(value));
+		return value;
+	};
+
+	if (data_size < 128 || read_dword(0) != MAKEFOURCC('D', 'D', 'S', ' ') || read_dword(4) != 124)
+		return reshade::api::format::unknown;
+
+	height = read_dword(12);
+	width = read_dword(16);
+	levels = std::max(read_dword(28), 1u);
+	payload_offset = 128;
+
+	// Reject volume and cube map files (see DDSD_DEPTH and DDSCAPS2_CUBEMAP flags)
+	if (read_dword(24) > 1 || (read_dword(112) & 0xFE00) != 0)
+		return reshade::api::format::unknown;
+
+	if ((read_dword(80) & 0x4 /* DDPF_FOURCC */) == 0)
+		return reshade::api::format::unknown;
+
+	switch (read_dword(84))
 	{
-		if (tex.resource == 0 || !tex.semantic.empty())
-			continue; // Ignore textures that are not created yet and those that are handled in the runtime implementation
+	case MAKEFOURCC('D', 'X', 'T', '1'):
+		return reshade::api::format::bc1_unorm;
+	case MAKEFOURCC('D', 'X', 'T', '2'):
+	case MAKEFOURCC('D', 'X', 'T', '3'):
+		return reshade::api::format::bc2_unorm;
+	case MAKEFOURCC('D', 'X', 'T', '4'):
+	case MAKEFOURCC('D', 'X', 'T', '5'):
+		return reshade::api::format::bc3_unorm;
+	case MAKEFOURCC('A', 'T', 'I', '1'):
+	case MAKEFOURCC('B', 'C', '4', 'U'):
+		return reshade::api::format::bc4_unorm;
+	case MAKEFOURCC('B', 'C', '4', 'S'):
+		return reshade::api::format::bc4_snorm;
+	case MAKEFOURCC('A', 'T', 'I', '2'):
+	case MAKEFOURCC('B', 'C', '5', 'U'):
+		return reshade::api::format::bc5_unorm;
+	case MAKEFOURCC('B', 'C', '5', 'S'):
+		return reshade::api::format::bc5_snorm;
+	case MAKEFOURCC('D', 'X', '1', '0'):
+		if (data_size < 148)
+			return reshade::api::format::unknown;
+		payload_offset = 148;
+		// Only accept plain 2D textures (see DDS_DIMENSION_TEXTURE2D and DDS_RESOURCE_MISC_TEXTURECUBE)
+		if (read_dword(132) != 3 || (read_dword(136) & 0x4) != 0 || read_dword(140) > 1)
+			return reshade::api::format::unknown;
+		// The format values of this API match those of the DXGI_FORMAT enumeration stored in the file
+		if (const auto format = static_cast<reshade::api::format>(read_dword(128));
+			(format >= reshade::api::format::bc1_unorm && format <= reshade::api::format::bc5_snorm && format != reshade::api::format::bc2_typeless && format != reshade::api::format::bc3_typeless && format != reshade::api::format::bc4_typeless && format != reshade::api::format::bc5_typeless) ||
+			(format >= reshade::api::format::bc6h_ufloat && format <= reshade::api::format::bc7_unorm_srgb && format != reshade::api::format::bc7_typeless))
+			return format;
+		return reshade::api::format::unknown;
+	default:
+		return reshade::api::format::unknown;
+	}
+}
 
-		std::filesystem::path source_path = std::filesystem::u8path(tex.annotation_as_string("source"));
-		// Ignore textures that have no image file attached to them (e.g. plain render targets)
-		if (source_path.empty())
-			continue;
+// System-memory shadows of decoded image data, shared between all effect runtimes in the process, so that a device reset (which tears down and rebuilds all effect resources, most notably on D3D9) can restore texture data from memory instead of decoding the image files from disk again
+struct image_data_cache_entry
+{
+	std::filesystem::file_time_type modified;
+	reshadefx::texture_format format = reshadefx::texture_format::unknown;
+	int width = 0, height = 0, depth = 0;
+	std::vector<uint8_t> pixels;
+};
+static std::mutex s_image_data_cache_mutex;
+static std::unordered_map<std::string, image_data_cache_entry> s_image_data_cache;
+
+static void *load_texture_image_data(const std::filesystem::path &source_path, const std::string &texture_name, reshadefx::texture_format format, int &width, int &height, int &depth)
+{
+	std::error_code ec;
+	const std::filesystem::file_time_type modified = std::filesystem::last_write_time(source_path, ec);
 
-		// Search for image file using the provided search paths unless the path provided is already absolute
-		if (!find_file(_texture_search_paths, source_path))
+	{	const std::unique_lock<std::mutex> lock(s_image_data_cache_mutex);
+
+		if (const auto it = s_image_data_cache.find(source_path.u8string());
+			it != s_image_data_cache.end() && it->second.modified == modified && it->second.format == format)
 		{
-			log::message(log::level::error, "Source '%s' for texture '%s' was not found in any of the texture search paths!", source_path.u8string().c_str(), tex.unique_name.c_str());
-			_last_reload_successful = false;
-			continue;
+			// Allocate with 'std::malloc', since the caller frees the returned data with 'stbi_image_free'
+			if (void *const cached_pixels = std::malloc(it->second.pixels.size()))
+			{
+				std::memcpy(cached_pixels, it->second.pixels.data(), it->second.pixels.size());
+				width = it->second.width;
+				height = it->second.height;
+				depth = it->second.depth;
+				return cached_pixels;
+			}
 		}
+	}
 
-		void *pixels = nullptr;
-		int width = 0, height = 1, depth = 1, channels = 0;
-		const bool is_floating_point_format = (tex.format == reshadefx::texture_format::r32f || tex.format == reshadefx::texture_format::rg32f || tex.format == reshadefx::texture_format::rgba32f);
+	void *pixels = nullptr;
+	int channels = 0;
+	const bool is_floating_point_format = (format == reshadefx::texture_format::r32f || format == reshadefx::texture_format::rg32f || format == reshadefx::texture_format::rgba32f);
 
-		if (FILE *const file = _wfsopen(source_path.c_str(), L"rb", SH_DENYNO))
-		{
-			fseek(file, 0, SEEK_END);
-			const size_t file_size = ftell(file);
-			fseek(file, 0, SEEK_SET);
+	if (FILE *const file = _wfsopen(source_path.c_str(), L"rb", SH_DENYNO))
+	{
+		fseek(file, 0, SEEK_END);
+		const size_t file_size = ftell(file);
+		fseek(file, 0, SEEK_SET);
 
-			if (source_path.extension() == L".cube")
+		if (source_path.extension() == L".cube")
+		{
+			if (!is_floating_point_format)
 			{
-				if (!is_floating_point_format)
-				{
-					log::message(log::level::error, "Source '%s' for texture '%s' is a Cube LUT file, which can only be loaded into textures with a floating-point format!", source_path.u8string().c_str(), tex.unique_name.c_str());
-					_last_reload_successful = false;
-					continue;
-				}
+				reshade::log::message(reshade::log::level::error, "Source '%s' for texture '%s' is a Cube LUT file, which can only be loaded into textures with a floating-point format!", source_path.u8string().c_str(), texture_name.c_str());
+				fclose(file);
+				return nullptr;
+			}
 
-				float domain_min[3] = { 0.0f, 0.0f, 0.0f };
-				float domain_max[3] = { 1.0f, 1.0f, 1.0f };
+			float domain_min[3] = { 0.0f, 0.0f, 0.0f };
+			float domain_max[3] = { 1.0f, 1.0f, 1.0f };
 
-				// Read header information
-				char line_data[1024];
-				while (fgets(line_data, sizeof(line_data), file))
-				{
-					const std::string_view line = trim(line_data, "\r\n");
+			// Read header information
+			char line_data[1024];
+			while (fgets(line_data, sizeof(line_data), file))
+			{
+				const std::string_view line = trim(line_data, "\r\n");
 
-					if (line.empty() || line[0] == '#')
-						continue; // Skip lines with comments
+				if (line.empty() || line[0] == '#')
+					continue; // Skip lines with comments
 
-					char *p = line_data;
+				char *p = line_data;
 
-					if (line.rfind("TITLE", 0) == 0)
-						continue; // Skip optional line with title
+				if (line.rfind("TITLE", 0) == 0)
+					continue; // Skip optional line with title
 
-					if (line.rfind("DOMAIN_MIN", 0) == 0)
-					{
-						p += 10;
-						domain_min[0] = static_cast<float>(std::strtod(p, &p));
-						domain_min[1] = static_cast<float>(std::strtod(p, &p));
-						domain_min[2] = static_cast<float>(std::strtod(p, &p));
-						continue;
-					}
-					if (line.rfind("DOMAIN_MAX", 0) == 0)
-					{
-						p += 10;
-						domain_max[0] = static_cast<float>(std::strtod(p, &p));
-						domain_max[1] = static_cast<float>(std::strtod(p, &p));
-						domain_max[2] = static_cast<float>(std::strtod(p, &p));
-						continue;
-					}
-
-					if (line.rfind("LUT_1D_SIZE", 0) == 0)
-					{
-						if (pixels != nullptr)
-							break;
-						width = std::strtol(p + 11, nullptr, 10);
-						pixels = std::malloc(static_cast<size_t>(width) * 4 * sizeof(float));
-						continue;
-					}
-					if (line.rfind("LUT_3D_SIZE", 0) == 0)
-					{
-						if (pixels != nullptr)
-							break;
-						width = height = depth = std::strtol(p + 11, nullptr, 10);
-						pixels = std::malloc(static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * 4 * sizeof(float));
-						continue;
-					}
-
-					// Line has no known keyword, so assume this is where the table data starts and roll back a line to continue reading that below
-					fseek(file, -static_cast<long>(std::strlen(line_data)), SEEK_CUR);
-					break;
+				if (line.rfind("DOMAIN_MIN", 0) == 0)
+				{
+					p += 10;
+					domain_min[0] = static_cast<float>(std::strtod(p, &p));
+					domain_min[1] = static_cast<float>(std::strtod(p, &p));
+					domain_min[2] = static_cast<float>(std::strtod(p, &p));
+					continue;
+				}
+				if (line.rfind("DOMAIN_MAX", 0) == 0)
+				{
+					p += 10;
+					domain_max[0] = static_cast<float>(std::strtod(p, &p));
+					domain_max[1] = static_cast<float>(std::strtod(p, &p));
+					domain_max[2] = static_cast<float>(std::strtod(p, &p));
+					continue;
 				}
 
-				// Read table data
-				if (pixels != nullptr)
+				if (line.rfind("LUT_1D_SIZE", 0) == 0)
+				{
+					if (pixels != nullptr)
+						break;
+					width = std::strtol(p + 11, nullptr, 10);
+					pixels = std::malloc(static_cast<size_t>(width) * 4 * sizeof(float));
+					continue;
+				}
+				if (line.rfind("LUT_3D_SIZE", 0) == 0)
 				{
-					size_t index = 0;
+					if (pixels != nullptr)
+						break;
+					width = height = depth = std::strtol(p + 11, nullptr, 10);
+					pixels = std::malloc(static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * 4 * sizeof(float));
+					continue;
+				}
 
-					while (fgets(line_data, sizeof(line_data), file) && (index + 4) <= (static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * 4))
-					{
-						const std::string_view line = trim(line_data, "\r\n");
+				// Line has no known keyword, so assume this is where the table data starts and roll back a line to continue reading that below
+				fseek(file, -static_cast<long>(std::strlen(line_data)), SEEK_CUR);
+				break;
+			}
+
+			// Read table data
+			if (pixels != nullptr)
+			{
+				size_t index = 0;
 
-						if (line.empty() || line[0] == '#')
-							continue; // Skip lines with comments
+				while (fgets(line_data, sizeof(line_data), file) && (index + 4) <= (static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * 4))
+				{
+					const std::string_view line = trim(line_data, "\r\n");
+
+					if (line.empty() || line[0] == '#')
+						continue; // Skip lines with comments
 
-						char *p = line_data;
+					char *p = line_data;
 
-						static_cast<float *>(pixels)[index++] = static_cast<float>(std::strtod(p, &p)) * (domain_max[0] - domain_min[0]) + domain_min[0];
-						static_cast<float *>(pixels)[index++] = static_cast<float>(std::strtod(p, &p)) * (domain_max[1] - domain_min[1]) + domain_min[1];
-						static_cast<float *>(pixels)[index++] = static_cast<float>(std::strtod(p, &p)) * (domain_max[2] - domain_min[2]) + domain_min[2];
-						static_cast<float *>(pixels)[index++] = 1.0f;
-					}
+					static_cast<float *>(pixels)[index++] = static_cast<float>(std::strtod(p, &p)) * (domain_max[0] - domain_min[0]) + domain_min[0];
+					static_cast<float *>(pixels)[index++] = static_cast<float>(std::strtod(p, &p)) * (domain_max[1] - domain_min[1]) + domain_min[1];
+					static_cast<float *>(pixels)[index++] = static_cast<float>(std::strtod(p, &p)) * (domain_max[2] - domain_min[2]) + domain_min[2];
+					static_cast<float *>(pixels)[index++] = 1.0f;
 				}
 			}
-			else
-			{
-				// Read texture data into memory in one go since that is faster than reading chunk by chunk
-				std::vector<stbi_uc> file_data(file_size);
-				const size_t file_size_read = fread(file_data.data(), 1, file_size, file);
-				fclose(file);
+		}
+		else
+		{
+			// Read texture data into memory in one go since that is faster than reading chunk by chunk
+			std::vector<stbi_uc> file_data(file_size);
+			const size_t file_size_read = fread(file_data.data(), 1, file_size, file);
+			fclose(file);
 
-				if (file_size_read == file_size)
-				{
-					if (is_floating_point_format)
-						pixels = stbi_loadf_from_memory(file_data.data(), static_cast<int>(file_data.size()), &width, &height, &channels, STBI_rgb_alpha);
-					else if (stbi_dds_test_memory(file_data.data(), static_cast<int>(file_data.size())))
-						pixels = stbi_dds_load_from_memory(file_data.data(), static_cast<int>(file_data.size()), &width, &height, &depth, &channels, STBI_rgb_alpha);
-					else
-						pixels = stbi_load_from_memory(file_data.data(), static_cast<int>(file_data.size()), &width, &height, &channels, STBI_rgb_alpha);
-				}
+			if (file_size_read == file_size)
+			{
+				if (is_floating_point_format)
+					pixels = stbi_loadf_from_memory(file_data.data(), static_cast<int>(file_data.size()), &width, &height, &channels, STBI_rgb_alpha);
+				else if (stbi_dds_test_memory(file_data.data(), static_cast<int>(file_data.size())))
+					pixels = stbi_dds_load_from_memory(file_data.data(), static_cast<int>(file_data.size()), &width, &height, &depth, &channels, STBI_rgb_alpha);
+				else
+					pixels = stbi_load_from_memory(file_data.data(), static_cast<int>(file_data.size()), &width, &height, &channels, STBI_rgb_alpha);
 			}
 		}
+	}
+
+	if (pixels == nullptr)
+	{
+		reshade::log::message(reshade::log::level::error, "Failed to load '%s' for texture '%s'!", source_path.u8string().c_str(), texture_name.c_str());
+		return nullptr;
+	}
+
+	// Collapse data to the correct number of components per pixel based on the texture format
+	size_t pixel_size = 0;
+	switch (format)
+	{
+	case reshadefx::texture_format::r8:
+		pixel_size = 1;
+		for (size_t i = 4, k = 1; i < static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * 4; i += 4, k += 1)
+			static_cast<stbi_uc *>(pixels)[k] = static_cast<stbi_uc *>(pixels)[i];
+		break;
+	case reshadefx::texture_format::r32f:
+		pixel_size = sizeof(float);
+		for (size_t i = 4, k = 1; i < static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * 4; i += 4, k += 1)
+			static_cast<float *>(pixels)[k] = static_cast<float *>(pixels)[i];
+		break;
+	case reshadefx::texture_format::rg8:
+		pixel_size = 2;
+		for (size_t i = 4, k = 2; i < static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * 4; i += 4, k += 2)
+			static_cast<stbi_uc *>(pixels)[k + 0] = static_cast<stbi_uc *>(pixels)[i + 0],
+			static_cast<stbi_uc *>(pixels)[k + 1] = static_cast<stbi_uc *>(pixels)[i + 1];
+		break;
+	case reshadefx::texture_format::rg32f:
+		pixel_size = 2 * sizeof(float);
+		for (size_t i = 4, k = 2; i < static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * 4; i += 4, k += 2)
+			static_cast<float *>(pixels)[k + 0] = static_cast<float *>(pixels)[i + 0],
+			static_cast<float *>(pixels)[k + 1] = static_cast<float *>(pixels)[i + 1];
+		break;
+	case reshadefx::texture_format::rgba8:
+		pixel_size = 4;
+		break;
+	case reshadefx::texture_format::rgba32f:
+		pixel_size = 4 * sizeof(float);
+		break;
+	default:
+		reshade::log::message(reshade::log::level::error, "Texture upload is not supported for format %d of texture '%s'!", static_cast<int>(format), texture_name.c_str());
+		stbi_image_free(pixels);
+		return nullptr;
+	}
+
+	// Keep a system-memory shadow of the decoded data, so that the next load of this image file (after a device reset in particular) is just a memory copy
+	{	const std::unique_lock<std::mutex> lock(s_image_data_cache_mutex);
+
+		image_data_cache_entry &entry = s_image_data_cache[source_path.u8string()];
+		entry.modified = modified;
+		entry.format = format;
+		entry.width = width;
+		entry.height = height;
+		entry.depth = depth;
+		entry.pixels.assign(static_cast<const uint8_t *>(pixels), static_cast<const uint8_t *>(pixels) + static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * pixel_size);
+	}
+
+	return pixels;
+}
+
+void reshade::runtime::load_textures()
+{
+	// Kick off a decode job on the thread pool for every texture that was not yet handled in this load cycle (decoding the image files is by far the most expensive part and does not need the main thread)
+	for (texture &tex : _textures)
+	{
+		if (tex.resource == 0 || !tex.semantic.empty() || tex.loaded || tex.loading)
+			continue; // Ignore textures that are not created yet, those that are handled in the runtime implementation and those that are already loading
+
+		// Only attempt to load each texture once per load cycle, even if resolving or decoding its image file fails below
+		tex.loading = true;
+
+		std::filesystem::path source_path = std::filesystem::u8path(tex.annotation_as_string("source"));
+		// Ignore textures that have no image file attached to them (e.g. plain render targets)
+		if (source_path.empty())
+			continue;
 
-		if (pixels == nullptr)
+		// Search for image file using the provided search paths unless the path provided is already absolute
+		if (!find_file(_texture_search_paths, source_path))
 		{
-			log::message(log::level::error, "Failed to load '%s' for texture '%s'!", source_path.u8string().c_str(), tex.unique_name.c_str());
+			log::message(log::level::error, "Source '%s' for texture '%s' was not found in any of the texture search paths!", source_path.u8string().c_str(), tex.unique_name.c_str());
 			_last_reload_successful = false;
 			continue;
 		}
 
-		// Collapse data to the correct number of components per pixel based on the texture format
-		switch (tex.format)
+		if (tex.compressed_format != api::format::unknown)
 		{
-		case reshadefx::texture_format::r8:
-			for (size_t i = 4, k = 1; i < static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * 4; i += 4, k += 1)
-				static_cast<stbi_uc *>(pixels)[k] = static_cast<stbi_uc *>(pixels)[i];
-			break;
-		case reshadefx::texture_format::r32f:
-			for (size_t i = 4, k = 1; i < static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * 4; i += 4, k += 1)
-				static_cast<float *>(pixels)[k] = static_cast<float *>(pixels)[i];
-			break;
-		case reshadefx::texture_format::rg8:
-			for (size_t i = 4, k = 2; i < static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * 4; i += 4, k += 2)
-				static_cast<stbi_uc *>(pixels)[k + 0] = static_cast<stbi_uc *>(pixels)[i + 0],
-				static_cast<stbi_uc *>(pixels)[k + 1] = static_cast<stbi_uc *>(pixels)[i + 1];
-			break;
-		case reshadefx::texture_format::rg32f:
-			for (size_t i = 4, k = 2; i < static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * 4; i += 4, k += 2)
-				static_cast<float *>(pixels)[k + 0] = static_cast<float *>(pixels)[i + 0],
-				static_cast<float *>(pixels)[k + 1] = static_cast<float *>(pixels)[i + 1];
-			break;
-		case reshadefx::texture_format::rgba8:
-		case reshadefx::texture_format::rgba32f:
-			break;
-		default:
-			log::message(log::level::error, "Texture upload is not supported for format %d of texture '%s'!", static_cast<int>(tex.format), tex.unique_name.c_str());
-			_last_reload_successful = false;
-			stbi_image_free(pixels);
+			// The file was already validated to be a matching block-compressed DDS when the texture resource was created, so its payload can be read and uploaded as-is without any decoding
+			get_thread_pool().enqueue(_texture_load_job_group, [this, source_path = std::move(source_path), texture_name = tex.unique_name, compressed_format = tex.compressed_format, levels = tex.levels]() {
+				void *file_data = nullptr;
+				size_t file_size = 0;
+				if (FILE *const file = _wfsopen(source_path.c_str(), L"rb", SH_DENYNO))
+				{
+					fseek(file, 0, SEEK_END);
+					file_size = ftell(file);
+					fseek(file, 0, SEEK_SET);
+
+					file_data = std::malloc(file_size);
+					if (file_data != nullptr && fread(file_data, 1, file_size, file) != file_size)
+					{
+						std::free(file_data);
+						file_data = nullptr;
+					}
+
+					fclose(file);
+				}
+
+				uint32_t file_width = 0, file_height = 0, file_levels = 1;
+				size_t payload_offset = 0;
+				if (file_data != nullptr &&
+					parse_compressed_dds_header(static_cast<const uint8_t *>(file_data), file_size, file_width, file_height, file_levels, payload_offset) == compressed_format)
+				{
+					// Verify the file actually contains the entire mipmap chain that is going to be uploaded
+					size_t payload_size = 0;
+					for (uint32_t level = 0; level < levels; ++level)
+						payload_size += api::format_slice_pitch(compressed_format, api::format_row_pitch(compressed_format, std::max(1u, file_width >> level)), std::max(1u, file_height >> level));
+
+					if (payload_size <= file_size - payload_offset)
+					{
+						pending_texture_upload upload;
+						upload.texture_name = texture_name;
+						upload.width = file_width;
+						upload.height = file_height;
+						upload.depth = 1;
+						upload.pixels = file_data;
+						upload.compressed_format = compressed_format;
+						upload.levels = levels;
+						upload.data_offset = payload_offset;
+
+						const std::unique_lock<std::mutex> lock(_texture_upload_mutex);
+						_texture_upload_queue.push_back(std::move(upload));
+						return;
+					}
+				}
+
+				log::message(log::level::error, "Failed to load '%s' for texture '%s'!", source_path.u8string().c_str(), texture_name.c_str());
+				_last_reload_successful = false;
+				std::free(file_data);
+			});
 			continue;
 		}
 
-		update_texture(tex, width, height, depth, pixels);
+		// Do not capture a reference to the texture itself, since the texture list may be modified by a background reload while the job is running
+		get_thread_pool().enqueue(_texture_load_job_group, [this, source_path = std::move(source_path), texture_name = tex.unique_name, format = tex.format]() {
+			int width = 0, height = 1, depth = 1;
+			void *const pixels = load_texture_image_data(source_path, texture_name, format, width, height, depth);
+			if (pixels == nullptr)
+			{
+				_last_reload_successful = false;
+				return;
+			}
+
+			pending_texture_upload upload;
+			upload.texture_name = texture_name;
+			upload.width = static_cast<uint32_t>(width);
+			upload.height = static_cast<uint32_t>(height);
+			upload.depth = static_cast<uint32_t>(depth);
+			upload.pixels = pixels;
+
+			const std::unique_lock<std::mutex> lock(_texture_upload_mutex);
+			_texture_upload_queue.push_back(std::move(upload));
+		});
+	}
+
+	// Upload image data that finished decoding, within a per-frame budget, so that a preset with many large textures streams in over a few frames instead of hitching once
+	constexpr size_t texture_upload_budget = 32 * 1024 * 1024;
+
+	for (size_t uploaded_size = 0; uploaded_size < texture_upload_budget;)
+	{
+		pending_texture_upload upload;
+		{	const std::unique_lock<std::mutex> lock(_texture_upload_mutex);
+
+			if (_texture_upload_queue.empty())
+				break;
+			upload = std::move(_texture_upload_queue.back());
+			_texture_upload_queue.pop_back();
+		}
+
+		if (const auto it = std::find_if(_textures.begin(), _textures.end(),
+				[&upload](const texture &tex) { return tex.unique_name == upload.texture_name && tex.resource != 0 && tex.semantic.empty() && tex.compressed_format == upload.compressed_format; });
+			it != _textures.end())
+		{
+			if (upload.compressed_format != api::format::unknown)
+			{
+				// Copy the block-compressed mipmap chain into the texture without any conversion
+				api::command_list *const cmd_list = _graphics_queue->get_immediate_command_list();
+				cmd_list->barrier(it->resource, api::resource_usage::shader_resource, api::resource_usage::copy_dest);
 
-		stbi_image_free(pixels);
+				const uint8_t *level_data = static_cast<const uint8_t *>(upload.pixels) + upload.data_offset;
+				for (uint32_t level = 0; level < upload.levels; ++level)
+				{
+					const uint32_t row_pitch = api::format_row_pitch(upload.compressed_format, std::max(1u, upload.width >> level));
+					const uint32_t slice_pitch = api::format_slice_pitch(upload.compressed_format, row_pitch, std::max(1u, upload.height >> level));
+
+					_device->update_texture_region({ const_cast<uint8_t *>(level_data), row_pitch, slice_pitch }, it->resource, level);
+
+					level_data += slice_pitch;
+					uploaded_size += slice_pitch;
+				}
+
+				cmd_list->barrier(it->resource, api::resource_usage::copy_dest, api::resource_usage::shader_resource);
+			}
+			else
+			{
+				update_texture(*it, upload.width, upload.height, upload.depth, upload.pixels);
 
-		tex.loaded = true;
+				uploaded_size += static_cast<size_t>(upload.width) * static_cast<size_t>(upload.height) * static_cast<size_t>(upload.depth) * 4; // This is only an estimate, since the per-pixel size depends on the texture format
+			}
+
+			it->loaded = true;
+		}
+		// Otherwise the texture was destroyed or recreated differently while its image file was still being read, so simply discard the data
+
+		stbi_image_free(upload.pixels);
 	}
 
-	_textures_loaded = true;
+	// The load cycle is complete once all decode jobs have finished and their results were uploaded above
+	if (_texture_load_job_group.num_pending_jobs == 0)
+	{
+		const std::unique_lock<std::mutex> lock(_texture_upload_mutex);
+
+		if (_texture_upload_queue.empty())
+			_textures_loaded = true;
+	}
 }
 bool reshade::runtime::create_texture(texture &tex)
 {
@@ -3141,6 +4386,39 @@ bool reshade::runtime::create_texture(texture &tex)
 	if (view_format == api::format::unknown)
 		view_format_srgb = view_format = format;
 
+	// Check if the texture is backed by a block-compressed DDS file, in which case the resource is created with the compressed format and the payload uploaded directly without decoding to RGBA (see 'load_textures'), which saves a lot of video memory and upload bandwidth
+	tex.compressed_format = api::format::unknown;
+	if (type == api::resource_type::texture_2d && !tex.render_target && !tex.storage_access && tex.semantic.empty())
+	{
+		std::filesystem::path source_path = std::filesystem::u8path(tex.annotation_as_string("source"));
+		if (!source_path.empty() && find_file(_texture_search_paths, source_path))
+		{
+			uint8_t header_data[148] = {};
+			size_t header_size = 0;
+			if (FILE *const file = _wfsopen(source_path.c_str(), L"rb", SH_DENYNO))
+			{
+				header_size = fread(header_data, 1, sizeof(header_data), file);
+				fclose(file);
+			}
+
+			uint32_t file_width = 0, file_height = 0, file_levels = 1;
+			size_t payload_offset = 0;
+			const api::format file_format = parse_compressed_dds_header(header_data, header_size, file_width, file_height, file_levels, payload_offset);
+
+			// Only use the compressed data when it matches the declared texture dimensions (the decode path can resize image data, but block-compressed data cannot) and contains all requested mipmap levels, and the backend supports sampling and copying this format
+			if (file_format != api::format::unknown &&
+				file_width == tex.width && file_height == tex.height && file_levels >= tex.levels &&
+				_device->check_format_support(file_format, api::resource_usage::shader_resource | api::resource_usage::copy_dest))
+			{
+				tex.compressed_format = file_format;
+
+				format = api::format_to_typeless(file_format);
+				view_format = api::format_to_default_typed(file_format, 0);
+				view_format_srgb = api::format_to_default_typed(file_format, 1);
+			}
+		}
+	}
+
 	api::resource_usage usage = api::resource_usage::shader_resource;
 	usage |= api::resource_usage::copy_source; // For texture data download
 	if (tex.semantic.empty())
@@ -3151,7 +4429,8 @@ bool reshade::runtime::create_texture(texture &tex)
 		usage |= api::resource_usage::unordered_access;
 
 	api::resource_flags flags = api::resource_flags::none;
-	if (tex.levels > 1)
+	// Mipmaps for block-compressed textures come from the file itself and cannot be generated
+	if (tex.levels > 1 && tex.compressed_format == api::format::unknown)
 		flags |= api::resource_flags::generate_mipmaps;
 
 	// Clear texture to zero since by default its contents are undefined
@@ -3179,6 +4458,11 @@ bool reshade::runtime::create_texture(texture &tex)
 
 	_device->set_resource_name(tex.resource, tex.unique_name.c_str());
 
+	// Track the allocation size based on the actual resource format (so that block-compressed textures are accounted correctly), to aggregate memory usage per effect in the statistics overlay and addon API
+	tex.memory_size = 0;
+	for (uint32_t level = 0, width = tex.width, height = tex.height, depth = tex.depth; level < tex.levels; ++level, width = std::max(1u, width / 2), height = std::max(1u, height / 2), depth = std::max(1u, depth / 2))
+		tex.memory_size += static_cast<uint64_t>(api::format_slice_pitch(format, api::format_row_pitch(format, width), height)) * depth;
+
 	// Always create shader resource views
 	{
 		if (!_device->create_resource_view(tex.resource, api::resource_usage::shader_resource, api::resource_view_desc(view_type, view_format, 0, tex.levels, 0, UINT32_MAX), &tex.srv[0]))
@@ -3248,6 +4532,7 @@ void reshade::runtime::destroy_texture(texture &tex)
 
 	_device->destroy_resource(tex.resource);
 	tex.resource = {};
+	tex.memory_size = 0;
 
 	_device->destroy_resource_view(tex.srv[0]);
 	if (tex.srv[1] != tex.srv[0])
@@ -3264,6 +4549,10 @@ void reshade::runtime::destroy_texture(texture &tex)
 	for (const api::resource_view uav : tex.uav)
 		_device->destroy_resource_view(uav);
 	tex.uav.clear();
+
+	// Contents are gone with the resource, so the image file has to be loaded again if this texture is recreated
+	tex.loaded = false;
+	tex.loading = false;
 }
 
 void reshade::runtime::enable_technique(technique &tech)
@@ -3287,6 +4576,7 @@ void reshade::runtime::enable_technique(technique &tech)
 	const bool status_changed = !tech.enabled;
 	tech.enabled = true;
 	tech.time_left = tech.annotation_as_int("timeout");
+	_technique_render_order_invalidated = true;
 
 	// Queue effect file for initialization if it was not fully loaded yet
 	if (tech.passes_data.empty() &&
@@ -3315,8 +4605,11 @@ void reshade::runtime::disable_technique(technique &tech)
 	const bool status_changed = tech.enabled;
 	tech.enabled = false;
 	tech.time_left = 0;
+	_technique_render_order_invalidated = true;
+	tech.budget_interval = 1;
 	tech.average_cpu_duration.clear();
 	tech.average_gpu_duration.clear();
+	tech.gpu_duration_histogram.clear();
 
 	if (status_changed) // Decrease rendering reference count
 		_effects[tech.effect_index].rendering--;
@@ -3357,10 +4650,15 @@ void reshade::runtime::reorder_techniques(std::vector<size_t> &&technique_indice
 #endif
 
 	_technique_sorting = std::move(technique_indices);
+	_technique_render_order_invalidated = true;
 }
 
 void reshade::runtime::load_effects(bool force_load_all)
 {
+	_last_reload_start_time = std::chrono::high_resolution_clock::now();
+	_effect_cache_hits = 0;
+	_effect_cache_misses = 0;
+
 	// Build a list of effect files by walking through the effect search paths
 	const std::vector<std::filesystem::path> effect_files =
 		find_files(_effect_search_paths, { L".fx", L".addonfx" });
@@ -3395,22 +4693,57 @@ void reshade::runtime::load_effects(bool force_load_all)
 	_effects.resize(offset + effect_files.size());
 	_reload_remaining_effects = effect_files.size();
 
-	// Now that we have a list of files, load them in parallel
-	// Split workload into batches instead of launching a thread for every file to avoid launch overhead and stutters due to too many threads being in flight
-	size_t num_splits = std::min(effect_files.size(), static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 2u) - 1));
-#ifndef _WIN64
-	// Limit number of threads in 32-bit due to the limited about of address space being available there and compilation being memory hungry
-	num_splits = std::min(num_splits, static_cast<size_t>(4));
-#endif
+	// Schedule effect files that contain techniques enabled in the current preset first, so that rendering with them can begin long before the entire reload has finished (see 'update_effects')
+	std::vector<std::string> technique_list;
+	preset.get({}, "Techniques", technique_list);
+
+	std::vector<size_t> scheduling_order;
+	scheduling_order.reserve(effect_files.size());
+	std::vector<size_t> background_order;
+	background_order.reserve(effect_files.size());
+
+	for (size_t i = 0; i < effect_files.size(); ++i)
+	{
+		const std::string effect_name = effect_files[i].filename().u8string();
+
+		if (std::find_if(technique_list.cbegin(), technique_list.cend(),
+				[&effect_name](const std::string &technique) {
+					const size_t at_pos = technique.find('@') + 1;
+					return at_pos == 0 || technique.find(effect_name, at_pos) == at_pos;
+				}) != technique_list.cend())
+			scheduling_order.push_back(i);
+		else
+			background_order.push_back(i);
+	}
 
-	// Keep track of the spawned threads, so the runtime cannot be destroyed while they are still running
-	for (size_t n = 0; n < num_splits; ++n)
-		_worker_threads.emplace_back([this, effect_files, offset, num_splits, n, &preset, force_load_all]() {
+	const size_t priority_effect_count = scheduling_order.size();
+
+	// This list stays sorted because the file indices are walked in ascending order above
+	_reload_priority_effect_indices.clear();
+	for (const size_t i : scheduling_order)
+		_reload_priority_effect_indices.push_back(offset + i);
+
+	_reload_preset_applied_early = false;
+	// Only track priority effects separately if there are also background effects, otherwise there is nothing to get ahead of
+	_reload_priority_remaining_effects = (priority_effect_count != 0 && !background_order.empty()) ? priority_effect_count : std::numeric_limits<size_t>::max();
+
+	scheduling_order.insert(scheduling_order.end(), background_order.begin(), background_order.end());
+
+	// Now that we have a list of files, load them in parallel
+	// Submit one job per file to the shared thread pool, rather than spawning threads, so that threads stay warm across reloads and work is stolen between them when effect files vary wildly in compilation time
+	thread_pool &pool = get_thread_pool();
+	for (size_t k = 0; k < scheduling_order.size(); ++k)
+	{
+		const size_t i = scheduling_order[k];
+		pool.enqueue(_reload_job_group, [this, effect_file = effect_files[i], index = offset + i, priority = (k < priority_effect_count), &preset, force_load_all]() {
 			// Abort loading when initialization state changes (indicating that 'on_reset' was called in the meantime)
-			for (size_t i = 0; i < effect_files.size() && _is_initialized; ++i)
-				if (i * num_splits / effect_files.size() == n)
-					load_effect(effect_files[i], preset, offset + i, force_load_all || effect_files[i].extension() == L".addonfx");
+			if (_is_initialized)
+				load_effect(effect_file, preset, index, force_load_all || effect_file.extension() == L".addonfx");
+
+			if (priority && _reload_priority_remaining_effects != std::numeric_limits<size_t>::max())
+				_reload_priority_remaining_effects--;
 		});
+	}
 }
 bool reshade::runtime::reload_effect(size_t effect_index)
 {
@@ -3418,6 +4751,10 @@ bool reshade::runtime::reload_effect(size_t effect_index)
 	_show_splash = false; // Hide splash bar when reloading a single effect file
 #endif
 
+	_last_reload_start_time = std::chrono::high_resolution_clock::now();
+	_effect_cache_hits = 0;
+	_effect_cache_misses = 0;
+
 	// Make sure no effect resources are currently in use
 	_graphics_queue->wait_idle();
 
@@ -3453,9 +4790,132 @@ void reshade::runtime::reload_effects(bool force_load_all)
 
 	load_effects(force_load_all);
 }
+void reshade::runtime::start_effect_file_watcher()
+{
+	if (!_watch_effect_files || _effect_file_watcher != nullptr)
+		return;
+
+	std::error_code ec;
+	std::vector<std::pair<std::filesystem::path, bool>> directories;
+	directories.reserve(_effect_search_paths.size());
+	for (std::filesystem::path search_path : _effect_search_paths)
+	{
+		const bool recursive_search = search_path.filename() == L"**";
+		if (recursive_search)
+			search_path.remove_filename();
+
+		if (resolve_path(search_path, ec))
+			directories.emplace_back(std::move(search_path), recursive_search);
+	}
+
+	_effect_file_watch_time = std::filesystem::file_time_type::clock::now();
+
+	// The callback only sets a flag, so that the timestamp scan and reload scheduling happen on the thread calling 'update_effects'
+	_effect_file_watcher = utils::start_directory_watch(directories,
+		[](void *user_data) {
+			static_cast<runtime *>(user_data)->_effect_files_possibly_changed.store(true, std::memory_order_relaxed);
+		}, this);
+}
+void reshade::runtime::stop_effect_file_watcher()
+{
+	utils::stop_directory_watch(_effect_file_watcher);
+	_effect_file_watcher = nullptr;
+}
+void reshade::runtime::check_for_effect_file_changes()
+{
+	if (!_effect_files_possibly_changed.exchange(false, std::memory_order_relaxed))
+		return;
+
+	const std::filesystem::file_time_type watch_time = _effect_file_watch_time;
+	_effect_file_watch_time = std::filesystem::file_time_type::clock::now();
+
+	std::error_code ec;
+	const auto modified_since_watch = [&ec, watch_time](const std::filesystem::path &file) {
+		const std::filesystem::file_time_type write_time = std::filesystem::last_write_time(file, ec);
+		return !ec && write_time > watch_time;
+	};
+
+	for (size_t effect_index = 0; effect_index < _effects.size(); ++effect_index)
+	{
+		const effect &effect = _effects[effect_index];
+		if (effect.source_file.empty())
+			continue;
+
+		if (!modified_since_watch(effect.source_file) &&
+			std::none_of(effect.included_files.cbegin(), effect.included_files.cend(), modified_since_watch))
+			continue;
+
+		// Only schedule the effects that reference the modified file for a reload, so that a save-and-check loop on a single file does not trigger a full preset reload
+		if (std::find(_reload_required_effects.cbegin(), _reload_required_effects.cend(), effect_index) == _reload_required_effects.cend())
+			_reload_required_effects.push_back(effect_index);
+	}
+}
+void reshade::runtime::precompile_presets()
+{
+	assert(!_precompile_presets_started);
+	_precompile_presets_started = true;
+
+	// The HLSL compiler module stays loaded while any effects exist, so the jobs below can rely on it (see 'destroy_effects')
+	if (_d3d_compiler_module == nullptr && (_renderer_id & 0xF0000) == 0)
+		return;
+
+	std::error_code ec;
+	for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(_current_preset_path.parent_path(), std::filesystem::directory_options::skip_permission_denied, ec))
+	{
+		const std::filesystem::path preset_path = entry.path();
+		if (preset_path.extension() != L".ini" || std::filesystem::equivalent(preset_path, _current_preset_path, ec))
+			continue;
+
+		const ini_file &preset = ini_file::load_cache(preset_path);
+
+		std::vector<std::string> technique_list;
+		if (!preset.get({}, "Techniques", technique_list) || technique_list.empty())
+			continue; // Skip INI files that are not presets (or presets without any enabled techniques)
+
+		// Union the effect files this preset references, so that each is only compiled once per preset
+		std::vector<std::filesystem::path> effect_files;
+		for (const std::string &technique_name : technique_list)
+		{
+			const size_t at_pos = technique_name.find('@');
+			if (at_pos == std::string::npos)
+				continue;
+
+			const auto it = std::find_if(_effects.cbegin(), _effects.cend(),
+				[effect_name = std::filesystem::u8path(technique_name.substr(at_pos + 1))](const effect &effect) {
+					return effect_name == effect.source_file.filename();
+				});
+			if (it == _effects.cend())
+				continue;
+
+			if (std::find(effect_files.cbegin(), effect_files.cend(), it->source_file) == effect_files.cend())
+				effect_files.push_back(it->source_file);
+		}
+
+		for (const std::filesystem::path &source_file : effect_files)
+		{
+			get_thread_pool().enqueue(_precompile_job_group,
+				[this, source_file, preset_path]() {
+					// The effect index is unused in cache-only mode and failures only affect the cache, so the result can be ignored
+					load_effect(source_file, ini_file::load_cache(preset_path), std::numeric_limits<size_t>::max(), false, false, true);
+				});
+		}
+	}
+}
 void reshade::runtime::destroy_effects()
 {
-	// Make sure no threads are still accessing effect data
+	// Make sure no thread pool jobs are still accessing effect data (or the HLSL compiler module, which is freed below)
+	get_thread_pool().wait(_reload_job_group);
+	get_thread_pool().wait(_texture_load_job_group);
+	get_thread_pool().wait(_precompile_job_group);
+
+	// Discard any image data that was still waiting to be uploaded to a texture
+	{	const std::unique_lock<std::mutex> lock(_texture_upload_mutex);
+
+		for (const pending_texture_upload &upload : _texture_upload_queue)
+			stbi_image_free(upload.pixels);
+		_texture_upload_queue.clear();
+	}
+
 	for (std::thread &thread : _worker_threads)
 		if (thread.joinable())
 			thread.join();
@@ -3467,6 +4927,9 @@ void reshade::runtime::destroy_effects()
 
 	// Reset the effect creation queue
 	_reload_create_queue.clear();
+	_reload_priority_remaining_effects = std::numeric_limits<size_t>::max();
+	_reload_priority_effect_indices.clear();
+	_reload_preset_applied_early = false;
 
 	// Make sure no effect resources are currently in use (do this even when the effect list is empty, since it is dependent upon by 'on_reset')
 	_graphics_queue->wait_idle();
@@ -3474,7 +4937,24 @@ void reshade::runtime::destroy_effects()
 	for (size_t effect_index = 0; effect_index < _effects.size(); ++effect_index)
 		destroy_effect(effect_index);
 
+	// All query allocations were released above, so the pooled query heap can be destroyed as well
+	_device->destroy_query_heap(_effect_query_heap);
+	_effect_query_heap = {};
+	_effect_query_heap_pairs = 0;
+	_effect_query_results.clear();
+	_effect_query_results_valid.clear();
+	_effect_query_pending_ranges.clear();
+
 	// Reset the effect list after all resources have been destroyed
+	// Releasing the effect data (module metadata with its many small string and vector allocations, assembly listings, preprocessed source, ...) serially takes measurable time with a large effect list, so hand it off to the thread pool instead (wrapped in a shared pointer, since 'std::function' requires a copyable job)
+	if (!_effects.empty())
+	{
+		// Use a process-lifetime job group for this fire-and-forget job rather than '_reload_job_group', since nothing waits on it before this runtime (and with it its job group members) may be destroyed, which would leave the pool worker decrementing the pending job count of a freed group (intentionally leaked for the same reason as the thread pool itself, see 'get_thread_pool')
+		static thread_pool::job_group *const s_destroy_job_group = new thread_pool::job_group();
+
+		const auto effects_to_destroy = std::make_shared<std::vector<effect>>(std::move(_effects));
+		get_thread_pool().enqueue(*s_destroy_job_group, [effects_to_destroy]() { effects_to_destroy->clear(); });
+	}
 	_effects.clear();
 
 	// Clean up sampler objects
@@ -3500,60 +4980,55 @@ void reshade::runtime::destroy_effects()
 bool reshade::runtime::load_effect_cache(const std::string &id, const std::string &type, std::string &data) const
 {
 	if (_no_effect_cache)
-		return false;
-
-	std::filesystem::path path = g_reshade_base_path / _effect_cache_path;
-	path /= std::filesystem::u8path("reshade-" + id + '.' + type);
-
-	FILE *const file = _wfsopen(path.c_str(), L"rb", SH_DENYNO);
-	if (file == nullptr)
-		return false;
-
-	fseek(file, 0, SEEK_END);
-	const size_t file_size = ftell(file);
-	fseek(file, 0, SEEK_SET);
+		// Fall back to the process-wide memory cache, so that effect runtimes created for additional swapchains can still reuse the artifacts compiled by the first one
+		return effect_cache::load_from_memory(id, type, data);
 
-	data.resize(file_size, '\0');
-	const size_t file_size_read = fread(data.data(), 1, data.size(), file);
-	fclose(file);
-	return file_size_read == data.size();
+	return effect_cache::load(g_reshade_base_path / _effect_cache_path, id, type, data);
 }
 bool reshade::runtime::save_effect_cache(const std::string &id, const std::string &type, const std::string &data) const
 {
 	if (_no_effect_cache)
-		return false;
-
-	std::filesystem::path path = g_reshade_base_path / _effect_cache_path;
-	path /= std::filesystem::u8path("reshade-" + id + '.' + type);
+		return effect_cache::save_to_memory(id, type, data);
 
-	FILE *const file = _wfsopen(path.c_str(), L"wb", SH_DENYNO);
-	if (file == nullptr)
-		return false;
-
-	const size_t file_size_written = fwrite(data.data(), 1, data.size(), file);
-	fclose(file);
-	return file_size_written == data.size();
+	return effect_cache::save(g_reshade_base_path / _effect_cache_path, id, type, data);
 }
 void reshade::runtime::clear_effect_cache()
 {
-	std::error_code ec;
+	effect_cache::clear(g_reshade_base_path / _effect_cache_path);
+}
 
-	// Find all cached effect files and delete them
-	for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(g_reshade_base_path / _effect_cache_path, std::filesystem::directory_options::skip_permission_denied, ec))
-	{
-		if (entry.is_directory(ec))
-			continue;
+std::string reshade::runtime::get_effect_assembly_text(const effect &effect, const std::string &entry_point_name) const
+{
+	const auto assembly_it = effect.assembly_text.find(entry_point_name);
+	if (assembly_it == effect.assembly_text.end())
+		return std::string();
+	if (!assembly_it->second.empty())
+		return assembly_it->second;
+
+	// The disassembly is not kept in memory, but loaded from the effect cache on demand when it is actually displayed (see 'compile_effect_entry_point')
+	std::string assembly_text;
+	if (const auto cache_id_it = effect.assembly_cache_ids.find(entry_point_name);
+		cache_id_it != effect.assembly_cache_ids.end())
+		load_effect_cache(cache_id_it->second, "asm", assembly_text);
+	return assembly_text;
+}
+std::string reshade::runtime::get_effect_generated_code(const effect &effect) const
+{
+	if (!effect.generated_code.empty() || effect.module_cache_id.empty())
+		return effect.generated_code;
 
-		const std::filesystem::path filename = entry.path().filename();
-		const std::filesystem::path extension = entry.path().extension();
-		if (filename.native().compare(0, 8, L"reshade-") != 0 || (extension != L".i" && extension != L".cso" && extension != L".asm"))
-			continue;
+	// The generated code was released after pipeline creation, so restore it from the serialized module in the effect cache (see 'create_effect')
+	std::string module_data;
+	if (!load_effect_cache(effect.module_cache_id, "mod", module_data))
+		return std::string();
 
-		std::filesystem::remove(entry, ec);
-	}
+	reshadefx::effect_module module;
+	std::string generated_code;
+	std::unordered_map<std::string, std::string> entry_point_code;
+	if (!reshadefx::deserialize_effect_module(module_data, module, generated_code, entry_point_code))
+		return std::string();
 
-	if (ec)
-		log::message(log::level::error, "Failed to clear effect cache directory with error code %d!", ec.value());
+	return generated_code;
 }
 
 bool reshade::runtime::update_effect_color_and_stencil_tex(uint32_t width, uint32_t height, api::format color_format, api::format stencil_format)
@@ -3582,6 +5057,9 @@ bool reshade::runtime::update_effect_color_and_stencil_tex(uint32_t width, uint3
 		_effect_stencil_tex = {};
 		_device->destroy_resource_view(_effect_stencil_dsv);
 		_effect_stencil_dsv = {};
+
+		// The scaled render targets derive their resolution and format from the effect color resource, so recreate them alongside it
+		destroy_scaled_render_targets();
 	}
 
 	if (!_device->create_resource(
@@ -3655,12 +5133,109 @@ bool reshade::runtime::update_effect_color_and_stencil_tex(uint32_t width, uint3
 	return true;
 }
 
+const reshade::runtime::scaled_render_target *reshade::runtime::acquire_scaled_render_target(float scale)
+{
+	const uint32_t width = std::max(static_cast<uint32_t>(_effect_width * scale), 1u);
+	const uint32_t height = std::max(static_cast<uint32_t>(_effect_height * scale), 1u);
+
+	for (const scaled_render_target &target : _scaled_render_targets)
+		if (target.width == width && target.height == height)
+			return target.tex != 0 ? &target : nullptr;
+
+	scaled_render_target target;
+	target.width = width;
+	target.height = height;
+
+	if (!_device->create_resource(
+			api::resource_desc(width, height, 1, 1, _effect_color_format, 1, api::memory_heap::gpu_only, api::resource_usage::render_target | api::resource_usage::shader_resource | api::resource_usage::copy_source | api::resource_usage::copy_dest),
+			nullptr, api::resource_usage::shader_resource, &target.tex) ||
+		!_device->create_resource_view(target.tex, api::resource_usage::render_target, api::resource_view_desc(api::format_to_default_typed(_effect_color_format, 0)), &target.rtv[0]) ||
+		!_device->create_resource_view(target.tex, api::resource_usage::render_target, api::resource_view_desc(api::format_to_default_typed(_effect_color_format, 1)), &target.rtv[1]) ||
+		!_device->create_resource_view(target.tex, api::resource_usage::shader_resource, api::resource_view_desc(api::format_to_default_typed(_effect_color_format, 0)), &target.srv))
+	{
+		log::message(log::level::error, "Failed to create scaled render target (width = %u, height = %u, format = %u)!", width, height, static_cast<uint32_t>(_effect_color_format));
+
+		_device->destroy_resource_view(target.rtv[0]);
+		_device->destroy_resource_view(target.rtv[1]);
+		_device->destroy_resource(target.tex);
+
+		// Remember this resolution as failed, so that it is not attempted again every frame
+		target = scaled_render_target { width, height };
+		_scaled_render_targets.push_back(target);
+		return nullptr;
+	}
+
+	_device->set_resource_name(target.tex, "ReShade scaled render target");
+
+	return &_scaled_render_targets.emplace_back(target);
+}
+void reshade::runtime::destroy_scaled_render_targets()
+{
+	for (const scaled_render_target &target : _scaled_render_targets)
+	{
+		_device->destroy_resource_view(target.rtv[0]);
+		_device->destroy_resource_view(target.rtv[1]);
+		_device->destroy_resource_view(target.srv);
+		_device->destroy_resource(target.tex);
+	}
+
+	_scaled_render_targets.clear();
+}
+
+void reshade::runtime::stretch_texture(api::command_list *cmd_list, api::resource source, api::resource_view source_srv, api::resource_usage source_usage, uint32_t source_width, uint32_t source_height, api::resource dest, api::resource_view dest_rtv, api::resource_usage dest_usage, uint32_t dest_width, uint32_t dest_height)
+{
+	const api::resource resources[2] = { source, dest };
+	const api::resource_usage state_old[2] = { source_usage, dest_usage };
+
+	if (_copy_pipeline != 0)
+	{
+		// D3D10, D3D11 and D3D12 cannot stretch in a copy command, so render a fullscreen triangle sampling the source with linear filtering instead
+		const api::resource_usage state_new[2] = { api::resource_usage::shader_resource, api::resource_usage::render_target };
+
+		cmd_list->barrier(2, resources, state_old, state_new);
+
+		cmd_list->bind_pipeline(api::pipeline_stage::all_graphics, _copy_pipeline);
+
+		cmd_list->push_descriptors(api::shader_stage::pixel, _copy_pipeline_layout, 0, api::descriptor_table_update { {}, 0, 0, 1, api::descriptor_type::sampler, &_scale_sampler_state });
+		cmd_list->push_descriptors(api::shader_stage::pixel, _copy_pipeline_layout, 1, api::descriptor_table_update { {}, 0, 0, 1, api::descriptor_type::shader_resource_view, &source_srv });
+
+		const api::viewport viewport = { 0.0f, 0.0f, static_cast<float>(dest_width), static_cast<float>(dest_height), 0.0f, 1.0f };
+		cmd_list->bind_viewports(0, 1, &viewport);
+		const api::rect scissor_rect = { 0, 0, static_cast<int32_t>(dest_width), static_cast<int32_t>(dest_height) };
+		cmd_list->bind_scissor_rects(0, 1, &scissor_rect);
+
+		cmd_list->bind_render_targets_and_depth_stencil(1, &dest_rtv);
+
+		cmd_list->draw(3, 1, 0, 0);
+
+		cmd_list->barrier(2, resources, state_new, state_old);
+	}
+	else
+	{
+		const api::resource_usage state_new[2] = { api::resource_usage::copy_source, api::resource_usage::copy_dest };
+
+		cmd_list->barrier(2, resources, state_old, state_new);
+
+		const api::subresource_box source_box = { 0, 0, 0, static_cast<int32_t>(source_width), static_cast<int32_t>(source_height), 1 };
+		const api::subresource_box dest_box = { 0, 0, 0, static_cast<int32_t>(dest_width), static_cast<int32_t>(dest_height), 1 };
+		cmd_list->copy_texture_region(source, 0, &source_box, dest, 0, &dest_box, api::filter_mode::min_mag_mip_linear);
+
+		cmd_list->barrier(2, resources, state_new, state_old);
+	}
+}
+
 void reshade::runtime::update_effects()
 {
+	const trace::scoped_event trace_scope("update_effects");
+	const profiling::scoped_cpu_timer profile_scope("update_effects");
+
 	// Delay first load to the first render call to avoid loading while the application is still initializing
 	if (_frame_count == 0 && !_no_reload_on_init)
 		reload_effects();
 
+	if (_effect_file_watcher != nullptr && !is_loading())
+		check_for_effect_file_changes();
+
 	if (!_reload_required_effects.empty() && !is_loading())
 	{
 		save_current_preset(); // Save preset preprocessor definitions
@@ -3689,6 +5264,9 @@ void reshade::runtime::update_effects()
 				thread.join(); // Threads have exited, but still need to join them prior to destruction
 		_worker_threads.clear();
 
+		// The entire reload has finished, so the preset below is applied to all effects rather than just the priority ones
+		_reload_priority_remaining_effects = std::numeric_limits<size_t>::max();
+
 		// Finished loading effects, so apply preset to figure out which ones need compiling
 		load_current_preset();
 
@@ -3699,6 +5277,23 @@ void reshade::runtime::update_effects()
 		_last_reload_time = std::chrono::high_resolution_clock::now();
 		_reload_remaining_effects = std::numeric_limits<size_t>::max();
 
+		if (_performance_log_interval != 0)
+		{
+			// Record how long the reload took and how effective the effect cache was, so that external tooling can spot cold caches and compile time regressions
+			char line[96];
+			const auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+			const auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(_last_reload_time - _last_reload_start_time).count();
+			_performance_log_pending.append(line, std::snprintf(line, sizeof(line), "%lld,reload,%lld,%u,%u\n", static_cast<long long>(timestamp), static_cast<long long>(duration_ms), _effect_cache_hits.load(), _effect_cache_misses.load()));
+		}
+
+		// Start pre-populating the effect cache for the other presets in the background, so that later preset switches hit a warm cache
+		if (_precompile_presets && !_precompile_presets_started)
+			precompile_presets();
+
+		if (_reload_preset_applied_early)
+			// Force texture loading below to run once more, so that the 'reshade_reloaded_effects' event is invoked again now that the entire reload has finished
+			_textures_loaded = false;
+
 #if RESHADE_GUI
 		// Update all code editors after a reload
 		for (editor_instance &instance : _editors)
@@ -3724,71 +5319,162 @@ void reshade::runtime::update_effects()
 	}
 
 	if (_reload_remaining_effects != std::numeric_limits<size_t>::max())
-		return;
+	{
+		// All effects with techniques enabled in the current preset have finished compiling, so apply the preset to them and start rendering, while the remaining effects continue compiling in the background
+		if (_reload_priority_remaining_effects == 0)
+		{
+			{	// Block worker threads from registering new textures and techniques while the preset is applied
+				const std::unique_lock<std::shared_mutex> lock(_reload_mutex);
+
+				load_current_preset();
+			}
+
+			_reload_priority_remaining_effects = std::numeric_limits<size_t>::max();
+			_reload_preset_applied_early = true;
+		}
+
+		if (!_reload_preset_applied_early)
+			return;
+	}
+
+	// Block worker threads from registering new textures and techniques while the lists are accessed below, in case a reload is still running in the background
+	std::shared_lock<std::shared_mutex> reload_lock(_reload_mutex, std::defer_lock);
+	if (_reload_remaining_effects != std::numeric_limits<size_t>::max())
+		reload_lock.lock();
 
 	if (!_reload_create_queue.empty())
 	{
-		// Pop an effect from the queue
-		const size_t effect_index = _reload_create_queue.back();
-		_reload_create_queue.pop_back();
+		// Create GPU objects for multiple effects per frame within a time budget, so that a preset with many effects does not take one frame per effect to converge after a reload
+		const uint64_t create_budget = static_cast<uint64_t>(_effect_create_budget * 1000000.0f);
+		const std::chrono::high_resolution_clock::time_point create_start_time = std::chrono::high_resolution_clock::now();
 
-		if (!create_effect(effect_index))
+		do
 		{
-			_graphics_queue->wait_idle();
+			// Pop an effect from the queue
+			const size_t effect_index = _reload_create_queue.back();
+			_reload_create_queue.pop_back();
 
-			// Destroy all textures belonging to this effect
-			for (texture &tex : _textures)
-				if (tex.effect_index == effect_index && tex.shared.size() <= 1)
-					destroy_texture(tex);
-			// Disable all techniques belonging to this effect
-			for (technique &tech : _techniques)
-				if (tech.effect_index == effect_index)
-					disable_technique(tech);
+			if (!create_effect(effect_index))
+			{
+				_graphics_queue->wait_idle();
 
-			_effects[effect_index].compiled = false;
-			_last_reload_successful = false;
-		}
+				// Destroy all textures belonging to this effect
+				for (texture &tex : _textures)
+					if (tex.effect_index == effect_index && tex.shared.size() <= 1)
+						destroy_texture(tex);
+				// Disable all techniques belonging to this effect
+				for (technique &tech : _techniques)
+					if (tech.effect_index == effect_index)
+						disable_technique(tech);
+
+				_effects[effect_index].compiled = false;
+				_last_reload_successful = false;
+			}
 
-		// An effect has changed, need to reload textures
-		_textures_loaded = false;
+			// An effect has changed, need to reload textures
+			_textures_loaded = false;
 
 #if RESHADE_GUI
-		const effect &effect = _effects[effect_index];
+			const effect &effect = _effects[effect_index];
 
-		// Update assembly in all code editors after a reload
-		for (editor_instance &instance : _editors)
-		{
-			if (!instance.generated || instance.entry_point_name.empty() || instance.file_path != effect.source_file)
-				continue;
+			// Update assembly in all code editors after a reload
+			for (editor_instance &instance : _editors)
+			{
+				if (!instance.generated || instance.entry_point_name.empty() || instance.file_path != effect.source_file)
+					continue;
 
-			assert(instance.effect_index == effect_index);
+				assert(instance.effect_index == effect_index);
 
-			if (effect.assembly_text.find(instance.entry_point_name) != effect.assembly_text.end())
-				open_code_editor(instance);
-		}
+				if (effect.assembly_text.find(instance.entry_point_name) != effect.assembly_text.end())
+					open_code_editor(instance);
+			}
 #endif
+		}
+		while (!_reload_create_queue.empty() &&
+			static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - create_start_time).count()) < create_budget);
+
+		// Effects were created (or destroyed on failure) above, which affects which techniques render and with what resources
+		_technique_render_order_invalidated = true;
 	}
 
 	if (!_textures_loaded && _reload_create_queue.empty())
 	{
-		// Now that all effects were created, load all textures
+		// Now that all effects were created, stream in texture data (this dispatches decode jobs on the first call and uploads the finished results on subsequent calls)
 		load_textures();
 
+		if (_textures_loaded)
+		{
 #if RESHADE_ADDON
-		invoke_addon_event<addon_event::reshade_reloaded_effects>(this);
+			invoke_addon_event<addon_event::reshade_reloaded_effects>(this);
 #endif
+
+			if (_reload_remaining_effects == std::numeric_limits<size_t>::max())
+				_reload_preset_applied_early = false;
+		}
 	}
+
+	if (_share_uniform_variables)
+		update_shared_uniform_variables();
 }
-void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource_view rtv, api::resource_view rtv_srgb)
+void reshade::runtime::update_effect_gpu_budget()
 {
-	// Do not render effects twice in a frame
-	if (_effects_rendered_this_frame)
-		return;
-	_effects_rendered_this_frame = true;
+	const uint64_t budget = static_cast<uint64_t>(_effect_gpu_budget * 1000000.0f);
 
-	// Nothing to do here if effects are still loading or disabled globally
-	if (is_loading() || !_effects_enabled || _techniques.empty())
-		return;
+	// Calculate the amortized GPU time all enabled techniques are expected to take per frame, based on the timestamp query results
+	uint64_t total_duration = 0;
+	for (const technique &tech : _techniques)
+	{
+		if (tech.passes_data.empty() || !tech.enabled)
+			continue;
+
+		total_duration += static_cast<uint64_t>(tech.average_gpu_duration) / tech.budget_interval;
+	}
+
+	if (total_duration > budget)
+	{
+		// Over budget, so halve the frequency of the technique currently contributing the most GPU time (but do not go below running every fourth frame, so that divided effects do not get too stale)
+		technique *most_expensive_technique = nullptr;
+		uint64_t most_expensive_duration = 0;
+
+		for (technique &tech : _techniques)
+		{
+			if (tech.passes_data.empty() || !tech.enabled || tech.budget_interval >= 4)
+				continue;
+
+			if (const uint64_t duration = static_cast<uint64_t>(tech.average_gpu_duration) / tech.budget_interval;
+				duration > most_expensive_duration)
+			{
+				most_expensive_technique = &tech;
+				most_expensive_duration = duration;
+			}
+		}
+
+		if (most_expensive_technique != nullptr)
+			most_expensive_technique->budget_interval *= 2;
+	}
+	else
+	{
+		for (technique &tech : _techniques)
+		{
+			if (tech.passes_data.empty() || !tech.enabled || tech.budget_interval <= 1)
+				continue;
+
+			// Restore the frequency of a divided technique only when doing so leaves ten percent headroom, so that the scheduler does not oscillate around the budget
+			// Doubling the frequency adds the current amortized duration of the technique on top again
+			if (const uint64_t restored_duration = static_cast<uint64_t>(tech.average_gpu_duration) / tech.budget_interval;
+				total_duration + restored_duration < budget - budget / 10)
+			{
+				tech.budget_interval /= 2;
+				// Only restore a single technique per frame, to observe the effect on the timings of the next frames before restoring more
+				break;
+			}
+		}
+	}
+}
+
+void reshade::runtime::update_special_uniform_variables()
+{
+	_special_uniforms_updated_this_frame = true;
 
 	// Lock input so it cannot be modified by other threads while we are reading it here
 	std::unique_lock<std::recursive_mutex> input_lock;
@@ -3805,9 +5491,12 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 		if (!effect.rendering)
 			continue;
 
-		for (uniform &variable : effect.uniforms)
+		for (const special_uniform_data &special_data : effect.special_uniforms)
 		{
-			switch (variable.special)
+			// Only the data layout fields of the variable are accessed below, annotation parameters were already resolved during loading
+			uniform &variable = effect.uniforms[special_data.uniform_index];
+
+			switch (special_data.special)
 			{
 				case special_uniform::frame_time:
 				{
@@ -3824,19 +5513,19 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 				}
 				case special_uniform::random:
 				{
-					const int min = variable.annotation_as_int("min", 0, 0);
-					const int max = variable.annotation_as_int("max", 0, RAND_MAX);
+					const int min = special_data.min_int;
+					const int max = special_data.max_int;
 					set_uniform_value(variable, min + (std::rand() % (std::abs(max - min) + 1)));
 					break;
 				}
 				case special_uniform::ping_pong:
 				{
-					const float min = variable.annotation_as_float("min", 0, 0.0f);
-					const float max = variable.annotation_as_float("max", 0, 1.0f);
-					const float step_min = variable.annotation_as_float("step", 0);
-					const float step_max = variable.annotation_as_float("step", 1);
+					const float min = special_data.min;
+					const float max = special_data.max;
+					const float step_min = special_data.step[0];
+					const float step_max = special_data.step[1];
 					float increment = step_max == 0 ? step_min : (step_min + std::fmod(static_cast<float>(std::rand()), step_max - step_min + 1));
-					const float smoothing = variable.annotation_as_float("smoothing");
+					const float smoothing = special_data.smoothing;
 
 					float value[2] = { 0, 0 };
 					get_uniform_value(variable, value, 2);
@@ -3884,18 +5573,17 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 					if (_input == nullptr)
 						break;
 
-					if (const int keycode = variable.annotation_as_int("keycode");
+					if (const int keycode = special_data.keycode;
 						keycode > 7 && keycode < 256)
 					{
-						if (const std::string_view mode = variable.annotation_as_string("mode");
-							mode == "toggle" || variable.annotation_as_int("toggle"))
+						if (special_data.toggle)
 						{
 							bool current_value = false;
 							get_uniform_value(variable, &current_value);
 							if (_input->is_key_pressed(keycode))
 								set_uniform_value(variable, !current_value);
 						}
-						else if (mode == "press")
+						else if (special_data.press)
 							set_uniform_value(variable, _input->is_key_pressed(keycode));
 						else
 							set_uniform_value(variable, _input->is_key_down(keycode));
@@ -3923,18 +5611,17 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 					if (_input == nullptr)
 						break;
 
-					if (const int keycode = variable.annotation_as_int("keycode");
+					if (const int keycode = special_data.keycode;
 						keycode >= 0 && keycode < 5)
 					{
-						if (const std::string_view mode = variable.annotation_as_string("mode");
-							mode == "toggle" || variable.annotation_as_int("toggle"))
+						if (special_data.toggle)
 						{
 							bool current_value = false;
 							get_uniform_value(variable, &current_value);
 							if (_input->is_mouse_button_pressed(keycode))
 								set_uniform_value(variable, !current_value);
 						}
-						else if (mode == "press")
+						else if (special_data.press)
 							set_uniform_value(variable, _input->is_mouse_button_pressed(keycode));
 						else
 							set_uniform_value(variable, _input->is_mouse_button_down(keycode));
@@ -3946,9 +5633,9 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 					if (_input == nullptr)
 						break;
 
-					const float min = variable.annotation_as_float("min");
-					const float max = variable.annotation_as_float("max");
-					float step = variable.annotation_as_float("step");
+					const float min = special_data.min;
+					const float max = special_data.max;
+					float step = special_data.step[0];
 					if (step == 0.0f)
 						step  = 1.0f;
 
@@ -3984,9 +5671,275 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 					set_uniform_value(variable, _should_save_screenshot);
 					break;
 				}
+				case special_uniform::view_count:
+				{
+					// Effects are rendered in a single pass covering all views, with VR compositing both eyes side by side into the back buffer, so expose the layout for effects that need to treat each eye separately
+					if (variable.type.is_boolean())
+						set_uniform_value(variable, _is_vr);
+					else
+						set_uniform_value(variable, _is_vr ? 2u : 1u);
+					break;
+				}
 			}
 		}
 	}
+}
+
+// Uniform value block shared between runtime instances, bumping a generation counter on every value change, so that other runtimes can detect changes with a single counter comparison instead of comparing or polling values
+struct reshade::shared_uniform_block
+{
+	std::shared_mutex mutex;
+	std::atomic<uint64_t> generation = 1;
+	std::vector<uint8_t> data;
+};
+
+// Registry of the blocks above keyed by preset and effect, so that runtimes rendering the same preset (e.g. a desktop mirror next to a VR runtime) find each other
+static std::shared_mutex s_shared_uniform_blocks_mutex;
+static std::unordered_map<std::wstring, std::weak_ptr<reshade::shared_uniform_block>> s_shared_uniform_blocks;
+
+void reshade::runtime::update_shared_uniform_variables()
+{
+	// A preset switch re-keys the shared blocks, so detach all effects and have them re-attach under the new preset below
+	if (_shared_uniform_preset_path != _current_preset_path)
+	{
+		for (effect &effect : _effects)
+		{
+			effect.shared_uniforms.reset();
+			effect.shared_uniform_generation = 0;
+		}
+
+		_shared_uniform_preset_path = _current_preset_path;
+	}
+
+	// Wait until the preset was applied before attaching, so that the first runtime publishes the preset values rather than defaults
+	if (is_loading())
+		return;
+
+	for (effect &effect : _effects)
+	{
+		if (!effect.compiled || effect.skipped || effect.uniform_data_storage.empty())
+			continue;
+
+		if (effect.shared_uniforms == nullptr)
+		{
+			// A maximum generation marks an effect whose uniform layout did not match the existing shared block (e.g. because another runtime compiled it for a different shader model), so do not try to attach it again every frame
+			if (effect.shared_uniform_generation == std::numeric_limits<uint64_t>::max())
+				continue;
+
+			std::shared_ptr<shared_uniform_block> block;
+			{
+				const std::wstring key = _current_preset_path.wstring() + L'?' + effect.source_file.filename().wstring();
+
+				const std::unique_lock<std::shared_mutex> registry_lock(s_shared_uniform_blocks_mutex);
+
+				std::weak_ptr<shared_uniform_block> &entry = s_shared_uniform_blocks[key];
+				block = entry.lock();
+				if (block == nullptr)
+				{
+					block = std::make_shared<shared_uniform_block>();
+					entry = block;
+				}
+			}
+
+			const std::unique_lock<std::shared_mutex> lock(block->mutex);
+
+			if (block->data.empty())
+			{
+				// This runtime is the first to attach this effect, so publish its current values
+				block->data = effect.uniform_data_storage;
+				effect.shared_uniform_generation = block->generation;
+			}
+			else if (block->data.size() == effect.uniform_data_storage.size())
+			{
+				// Another runtime already published values for this effect, so adopt them
+				std::memcpy(effect.uniform_data_storage.data(), block->data.data(), block->data.size());
+				effect.uniform_data_dirty_begin = 0;
+				effect.uniform_data_dirty_end = effect.uniform_data_storage.size();
+				effect.shared_uniform_generation = block->generation;
+			}
+			else
+			{
+				effect.shared_uniform_generation = std::numeric_limits<uint64_t>::max();
+				continue;
+			}
+
+			effect.shared_uniforms = std::move(block);
+			continue;
+		}
+
+		shared_uniform_block &block = *effect.shared_uniforms;
+
+		// Cheap check without taking the lock first, values only need copying when another runtime bumped the generation
+		if (block.generation.load(std::memory_order_relaxed) == effect.shared_uniform_generation)
+			continue;
+
+		const std::shared_lock<std::shared_mutex> lock(block.mutex);
+
+		// Special uniform variables are overwritten with this runtime's own state every frame afterwards, so copying the entire block is safe (see 'update_special_uniform_variables')
+		std::memcpy(effect.uniform_data_storage.data(), block.data.data(), block.data.size());
+		effect.uniform_data_dirty_begin = 0;
+		effect.uniform_data_dirty_end = effect.uniform_data_storage.size();
+		effect.shared_uniform_generation = block.generation.load(std::memory_order_relaxed);
+	}
+}
+
+void reshade::runtime::update_technique_render_order()
+{
+	_technique_render_order = _technique_sorting;
+	_technique_render_order_invalidated = false;
+
+	struct resource_usage_info
+	{
+		bool active = false;
+		bool compute_only = true;
+		bool reads_back_buffer = false;
+		bool writes_back_buffer = false;
+		std::vector<api::resource> read_resources;
+		std::vector<api::resource> written_resources;
+	};
+
+	// Gather the resources each technique samples and renders to, so that it is possible to tell which neighboring techniques commute
+	std::vector<resource_usage_info> usage(_techniques.size());
+
+	for (size_t technique_index = 0; technique_index < _techniques.size(); ++technique_index)
+	{
+		const technique &tech = _techniques[technique_index];
+		resource_usage_info &info = usage[technique_index];
+
+		// Techniques that are disabled or not fully loaded are skipped during rendering and therefore do not restrict reordering
+		if (!tech.enabled || tech.passes_data.empty())
+			continue;
+		info.active = true;
+
+		const effect &effect = _effects[tech.effect_index];
+
+		for (size_t pass_index = 0; pass_index < tech.passes.size(); ++pass_index)
+		{
+			const reshadefx::pass &pass = tech.passes[pass_index];
+
+			if (pass.cs_entry_point.empty())
+			{
+				info.compute_only = false;
+
+				if (pass.render_target_names[0].empty())
+					info.writes_back_buffer = true;
+			}
+
+			for (const reshadefx::texture_binding &binding : pass.texture_bindings)
+			{
+				const std::string &texture_name = effect.module.samplers[binding.index].texture_name;
+				const auto sampled_texture = std::find_if(_textures.cbegin(), _textures.cend(),
+					[&texture_name](const texture &item) {
+						return item.unique_name == texture_name && (item.resource != 0 || !item.semantic.empty());
+					});
+				if (sampled_texture == _textures.cend())
+					continue;
+
+				// Sampling the color semantic reads the back buffer contents of the previous technique (through the implicit copy in 'render_technique')
+				if (sampled_texture->semantic == "COLOR")
+					info.reads_back_buffer = true;
+				else if (sampled_texture->resource != 0)
+					info.read_resources.push_back(sampled_texture->resource);
+			}
+
+			// Storage bindings can read as well as write, so count the modified resources (render targets and storage textures) towards both sets
+			for (const api::resource modified_resource : tech.passes_data[pass_index].modified_resources)
+			{
+				info.read_resources.push_back(modified_resource);
+				info.written_resources.push_back(modified_resource);
+			}
+		}
+	}
+
+	const auto techniques_commute = [](const resource_usage_info &a, const resource_usage_info &b) {
+		if ((a.writes_back_buffer && (b.writes_back_buffer || b.reads_back_buffer)) ||
+			(b.writes_back_buffer && a.reads_back_buffer))
+			return false;
+
+		for (const api::resource written_resource : a.written_resources)
+			if (std::find(b.read_resources.cbegin(), b.read_resources.cend(), written_resource) != b.read_resources.cend())
+				return false;
+		for (const api::resource written_resource : b.written_resources)
+			if (std::find(a.read_resources.cbegin(), a.read_resources.cend(), written_resource) != a.read_resources.cend())
+				return false;
+
+		return true;
+	};
+
+	// Move each technique up next to the closest preceding technique of the same effect when that cannot change the visible output, so that techniques sharing constant buffer, descriptor and resource state render back to back
+	for (size_t i = 1; i < _technique_render_order.size(); ++i)
+	{
+		const size_t technique_index = _technique_render_order[i];
+		if (!usage[technique_index].active)
+			continue;
+
+		size_t insert_pos = std::numeric_limits<size_t>::max();
+		for (size_t j = i; j != 0; --j)
+		{
+			const size_t prev_technique_index = _technique_render_order[j - 1];
+			if (usage[prev_technique_index].active && _techniques[prev_technique_index].effect_index == _techniques[technique_index].effect_index)
+			{
+				insert_pos = j;
+				break;
+			}
+		}
+
+		if (insert_pos == std::numeric_limits<size_t>::max() || insert_pos == i)
+			continue;
+
+		// Only allowed to move past techniques that do not sample this technique's output and vice versa
+		bool can_move = true;
+		for (size_t j = insert_pos; j < i && can_move; ++j)
+			can_move = !usage[_technique_render_order[j]].active || techniques_commute(usage[_technique_render_order[j]], usage[technique_index]);
+
+		if (can_move)
+			std::rotate(_technique_render_order.begin() + insert_pos, _technique_render_order.begin() + i, _technique_render_order.begin() + i + 1);
+	}
+
+	// Hoist compute-only techniques that do not touch the back buffer to the front of the render order, so that their dispatches do not depend on any of the back buffer copies and barriers of the remaining techniques and can be submitted to the GPU early (see 'render_effects')
+	_technique_render_order_compute_prefix = 0;
+
+	for (size_t i = 0; i < _technique_render_order.size(); ++i)
+	{
+		const size_t technique_index = _technique_render_order[i];
+		const resource_usage_info &info = usage[technique_index];
+
+		if (!info.active || !info.compute_only || info.reads_back_buffer || info.writes_back_buffer)
+			continue;
+
+		// Only allowed to move past techniques that do not feed into this technique and vice versa
+		bool can_move = true;
+		for (size_t j = _technique_render_order_compute_prefix; j < i && can_move; ++j)
+			can_move = !usage[_technique_render_order[j]].active || techniques_commute(usage[_technique_render_order[j]], info);
+
+		if (can_move)
+			std::rotate(_technique_render_order.begin() + _technique_render_order_compute_prefix++, _technique_render_order.begin() + i, _technique_render_order.begin() + i + 1);
+	}
+}
+
+void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource_view rtv, api::resource_view rtv_srgb)
+{
+	const profiling::scoped_cpu_timer profile_scope("render_effects");
+
+	// Do not render effects twice in a frame
+	if (_effects_rendered_this_frame)
+		return;
+	_effects_rendered_this_frame = true;
+
+	// Nothing to do here if effects are still loading or disabled globally
+	// Rendering may begin before a reload has fully finished, as long as the effects enabled in the current preset were already initialized (see 'update_effects')
+	// Textures that are still streaming in at this point render as black placeholders until their image data arrives, since their resources were cleared to zero on creation
+	if ((is_loading() && !(_reload_preset_applied_early && _reload_create_queue.empty())) || !_effects_enabled || _techniques.empty())
+		return;
+
+	// Block worker threads from registering new textures and techniques while rendering, in case a reload is still running in the background
+	std::shared_lock<std::shared_mutex> reload_lock(_reload_mutex, std::defer_lock);
+	if (_reload_remaining_effects != std::numeric_limits<size_t>::max())
+		reload_lock.lock();
+
+	// Update uniform variables that are filled with data from this frame, unless that already happened on the present thread (see 'prepare_deferred_effect_rendering')
+	if (!_special_uniforms_updated_this_frame)
+		update_special_uniform_variables();
 
 	if (rtv == 0)
 		return;
@@ -4022,14 +5975,33 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 	cmd_list->begin_debug_event("ReShade effects");
 #endif
 
+	// Update the frame intervals of expensive techniques when a GPU time budget is configured
+	if (_effect_gpu_budget > 0)
+		update_effect_gpu_budget();
+
+	if (_optimize_technique_order && _technique_render_order_invalidated)
+		update_technique_render_order();
+
 	// Render all enabled techniques
-	for (size_t technique_index : _technique_sorting)
+	const std::vector<size_t> &technique_order = _optimize_technique_order ? _technique_render_order : _technique_sorting;
+	for (size_t order_index = 0; order_index < technique_order.size(); ++order_index)
 	{
+		const size_t technique_index = technique_order[order_index];
+
+		// Submit the compute-only techniques hoisted to the front of the render order to the GPU right away, so that it can start executing them while the remaining techniques are still being recorded here
+		if (_optimize_technique_order && order_index != 0 && order_index == _technique_render_order_compute_prefix && cmd_list == _graphics_queue->get_immediate_command_list())
+			_graphics_queue->flush_immediate_command_list();
+
 		technique &tech = _techniques[technique_index];
 
 		if (tech.passes_data.empty() || !tech.enabled || (_should_save_screenshot && !tech.enabled_in_screenshot))
 			continue; // Ignore techniques that are not fully loaded or currently disabled
 
+		// Skip techniques the GPU budget scheduler frequency-divided on frames they are not scheduled (but always render everything into screenshots)
+		// The technique index offsets the phase, so that divided techniques do not all pile up on the same frame
+		if (tech.budget_interval > 1 && !_should_save_screenshot && (_frame_count + technique_index) % tech.budget_interval != 0)
+			continue;
+
 		render_technique(tech, cmd_list, back_buffer_resource, rtv, rtv_srgb);
 
 		if (tech.time_left > 0)
@@ -4051,19 +6023,185 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 		apply_state(cmd_list, _app_state);
 #endif
 }
+
+bool reshade::runtime::prepare_deferred_effect_rendering()
+{
+	if (!_deferred_effect_rendering || _deferred_effect_rendering_failed)
+		return false;
+
+	// Only the D3D11 backend can record on a worker thread, via a deferred context
+	if (_device->get_api() != api::device_api::d3d11)
+		return false;
+
+	// The worker thread cannot take screenshots, render in VR or safely recreate the effect color resources, and GPU timing readback would access the immediate context from the wrong thread
+	if (_is_vr || _should_save_screenshot || _gather_gpu_statistics ||
+		_effect_width != _width || _effect_height != _height || _effect_color_format != api::format_to_typeless(_back_buffer_format))
+		return false;
+
+#if RESHADE_GUI
+	// Uniform values and technique state can be modified through the overlay while the worker thread is reading them, so only record on it while the overlay is closed
+	if (_show_overlay)
+		return false;
+#endif
+
+#if RESHADE_ADDON
+	// Addon callbacks around effect rendering expect to be invoked on the thread calling into the runtime
+	if (has_addon_event<addon_event::reshade_begin_effects>() ||
+		has_addon_event<addon_event::reshade_finish_effects>() ||
+		has_addon_event<addon_event::reshade_render_technique>() ||
+		has_addon_event<addon_event::reshade_set_technique_state>())
+		return false;
+#endif
+
+	if (_deferred_effect_cmd_list == nullptr)
+	{
+		_deferred_effect_cmd_list = d3d11::create_deferred_command_list(_device);
+		if (_deferred_effect_cmd_list == nullptr)
+		{
+			log::message(log::level::warning, "Failed to create deferred context for effect rendering! Falling back to rendering on the present thread.");
+			_deferred_effect_rendering_failed = true;
+			return false;
+		}
+	}
+
+	return true;
+}
+void reshade::runtime::finish_deferred_effect_rendering()
+{
+	if (!_deferred_effect_recording_pending)
+		return;
+	_deferred_effect_recording_pending = false;
+
+	const profiling::scoped_cpu_timer profile_scope("finish_deferred_effect_rendering");
+
+	// Wait for the worker thread to finish recording into the deferred command list
+	get_thread_pool().wait(_deferred_effect_job_group);
+
+	api::command_list *const cmd_list = _graphics_queue->get_immediate_command_list();
+
+	if (_deferred_effect_back_buffer != 0)
+		cmd_list->barrier(_deferred_effect_back_buffer, api::resource_usage::present, api::resource_usage::render_target);
+
+	// Executing clears the immediate context state, which is restored again at the end of 'on_present'
+	if (!d3d11::execute_deferred_command_list(_graphics_queue, _deferred_effect_cmd_list))
+		log::message(log::level::error, "Failed to execute deferred context command list for effect rendering!");
+
+	if (_deferred_effect_back_buffer != 0)
+		cmd_list->barrier(_deferred_effect_back_buffer, api::resource_usage::render_target, api::resource_usage::present);
+
+	_deferred_effect_back_buffer = {};
+}
+
+bool reshade::runtime::allocate_effect_query_pairs(effect &effect, uint32_t count)
+{
+	assert(effect.query_count == 0);
+
+	// Find the lowest free range of query pairs in the pooled heap via first fit over the allocations of the other effects
+	std::vector<std::pair<uint32_t, uint32_t>> used_ranges;
+	used_ranges.reserve(_effects.size());
+	for (const reshade::effect &other_effect : _effects)
+		if (other_effect.query_count != 0)
+			used_ranges.emplace_back(other_effect.query_base, other_effect.query_count);
+	std::sort(used_ranges.begin(), used_ranges.end());
+
+	uint32_t base = 0;
+	for (const std::pair<uint32_t, uint32_t> &used_range : used_ranges)
+	{
+		if (base + count <= used_range.first)
+			break;
+		base = std::max(base, used_range.first + used_range.second);
+	}
+
+	if (_effect_query_heap == 0 || base + count > _effect_query_heap_pairs)
+	{
+		uint32_t new_capacity = std::max(_effect_query_heap_pairs * 2, 128u);
+		while (new_capacity < base + count)
+			new_capacity *= 2;
+
+		// Recreating the heap loses the in-flight queries of all effects, so their statistics simply skip a couple of frames
+		_graphics_queue->wait_idle();
+
+		_device->destroy_query_heap(_effect_query_heap);
+		_effect_query_heap = {};
+
+		if (!_device->create_query_heap(api::query_type::timestamp, new_capacity * 2 * _gpu_timestamp_frames, &_effect_query_heap))
+		{
+			_effect_query_heap_pairs = 0;
+			return false;
+		}
+
+		_effect_query_heap_pairs = new_capacity;
+
+		_effect_query_results.assign(static_cast<size_t>(new_capacity) * 2, 0);
+		_effect_query_results_valid.assign(new_capacity, false);
+		_effect_query_pending_ranges.clear();
+		_effect_query_pending_ranges.resize(_gpu_timestamp_frames);
+		_effect_query_results_frame = std::numeric_limits<uint64_t>::max();
+	}
+
+	effect.query_base = base;
+	effect.query_count = count;
+
+	return true;
+}
+void reshade::runtime::update_effect_query_results()
+{
+	// Only read back the oldest frame slice once per frame, the first technique that renders triggers it for all effects
+	if (_effect_query_results_frame == _frame_count)
+		return;
+	_effect_query_results_frame = _frame_count;
+
+	const uint32_t slice = static_cast<uint32_t>(_frame_count % _gpu_timestamp_frames);
+	std::vector<std::pair<uint32_t, uint32_t>> &ranges = _effect_query_pending_ranges[slice];
+
+	std::fill(_effect_query_results_valid.begin(), _effect_query_results_valid.end(), false);
+
+	// Coalesce the query pairs that were actually written when this frame slice was last recorded into contiguous runs, so that they can be read back in as few calls as possible (usually just one)
+	// Cannot simply read back the entire slice, since results for query slots that were never ended are not available and would fail the batch
+	std::sort(ranges.begin(), ranges.end());
+
+	for (size_t i = 0; i < ranges.size();)
+	{
+		const uint32_t first = ranges[i].first;
+		uint32_t last = first + ranges[i].second;
+		while (++i < ranges.size() && ranges[i].first <= last)
+			last = std::max(last, ranges[i].first + ranges[i].second);
+
+		if (_device->get_query_heap_results(_effect_query_heap, (slice * _effect_query_heap_pairs + first) * 2, (last - first) * 2, _effect_query_results.data() + static_cast<size_t>(first) * 2, sizeof(uint64_t)))
+			std::fill(_effect_query_results_valid.begin() + first, _effect_query_results_valid.begin() + last, true);
+	}
+
+	ranges.clear();
+}
+
 void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_list, api::resource back_buffer_resource, api::resource_view back_buffer_rtv, api::resource_view back_buffer_rtv_srgb)
 {
-	const effect &effect = _effects[tech.effect_index];
+	// Use the technique name for the span, so that traces distinguish the cost of individual techniques
+	const trace::scoped_event trace_scope(tech.name.c_str());
+	const profiling::scoped_cpu_timer profile_scope(tech.name.c_str());
+
+	effect &effect = _effects[tech.effect_index];
 
 #if RESHADE_GUI
-	if (_gather_gpu_statistics && _timestamp_frequency != 0 && effect.query_heap != 0)
+	// Offset of the current command frame's slice in the pooled query heap (in query pairs)
+	const uint32_t query_slice = static_cast<uint32_t>(_frame_count % _gpu_timestamp_frames);
+	const uint32_t query_slice_offset = query_slice * _effect_query_heap_pairs;
+
+	if (_gather_gpu_statistics && _timestamp_frequency != 0 && _effect_query_heap != 0 && effect.query_count != 0)
 	{
-		// Evaluate queries from oldest frame in queue
-		if (uint64_t timestamps[2];
-			_device->get_query_heap_results(effect.query_heap, tech.query_base_index + (_frame_count % 4) * 2, 2, timestamps, sizeof(uint64_t)))
-			tech.average_gpu_duration.append((timestamps[1] - timestamps[0]) * 1000000000ull / _timestamp_frequency);
+		// Evaluate queries from oldest frame in queue, which were read back in batch for all effects
+		update_effect_query_results();
 
-		cmd_list->end_query(effect.query_heap, api::query_type::timestamp, tech.query_base_index + (_frame_count % 4) * 2);
+		if (_effect_query_results_valid[tech.query_base_index])
+		{
+			const uint64_t *const timestamps = &_effect_query_results[static_cast<size_t>(tech.query_base_index) * 2];
+			const uint64_t elapsed_time = (timestamps[1] - timestamps[0]) * 1000000000ull / _timestamp_frequency;
+			tech.average_gpu_duration.append(elapsed_time);
+			tech.gpu_duration_histogram.append(elapsed_time);
+		}
+
+		cmd_list->end_query(_effect_query_heap, api::query_type::timestamp, (query_slice_offset + tech.query_base_index) * 2);
+		_effect_query_pending_ranges[query_slice].emplace_back(tech.query_base_index, 1);
 	}
 
 	const std::chrono::high_resolution_clock::time_point time_technique_started = std::chrono::high_resolution_clock::now();
@@ -4073,20 +6211,48 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 	cmd_list->begin_debug_event(tech.name.c_str());
 #endif
 
-	// Update shader constants
-	if (void *mapped_uniform_data;
-		effect.cb != 0 && _device->map_buffer_region(effect.cb, 0, std::numeric_limits<uint64_t>::max(), api::map_access::write_discard, &mapped_uniform_data))
+	// Update shader constants, but only if any of them changed since the last upload (multiple techniques of the same effect then only trigger a single upload per frame)
+	if (const size_t dirty_begin = effect.uniform_data_dirty_begin, dirty_end = std::min(effect.uniform_data_dirty_end, effect.uniform_data_storage.size());
+		effect.cb != 0 && dirty_begin < dirty_end)
 	{
-		std::memcpy(mapped_uniform_data, effect.uniform_data_storage.data(), effect.uniform_data_storage.size());
-		_device->unmap_buffer_region(effect.cb);
+		if (!_device->check_capability(api::device_caps::partial_constant_buffer_updates))
+		{
+			// Dynamic constant buffers can only be mapped with discard in D3D10 and on D3D11 drivers without no overwrite support, so have to upload the entire contents
+			if (void *mapped_uniform_data;
+				_device->map_buffer_region(effect.cb, 0, std::numeric_limits<uint64_t>::max(), api::map_access::write_discard, &mapped_uniform_data))
+			{
+				std::memcpy(mapped_uniform_data, effect.uniform_data_storage.data(), effect.uniform_data_storage.size());
+				_device->unmap_buffer_region(effect.cb);
+
+				effect.uniform_data_dirty_begin = std::numeric_limits<size_t>::max();
+				effect.uniform_data_dirty_end = 0;
+			}
+		}
+		else
+		{
+			if (void *mapped_uniform_data;
+				_device->map_buffer_region(effect.cb, dirty_begin, dirty_end - dirty_begin, api::map_access::write_only, &mapped_uniform_data))
+			{
+				std::memcpy(mapped_uniform_data, effect.uniform_data_storage.data() + dirty_begin, dirty_end - dirty_begin);
+				_device->unmap_buffer_region(effect.cb);
+
+				effect.uniform_data_dirty_begin = std::numeric_limits<size_t>::max();
+				effect.uniform_data_dirty_end = 0;
+			}
+		}
 	}
-	else if (_renderer_id == 0x9000)
+	else if (effect.cb == 0 && _renderer_id == 0x9000)
 	{
 		cmd_list->push_constants(api::shader_stage::all, effect.layout, 0, 0, static_cast<uint32_t>(effect.uniform_data_storage.size() / 4), effect.uniform_data_storage.data());
 	}
 
 	const bool sampler_with_resource_view = _device->check_capability(api::device_caps::sampler_with_resource_view);
 
+	// Redirect passes that render to the back buffer into a scaled intermediate when a render scale below one is set for this technique (the GPU timestamps around the technique include the scaling blits, so the statistics reflect the actual cost)
+	const scaled_render_target *scaled_target = nullptr;
+	if (tech.render_scale < 1.0f)
+		scaled_target = acquire_scaled_render_target(tech.render_scale);
+
 	bool is_effect_stencil_cleared = false;
 	bool needs_implicit_back_buffer_copy = true; // First pass always needs the back buffer updated
 
@@ -4105,10 +6271,29 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 		}
 
 		const reshadefx::pass &pass = tech.passes[pass_index];
-		const technique::pass_data &pass_data = tech.passes_data[pass_index];
+		technique::pass_data &pass_data = tech.passes_data[pass_index];
 
 #ifndef NDEBUG
-		cmd_list->begin_debug_event((pass.name.empty() ? "Pass " + std::to_string(pass_index) : pass.name).c_str());
+		cmd_list->begin_debug_event(pass_data.debug_name.c_str());
+#endif
+
+#if RESHADE_GUI
+		const bool gather_pass_gpu_statistics = _gather_gpu_statistics && _gather_gpu_statistics_per_pass && _timestamp_frequency != 0 && _effect_query_heap != 0 && effect.query_count != 0;
+		const uint32_t pass_query_pair = tech.pass_query_base_index + static_cast<uint32_t>(pass_index);
+		const uint32_t pass_query_index = (query_slice_offset + pass_query_pair) * 2;
+
+		if (gather_pass_gpu_statistics)
+		{
+			// Evaluate per-pass queries from oldest frame in queue (see batched read back in 'update_effect_query_results')
+			if (_effect_query_results_valid[pass_query_pair])
+			{
+				const uint64_t *const timestamps = &_effect_query_results[static_cast<size_t>(pass_query_pair) * 2];
+				pass_data.average_gpu_duration.append((timestamps[1] - timestamps[0]) * 1000000000ull / _timestamp_frequency);
+			}
+
+			cmd_list->end_query(_effect_query_heap, api::query_type::timestamp, pass_query_index);
+			_effect_query_pending_ranges[query_slice].emplace_back(pass_query_pair, 1);
+		}
 #endif
 
 		const uint32_t num_barriers = static_cast<uint32_t>(pass_data.modified_resources.size());
@@ -4142,6 +6327,16 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 		}
 		else
 		{
+			const bool scaled_pass = scaled_target != nullptr && pass.render_target_names[0].empty();
+			if (scaled_pass)
+			{
+				// Bring the current back buffer contents into the scaled target first, so that alpha blending against them behaves as at full resolution
+				if (_copy_pipeline != 0)
+					stretch_texture(cmd_list, _effect_color_tex, _effect_color_srv[0], api::resource_usage::shader_resource, _effect_width, _effect_height, scaled_target->tex, scaled_target->rtv[0], api::resource_usage::shader_resource, scaled_target->width, scaled_target->height);
+				else
+					stretch_texture(cmd_list, back_buffer_resource, {}, api::resource_usage::render_target, _effect_width, _effect_height, scaled_target->tex, {}, api::resource_usage::shader_resource, scaled_target->width, scaled_target->height);
+			}
+
 			cmd_list->bind_pipeline(api::pipeline_stage::all_graphics, pass_data.pipeline);
 
 			// Transition resource state for render targets
@@ -4150,33 +6345,24 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 			std::fill_n(state_new.p, num_barriers, api::resource_usage::render_target);
 			cmd_list->barrier(num_barriers, pass_data.modified_resources.data(), state_old.p, state_new.p);
 
-			// Setup render targets
-			uint32_t render_target_count = 0;
+			// Setup render targets using the state that was pre-built during technique initialization
 			api::render_pass_depth_stencil_desc depth_stencil = {};
-			api::render_pass_render_target_desc render_target[8] = {};
 
 			if (pass.render_target_names[0].empty())
 			{
 				needs_implicit_back_buffer_copy = true;
 
-				render_target[0].view = pass.srgb_write_enable ? back_buffer_rtv_srgb : back_buffer_rtv;
-				render_target_count = 1;
+				// The back buffer can change between frames, so this view cannot be pre-built
+				pass_data.render_pass_targets[0].view = scaled_pass ? scaled_target->rtv[pass.srgb_write_enable] :
+					pass.srgb_write_enable ? back_buffer_rtv_srgb : back_buffer_rtv;
 			}
 			else
 			{
 				needs_implicit_back_buffer_copy = false;
-
-				for (int i = 0; i < 8 && pass_data.render_target_views[i] != 0; ++i, ++render_target_count)
-					render_target[i].view = pass_data.render_target_views[i];
 			}
 
-			if (pass.clear_render_targets)
-			{
-				for (int i = 0; i < 8; ++i)
-					render_target[i].load_op = api::render_pass_load_op::clear;
-			}
-
-			if (pass.stencil_enable &&
+			// The full resolution stencil buffer cannot be bound together with a scaled render target
+			if (pass.stencil_enable && !scaled_pass &&
 				pass.viewport_width == _effect_width &&
 				pass.viewport_height == _effect_height)
 			{
@@ -4187,7 +6373,7 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 					depth_stencil.stencil_load_op = api::render_pass_load_op::clear, is_effect_stencil_cleared = true;
 			}
 
-			cmd_list->begin_render_pass(render_target_count, render_target, depth_stencil.view != 0 ? &depth_stencil : nullptr);
+			cmd_list->begin_render_pass(pass_data.render_pass_target_count, pass_data.render_pass_targets, depth_stencil.view != 0 ? &depth_stencil : nullptr);
 
 			// Reset bindings on every pass (since they get invalidated by the call to 'generate_mipmaps' below)
 			if (effect.cb != 0)
@@ -4199,27 +6385,25 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 			if (!pass.texture_bindings.empty())
 				cmd_list->bind_descriptor_table(api::shader_stage::all_graphics, effect.layout, sampler_with_resource_view ? 1 : 2, pass_data.texture_table);
 
-			const api::viewport viewport = {
-				0.0f, 0.0f,
-				static_cast<float>(pass.viewport_width),
-				static_cast<float>(pass.viewport_height),
-				0.0f, 1.0f
-			};
-			cmd_list->bind_viewports(0, 1, &viewport);
-
-			const api::rect scissor_rect = {
-				0, 0,
-				static_cast<int32_t>(pass.viewport_width),
-				static_cast<int32_t>(pass.viewport_height)
-			};
-			cmd_list->bind_scissor_rects(0, 1, &scissor_rect);
+			if (scaled_pass)
+			{
+				const api::viewport scaled_viewport = { 0.0f, 0.0f, static_cast<float>(scaled_target->width), static_cast<float>(scaled_target->height), 0.0f, 1.0f };
+				cmd_list->bind_viewports(0, 1, &scaled_viewport);
+				const api::rect scaled_scissor_rect = { 0, 0, static_cast<int32_t>(scaled_target->width), static_cast<int32_t>(scaled_target->height) };
+				cmd_list->bind_scissor_rects(0, 1, &scaled_scissor_rect);
+			}
+			else
+			{
+				cmd_list->bind_viewports(0, 1, &pass_data.viewport);
+				cmd_list->bind_scissor_rects(0, 1, &pass_data.scissor_rect);
+			}
 
 			if (_renderer_id == 0x9000)
 			{
 				// Set __TEXEL_SIZE__ constant (see effect_codegen_hlsl.cpp)
 				const float texel_size[4] = {
-					-1.0f / pass.viewport_width,
-					 1.0f / pass.viewport_height
+					-1.0f / (scaled_pass ? scaled_target->width : pass.viewport_width),
+					 1.0f / (scaled_pass ? scaled_target->height : pass.viewport_height)
 				};
 				cmd_list->push_constants(api::shader_stage::vertex, effect.layout, 0, 255 * 4, 4, texel_size);
 
@@ -4251,12 +6435,21 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 
 			// Transition resource state back to shader access
 			cmd_list->barrier(num_barriers, pass_data.modified_resources.data(), state_new.p, state_old.p);
+
+			// Composite the scaled result back into the full resolution back buffer
+			if (scaled_pass)
+				stretch_texture(cmd_list, scaled_target->tex, scaled_target->srv, api::resource_usage::shader_resource, scaled_target->width, scaled_target->height, back_buffer_resource, back_buffer_rtv, api::resource_usage::render_target, _effect_width, _effect_height);
 		}
 
 		// Generate mipmaps for modified resources
 		for (const api::resource_view modified_texture : pass_data.generate_mipmap_views)
 			cmd_list->generate_mipmaps(modified_texture);
 
+#if RESHADE_GUI
+		if (gather_pass_gpu_statistics)
+			cmd_list->end_query(_effect_query_heap, api::query_type::timestamp, pass_query_index + 1);
+#endif
+
 #ifndef NDEBUG
 		cmd_list->end_debug_event();
 #endif
@@ -4271,8 +6464,8 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 
 	tech.average_cpu_duration.append(std::chrono::duration_cast<std::chrono::nanoseconds>(time_technique_finished - time_technique_started).count());
 
-	if (_gather_gpu_statistics && _timestamp_frequency != 0 && effect.query_heap != 0)
-		cmd_list->end_query(effect.query_heap, api::query_type::timestamp, tech.query_base_index + (_frame_count % 4) * 2 + 1);
+	if (_gather_gpu_statistics && _timestamp_frequency != 0 && _effect_query_heap != 0 && effect.query_count != 0)
+		cmd_list->end_query(_effect_query_heap, api::query_type::timestamp, (query_slice_offset + tech.query_base_index) * 2 + 1);
 #endif
 
 #if RESHADE_ADDON
@@ -4285,6 +6478,148 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 #endif
 }
 
+// Merge two Adler-32 checksums as if the data they cover had been checksummed as a single buffer (equivalent to zlib's 'adler32_combine')
+static uint32_t merge_adler32(uint32_t adler1, uint32_t adler2, size_t len2)
+{
+	const uint32_t base = 65521;
+	const uint32_t rem = static_cast<uint32_t>(len2 % base);
+	uint32_t sum1 = adler1 & 0xFFFF;
+	uint32_t sum2 = static_cast<uint32_t>((static_cast<uint64_t>(rem) * sum1) % base);
+	sum1 += (adler2 & 0xFFFF) + base - 1;
+	sum2 += ((adler1 >> 16) & 0xFFFF) + ((adler2 >> 16) & 0xFFFF) + base - rem;
+	if (sum1 >= base) sum1 -= base;
+	if (sum1 >= base) sum1 -= base;
+	if (sum2 >= base * 2) sum2 -= base * 2;
+	if (sum2 >= base) sum2 -= base;
+	return sum1 | (sum2 << 16);
+}
+// Latency-optimized PNG encoder that splits the image into horizontal bands which are packed into byte-aligned stored deflate blocks in parallel on the thread pool and then stitched into a single zlib stream (in contrast to fpng, which compresses the entire image on the calling thread)
+static bool encode_png_parallel(const uint8_t *pixels, uint32_t width, uint32_t height, int comp, std::vector<uint8_t> &encoded_data)
+{
+	if (width == 0 || height == 0 || (comp != 3 && comp != 4))
+		return false;
+
+	const size_t row_size = static_cast<size_t>(width) * comp;
+	// Each row is prefixed with a PNG filter type byte (filter 'none', since actual filtering would negate the fast stored block path)
+	const size_t filtered_row_size = 1 + row_size;
+
+	struct band_data
+	{
+		uint32_t row_begin = 0;
+		uint32_t row_end = 0;
+		uint32_t adler = 0;
+		std::vector<uint8_t> blocks;
+	};
+
+	size_t num_bands = std::thread::hardware_concurrency();
+	num_bands = std::max<size_t>(1, std::min<size_t>(num_bands, height / 16));
+
+	std::vector<band_data> bands(num_bands);
+
+	reshade::thread_pool &pool = reshade::get_thread_pool();
+	reshade::thread_pool::job_group band_job_group;
+
+	for (size_t band_index = 0; band_index < num_bands; ++band_index)
+	{
+		band_data &band = bands[band_index];
+		band.row_begin = static_cast<uint32_t>((static_cast<uint64_t>(height) * band_index) / num_bands);
+		band.row_end = static_cast<uint32_t>((static_cast<uint64_t>(height) * (band_index + 1)) / num_bands);
+
+		const auto encode_band = [pixels, row_size, filtered_row_size, &band]() {
+			std::vector<uint8_t> filtered(static_cast<size_t>(band.row_end - band.row_begin) * filtered_row_size);
+			for (uint32_t y = band.row_begin; y < band.row_end; ++y)
+			{
+				uint8_t *const filtered_row = filtered.data() + static_cast<size_t>(y - band.row_begin) * filtered_row_size;
+				filtered_row[0] = 0; // Filter type 'none'
+				std::memcpy(filtered_row + 1, pixels + static_cast<size_t>(y) * row_size, row_size);
+			}
+
+			band.adler = fpng::fpng_adler32(filtered.data(), filtered.size());
+
+			// Pack the filtered rows into stored deflate blocks, which are byte-aligned and can therefore simply be concatenated across bands
+			band.blocks.reserve(filtered.size() + (filtered.size() / 0xFFFF + 1) * 5);
+			for (size_t offset = 0; offset < filtered.size();)
+			{
+				const uint16_t block_size = static_cast<uint16_t>(std::min<size_t>(filtered.size() - offset, 0xFFFF));
+				band.blocks.push_back(0x00); // Not the final block ('BFINAL' zero, 'BTYPE' stored)
+				band.blocks.push_back(static_cast<uint8_t>(block_size & 0xFF));
+				band.blocks.push_back(static_cast<uint8_t>(block_size >> 8));
+				band.blocks.push_back(static_cast<uint8_t>(~block_size & 0xFF));
+				band.blocks.push_back(static_cast<uint8_t>((~block_size >> 8) & 0xFF));
+				band.blocks.insert(band.blocks.end(), filtered.begin() + offset, filtered.begin() + offset + block_size);
+				offset += block_size;
+			}
+		};
+
+		if (band_index < num_bands - 1)
+			pool.enqueue(band_job_group, encode_band);
+		else
+			encode_band(); // Encode the last band on the calling thread while the pool works on the others
+	}
+
+	pool.wait(band_job_group);
+
+	uint32_t adler = 1;
+	size_t compressed_size = 2 + 5 + 4; // zlib header, final empty stored block and Adler-32 checksum
+	for (const band_data &band : bands)
+	{
+		adler = merge_adler32(adler, band.adler, static_cast<size_t>(band.row_end - band.row_begin) * filtered_row_size);
+		compressed_size += band.blocks.size();
+	}
+
+	encoded_data.clear();
+	encoded_data.reserve(8 + (12 + 13) + (12 + compressed_size) + 12);
+
+	const auto write_be32 = [&encoded_data](uint32_t value) {
+		encoded_data.push_back(static_cast<uint8_t>(value >> 24));
+		encoded_data.push_back(static_cast<uint8_t>(value >> 16));
+		encoded_data.push_back(static_cast<uint8_t>(value >>  8));
+		encoded_data.push_back(static_cast<uint8_t>(value));
+	};
+
+	// PNG signature
+	const uint8_t signature[8] = { 0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A };
+	encoded_data.insert(encoded_data.end(), std::begin(signature), std::end(signature));
+
+	// IHDR chunk
+	write_be32(13);
+	const size_t ihdr_offset = encoded_data.size();
+	encoded_data.insert(encoded_data.end(), { 'I', 'H', 'D', 'R' });
+	write_be32(width);
+	write_be32(height);
+	encoded_data.push_back(8); // Bit depth
+	encoded_data.push_back(comp == 4 ? 6 : 2); // Color type (truecolor with or without alpha)
+	encoded_data.push_back(0); // Compression method
+	encoded_data.push_back(0); // Filter method
+	encoded_data.push_back(0); // Interlace method
+	write_be32(fpng::fpng_crc32(encoded_data.data() + ihdr_offset, encoded_data.size() - ihdr_offset));
+
+	// IDAT chunk
+	write_be32(static_cast<uint32_t>(compressed_size));
+	const size_t idat_offset = encoded_data.size();
+	encoded_data.insert(encoded_data.end(), { 'I', 'D', 'A', 'T' });
+	encoded_data.push_back(0x78); // zlib header (32k window, fastest compression level)
+	encoded_data.push_back(0x01);
+	for (const band_data &band : bands)
+		encoded_data.insert(encoded_data.end(), band.blocks.begin(), band.blocks.end());
+	// Final empty stored block terminating the deflate stream
+	encoded_data.push_back(0x01);
+	encoded_data.push_back(0x00);
+	encoded_data.push_back(0x00);
+	encoded_data.push_back(0xFF);
+	encoded_data.push_back(0xFF);
+	write_be32(adler);
+	write_be32(fpng::fpng_crc32(encoded_data.data() + idat_offset, encoded_data.size() - idat_offset));
+
+	// IEND chunk
+	write_be32(0);
+	const size_t iend_offset = encoded_data.size();
+	encoded_data.insert(encoded_data.end(), { 'I', 'E', 'N', 'D' });
+	write_be32(fpng::fpng_crc32(encoded_data.data() + iend_offset, 4));
+
+	return true;
+}
+
 void reshade::runtime::save_texture(const texture &tex)
 {
 	if (tex.type == reshadefx::texture_type::texture_3d)
@@ -4294,7 +6629,7 @@ void reshade::runtime::save_texture(const texture &tex)
 	}
 
 	std::string filename = tex.unique_name;
-	filename += (_screenshot_format == 0 ? ".bmp" : _screenshot_format == 1 ? ".png" : ".jpg");
+	filename += (_screenshot_format == 0 ? ".bmp" : _screenshot_format == 2 ? ".jpg" : ".png");
 
 	const std::filesystem::path screenshot_path = g_reshade_base_path / _screenshot_path / std::filesystem::u8path(filename);
 
@@ -4330,6 +6665,11 @@ void reshade::runtime::save_texture(const texture &tex)
 				case 2:
 					save_success = stbi_write_jpg_to_func(write_callback, file, width, height, 4, pixels.data(), _screenshot_jpeg_quality) != 0;
 					break;
+				case 3:
+					if (std::vector<uint8_t> encoded_data;
+						encode_png_parallel(pixels.data(), width, height, 4, encoded_data))
+						save_success = fwrite(encoded_data.data(), 1, encoded_data.size(), file) == encoded_data.size();
+					break;
 				}
 
 				if (ferror(file))
@@ -4347,6 +6687,70 @@ void reshade::runtime::save_texture(const texture &tex)
 		});
 	}
 }
+static bool cpu_supports_avx2()
+{
+	int regs[4];
+	__cpuid(regs, 0);
+	if (regs[0] < 7)
+		return false;
+	// Check for OS support of the extended AVX register state in addition to the AVX2 instruction set itself
+	__cpuid(regs, 1);
+	if ((regs[2] & (1 << 27)) == 0 /* OSXSAVE */ || (_xgetbv(_XCR_XFEATURE_ENABLED_MASK) & 0x6) != 0x6)
+		return false;
+	__cpuidex(regs, 7, 0);
+	return (regs[1] & (1 << 5)) != 0;
+}
+
+// Latency-optimized replacement for 'stbir_resize' that splits the image into horizontal strips which are resized in parallel on the thread pool, dispatching to the AVX2 build of stb_image_resize2 on capable CPUs
+static void *resize_image_data(const void *pixels, uint32_t width, uint32_t height, void *output_pixels, uint32_t output_width, uint32_t output_height, stbir_pixel_layout pixel_layout, stbir_datatype data_type)
+{
+	static const bool use_avx2 = cpu_supports_avx2();
+
+	STBIR_RESIZE resize;
+	stbir_resize_init(&resize, pixels, static_cast<int>(width), static_cast<int>(height), 0, output_pixels, static_cast<int>(output_width), static_cast<int>(output_height), 0, pixel_layout, data_type);
+	stbir_set_edgemodes(&resize, STBIR_EDGE_CLAMP, STBIR_EDGE_CLAMP);
+
+	// Only pay the thread synchronization overhead on images large enough for it to be worthwhile
+	int num_splits = 1;
+	if (static_cast<uint64_t>(output_width) * static_cast<uint64_t>(output_height) >= 1024 * 1024)
+		num_splits = static_cast<int>(std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), output_height / 64)));
+
+	num_splits = use_avx2 ?
+		stbir_build_samplers_with_splits_avx2(&resize, num_splits) :
+		stbir_build_samplers_with_splits(&resize, num_splits);
+	if (num_splits <= 0)
+		return nullptr;
+
+	std::atomic<bool> resize_success = { true };
+
+	reshade::thread_pool &pool = reshade::get_thread_pool();
+	reshade::thread_pool::job_group split_job_group;
+
+	for (int split_index = 0; split_index < num_splits; ++split_index)
+	{
+		const auto resize_split = [&resize, &resize_success, split_index]() {
+			if (!(use_avx2 ?
+					stbir_resize_extended_split_avx2(&resize, split_index, 1) :
+					stbir_resize_extended_split(&resize, split_index, 1)))
+				resize_success = false;
+		};
+
+		if (split_index < num_splits - 1)
+			pool.enqueue(split_job_group, resize_split);
+		else
+			resize_split(); // Resize the last strip on the calling thread while the pool works on the others
+	}
+
+	pool.wait(split_job_group);
+
+	if (use_avx2)
+		stbir_free_samplers_avx2(&resize);
+	else
+		stbir_free_samplers(&resize);
+
+	return resize_success ? output_pixels : nullptr;
+}
+
 void reshade::runtime::update_texture(texture &tex, uint32_t width, uint32_t height, uint32_t depth, const void *pixels)
 {
 	if (tex.depth != depth || (tex.depth != 1 && (tex.width != width || tex.height != height)))
@@ -4425,7 +6829,12 @@ void reshade::runtime::update_texture(texture &tex, uint32_t width, uint32_t hei
 
 		resized.resize(static_cast<size_t>(tex.width) * static_cast<size_t>(tex.height) * static_cast<size_t>(tex.depth) * static_cast<size_t>(pixel_size));
 
-		upload_data = stbir_resize(pixels, width, height, 0, resized.data(), tex.width, tex.height, 0, pixel_layout, data_type, STBIR_EDGE_CLAMP, STBIR_FILTER_DEFAULT);
+		upload_data = resize_image_data(pixels, width, height, resized.data(), tex.width, tex.height, pixel_layout, data_type);
+		if (upload_data == nullptr)
+		{
+			log::message(log::level::error, "Failed to resize image data for texture '%s'!", tex.unique_name.c_str());
+			return;
+		}
 	}
 
 	api::command_list *const cmd_list = _graphics_queue->get_immediate_command_list();
@@ -4441,7 +6850,11 @@ void reshade::runtime::reset_uniform_value(uniform &variable)
 {
 	if (variable.special != reshade::special_uniform::none)
 	{
-		std::memset(_effects[variable.effect_index].uniform_data_storage.data() + variable.offset, 0, variable.size);
+		effect &effect = _effects[variable.effect_index];
+		std::memset(effect.uniform_data_storage.data() + variable.offset, 0, variable.size);
+
+		effect.uniform_data_dirty_begin = std::min(effect.uniform_data_dirty_begin, static_cast<size_t>(variable.offset));
+		effect.uniform_data_dirty_end = std::max(effect.uniform_data_dirty_end, static_cast<size_t>(variable.offset) + variable.size);
 		return;
 	}
 
@@ -4583,9 +6996,14 @@ void reshade::runtime::set_uniform_value_data(uniform &variable, const uint8_t *
 	size = std::min(size, static_cast<size_t>(variable.size));
 	assert(data != nullptr && (size % 4) == 0);
 
-	std::vector<uint8_t> &data_storage = _effects[variable.effect_index].uniform_data_storage;
+	effect &effect = _effects[variable.effect_index];
+	std::vector<uint8_t> &data_storage = effect.uniform_data_storage;
 	assert(variable.offset + size <= data_storage.size());
 
+	// Expand the dirty range, so that the modified values are uploaded to the constant buffer before the next use (see 'render_technique')
+	effect.uniform_data_dirty_begin = std::min(effect.uniform_data_dirty_begin, static_cast<size_t>(variable.offset));
+	effect.uniform_data_dirty_end = std::max(effect.uniform_data_dirty_end, static_cast<size_t>(variable.offset) + variable.size);
+
 	const size_t array_length = (variable.type.is_array() ? variable.type.array_length : 1u);
 	if (assert(base_index < array_length); base_index >= array_length)
 		return;
@@ -4613,6 +7031,17 @@ void reshade::runtime::set_uniform_value_data(uniform &variable, const uint8_t *
 	{
 		std::memcpy(data_storage.data() + variable.offset, data, size);
 	}
+
+	// Propagate the new value to runtimes sharing this uniform block (special uniform variables are per-runtime state that is rewritten every frame, so they are not propagated)
+	if (effect.shared_uniforms != nullptr && variable.special == special_uniform::none)
+	{
+		shared_uniform_block &block = *effect.shared_uniforms;
+
+		const std::unique_lock<std::shared_mutex> lock(block.mutex);
+
+		std::memcpy(block.data.data() + variable.offset, data_storage.data() + variable.offset, variable.size);
+		effect.shared_uniform_generation = block.generation.fetch_add(1, std::memory_order_relaxed) + 1;
+	}
 }
 
 template <> void reshade::runtime::set_uniform_value<bool>(uniform &variable, const bool *values, size_t count, size_t array_index)
@@ -4786,10 +7215,374 @@ static std::string expand_macro_string(const std::string &input, std::vector<std
 	return result;
 }
 
+static bool is_screenshot_compatible_format(reshade::api::format view_format)
+{
+	return
+		view_format == reshade::api::format::r8_unorm ||
+		view_format == reshade::api::format::r8g8_unorm ||
+		view_format == reshade::api::format::r8g8b8a8_unorm ||
+		view_format == reshade::api::format::b8g8r8a8_unorm ||
+		view_format == reshade::api::format::r8g8b8x8_unorm ||
+		view_format == reshade::api::format::b8g8r8x8_unorm ||
+		view_format == reshade::api::format::r10g10b10a2_unorm ||
+		view_format == reshade::api::format::b10g10r10a2_unorm;
+}
+static void convert_mapped_texture_data(reshade::api::format view_format, uint32_t width, uint32_t height, const reshade::api::subresource_data &mapped_data, uint8_t *pixels)
+{
+	auto mapped_pixels = static_cast<const uint8_t *>(mapped_data.data);
+	const uint32_t pixels_row_pitch = width * 4;
+
+	for (size_t y = 0; y < height; ++y, pixels += pixels_row_pitch, mapped_pixels += mapped_data.row_pitch)
+	{
+		switch (view_format)
+		{
+		case reshade::api::format::r8_unorm:
+			for (size_t x = 0; x < width; ++x)
+			{
+				pixels[x * 4 + 0] = mapped_pixels[x];
+				pixels[x * 4 + 1] = 0;
+				pixels[x * 4 + 2] = 0;
+				pixels[x * 4 + 3] = 0xFF;
+			}
+			break;
+		case reshade::api::format::r8g8_unorm:
+			for (size_t x = 0; x < width; ++x)
+			{
+				pixels[x * 4 + 0] = mapped_pixels[x * 2 + 0];
+				pixels[x * 4 + 1] = mapped_pixels[x * 2 + 1];
+				pixels[x * 4 + 2] = 0;
+				pixels[x * 4 + 3] = 0xFF;
+			}
+			break;
+		case reshade::api::format::r8g8b8a8_unorm:
+		case reshade::api::format::r8g8b8x8_unorm:
+			std::memcpy(pixels, mapped_pixels, pixels_row_pitch);
+			if (view_format == reshade::api::format::r8g8b8x8_unorm)
+				for (size_t x = 0; x < pixels_row_pitch; x += 4)
+					pixels[x + 3] = 0xFF;
+			break;
+		case reshade::api::format::b8g8r8a8_unorm:
+		case reshade::api::format::b8g8r8x8_unorm:
+			std::memcpy(pixels, mapped_pixels, pixels_row_pitch);
+			// Format is BGRA, but output should be RGBA, so flip channels
+			for (size_t x = 0; x < pixels_row_pitch; x += 4)
+				std::swap(pixels[x + 0], pixels[x + 2]);
+			if (view_format == reshade::api::format::b8g8r8x8_unorm)
+				for (size_t x = 0; x < pixels_row_pitch; x += 4)
+					pixels[x + 3] = 0xFF;
+			break;
+		case reshade::api::format::r10g10b10a2_unorm:
+		case reshade::api::format::b10g10r10a2_unorm:
+			for (size_t x = 0; x < pixels_row_pitch; x += 4)
+			{
+				const uint32_t rgba = *reinterpret_cast<const uint32_t *>(mapped_pixels + x);
+				// Divide by 4 to get 10-bit range (0-1023) into 8-bit range (0-255)
+				pixels[x + 0] = (( rgba & 0x000003FF)        /  4) & 0xFF;
+				pixels[x + 1] = (((rgba & 0x000FFC00) >> 10) /  4) & 0xFF;
+				pixels[x + 2] = (((rgba & 0x3FF00000) >> 20) /  4) & 0xFF;
+				pixels[x + 3] = (((rgba & 0xC0000000) >> 30) * 85) & 0xFF;
+				if (view_format == reshade::api::format::b10g10r10a2_unorm)
+					std::swap(pixels[x + 0], pixels[x + 2]);
+			}
+			break;
+		}
+	}
+}
+
+void reshade::runtime::save_performance_log_sample()
+{
+	const auto current_time = std::chrono::high_resolution_clock::now();
+	const float elapsed_ms = std::chrono::duration_cast<std::chrono::nanoseconds>(current_time - _last_performance_log_time).count() * 1e-6f;
+
+	const auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+	char line[192];
+
+	if (_performance_log_frame_count != 0 && elapsed_ms > 0)
+		_performance_log_pending.append(line, std::snprintf(line, sizeof(line), "%lld,frame,%.3f,%.1f\n", static_cast<long long>(timestamp), elapsed_ms / _performance_log_frame_count, _performance_log_frame_count * 1000.0f / elapsed_ms));
+
+#if RESHADE_FX
+	for (const technique &tech : _techniques)
+	{
+		if (!tech.enabled || tech.average_gpu_duration == 0)
+			continue;
+
+		const int len = std::snprintf(line, sizeof(line), "%lld,technique,%s,%.3f\n", static_cast<long long>(timestamp), tech.name.c_str(), static_cast<uint64_t>(tech.average_gpu_duration) * 1e-6f);
+		if (len > 0)
+			_performance_log_pending.append(line, std::min(static_cast<size_t>(len), sizeof(line) - 1));
+	}
+#endif
+
+	_last_performance_log_time = current_time;
+	_performance_log_frame_count = 0;
+
+	flush_performance_log();
+}
+void reshade::runtime::flush_performance_log()
+{
+	// Use a process-lifetime job group rather than a runtime member, since nothing waits on the append job before this runtime may be destroyed (intentionally leaked for the same reason as the thread pool itself, see 'get_thread_pool')
+	static thread_pool::job_group *const s_append_job_group = new thread_pool::job_group();
+
+	if (_performance_log_pending.empty())
+		return;
+	// Skip flushing while a previous write has not finished yet (e.g. because the file is on a slow network share) and simply keep accumulating until the next sample
+	if (s_append_job_group->num_pending_jobs != 0)
+		return;
+
+	// Submit the file append to the thread pool rather than the file write queue, since the latter would overwrite the existing log contents
+	// The job deliberately does not reference this runtime, so that it can safely finish after the runtime was destroyed
+	get_thread_pool().enqueue(*s_append_job_group,
+		[log_path = g_reshade_base_path / L"ReShadePerf.log", data = std::move(_performance_log_pending)]() {
+			// Rotate the log into a single backup file once it has grown too large, so that disk usage stays bounded over long sessions
+			WIN32_FILE_ATTRIBUTE_DATA attributes = {};
+			bool write_schema = GetFileAttributesExW(log_path.c_str(), GetFileExInfoStandard, &attributes) == FALSE;
+			if (!write_schema && (attributes.nFileSizeHigh != 0 || attributes.nFileSizeLow > 4 * 1024 * 1024))
+			{
+				std::filesystem::path backup_path = log_path;
+				backup_path += L".1";
+				write_schema = MoveFileExW(log_path.c_str(), backup_path.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+			}
+
+			const HANDLE file = CreateFileW(log_path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				return;
+
+			if (write_schema)
+			{
+				static constexpr char schema[] =
+					"# ReShade performance log (comma-separated records, timestamps are Unix time in seconds)\n"
+					"# <timestamp>,frame,<average frame time in milliseconds>,<average frames per second>\n"
+					"# <timestamp>,technique,<technique name>,<average GPU duration in milliseconds>\n"
+					"# <timestamp>,reload,<reload duration in milliseconds>,<effect cache hits>,<effect cache misses>\n";
+				DWORD size_written = 0;
+				WriteFile(file, schema, static_cast<DWORD>(sizeof(schema) - 1), &size_written, nullptr);
+			}
+
+			DWORD size_written = 0;
+			WriteFile(file, data.data(), static_cast<DWORD>(data.size()), &size_written, nullptr);
+			CloseHandle(file);
+		});
+
+	_performance_log_pending.clear(); // String was moved from above, but make sure it is back in a defined empty state
+}
+
 void reshade::runtime::save_screenshot(const std::string_view postfix)
 {
 	const unsigned int screenshot_count = _screenshot_count;
 
+#if RESHADE_FX
+	// Flush the current preset to disk now, so that its state at capture time can be copied alongside the screenshot file once it was written
+	const bool include_preset = _screenshot_include_preset && postfix.empty() && ini_file::flush_cache(_current_preset_path);
+#else
+	const bool include_preset = false;
+#endif
+
+	// Play screenshot sound
+	if (!_screenshot_sound_path.empty())
+		utils::play_sound_async(g_reshade_base_path / _screenshot_sound_path);
+
+	if (screenshot_readback *const readback = acquire_screenshot_readback())
+	{
+		readback->screenshot_count = screenshot_count;
+		readback->postfix = postfix;
+		readback->include_preset = include_preset;
+		return;
+	}
+
+	// Fall back to a blocking capture when the asynchronous readback could not be set up
+	if (std::vector<uint8_t> pixels(static_cast<size_t>(_width) * static_cast<size_t>(_height) * 4);
+		capture_screenshot(pixels.data()))
+		save_screenshot_data(std::move(pixels), screenshot_count, std::string(postfix), include_preset);
+	else
+		_last_screenshot_save_successful = false;
+}
+reshade::runtime::screenshot_readback *reshade::runtime::acquire_screenshot_readback()
+{
+	if (_screenshot_fence == 0 && !_device->create_fence(0, api::fence_flags::none, &_screenshot_fence))
+	{
+		log::message(log::level::error, "Failed to create screenshot synchronization fence!");
+		return nullptr;
+	}
+
+	const api::resource back_buffer_resource = _back_buffer_resolved != 0 ? _back_buffer_resolved : _swapchain->get_current_back_buffer();
+	const api::resource_usage back_buffer_state = _back_buffer_resolved != 0 ? api::resource_usage::render_target : api::resource_usage::present;
+
+	// Prefer a readback texture that is not in flight, otherwise block on the oldest capture to free up its slot (this only happens when more captures are started per frame than there are readback textures)
+	screenshot_readback *readback = &_screenshot_readbacks[0];
+	for (screenshot_readback &candidate : _screenshot_readbacks)
+		if (candidate.fence_value < readback->fence_value)
+			readback = &candidate;
+	if (readback->fence_value != 0)
+	{
+		_device->wait(_screenshot_fence, readback->fence_value);
+		finish_pending_screenshots(false);
+		readback->fence_value = 0;
+	}
+
+	// The readback texture is created on first use and kept alive for subsequent captures (it is destroyed again in 'on_reset')
+	if (readback->intermediate == 0)
+	{
+		const api::resource_desc desc = _device->get_resource_desc(back_buffer_resource);
+		readback->view_format = api::format_to_default_typed(desc.texture.format, 0);
+
+		if (is_screenshot_compatible_format(readback->view_format))
+		{
+			if (!_device->create_resource(api::resource_desc(desc.texture.width, desc.texture.height, 1, 1, readback->view_format, 1, api::memory_heap::gpu_to_cpu, api::resource_usage::copy_dest), nullptr, api::resource_usage::copy_dest, &readback->intermediate))
+				log::message(log::level::error, "Failed to create system memory texture for screenshot capture!");
+			else
+				_device->set_resource_name(readback->intermediate, "ReShade screenshot texture");
+		}
+	}
+
+	if (readback->intermediate == 0)
+		return nullptr;
+
+	// Record the back buffer copy on the frame's command list and only map the readback texture in a later frame once the GPU has caught up, instead of blocking on the copy here
+	api::command_list *const cmd_list = _graphics_queue->get_immediate_command_list();
+	cmd_list->barrier(back_buffer_resource, back_buffer_state, api::resource_usage::copy_source);
+	cmd_list->copy_texture_region(back_buffer_resource, 0, nullptr, readback->intermediate, 0, nullptr);
+	cmd_list->barrier(back_buffer_resource, api::resource_usage::copy_source, back_buffer_state);
+
+	if (!_graphics_queue->signal(_screenshot_fence, ++_screenshot_fence_value))
+	{
+		// The copy was already recorded above, so ensure it finished before any fallback capture runs
+		_graphics_queue->wait_idle();
+		return nullptr;
+	}
+
+	readback->fence_value = _screenshot_fence_value;
+	readback->screenshot_count = 0;
+	readback->postfix.clear();
+	readback->include_preset = false;
+	readback->callback = nullptr;
+	readback->user_data = nullptr;
+	readback->burst_destination = nullptr;
+	return readback;
+}
+bool reshade::runtime::capture_screenshot_async(void (*callback)(void *user_data, const uint8_t *pixels, uint32_t width, uint32_t height), void *user_data)
+{
+	if (callback == nullptr)
+		return false;
+
+	screenshot_readback *const readback = acquire_screenshot_readback();
+	if (readback == nullptr)
+		return false;
+
+	readback->callback = callback;
+	readback->user_data = user_data;
+	return true;
+}
+void reshade::runtime::start_burst_capture()
+{
+	assert(_burst_capture_view == nullptr);
+
+	std::string capture_name = expand_macro_string(_screenshot_name, {
+		{ "AppName", g_target_executable_path.stem().u8string() },
+#if RESHADE_FX
+		{ "PresetName",  _current_preset_path.stem().u8string() },
+		{ "Count", std::to_string(_screenshot_count) }
+#endif
+	});
+	capture_name += ".rsbc";
+
+	const std::filesystem::path capture_path = g_reshade_base_path / _screenshot_path / std::filesystem::u8path(capture_name);
+
+	std::error_code ec;
+	if (!std::filesystem::exists(capture_path.parent_path(), ec))
+		std::filesystem::create_directories(capture_path.parent_path(), ec);
+
+	// Size the ring for the configured duration at 60 frames per second, so that at higher frame rates it wraps around and keeps the most recent frames
+	const uint32_t frame_capacity = std::max(_burst_capture_duration, 1u) * 60;
+	const uint32_t frame_size = _width * _height * 4;
+	const uint64_t file_size = sizeof(burst_capture_header) + frame_capacity * sizeof(uint64_t) + static_cast<uint64_t>(frame_capacity) * frame_size;
+
+	// Preallocate the entire capture file up front, so that appending frames never has to grow it
+	const HANDLE file = CreateFileW(capture_path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		log::message(log::level::error, "Failed to create burst capture file '%s'!", capture_path.u8string().c_str());
+		return;
+	}
+
+	const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(file_size >> 32), static_cast<DWORD>(file_size & 0xFFFFFFFF), nullptr);
+	CloseHandle(file); // The mapping keeps its own reference to the file
+	if (mapping == nullptr)
+	{
+		log::message(log::level::error, "Failed to create burst capture file mapping for '%s'!", capture_path.u8string().c_str());
+		return;
+	}
+
+	const auto view = static_cast<uint8_t *>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0));
+	if (view == nullptr)
+	{
+		CloseHandle(mapping);
+		log::message(log::level::error, "Failed to map burst capture file '%s'!", capture_path.u8string().c_str());
+		return;
+	}
+
+	const auto header = reinterpret_cast<burst_capture_header *>(view);
+	header->magic = burst_capture_header::signature;
+	header->version = burst_capture_header::latest_version;
+	header->width = _width;
+	header->height = _height;
+	header->frame_size = frame_size;
+	header->frame_capacity = frame_capacity;
+	header->frame_count = 0;
+	header->reserved = 0;
+	LARGE_INTEGER frequency = {};
+	QueryPerformanceFrequency(&frequency);
+	header->ticks_per_second = frequency.QuadPart;
+
+	_burst_capture_mapping = mapping;
+	_burst_capture_view = view;
+	_burst_capture_frame_count = 0;
+	_burst_capture_file = capture_path;
+	_burst_capture_start_time = std::chrono::high_resolution_clock::now();
+
+	log::message(log::level::info, "Recording burst capture to '%s' ...", capture_path.u8string().c_str());
+}
+void reshade::runtime::stop_burst_capture()
+{
+	if (_burst_capture_view == nullptr)
+		return;
+
+	// Wait for readbacks that are still converting frames into the mapping before it is unmapped
+	finish_pending_screenshots(true);
+
+	log::message(log::level::info, "Saved burst capture with %u frames to '%s'.", _burst_capture_frame_count, _burst_capture_file.u8string().c_str());
+
+	UnmapViewOfFile(_burst_capture_view);
+	_burst_capture_view = nullptr;
+	CloseHandle(_burst_capture_mapping);
+	_burst_capture_mapping = nullptr;
+}
+void reshade::runtime::capture_burst_frame()
+{
+	assert(_burst_capture_view != nullptr);
+
+	const auto header = reinterpret_cast<burst_capture_header *>(_burst_capture_view);
+
+	// Stop once the configured duration elapsed, or when the readback setup failed (e.g. because the back buffer format is not screenshot compatible)
+	screenshot_readback *readback = nullptr;
+	if (std::chrono::high_resolution_clock::now() - _burst_capture_start_time >= std::chrono::seconds(_burst_capture_duration) ||
+		(readback = acquire_screenshot_readback()) == nullptr)
+	{
+		stop_burst_capture();
+		return;
+	}
+
+	const uint32_t slot = _burst_capture_frame_count % header->frame_capacity;
+
+	LARGE_INTEGER time = {};
+	QueryPerformanceCounter(&time);
+	reinterpret_cast<uint64_t *>(_burst_capture_view + sizeof(burst_capture_header))[slot] = time.QuadPart;
+
+	readback->burst_destination = _burst_capture_view + sizeof(burst_capture_header) + header->frame_capacity * sizeof(uint64_t) + static_cast<size_t>(slot) * header->frame_size;
+
+	header->frame_count = ++_burst_capture_frame_count;
+}
+void reshade::runtime::save_screenshot_data(std::vector<uint8_t> pixels, unsigned int screenshot_count, std::string postfix, bool include_preset)
+{
 	std::string screenshot_name = expand_macro_string(_screenshot_name, {
 		{ "AppName", g_target_executable_path.stem().u8string() },
 #if RESHADE_FX
@@ -4799,7 +7592,7 @@ void reshade::runtime::save_screenshot(const std::string_view postfix)
 	});
 
 	screenshot_name += postfix;
-	screenshot_name += (_screenshot_format == 0 ? ".bmp" : _screenshot_format == 1 ? ".png" : ".jpg");
+	screenshot_name += (_screenshot_format == 0 ? ".bmp" : _screenshot_format == 2 ? ".jpg" : ".png");
 
 	const std::filesystem::path screenshot_path = g_reshade_base_path / _screenshot_path / std::filesystem::u8path(screenshot_name);
 
@@ -4807,69 +7600,57 @@ void reshade::runtime::save_screenshot(const std::string_view postfix)
 
 	_last_screenshot_save_successful = true;
 
-	if (std::vector<uint8_t> pixels(static_cast<size_t>(_width) * static_cast<size_t>(_height) * 4);
-		capture_screenshot(pixels.data()))
-	{
-#if RESHADE_FX
-		const bool include_preset = _screenshot_include_preset && postfix.empty() && ini_file::flush_cache(_current_preset_path);
-#else
-		const bool include_preset = false;
-#endif
-		// Play screenshot sound
-		if (!_screenshot_sound_path.empty())
-			utils::play_sound_async(g_reshade_base_path / _screenshot_sound_path);
-
-		_worker_threads.emplace_back([this, screenshot_count, screenshot_path, pixels = std::move(pixels), include_preset]() mutable {
-			// Remove alpha channel
-			int comp = 4;
-			if (_screenshot_clear_alpha)
-			{
-				comp = 3;
-				for (size_t i = 0; i < static_cast<size_t>(_width) * static_cast<size_t>(_height); ++i)
-					*reinterpret_cast<uint32_t *>(pixels.data() + 3 * i) = *reinterpret_cast<const uint32_t *>(pixels.data() + 4 * i);
-			}
+	_worker_threads.emplace_back([this, screenshot_count, screenshot_path, pixels = std::move(pixels), include_preset]() mutable {
+		// Remove alpha channel
+		int comp = 4;
+		if (_screenshot_clear_alpha)
+		{
+			comp = 3;
+			for (size_t i = 0; i < static_cast<size_t>(_width) * static_cast<size_t>(_height); ++i)
+				*reinterpret_cast<uint32_t *>(pixels.data() + 3 * i) = *reinterpret_cast<const uint32_t *>(pixels.data() + 4 * i);
+		}
 
-			// Create screenshot directory if it does not exist
-			std::error_code ec;
-			_screenshot_directory_creation_successful = true;
-			if (!std::filesystem::exists(screenshot_path.parent_path(), ec))
-				if (!(_screenshot_directory_creation_successful = std::filesystem::create_directories(screenshot_path.parent_path(), ec)))
-					log::message(log::level::error, "Failed to create screenshot directory '%s' with error code %d!", screenshot_path.parent_path().u8string().c_str(), ec.value());
+		// Create screenshot directory if it does not exist
+		std::error_code ec;
+		_screenshot_directory_creation_successful = true;
+		if (!std::filesystem::exists(screenshot_path.parent_path(), ec))
+			if (!(_screenshot_directory_creation_successful = std::filesystem::create_directories(screenshot_path.parent_path(), ec)))
+				log::message(log::level::error, "Failed to create screenshot directory '%s' with error code %d!", screenshot_path.parent_path().u8string().c_str(), ec.value());
 
-			// Default to a save failure unless it is reported to succeed below
-			bool save_success = false;
+		// Default to a save failure unless encoding is reported to succeed below
+		bool save_success = false;
 
-			if (FILE *const file = _wfsopen(screenshot_path.c_str(), L"wb", SH_DENYNO))
-			{
-				const auto write_callback = [](void *context, void *data, int size) {
-					fwrite(data, 1, size, static_cast<FILE *>(context));
-				};
+		// Encode the image to memory, so that the file write can be handed to the shared write-behind queue below
+		std::vector<uint8_t> encoded_data;
+		{
+			const auto write_callback = [](void *context, void *data, int size) {
+				const auto encoded_data_p = static_cast<std::vector<uint8_t> *>(context);
+				encoded_data_p->insert(encoded_data_p->end(), static_cast<const uint8_t *>(data), static_cast<const uint8_t *>(data) + size);
+			};
 
-				switch (_screenshot_format)
-				{
-				case 0:
-					save_success = stbi_write_bmp_to_func(write_callback, file, _width, _height, comp, pixels.data()) != 0;
-					break;
-				case 1:
+			switch (_screenshot_format)
+			{
+			case 0:
+				save_success = stbi_write_bmp_to_func(write_callback, &encoded_data, _width, _height, comp, pixels.data()) != 0;
+				break;
+			case 1:
 #if 1
-					if (std::vector<uint8_t> encoded_data;
-						fpng::fpng_encode_image_to_memory(pixels.data(), _width, _height, comp, encoded_data))
-						save_success = fwrite(encoded_data.data(), 1, encoded_data.size(), file) == encoded_data.size();
+				save_success = fpng::fpng_encode_image_to_memory(pixels.data(), _width, _height, comp, encoded_data);
 #else
-					save_success = stbi_write_png_to_func(write_callback, file, _width, _height, comp, pixels.data(), 0) != 0;
+				save_success = stbi_write_png_to_func(write_callback, &encoded_data, _width, _height, comp, pixels.data(), 0) != 0;
 #endif
-					break;
-				case 2:
-					save_success = stbi_write_jpg_to_func(write_callback, file, _width, _height, comp, pixels.data(), _screenshot_jpeg_quality) != 0;
-					break;
-				}
-
-				if (ferror(file))
-					save_success = false;
-
-				fclose(file);
+				break;
+			case 2:
+				save_success = stbi_write_jpg_to_func(write_callback, &encoded_data, _width, _height, comp, pixels.data(), _screenshot_jpeg_quality) != 0;
+				break;
+			case 3:
+				save_success = encode_png_parallel(pixels.data(), _width, _height, comp, encoded_data);
+				break;
 			}
+		}
 
+		// Executed on the writer thread of the write-behind queue once the file write finished (or below when the write did not happen asynchronously)
+		const auto finish_save = [this, screenshot_count, screenshot_path, include_preset](bool save_success) {
 			if (save_success)
 			{
 				execute_screenshot_post_save_command(screenshot_path, screenshot_count);
@@ -4881,6 +7662,7 @@ void reshade::runtime::save_screenshot(const std::string_view postfix)
 					screenshot_preset_path.replace_extension(L".ini");
 
 					// Preset was flushed to disk, so can just copy it over to the new location
+					std::error_code ec;
 					if (!std::filesystem::copy_file(_current_preset_path, screenshot_preset_path, std::filesystem::copy_options::overwrite_existing, ec))
 						log::message(log::level::error, "Failed to copy preset file for screenshot to '%s' with error code %d!", screenshot_preset_path.u8string().c_str(), ec.value());
 				}
@@ -4901,7 +7683,93 @@ void reshade::runtime::save_screenshot(const std::string_view postfix)
 				_last_screenshot_file = screenshot_path;
 				_last_screenshot_save_successful = save_success;
 			}
-		});
+		};
+
+		if (save_success)
+		{
+			// Hand the encoded image to the shared write-behind queue, so that burst captures are not serialized on disk I/O, but fall back to writing synchronously when it is saturated
+			if (std::filesystem::path write_path = screenshot_path;
+				!get_file_write_queue().enqueue(std::move(write_path), std::move(encoded_data), finish_save))
+			{
+				bool write_success = false;
+				if (FILE *const file = _wfsopen(screenshot_path.c_str(), L"wb", SH_DENYNO))
+				{
+					write_success = fwrite(encoded_data.data(), 1, encoded_data.size(), file) == encoded_data.size() && ferror(file) == 0;
+					fclose(file);
+				}
+
+				finish_save(write_success);
+			}
+		}
+		else
+		{
+			finish_save(false);
+		}
+	});
+}
+void reshade::runtime::finish_pending_screenshots(bool wait)
+{
+	if (_screenshot_fence == 0)
+		return;
+
+	for (screenshot_readback &readback : _screenshot_readbacks)
+	{
+		if (readback.fence_value == 0)
+			continue;
+		if (wait)
+			_device->wait(_screenshot_fence, readback.fence_value);
+		else if (_device->get_completed_fence_value(_screenshot_fence) < readback.fence_value)
+			continue;
+
+		// Frames that belong to a burst capture are converted directly into the memory-mapped capture file and skip the usual encode and save path
+		if (readback.burst_destination != nullptr)
+		{
+			const api::resource_desc desc = _device->get_resource_desc(readback.intermediate);
+
+			api::subresource_data mapped_data = {};
+			if (_device->map_texture_region(readback.intermediate, 0, nullptr, api::map_access::read_only, &mapped_data))
+			{
+				convert_mapped_texture_data(readback.view_format, desc.texture.width, desc.texture.height, mapped_data, readback.burst_destination);
+
+				_device->unmap_texture_region(readback.intermediate, 0);
+			}
+			else
+			{
+				log::message(log::level::error, "Failed to map system memory texture for burst capture!");
+			}
+
+			readback.burst_destination = nullptr;
+			readback.fence_value = 0;
+			continue;
+		}
+
+		const api::resource_desc desc = _device->get_resource_desc(readback.intermediate);
+
+		api::subresource_data mapped_data = {};
+		if (std::vector<uint8_t> pixels(static_cast<size_t>(desc.texture.width) * static_cast<size_t>(desc.texture.height) * 4);
+			_device->map_texture_region(readback.intermediate, 0, nullptr, api::map_access::read_only, &mapped_data))
+		{
+			convert_mapped_texture_data(readback.view_format, desc.texture.width, desc.texture.height, mapped_data, pixels.data());
+
+			_device->unmap_texture_region(readback.intermediate, 0);
+
+			if (readback.callback != nullptr)
+				readback.callback(readback.user_data, pixels.data(), desc.texture.width, desc.texture.height);
+			else
+				save_screenshot_data(std::move(pixels), readback.screenshot_count, std::move(readback.postfix), readback.include_preset);
+		}
+		else
+		{
+			log::message(log::level::error, "Failed to map system memory texture for screenshot capture!");
+
+			if (readback.callback != nullptr)
+				readback.callback(readback.user_data, nullptr, 0, 0);
+			else
+				_last_screenshot_save_successful = false;
+		}
+
+		readback.callback = nullptr;
+		readback.fence_value = 0;
 	}
 }
 bool reshade::runtime::execute_screenshot_post_save_command(const std::filesystem::path &screenshot_path, unsigned int screenshot_count)
@@ -4945,14 +7813,7 @@ bool reshade::runtime::get_texture_data(api::resource resource, api::resource_us
 	const api::resource_desc desc = _device->get_resource_desc(resource);
 	const api::format view_format = api::format_to_default_typed(desc.texture.format, 0);
 
-	if (view_format != api::format::r8_unorm &&
-		view_format != api::format::r8g8_unorm &&
-		view_format != api::format::r8g8b8a8_unorm &&
-		view_format != api::format::b8g8r8a8_unorm &&
-		view_format != api::format::r8g8b8x8_unorm &&
-		view_format != api::format::b8g8r8x8_unorm &&
-		view_format != api::format::r10g10b10a2_unorm &&
-		view_format != api::format::b10g10r10a2_unorm)
+	if (!is_screenshot_compatible_format(view_format))
 	{
 		log::message(log::level::error, "Screenshots are not supported for format %u!", static_cast<uint32_t>(desc.texture.format));
 		return false;
@@ -4982,64 +7843,7 @@ bool reshade::runtime::get_texture_data(api::resource resource, api::resource_us
 	api::subresource_data mapped_data = {};
 	if (_device->map_texture_region(intermediate, 0, nullptr, api::map_access::read_only, &mapped_data))
 	{
-		auto mapped_pixels = static_cast<const uint8_t *>(mapped_data.data);
-		const uint32_t pixels_row_pitch = desc.texture.width * 4;
-
-		for (size_t y = 0; y < desc.texture.height; ++y, pixels += pixels_row_pitch, mapped_pixels += mapped_data.row_pitch)
-		{
-			switch (view_format)
-			{
-			case api::format::r8_unorm:
-				for (size_t x = 0; x < desc.texture.width; ++x)
-				{
-					pixels[x * 4 + 0] = mapped_pixels[x];
-					pixels[x * 4 + 1] = 0;
-					pixels[x * 4 + 2] = 0;
-					pixels[x * 4 + 3] = 0xFF;
-				}
-				break;
-			case api::format::r8g8_unorm:
-				for (size_t x = 0; x < desc.texture.width; ++x)
-				{
-					pixels[x * 4 + 0] = mapped_pixels[x * 2 + 0];
-					pixels[x * 4 + 1] = mapped_pixels[x * 2 + 1];
-					pixels[x * 4 + 2] = 0;
-					pixels[x * 4 + 3] = 0xFF;
-				}
-				break;
-			case api::format::r8g8b8a8_unorm:
-			case api::format::r8g8b8x8_unorm:
-				std::memcpy(pixels, mapped_pixels, pixels_row_pitch);
-				if (view_format == api::format::r8g8b8x8_unorm)
-					for (size_t x = 0; x < pixels_row_pitch; x += 4)
-						pixels[x + 3] = 0xFF;
-				break;
-			case api::format::b8g8r8a8_unorm:
-			case api::format::b8g8r8x8_unorm:
-				std::memcpy(pixels, mapped_pixels, pixels_row_pitch);
-				// Format is BGRA, but output should be RGBA, so flip channels
-				for (size_t x = 0; x < pixels_row_pitch; x += 4)
-					std::swap(pixels[x + 0], pixels[x + 2]);
-				if (view_format == api::format::b8g8r8x8_unorm)
-					for (size_t x = 0; x < pixels_row_pitch; x += 4)
-						pixels[x + 3] = 0xFF;
-				break;
-			case api::format::r10g10b10a2_unorm:
-			case api::format::b10g10r10a2_unorm:
-				for (size_t x = 0; x < pixels_row_pitch; x += 4)
-				{
-					const uint32_t rgba = *reinterpret_cast<const uint32_t *>(mapped_pixels + x);
-					// Divide by 4 to get 10-bit range (0-1023) into 8-bit range (0-255)
-					pixels[x + 0] = (( rgba & 0x000003FF)        /  4) & 0xFF;
-					pixels[x + 1] = (((rgba & 0x000FFC00) >> 10) /  4) & 0xFF;
-					pixels[x + 2] = (((rgba & 0x3FF00000) >> 20) /  4) & 0xFF;
-					pixels[x + 3] = (((rgba & 0xC0000000) >> 30) * 85) & 0xFF;
-					if (view_format == api::format::b10g10r10a2_unorm)
-						std::swap(pixels[x + 0], pixels[x + 2]);
-				}
-				break;
-			}
-		}
+		convert_mapped_texture_data(view_format, desc.texture.width, desc.texture.height, mapped_data, pixels);
 
 		_device->unmap_texture_region(intermediate, 0);
 	}
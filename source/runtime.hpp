@@ -6,7 +6,9 @@
 #pragma once
 
 #include "reshade_api.hpp"
+#include "moving_average.hpp"
 #include "state_block.hpp"
+#include "thread_pool.hpp"
 #include "imgui_code_editor.hpp"
 #include <chrono>
 #include <memory>
@@ -93,6 +95,8 @@ namespace reshade
 
 		api::effect_uniform_variable find_uniform_variable(const char *effect_name, const char *variable_name) const final;
 
+		void get_uniform_variables(const char *effect_name, api::effect_uniform_variable *out_variables, size_t *count) const final;
+
 		void get_uniform_variable_type(api::effect_uniform_variable variable, api::format *out_base_type, uint32_t *out_rows, uint32_t *out_columns, uint32_t *out_array_length) const final;
 
 		void get_uniform_variable_name(api::effect_uniform_variable variable, char *name, size_t *name_size) const final;
@@ -139,6 +143,8 @@ namespace reshade
 
 		api::effect_technique find_technique(const char *effect_name, const char *technique_name) final;
 
+		void get_techniques(const char *effect_name, api::effect_technique *out_techniques, size_t *count) final;
+
 		void get_technique_name(api::effect_technique technique, char *name, size_t *name_size) const final;
 		void get_technique_effect_name(api::effect_technique technique, char *effect_name, size_t *effect_name_size) const final;
 
@@ -170,21 +176,35 @@ namespace reshade
 
 		void reload_effect_next_frame(const char *effect_name) final;
 
+		uint64_t get_technique_pass_gpu_duration(api::effect_technique technique, size_t pass_index) const final;
+
+		bool capture_screenshot_async(void (*callback)(void *user_data, const uint8_t *pixels, uint32_t width, uint32_t height), void *user_data) final;
+
+		uint64_t get_frame_duration_percentile(float percent) const final;
+		uint64_t get_technique_gpu_duration_percentile(api::effect_technique technique, float percent) const final;
+
+		uint64_t get_effect_texture_memory_usage(const char *effect_name) const final;
+
 	private:
 		static void check_for_update();
 
 		void load_config();
 		void save_config() const;
 
+		void save_performance_log_sample();
+		void flush_performance_log();
+
 #if RESHADE_FX
 		void load_current_preset();
 		void save_current_preset() const final;
 
 		bool switch_to_next_preset(std::filesystem::path filter_path, bool reversed = false);
 
-		bool load_effect(const std::filesystem::path &source_file, const ini_file &preset, size_t effect_index, bool force_load = false, bool preprocess_required = false);
+		bool load_effect(const std::filesystem::path &source_file, const ini_file &preset, size_t effect_index, bool force_load = false, bool preprocess_required = false, bool cache_only = false);
+		bool compile_effect_entry_point(effect &effect, const std::pair<std::string, reshadefx::shader_type> &entry_point, std::string entry_point_code);
 		bool create_effect(size_t effect_index);
 		bool create_effect_sampler_state(const reshadefx::sampler_desc &desc, api::sampler &sampler);
+		bool respecialize_effect(size_t effect_index, const ini_file &preset);
 		void destroy_effect(size_t effect_index);
 
 		void load_textures();
@@ -201,15 +221,49 @@ namespace reshade
 		void reload_effects(bool force_load_all = false);
 		void destroy_effects();
 
+		void start_effect_file_watcher();
+		void stop_effect_file_watcher();
+		// Maps externally modified effect files to the effects that include them and schedules those for a granular reload (see 'update_effects')
+		void check_for_effect_file_changes();
+
+		void precompile_presets();
+
 		bool load_effect_cache(const std::string &id, const std::string &type, std::string &data) const;
 		bool save_effect_cache(const std::string &id, const std::string &type, const std::string &data) const;
 		void clear_effect_cache();
 
+		std::string get_effect_assembly_text(const effect &effect, const std::string &entry_point_name) const;
+		std::string get_effect_generated_code(const effect &effect) const;
+
 		bool update_effect_color_and_stencil_tex(uint32_t width, uint32_t height, api::format color_format, api::format stencil_format);
 
+		struct scaled_render_target
+		{
+			uint32_t width = 0;
+			uint32_t height = 0;
+			api::resource tex = {};
+			api::resource_view rtv[2] = {};
+			api::resource_view srv = {};
+		};
+
+		// Gets (or creates on first use) the scaled intermediate render target for the specified render scale, or returns 'nullptr' when creation failed
+		const scaled_render_target *acquire_scaled_render_target(float scale);
+		void destroy_scaled_render_targets();
+		// Stretches 'source' over the entirety of 'dest' using linear filtering, transitioning both resources from and back to the specified resource usages
+		void stretch_texture(api::command_list *cmd_list, api::resource source, api::resource_view source_srv, api::resource_usage source_usage, uint32_t source_width, uint32_t source_height, api::resource dest, api::resource_view dest_rtv, api::resource_usage dest_usage, uint32_t dest_width, uint32_t dest_height);
+
 		void update_effects();
+		void update_effect_gpu_budget();
+		void update_special_uniform_variables();
+		void update_shared_uniform_variables();
+		void update_technique_render_order();
 		void render_technique(technique &technique, api::command_list *cmd_list, api::resource back_buffer_resource, api::resource_view back_buffer_rtv, api::resource_view back_buffer_rtv_srgb);
 
+		// Checks whether effect rendering this frame can be recorded into a deferred command list on a worker thread, creating that command list on first use
+		bool prepare_deferred_effect_rendering();
+		// Waits for the worker recording to finish and executes the result on the immediate command list (safe to call when no recording is pending)
+		void finish_deferred_effect_rendering();
+
 		void save_texture(const texture &texture);
 		void update_texture(texture &texture, uint32_t width, uint32_t height, uint32_t depth, const void *pixels);
 
@@ -239,6 +293,9 @@ namespace reshade
 
 		bool get_texture_data(api::resource resource, api::resource_usage state, uint8_t *pixels);
 
+		void save_screenshot_data(std::vector<uint8_t> pixels, unsigned int screenshot_count, std::string postfix, bool include_preset);
+		void finish_pending_screenshots(bool wait);
+
 		bool execute_screenshot_post_save_command(const std::filesystem::path &screenshot_path, unsigned int screenshot_count);
 
 		api::swapchain *const _swapchain;
@@ -253,6 +310,8 @@ namespace reshade
 		api::format _back_buffer_format = api::format::unknown;
 		api::color_space _back_buffer_color_space = api::color_space::unknown;
 		bool _is_vr = false;
+		// Set when ReShade will not modify the current frame, so that the later rendering stages in 'on_present' and 'draw_gui' stay consistent with the state capture decision taken at the start of the frame
+		bool _skip_rendering_this_frame = false;
 
 #if RESHADE_ADDON
 		bool _is_in_api_call = false;
@@ -278,8 +337,18 @@ namespace reshade
 #endif
 
 		std::chrono::high_resolution_clock::duration _last_frame_duration;
+		// Distribution of recent frame times, to display percentiles and stutter counts in the statistics overlay, since a plain average hides those outliers
+		duration_histogram<uint64_t, 64> _frame_duration_histogram;
+#if RESHADE_GUI
+		// Decimated history of frame times (in milliseconds) covering the last minute, to plot in the statistics overlay at a fixed point count
+		decimated_history<float, 240> _frame_time_history { 60000.0f };
+#endif
 		std::chrono::high_resolution_clock::time_point _start_time, _last_present_time;
 		uint64_t _frame_count = 0;
+
+		unsigned int _fps_limit = 0;
+		void *_pacing_timer = nullptr;
+		std::chrono::high_resolution_clock::time_point _next_present_deadline;
 		#pragma endregion
 
 		#pragma region Effect Loading
@@ -288,6 +357,7 @@ namespace reshade
 		bool _no_effect_cache = false;
 		bool _no_reload_on_init = false;
 		bool _performance_mode = false;
+		bool _relaxed_precision = false;
 		bool _effect_load_skipping = false;
 		unsigned int _reload_key_data[4] = {};
 		unsigned int _performance_mode_key_data[4] = {};
@@ -301,20 +371,69 @@ namespace reshade
 		std::vector<std::filesystem::path> _effect_search_paths;
 		std::vector<std::filesystem::path> _texture_search_paths;
 
+		// Watch for change notifications on the effect search paths, which only set the flag below, so that the timestamp scan and reload scheduling happen on the thread calling 'update_effects' (see 'check_for_effect_file_changes')
+		bool _watch_effect_files = false;
+		void *_effect_file_watcher = nullptr;
+		std::atomic<bool> _effect_files_possibly_changed = false;
+		std::filesystem::file_time_type _effect_file_watch_time;
+
 		std::atomic<bool> _last_reload_successful = true;
 		bool _textures_loaded = false;
+		// Image data that finished decoding on a thread pool worker and is waiting to be uploaded to its texture resource (see 'load_textures')
+		struct pending_texture_upload
+		{
+			std::string texture_name;
+			uint32_t width = 0;
+			uint32_t height = 0;
+			uint32_t depth = 0;
+			void *pixels = nullptr; // Allocated by stb_image, so has to be released with 'stbi_image_free'
+			// Set when 'pixels' contains a raw block-compressed DDS file rather than decoded image data, with the mipmap chain starting at 'data_offset'
+			api::format compressed_format = api::format::unknown;
+			uint32_t levels = 1;
+			size_t data_offset = 0;
+		};
+		std::mutex _texture_upload_mutex;
+		std::vector<pending_texture_upload> _texture_upload_queue;
+		thread_pool::job_group _texture_load_job_group;
 		std::shared_mutex _reload_mutex;
 		std::vector<size_t> _reload_create_queue;
 		std::atomic<size_t> _reload_remaining_effects = std::numeric_limits<size_t>::max();
+		std::atomic<size_t> _reload_priority_remaining_effects = std::numeric_limits<size_t>::max();
+		// Sorted indices of the effects that contain techniques enabled in the current preset and are therefore compiled with priority (only accessed by the thread calling 'update_effects')
+		std::vector<size_t> _reload_priority_effect_indices;
+		// Set after the preset was applied in the middle of a reload, so that rendering with the priority effects can begin while the remaining effects are still compiling
+		bool _reload_preset_applied_early = false;
+		// Time budget in milliseconds for creating GPU objects of compiled effects each frame, so that post-reload convergence is bounded by actual creation cost rather than one effect per frame (see 'update_effects')
+		float _effect_create_budget = 3.0f;
 		void *_d3d_compiler_module = nullptr;
 
 		std::vector<effect> _effects;
 		std::vector<texture> _textures;
 		std::vector<technique> _techniques;
 		std::vector<size_t> _technique_sorting;
+		// Technique execution order derived from '_technique_sorting' by grouping commutative techniques of the same effect, used in place of the sorting when '_optimize_technique_order' is set (see 'update_technique_render_order')
+		std::vector<size_t> _technique_render_order;
+		// Number of compute-only techniques hoisted to the front of the render order, which are submitted to the GPU early (see 'render_effects')
+		size_t _technique_render_order_compute_prefix = 0;
+		bool _technique_render_order_invalidated = true;
+		// Set to reorder neighboring techniques that do not sample each other's output before rendering, so that fewer state transitions and back buffer copies occur per frame
+		bool _optimize_technique_order = false;
 #endif
 		std::vector<std::thread> _worker_threads;
+		thread_pool::job_group _reload_job_group;
+		// Optionally pre-populate the effect cache for the other presets in the preset directory in the background, so that later preset switches hit a warm cache (see 'precompile_presets')
+		bool _precompile_presets = false;
+		bool _precompile_presets_started = false;
+		thread_pool::job_group _precompile_job_group;
 		std::chrono::high_resolution_clock::time_point _last_reload_time;
+		std::chrono::high_resolution_clock::time_point _last_reload_start_time;
+		std::atomic<unsigned int> _effect_cache_hits = 0;
+		std::atomic<unsigned int> _effect_cache_misses = 0;
+		// Optionally sample performance data into a rotating log file for external monitoring tooling (see 'save_performance_log_sample'), disabled while the sampling interval is zero
+		unsigned int _performance_log_interval = 0;
+		unsigned int _performance_log_frame_count = 0;
+		std::chrono::high_resolution_clock::time_point _last_performance_log_time;
+		std::string _performance_log_pending;
 		#pragma endregion
 
 		#pragma region Effect Rendering
@@ -330,6 +449,42 @@ namespace reshade
 		api::resource _effect_stencil_tex = {};
 		api::resource_view _effect_stencil_dsv = {};
 
+		// Scaled intermediate render targets for techniques with a render scale below one, cached per resolution (a zero resource marks a resolution that failed to create, see 'render_technique')
+		std::vector<scaled_render_target> _scaled_render_targets;
+		// Sampler with linear filtering for the scaling blits, since the point filtering of '_copy_sampler_state' would produce blocky upscaling
+		api::sampler _scale_sampler_state = {};
+
+		// Additionally gather GPU timings for each individual pass, rather than just each technique (at the cost of additional timestamp queries)
+		bool _gather_gpu_statistics_per_pass = false;
+		// Gather GPU timings even while the statistics overlay is closed, so that external tooling can read them
+		bool _force_gather_gpu_statistics = false;
+		// Number of frames timestamp query results are delayed by, to avoid stalling on queries the GPU has not finished yet
+		unsigned int _gpu_timestamp_frames = 4;
+
+		// Timestamp queries of all effects are pooled in a single heap, with a contiguous range of begin/end pairs per effect and a separate slice of the heap per command frame, so that a frame's results can be read back in batch (see 'update_effect_query_results')
+		api::query_heap _effect_query_heap = {};
+		uint32_t _effect_query_heap_pairs = 0;
+		// Cached results and per-pair validity of the frame slice that was last read back
+		std::vector<uint64_t> _effect_query_results;
+		std::vector<bool> _effect_query_results_valid;
+		uint64_t _effect_query_results_frame = std::numeric_limits<uint64_t>::max();
+		// Query pairs that were written during each frame slice, which are the ones read back when that slice comes around again
+		std::vector<std::vector<std::pair<uint32_t, uint32_t>>> _effect_query_pending_ranges;
+
+		bool allocate_effect_query_pairs(effect &effect, uint32_t count);
+		void update_effect_query_results();
+		// GPU time budget for all effects in milliseconds, beyond which the most expensive techniques are run every few frames only, to stay within it (zero disables the scheduler, see <see cref="update_effect_gpu_budget"/>)
+		float _effect_gpu_budget = 0.0f;
+
+		// Record effect rendering into a deferred context on a worker thread, so that it overlaps with overlay rendering on the present thread (D3D11 only, see 'prepare_deferred_effect_rendering')
+		bool _deferred_effect_rendering = false;
+		bool _deferred_effect_rendering_failed = false;
+		bool _deferred_effect_recording_pending = false;
+		bool _special_uniforms_updated_this_frame = false;
+		api::command_list *_deferred_effect_cmd_list = nullptr;
+		api::resource _deferred_effect_back_buffer = {};
+		thread_pool::job_group _deferred_effect_job_group;
+
 		std::unordered_map<size_t, api::sampler> _effect_sampler_states;
 		std::unordered_map<std::string, std::pair<api::resource_view, api::resource_view>> _texture_semantic_bindings;
 #if RESHADE_ADDON == 1
@@ -363,6 +518,8 @@ namespace reshade
 		unsigned int _screenshot_format = 1;
 		unsigned int _screenshot_jpeg_quality = 90;
 		unsigned int _screenshot_key_data[4] = {};
+		unsigned int _burst_capture_key_data[4] = {};
+		unsigned int _burst_capture_duration = 3;
 		std::filesystem::path _screenshot_sound_path;
 		std::filesystem::path _screenshot_path;
 		std::string _screenshot_name;
@@ -376,6 +533,37 @@ namespace reshade
 		bool _screenshot_directory_creation_successful = true;
 		std::filesystem::path _last_screenshot_file;
 		std::chrono::high_resolution_clock::time_point _last_screenshot_time;
+
+		// Readback textures the back buffer is copied into when capturing a screenshot, which are only mapped in a later frame once the GPU has finished the copy, so that capturing does not stall the frame (see <see cref="runtime::save_screenshot"/>)
+		// The slots are shared between screenshots saved to disk and asynchronous captures started through the addon API (see <see cref="runtime::capture_screenshot_async"/>)
+		struct screenshot_readback
+		{
+			api::resource intermediate = {};
+			api::format view_format = api::format::unknown;
+			uint64_t fence_value = 0;
+			unsigned int screenshot_count = 0;
+			std::string postfix;
+			bool include_preset = false;
+			void (*callback)(void *user_data, const uint8_t *pixels, uint32_t width, uint32_t height) = nullptr;
+			void *user_data = nullptr;
+			uint8_t *burst_destination = nullptr;
+		};
+		screenshot_readback _screenshot_readbacks[4];
+		api::fence _screenshot_fence = {};
+		uint64_t _screenshot_fence_value = 0;
+
+		screenshot_readback *acquire_screenshot_readback();
+
+		// Memory-mapped capture file raw frames are appended to while a burst capture is active (see <see cref="runtime::start_burst_capture"/>)
+		void *_burst_capture_mapping = nullptr;
+		uint8_t *_burst_capture_view = nullptr;
+		uint32_t _burst_capture_frame_count = 0;
+		std::filesystem::path _burst_capture_file;
+		std::chrono::high_resolution_clock::time_point _burst_capture_start_time;
+
+		void start_burst_capture();
+		void stop_burst_capture();
+		void capture_burst_frame();
 		#pragma endregion
 
 		#pragma region Preset Switching
@@ -385,10 +573,24 @@ namespace reshade
 		unsigned int _preset_transition_duration = 1000;
 		std::filesystem::path _startup_preset_path;
 		std::filesystem::path _current_preset_path;
+		// Set to share uniform values between all runtime instances in this process that loaded the same preset, e.g. to keep a desktop mirror in sync with a VR runtime (see 'update_shared_uniform_variables')
+		bool _share_uniform_variables = false;
+		// Preset the effects were attached to their shared uniform blocks under, so that a preset switch detaches them again
+		std::filesystem::path _shared_uniform_preset_path;
 
 		bool _is_in_preset_transition = false;
 		std::chrono::high_resolution_clock::time_point _last_preset_switching_time;
 
+		// Floating point uniform values of the transition target preset, pre-resolved on the first frame of a preset transition, so that the update every frame during the transition is a flat interpolation walk instead of a full preset load (see 'load_current_preset')
+		struct preset_transition_value
+		{
+			size_t effect_index;
+			size_t uniform_index;
+			float value[16];
+		};
+		std::vector<preset_transition_value> _preset_transition_values;
+		bool _preset_transition_values_valid = false;
+
 		struct preset_shortcut
 		{
 			std::filesystem::path preset_path;
@@ -411,14 +613,20 @@ namespace reshade
 		void load_custom_style();
 		void save_custom_style() const;
 
+		// Checks whether 'draw_gui' may put anything on screen this frame, so that the present path can skip preparing for rendering otherwise
+		bool is_gui_draw_pending() const;
+
 		void draw_gui();
 		void draw_gui_vr();
+		// Renders just the clock, FPS and frame time texts with a standalone draw list, so that the passive OSD does not have to spin up a full ImGui frame
+		void draw_gui_osd();
 
 #if RESHADE_FX
 		void draw_gui_home();
 #endif
 		void draw_gui_settings();
 		void draw_gui_statistics();
+		void draw_gui_profiler();
 		void draw_gui_log();
 		void draw_gui_about();
 #if RESHADE_ADDON
@@ -427,6 +635,12 @@ namespace reshade
 #if RESHADE_FX
 		void draw_variable_editor();
 		void draw_technique_editor();
+
+		// Measures the GPU cost of each enabled technique in isolation over a number of frames and builds a sorted cost report (see 'draw_gui_statistics')
+		void start_preset_audit();
+		void stop_preset_audit();
+		void update_preset_audit();
+		bool save_preset_audit_report(const std::filesystem::path &path) const;
 #endif
 
 		bool init_imgui_resources();
@@ -469,9 +683,15 @@ namespace reshade
 		api::resource _imgui_indices[4] = {};
 		int _imgui_num_vertices[4] = {};
 		api::resource _imgui_vertices[4] = {};
+		// Buffers that were replaced with larger ones, together with the fence value of the frame that retired them (see 'render_imgui_draw_data')
+		api::fence _imgui_buffer_fence = {};
+		uint64_t _imgui_buffer_fence_value = 0;
+		std::vector<std::pair<uint64_t, api::resource>> _imgui_retired_buffers;
 
 		api::resource _vr_overlay_tex = {};
 		api::resource_view _vr_overlay_target = {};
+		// Fingerprint of the ImGui draw data last rendered into the VR overlay, used to skip re-rendering and re-submitting it while its content does not change (see 'draw_gui_vr')
+		size_t _vr_overlay_draw_data_hash = 0;
 		#pragma endregion
 
 		#pragma region Overlay Home
@@ -518,10 +738,35 @@ namespace reshade
 		#pragma region Overlay Statistics
 #if RESHADE_FX
 		bool _gather_gpu_statistics = false;
+		// Decimated history of the total post-processing GPU time (in milliseconds), only filled while the technique statistics are visible, since GPU timings are not gathered otherwise
+		decimated_history<float, 240> _post_processing_time_history { 60000.0f };
 		api::resource_view _preview_texture = {};
 		unsigned int _preview_size[3] = { 0, 0, 0xFFFFFFFF };
 		uint64_t _timestamp_frequency = 0;
+
+		// State of the preset performance audit, which temporarily renders each enabled technique on its own to measure its GPU cost in isolation
+		bool _preset_audit_active = false;
+		int _preset_audit_frame_count = 120;
+		unsigned int _preset_audit_frames_remaining = 0;
+		size_t _preset_audit_current = std::numeric_limits<size_t>::max();
+		std::vector<size_t> _preset_audit_technique_indices;
+		// Audited technique indices and their measured average GPU durations, sorted by cost once the audit finished
+		std::vector<std::pair<size_t, uint64_t>> _preset_audit_results;
 #endif
+
+		/// <summary>
+		/// Measures the time from entering <see cref="on_present"/> until the GPU finished executing all the work submitted during it, using a fence signaled after submission and waited on by a monitoring thread.
+		/// </summary>
+		void update_present_latency(std::chrono::high_resolution_clock::time_point present_start_time);
+
+		bool _gather_present_latency = false;
+		api::fence _present_latency_fence = {};
+		std::atomic<uint64_t> _present_latency_fence_value = 0;
+		std::atomic<bool> _present_latency_thread_exit = false;
+		std::thread _present_latency_thread;
+		// Ring buffer with the start times (in nanoseconds) of recent frames, indexed by fence value and read by the monitoring thread once the corresponding fence value passed
+		std::atomic<uint64_t> _present_latency_start_times[8] = {};
+		std::atomic<uint64_t> _present_latency_average = 0; // In nanoseconds
 		#pragma endregion
 
 		#pragma region Overlay Log
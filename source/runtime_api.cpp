@@ -89,6 +89,37 @@ reshade::api::effect_uniform_variable reshade::runtime::find_uniform_variable([[
 	if (is_loading())
 		return { 0 };
 
+	for (const effect &effect : _effects)
+	{
+		if (effect_name != nullptr && effect.source_file.filename() != effect_name)
+			continue;
+
+		// Look up the variable in the name index built during loading, instead of scanning the entire uniform list
+		const auto it = effect.uniform_index.find(variable_name);
+		if (it != effect.uniform_index.end())
+			return { reinterpret_cast<uintptr_t>(&effect.uniforms[it->second]) };
+
+		if (effect_name != nullptr)
+			break;
+	}
+#endif
+
+	return { 0 };
+}
+
+void reshade::runtime::get_uniform_variables([[maybe_unused]] const char *effect_name, [[maybe_unused]] api::effect_uniform_variable *out_variables, size_t *count) const
+{
+	if (count == nullptr)
+		return;
+
+	size_t written = 0;
+#if RESHADE_FX
+	if (is_loading())
+	{
+		*count = 0;
+		return;
+	}
+
 	for (const effect &effect : _effects)
 	{
 		if (effect_name != nullptr && effect.source_file.filename() != effect_name)
@@ -96,16 +127,20 @@ reshade::api::effect_uniform_variable reshade::runtime::find_uniform_variable([[
 
 		for (const uniform &variable : effect.uniforms)
 		{
-			if (variable.name == variable_name)
-				return { reinterpret_cast<uintptr_t>(&variable) };
+			if (out_variables != nullptr)
+			{
+				if (written >= *count)
+					return; // Array is full, so just return the truncated count
+				out_variables[written] = { reinterpret_cast<uintptr_t>(&variable) };
+			}
+			written++;
 		}
 
 		if (effect_name != nullptr)
 			break;
 	}
 #endif
-
-	return { 0 };
+	*count = written;
 }
 
 void reshade::runtime::get_uniform_variable_type([[maybe_unused]] api::effect_uniform_variable handle, api::format *out_base_type, uint32_t *out_rows, uint32_t *out_columns, uint32_t *out_array_length) const
@@ -835,19 +870,56 @@ reshade::api::effect_technique reshade::runtime::find_technique([[maybe_unused]]
 	if (is_loading())
 		return { 0 };
 
-	for (const technique &technique : _techniques)
+	for (const effect &effect : _effects)
 	{
-		if (effect_name != nullptr && _effects[technique.effect_index].source_file.filename() != effect_name)
+		if (effect_name != nullptr && effect.source_file.filename() != effect_name)
 			continue;
 
-		if (technique.name == technique_name)
-			return { reinterpret_cast<uintptr_t>(&technique) };
+		// Look up the technique in the name index built during loading, instead of scanning the entire technique list
+		const auto it = effect.technique_index.find(technique_name);
+		if (it != effect.technique_index.end())
+			return { reinterpret_cast<uintptr_t>(&_techniques[it->second]) };
+
+		if (effect_name != nullptr)
+			break;
 	}
 #endif
 
 	return { 0 };
 }
 
+void reshade::runtime::get_techniques([[maybe_unused]] const char *effect_name, [[maybe_unused]] api::effect_technique *out_techniques, size_t *count)
+{
+	if (count == nullptr)
+		return;
+
+	size_t written = 0;
+#if RESHADE_FX
+	if (is_loading())
+	{
+		*count = 0;
+		return;
+	}
+
+	for (size_t technique_index : _technique_sorting)
+	{
+		const technique &technique = _techniques[technique_index];
+
+		if (effect_name != nullptr && _effects[technique.effect_index].source_file.filename() != effect_name)
+			continue;
+
+		if (out_techniques != nullptr)
+		{
+			if (written >= *count)
+				return; // Array is full, so just return the truncated count
+			out_techniques[written] = { reinterpret_cast<uintptr_t>(&technique) };
+		}
+		written++;
+	}
+#endif
+	*count = written;
+}
+
 void reshade::runtime::get_technique_name([[maybe_unused]] api::effect_technique handle, [[maybe_unused]] char *value, size_t *size) const
 {
 	if (size == nullptr)
@@ -1211,7 +1283,21 @@ void reshade::runtime::set_preprocessor_definition_for_effect([[maybe_unused]] c
 
 		if ((scope_mask_updated & (GLOBAL_SCOPE_FLAG | PRESET_SCOPE_FLAG)) != 0)
 		{
-			_reload_required_effects = { _effects.size() };
+			// Only schedule effects that actually queried this definition for a reload, instead of reloading everything
+			if (std::find(_reload_required_effects.cbegin(), _reload_required_effects.cend(), _effects.size()) == _reload_required_effects.cend())
+			{
+				for (size_t effect_index = 0; effect_index < _effects.size(); ++effect_index)
+				{
+					const effect &effect = _effects[effect_index];
+
+					// Effects that failed to compile may start compiling with the new definition, so reload them as well
+					if (effect.compiled && !std::binary_search(effect.used_definitions.cbegin(), effect.used_definitions.cend(), name))
+						continue;
+
+					if (std::find(_reload_required_effects.cbegin(), _reload_required_effects.cend(), effect_index) == _reload_required_effects.cend())
+						_reload_required_effects.push_back(effect_index);
+				}
+			}
 		}
 		else
 		{
@@ -1373,9 +1459,14 @@ void reshade::runtime::render_technique(api::effect_technique handle, api::comma
 		return;
 
 	// Queue effect file for initialization if it was not fully loaded yet
-	if (tech->passes_data.empty() &&
-		std::find(_reload_create_queue.cbegin(), _reload_create_queue.cend(), tech->effect_index) == _reload_create_queue.cend())
-		_reload_create_queue.push_back(tech->effect_index);
+	if (tech->passes_data.empty())
+	{
+		// Techniques are only initialized once they are enabled, so request creation explicitly since this technique should be rendered while still disabled
+		tech->create_passes_requested = true;
+
+		if (std::find(_reload_create_queue.cbegin(), _reload_create_queue.cend(), tech->effect_index) == _reload_create_queue.cend())
+			_reload_create_queue.push_back(tech->effect_index);
+	}
 
 	if (rtv == 0 || is_loading())
 		return;
@@ -1562,3 +1653,56 @@ void reshade::runtime::reload_effect_next_frame([[maybe_unused]] const char *eff
 	}
 #endif
 }
+
+uint64_t reshade::runtime::get_technique_pass_gpu_duration([[maybe_unused]] api::effect_technique handle, [[maybe_unused]] size_t pass_index) const
+{
+#if RESHADE_FX
+	const auto tech = reinterpret_cast<const technique *>(handle.handle);
+	if (tech == nullptr || pass_index >= tech->passes_data.size())
+		return 0;
+
+	return tech->passes_data[pass_index].average_gpu_duration;
+#else
+	return 0;
+#endif
+}
+
+uint64_t reshade::runtime::get_frame_duration_percentile(float percent) const
+{
+	return _frame_duration_histogram.percentile(percent);
+}
+uint64_t reshade::runtime::get_technique_gpu_duration_percentile([[maybe_unused]] api::effect_technique handle, [[maybe_unused]] float percent) const
+{
+#if RESHADE_FX
+	const auto tech = reinterpret_cast<const technique *>(handle.handle);
+	if (tech == nullptr)
+		return 0;
+
+	return tech->gpu_duration_histogram.percentile(percent);
+#else
+	return 0;
+#endif
+}
+
+uint64_t reshade::runtime::get_effect_texture_memory_usage([[maybe_unused]] const char *effect_name) const
+{
+#if RESHADE_FX
+	size_t effect_index = std::numeric_limits<size_t>::max();
+	if (effect_name != nullptr && *effect_name != '\0')
+	{
+		const auto it = std::find_if(_effects.cbegin(), _effects.cend(), [effect_name = std::string_view(effect_name)](const effect &effect) { return effect.source_file.filename().u8string() == effect_name; });
+		if (it == _effects.cend())
+			return 0;
+
+		effect_index = static_cast<size_t>(std::distance(_effects.cbegin(), it));
+	}
+
+	uint64_t memory_size = 0;
+	for (const texture &tex : _textures)
+		if (tex.resource != 0 && (effect_index == std::numeric_limits<size_t>::max() || std::find(tex.shared.cbegin(), tex.shared.cend(), effect_index) != tex.shared.cend()))
+			memory_size += tex.memory_size;
+	return memory_size;
+#else
+	return 0;
+#endif
+}
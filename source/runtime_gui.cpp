@@ -14,6 +14,7 @@
 #include "addon_manager.hpp"
 #include "input.hpp"
 #include "input_gamepad.hpp"
+#include "cpu_profiler.hpp"
 #include "imgui_widgets.hpp"
 #include "localization.hpp"
 #include "platform_utils.hpp"
@@ -25,6 +26,12 @@
 #include <cstring> // std::memcmp, std::memcpy
 #include <algorithm> // std::any_of, std::count_if, std::find, std::find_if, std::max, std::min, std::replace, std::rotate, std::search, std::swap, std::transform
 
+static void to_lower_case(std::string &text)
+{
+	std::transform(text.begin(), text.end(), text.begin(),
+		[](const char c) { return ('A' <= c && c <= 'Z') ? static_cast<char>(c + ' ') : c; });
+}
+
 static bool filter_text(const std::string_view text, const std::string_view filter)
 {
 	return filter.empty() ||
@@ -127,186 +134,191 @@ void reshade::runtime::build_font_atlas()
 {
 	ImFontAtlas *const atlas = _imgui_context->IO.Fonts;
 
-	if (atlas->IsBuilt())
+	if (atlas->IsBuilt() && _font_atlas_srv != 0)
 		return;
 
-	ImGuiContext *const backup_context = ImGui::GetCurrentContext();
-	ImGui::SetCurrentContext(_imgui_context);
+	// The rasterized glyph data is kept around after a build and acts as an in-memory cache, so that the frequent swap chain resets (e.g. on every resolution change) only have to upload the font atlas texture again, instead of rasterizing all fonts anew
+	// Changing any font setting resets 'TexReady' (and with it 'ImFontAtlas::IsBuilt'), which forces a full rebuild here
+	if (!atlas->IsBuilt())
+	{
+		ImGuiContext *const backup_context = ImGui::GetCurrentContext();
+		ImGui::SetCurrentContext(_imgui_context);
 
-	// Remove any existing fonts from atlas first
-	atlas->Clear();
+		// Remove any existing fonts from atlas first
+		atlas->Clear();
 
-	std::error_code ec;
-	const ImWchar *glyph_ranges = nullptr;
-	std::filesystem::path resolved_font_path;
+		std::error_code ec;
+		const ImWchar *glyph_ranges = nullptr;
+		std::filesystem::path resolved_font_path;
 
 #if RESHADE_LOCALIZATION
-	std::string language = _selected_language;
-	if (language.empty())
-		language = resources::get_current_language();
+		std::string language = _selected_language;
+		if (language.empty())
+			language = resources::get_current_language();
 
-	if (language.find("bg") == 0 || language.find("ru") == 0)
-	{
-		glyph_ranges = atlas->GetGlyphRangesCyrillic();
+		if (language.find("bg") == 0 || language.find("ru") == 0)
+		{
+			glyph_ranges = atlas->GetGlyphRangesCyrillic();
 
-		_default_font_path = L"C:\\Windows\\Fonts\\calibri.ttf";
-	}
-	else
-	if (language.find("ja") == 0)
-	{
-		glyph_ranges = atlas->GetGlyphRangesJapanese();
+			_default_font_path = L"C:\\Windows\\Fonts\\calibri.ttf";
+		}
+		else
+		if (language.find("ja") == 0)
+		{
+			glyph_ranges = atlas->GetGlyphRangesJapanese();
 
-		// Morisawa BIZ UDGothic Regular, available since Windows 10 October 2018 Update (1809) Build 17763.1
-		_default_font_path = L"C:\\Windows\\Fonts\\BIZ-UDGothicR.ttc";
-		if (!std::filesystem::exists(_default_font_path, ec))
-			_default_font_path = L"C:\\Windows\\Fonts\\msgothic.ttc"; // MS Gothic
-	}
-	else
-	if (language.find("ko") == 0)
-	{
-		glyph_ranges = atlas->GetGlyphRangesKorean();
+			// Morisawa BIZ UDGothic Regular, available since Windows 10 October 2018 Update (1809) Build 17763.1
+			_default_font_path = L"C:\\Windows\\Fonts\\BIZ-UDGothicR.ttc";
+			if (!std::filesystem::exists(_default_font_path, ec))
+				_default_font_path = L"C:\\Windows\\Fonts\\msgothic.ttc"; // MS Gothic
+		}
+		else
+		if (language.find("ko") == 0)
+		{
+			glyph_ranges = atlas->GetGlyphRangesKorean();
 
-		_default_font_path = L"C:\\Windows\\Fonts\\malgun.ttf"; // Malgun Gothic
-	}
-	else
-	if (language.find("zh") == 0)
-	{
-		glyph_ranges = GetGlyphRangesChineseSimplifiedGB2312();
+			_default_font_path = L"C:\\Windows\\Fonts\\malgun.ttf"; // Malgun Gothic
+		}
+		else
+		if (language.find("zh") == 0)
+		{
+			glyph_ranges = GetGlyphRangesChineseSimplifiedGB2312();
 
-		_default_font_path = L"C:\\Windows\\Fonts\\msyh.ttc"; // Microsoft YaHei
-		if (!std::filesystem::exists(_default_font_path, ec))
-			_default_font_path = L"C:\\Windows\\Fonts\\simsun.ttc"; // SimSun
-	}
-	else
+			_default_font_path = L"C:\\Windows\\Fonts\\msyh.ttc"; // Microsoft YaHei
+			if (!std::filesystem::exists(_default_font_path, ec))
+				_default_font_path = L"C:\\Windows\\Fonts\\simsun.ttc"; // SimSun
+		}
+		else
 #endif
-	{
-		glyph_ranges = atlas->GetGlyphRangesDefault();
-
-		_default_font_path.clear();
-	}
+		{
+			glyph_ranges = atlas->GetGlyphRangesDefault();
 
-	const auto add_font_from_file = [atlas](std::filesystem::path &font_path, ImFontConfig cfg, const ImWchar *glyph_ranges, std::error_code &ec) -> bool {
-		if (font_path.empty())
-			return true;
+			_default_font_path.clear();
+		}
 
-		extern bool resolve_path(std::filesystem::path &path, std::error_code &ec);
-		if (!resolve_path(font_path, ec))
-			return false;
+		const auto add_font_from_file = [atlas](std::filesystem::path &font_path, ImFontConfig cfg, const ImWchar *glyph_ranges, std::error_code &ec) -> bool {
+			if (font_path.empty())
+				return true;
 
-		if (FILE *const file = _wfsopen(font_path.c_str(), L"rb", SH_DENYNO))
-		{
-			fseek(file, 0, SEEK_END);
-			const size_t data_size = ftell(file);
-			fseek(file, 0, SEEK_SET);
+			extern bool resolve_path(std::filesystem::path &path, std::error_code &ec);
+			if (!resolve_path(font_path, ec))
+				return false;
 
-			void *data = IM_ALLOC(data_size);
-			const size_t data_size_read = fread(data, 1, data_size, file);
-			fclose(file);
-			if (data_size_read != data_size)
+			if (FILE *const file = _wfsopen(font_path.c_str(), L"rb", SH_DENYNO))
 			{
-				IM_FREE(data);
-				return false;
-			}
+				fseek(file, 0, SEEK_END);
+				const size_t data_size = ftell(file);
+				fseek(file, 0, SEEK_SET);
 
-			ImFormatString(cfg.Name, IM_ARRAYSIZE(cfg.Name), "%s, %.0fpx", font_path.stem().u8string().c_str(), cfg.SizePixels);
+				void *data = IM_ALLOC(data_size);
+				const size_t data_size_read = fread(data, 1, data_size, file);
+				fclose(file);
+				if (data_size_read != data_size)
+				{
+					IM_FREE(data);
+					return false;
+				}
 
-			return atlas->AddFontFromMemoryTTF(data, static_cast<int>(data_size), cfg.SizePixels, &cfg, glyph_ranges) != nullptr;
-		}
+				ImFormatString(cfg.Name, IM_ARRAYSIZE(cfg.Name), "%s, %.0fpx", font_path.stem().u8string().c_str(), cfg.SizePixels);
 
-		return false;
-	};
+				return atlas->AddFontFromMemoryTTF(data, static_cast<int>(data_size), cfg.SizePixels, &cfg, glyph_ranges) != nullptr;
+			}
 
-	ImFontConfig cfg;
-	cfg.GlyphOffset.y = std::floor(_font_size / 13.0f); // Not used in AddFontDefault()
-	cfg.SizePixels = static_cast<float>(_font_size);
+			return false;
+		};
+
+		ImFontConfig cfg;
+		cfg.GlyphOffset.y = std::floor(_font_size / 13.0f); // Not used in AddFontDefault()
+		cfg.SizePixels = static_cast<float>(_font_size);
 
 #if RESHADE_LOCALIZATION
-	// Add latin font
-	resolved_font_path = _latin_font_path;
-	if (!_default_font_path.empty())
-	{
-		if (!add_font_from_file(resolved_font_path, cfg, atlas->GetGlyphRangesDefault(), ec))
+		// Add latin font
+		resolved_font_path = _latin_font_path;
+		if (!_default_font_path.empty())
 		{
-			log::message(log::level::error, "Failed to load latin font from '%s' with error code %d!", resolved_font_path.u8string().c_str(), ec.value());
-			resolved_font_path.clear();
-		}
+			if (!add_font_from_file(resolved_font_path, cfg, atlas->GetGlyphRangesDefault(), ec))
+			{
+				log::message(log::level::error, "Failed to load latin font from '%s' with error code %d!", resolved_font_path.u8string().c_str(), ec.value());
+				resolved_font_path.clear();
+			}
 
-		if (resolved_font_path.empty())
-			atlas->AddFontDefault(&cfg);
+			if (resolved_font_path.empty())
+				atlas->AddFontDefault(&cfg);
 
-		cfg.MergeMode = true;
-	}
+			cfg.MergeMode = true;
+		}
 #endif
 
-	// Add main font
-	resolved_font_path = _font_path.empty() ? _default_font_path : _font_path;
-	{
-		if (!add_font_from_file(resolved_font_path, cfg, glyph_ranges, ec))
+		// Add main font
+		resolved_font_path = _font_path.empty() ? _default_font_path : _font_path;
 		{
-			log::message(log::level::error, "Failed to load font from '%s' with error code %d!", resolved_font_path.u8string().c_str(), ec.value());
-			resolved_font_path.clear();
-		}
-
-		// Use default font if custom font failed to load
-		if (resolved_font_path.empty())
-			atlas->AddFontDefault(&cfg);
+			if (!add_font_from_file(resolved_font_path, cfg, glyph_ranges, ec))
+			{
+				log::message(log::level::error, "Failed to load font from '%s' with error code %d!", resolved_font_path.u8string().c_str(), ec.value());
+				resolved_font_path.clear();
+			}
 
-		// Merge icons into main font
-		cfg.MergeMode = true;
-		cfg.PixelSnapH = true;
+			// Use default font if custom font failed to load
+			if (resolved_font_path.empty())
+				atlas->AddFontDefault(&cfg);
 
-		// This need to be static so that it doesn't fall out of scope before the atlas is built below
-		static constexpr ImWchar icon_ranges[] = { ICON_MIN_FK, ICON_MAX_FK, 0 }; // Zero-terminated list
+			// Merge icons into main font
+			cfg.MergeMode = true;
+			cfg.PixelSnapH = true;
 
-		atlas->AddFontFromMemoryCompressedBase85TTF(FONT_ICON_BUFFER_NAME_FK, cfg.SizePixels, &cfg, icon_ranges);
-	}
+			// This need to be static so that it doesn't fall out of scope before the atlas is built below
+			static constexpr ImWchar icon_ranges[] = { ICON_MIN_FK, ICON_MAX_FK, 0 }; // Zero-terminated list
 
-	// Add editor font
-	resolved_font_path = _editor_font_path.empty() ? _default_editor_font_path : _editor_font_path;
-	if (resolved_font_path != _font_path || _editor_font_size != _font_size)
-	{
-		cfg = ImFontConfig();
-		cfg.SizePixels = static_cast<float>(_editor_font_size);
+			atlas->AddFontFromMemoryCompressedBase85TTF(FONT_ICON_BUFFER_NAME_FK, cfg.SizePixels, &cfg, icon_ranges);
+		}
 
-		if (!add_font_from_file(resolved_font_path, cfg, glyph_ranges, ec))
+		// Add editor font
+		resolved_font_path = _editor_font_path.empty() ? _default_editor_font_path : _editor_font_path;
+		if (resolved_font_path != _font_path || _editor_font_size != _font_size)
 		{
-			log::message(log::level::error, "Failed to load editor font from '%s' with error code %d!", resolved_font_path.u8string().c_str(), ec.value());
-			resolved_font_path.clear();
-		}
+			cfg = ImFontConfig();
+			cfg.SizePixels = static_cast<float>(_editor_font_size);
 
-		if (resolved_font_path.empty())
-			atlas->AddFontDefault(&cfg);
-	}
+			if (!add_font_from_file(resolved_font_path, cfg, glyph_ranges, ec))
+			{
+				log::message(log::level::error, "Failed to load editor font from '%s' with error code %d!", resolved_font_path.u8string().c_str(), ec.value());
+				resolved_font_path.clear();
+			}
 
-	if (atlas->Build())
-	{
+			if (resolved_font_path.empty())
+				atlas->AddFontDefault(&cfg);
+		}
+
+		if (atlas->Build())
+		{
 #if RESHADE_VERBOSE_LOG
-		log::message(log::level::debug, "Font atlas size: %dx%d", atlas->TexWidth, atlas->TexHeight);
+			log::message(log::level::debug, "Font atlas size: %dx%d", atlas->TexWidth, atlas->TexHeight);
 #endif
-	}
-	else
-	{
-		log::message(log::level::error, "Failed to build font atlas!");
+		}
+		else
+		{
+			log::message(log::level::error, "Failed to build font atlas!");
 
-		_font_path.clear();
-		_latin_font_path.clear();
-		_editor_font_path.clear();
+			_font_path.clear();
+			_latin_font_path.clear();
+			_editor_font_path.clear();
 
-		atlas->Clear();
+			atlas->Clear();
 
-		// If unable to build font atlas due to an invalid custom font, revert to the default font
-		for (int i = 0; i < (_editor_font_size != _font_size ? 2 : 1); ++i)
-		{
-			cfg = ImFontConfig();
-			cfg.SizePixels = static_cast<float>(i == 0 ? _font_size : _editor_font_size);
+			// If unable to build font atlas due to an invalid custom font, revert to the default font
+			for (int i = 0; i < (_editor_font_size != _font_size ? 2 : 1); ++i)
+			{
+				cfg = ImFontConfig();
+				cfg.SizePixels = static_cast<float>(i == 0 ? _font_size : _editor_font_size);
 
-			atlas->AddFontDefault(&cfg);
+				atlas->AddFontDefault(&cfg);
+			}
 		}
-	}
 
-	ImGui::SetCurrentContext(backup_context);
+		ImGui::SetCurrentContext(backup_context);
 
-	_show_splash = true;
+		_show_splash = true;
+	}
 
 	int width, height;
 	unsigned char *pixels;
@@ -332,8 +344,13 @@ void reshade::runtime::build_font_atlas()
 		return;
 	}
 
-	// Texture data is now uploaded, so can free the memory
-	atlas->ClearTexData();
+	// Texture data is now uploaded, so can free the expanded RGBA copy again
+	// The single channel data is kept alive however, so that the texture can be recreated from it after a swap chain reset without rasterizing all fonts again (it is expanded back to RGBA on demand by 'ImFontAtlas::GetTexDataAsRGBA32')
+	if (atlas->TexPixelsAlpha8 != nullptr && atlas->TexPixelsRGBA32 != nullptr)
+	{
+		IM_FREE(atlas->TexPixelsRGBA32);
+		atlas->TexPixelsRGBA32 = nullptr;
+	}
 
 	if (!_device->create_resource_view(_font_atlas_tex, api::resource_usage::shader_resource, api::resource_view_desc(api::format::r8g8b8a8_unorm), &_font_atlas_srv))
 	{
@@ -827,10 +844,65 @@ void reshade::runtime::save_custom_style() const
 	}
 }
 
+bool reshade::runtime::is_gui_draw_pending() const
+{
+#if RESHADE_FX
+	if (_show_overlay || _preview_texture != 0)
+#else
+	if (_show_overlay)
+#endif
+		return true;
+
+	// The overlay may be opened in response to input this frame, in which case it has to be rendered right away
+	if (_input != nullptr && !_ignore_shortcuts && _input->is_key_pressed(_overlay_key_data, _force_shortcut_modifiers))
+		return true;
+	if (_input_gamepad != nullptr &&
+		_input_gamepad->is_button_down(input_gamepad::button_left_shoulder) &&
+		_input_gamepad->is_button_down(input_gamepad::button_right_shoulder) &&
+		_input_gamepad->is_button_pressed(input_gamepad::button_start))
+		return true;
+
+	// Keep the window visibility conditions below in sync with those in 'draw_gui' (with the overlay known to be hidden here)
+#if RESHADE_FX
+	if (_show_splash && (is_loading() || (_reload_count <= 1 && (_last_present_time - _last_reload_time) < std::chrono::seconds(5)) || (_tutorial_index == 0 && _input != nullptr)))
+		return true;
+#else
+	if (_show_splash && (_last_present_time - _last_reload_time) < std::chrono::seconds(5))
+		return true;
+#endif
+
+	if (((_show_screenshot_message || !_last_screenshot_save_successful) && (_last_present_time - _last_screenshot_time) < std::chrono::seconds(5)) || !_preset_save_successful)
+		return true;
+#if RESHADE_FX
+	if (_show_preset_transition_message && _is_in_preset_transition)
+		return true;
+#endif
+
+	if (_show_clock == 1 || _show_fps == 1 || _show_frametime == 1 || _show_preset_name == 1)
+		return true;
+	// The statistics toggle keys may also put those on screen this frame
+	if (_input != nullptr && !_ignore_shortcuts && (_input->is_key_pressed(_fps_key_data, _force_shortcut_modifiers) || _input->is_key_pressed(_frametime_key_data, _force_shortcut_modifiers)))
+		return true;
+
+#if RESHADE_ADDON
+	if (has_addon_event<addon_event::reshade_overlay>())
+		return true;
+
+	for (const addon_info &info : addon_loaded_info)
+		for (const addon_info::overlay_callback &widget : info.overlay_callbacks)
+			if (widget.title == "OSD")
+				return true;
+#endif
+
+	return false;
+}
+
 void reshade::runtime::draw_gui()
 {
 	assert(_is_initialized);
 
+	const profiling::scoped_cpu_timer profile_scope("draw_gui");
+
 	bool show_overlay = _show_overlay;
 	api::input_source show_overlay_source = api::input_source::keyboard;
 
@@ -885,24 +957,30 @@ void reshade::runtime::draw_gui()
 	const bool show_preset_name = _show_preset_name == 1 || (_show_overlay && _show_preset_name > 1);
 	bool show_statistics_window = show_clock || show_fps || show_frametime || show_preset_name;
 #if RESHADE_ADDON
+	bool show_addon_osd = false;
 	for (const addon_info &info : addon_loaded_info)
 	{
 		for (const addon_info::overlay_callback &widget : info.overlay_callbacks)
 		{
 			if (widget.title == "OSD")
 			{
-				show_statistics_window = true;
+				show_addon_osd = true;
 				break;
 			}
 		}
 	}
+	show_statistics_window |= show_addon_osd;
 #endif
 
 	_ignore_shortcuts = false;
 	_block_input_next_frame = false;
+	_gather_present_latency = false;
 #if RESHADE_FX
-	_gather_gpu_statistics = false;
+	_gather_gpu_statistics = _force_gather_gpu_statistics;
 	_effects_expanded_state &= 2;
+
+	if (_preset_audit_active)
+		update_preset_audit();
 #endif
 
 	if (!show_splash_window && !show_message_window && !show_statistics_window && !_show_overlay
@@ -935,6 +1013,29 @@ void reshade::runtime::draw_gui()
 	imgui_io.DisplaySize.y = static_cast<float>(_height);
 	imgui_io.Fonts->TexID = _font_atlas_srv.handle;
 
+	// When only the passive OSD texts are on screen, render them with a standalone draw list and skip the full ImGui frame (input event processing, window layout, rendering all widgets, ...) entirely
+	if (show_statistics_window && !_show_overlay && !show_splash_window && !show_message_window
+#if RESHADE_FX
+		&& _preview_texture == 0
+#endif
+#if RESHADE_ADDON
+		&& !show_addon_osd
+		&& !has_addon_event<addon_event::reshade_overlay>()
+#endif
+		)
+	{
+		if (_input != nullptr)
+		{
+			_input->block_mouse_input(false);
+			_input->block_keyboard_input(false);
+		}
+
+		draw_gui_osd();
+
+		ImGui::SetCurrentContext(backup_context);
+		return;
+	}
+
 	if (_input != nullptr)
 	{
 		imgui_io.MouseDrawCursor = _show_overlay && (!_should_save_screenshot || !_screenshot_save_gui);
@@ -1414,6 +1515,7 @@ void reshade::runtime::draw_gui()
 #endif
 			{ _("Settings###settings"), &runtime::draw_gui_settings },
 			{ _("Statistics###statistics"), &runtime::draw_gui_statistics },
+			{ _("Profiler###profiler"), &runtime::draw_gui_profiler },
 			{ _("Log###log"), &runtime::draw_gui_log },
 			{ _("About###about"), &runtime::draw_gui_about }
 		};
@@ -1594,8 +1696,15 @@ void reshade::runtime::draw_gui()
 	}
 
 	if (ImDrawData *const draw_data = ImGui::GetDrawData();
-		draw_data != nullptr && draw_data->CmdListsCount != 0 && draw_data->TotalVtxCount != 0)
+		draw_data != nullptr && draw_data->CmdListsCount != 0 && draw_data->TotalVtxCount != 0 &&
+		// Do not render when the state capture at the start of 'on_present' was skipped, e.g. when a window became visible only because a reload was started mid-frame after that decision was taken (it is rendered next frame instead)
+		!_skip_rendering_this_frame)
 	{
+#if RESHADE_FX
+		// Effect rendering that was recorded on a worker thread has to execute before the overlay is drawn on top of it
+		finish_deferred_effect_rendering();
+#endif
+
 		api::command_list *const cmd_list = _graphics_queue->get_immediate_command_list();
 
 		if (_back_buffer_resolved != 0)
@@ -1616,6 +1725,147 @@ void reshade::runtime::draw_gui()
 	ImGui::SetCurrentContext(backup_context);
 }
 
+void reshade::runtime::draw_gui_osd()
+{
+	ImGuiIO &imgui_io = _imgui_context->IO;
+
+	// Keep the frame rate average moving even though 'ImGui::NewFrame' is not called in this code path (this matches the calculation done there)
+	_imgui_context->FramerateSecPerFrameAccum += imgui_io.DeltaTime - _imgui_context->FramerateSecPerFrame[_imgui_context->FramerateSecPerFrameIdx];
+	_imgui_context->FramerateSecPerFrame[_imgui_context->FramerateSecPerFrameIdx] = imgui_io.DeltaTime;
+	_imgui_context->FramerateSecPerFrameIdx = (_imgui_context->FramerateSecPerFrameIdx + 1) % IM_ARRAYSIZE(_imgui_context->FramerateSecPerFrame);
+	_imgui_context->FramerateSecPerFrameCount = ImMin(_imgui_context->FramerateSecPerFrameCount + 1, IM_ARRAYSIZE(_imgui_context->FramerateSecPerFrame));
+	imgui_io.Framerate = (_imgui_context->FramerateSecPerFrameAccum > 0.0f) ? (1.0f / (_imgui_context->FramerateSecPerFrameAccum / static_cast<float>(_imgui_context->FramerateSecPerFrameCount))) : FLT_MAX;
+
+	// The overlay is not open in this code path, so only the always-on visibility setting is relevant (see 'draw_gui')
+	const bool show_clock = _show_clock == 1;
+	const bool show_fps = _show_fps == 1;
+	const bool show_frametime = _show_frametime == 1;
+
+	int line_count = 0;
+	char temp[4][512];
+	int temp_size[4];
+
+	if (show_clock)
+	{
+		const std::time_t t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+		struct tm tm; localtime_s(&tm, &t);
+
+		switch (_clock_format)
+		{
+		default:
+		case 0:
+			temp_size[line_count] = ImFormatString(temp[line_count], sizeof(temp[0]), "%02d:%02d", tm.tm_hour, tm.tm_min);
+			break;
+		case 1:
+			temp_size[line_count] = ImFormatString(temp[line_count], sizeof(temp[0]), "%02d:%02d:%02d", tm.tm_hour, tm.tm_min, tm.tm_sec);
+			break;
+		case 2:
+			temp_size[line_count] = ImFormatString(temp[line_count], sizeof(temp[0]), "%.4d-%.2d-%.2d %02d:%02d:%02d", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+			break;
+		}
+		line_count++;
+	}
+	if (show_fps)
+	{
+		temp_size[line_count] = ImFormatString(temp[line_count], sizeof(temp[0]), "%.0f fps", imgui_io.Framerate);
+		line_count++;
+	}
+	if (show_frametime)
+	{
+		temp_size[line_count] = ImFormatString(temp[line_count], sizeof(temp[0]), "%5.2f ms", 1000.0f / imgui_io.Framerate);
+		line_count++;
+	}
+#if RESHADE_FX
+	if (_show_preset_name == 1)
+	{
+		const std::string preset_name = _current_preset_path.stem().u8string();
+		temp_size[line_count] = ImFormatString(temp[line_count], sizeof(temp[0]), "%s", preset_name.c_str());
+		line_count++;
+	}
+#endif
+
+	if (line_count == 0)
+		return;
+
+	// Use the default font directly, since the font of the ImGui context is only valid within a frame
+	ImFont *const font = imgui_io.Fonts->Fonts[0];
+	const float font_size = font->FontSize * _fps_scale;
+	const float line_height = _imgui_context->Style.ItemSpacing.y + font_size;
+
+	float text_width[4];
+	// Lay the texts out the same way the auto-resized OSD window does (see the statistics window in 'draw_gui')
+	ImVec2 window_pos(5, 5);
+	ImVec2 window_size(200, _imgui_context->Style.FramePadding.y * 4.0f + _imgui_context->Style.ItemSpacing.y + line_height * line_count);
+
+	for (int i = 0; i < line_count; ++i)
+	{
+		text_width[i] = font->CalcTextSizeA(font_size, FLT_MAX, 0.0f, temp[i], temp[i] + temp_size[i]).x;
+		window_size.x = std::max(window_size.x, text_width[i] + _imgui_context->Style.WindowPadding.x * 2.0f);
+	}
+
+	if (_fps_pos % 2)
+		window_pos.x = imgui_io.DisplaySize.x - window_size.x - 5;
+	if (_fps_pos > 1)
+		window_pos.y = imgui_io.DisplaySize.y - window_size.y - 5;
+
+	ImDrawList draw_list(&_imgui_context->DrawListSharedData);
+	draw_list._ResetForNewFrame();
+	draw_list.PushClipRect(ImVec2(0, 0), imgui_io.DisplaySize);
+	draw_list.PushTextureID(imgui_io.Fonts->TexID);
+
+	const ImU32 text_col = ImGui::ColorConvertFloat4ToU32((const ImVec4 &)_fps_col);
+
+	ImVec2 text_pos(window_pos.x + _imgui_context->Style.WindowPadding.x, window_pos.y + _imgui_context->Style.WindowPadding.y);
+
+	for (int i = 0; i < line_count; ++i)
+	{
+		if (_fps_pos % 2) // Align text to the right of the window
+			text_pos.x = window_pos.x + window_size.x - _imgui_context->Style.WindowPadding.x - text_width[i];
+
+		draw_list.AddText(font, font_size, text_pos, text_col, temp[i], temp[i] + temp_size[i]);
+
+		text_pos.y += line_height;
+	}
+
+	draw_list.PopTextureID();
+	draw_list.PopClipRect();
+	draw_list._PopUnusedDrawCmd();
+
+	ImDrawData draw_data;
+	draw_data.Valid = true;
+	draw_data.DisplayPos = ImVec2(0, 0);
+	draw_data.DisplaySize = imgui_io.DisplaySize;
+	draw_data.FramebufferScale = ImVec2(1.0f, 1.0f);
+	draw_data.AddDrawList(&draw_list);
+
+	if (draw_data.CmdListsCount == 0 || draw_data.TotalVtxCount == 0)
+		return;
+	// Keep this consistent with the state capture decision taken at the start of 'on_present' (see 'draw_gui')
+	if (_skip_rendering_this_frame)
+		return;
+
+#if RESHADE_FX
+	// Effect rendering that was recorded on a worker thread has to execute before the overlay is drawn on top of it
+	finish_deferred_effect_rendering();
+#endif
+
+	api::command_list *const cmd_list = _graphics_queue->get_immediate_command_list();
+
+	if (_back_buffer_resolved != 0)
+	{
+		render_imgui_draw_data(cmd_list, &draw_data, _back_buffer_targets[0]);
+	}
+	else
+	{
+		uint32_t back_buffer_index = get_current_back_buffer_index() * 2;
+		const api::resource back_buffer_resource = _device->get_resource_from_view(_back_buffer_targets[back_buffer_index]);
+
+		cmd_list->barrier(back_buffer_resource, api::resource_usage::present, api::resource_usage::render_target);
+		render_imgui_draw_data(cmd_list, &draw_data, _back_buffer_targets[back_buffer_index]);
+		cmd_list->barrier(back_buffer_resource, api::resource_usage::render_target, api::resource_usage::present);
+	}
+}
+
 #if RESHADE_FX
 void reshade::runtime::draw_gui_home()
 {
@@ -1914,13 +2164,76 @@ void reshade::runtime::draw_gui_home()
 		{
 			_effects_expanded_state = 3;
 
+			// Transform the filter text to lower case once, so that the matching below is a plain byte search against the prebuilt search text
+			std::string filter(_effect_filter);
+			to_lower_case(filter);
+
 			for (technique &tech : _techniques)
 			{
-				std::string_view label = tech.annotation_as_string("ui_label");
-				if (label.empty())
-					label = tech.name;
+				if (tech.search_text.empty())
+				{
+					std::string_view label = tech.annotation_as_string("ui_label");
+					if (label.empty())
+						label = tech.name;
+
+					// Build the lower case search text for this technique on first use (effect reloading recreates the technique, so this does not go stale)
+					tech.search_text = std::string(label) + ' ' + _effects[tech.effect_index].source_file.filename().u8string();
+					to_lower_case(tech.search_text);
+				}
+
+				tech.hidden = tech.annotation_as_int("hidden") != 0 || tech.search_text.find(filter) == std::string::npos;
+			}
+
+			// Also pre-filter the variable editor here, so that only the search input changing re-scans the uniforms and preprocessor definitions, instead of every frame while the filter is active
+			for (reshade::effect &effect : _effects)
+			{
+				if (effect.search_text.empty())
+				{
+					effect.search_text = effect.source_file.filename().u8string();
+					to_lower_case(effect.search_text);
+				}
+
+				// A match on the effect file name keeps the entire effect section visible
+				const bool effect_visible = filter.empty() || effect.search_text.find(filter) != std::string::npos;
+				bool any_visible = effect_visible;
+
+				for (reshade::uniform &variable : effect.uniforms)
+				{
+					if (variable.search_text.empty())
+					{
+						std::string_view label = variable.annotation_as_string("ui_label");
+						if (label.empty())
+							label = variable.name;
+
+						variable.search_text = std::string(label) + ' ' + std::string(variable.annotation_as_string("ui_category"));
+						to_lower_case(variable.search_text);
+					}
+
+					variable.search_hidden = !effect_visible && variable.search_text.find(filter) == std::string::npos;
+
+					if (variable.special == special_uniform::none)
+						any_visible |= !variable.search_hidden;
+				}
 
-				tech.hidden = tech.annotation_as_int("hidden") != 0 || !(filter_text(label, _effect_filter) || filter_text(_effects[tech.effect_index].source_file.filename().u8string(), _effect_filter));
+				if (effect.definition_search_text.size() != effect.definitions.size())
+				{
+					effect.definition_search_text.resize(effect.definitions.size());
+					for (size_t definition_index = 0; definition_index < effect.definitions.size(); ++definition_index)
+					{
+						effect.definition_search_text[definition_index] = effect.definitions[definition_index].first;
+						to_lower_case(effect.definition_search_text[definition_index]);
+					}
+				}
+
+				effect.definition_search_hidden.resize(effect.definitions.size());
+				for (size_t definition_index = 0; definition_index < effect.definitions.size(); ++definition_index)
+				{
+					const bool definition_hidden = !effect_visible && effect.definition_search_text[definition_index].find(filter) == std::string::npos;
+					effect.definition_search_hidden[definition_index] = definition_hidden;
+					any_visible |= !definition_hidden;
+				}
+
+				effect.search_hidden = !any_visible;
 			}
 		}
 
@@ -2186,6 +2499,14 @@ void reshade::runtime::draw_gui_settings()
 			ImGui::Spacing();
 		}
 
+		modified |= ImGui::SliderInt(_("Frame rate limit"), reinterpret_cast<int *>(&_fps_limit), 0, 240);
+		ImGui::SetItemTooltip(_(
+			"Limit the frame rate to the specified value by delaying the return from the present call.\n"
+			"Uses a high resolution timer with a short spin wait for precise pacing.\n"
+			"Set this to zero to disable the limit."));
+
+		ImGui::Spacing();
+
 #if RESHADE_FX
 		modified |= imgui::file_input_box(_("Start-up preset"), nullptr, _startup_preset_path, _file_selection_path, { L".ini", L".txt" });
 		ImGui::SetItemTooltip(_("When not empty, reset the current preset to this file during reloads."));
@@ -2205,6 +2526,24 @@ void reshade::runtime::draw_gui_settings()
 			reload_effects(!_effect_load_skipping);
 		}
 
+		// Only Vulkan uses SPIR-V, which is the only generated code representation that can express relaxed precision
+		if (_renderer_id >= 0x20000)
+		{
+			if (ImGui::Checkbox(_("Relaxed precision math"), &_relaxed_precision))
+			{
+				modified = true;
+
+				reload_effects(); // Reload effects after switching, since this affects the generated code
+			}
+
+			ImGui::SetItemTooltip(_("Allow the driver to evaluate math on values read from textures at 16-bit precision, which can give a performance boost on some GPUs at a slight quality cost."));
+		}
+
+		modified |= ImGui::SliderFloat(_("GPU time budget"), &_effect_gpu_budget, 0.0f, 16.0f, _effect_gpu_budget > 0 ? "%.1f ms" : _("disabled"), ImGuiSliderFlags_AlwaysClamp);
+		ImGui::SetItemTooltip(_(
+			"When all enabled effects together take longer than this on the GPU, the most expensive ones are automatically run every few frames only until there is headroom again.\n"
+			"Effects run at a reduced rate flicker or appear stale, so this is a trade-off for staying below the display refresh interval. Set to zero to always run every effect each frame."));
+
 		if (ImGui::Button(_("Clear effect cache"), ImVec2(ImGui::CalcItemWidth(), 0)))
 			clear_effect_cache();
 		ImGui::SetItemTooltip(_("Clear effect cache located in \"%s\"."), _effect_cache_path.u8string().c_str());
@@ -2216,6 +2555,13 @@ void reshade::runtime::draw_gui_settings()
 		if (_input != nullptr)
 		{
 			modified |= imgui::key_input_box(_("Screenshot key"), _screenshot_key_data, *_input);
+
+			modified |= imgui::key_input_box(_("Burst capture key"), _burst_capture_key_data, *_input);
+			ImGui::SetItemTooltip(_(
+				"Records raw frames to a capture file in the screenshot path for the configured duration (or until the key is pressed again).\n"
+				"Use the burstconv tool to convert the capture file into individual images afterwards."));
+
+			modified |= ImGui::SliderInt(_("Burst capture duration"), reinterpret_cast<int *>(&_burst_capture_duration), 1, 10, _("%d seconds"), ImGuiSliderFlags_AlwaysClamp);
 		}
 
 		modified |= imgui::directory_input_box(_("Screenshot path"), _screenshot_path, _file_selection_path);
@@ -2254,7 +2600,7 @@ void reshade::runtime::draw_gui_settings()
 				"HH-mm-ss");
 		}
 
-		modified |= ImGui::Combo(_("Screenshot format"), reinterpret_cast<int *>(&_screenshot_format), "Bitmap (*.bmp)\0Portable Network Graphics (*.png)\0JPEG (*.jpeg)\0");
+		modified |= ImGui::Combo(_("Screenshot format"), reinterpret_cast<int *>(&_screenshot_format), "Bitmap (*.bmp)\0Portable Network Graphics (*.png)\0JPEG (*.jpeg)\0Portable Network Graphics, uncompressed (*.png)\0");
 
 		if (_screenshot_format == 2)
 			modified |= ImGui::SliderInt(_("JPEG quality"), reinterpret_cast<int *>(&_screenshot_jpeg_quality), 1, 100, "%d", ImGuiSliderFlags_AlwaysClamp);
@@ -2285,7 +2631,7 @@ void reshade::runtime::draw_gui_settings()
 
 		if (ImGui::IsItemHovered(ImGuiHoveredFlags_ForTooltip))
 		{
-			const std::string extension = _screenshot_format == 0 ? ".bmp" : _screenshot_format == 1 ? ".png" : ".jpg";
+			const std::string extension = _screenshot_format == 0 ? ".bmp" : _screenshot_format == 2 ? ".jpg" : ".png";
 
 			ImGui::SetTooltip(_(
 				"Macros you can add that are resolved during command execution:\n"
@@ -2579,6 +2925,120 @@ void reshade::runtime::draw_gui_settings()
 	if (modified_custom_style)
 		save_custom_style();
 }
+#if RESHADE_FX
+void reshade::runtime::start_preset_audit()
+{
+	assert(!_preset_audit_active);
+
+	_preset_audit_technique_indices.clear();
+	_preset_audit_results.clear();
+
+	for (size_t technique_index : _technique_sorting)
+	{
+		if (_techniques[technique_index].enabled)
+			_preset_audit_technique_indices.push_back(technique_index);
+	}
+
+	if (_preset_audit_technique_indices.empty())
+		return;
+
+	// Disable all techniques to begin with, they are then re-enabled one at a time in 'update_preset_audit'
+	for (size_t technique_index : _preset_audit_technique_indices)
+		disable_technique(_techniques[technique_index]);
+
+	_preset_audit_active = true;
+	_preset_audit_current = std::numeric_limits<size_t>::max();
+	_preset_audit_frames_remaining = 0;
+}
+void reshade::runtime::stop_preset_audit()
+{
+	if (!_preset_audit_active)
+		return;
+
+	// Restore all techniques that were enabled before the audit started (the technique currently being measured is already enabled, but enabling it again is harmless)
+	for (size_t technique_index : _preset_audit_technique_indices)
+	{
+		if (technique_index < _techniques.size())
+			enable_technique(_techniques[technique_index]);
+	}
+
+	_preset_audit_active = false;
+	_preset_audit_results.clear();
+}
+void reshade::runtime::update_preset_audit()
+{
+	assert(_preset_audit_active);
+
+	// Abort the audit when effects are reloaded in the middle of it, since the technique list may have changed (the preset itself was not modified, so the reload restores the previous technique state)
+	if (is_loading() ||
+		std::any_of(_preset_audit_technique_indices.cbegin(), _preset_audit_technique_indices.cend(),
+			[this](size_t technique_index) { return technique_index >= _techniques.size(); }))
+	{
+		_preset_audit_active = false;
+		_preset_audit_technique_indices.clear();
+		_preset_audit_results.clear();
+		return;
+	}
+
+	// Ensure timestamp queries keep running while the audit is in progress, even when the statistics are not visible
+	_gather_gpu_statistics = true;
+
+	if (_preset_audit_frames_remaining != 0)
+	{
+		_preset_audit_frames_remaining--;
+		return;
+	}
+
+	if (_preset_audit_current != std::numeric_limits<size_t>::max())
+	{
+		technique &tech = _techniques[_preset_audit_technique_indices[_preset_audit_current]];
+
+		_preset_audit_results.emplace_back(_preset_audit_technique_indices[_preset_audit_current], static_cast<uint64_t>(tech.average_gpu_duration));
+
+		disable_technique(tech); // This also clears the accumulated duration averages, so the next measurement starts fresh
+	}
+
+	_preset_audit_current = (_preset_audit_current == std::numeric_limits<size_t>::max()) ? 0 : _preset_audit_current + 1;
+
+	if (_preset_audit_current < _preset_audit_technique_indices.size())
+	{
+		enable_technique(_techniques[_preset_audit_technique_indices[_preset_audit_current]]);
+
+		_preset_audit_frames_remaining = static_cast<unsigned int>(_preset_audit_frame_count);
+	}
+	else
+	{
+		// All techniques were measured, so restore them and sort the report by cost
+		for (size_t technique_index : _preset_audit_technique_indices)
+			enable_technique(_techniques[technique_index]);
+
+		std::sort(_preset_audit_results.begin(), _preset_audit_results.end(),
+			[](const std::pair<size_t, uint64_t> &lhs, const std::pair<size_t, uint64_t> &rhs) { return lhs.second > rhs.second; });
+
+		_preset_audit_active = false;
+	}
+}
+bool reshade::runtime::save_preset_audit_report(const std::filesystem::path &path) const
+{
+	FILE *const file = _wfsopen(path.c_str(), L"w", SH_DENYWR);
+	if (file == nullptr)
+		return false;
+
+	fprintf(file, "technique,effect,average_gpu_duration_ms\n");
+
+	for (const std::pair<size_t, uint64_t> &result : _preset_audit_results)
+	{
+		const technique &tech = _techniques[result.first];
+
+		fprintf(file, "\"%s\",\"%s\",%.6f\n", tech.name.c_str(), _effects[tech.effect_index].source_file.filename().u8string().c_str(), result.second * 1e-6f);
+	}
+
+	fclose(file);
+
+	return true;
+}
+#endif
+
 void reshade::runtime::draw_gui_statistics()
 {
 	unsigned int gpu_digits = 1;
@@ -2604,19 +3064,28 @@ void reshade::runtime::draw_gui_statistics()
 #if RESHADE_FX
 		_gather_gpu_statistics = true;
 #endif
+		_gather_present_latency = true;
+
+		char frame_time_label[64];
+		ImFormatString(frame_time_label, std::size(frame_time_label), _("Frame time (last %.0f s)"), _frame_time_history.span() * (1.0f / 1000));
 
 		ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
-		ImGui::PlotLines("##framerate",
-			_imgui_context->FramerateSecPerFrame, static_cast<int>(std::size(_imgui_context->FramerateSecPerFrame)),
-			_imgui_context->FramerateSecPerFrameIdx,
-			nullptr,
-			_imgui_context->FramerateSecPerFrameAccum / static_cast<int>(std::size(_imgui_context->FramerateSecPerFrame)) * 0.5f,
-			_imgui_context->FramerateSecPerFrameAccum / static_cast<int>(std::size(_imgui_context->FramerateSecPerFrame)) * 1.5f,
+		ImGui::PlotLines("##frametime",
+			_frame_time_history.data(), static_cast<int>(_frame_time_history.size()),
+			static_cast<int>(_frame_time_history.offset()),
+			frame_time_label,
+			_frame_time_history.average() * 0.5f,
+			_frame_time_history.average() * 1.5f,
 			ImVec2(0, 50));
 
 		const std::time_t t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
 		struct tm tm; localtime_s(&tm, &t);
 
+		// Count frames that took at least twice as long as the median frame as stutters
+		const uint64_t frame_time_p95 = _frame_duration_histogram.percentile(95.0f);
+		const uint64_t frame_time_p99 = _frame_duration_histogram.percentile(99.0f);
+		const uint64_t stutter_count = _frame_duration_histogram.count_above(2 * _frame_duration_histogram.percentile(50.0f));
+
 		ImGui::BeginGroup();
 
 		ImGui::TextUnformatted(_("API:"));
@@ -2627,6 +3096,9 @@ void reshade::runtime::draw_gui_statistics()
 		ImGui::TextUnformatted(_("Resolution:"));
 #endif
 		ImGui::Text(_("Frame %llu:"), _frame_count + 1);
+		ImGui::TextUnformatted(_("Frame time:"));
+		ImGui::TextUnformatted(_("Stutters:"));
+		ImGui::TextUnformatted(_("Present latency:"));
 #if RESHADE_FX
 		ImGui::TextUnformatted(_("Post-Processing:"));
 #endif
@@ -2669,6 +3141,13 @@ void reshade::runtime::draw_gui_statistics()
 		ImGui::Text("%ux%u", _effect_width, _effect_height);
 #endif
 		ImGui::Text("%.2f fps", _imgui_context->IO.Framerate);
+		ImGui::Text("%*.3f ms (95%%)", gpu_digits + 4, frame_time_p95 * 1e-6f);
+		ImGui::Text(_("%llu of %llu frames"), stutter_count, _frame_duration_histogram.total_count());
+		// Time from entering the present hook until the GPU finished executing the work submitted during it (see 'update_present_latency')
+		if (const uint64_t present_latency = _present_latency_average.load(std::memory_order_relaxed); present_latency != 0)
+			ImGui::Text("%*.3f ms", gpu_digits + 4, present_latency * 1e-6f);
+		else
+			ImGui::TextUnformatted("Unknown");
 #if RESHADE_FX
 		ImGui::Text("%*.3f ms CPU", cpu_digits + 4, post_processing_time_cpu * 1e-6f);
 #endif
@@ -2688,6 +3167,9 @@ void reshade::runtime::draw_gui_statistics()
 		ImGui::Text("Format %u (%u bpc)", static_cast<unsigned int>(_effect_color_format), api::format_bit_depth(_effect_color_format));
 #endif
 		ImGui::Text("%*.3f ms", gpu_digits + 4, _last_frame_duration.count() * 1e-6f);
+		ImGui::Text("%*.3f ms (99%%)", gpu_digits + 4, frame_time_p99 * 1e-6f);
+		ImGui::NewLine();
+		ImGui::NewLine();
 #if RESHADE_FX
 		if (_gather_gpu_statistics && post_processing_time_gpu != 0)
 			ImGui::Text("%*.3f ms GPU", gpu_digits + 4, (post_processing_time_gpu * 1e-6f));
@@ -2702,6 +3184,89 @@ void reshade::runtime::draw_gui_statistics()
 		// Only need to gather GPU statistics if the statistics are actually visible
 		_gather_gpu_statistics = true;
 
+		// Append here rather than in 'on_present', since GPU timings are only gathered while these statistics are visible (the frame time weights the sample on the time axis, since the GPU duration is not itself the amount of time covered)
+		if (post_processing_time_gpu != 0)
+			_post_processing_time_history.append(post_processing_time_gpu * 1e-6f, _last_frame_duration.count() * 1e-6f);
+
+		if (_post_processing_time_history.size() != 0)
+		{
+			char gpu_time_label[64];
+			ImFormatString(gpu_time_label, std::size(gpu_time_label), _("Post-processing GPU time (last %.0f s)"), _post_processing_time_history.span() * (1.0f / 1000));
+
+			ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
+			ImGui::PlotLines("##postprocessing",
+				_post_processing_time_history.data(), static_cast<int>(_post_processing_time_history.size()),
+				static_cast<int>(_post_processing_time_history.offset()),
+				gpu_time_label,
+				0.0f,
+				_post_processing_time_history.average() * 2.0f,
+				ImVec2(0, 50));
+		}
+
+		if (_preset_audit_active)
+		{
+			char progress_label[64];
+			ImFormatString(progress_label, std::size(progress_label), _("Measuring technique %zu of %zu ..."), _preset_audit_current + 1, _preset_audit_technique_indices.size());
+
+			ImGui::ProgressBar((_preset_audit_current + 1 - (_preset_audit_frames_remaining / static_cast<float>(_preset_audit_frame_count))) / _preset_audit_technique_indices.size(), ImVec2(ImGui::GetContentRegionAvail().x - (80 * _font_size / 13), 0), progress_label);
+
+			ImGui::SameLine();
+
+			if (ImGui::Button(_("Cancel"), ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+				stop_preset_audit();
+		}
+		else
+		{
+			if (ImGui::Button(_("Audit preset performance"), ImVec2(ImGui::GetContentRegionAvail().x * 0.66666666f, 0)))
+				start_preset_audit();
+
+			ImGui::SetItemTooltip(_("Temporarily renders each enabled technique on its own for a number of frames, to measure its GPU cost in isolation, and then presents a report sorted by cost.\nThe preset is not modified by this."));
+
+			ImGui::SameLine();
+
+			ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
+			ImGui::SliderInt("##preset_audit_frame_count", &_preset_audit_frame_count, 60, 600, _("%d frames"), ImGuiSliderFlags_AlwaysClamp);
+		}
+
+		if (!_preset_audit_results.empty() && !_preset_audit_active)
+		{
+			uint64_t audit_total = 0;
+			for (const std::pair<size_t, uint64_t> &result : _preset_audit_results)
+				audit_total += result.second;
+
+			for (const std::pair<size_t, uint64_t> &result : _preset_audit_results)
+			{
+				const technique &tech = _techniques[result.first];
+
+				ImGui::Text("%*.3f ms (%4.1f%%) %s", gpu_digits + 4, result.second * 1e-6f, audit_total != 0 ? 100.0f * result.second / audit_total : 0.0f, tech.name.c_str());
+
+				// Point out techniques that dominate the preset cost, together with a cheaper alternative to disabling them where one exists
+				if (audit_total != 0 && result.second * 4 > audit_total && result.second > 500'000)
+				{
+					ImGui::SameLine();
+					ImGui::TextColored(COLOR_YELLOW, tech.render_scale >= 1.0f ? _("(try lowering its render scale or disabling it)") : _("(consider disabling it)"));
+				}
+			}
+
+			if (ImGui::Button(_("Export audit report to CSV"), ImVec2(ImGui::GetContentRegionAvail().x * 0.66666666f, 0)))
+			{
+				std::filesystem::path audit_path = _current_preset_path;
+				audit_path.replace_extension(L".audit.csv");
+
+				if (!save_preset_audit_report(audit_path))
+					log::message(log::level::error, "Failed to save preset audit report to '%s'!", audit_path.u8string().c_str());
+			}
+
+			ImGui::SetItemTooltip(_("Writes the report to a CSV file next to the current preset."));
+
+			ImGui::SameLine();
+
+			if (ImGui::Button(_("Clear"), ImVec2(ImGui::GetContentRegionAvail().x, 0)))
+				_preset_audit_results.clear();
+
+			ImGui::Spacing();
+		}
+
 		ImGui::BeginGroup();
 
 		std::vector<bool> long_technique_name(_techniques.size());
@@ -2712,7 +3277,9 @@ void reshade::runtime::draw_gui_statistics()
 			if (!tech.enabled)
 				continue;
 
-			if (tech.passes.size() > 1)
+			if (tech.budget_interval > 1)
+				ImGui::Text(_("%s (every %u frames)"), tech.name.c_str(), tech.budget_interval);
+			else if (tech.passes.size() > 1)
 				ImGui::Text("%s (%zu passes)", tech.name.c_str(), tech.passes.size());
 			else
 				ImGui::TextUnformatted(tech.name.c_str(), tech.name.c_str() + tech.name.size());
@@ -2720,6 +3287,10 @@ void reshade::runtime::draw_gui_statistics()
 			long_technique_name[technique_index] = (ImGui::GetItemRectSize().x + 10.0f) > (ImGui::GetWindowWidth() * 0.33333333f);
 			if (long_technique_name[technique_index])
 				ImGui::NewLine();
+
+			if (_gather_gpu_statistics_per_pass && tech.passes.size() > 1)
+				for (const reshade::technique::pass_data &pass_data : tech.passes_data)
+					ImGui::Text("  %s", pass_data.debug_name.c_str());
 		}
 
 		ImGui::EndGroup();
@@ -2740,6 +3311,11 @@ void reshade::runtime::draw_gui_statistics()
 				ImGui::Text("%*.3f ms CPU", cpu_digits + 4, tech.average_cpu_duration * 1e-6f);
 			else
 				ImGui::NewLine();
+
+			// Skip the rows the per-pass timings occupy in the other groups (those only have GPU timings)
+			if (_gather_gpu_statistics_per_pass && tech.passes.size() > 1)
+				for (size_t pass_index = 0; pass_index < tech.passes_data.size(); ++pass_index)
+					ImGui::NewLine();
 		}
 
 		ImGui::EndGroup();
@@ -2758,9 +3334,20 @@ void reshade::runtime::draw_gui_statistics()
 
 			// GPU timings are not available for all APIs
 			if (_gather_gpu_statistics && tech.average_gpu_duration != 0)
-				ImGui::Text("%*.3f ms GPU", gpu_digits + 4, tech.average_gpu_duration * 1e-6f);
+				ImGui::Text("%*.3f ms GPU (%.3f ms 99%%)", gpu_digits + 4, tech.average_gpu_duration * 1e-6f, tech.gpu_duration_histogram.percentile(99.0f) * 1e-6f);
 			else
 				ImGui::NewLine();
+
+			if (_gather_gpu_statistics_per_pass && tech.passes.size() > 1)
+			{
+				for (const reshade::technique::pass_data &pass_data : tech.passes_data)
+				{
+					if (_gather_gpu_statistics && pass_data.average_gpu_duration != 0)
+						ImGui::Text("%*.3f ms GPU", gpu_digits + 4, pass_data.average_gpu_duration * 1e-6f);
+					else
+						ImGui::NewLine();
+				}
+			}
 		}
 
 		ImGui::EndGroup();
@@ -2772,10 +3359,6 @@ void reshade::runtime::draw_gui_statistics()
 			"unknown",
 			"R8", "R16", "R16F", "R32I", "R32U", "R32F", "RG8", "RG16", "RG16F", "RG32F", "RGBA8", "RGBA16", "RGBA16F", "RGBA32F", "RGB10A2"
 		};
-		static constexpr uint32_t pixel_sizes[] = {
-			0,
-			1 /*R8*/, 2 /*R16*/, 2 /*R16F*/, 4 /*R32I*/, 4 /*R32U*/, 4 /*R32F*/, 2 /*RG8*/, 4 /*RG16*/, 4 /*RG16F*/, 8 /*RG32F*/, 4 /*RGBA8*/, 8 /*RGBA16*/, 8 /*RGBA16F*/, 16 /*RGBA32F*/, 4 /*RGB10A2*/
-		};
 
 		static_assert((std::size(texture_formats) - 1) == static_cast<size_t>(reshadefx::texture_format::rgb10a2));
 
@@ -2799,9 +3382,7 @@ void reshade::runtime::draw_gui_statistics()
 			ImGui::PushID(texture_index);
 			ImGui::BeginGroup();
 
-			int64_t memory_size = 0;
-			for (uint32_t level = 0, width = tex.width, height = tex.height, depth = tex.depth; level < tex.levels; ++level, width /= 2, height /= 2, depth /= 2)
-				memory_size += static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(depth) * pixel_sizes[static_cast<int>(tex.format)];
+			const int64_t memory_size = static_cast<int64_t>(tex.memory_size);
 
 			post_processing_memory_size += memory_size;
 
@@ -3007,6 +3588,33 @@ void reshade::runtime::draw_gui_statistics()
 
 		ImGui::Separator();
 
+		// Break the total down per effect, counting pooled textures towards every effect that references them, to make it easy to spot which effect is responsible for video memory pressure
+		std::vector<int64_t> effect_memory_sizes(_effects.size());
+		for (const texture &tex : _textures)
+			if (tex.resource != 0 && tex.semantic.empty())
+				for (const size_t effect_index : tex.shared)
+					effect_memory_sizes[effect_index] += static_cast<int64_t>(tex.memory_size);
+
+		for (size_t effect_index = 0; effect_index < _effects.size(); ++effect_index)
+		{
+			if (effect_memory_sizes[effect_index] == 0)
+				continue;
+
+			if (effect_memory_sizes[effect_index] >= 1024 * 1024)
+			{
+				memory_view = std::lldiv(effect_memory_sizes[effect_index], 1024 * 1024);
+				memory_view.rem /= 1000;
+				memory_size_unit = "MiB";
+			}
+			else
+			{
+				memory_view = std::lldiv(effect_memory_sizes[effect_index], 1024);
+				memory_size_unit = "KiB";
+			}
+
+			ImGui::Text("%s: %lld.%03lld %s", _effects[effect_index].source_file.filename().u8string().c_str(), memory_view.quot, memory_view.rem, memory_size_unit);
+		}
+
 		if (post_processing_memory_size >= 1024 * 1024)
 		{
 			memory_view = std::lldiv(post_processing_memory_size, 1024 * 1024);
@@ -3022,7 +3630,128 @@ void reshade::runtime::draw_gui_statistics()
 		ImGui::Text(_("Total memory usage: %lld.%03lld %s"), memory_view.quot, memory_view.rem, memory_size_unit);
 	}
 #endif
+
+#if RESHADE_ADDON
+	if (ImGui::CollapsingHeader(_("Add-ons")))
+	{
+		if (ImGui::Checkbox(_("Profile add-on events"), &addon_event_profiling) && addon_event_profiling)
+			clear_addon_event_profiles(); // Start each profiling session from a clean slate
+
+		if (addon_event_profiling)
+		{
+			ImGui::SameLine(ImGui::GetContentRegionAvail().x - 8.0f * _font_size);
+			if (ImGui::SmallButton(_("Reset")))
+				clear_addon_event_profiles();
+
+			for (const addon_info &info : addon_loaded_info)
+			{
+				bool addon_name_shown = false;
+
+				for (const std::pair<uint32_t, void *> &event_callback : info.event_callbacks)
+				{
+					uint64_t call_count = 0, total_duration = 0;
+					if (!get_addon_event_profiling(static_cast<addon_event>(event_callback.first), event_callback.second, call_count, total_duration) || call_count == 0)
+						continue;
+
+					if (!addon_name_shown)
+					{
+						ImGui::TextUnformatted(info.name.c_str(), info.name.c_str() + info.name.size());
+						addon_name_shown = true;
+					}
+
+					ImGui::Text("  %s", addon_event_to_string(static_cast<addon_event>(event_callback.first)));
+					ImGui::SameLine(ImGui::GetWindowWidth() * 0.5f);
+					ImGui::Text("%llu calls", call_count);
+					ImGui::SameLine(ImGui::GetWindowWidth() * 0.75f);
+					ImGui::Text("%8.3f ms CPU", total_duration * 1e-6f);
+				}
+			}
+		}
+	}
+#endif
 }
+void reshade::runtime::draw_gui_profiler()
+{
+	// Request scope recording for the next frame, so that the timeline keeps updating while this tab is visible
+	profiling::request_capture();
+
+	profiling::frame_snapshot frame;
+	profiling::get_last_frame(frame);
+
+	if (frame.spans.empty() || frame.end_ticks <= frame.begin_ticks || frame.ticks_per_second == 0)
+	{
+		ImGui::TextUnformatted(_("Capturing CPU timings for the next frame ..."));
+		return;
+	}
+
+	const uint64_t frame_ticks = frame.end_ticks - frame.begin_ticks;
+	const float ms_per_tick = 1000.0f / frame.ticks_per_second;
+
+	ImGui::Text(_("Frame time: %.3f ms"), frame_ticks * ms_per_tick);
+	ImGui::SetItemTooltip(_("Timeline of the last completed frame, from one present call to the next. Hover a span for details."));
+
+	ImGui::Spacing();
+
+	// Gather the threads that recorded scopes during the frame, in the order they first appear
+	std::vector<uint32_t> thread_ids;
+	for (const profiling::cpu_span &span : frame.spans)
+	{
+		if (std::find(thread_ids.cbegin(), thread_ids.cend(), span.thread_id) == thread_ids.cend())
+			thread_ids.push_back(span.thread_id);
+	}
+
+	ImDrawList *const draw_list = ImGui::GetWindowDrawList();
+	const float strip_width = ImGui::GetContentRegionAvail().x;
+	const float row_height = ImGui::GetFrameHeight();
+
+	for (const uint32_t thread_id : thread_ids)
+	{
+		uint32_t max_depth = 0;
+		for (const profiling::cpu_span &span : frame.spans)
+		{
+			if (span.thread_id == thread_id)
+				max_depth = std::max(max_depth, span.depth);
+		}
+
+		ImGui::Text(_("Thread %u:"), thread_id);
+
+		const ImVec2 strip_pos = ImGui::GetCursorScreenPos();
+		ImGui::Dummy(ImVec2(strip_width, row_height * (max_depth + 1)));
+
+		for (const profiling::cpu_span &span : frame.spans)
+		{
+			if (span.thread_id != thread_id)
+				continue;
+
+			// Clamp spans to the frame boundaries, since scopes may overlap the present call that delimits frames
+			const uint64_t begin_ticks = std::max(span.begin_ticks, frame.begin_ticks);
+			const uint64_t end_ticks = std::min(span.end_ticks, frame.end_ticks);
+
+			const ImVec2 span_min(
+				strip_pos.x + strip_width * ((begin_ticks - frame.begin_ticks) / static_cast<float>(frame_ticks)),
+				strip_pos.y + row_height * span.depth);
+			ImVec2 span_max(
+				strip_pos.x + strip_width * ((end_ticks - frame.begin_ticks) / static_cast<float>(frame_ticks)),
+				span_min.y + row_height - 1);
+			if ((span_max.x - span_min.x) < 1.0f)
+				span_max.x = span_min.x + 1.0f; // Ensure even very short spans stay visible
+
+			// Derive a stable color from the span name, so that the same phase keeps its color across frames
+			const ImU32 span_color = ImColor::HSV((ImHashStr(span.name) % 360) / 360.0f, 0.6f, 0.8f);
+
+			draw_list->AddRectFilled(span_min, span_max, span_color);
+
+			if ((span_max.x - span_min.x) > ImGui::CalcTextSize(span.name).x + 4)
+				draw_list->AddText(ImVec2(span_min.x + 2, span_min.y), IM_COL32_WHITE, span.name);
+
+			if (ImGui::IsMouseHoveringRect(span_min, span_max))
+				ImGui::SetTooltip("%s (%.3f ms)", span.name, (span.end_ticks - span.begin_ticks) * ms_per_tick);
+		}
+
+		ImGui::Spacing();
+	}
+}
+
 void reshade::runtime::draw_gui_log()
 {
 	std::error_code ec;
@@ -3462,18 +4191,19 @@ void reshade::runtime::draw_variable_editor()
 	if (_variable_editor_tabs)
 		ImGui::BeginTabBar("##variables", ImGuiTabBarFlags_TabListPopupButton | ImGuiTabBarFlags_FittingPolicyScroll);
 
-	for (size_t effect_index = 0, id = 0; effect_index < _effects.size(); ++effect_index)
+	for (size_t effect_index = 0; effect_index < _effects.size(); ++effect_index)
 	{
 		reshade::effect &effect = _effects[effect_index];
 
 		// Hide variables that are not currently used in any of the active effects
-		// Also skip showing this effect in the variable list if it doesn't have any uniform variables to show
-		if (!effect.rendering || (effect.uniforms.empty() && effect.definitions.empty()))
+		// Also skip showing this effect in the variable list if it doesn't have any uniform variables to show or nothing in it matches the current search input
+		if (!effect.rendering || effect.search_hidden || (effect.uniforms.empty() && effect.definitions.empty()))
 			continue;
 		assert(effect.compiled);
 
 		bool force_reload_effect = false;
 		const bool is_focused = _focused_effect == effect_index;
+		const float section_top = ImGui::GetCursorPosY();
 		const std::string effect_name = effect.source_file.filename().u8string();
 
 		// Create separate tab for every effect file
@@ -3491,10 +4221,21 @@ void reshade::runtime::draw_variable_editor()
 		else
 		{
 			if (is_focused || _effects_expanded_state & 1)
+			{
 				ImGui::SetNextItemOpen(is_focused || (_effects_expanded_state >> 1) != 0);
+			}
+			else if (effect.gui_section_height != 0.0f && !ImGui::IsRectVisible(ImVec2(1.0f, effect.gui_section_height)))
+			{
+				// This entire section is scrolled out of view, so skip submitting its widgets and just advance the cursor by the height it had when it was last drawn
+				ImGui::Dummy(ImVec2(0.0f, effect.gui_section_height - _imgui_context->Style.ItemSpacing.y));
+				continue;
+			}
 
 			if (!ImGui::TreeNodeEx(effect_name.c_str(), ImGuiTreeNodeFlags_DefaultOpen))
+			{
+				effect.gui_section_height = ImGui::GetCursorPosY() - section_top;
 				continue; // Skip rendering invisible items
+			}
 		}
 
 		if (is_focused)
@@ -3557,8 +4298,8 @@ void reshade::runtime::draw_variable_editor()
 		{
 			reshade::uniform &variable = effect.uniforms[variable_index];
 
-			// Skip hidden and special variables
-			if (variable.annotation_as_int("hidden") || variable.special != special_uniform::none)
+			// Skip hidden and special variables, as well as those filtered out by the search input
+			if (variable.search_hidden || variable.annotation_as_int("hidden") || variable.special != special_uniform::none)
 			{
 				if (variable.special == special_uniform::overlay_active)
 					active_variable_index = variable_index;
@@ -3640,7 +4381,8 @@ void reshade::runtime::draw_variable_editor()
 			bool modified = false;
 			bool is_default_value = true;
 
-			ImGui::PushID(static_cast<int>(id++));
+			// The widget ID is scoped to the tree node or tab of the effect this variable belongs to, so the index is enough to make it unique and in contrast to a running counter stays stable when other sections are skipped
+			ImGui::PushID(static_cast<int>(variable_index));
 
 			reshadefx::constant value;
 			switch (variable.type.base)
@@ -3868,7 +4610,8 @@ void reshade::runtime::draw_variable_editor()
 		std::vector<std::pair<std::string, std::string>> &effect_definitions = _preset_preprocessor_definitions[effect_name];
 		std::vector<std::pair<std::string, std::string>>::iterator modified_definition;
 
-		if (!effect.definitions.empty())
+		if (!effect.definitions.empty() &&
+			(effect.definition_search_hidden.empty() || std::find(effect.definition_search_hidden.cbegin(), effect.definition_search_hidden.cend(), false) != effect.definition_search_hidden.cend()))
 		{
 			std::string category_label = _("Preprocessor definitions");
 			if (!_variable_editor_tabs)
@@ -3880,8 +4623,14 @@ void reshade::runtime::draw_variable_editor()
 
 			if (ImGui::TreeNodeEx(category_label.c_str(), ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_DefaultOpen))
 			{
-				for (const std::pair<std::string, std::string> &definition : effect.definitions)
+				for (size_t definition_index = 0; definition_index < effect.definitions.size(); ++definition_index)
 				{
+					const std::pair<std::string, std::string> &definition = effect.definitions[definition_index];
+
+					// Skip definitions filtered out by the search input
+					if (definition_index < effect.definition_search_hidden.size() && effect.definition_search_hidden[definition_index])
+						continue;
+
 					std::vector<std::pair<std::string, std::string>> *definition_scope = nullptr;
 					std::vector<std::pair<std::string, std::string>>::iterator definition_it;
 
@@ -3958,6 +4707,9 @@ void reshade::runtime::draw_variable_editor()
 		else
 		{
 			ImGui::TreePop();
+
+			// Remember the height of this section, so that its widgets do not have to be submitted anymore once it is scrolled out of view
+			effect.gui_section_height = ImGui::GetCursorPosY() - section_top;
 		}
 
 		if (force_reload_effect)
@@ -4133,7 +4885,7 @@ void reshade::runtime::draw_technique_editor()
 					}
 				}
 
-				if (!effect.generated_code.empty() &&
+				if ((!effect.generated_code.empty() || !effect.module_cache_id.empty()) &&
 					imgui::popup_button(_("Show compiled results"), 18.0f * _font_size))
 				{
 					const bool open_generated_code = ImGui::MenuItem(_("Generated code"));
@@ -4157,16 +4909,31 @@ void reshade::runtime::draw_technique_editor()
 	size_t force_reload_effect = std::numeric_limits<size_t>::max();
 	size_t hovered_technique_index = std::numeric_limits<size_t>::max();
 
+	// Collect the list positions of all techniques that pass the filter, so that the clipper below can skip the rows that are scrolled out of view
+	std::vector<size_t> sorted_positions;
+	sorted_positions.reserve(_technique_sorting.size());
 	for (size_t index = 0; index < _technique_sorting.size(); ++index)
 	{
-		const size_t technique_index = _technique_sorting[index];
+		const reshade::technique &tech = _techniques[_technique_sorting[index]];
+
+		// Skip hidden techniques
+		if (tech.hidden || !_effects[tech.effect_index].compiled)
+			continue;
+
+		sorted_positions.push_back(index);
+	}
+
+	// All rows have the same frame height, so use a clipper to only submit widgets for the techniques that are actually visible in the scrolling region
+	ImGuiListClipper clipper;
+	clipper.Begin(static_cast<int>(sorted_positions.size()));
+	while (clipper.Step())
+	{
+		for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
 		{
+			const size_t index = sorted_positions[row];
+			const size_t technique_index = _technique_sorting[index];
 			reshade::technique &tech = _techniques[technique_index];
 
-			// Skip hidden techniques
-			if (tech.hidden || !_effects[tech.effect_index].compiled)
-				continue;
-
 			bool modified = false;
 
 			ImGui::PushID(static_cast<int>(index));
@@ -4251,6 +5018,16 @@ void reshade::runtime::draw_technique_editor()
 						_preset_is_modified = true;
 				}
 
+				ImGui::SetNextItemWidth(18.0f * _font_size);
+				ImGui::SliderFloat("##render_scale", &tech.render_scale, 0.25f, 1.0f, _("Render scale %.2fx"), ImGuiSliderFlags_AlwaysClamp);
+				if (ImGui::IsItemDeactivatedAfterEdit())
+				{
+					if (_auto_save_preset)
+						save_current_preset();
+					else
+						_preset_is_modified = true;
+				}
+
 				const bool is_not_top = index > 0;
 				const bool is_not_bottom = index < _technique_sorting.size() - 1;
 
@@ -4325,7 +5102,7 @@ void reshade::runtime::draw_technique_editor()
 					}
 				}
 
-				if (!effect.generated_code.empty() &&
+				if ((!effect.generated_code.empty() || !effect.module_cache_id.empty()) &&
 					imgui::popup_button(_("Show compiled results"), 18.0f * _font_size))
 				{
 					const bool open_generated_code = ImGui::MenuItem(_("Generated code"));
@@ -4486,9 +5263,9 @@ void reshade::runtime::open_code_editor(editor_instance &instance) const
 	if (instance.generated)
 	{
 		if (instance.entry_point_name.empty())
-			instance.editor.set_text(effect.generated_code);
+			instance.editor.set_text(get_effect_generated_code(effect));
 		else
-			instance.editor.set_text(effect.assembly_text.at(instance.entry_point_name));
+			instance.editor.set_text(get_effect_assembly_text(effect, instance.entry_point_name));
 		instance.editor.set_readonly(true);
 		return; // Errors only apply to the effect source, not generated code
 	}
@@ -4697,15 +5474,35 @@ void reshade::runtime::render_imgui_draw_data(api::command_list *cmd_list, ImDra
 	// Need to multi-buffer vertex data so not to modify data below when the previous frame is still in flight
 	const size_t buffer_index = _frame_count % std::size(_imgui_vertices);
 
-	// Create and grow vertex/index buffers if needed
-	if (_imgui_num_indices[buffer_index] < draw_data->TotalIdxCount)
+	// Free any retired buffers once the GPU has caught up with the frames that last used them
+	while (!_imgui_retired_buffers.empty() && _device->wait(_imgui_buffer_fence, _imgui_retired_buffers.front().first, 0))
 	{
-		if (_imgui_indices[buffer_index] != 0)
+		_device->destroy_resource(_imgui_retired_buffers.front().second);
+		_imgui_retired_buffers.erase(_imgui_retired_buffers.begin());
+	}
+
+	// Previous frames may still be using a buffer that has to grow, so prefer retiring it until the GPU caught up with the current frame, over stalling the entire queue here
+	const auto retire_buffer = [this](api::resource buffer) {
+		if (_imgui_buffer_fence == 0)
+			_device->create_fence(0, api::fence_flags::none, &_imgui_buffer_fence);
+
+		if (_imgui_buffer_fence != 0 && _graphics_queue->signal(_imgui_buffer_fence, ++_imgui_buffer_fence_value))
+		{
+			_imgui_retired_buffers.emplace_back(_imgui_buffer_fence_value, buffer);
+		}
+		else
 		{
 			_graphics_queue->wait_idle(); // Be safe and ensure nothing still uses this buffer
 
-			_device->destroy_resource(_imgui_indices[buffer_index]);
+			_device->destroy_resource(buffer);
 		}
+	};
+
+	// Create and grow vertex/index buffers if needed
+	if (_imgui_num_indices[buffer_index] < draw_data->TotalIdxCount)
+	{
+		if (_imgui_indices[buffer_index] != 0)
+			retire_buffer(_imgui_indices[buffer_index]);
 
 		const int new_size = draw_data->TotalIdxCount + 10000;
 		if (!_device->create_resource(api::resource_desc(new_size * sizeof(ImDrawIdx), api::memory_heap::cpu_to_gpu, api::resource_usage::index_buffer), nullptr, api::resource_usage::cpu_access, &_imgui_indices[buffer_index]))
@@ -4721,11 +5518,7 @@ void reshade::runtime::render_imgui_draw_data(api::command_list *cmd_list, ImDra
 	if (_imgui_num_vertices[buffer_index] < draw_data->TotalVtxCount)
 	{
 		if (_imgui_vertices[buffer_index] != 0)
-		{
-			_graphics_queue->wait_idle();
-
-			_device->destroy_resource(_imgui_vertices[buffer_index]);
-		}
+			retire_buffer(_imgui_vertices[buffer_index]);
 
 		const int new_size = draw_data->TotalVtxCount + 5000;
 		if (!_device->create_resource(api::resource_desc(new_size * sizeof(ImDrawVert), api::memory_heap::cpu_to_gpu, api::resource_usage::vertex_buffer), nullptr, api::resource_usage::cpu_access, &_imgui_vertices[buffer_index]))
@@ -4869,7 +5662,7 @@ void reshade::runtime::render_imgui_draw_data(api::command_list *cmd_list, ImDra
 }
 void reshade::runtime::destroy_imgui_resources()
 {
-	_imgui_context->IO.Fonts->Clear();
+	// Deliberately do not clear the font atlas here, so that the rasterized glyph data survives swap chain resets and 'build_font_atlas' only has to upload the texture again (any font setting change still triggers a full rebuild there)
 
 	_device->destroy_resource(_font_atlas_tex);
 	_font_atlas_tex = {};
@@ -4886,6 +5679,15 @@ void reshade::runtime::destroy_imgui_resources()
 		_imgui_num_vertices[i] = 0;
 	}
 
+	// The GPU has finished all work at this point, so any retired buffers can be destroyed right away
+	for (const std::pair<uint64_t, api::resource> &retired_buffer : _imgui_retired_buffers)
+		_device->destroy_resource(retired_buffer.second);
+	_imgui_retired_buffers.clear();
+
+	_device->destroy_fence(_imgui_buffer_fence);
+	_imgui_buffer_fence = {};
+	_imgui_buffer_fence_value = 0;
+
 	_device->destroy_sampler(_imgui_sampler_state);
 	_imgui_sampler_state = {};
 	_device->destroy_pipeline(_imgui_pipeline);
@@ -302,18 +302,46 @@ void reshade::runtime::draw_gui_vr()
 
 	ImGui::Render();
 
+	bool update_overlay = false;
+
 	if (ImDrawData *const draw_data = ImGui::GetDrawData();
 		draw_data != nullptr && draw_data->CmdListsCount != 0 && draw_data->TotalVtxCount != 0)
 	{
-		api::command_list *const cmd_list = _graphics_queue->get_immediate_command_list();
+		// Generate hash for the draw data, so that the overlay render pass and compositor submission can be skipped while its content does not change (this runs at the VR refresh rate of 90 Hz or more, but the overlay contents rarely change that often)
+		size_t draw_data_hash = 2166136261;
+		const auto hash_draw_data_block = [&draw_data_hash](const void *data, size_t size) {
+			for (size_t i = 0; i < size; ++i)
+				draw_data_hash = (draw_data_hash * 16777619) ^ static_cast<const uint8_t *>(data)[i];
+		};
+
+		for (int draw_list_index = 0; draw_list_index < draw_data->CmdListsCount; ++draw_list_index)
+		{
+			const ImDrawList *const draw_list = draw_data->CmdLists[draw_list_index];
+			hash_draw_data_block(draw_list->VtxBuffer.Data, draw_list->VtxBuffer.Size * sizeof(ImDrawVert));
+			hash_draw_data_block(draw_list->IdxBuffer.Data, draw_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+			hash_draw_data_block(draw_list->CmdBuffer.Data, draw_list->CmdBuffer.Size * sizeof(ImDrawCmd));
+		}
 
-		cmd_list->barrier(_vr_overlay_tex, api::resource_usage::copy_source, api::resource_usage::render_target);
-		render_imgui_draw_data(cmd_list, draw_data, _vr_overlay_target);
-		cmd_list->barrier(_vr_overlay_tex, api::resource_usage::render_target, api::resource_usage::copy_source);
+		// Refresh at a low cadence regardless, since draw commands with user callbacks can render content that is not captured by the hash
+		update_overlay = draw_data_hash != _vr_overlay_draw_data_hash || (_frame_count % 30) == 0;
+
+		if (update_overlay)
+		{
+			_vr_overlay_draw_data_hash = draw_data_hash;
+
+			api::command_list *const cmd_list = _graphics_queue->get_immediate_command_list();
+
+			cmd_list->barrier(_vr_overlay_tex, api::resource_usage::copy_source, api::resource_usage::render_target);
+			render_imgui_draw_data(cmd_list, draw_data, _vr_overlay_target);
+			cmd_list->barrier(_vr_overlay_tex, api::resource_usage::render_target, api::resource_usage::copy_source);
+		}
 	}
 
 	ImGui::SetCurrentContext(backup_context);
 
+	if (!update_overlay)
+		return; // The compositor keeps displaying the texture submitted last, so can skip the submission as well
+
 	vr::Texture_t texture;
 	texture.eColorSpace = vr::ColorSpace_Auto;
 	union
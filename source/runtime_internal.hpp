@@ -7,6 +7,7 @@
 
 #include "effect_module.hpp"
 #include "moving_average.hpp"
+#include <memory> // std::shared_ptr
 
 namespace reshade
 {
@@ -28,6 +29,7 @@ namespace reshade
 		overlay_active,
 		overlay_hovered,
 		screenshot,
+		view_count,
 		unknown
 	};
 
@@ -72,12 +74,21 @@ namespace reshade
 		size_t effect_index = std::numeric_limits<size_t>::max();
 
 		std::vector<size_t> shared;
+		// Set when the texture contents provably do not carry over between technique invocations, in which case its memory is aliased with transient textures from other effects to save memory (see <see cref="runtime::load_effect"/>)
+		bool transient = false;
 		bool loaded = false;
+		// Set while the image file for this texture is being decoded asynchronously (see <see cref="runtime::load_textures"/>)
+		bool loading = false;
+		// Format of the block-compressed DDS file backing this texture, in which case its payload is uploaded directly without decoding (see <see cref="runtime::create_texture"/>)
+		api::format compressed_format = api::format::unknown;
 
 		api::resource resource = {};
 		api::resource_view srv[2] = {};
 		api::resource_view rtv[2] = {};
 		std::vector<api::resource_view> uav;
+
+		// Size of the resource allocation in bytes, calculated from the actual resource format when it is created (see <see cref="runtime::create_texture"/>)
+		uint64_t memory_size = 0;
 	};
 
 	struct uniform final : reshadefx::uniform
@@ -127,6 +138,10 @@ namespace reshade
 		unsigned int toggle_key_data[4] = {};
 
 		special_uniform special = special_uniform::none;
+
+		// Lower case text the search box input is matched against and the result of that match, updated when the search input changes rather than every frame (see <see cref="runtime::draw_gui_home"/>)
+		bool search_hidden = false;
+		std::string search_text;
 	};
 
 	struct technique final : reshadefx::technique
@@ -165,10 +180,18 @@ namespace reshade
 		size_t effect_index = std::numeric_limits<size_t>::max();
 		unsigned int toggle_key_data[4] = {};
 
-		bool hidden = false;
+		// State checked every frame is grouped together, so that the technique walk in <see cref="runtime::render_effects"/> touches as few cache lines per technique as possible
 		bool enabled = false;
 		bool enabled_in_screenshot = true;
+		// Number of frames between invocations of this technique, which is increased by the GPU budget scheduler for expensive techniques when the configured budget is exceeded (see <see cref="runtime::update_effect_gpu_budget"/>)
+		uint32_t budget_interval = 1;
 		int64_t time_left = 0;
+		// Resolution scale applied to passes of this technique that render to the back buffer, which are redirected into a scaled intermediate and composited back through an upscale afterwards (see <see cref="runtime::render_technique"/>)
+		float render_scale = 1.0f;
+
+		bool hidden = false;
+		// Lower case text the search box input is matched against, built once on first use instead of re-transforming the technique label on every search (see <see cref="runtime::draw_gui_home"/>)
+		std::string search_text;
 
 		struct pass_data
 		{
@@ -178,14 +201,53 @@ namespace reshade
 			api::descriptor_table storage_table = {};
 			std::vector<api::resource> modified_resources;
 			std::vector<api::resource_view> generate_mipmap_views;
+
+			// Static render state that is pre-built once during technique initialization and replayed every frame, instead of being recomputed (see <see cref="runtime::render_technique"/>)
+			api::render_pass_render_target_desc render_pass_targets[8] = {};
+			uint32_t render_pass_target_count = 0;
+			api::viewport viewport = {};
+			api::rect scissor_rect = {};
+			std::string debug_name;
+
+			// Only updated when per-pass timestamp queries are enabled (see <see cref="runtime::render_technique"/>)
+			moving_average<uint64_t, 60> average_gpu_duration;
 		};
 
 		std::vector<pass_data> passes_data;
+		// Set to request pipeline creation for this technique even while it is disabled (techniques are otherwise only initialized once they are enabled, see <see cref="runtime::create_effect"/>)
+		bool create_passes_requested = false;
+		// Index of the begin/end timestamp query pair of this technique in the pooled effect query heap (see <see cref="runtime::render_technique"/>)
 		uint32_t query_base_index = 0;
+		// Index of the first per-pass query pair of this technique, which are laid out behind the technique pairs of the effect (see <see cref="runtime::render_technique"/>)
+		uint32_t pass_query_base_index = 0;
 		moving_average<uint64_t, 60> average_cpu_duration;
 		moving_average<uint64_t, 60> average_gpu_duration;
+		// Distribution of the same GPU duration samples, to additionally extract tail percentiles (see <see cref="runtime::render_technique"/>)
+		duration_histogram<uint64_t, 64> gpu_duration_histogram;
 	};
 
+	// Hot per-frame state of a uniform variable with a special source annotation, with all annotation parameters resolved up front, so that the update every frame does not have to drag the cold uniform metadata like names and annotation lists through the cache (see <see cref="runtime::update_special_uniform_variables"/>)
+	struct special_uniform_data
+	{
+		special_uniform special = special_uniform::none;
+		// Index of the corresponding entry in <see cref="effect::uniforms"/>
+		size_t uniform_index = 0;
+
+		// Pre-resolved "keycode", "mode"/"toggle", "min"/"max", "step" and "smoothing" annotation values of those special types that consult them
+		int keycode = 0;
+		bool toggle = false;
+		bool press = false;
+		int min_int = 0;
+		int max_int = 0;
+		float min = 0.0f;
+		float max = 0.0f;
+		float step[2] = {};
+		float smoothing = 0.0f;
+	};
+
+	// Uniform value block shared between all runtime instances in this process that loaded the same preset and effect (see <see cref="runtime::update_shared_uniform_variables"/>)
+	struct shared_uniform_block;
+
 	struct effect
 	{
 		unsigned int rendering = 0;
@@ -199,14 +261,49 @@ namespace reshade
 		std::filesystem::path source_file;
 		std::vector<std::filesystem::path> included_files;
 		std::vector<std::pair<std::string, std::string>> definitions;
+		// Sorted list of all preprocessor definition names this effect queried during preprocessing, used to selectively reload effects when a definition changes
+		std::vector<std::string> used_definitions;
 		std::string generated_code;
+		// Effect cache entry ID of the serialized module, used to restore <see cref="generated_code"/> on demand after it was released following pipeline creation (see <see cref="runtime::get_effect_generated_code"/>)
+		std::string module_cache_id;
 		std::unordered_map<std::string, std::string> assembly;
 		std::unordered_map<std::string, std::string> assembly_text;
+		// Effect cache entry IDs of the compiled shader blobs and their disassembly texts, which are released after pipeline creation and loaded back from the cache on demand (see <see cref="runtime::create_effect"/> and <see cref="runtime::get_effect_assembly_text"/>)
+		std::unordered_map<std::string, std::string> assembly_cache_ids;
+		// Generated code of entry points that were not compiled during loading because no enabled technique referenced them, compiled on demand when a technique using them is enabled (see <see cref="runtime::compile_effect_entry_point"/>)
+		std::unordered_map<std::string, std::string> deferred_entry_point_code;
+		// Code generation state kept around for compiling those deferred entry points after loading finished
+		std::string code_preamble;
+		bool skip_optimization = false;
 
 		std::vector<uniform> uniforms;
+		// Hot data of all entries in <see cref="uniforms"/> with a special source annotation, so that the per-frame update does not have to scan the entire uniform list or its annotations (see <see cref="runtime::update_effects"/>)
+		std::vector<special_uniform_data> special_uniforms;
+		// Index of each entry in <see cref="uniforms"/> by name, built during loading, so that addon lookups do not have to scan the entire uniform list (see <see cref="runtime::find_uniform_variable"/>)
+		std::unordered_map<std::string, size_t> uniform_index;
+		// Index of each technique belonging to this effect in <see cref="runtime::_techniques"/> by name, maintained alongside that list (see <see cref="runtime::find_technique"/>)
+		std::unordered_map<std::string, size_t> technique_index;
+		// Default and currently applied value of each specialization constant in <see cref="module"/> in performance mode, used to only reload effects whose values a preset switch actually changed (see <see cref="runtime::load_current_preset"/>)
+		std::vector<std::pair<reshadefx::constant, reshadefx::constant>> spec_constant_values;
 		std::vector<uint8_t> uniform_data_storage;
+		// Byte range of <see cref="uniform_data_storage"/> that was modified since the last upload to the constant buffer, so that only that range has to be written again (see <see cref="runtime::render_technique"/>)
+		size_t uniform_data_dirty_begin = 0;
+		size_t uniform_data_dirty_end = std::numeric_limits<size_t>::max();
+		// Uniform value block shared with other runtime instances, together with the generation of that block this runtime last observed, so that change detection is a single counter comparison (see <see cref="runtime::update_shared_uniform_variables"/>)
+		std::shared_ptr<shared_uniform_block> shared_uniforms;
+		uint64_t shared_uniform_generation = 0;
+		// Height of this effect's section in the variable editor as of the last frame it was drawn, used to skip submitting its widgets entirely while the section is scrolled out of view (see <see cref="runtime::draw_variable_editor"/>)
+		float gui_section_height = 0.0f;
+		// Lower case search text of the effect file name and of each entry in <see cref="definitions"/>, built on first search after a reload, together with the visibility the last search input produced (see <see cref="runtime::draw_gui_home"/> and <see cref="runtime::draw_variable_editor"/>)
+		std::string search_text;
+		std::vector<std::string> definition_search_text;
+		bool search_hidden = false;
+		std::vector<bool> definition_search_hidden;
+
+		// Range of begin/end timestamp query pairs allocated to this effect in the pooled query heap (see <see cref="runtime::allocate_effect_query_pairs"/>)
+		uint32_t query_base = 0;
+		uint32_t query_count = 0;
 
-		api::query_heap query_heap = {};
 		api::resource cb = {};
 		api::pipeline_layout layout = {};
 
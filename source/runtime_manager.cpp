@@ -13,13 +13,18 @@
 static std::shared_mutex s_runtime_config_names_mutex;
 static std::unordered_set<std::string> s_runtime_config_names;
 
-void reshade::create_effect_runtime(api::swapchain *swapchain, api::command_queue *graphics_queue, bool is_vr)
+// Lightweight state stored for swapchains in place of a full effect runtime until they proved to be actual presentation swapchains (see 'reshade::create_effect_runtime')
+struct __declspec(uuid("0929ebe2-1e79-4d2b-aa40-0be9cfbae3ba")) deferred_runtime_state
 {
-	if (graphics_queue == nullptr || &swapchain->get_private_data<reshade::runtime>() != nullptr)
-		return;
-
-	assert((graphics_queue->get_type() & api::command_queue_type::graphics) != 0);
+	reshade::api::command_queue *graphics_queue = nullptr;
+	bool is_vr = false;
+	// Set when 'reshade::init_effect_runtime' was called for the swapchain, so that a subsequent present may trigger the actual runtime creation
+	bool init_requested = false;
+	bool presented_before = false;
+};
 
+static void create_effect_runtime_now(reshade::api::swapchain *swapchain, reshade::api::command_queue *graphics_queue, bool is_vr)
+{
 	// Try to find a unique configuration name for this effect runtime instance
 	std::string config_name = "ReShade";
 	if (is_vr)
@@ -42,6 +47,21 @@ void reshade::create_effect_runtime(api::swapchain *swapchain, api::command_queu
 
 	swapchain->create_private_data<reshade::runtime>(swapchain, graphics_queue, config.path(), is_vr);
 }
+
+void reshade::create_effect_runtime(api::swapchain *swapchain, api::command_queue *graphics_queue, bool is_vr)
+{
+	if (graphics_queue == nullptr ||
+		&swapchain->get_private_data<reshade::runtime>() != nullptr ||
+		&swapchain->get_private_data<deferred_runtime_state>() != nullptr)
+		return;
+
+	assert((graphics_queue->get_type() & api::command_queue_type::graphics) != 0);
+
+	// Defer the expensive runtime creation (configuration load, GUI and font atlas setup, effect loading) until the swapchain has actually presented more than once, since some launchers and video players rapidly create and destroy utility or offscreen swapchains that never present
+	deferred_runtime_state &state = swapchain->create_private_data<deferred_runtime_state>();
+	state.graphics_queue = graphics_queue;
+	state.is_vr = is_vr;
+}
 void reshade::destroy_effect_runtime(api::swapchain *swapchain)
 {
 	if (const auto runtime = &swapchain->get_private_data<reshade::runtime>())
@@ -53,20 +73,53 @@ void reshade::destroy_effect_runtime(api::swapchain *swapchain)
 	}
 
 	swapchain->destroy_private_data<reshade::runtime>();
+	swapchain->destroy_private_data<deferred_runtime_state>();
 }
 
 void reshade::init_effect_runtime(api::swapchain *swapchain)
 {
 	if (const auto runtime = &swapchain->get_private_data<reshade::runtime>())
 		runtime->on_init();
+	else if (const auto state = &swapchain->get_private_data<deferred_runtime_state>())
+		state->init_requested = true;
 }
 void reshade::reset_effect_runtime(api::swapchain *swapchain)
 {
 	if (const auto runtime = &swapchain->get_private_data<reshade::runtime>())
 		runtime->on_reset();
+	else if (const auto state = &swapchain->get_private_data<deferred_runtime_state>())
+		state->init_requested = false;
 }
 void reshade::present_effect_runtime(api::swapchain *swapchain, reshade::api::command_queue *present_queue)
 {
 	if (const auto runtime = &swapchain->get_private_data<reshade::runtime>())
+	{
 		runtime->on_present(present_queue);
+		return;
+	}
+
+	const auto state = &swapchain->get_private_data<deferred_runtime_state>();
+	if (state == nullptr || !state->init_requested)
+		return;
+
+	// Only create the full runtime once the swapchain persisted for more than a frame
+	if (!state->presented_before)
+	{
+		state->presented_before = true;
+		return;
+	}
+
+	api::command_queue *const graphics_queue = state->graphics_queue;
+	const bool is_vr = state->is_vr;
+
+	// Destroy the deferred state before creating the runtime, so that subsequent presents take the fast path above
+	swapchain->destroy_private_data<deferred_runtime_state>();
+
+	create_effect_runtime_now(swapchain, graphics_queue, is_vr);
+
+	if (const auto runtime = &swapchain->get_private_data<reshade::runtime>())
+	{
+		runtime->on_init();
+		runtime->on_present(present_queue);
+	}
 }
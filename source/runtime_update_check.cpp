@@ -4,6 +4,9 @@
  */
 
 #include "runtime.hpp"
+#include "ini_file.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
 #include <Windows.h>
 #include <WinInet.h>
 
@@ -23,39 +26,73 @@ unsigned int reshade::runtime::s_latest_version[3] = {};
 void reshade::runtime::check_for_update()
 {
 #if defined(NDEBUG) && !defined(RESHADE_TEST_APPLICATION)
-	if (s_latest_version[0] != 0)
+	// Only start a single update check per process
+	static std::atomic<bool> s_update_check_started = false;
+	if (s_update_check_started.exchange(true))
 		return;
 
-	const scoped_internet_handle handle = InternetOpen(TEXT("reshade"), INTERNET_OPEN_TYPE_PRECONFIG, nullptr, nullptr, 0);
-	if (handle == nullptr)
-		return;
+	const long long current_time = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
 
-	constexpr auto api_url = TEXT("https://api.github.com/repos/crosire/reshade/tags");
+	// Use the result of a recent previous update check instead of hitting the network again, so that machines without Internet access are not delayed by connection attempts on every startup
+	if (long long last_check_time = 0;
+		global_config().get("UPDATE", "LastCheckTime", last_check_time) && current_time >= last_check_time && current_time < last_check_time + 24 * 60 * 60)
+	{
+		unsigned int cached_version[3] = {};
+		global_config().get("UPDATE", "LatestVersion", cached_version);
 
-	const scoped_internet_handle request = InternetOpenUrl(handle, api_url, nullptr, 0, INTERNET_FLAG_RELOAD | INTERNET_FLAG_PRAGMA_NOCACHE | INTERNET_FLAG_NO_CACHE_WRITE, 0);
-	if (request == nullptr)
+		// Store the major version last, since the overlay only shows the update notification once it is non-zero
+		s_latest_version[1] = cached_version[1];
+		s_latest_version[2] = cached_version[2];
+		std::atomic_thread_fence(std::memory_order_release);
+		s_latest_version[0] = cached_version[0];
 		return;
+	}
 
-	// Set some timeouts to avoid stalling startup because of a broken Internet connection
-	DWORD timeout = 2000; // 2 seconds
-	InternetSetOption(request, INTERNET_OPTION_CONNECT_TIMEOUT, &timeout, sizeof(timeout));
-	InternetSetOption(request, INTERNET_OPTION_RECEIVE_TIMEOUT, &timeout, sizeof(timeout));
+	// Run the update check on a worker thread, since the network request can block for multiple seconds on a broken Internet connection, which would otherwise stall the first swapchain creation of the application
+	static thread_pool::job_group s_update_check_group;
+	get_thread_pool().enqueue(s_update_check_group, [current_time]() {
+		// Skip the connection attempt entirely when this machine does not currently have an Internet connection (the check is retried on the next startup, since the last check time is only updated on success)
+		if (DWORD connection_flags = 0;
+			!InternetGetConnectedState(&connection_flags, 0))
+			return;
 
-	char response_data[32];
-	if (DWORD len = 0; InternetReadFile(request, response_data, sizeof(response_data) - 1, &len) && len > 0)
-	{
-		response_data[len] = '\0';
-
-		const char *version_major_offset = std::strchr(response_data, 'v');
-		if (version_major_offset == nullptr) return; else version_major_offset++;
-		const char *version_minor_offset = std::strchr(version_major_offset, '.');
-		if (version_minor_offset == nullptr) return; else version_minor_offset++;
-		const char *version_revision_offset = std::strchr(version_minor_offset, '.');
-		if (version_revision_offset == nullptr) return; else version_revision_offset++;
-
-		s_latest_version[0] = static_cast<unsigned int>(std::strtoul(version_major_offset, nullptr, 10));
-		s_latest_version[1] = static_cast<unsigned int>(std::strtoul(version_minor_offset, nullptr, 10));
-		s_latest_version[2] = static_cast<unsigned int>(std::strtoul(version_revision_offset, nullptr, 10));
-	}
+		const scoped_internet_handle handle = InternetOpen(TEXT("reshade"), INTERNET_OPEN_TYPE_PRECONFIG, nullptr, nullptr, 0);
+		if (handle == nullptr)
+			return;
+
+		constexpr auto api_url = TEXT("https://api.github.com/repos/crosire/reshade/tags");
+
+		const scoped_internet_handle request = InternetOpenUrl(handle, api_url, nullptr, 0, INTERNET_FLAG_RELOAD | INTERNET_FLAG_PRAGMA_NOCACHE | INTERNET_FLAG_NO_CACHE_WRITE, 0);
+		if (request == nullptr)
+			return;
+
+		// Set some timeouts to avoid stalling startup because of a broken Internet connection
+		DWORD timeout = 2000; // 2 seconds
+		InternetSetOption(request, INTERNET_OPTION_CONNECT_TIMEOUT, &timeout, sizeof(timeout));
+		InternetSetOption(request, INTERNET_OPTION_RECEIVE_TIMEOUT, &timeout, sizeof(timeout));
+
+		char response_data[32];
+		if (DWORD len = 0; InternetReadFile(request, response_data, sizeof(response_data) - 1, &len) && len > 0)
+		{
+			response_data[len] = '\0';
+
+			const char *version_major_offset = std::strchr(response_data, 'v');
+			if (version_major_offset == nullptr) return; else version_major_offset++;
+			const char *version_minor_offset = std::strchr(version_major_offset, '.');
+			if (version_minor_offset == nullptr) return; else version_minor_offset++;
+			const char *version_revision_offset = std::strchr(version_minor_offset, '.');
+			if (version_revision_offset == nullptr) return; else version_revision_offset++;
+
+			// Store the major version last, since the overlay only shows the update notification once it is non-zero
+			s_latest_version[1] = static_cast<unsigned int>(std::strtoul(version_minor_offset, nullptr, 10));
+			s_latest_version[2] = static_cast<unsigned int>(std::strtoul(version_revision_offset, nullptr, 10));
+			std::atomic_thread_fence(std::memory_order_release);
+			s_latest_version[0] = static_cast<unsigned int>(std::strtoul(version_major_offset, nullptr, 10));
+
+			// Persist the result, so that startups within the next day can reuse it without hitting the network (the modified configuration is written to disk by the periodic cache flush)
+			global_config().set("UPDATE", "LastCheckTime", current_time);
+			global_config().set("UPDATE", "LatestVersion", s_latest_version);
+		}
+	});
 #endif
 }
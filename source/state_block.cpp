@@ -6,6 +6,7 @@
 #include "state_block.hpp"
 #include "d3d9/d3d9_impl_state_block.hpp"
 #include "d3d10/d3d10_impl_state_block.hpp"
+#include "d3d11/d3d11_impl_device_context.hpp"
 #include "d3d11/d3d11_impl_state_block.hpp"
 #include "opengl/opengl_impl_device.hpp"
 #include "opengl/opengl_impl_state_block.hpp"
@@ -63,6 +64,7 @@ void reshade::api::apply_state(api::command_list *cmd_list, state_block state_bl
 		break;
 	case api::device_api::d3d11:
 		reinterpret_cast<d3d11::state_block *>(state_block.handle)->apply_and_release();
+		static_cast<d3d11::device_context_impl *>(cmd_list)->enable_bound_descriptor_table_cache(false);
 		break;
 	case api::device_api::opengl:
 		reinterpret_cast<opengl::state_block *>(state_block.handle)->apply(static_cast<opengl::device_impl *>(device)->get_compatibility_context());
@@ -83,6 +85,8 @@ void reshade::api::capture_state(api::command_list *cmd_list, state_block state_
 		break;
 	case api::device_api::d3d11:
 		reinterpret_cast<d3d11::state_block *>(state_block.handle)->capture(reinterpret_cast<ID3D11DeviceContext *>(cmd_list->get_native()));
+		// The application cannot change bindings while its state is captured, so it is safe to skip redundant descriptor table binds until it is restored
+		static_cast<d3d11::device_context_impl *>(cmd_list)->enable_bound_descriptor_table_cache(true);
 		break;
 	case api::device_api::opengl:
 		reinterpret_cast<opengl::state_block *>(state_block.handle)->capture(static_cast<opengl::device_impl *>(device)->get_compatibility_context());
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2025 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "thread_pool.hpp"
+#include <cassert>
+#include <algorithm> // std::max, std::min
+
+reshade::thread_pool::thread_pool(size_t num_threads)
+{
+	assert(num_threads != 0);
+
+	_workers.resize(num_threads);
+	for (size_t worker_index = 0; worker_index < num_threads; ++worker_index)
+		_workers[worker_index] = std::make_unique<worker>();
+
+	_threads.reserve(num_threads);
+	for (size_t worker_index = 0; worker_index < num_threads; ++worker_index)
+		_threads.emplace_back(&thread_pool::run_worker, this, worker_index);
+}
+reshade::thread_pool::~thread_pool()
+{
+	{	const std::unique_lock<std::mutex> lock(_signal_mutex);
+		_exit_threads = true;
+	}
+
+	_wake_signal.notify_all();
+
+	for (std::thread &thread : _threads)
+		if (thread.joinable())
+			thread.join();
+}
+
+void reshade::thread_pool::enqueue(job_group &group, std::function<void()> job)
+{
+	group.num_pending_jobs++;
+
+	// Distribute jobs round-robin across workers, they are stolen by idle workers anyway
+	worker &target_worker = *_workers[_next_worker_index++ % _workers.size()];
+	{
+		const std::unique_lock<std::mutex> lock(target_worker.mutex);
+		target_worker.jobs.emplace_back(&group, std::move(job));
+	}
+
+	{	const std::unique_lock<std::mutex> lock(_signal_mutex);
+		_num_queued_jobs++;
+	}
+
+	_wake_signal.notify_one();
+}
+
+void reshade::thread_pool::wait(job_group &group)
+{
+	std::unique_lock<std::mutex> lock(_signal_mutex);
+	_finished_signal.wait(lock, [&group]() { return group.num_pending_jobs == 0; });
+}
+
+bool reshade::thread_pool::find_job(size_t worker_index, std::pair<job_group *, std::function<void()>> &job)
+{
+	// Prefer jobs from the worker's own queue, before stealing from the back of the queues of the other workers
+	for (size_t attempt = 0; attempt < _workers.size(); ++attempt)
+	{
+		worker &target_worker = *_workers[(worker_index + attempt) % _workers.size()];
+
+		const std::unique_lock<std::mutex> lock(target_worker.mutex);
+		if (target_worker.jobs.empty())
+			continue;
+
+		if (attempt == 0)
+		{
+			job = std::move(target_worker.jobs.front());
+			target_worker.jobs.pop_front();
+		}
+		else
+		{
+			job = std::move(target_worker.jobs.back());
+			target_worker.jobs.pop_back();
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+void reshade::thread_pool::run_worker(size_t worker_index)
+{
+	while (true)
+	{
+		std::pair<job_group *, std::function<void()>> job;
+
+		{	std::unique_lock<std::mutex> lock(_signal_mutex);
+			_wake_signal.wait(lock, [this]() { return _exit_threads || _num_queued_jobs != 0; });
+
+			if (_num_queued_jobs == 0)
+				break; // Only exit after all queued jobs were drained
+
+			lock.unlock();
+
+			if (!find_job(worker_index, job))
+				continue; // Another worker stole the job this one was woken up for
+		}
+
+		{	const std::unique_lock<std::mutex> lock(_signal_mutex);
+			_num_queued_jobs--;
+		}
+
+		job.second();
+
+		{	const std::unique_lock<std::mutex> lock(_signal_mutex);
+			job.first->num_pending_jobs--;
+		}
+
+		_finished_signal.notify_all();
+	}
+}
+
+reshade::thread_pool &reshade::get_thread_pool()
+{
+	size_t num_threads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+#ifndef _WIN64
+	// Limit number of threads in 32-bit due to the limited amount of address space being available there and effect compilation being memory hungry
+	num_threads = std::min(num_threads, static_cast<size_t>(4));
+#endif
+
+	// Intentionally leaked, so that pool threads are never joined during process shutdown while the loader lock is held
+	static thread_pool *const pool = new thread_pool(num_threads);
+	return *pool;
+}
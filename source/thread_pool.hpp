@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2025 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <functional>
+#include <condition_variable>
+
+namespace reshade
+{
+	/// <summary>
+	/// Work-stealing thread pool shared by all effect runtime instances created in this module.
+	/// </summary>
+	class thread_pool
+	{
+	public:
+		/// <summary>
+		/// Tracks completion of a batch of related jobs submitted to the pool.
+		/// </summary>
+		struct job_group
+		{
+			std::atomic<size_t> num_pending_jobs = 0;
+		};
+
+		explicit thread_pool(size_t num_threads);
+		thread_pool(const thread_pool &) = delete;
+		~thread_pool();
+
+		thread_pool &operator=(const thread_pool &) = delete;
+
+		/// <summary>
+		/// Submits a job for asynchronous execution on one of the pool threads.
+		/// </summary>
+		/// <param name="group">Group the job belongs to, which can be passed to <see cref="wait"/> to await its completion.</param>
+		/// <param name="job">Function to execute on a pool thread.</param>
+		void enqueue(job_group &group, std::function<void()> job);
+
+		/// <summary>
+		/// Blocks the calling thread until all jobs previously submitted for the specified group have finished executing.
+		/// </summary>
+		void wait(job_group &group);
+
+	private:
+		struct worker
+		{
+			std::mutex mutex;
+			std::deque<std::pair<job_group *, std::function<void()>>> jobs;
+		};
+
+		void run_worker(size_t worker_index);
+		bool find_job(size_t worker_index, std::pair<job_group *, std::function<void()>> &job);
+
+		std::vector<std::unique_ptr<worker>> _workers;
+		std::vector<std::thread> _threads;
+		std::mutex _signal_mutex;
+		std::condition_variable _wake_signal;
+		std::condition_variable _finished_signal;
+		std::atomic<size_t> _next_worker_index = 0;
+		std::atomic<size_t> _num_queued_jobs = 0;
+		bool _exit_threads = false;
+	};
+
+	/// <summary>
+	/// Gets the thread pool shared across all effect runtimes of this module, creating it on first use.
+	/// </summary>
+	thread_pool &get_thread_pool();
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2025 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "trace_events.hpp"
+
+// Provider GUID {88403128-91f5-ca5d-9a8b-e4cd82fdf018} is derived from the provider name using the standard ETW name-hashing algorithm, so that trace sessions can enable it via "*ReShade"
+TRACELOGGING_DEFINE_PROVIDER(
+	g_reshade_trace_provider,
+	"ReShade",
+	(0x88403128, 0x91f5, 0xca5d, 0x9a, 0x8b, 0xe4, 0xcd, 0x82, 0xfd, 0xf0, 0x18));
+
+void reshade::trace::register_provider()
+{
+	TraceLoggingRegister(g_reshade_trace_provider);
+}
+void reshade::trace::unregister_provider()
+{
+	TraceLoggingUnregister(g_reshade_trace_provider);
+}
+
+void reshade::trace::scoped_event::start(const char *name)
+{
+	_name = name;
+
+	TraceLoggingWrite(g_reshade_trace_provider, "span_start",
+		TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+		TraceLoggingOpcode(WINEVENT_OPCODE_START),
+		TraceLoggingString(name, "name"));
+}
+void reshade::trace::scoped_event::stop()
+{
+	TraceLoggingWrite(g_reshade_trace_provider, "span_stop",
+		TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+		TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+		TraceLoggingString(_name, "name"));
+}
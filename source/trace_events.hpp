@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2025 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <Windows.h>
+#include <TraceLoggingProvider.h>
+
+TRACELOGGING_DECLARE_PROVIDER(g_reshade_trace_provider);
+
+namespace reshade::trace
+{
+	/// <summary>
+	/// Registers the ETW TraceLogging provider, so that trace sessions (e.g. started via Windows Performance Recorder) can enable it.
+	/// </summary>
+	void register_provider();
+	/// <summary>
+	/// Unregisters the ETW TraceLogging provider again before the module is unloaded.
+	/// </summary>
+	void unregister_provider();
+
+	/// <summary>
+	/// Emits a pair of start/stop ETW events around the enclosing scope, so that external profilers can show the phase as a span aligned with other trace data.
+	/// When no trace session enabled the provider this costs no more than a single branch, so it is safe to use in per-frame code.
+	/// </summary>
+	class scoped_event
+	{
+	public:
+		explicit scoped_event(const char *name)
+		{
+			if (TraceLoggingProviderEnabled(g_reshade_trace_provider, WINEVENT_LEVEL_VERBOSE, 0))
+				start(name);
+		}
+		~scoped_event()
+		{
+			if (_name != nullptr)
+				stop();
+		}
+
+		scoped_event(const scoped_event &) = delete;
+		scoped_event &operator=(const scoped_event &) = delete;
+
+	private:
+		void start(const char *name);
+		void stop();
+
+		// Name of the phase this scope covers, which has to stay valid until the end of the scope, or 'nullptr' when the provider was not enabled at construction
+		const char *_name = nullptr;
+	};
+}
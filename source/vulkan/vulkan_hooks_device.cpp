@@ -14,7 +14,7 @@
 #include "runtime_manager.hpp"
 #include "lockfree_linear_map.hpp"
 #include <cstring> // std::strcmp, std::strncmp
-#include <algorithm> // std::fill_n, std::find_if, std::min, std::sort, std::unique
+#include <algorithm> // std::fill_n, std::find, std::find_if, std::min, std::sort, std::unique
 
 // Set during Vulkan device creation and presentation, to avoid hooking internal D3D devices created e.g. by NVIDIA Ansel and Optimus
 extern thread_local bool g_in_dxgi_runtime;
@@ -66,11 +66,17 @@ static void destroy_default_view(reshade::vulkan::device_impl *device_impl, VkIm
 	if (image == VK_NULL_HANDLE)
 		return;
 
-	const VkImageView default_view = device_impl->get_private_data_for_object<VK_OBJECT_TYPE_IMAGE>(image)->default_view;
-	if (default_view != VK_NULL_HANDLE)
+	const auto data = device_impl->get_private_data_for_object<VK_OBJECT_TYPE_IMAGE>(image);
+
+	if (data->default_view != VK_NULL_HANDLE)
 	{
-		vkDestroyImageView(device_impl->_orig, default_view, nullptr);
+		vkDestroyImageView(device_impl->_orig, data->default_view, nullptr);
 	}
+
+	// Also destroy any per-level views that were created for compute shader based mipmap generation
+	for (const VkImageView mipmap_view : data->mipmap_views)
+		vkDestroyImageView(device_impl->_orig, mipmap_view, nullptr);
+	data->mipmap_views.clear();
 }
 #endif
 
@@ -167,6 +173,8 @@ VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDevi
 	bool custom_border_color_ext = false;
 	bool extended_dynamic_state_ext = false;
 	bool conservative_rasterization_ext = false;
+	bool graphics_pipeline_library_ext = false;
+	bool host_image_copy_ext = false;
 	bool ray_tracing_ext = false;
 
 	// Check if the device is used for presenting
@@ -242,6 +250,35 @@ VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDevi
 		custom_border_color_ext = add_extension(VK_EXT_CUSTOM_BORDER_COLOR_EXTENSION_NAME, false);
 		extended_dynamic_state_ext = instance_dispatch.api_version >= VK_API_VERSION_1_3 || add_extension(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME, false);
 		conservative_rasterization_ext = add_extension(VK_EXT_CONSERVATIVE_RASTERIZATION_EXTENSION_NAME, false);
+		graphics_pipeline_library_ext =
+			add_extension(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME, false) &&
+			add_extension(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME, false);
+		host_image_copy_ext = add_extension(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME, false);
+		// Add extensions that are required by VK_EXT_host_image_copy when not targeting Vulkan 1.3
+		if (host_image_copy_ext && instance_dispatch.api_version < VK_API_VERSION_1_3)
+		{
+			host_image_copy_ext =
+				add_extension(VK_KHR_COPY_COMMANDS_2_EXTENSION_NAME, false) &&
+				add_extension(VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME, false);
+		}
+		// Host image copies are only used when images can be transitioned to the layout the rest of the implementation keeps copy destinations in (see 'device_impl::update_texture_region')
+		if (host_image_copy_ext)
+		{
+			host_image_copy_ext = false;
+
+			if (instance_dispatch.GetPhysicalDeviceProperties2 != nullptr)
+			{
+				VkPhysicalDeviceHostImageCopyPropertiesEXT host_image_copy_props { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT };
+				VkPhysicalDeviceProperties2 props { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, &host_image_copy_props };
+				instance_dispatch.GetPhysicalDeviceProperties2(physicalDevice, &props);
+
+				std::vector<VkImageLayout> copy_dst_layouts(host_image_copy_props.copyDstLayoutCount);
+				host_image_copy_props.pCopyDstLayouts = copy_dst_layouts.data();
+				instance_dispatch.GetPhysicalDeviceProperties2(physicalDevice, &props);
+
+				host_image_copy_ext = std::find(copy_dst_layouts.cbegin(), copy_dst_layouts.cend(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) != copy_dst_layouts.cend();
+			}
+		}
 		add_extension(VK_KHR_EXTERNAL_MEMORY_WIN32_EXTENSION_NAME, false);
 
 #if 0
@@ -368,6 +405,38 @@ VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDevi
 		create_info.pNext = &extended_dynamic_state_feature;
 	}
 
+	// Optionally enable graphics pipeline library feature
+	VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphics_pipeline_library_feature;
+	if (const auto existing_graphics_pipeline_library_features = find_in_structure_chain<VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>(
+			pCreateInfo->pNext, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT))
+	{
+		graphics_pipeline_library_ext = existing_graphics_pipeline_library_features->graphicsPipelineLibrary;
+	}
+	else if (graphics_pipeline_library_ext)
+	{
+		graphics_pipeline_library_feature = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT };
+		graphics_pipeline_library_feature.pNext = const_cast<void *>(create_info.pNext);
+		graphics_pipeline_library_feature.graphicsPipelineLibrary = VK_TRUE;
+
+		create_info.pNext = &graphics_pipeline_library_feature;
+	}
+
+	// Optionally enable host image copy feature
+	VkPhysicalDeviceHostImageCopyFeaturesEXT host_image_copy_feature;
+	if (const auto existing_host_image_copy_features = find_in_structure_chain<VkPhysicalDeviceHostImageCopyFeaturesEXT>(
+			pCreateInfo->pNext, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT))
+	{
+		host_image_copy_ext = host_image_copy_ext && existing_host_image_copy_features->hostImageCopy;
+	}
+	else if (host_image_copy_ext)
+	{
+		host_image_copy_feature = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT };
+		host_image_copy_feature.pNext = const_cast<void *>(create_info.pNext);
+		host_image_copy_feature.hostImageCopy = VK_TRUE;
+
+		create_info.pNext = &host_image_copy_feature;
+	}
+
 	// Optionally enable ray tracing feature
 	VkPhysicalDeviceRayTracingPipelineFeaturesKHR ray_tracing_feature;
 	VkPhysicalDeviceAccelerationStructureFeaturesKHR acceleration_structure_feature;
@@ -451,6 +520,9 @@ VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDevi
 	INIT_DISPATCH_PTR(DestroyImageView);
 	INIT_DISPATCH_PTR(CreateShaderModule);
 	INIT_DISPATCH_PTR(DestroyShaderModule);
+	INIT_DISPATCH_PTR(CreatePipelineCache);
+	INIT_DISPATCH_PTR(DestroyPipelineCache);
+	INIT_DISPATCH_PTR(GetPipelineCacheData);
 	INIT_DISPATCH_PTR(CreateGraphicsPipelines);
 	INIT_DISPATCH_PTR(CreateComputePipelines);
 	INIT_DISPATCH_PTR(DestroyPipeline);
@@ -525,6 +597,9 @@ VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDevi
 		INIT_DISPATCH_PTR(GetBufferMemoryRequirements2);
 		INIT_DISPATCH_PTR(GetImageMemoryRequirements2);
 		INIT_DISPATCH_PTR(GetDeviceQueue2);
+		INIT_DISPATCH_PTR(CreateDescriptorUpdateTemplate);
+		INIT_DISPATCH_PTR(DestroyDescriptorUpdateTemplate);
+		INIT_DISPATCH_PTR(UpdateDescriptorSetWithTemplate);
 	}
 
 	// Core 1_2
@@ -604,6 +679,11 @@ VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDevi
 	INIT_DISPATCH_PTR_ALTERNATIVE(BindBufferMemory2, KHR);
 	INIT_DISPATCH_PTR_ALTERNATIVE(BindImageMemory2, KHR);
 
+	// VK_KHR_descriptor_update_template
+	INIT_DISPATCH_PTR_ALTERNATIVE(CreateDescriptorUpdateTemplate, KHR);
+	INIT_DISPATCH_PTR_ALTERNATIVE(DestroyDescriptorUpdateTemplate, KHR);
+	INIT_DISPATCH_PTR_ALTERNATIVE(UpdateDescriptorSetWithTemplate, KHR);
+
 	// VK_KHR_draw_indirect_count
 	INIT_DISPATCH_PTR_ALTERNATIVE(CmdDrawIndirectCount, KHR);
 	INIT_DISPATCH_PTR_ALTERNATIVE(CmdDrawIndexedIndirectCount, KHR);
@@ -629,6 +709,10 @@ VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDevi
 	INIT_DISPATCH_PTR_ALTERNATIVE(CmdBlitImage2, KHR);
 	INIT_DISPATCH_PTR_ALTERNATIVE(CmdResolveImage2, KHR);
 
+	// VK_EXT_host_image_copy
+	INIT_DISPATCH_PTR(CopyMemoryToImageEXT);
+	INIT_DISPATCH_PTR(TransitionImageLayoutEXT);
+
 	// VK_EXT_transform_feedback
 	INIT_DISPATCH_PTR(CmdBindTransformFeedbackBuffersEXT);
 	INIT_DISPATCH_PTR(CmdBeginQueryIndexedEXT);
@@ -710,7 +794,9 @@ VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDevi
 		custom_border_color_ext,
 		extended_dynamic_state_ext,
 		conservative_rasterization_ext,
-		ray_tracing_ext);
+		ray_tracing_ext,
+		graphics_pipeline_library_ext,
+		host_image_copy_ext);
 
 	device_impl->_graphics_queue_family_index = graphics_queue_family_index;
 
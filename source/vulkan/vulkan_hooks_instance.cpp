@@ -150,6 +150,7 @@ VkResult VKAPI_CALL vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo, co
 
 	// Core 1_1
 	INIT_DISPATCH_PTR(GetPhysicalDeviceProperties2);
+	INIT_DISPATCH_PTR(GetPhysicalDeviceFormatProperties2);
 	INIT_DISPATCH_PTR(GetPhysicalDeviceMemoryProperties2);
 	INIT_DISPATCH_PTR(GetPhysicalDeviceExternalBufferProperties);
 	INIT_DISPATCH_PTR(GetPhysicalDeviceExternalSemaphoreProperties);
@@ -36,6 +36,94 @@ void reshade::vulkan::command_list_impl::barrier(uint32_t count, const api::reso
 	if (count == 0)
 		return;
 
+	if (!_batch_barriers)
+	{
+		submit_barriers(count, resources, old_states, new_states);
+		return;
+	}
+
+	_has_commands = true;
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (resources[i] != 0)
+		{
+			// Find the most recent pending barrier for this resource, so that transition chains are merged in order
+			size_t k = _pending_barrier_resources.size();
+			while (k != 0 && _pending_barrier_resources[k - 1] != resources[i])
+				--k;
+
+			if (k != 0)
+			{
+				const size_t pending = k - 1;
+
+				// A duplicate of an identical pending barrier has no additional effect, since no commands were recorded in between
+				if (_pending_barrier_old_states[pending] == old_states[i] && _pending_barrier_new_states[pending] == new_states[i])
+					continue;
+
+				// Barriers with identical source and destination usage exist purely for synchronization and must not take part in merging
+				const bool pending_is_special = _pending_barrier_old_states[pending] == _pending_barrier_new_states[pending];
+				const bool current_is_special = old_states[i] == new_states[i];
+
+				// Only the resulting layout of a transition chain matters when no commands were recorded in between, so the intermediate one can be elided
+				if (!pending_is_special && !current_is_special && _pending_barrier_new_states[pending] == old_states[i])
+				{
+					if (_pending_barrier_old_states[pending] == new_states[i])
+					{
+						// The chain transitions back to the original layout, which makes the barrier redundant altogether
+						_pending_barrier_resources.erase(_pending_barrier_resources.begin() + pending);
+						_pending_barrier_old_states.erase(_pending_barrier_old_states.begin() + pending);
+						_pending_barrier_new_states.erase(_pending_barrier_new_states.begin() + pending);
+					}
+					else
+					{
+						_pending_barrier_new_states[pending] = new_states[i];
+					}
+					continue;
+				}
+			}
+		}
+
+		_pending_barrier_resources.push_back(resources[i]);
+		_pending_barrier_old_states.push_back(old_states[i]);
+		_pending_barrier_new_states.push_back(new_states[i]);
+	}
+}
+void reshade::vulkan::command_list_impl::set_barrier_batching(bool enable)
+{
+	// Submit any accumulated barriers when batching is turned off
+	if (!enable)
+		flush_barriers();
+
+	_batch_barriers = enable;
+}
+void reshade::vulkan::command_list_impl::flush_barriers()
+{
+	if (_pending_barrier_resources.empty())
+		return;
+
+	submit_barriers(static_cast<uint32_t>(_pending_barrier_resources.size()), _pending_barrier_resources.data(), _pending_barrier_old_states.data(), _pending_barrier_new_states.data());
+
+	_pending_barrier_resources.clear();
+	_pending_barrier_old_states.clear();
+	_pending_barrier_new_states.clear();
+}
+bool reshade::vulkan::command_list_impl::convert_pending_barrier_to_sync(api::resource resource, api::resource_usage state)
+{
+	// Find the most recent pending barrier for this resource, like the merging in 'barrier' does
+	size_t k = _pending_barrier_resources.size();
+	while (k != 0 && _pending_barrier_resources[k - 1] != resource)
+		--k;
+
+	if (k == 0 || _pending_barrier_new_states[k - 1] != state)
+		return false;
+
+	// The resource is already in the target layout, so only the synchronization part of the barrier is still needed
+	_pending_barrier_old_states[k - 1] = state;
+	return true;
+}
+void reshade::vulkan::command_list_impl::submit_barriers(uint32_t count, const api::resource *resources, const api::resource_usage *old_states, const api::resource_usage *new_states)
+{
 	_has_commands = true;
 
 	uint32_t num_mem_barriers = 0;
@@ -100,6 +188,8 @@ void reshade::vulkan::command_list_impl::barrier(uint32_t count, const api::reso
 
 void reshade::vulkan::command_list_impl::begin_render_pass(uint32_t count, const api::render_pass_render_target_desc *rts, const api::render_pass_depth_stencil_desc *ds)
 {
+	flush_barriers();
+
 	_has_commands = true;
 	_is_in_render_pass = true;
 
@@ -628,30 +718,40 @@ void reshade::vulkan::command_list_impl::bind_stream_output_buffers(uint32_t fir
 
 void reshade::vulkan::command_list_impl::draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	vk.CmdDraw(_orig, vertex_count, instance_count, first_vertex, first_instance);
 }
 void reshade::vulkan::command_list_impl::draw_indexed(uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	vk.CmdDrawIndexed(_orig, index_count, instance_count, first_index, vertex_offset, first_instance);
 }
 void reshade::vulkan::command_list_impl::dispatch(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	vk.CmdDispatch(_orig, group_count_x, group_count_y, group_count_z);
 }
 void reshade::vulkan::command_list_impl::dispatch_mesh(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	vk.CmdDrawMeshTasksEXT(_orig, group_count_x, group_count_y, group_count_z);
 }
 void reshade::vulkan::command_list_impl::dispatch_rays(api::resource raygen, uint64_t raygen_offset, uint64_t raygen_size, api::resource miss, uint64_t miss_offset, uint64_t miss_size, uint64_t miss_stride, api::resource hit_group, uint64_t hit_group_offset, uint64_t hit_group_size, uint64_t hit_group_stride, api::resource callable, uint64_t callable_offset, uint64_t callable_size, uint64_t callable_stride, uint32_t width, uint32_t height, uint32_t depth)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	VkStridedDeviceAddressRegionKHR raygen_region;
@@ -702,6 +802,8 @@ void reshade::vulkan::command_list_impl::dispatch_rays(api::resource raygen, uin
 }
 void reshade::vulkan::command_list_impl::draw_or_dispatch_indirect(api::indirect_command type, api::resource buffer, uint64_t offset, uint32_t draw_count, uint32_t stride)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	switch (type)
@@ -755,6 +857,8 @@ void reshade::vulkan::command_list_impl::copy_resource(api::resource src, api::r
 }
 void reshade::vulkan::command_list_impl::copy_buffer_region(api::resource src, uint64_t src_offset, api::resource dst, uint64_t dst_offset, uint64_t size)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	if (UINT64_MAX == size)
@@ -769,6 +873,8 @@ void reshade::vulkan::command_list_impl::copy_buffer_region(api::resource src, u
 }
 void reshade::vulkan::command_list_impl::copy_buffer_to_texture(api::resource src, uint64_t src_offset, uint32_t row_length, uint32_t slice_height, api::resource dst, uint32_t dst_subresource, const api::subresource_box *dst_box)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	const auto dst_data = _device_impl->get_private_data_for_object<VK_OBJECT_TYPE_IMAGE>((VkImage)dst.handle);
@@ -808,6 +914,8 @@ void reshade::vulkan::command_list_impl::copy_buffer_to_texture(api::resource sr
 }
 void reshade::vulkan::command_list_impl::copy_texture_region(api::resource src, uint32_t src_subresource, const api::subresource_box *src_box, api::resource dst, uint32_t dst_subresource, const api::subresource_box *dst_box, api::filter_mode filter)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	const auto src_data = _device_impl->get_private_data_for_object<VK_OBJECT_TYPE_IMAGE>((VkImage)src.handle);
@@ -908,6 +1016,8 @@ void reshade::vulkan::command_list_impl::copy_texture_region(api::resource src,
 }
 void reshade::vulkan::command_list_impl::copy_texture_to_buffer(api::resource src, uint32_t src_subresource, const api::subresource_box *src_box, api::resource dst, uint64_t dst_offset, uint32_t row_length, uint32_t slice_height)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	const auto src_data = _device_impl->get_private_data_for_object<VK_OBJECT_TYPE_IMAGE>((VkImage)src.handle);
@@ -948,6 +1058,8 @@ void reshade::vulkan::command_list_impl::copy_texture_to_buffer(api::resource sr
 }
 void reshade::vulkan::command_list_impl::resolve_texture_region(api::resource src, uint32_t src_subresource, const api::subresource_box *src_box, api::resource dst, uint32_t dst_subresource, int32_t dst_x, int32_t dst_y, int32_t dst_z, api::format format)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	const auto src_data = _device_impl->get_private_data_for_object<VK_OBJECT_TYPE_IMAGE>((VkImage)src.handle);
@@ -1089,6 +1201,8 @@ void reshade::vulkan::command_list_impl::resolve_texture_region(api::resource sr
 
 void reshade::vulkan::command_list_impl::clear_depth_stencil_view(api::resource_view dsv, const float *depth, const uint8_t *stencil, uint32_t rect_count, const api::rect *)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(rect_count == 0);
@@ -1122,6 +1236,8 @@ void reshade::vulkan::command_list_impl::clear_depth_stencil_view(api::resource_
 }
 void reshade::vulkan::command_list_impl::clear_render_target_view(api::resource_view rtv, const float color[4], uint32_t rect_count, const api::rect *)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(rect_count == 0);
@@ -1148,6 +1264,8 @@ void reshade::vulkan::command_list_impl::clear_render_target_view(api::resource_
 }
 void reshade::vulkan::command_list_impl::clear_unordered_access_view_uint(api::resource_view uav, const uint32_t values[4], uint32_t rect_count, const api::rect *)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(rect_count == 0);
@@ -1161,6 +1279,8 @@ void reshade::vulkan::command_list_impl::clear_unordered_access_view_uint(api::r
 }
 void reshade::vulkan::command_list_impl::clear_unordered_access_view_float(api::resource_view uav, const float values[4], uint32_t rect_count, const api::rect *)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(rect_count == 0);
@@ -1175,9 +1295,115 @@ void reshade::vulkan::command_list_impl::clear_unordered_access_view_float(api::
 
 void reshade::vulkan::command_list_impl::generate_mipmaps(api::resource_view srv)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	const auto view_data = _device_impl->get_private_data_for_object<VK_OBJECT_TYPE_IMAGE_VIEW>((VkImageView)srv.handle);
+	const auto image_data = _device_impl->get_private_data_for_object<VK_OBJECT_TYPE_IMAGE>(view_data->create_info.image);
+
+	const uint32_t first_level = view_data->create_info.subresourceRange.baseMipLevel;
+	const uint32_t level_count = std::min(view_data->create_info.subresourceRange.levelCount, image_data->create_info.mipLevels - first_level);
+	if (level_count <= 1)
+		return; // There are no mipmaps to generate
+
+	// Prefer generating all mip levels with just a few compute dispatches (each downsampling up to six levels at once) over the serial per-level blit chain below
+	if (_device_impl->_mipmap_pipeline != VK_NULL_HANDLE &&
+		image_data->create_info.imageType == VK_IMAGE_TYPE_2D &&
+		(image_data->create_info.usage & (VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT)) == (VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT) &&
+		(view_data->create_info.subresourceRange.aspectMask & VK_IMAGE_ASPECT_COLOR_BIT) != 0)
+	{
+		if (const VkImageView *const chain_views = _device_impl->get_mipmap_chain_views(view_data->create_info.image))
+		{
+			const uint32_t layer_count = image_data->create_info.arrayLayers;
+
+			VkImageMemoryBarrier barrier { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = view_data->create_info.image;
+			barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, layer_count };
+
+			vk.CmdBindPipeline(_orig, VK_PIPELINE_BIND_POINT_COMPUTE, _device_impl->_mipmap_pipeline);
+
+			for (uint32_t level = first_level; level + 1 < first_level + level_count; level += 6)
+			{
+				const uint32_t num_mips = first_level + level_count - level; // Number of levels accessible to this dispatch, including the source level
+				const uint32_t target_level_count = std::min(num_mips - 1, 6u);
+
+				VkDescriptorImageInfo image_info[7];
+				image_info[0] = { VK_NULL_HANDLE, chain_views[level], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+				for (uint32_t i = 0; i < 6; ++i)
+					image_info[1 + i] = { VK_NULL_HANDLE, chain_views[level + 1 + std::min(i, target_level_count - 1)], VK_IMAGE_LAYOUT_GENERAL };
+
+				VkWriteDescriptorSet writes[2];
+				writes[0] = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+				writes[0].dstBinding = 0;
+				writes[0].descriptorCount = 1;
+				writes[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+				writes[0].pImageInfo = &image_info[0];
+				writes[1] = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+				writes[1].dstBinding = 1;
+				writes[1].descriptorCount = 6;
+				writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+				writes[1].pImageInfo = &image_info[1];
+
+				if (_device_impl->_push_descriptor_ext)
+				{
+					vk.CmdPushDescriptorSetKHR(_orig, VK_PIPELINE_BIND_POINT_COMPUTE, _device_impl->_mipmap_pipeline_layout, 0, 2, writes);
+				}
+				else
+				{
+					VkDescriptorSetAllocateInfo alloc_info { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+					alloc_info.descriptorPool = _device_impl->_transient_descriptor_pool[_device_impl->_transient_index % 4];
+					alloc_info.descriptorSetCount = 1;
+					alloc_info.pSetLayouts = &_device_impl->_mipmap_set_layout;
+
+					VkDescriptorSet set = VK_NULL_HANDLE;
+
+					// Access to descriptor pools must be externally synchronized, so lock for the duration of allocation from the transient descriptor pool
+					if (const std::unique_lock<std::shared_mutex> lock(_device_impl->_mutex);
+						vk.AllocateDescriptorSets(_device_impl->_orig, &alloc_info, &set) != VK_SUCCESS)
+					{
+						log::message(log::level::error, "Failed to allocate %u transient descriptor handle(s) of type %u!", 7u, static_cast<uint32_t>(api::descriptor_type::texture_unordered_access_view));
+						return;
+					}
+
+					writes[0].dstSet = set;
+					writes[1].dstSet = set;
+
+					vk.UpdateDescriptorSets(_device_impl->_orig, 2, writes, 0, nullptr);
+
+					vk.CmdBindDescriptorSets(_orig, VK_PIPELINE_BIND_POINT_COMPUTE, _device_impl->_mipmap_pipeline_layout, 0, 1, &set, 0, nullptr);
+				}
+
+				// Transition the target levels for storage writes (the whole subresource range is expected to be in shader read-only layout)
+				barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+				barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+				barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+				barrier.subresourceRange.baseMipLevel = level + 1;
+				barrier.subresourceRange.levelCount = target_level_count;
+				vk.CmdPipelineBarrier(_orig, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+				vk.CmdPushConstants(_orig, _device_impl->_mipmap_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(num_mips), &num_mips);
+
+				const uint32_t width = std::max(1u, image_data->create_info.extent.width >> level);
+				const uint32_t height = std::max(1u, image_data->create_info.extent.height >> level);
+
+				// Each 16x16 thread group downsamples a 64x64 tile of the source level
+				vk.CmdDispatch(_orig, (width - 1) / 64 + 1, (height - 1) / 64 + 1, layer_count);
+
+				// Transition the written levels back, so that the next iteration can read the last one and subsequent rendering can sample all of them
+				barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+				barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+				barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+				barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				vk.CmdPipelineBarrier(_orig, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+			}
+
+			return;
+		}
+	}
 
 	VkImageMemoryBarrier barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
 	barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
@@ -1233,6 +1459,8 @@ void reshade::vulkan::command_list_impl::generate_mipmaps(api::resource_view srv
 
 void reshade::vulkan::command_list_impl::begin_query(api::query_heap heap, api::query_type type, uint32_t index)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(heap != 0);
@@ -1256,6 +1484,8 @@ void reshade::vulkan::command_list_impl::begin_query(api::query_heap heap, api::
 }
 void reshade::vulkan::command_list_impl::end_query(api::query_heap heap, api::query_type type, uint32_t index)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(heap != 0);
@@ -1281,6 +1511,8 @@ void reshade::vulkan::command_list_impl::end_query(api::query_heap heap, api::qu
 }
 void reshade::vulkan::command_list_impl::copy_query_heap_results(api::query_heap heap, api::query_type type, uint32_t first, uint32_t count, api::resource dst, uint64_t dst_offset, uint32_t stride)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	assert(heap != 0);
@@ -1291,6 +1523,8 @@ void reshade::vulkan::command_list_impl::copy_query_heap_results(api::query_heap
 
 void reshade::vulkan::command_list_impl::copy_acceleration_structure(api::resource_view source, api::resource_view dest, api::acceleration_structure_copy_mode mode)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	VkCopyAccelerationStructureInfoKHR info { VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR };
@@ -1302,6 +1536,8 @@ void reshade::vulkan::command_list_impl::copy_acceleration_structure(api::resour
 }
 void reshade::vulkan::command_list_impl::build_acceleration_structure(api::acceleration_structure_type type, api::acceleration_structure_build_flags flags, uint32_t input_count, const api::acceleration_structure_build_input *inputs, api::resource scratch, uint64_t scratch_offset, api::resource_view source, api::resource_view dest, api::acceleration_structure_build_mode mode)
 {
+	flush_barriers();
+
 	_has_commands = true;
 
 	std::vector<VkAccelerationStructureGeometryKHR> geometries(input_count, { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR });
@@ -69,10 +69,26 @@ namespace reshade::vulkan
 		void end_debug_event() final;
 		void insert_debug_marker(const char *label, const float color[4]) final;
 
+		// Opt in to accumulating barriers across 'barrier' calls, to be submitted as a single merged batch right before the next action command
+		// This is only safe on command buffers whose entire command stream is recorded through this implementation, since commands recorded directly on the underlying command buffer would not see pending barriers
+		void set_barrier_batching(bool enable);
+		// Submits any barriers accumulated while barrier batching is enabled
+		void flush_barriers();
+		// Rewrites the most recent pending barrier on the specified resource into a synchronization-only barrier, after the layout transition it described was already performed on the host
+		bool convert_pending_barrier_to_sync(api::resource resource, api::resource_usage state);
+
 	protected:
+		void submit_barriers(uint32_t count, const api::resource *resources, const api::resource_usage *old_states, const api::resource_usage *new_states);
+
 		device_impl *const _device_impl;
 		bool _has_commands = false;
 		bool _is_in_render_pass = false;
+		bool _batch_barriers = false;
+
+		// Barriers accumulated while barrier batching is enabled, kept in the layout of the 'barrier' arguments for submission
+		std::vector<api::resource> _pending_barrier_resources;
+		std::vector<api::resource_usage> _pending_barrier_old_states;
+		std::vector<api::resource_usage> _pending_barrier_new_states;
 	};
 
 	template <>
@@ -6,9 +6,13 @@
 #include "vulkan_impl_device.hpp"
 #include "vulkan_impl_command_list_immediate.hpp"
 #include "dll_log.hpp"
+#include "trace_events.hpp"
 
 #define vk _device_impl->_dispatch_table
 
+// Upload buffers larger than this are released back to the system once the GPU has finished with them, instead of being kept around for reuse
+static constexpr VkDeviceSize UPLOAD_BUFFER_RECYCLE_LIMIT = 16 * 1024 * 1024;
+
 thread_local reshade::vulkan::command_list_immediate_impl *reshade::vulkan::command_list_immediate_impl::s_last_immediate_command_list = nullptr;
 
 reshade::vulkan::command_list_immediate_impl::command_list_immediate_impl(device_impl *device, uint32_t queue_family_index, VkQueue queue) :
@@ -32,6 +36,18 @@ reshade::vulkan::command_list_immediate_impl::command_list_immediate_impl(device
 			return;
 	}
 
+	// Create a timeline semaphore to track completion of submissions when supported, so that specific submissions can be polled or waited on, instead of blocking on fences
+	if (device->_timeline_semaphore_ext)
+	{
+		VkSemaphoreTypeCreateInfo type_create_info { VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+		type_create_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+
+		VkSemaphoreCreateInfo create_info { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, &type_create_info };
+
+		if (vk.CreateSemaphore(_device_impl->_orig, &create_info, nullptr, &_timeline_semaphore) != VK_SUCCESS)
+			return;
+	}
+
 	for (uint32_t i = 0; i < NUM_COMMAND_FRAMES; ++i)
 	{
 		// The validation layers expect the loader to have set the dispatch pointer, but this does not happen when calling down the layer chain from here, so fix it
@@ -50,11 +66,15 @@ reshade::vulkan::command_list_immediate_impl::command_list_immediate_impl(device
 			vk.SetDebugUtilsObjectNameEXT(_device_impl->_orig, &name_info);
 		}
 
-		VkFenceCreateInfo create_info { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
-		create_info.flags = VK_FENCE_CREATE_SIGNALED_BIT; // Create signaled so waiting on it when no commands where submitted succeeds
+		// Fences are only needed as a fallback when the timeline semaphore above could not be created
+		if (_timeline_semaphore == VK_NULL_HANDLE)
+		{
+			VkFenceCreateInfo create_info { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+			create_info.flags = VK_FENCE_CREATE_SIGNALED_BIT; // Create signaled so waiting on it when no commands where submitted succeeds
 
-		if (vk.CreateFence(_device_impl->_orig, &create_info, nullptr, &_cmd_fences[i]) != VK_SUCCESS)
-			return;
+			if (vk.CreateFence(_device_impl->_orig, &create_info, nullptr, &_cmd_fences[i]) != VK_SUCCESS)
+				return;
+		}
 
 		VkSemaphoreCreateInfo sem_create_info { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
 
@@ -72,6 +92,9 @@ reshade::vulkan::command_list_immediate_impl::command_list_immediate_impl(device
 	// Command buffer is now in the recording state
 	_orig = _cmd_buffers[_cmd_index];
 
+	// The entire command stream of this command buffer is recorded through this implementation, so barriers can safely be accumulated and merged
+	set_barrier_batching(true);
+
 	s_last_immediate_command_list = this;
 }
 reshade::vulkan::command_list_immediate_impl::~command_list_immediate_impl()
@@ -79,6 +102,17 @@ reshade::vulkan::command_list_immediate_impl::~command_list_immediate_impl()
 	if (this == s_last_immediate_command_list)
 		s_last_immediate_command_list = nullptr;
 
+	// Make sure all outstanding submissions have finished executing before releasing the upload buffers still referenced by them
+	if (!_upload_buffers.empty())
+	{
+		wait(_timeline_value);
+
+		for (const upload_buffer &buffer : _upload_buffers)
+			vmaDestroyBuffer(_device_impl->_alloc, buffer.buffer, buffer.allocation);
+	}
+
+	vk.DestroySemaphore(_device_impl->_orig, _timeline_semaphore, nullptr);
+
 	for (VkFence fence : _cmd_fences)
 		vk.DestroyFence(_device_impl->_orig, fence, nullptr);
 	for (VkSemaphore semaphore : _cmd_semaphores)
@@ -91,12 +125,86 @@ reshade::vulkan::command_list_immediate_impl::~command_list_immediate_impl()
 	_orig = VK_NULL_HANDLE;
 }
 
+VkBuffer reshade::vulkan::command_list_immediate_impl::acquire_upload_buffer(VkDeviceSize size, VmaAllocation *out_allocation)
+{
+	// Completion of previous submissions can only be polled cheaply when a timeline semaphore exists
+	if (_timeline_semaphore == VK_NULL_HANDLE)
+		return VK_NULL_HANDLE;
+
+	// Round the size up to the next power of two, so that buffers are more likely to be reusable for differently sized uploads
+	VkDeviceSize capacity = 4096;
+	while (capacity < size)
+		capacity <<= 1;
+
+	// Prefer reusing an existing buffer whose last upload has already finished executing on the GPU
+	const uint64_t completed_value = get_completed_value();
+	for (upload_buffer &buffer : _upload_buffers)
+	{
+		if (buffer.capacity >= capacity && buffer.timeline_value <= completed_value)
+		{
+			// Mark the buffer as in use until the next submission has finished executing
+			buffer.timeline_value = _timeline_value + 1;
+			*out_allocation = buffer.allocation;
+			return buffer.buffer;
+		}
+	}
+
+	VkBufferCreateInfo create_info { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+	create_info.size = capacity;
+	create_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+	VmaAllocationCreateInfo alloc_info = {};
+	alloc_info.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+
+	// Allocate upload buffers from the dedicated memory pool, which retains its memory blocks, so that growing the ring does not churn driver memory allocations
+	if (uint32_t memory_type_index = 0;
+		vmaFindMemoryTypeIndexForBufferInfo(_device_impl->_alloc, &create_info, &alloc_info, &memory_type_index) == VK_SUCCESS)
+		alloc_info.pool = _device_impl->get_memory_pool(memory_type_index);
+
+	VkBuffer buffer = VK_NULL_HANDLE;
+	VmaAllocation allocation = VMA_NULL;
+	if (vmaCreateBuffer(_device_impl->_alloc, &create_info, &alloc_info, &buffer, &allocation, nullptr) != VK_SUCCESS)
+	{
+		log::message(log::level::error, "Failed to create upload buffer (width = %llu)!", create_info.size);
+		return VK_NULL_HANDLE;
+	}
+
+	_upload_buffers.push_back({ buffer, allocation, capacity, _timeline_value + 1 });
+
+	*out_allocation = allocation;
+	return buffer;
+}
+
 bool reshade::vulkan::command_list_immediate_impl::flush(VkSubmitInfo &submit_info)
 {
 	s_last_immediate_command_list = this;
 
 	if (!_has_commands)
 		return true;
+
+	const trace::scoped_event trace_scope("flush_immediate_command_list");
+
+	// Release large upload buffers back to the system once their uploads have finished, only small ones are worth keeping around for reuse
+	if (!_upload_buffers.empty())
+	{
+		const uint64_t completed_value = get_completed_value();
+		for (auto it = _upload_buffers.begin(); it != _upload_buffers.end();)
+		{
+			if (it->timeline_value <= completed_value && it->capacity > UPLOAD_BUFFER_RECYCLE_LIMIT)
+			{
+				vmaDestroyBuffer(_device_impl->_alloc, it->buffer, it->allocation);
+				it = _upload_buffers.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	// Submit any barriers that are still pending before closing the command buffer, so that tracked resource states stay correct across submissions
+	flush_barriers();
+
 	_has_commands = false;
 
 	assert(_orig != VK_NULL_HANDLE);
@@ -124,10 +232,51 @@ bool reshade::vulkan::command_list_immediate_impl::flush(VkSubmitInfo &submit_in
 		submit_info.pSignalSemaphores = &_cmd_semaphores[_cmd_index];
 	}
 
-	// Only reset fence before an actual submit which can signal it again
-	vk.ResetFences(_device_impl->_orig, 1, &_cmd_fences[_cmd_index]);
+	// Keep track of the semaphores the next submission should wait on, before temporarily appending the timeline semaphore to the signal semaphores below
+	const uint32_t chain_semaphore_count = submit_info.signalSemaphoreCount;
+	const VkSemaphore *const chain_semaphores = submit_info.pSignalSemaphores;
+
+	VkSemaphore signal_semaphores[2] = {};
+	uint64_t signal_semaphore_values[2] = {};
+	VkTimelineSemaphoreSubmitInfo timeline_info { VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+
+	if (_timeline_semaphore != VK_NULL_HANDLE)
+	{
+		// Signal the timeline semaphore with the next submit value in addition to any binary semaphores (the signal values of binary semaphores are ignored)
+		assert(chain_semaphore_count < 2);
+		for (uint32_t i = 0; i < chain_semaphore_count; ++i)
+			signal_semaphores[i] = chain_semaphores[i];
+		signal_semaphores[chain_semaphore_count] = _timeline_semaphore;
+		signal_semaphore_values[chain_semaphore_count] = _timeline_value + 1;
+
+		timeline_info.pNext = submit_info.pNext;
+		timeline_info.signalSemaphoreValueCount = chain_semaphore_count + 1;
+		timeline_info.pSignalSemaphoreValues = signal_semaphore_values;
+
+		submit_info.pNext = &timeline_info;
+		submit_info.signalSemaphoreCount = chain_semaphore_count + 1;
+		submit_info.pSignalSemaphores = signal_semaphores;
+	}
+	else
+	{
+		// Only reset fence before an actual submit which can signal it again
+		vk.ResetFences(_device_impl->_orig, 1, &_cmd_fences[_cmd_index]);
+	}
+
+	const VkResult submit_result = vk.QueueSubmit(_parent_queue, 1, &submit_info, _timeline_semaphore != VK_NULL_HANDLE ? VK_NULL_HANDLE : _cmd_fences[_cmd_index]);
 
-	if (vk.QueueSubmit(_parent_queue, 1, &submit_info, _cmd_fences[_cmd_index]) != VK_SUCCESS)
+	if (_timeline_semaphore != VK_NULL_HANDLE)
+	{
+		// Undo the timeline semaphore changes again, since the local arrays referenced by them go out of scope with this function
+		submit_info.pNext = timeline_info.pNext;
+		submit_info.signalSemaphoreCount = chain_semaphore_count;
+		submit_info.pSignalSemaphores = chain_semaphores;
+
+		if (submit_result == VK_SUCCESS)
+			_cmd_timeline_values[_cmd_index] = ++_timeline_value;
+	}
+
+	if (submit_result != VK_SUCCESS)
 	{
 		log::message(log::level::error, "Failed to submit immediate command list!");
 
@@ -150,7 +299,11 @@ bool reshade::vulkan::command_list_immediate_impl::flush(VkSubmitInfo &submit_in
 	_cmd_index = (_cmd_index + 1) % NUM_COMMAND_FRAMES;
 
 	// Make sure the next command buffer has finished executing before reusing it this frame
-	if (vk.GetFenceStatus(_device_impl->_orig, _cmd_fences[_cmd_index]) == VK_NOT_READY)
+	if (_timeline_semaphore != VK_NULL_HANDLE)
+	{
+		wait(_cmd_timeline_values[_cmd_index]);
+	}
+	else if (vk.GetFenceStatus(_device_impl->_orig, _cmd_fences[_cmd_index]) == VK_NOT_READY)
 	{
 		vk.WaitForFences(_device_impl->_orig, 1, &_cmd_fences[_cmd_index], VK_TRUE, UINT64_MAX);
 	}
@@ -175,6 +328,33 @@ bool reshade::vulkan::command_list_immediate_impl::flush_and_wait()
 	if (!flush(submit_info))
 		return false;
 
+	// Wait for the timeline semaphore to reach the value signaled by the submission above
+	if (_timeline_semaphore != VK_NULL_HANDLE)
+		return wait(_timeline_value);
+
 	// Wait for the submitted work to finish and reset fence again for next use
 	return vk.WaitForFences(_device_impl->_orig, 1, &_cmd_fences[cmd_index_to_wait_on], VK_TRUE, UINT64_MAX) == VK_SUCCESS;
 }
+
+uint64_t reshade::vulkan::command_list_immediate_impl::get_completed_value() const
+{
+	if (_timeline_semaphore == VK_NULL_HANDLE)
+		return 0;
+
+	uint64_t value = 0;
+	vk.GetSemaphoreCounterValue(_device_impl->_orig, _timeline_semaphore, &value);
+	return value;
+}
+bool reshade::vulkan::command_list_immediate_impl::wait(uint64_t value, uint64_t timeout) const
+{
+	// Fall back to waiting for the entire queue to go idle when timeline semaphores are unavailable (the timeout cannot be honored in that case)
+	if (_timeline_semaphore == VK_NULL_HANDLE)
+		return vk.QueueWaitIdle(_parent_queue) == VK_SUCCESS;
+
+	VkSemaphoreWaitInfo wait_info { VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+	wait_info.semaphoreCount = 1;
+	wait_info.pSemaphores = &_timeline_semaphore;
+	wait_info.pValues = &value;
+
+	return vk.WaitSemaphores(_device_impl->_orig, &wait_info, timeout) == VK_SUCCESS;
+}
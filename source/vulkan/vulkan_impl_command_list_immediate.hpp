@@ -22,10 +22,38 @@ namespace reshade::vulkan
 		bool flush(VkSubmitInfo &semaphore_info);
 		bool flush_and_wait();
 
+		// Gets the timeline semaphore that is signaled by submissions of this command list (when 'VK_KHR_timeline_semaphore' is available, 'VK_NULL_HANDLE' otherwise)
+		VkSemaphore get_timeline_semaphore() const { return _timeline_semaphore; }
+		// Gets the timeline semaphore value that is signaled once all work submitted via this command list so far has finished execution
+		uint64_t get_last_submit_value() const { return _timeline_value; }
+		// Gets the timeline semaphore value the GPU has completed execution up to, so that completion of previous submissions can be polled without blocking
+		uint64_t get_completed_value() const;
+		// Blocks until the timeline semaphore reached the specified value (or the specified timeout in nanoseconds ran out)
+		bool wait(uint64_t value, uint64_t timeout = UINT64_MAX) const;
+
+		// Returns an upload buffer of at least 'size' bytes, which is recycled once the GPU has finished executing the commands currently being recorded
+		// This requires timeline semaphore support to poll for completed submissions, so returns 'VK_NULL_HANDLE' when that is unavailable
+		VkBuffer acquire_upload_buffer(VkDeviceSize size, VmaAllocation *out_allocation);
+
 	private:
+		// Upload buffer that was used in a submission and can be reused once the associated timeline semaphore value has passed
+		struct upload_buffer
+		{
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VmaAllocation allocation = VMA_NULL;
+			VkDeviceSize capacity = 0;
+			uint64_t timeline_value = 0;
+		};
+
+		std::vector<upload_buffer> _upload_buffers;
+
 		const VkQueue _parent_queue;
 		uint32_t _cmd_index = 0;
 		VkCommandPool _cmd_pool = VK_NULL_HANDLE;
+		// Timeline semaphore signaled with a monotonically increasing value on every submission, which replaces the per-command-buffer fences below when 'VK_KHR_timeline_semaphore' is available
+		VkSemaphore _timeline_semaphore = VK_NULL_HANDLE;
+		uint64_t _timeline_value = 0;
+		uint64_t _cmd_timeline_values[NUM_COMMAND_FRAMES] = {};
 		VkFence _cmd_fences[NUM_COMMAND_FRAMES] = {};
 		VkSemaphore _cmd_semaphores[NUM_COMMAND_FRAMES] = {};
 		VkCommandBuffer _cmd_buffers[NUM_COMMAND_FRAMES] = {};
@@ -74,6 +74,15 @@ void reshade::vulkan::command_queue_impl::flush_immediate_command_list(VkSubmitI
 		_immediate_cmd_list->flush(semaphore_info);
 }
 
+reshade::api::fence reshade::vulkan::command_queue_impl::get_immediate_fence(uint64_t *out_signal_value) const
+{
+	if (out_signal_value != nullptr)
+		*out_signal_value = (_immediate_cmd_list != nullptr) ? _immediate_cmd_list->get_last_submit_value() : 0;
+
+	// The timeline semaphore has the same representation as the fences created by 'device_impl::create_fence', so can hand it out as one
+	return { (_immediate_cmd_list != nullptr) ? (uint64_t)_immediate_cmd_list->get_timeline_semaphore() : 0 };
+}
+
 void reshade::vulkan::command_queue_impl::begin_debug_event(const char *label, const float color[4])
 {
 	assert(label != nullptr);
@@ -24,6 +24,10 @@ namespace reshade::vulkan
 		void flush_immediate_command_list() const final;
 		void flush_immediate_command_list(VkSubmitInfo &semaphore_info) const;
 
+		// Gets the timeline semaphore signaled by submissions of the immediate command list as a generic fence object, together with the value that is signaled once all work submitted so far has finished execution
+		// Completion of that work can then be polled via 'device::get_completed_fence_value', instead of blocking in 'wait_idle' (returns a null fence when timeline semaphores are unavailable or this queue has no immediate command list)
+		api::fence get_immediate_fence(uint64_t *out_signal_value = nullptr) const;
+
 		api::command_list *get_immediate_command_list() final { return _immediate_cmd_list; }
 
 		void begin_debug_event(const char *label, const float color[4]) final;
@@ -7,7 +7,10 @@
 #include "vulkan_impl_command_queue.hpp"
 #include "vulkan_impl_type_convert.hpp"
 #include "dll_log.hpp"
-#include <cstring> // std::memcpy
+#include "dll_resources.hpp"
+#include "ini_file.hpp" // global_config, g_reshade_base_path
+#include <cwchar> // std::swprintf
+#include <cstring> // std::memcmp, std::memcpy
 #include <algorithm> // std::copy_n, std::max
 
 #define vk _dispatch_table
@@ -24,7 +27,9 @@ reshade::vulkan::device_impl::device_impl(
 	bool custom_border_color_ext,
 	bool extended_dynamic_state_ext,
 	bool conservative_rasterization_ext,
-	bool ray_tracing_ext) :
+	bool ray_tracing_ext,
+	bool graphics_pipeline_library_ext,
+	bool host_image_copy_ext) :
 	api_object_impl(device),
 	_physical_device(physical_device),
 	_dispatch_table(device_table),
@@ -36,6 +41,8 @@ reshade::vulkan::device_impl::device_impl(
 	_extended_dynamic_state_ext(extended_dynamic_state_ext),
 	_conservative_rasterization_ext(conservative_rasterization_ext),
 	_ray_tracing_ext(ray_tracing_ext),
+	_graphics_pipeline_library_ext(graphics_pipeline_library_ext),
+	_host_image_copy_ext(host_image_copy_ext),
 	_enabled_features(enabled_features)
 {
 	{	VmaVulkanFunctions functions;
@@ -125,6 +132,51 @@ reshade::vulkan::device_impl::device_impl(
 			log::message(log::level::error, "Failed to create private data slot!");
 		}
 	}
+
+	// Create mipmap generation states used in the 'command_list_impl::generate_mipmaps' implementation (requires formatless storage image writes, which are force-enabled during device creation)
+	if (enabled_features.shaderStorageImageWriteWithoutFormat)
+	{
+		const resources::data_resource cs = resources::load_data_resource(IDR_MIPMAP_CS_SPIRV);
+
+		VkShaderModuleCreateInfo module_create_info { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+		module_create_info.codeSize = cs.data_size;
+		module_create_info.pCode = static_cast<const uint32_t *>(cs.data);
+
+		const VkDescriptorSetLayoutBinding bindings[] = {
+			{ 0, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+			{ 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 6, VK_SHADER_STAGE_COMPUTE_BIT, nullptr }
+		};
+
+		VkDescriptorSetLayoutCreateInfo set_layout_create_info { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+		if (push_descriptors_ext)
+			set_layout_create_info.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+		set_layout_create_info.bindingCount = static_cast<uint32_t>(std::size(bindings));
+		set_layout_create_info.pBindings = bindings;
+
+		const VkPushConstantRange push_constant_range = { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t) };
+
+		VkPipelineLayoutCreateInfo layout_create_info { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+		layout_create_info.setLayoutCount = 1;
+		layout_create_info.pSetLayouts = &_mipmap_set_layout;
+		layout_create_info.pushConstantRangeCount = 1;
+		layout_create_info.pPushConstantRanges = &push_constant_range;
+
+		VkComputePipelineCreateInfo pipeline_create_info { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+		pipeline_create_info.stage = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
+		pipeline_create_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		pipeline_create_info.stage.pName = "main";
+
+		if (vk.CreateShaderModule(_orig, &module_create_info, nullptr, &pipeline_create_info.stage.module) != VK_SUCCESS ||
+			vk.CreateDescriptorSetLayout(_orig, &set_layout_create_info, nullptr, &_mipmap_set_layout) != VK_SUCCESS ||
+			vk.CreatePipelineLayout(_orig, &layout_create_info, nullptr, &_mipmap_pipeline_layout) != VK_SUCCESS ||
+			(pipeline_create_info.layout = _mipmap_pipeline_layout,
+			 vk.CreateComputePipelines(_orig, VK_NULL_HANDLE, 1, &pipeline_create_info, nullptr, &_mipmap_pipeline)) != VK_SUCCESS)
+		{
+			log::message(log::level::error, "Failed to create mipmap generation pipeline!");
+		}
+
+		vk.DestroyShaderModule(_orig, pipeline_create_info.stage.module, nullptr);
+	}
 }
 reshade::vulkan::device_impl::~device_impl()
 {
@@ -136,15 +188,189 @@ reshade::vulkan::device_impl::~device_impl()
 		vk.DestroyFramebuffer(_orig, render_pass_data.second.framebuffer, nullptr);
 	}
 
+	for (const auto &descriptor_template_data : _descriptor_template_lookup)
+		vk.DestroyDescriptorUpdateTemplate(_orig, descriptor_template_data.second, nullptr);
+
+	for (const auto &pipeline_library_data : _pipeline_libraries)
+		vk.DestroyPipeline(_orig, pipeline_library_data.second, nullptr);
+
+	for (const auto &shader_module_data : _shader_modules)
+		vk.DestroyShaderModule(_orig, shader_module_data.second, nullptr);
+
+	// Serialize the pipeline cache back to disk if it grew since it was loaded
+	if (_pipeline_cache != VK_NULL_HANDLE)
+	{
+		if (size_t data_size = 0;
+			vk.GetPipelineCacheData(_orig, _pipeline_cache, &data_size, nullptr) == VK_SUCCESS && data_size > _pipeline_cache_initial_data_size)
+		{
+			std::vector<uint8_t> data(data_size);
+			if (vk.GetPipelineCacheData(_orig, _pipeline_cache, &data_size, data.data()) == VK_SUCCESS)
+			{
+				const HANDLE file = CreateFileW(_pipeline_cache_path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+				if (file != INVALID_HANDLE_VALUE)
+				{
+					DWORD size_written = 0;
+					if (!WriteFile(file, data.data(), static_cast<DWORD>(data_size), &size_written, nullptr) || size_written != data_size)
+						log::message(log::level::warning, "Failed to write pipeline cache file '%s'!", _pipeline_cache_path.u8string().c_str());
+					CloseHandle(file);
+				}
+			}
+		}
+
+		vk.DestroyPipelineCache(_orig, _pipeline_cache, nullptr);
+	}
+
+	vk.DestroyPipeline(_orig, _mipmap_pipeline, nullptr);
+	vk.DestroyPipelineLayout(_orig, _mipmap_pipeline_layout, nullptr);
+	vk.DestroyDescriptorSetLayout(_orig, _mipmap_set_layout, nullptr);
+
 	vk.DestroyPrivateDataSlot(_orig, _private_data_slot, nullptr);
 
 	vk.DestroyDescriptorPool(_orig, _descriptor_pool, nullptr);
 	for (uint32_t i = 0; i < 4; ++i)
 		vk.DestroyDescriptorPool(_orig, _transient_descriptor_pool[i], nullptr);
 
+	for (const VmaPool memory_pool : _memory_pools)
+		if (memory_pool != VMA_NULL)
+			vmaDestroyPool(_alloc, memory_pool);
+
 	vmaDestroyAllocator(_alloc);
 }
 
+VkPipelineCache reshade::vulkan::device_impl::open_pipeline_cache()
+{
+	if (_pipeline_cache_opened)
+		return _pipeline_cache;
+	_pipeline_cache_opened = true;
+
+	if (vk.CreatePipelineCache == nullptr || vk.GetPipelineCacheData == nullptr || vk.DestroyPipelineCache == nullptr)
+		return VK_NULL_HANDLE;
+
+	VkPhysicalDeviceProperties device_props = {};
+	_instance_dispatch_table.GetPhysicalDeviceProperties(_physical_device, &device_props);
+
+	// Mirror the intermediate cache path resolution in 'runtime::load_config', so that the serialized cache ends up next to the effect cache
+	std::error_code ec;
+	std::filesystem::path cache_path;
+	global_config().get("GENERAL", "IntermediateCachePath", cache_path);
+	if (!cache_path.empty() && cache_path.is_relative())
+		cache_path = g_reshade_base_path / cache_path;
+	if (cache_path.empty() || !std::filesystem::is_directory(cache_path, ec))
+		cache_path = std::filesystem::temp_directory_path(ec) / "ReShade";
+
+	// The cache contents are device and driver specific, so keep a separate file keyed by the pipeline cache UUID the driver reports (which changes with driver updates)
+	static_assert(VK_UUID_SIZE == 16);
+	const uint8_t *const uuid = device_props.pipelineCacheUUID;
+	WCHAR file_name[64] = L"";
+	std::swprintf(file_name, std::size(file_name), L"reshade-pipelines-%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X.bin",
+		uuid[0], uuid[1], uuid[2], uuid[3], uuid[4], uuid[5], uuid[6], uuid[7], uuid[8], uuid[9], uuid[10], uuid[11], uuid[12], uuid[13], uuid[14], uuid[15]);
+	_pipeline_cache_path = cache_path / file_name;
+
+	std::vector<uint8_t> initial_data;
+	if (const HANDLE file = CreateFileW(_pipeline_cache_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		file != INVALID_HANDLE_VALUE)
+	{
+		LARGE_INTEGER file_size = {};
+		GetFileSizeEx(file, &file_size);
+		initial_data.resize(static_cast<size_t>(file_size.QuadPart));
+		DWORD size_read = 0;
+		if (!ReadFile(file, initial_data.data(), static_cast<DWORD>(initial_data.size()), &size_read, nullptr) || size_read != initial_data.size())
+			initial_data.clear();
+		CloseHandle(file);
+	}
+
+	// Validate the blob header before passing it along, since drivers are not required to handle initial data created by a different device or driver version gracefully
+	if (initial_data.size() >= sizeof(VkPipelineCacheHeaderVersionOne))
+	{
+		const auto header = reinterpret_cast<const VkPipelineCacheHeaderVersionOne *>(initial_data.data());
+		if (header->headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+			header->vendorID != device_props.vendorID ||
+			header->deviceID != device_props.deviceID ||
+			std::memcmp(header->pipelineCacheUUID, device_props.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+			initial_data.clear();
+	}
+	else
+	{
+		initial_data.clear();
+	}
+
+	VkPipelineCacheCreateInfo create_info { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+	create_info.initialDataSize = initial_data.size();
+	create_info.pInitialData = initial_data.data();
+
+	if (vk.CreatePipelineCache(_orig, &create_info, nullptr, &_pipeline_cache) != VK_SUCCESS)
+	{
+		// The existing data may still be corrupted in ways the header check above cannot catch, so start over with an empty cache
+		create_info.initialDataSize = 0;
+		create_info.pInitialData = nullptr;
+
+		if (vk.CreatePipelineCache(_orig, &create_info, nullptr, &_pipeline_cache) != VK_SUCCESS)
+		{
+			log::message(log::level::warning, "Failed to create pipeline cache!");
+			_pipeline_cache = VK_NULL_HANDLE;
+			return VK_NULL_HANDLE;
+		}
+	}
+
+	_pipeline_cache_initial_data_size = create_info.initialDataSize;
+
+	return _pipeline_cache;
+}
+
+VmaPool reshade::vulkan::device_impl::get_memory_pool(uint32_t memory_type_index)
+{
+	assert(memory_type_index < VK_MAX_MEMORY_TYPES);
+
+	const std::unique_lock<std::mutex> lock(_memory_pool_mutex);
+
+	if (_memory_pools[memory_type_index] == VMA_NULL)
+	{
+		VmaPoolCreateInfo create_info = {};
+		create_info.memoryTypeIndex = memory_type_index;
+		// Keep one memory block alive even while all allocations in the pool are freed, so that effect reload cycles reuse it instead of repeatedly freeing and reallocating device memory
+		create_info.minBlockCount = 1;
+
+		// Returning a null handle here makes the caller fall back to the default pools
+		if (vmaCreatePool(_alloc, &create_info, &_memory_pools[memory_type_index]) != VK_SUCCESS)
+			_memory_pools[memory_type_index] = VMA_NULL;
+	}
+
+	return _memory_pools[memory_type_index];
+}
+
+const VkImageView *reshade::vulkan::device_impl::get_mipmap_chain_views(VkImage image)
+{
+	const auto data = get_private_data_for_object<VK_OBJECT_TYPE_IMAGE>(image);
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	if (data->mipmap_views.empty())
+	{
+		VkImageViewCreateInfo create_info { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+		create_info.image = image;
+		create_info.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+		create_info.format = data->create_info.format;
+		create_info.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, data->create_info.arrayLayers };
+
+		data->mipmap_views.resize(data->create_info.mipLevels);
+
+		for (uint32_t level = 0; level < data->create_info.mipLevels; ++level)
+		{
+			create_info.subresourceRange.baseMipLevel = level;
+
+			if (vk.CreateImageView(_orig, &create_info, nullptr, &data->mipmap_views[level]) != VK_SUCCESS)
+			{
+				for (uint32_t prev_level = 0; prev_level < level; ++prev_level)
+					vk.DestroyImageView(_orig, data->mipmap_views[prev_level], nullptr);
+				data->mipmap_views.clear();
+				return nullptr;
+			}
+		}
+	}
+
+	return data->mipmap_views.data();
+}
+
 bool reshade::vulkan::device_impl::get_property(api::device_properties property, void *data) const
 {
 	VkPhysicalDeviceRayTracingPipelinePropertiesKHR ray_tracing_props { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_PROPERTIES_KHR };
@@ -278,6 +504,8 @@ bool reshade::vulkan::device_impl::check_capability(api::device_caps capability)
 		return vk.CmdDrawMeshTasksEXT != nullptr;
 	case api::device_caps::ray_tracing:
 		return _ray_tracing_ext;
+	case api::device_caps::partial_constant_buffer_updates:
+		return true;
 	default:
 		return false;
 	}
@@ -428,6 +656,12 @@ bool reshade::vulkan::device_impl::create_resource(const api::resource_desc &des
 				create_info.pNext = &external_memory_info;
 			}
 
+			// Route the allocation into a dedicated memory pool whose blocks are retained across effect reloads, so that frequent destruction and re-creation of resources does not churn driver memory allocations
+			if (!is_shared && desc.heap != api::memory_heap::unknown)
+				if (uint32_t memory_type_index = 0;
+					vmaFindMemoryTypeIndexForBufferInfo(_alloc, &create_info, &alloc_info, &memory_type_index) == VK_SUCCESS)
+					alloc_info.pool = get_memory_pool(memory_type_index);
+
 			if (VkBuffer object = VK_NULL_HANDLE;
 				(desc.heap == api::memory_heap::unknown || is_shared ?
 					 vk.CreateBuffer(_orig, &create_info, nullptr, &object) :
@@ -516,6 +750,30 @@ bool reshade::vulkan::device_impl::create_resource(const api::resource_desc &des
 			if (desc.heap == api::memory_heap::gpu_to_cpu || desc.heap == api::memory_heap::cpu_only)
 				create_info.tiling = VK_IMAGE_TILING_LINEAR;
 
+			// Mipmap generation prefers a compute shader writing to per-level storage image views, so add the necessary usage when the format supports it (see 'command_list_impl::generate_mipmaps')
+			if ((desc.flags & api::resource_flags::generate_mipmaps) != 0 && create_info.mipLevels > 1 && create_info.tiling == VK_IMAGE_TILING_OPTIMAL)
+			{
+				VkFormatProperties format_props = {};
+				_instance_dispatch_table.GetPhysicalDeviceFormatProperties(_physical_device, create_info.format, &format_props);
+
+				if ((format_props.optimalTilingFeatures & (VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)) == (VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+					create_info.usage |= VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+			}
+
+			// Texture uploads prefer host image copies, which avoid the upload buffer and queue submission otherwise necessary (see 'update_texture_region')
+			// Only opt sampled textures in, since the host transfer usage can disable framebuffer compression on some hardware
+			if (_host_image_copy_ext && !is_shared && create_info.tiling == VK_IMAGE_TILING_OPTIMAL && create_info.samples == VK_SAMPLE_COUNT_1_BIT &&
+				(desc.usage & (api::resource_usage::copy_dest | api::resource_usage::shader_resource)) == (api::resource_usage::copy_dest | api::resource_usage::shader_resource) &&
+				(desc.usage & (api::resource_usage::render_target | api::resource_usage::depth_stencil | api::resource_usage::unordered_access)) == 0)
+			{
+				VkFormatProperties3 format_props_3 { VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3 };
+				VkFormatProperties2 format_props { VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2, &format_props_3 };
+				_instance_dispatch_table.GetPhysicalDeviceFormatProperties2(_physical_device, create_info.format, &format_props);
+
+				if ((format_props_3.optimalTilingFeatures & VK_FORMAT_FEATURE_2_HOST_IMAGE_TRANSFER_BIT_EXT) != 0)
+					create_info.usage |= VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
+			}
+
 			VkExternalMemoryImageCreateInfo external_memory_info;
 			if (is_shared)
 			{
@@ -525,6 +783,12 @@ bool reshade::vulkan::device_impl::create_resource(const api::resource_desc &des
 				create_info.pNext = &external_memory_info;
 			}
 
+			// Route the allocation into a dedicated memory pool whose blocks are retained across effect reloads (see also the buffer path above)
+			if (!is_shared && desc.heap != api::memory_heap::unknown)
+				if (uint32_t memory_type_index = 0;
+					vmaFindMemoryTypeIndexForImageInfo(_alloc, &create_info, &alloc_info, &memory_type_index) == VK_SUCCESS)
+					alloc_info.pool = get_memory_pool(memory_type_index);
+
 			if (VkImage object = VK_NULL_HANDLE;
 				(desc.heap == api::memory_heap::unknown || is_shared ?
 					 vk.CreateImage(_orig, &create_info, nullptr, &object) :
@@ -654,10 +918,14 @@ void reshade::vulkan::device_impl::destroy_resource(api::resource resource)
 		const VmaAllocation allocation = data->allocation;
 		const VkDeviceMemory memory = data->memory;
 		const VkImageView default_view = data->default_view;
+		const std::vector<VkImageView> mipmap_views = std::move(data->mipmap_views);
 
 		// Warning, the 'data' pointer must not be accessed after this call, since it frees that memory!
 		unregister_object<VK_OBJECT_TYPE_IMAGE>((VkImage)resource.handle);
 
+		for (const VkImageView mipmap_view : mipmap_views)
+			vk.DestroyImageView(_orig, mipmap_view, nullptr);
+
 		if (allocation == VMA_NULL)
 		{
 			vk.DestroyImageView(_orig, default_view, nullptr);
@@ -1027,8 +1295,12 @@ void reshade::vulkan::device_impl::update_texture_region(const api::subresource_
 
 	const auto resource_data = get_private_data_for_object<VK_OBJECT_TYPE_IMAGE>((VkImage)resource.handle);
 
+	const uint32_t mip_level = subresource % resource_data->create_info.mipLevels;
+
 	VkExtent3D extent = resource_data->create_info.extent;
-	extent.depth *= resource_data->create_info.arrayLayers;
+	extent.width  = std::max(1u, extent.width  >> mip_level);
+	extent.height = std::max(1u, extent.height >> mip_level);
+	extent.depth  = std::max(1u, extent.depth  >> mip_level);
 
 	if (box != nullptr)
 	{
@@ -1041,17 +1313,63 @@ void reshade::vulkan::device_impl::update_texture_region(const api::subresource_
 	const auto slice_pitch = api::format_slice_pitch(convert_format(resource_data->create_info.format), row_pitch, extent.height);
 	const auto total_image_size = extent.depth * static_cast<size_t>(slice_pitch);
 
-	// Allocate host memory for upload
-	VkBuffer intermediate = VK_NULL_HANDLE;
-	VmaAllocation intermediate_mem = VK_NULL_HANDLE;
+	const bool tightly_packed =
+		(row_pitch == data.row_pitch || extent.height == 1) &&
+		(slice_pitch == data.slice_pitch || extent.depth == 1);
 
-	{   VkBufferCreateInfo create_info { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+	// Write the pixel data directly to the image when it was created for host image copies, which avoids the upload buffer and expensive queue submission below entirely (see also 'create_resource')
+	if ((resource_data->create_info.usage & VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT) != 0 && box == nullptr && tightly_packed &&
+		// The image is left in the copy destination layout by the host transition, so the pending barrier that was meant to transition it there on the GPU timeline has to be reduced to its synchronization part
+		immediate_command_list->convert_pending_barrier_to_sync(resource, api::resource_usage::copy_dest))
+	{
+		VkHostImageLayoutTransitionInfoEXT transition_info { VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT };
+		transition_info.image = (VkImage)resource.handle;
+		// The entire subresource is overwritten below, so its previous contents can be discarded
+		transition_info.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		transition_info.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		transition_info.subresourceRange = { aspect_flags_from_format(resource_data->create_info.format), mip_level, 1, subresource / resource_data->create_info.mipLevels, 1 };
+
+		VkMemoryToImageCopyEXT region { VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT };
+		region.pHostPointer = data.data;
+		region.memoryRowLength = 0;
+		region.memoryImageHeight = 0;
+		region.imageSubresource = { transition_info.subresourceRange.aspectMask, mip_level, transition_info.subresourceRange.baseArrayLayer, 1 };
+		region.imageOffset = { 0, 0, 0 };
+		region.imageExtent = extent;
+
+		VkCopyMemoryToImageInfoEXT copy_info { VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT };
+		copy_info.dstImage = (VkImage)resource.handle;
+		copy_info.dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		copy_info.regionCount = 1;
+		copy_info.pRegions = &region;
+
+		if (vk.TransitionImageLayoutEXT(_orig, 1, &transition_info) == VK_SUCCESS &&
+			vk.CopyMemoryToImageEXT(_orig, &copy_info) == VK_SUCCESS)
+			return;
+
+		// Fall back to the upload buffer below, which also expects the image in the copy destination layout, so the host transition above does no harm even when only the copy failed
+	}
+
+	// Prefer an upload buffer recycled by the immediate command list, so that repeated texture updates are allocation-free and do not stall on the GPU
+	VmaAllocation intermediate_mem = VMA_NULL;
+	VkBuffer intermediate = immediate_command_list->acquire_upload_buffer(total_image_size, &intermediate_mem);
+	const bool intermediate_recycled = intermediate != VK_NULL_HANDLE;
+
+	if (!intermediate_recycled)
+	{
+		// Allocate host memory for upload
+		VkBufferCreateInfo create_info { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
 		create_info.size = total_image_size;
 		create_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
 
 		VmaAllocationCreateInfo alloc_info = {};
 		alloc_info.usage = VMA_MEMORY_USAGE_CPU_ONLY;
 
+		// Allocate upload buffers from the dedicated memory pool, which retains its memory blocks, so that repeated texture uploads during effect loading do not churn driver memory allocations
+		if (uint32_t memory_type_index = 0;
+			vmaFindMemoryTypeIndexForBufferInfo(_alloc, &create_info, &alloc_info, &memory_type_index) == VK_SUCCESS)
+			alloc_info.pool = get_memory_pool(memory_type_index);
+
 		if (vmaCreateBuffer(_alloc, &create_info, &alloc_info, &intermediate, &intermediate_mem, nullptr) != VK_SUCCESS)
 		{
 			log::message(log::level::error, "Failed to create upload buffer (width = %llu)!", create_info.size);
@@ -1063,8 +1381,7 @@ void reshade::vulkan::device_impl::update_texture_region(const api::subresource_
 	uint8_t *mapped_data = nullptr;
 	if (vmaMapMemory(_alloc, intermediate_mem, reinterpret_cast<void **>(&mapped_data)) == VK_SUCCESS)
 	{
-		if ((row_pitch == data.row_pitch || extent.height == 1) &&
-			(slice_pitch == data.slice_pitch || extent.depth == 1))
+		if (tightly_packed)
 		{
 			std::memcpy(mapped_data, data.data, total_image_size);
 		}
@@ -1082,11 +1399,27 @@ void reshade::vulkan::device_impl::update_texture_region(const api::subresource_
 		// Copy data from upload buffer into target texture using the first available immediate command list
 		immediate_command_list->copy_buffer_to_texture({ (uint64_t)intermediate }, 0, 0, 0, resource, subresource, box);
 
-		// Wait for command to finish executing before destroying the upload buffer
-		immediate_command_list->flush_and_wait();
+		if (intermediate_recycled)
+		{
+			// There is no need to wait for the copy to finish, since the recycled upload buffer stays alive until it did
+			VkSubmitInfo submit_info { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+			immediate_command_list->flush(submit_info);
+		}
+		else
+		{
+			// Wait for command to finish executing before destroying the upload buffer
+			immediate_command_list->flush_and_wait();
+		}
 	}
 
-	vmaDestroyBuffer(_alloc, intermediate, intermediate_mem);
+	if (!intermediate_recycled)
+		vmaDestroyBuffer(_alloc, intermediate, intermediate_mem);
+}
+
+static void hash_combine_data(size_t &seed, const void *data, size_t size)
+{
+	for (size_t i = 0; i < size; ++i)
+		seed = (seed * 16777619) ^ static_cast<const uint8_t *>(data)[i];
 }
 
 bool reshade::vulkan::device_impl::create_shader_module(VkShaderStageFlagBits stage, const api::shader_desc &desc, VkPipelineShaderStageCreateInfo &stage_info, VkSpecializationInfo &spec_info, std::vector<VkSpecializationMapEntry> &spec_map)
@@ -1105,17 +1438,40 @@ bool reshade::vulkan::device_impl::create_shader_module(VkShaderStageFlagBits st
 	stage_info.pName = desc.entry_point != nullptr ? desc.entry_point : "main";
 	stage_info.pSpecializationInfo = &spec_info;
 
+	// Shader modules only wrap the SPIR-V code (entry point and specialization constants are part of the stage info), so can be deduplicated by a hash of that code and shared between pipelines
+	size_t code_hash = 2166136261;
+	hash_combine_data(code_hash, desc.code, desc.code_size);
+
+	const std::unique_lock<std::mutex> lock(_shader_module_mutex);
+
+	if (const auto it = _shader_modules.find(code_hash);
+		it != _shader_modules.end())
+	{
+		stage_info.module = it->second;
+		return true;
+	}
+
 	VkShaderModuleCreateInfo create_info { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
 	create_info.codeSize = desc.code_size;
 	create_info.pCode = static_cast<const uint32_t *>(desc.code);
 
-	return vk.CreateShaderModule(_orig, &create_info, nullptr, &stage_info.module) == VK_SUCCESS;
+	if (vk.CreateShaderModule(_orig, &create_info, nullptr, &stage_info.module) != VK_SUCCESS)
+		return false;
+
+	_shader_modules.emplace(code_hash, stage_info.module);
+	return true;
 }
 
 bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout, uint32_t subobject_count, const api::pipeline_subobject *subobjects, api::pipeline *out_pipeline)
 {
+	// Feed all pipeline creation through the persistent pipeline cache, so that shader compilation done for the effects of previous runs can be reused (the cache object itself is internally synchronized)
+	VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
+	{
+		const std::unique_lock<std::mutex> lock(_pipeline_cache_mutex);
+		pipeline_cache = open_pipeline_cache();
+	}
+
 	VkRenderPass render_pass = VK_NULL_HANDLE;
-	std::vector<VkShaderModule> shaders;
 
 	api::shader_desc vs_desc = {};
 	api::shader_desc hs_desc = {};
@@ -1313,37 +1669,31 @@ bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout,
 		{
 			if (!create_shader_module(VK_SHADER_STAGE_RAYGEN_BIT_KHR, shader_desc, shader_stage_info.emplace_back(), spec_info.emplace_back(), spec_map.emplace_back()))
 				goto exit_failure;
-			shaders.push_back(shader_stage_info.back().module);
 		}
 		for (const api::shader_desc &shader_desc : any_hit_desc)
 		{
 			if (!create_shader_module(VK_SHADER_STAGE_ANY_HIT_BIT_KHR, shader_desc, shader_stage_info.emplace_back(), spec_info.emplace_back(), spec_map.emplace_back()))
 				goto exit_failure;
-			shaders.push_back(shader_stage_info.back().module);
 		}
 		for (const api::shader_desc &shader_desc : closest_hit_desc)
 		{
 			if (!create_shader_module(VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, shader_desc, shader_stage_info.emplace_back(), spec_info.emplace_back(), spec_map.emplace_back()))
 				goto exit_failure;
-			shaders.push_back(shader_stage_info.back().module);
 		}
 		for (const api::shader_desc &shader_desc : miss_desc)
 		{
 			if (!create_shader_module(VK_SHADER_STAGE_MISS_BIT_KHR, shader_desc, shader_stage_info.emplace_back(), spec_info.emplace_back(), spec_map.emplace_back()))
 				goto exit_failure;
-			shaders.push_back(shader_stage_info.back().module);
 		}
 		for (const api::shader_desc &shader_desc : intersection_desc)
 		{
 			if (!create_shader_module(VK_SHADER_STAGE_INTERSECTION_BIT_KHR, shader_desc, shader_stage_info.emplace_back(), spec_info.emplace_back(), spec_map.emplace_back()))
 				goto exit_failure;
-			shaders.push_back(shader_stage_info.back().module);
 		}
 		for (const api::shader_desc &shader_desc : callable_desc)
 		{
 			if (!create_shader_module(VK_SHADER_STAGE_CALLABLE_BIT_KHR, shader_desc, shader_stage_info.emplace_back(), spec_info.emplace_back(), spec_map.emplace_back()))
 				goto exit_failure;
-			shaders.push_back(shader_stage_info.back().module);
 		}
 
 		create_info.stageCount = static_cast<uint32_t>(shader_stage_info.size());
@@ -1467,11 +1817,8 @@ bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout,
 		}
 
 		if (VkPipeline object = VK_NULL_HANDLE;
-			vk.CreateRayTracingPipelinesKHR(_orig, VK_NULL_HANDLE, VK_NULL_HANDLE, 1, &create_info, nullptr, &object) == VK_SUCCESS)
+			vk.CreateRayTracingPipelinesKHR(_orig, VK_NULL_HANDLE, pipeline_cache, 1, &create_info, nullptr, &object) == VK_SUCCESS)
 		{
-			for (const VkShaderModule shader : shaders)
-				vk.DestroyShaderModule(_orig, shader, nullptr);
-
 			*out_pipeline = { (uint64_t)object };
 			return true;
 		}
@@ -1489,14 +1836,11 @@ bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout,
 		{
 			if (!create_shader_module(VK_SHADER_STAGE_COMPUTE_BIT, cs_desc, create_info.stage, spec_info, spec_map))
 				goto exit_failure;
-			shaders.push_back(create_info.stage.module);
 		}
 
 		if (VkPipeline object = VK_NULL_HANDLE;
-			vk.CreateComputePipelines(_orig, VK_NULL_HANDLE, 1, &create_info, nullptr, &object) == VK_SUCCESS)
+			vk.CreateComputePipelines(_orig, pipeline_cache, 1, &create_info, nullptr, &object) == VK_SUCCESS)
 		{
-			vk.DestroyShaderModule(_orig, create_info.stage.module, nullptr);
-
 			*out_pipeline = { (uint64_t)object };
 			return true;
 		}
@@ -1517,43 +1861,43 @@ bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout,
 		{
 			if (!create_shader_module(VK_SHADER_STAGE_VERTEX_BIT, vs_desc, shader_stage_info[create_info.stageCount], spec_info[create_info.stageCount], spec_map[create_info.stageCount]))
 				goto exit_failure;
-			shaders.push_back(shader_stage_info[create_info.stageCount++].module);
+			create_info.stageCount++;
 		}
 		if (hs_desc.code_size != 0)
 		{
 			if (!create_shader_module(VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT, hs_desc, shader_stage_info[create_info.stageCount], spec_info[create_info.stageCount], spec_map[create_info.stageCount]))
 				goto exit_failure;
-			shaders.push_back(shader_stage_info[create_info.stageCount++].module);
+			create_info.stageCount++;
 		}
 		if (ds_desc.code_size != 0)
 		{
 			if (!create_shader_module(VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT, ds_desc, shader_stage_info[create_info.stageCount], spec_info[create_info.stageCount], spec_map[create_info.stageCount]))
 				goto exit_failure;
-			shaders.push_back(shader_stage_info[create_info.stageCount++].module);
+			create_info.stageCount++;
 		}
 		if (gs_desc.code_size != 0)
 		{
 			if (!create_shader_module(VK_SHADER_STAGE_GEOMETRY_BIT, gs_desc, shader_stage_info[create_info.stageCount], spec_info[create_info.stageCount], spec_map[create_info.stageCount]))
 				goto exit_failure;
-			shaders.push_back(shader_stage_info[create_info.stageCount++].module);
+			create_info.stageCount++;
 		}
 		if (ps_desc.code_size != 0)
 		{
 			if (!create_shader_module(VK_SHADER_STAGE_FRAGMENT_BIT, ps_desc, shader_stage_info[create_info.stageCount], spec_info[create_info.stageCount], spec_map[create_info.stageCount]))
 				goto exit_failure;
-			shaders.push_back(shader_stage_info[create_info.stageCount++].module);
+			create_info.stageCount++;
 		}
 		if (as_desc.code_size != 0)
 		{
 			if (!create_shader_module(VK_SHADER_STAGE_TASK_BIT_EXT, as_desc, shader_stage_info[create_info.stageCount], spec_info[create_info.stageCount], spec_map[create_info.stageCount]))
 				goto exit_failure;
-			shaders.push_back(shader_stage_info[create_info.stageCount++].module);
+			create_info.stageCount++;
 		}
 		if (ms_desc.code_size != 0)
 		{
 			if (!create_shader_module(VK_SHADER_STAGE_MESH_BIT_EXT, ms_desc, shader_stage_info[create_info.stageCount], spec_info[create_info.stageCount], spec_map[create_info.stageCount]))
 				goto exit_failure;
-			shaders.push_back(shader_stage_info[create_info.stageCount++].module);
+			create_info.stageCount++;
 		}
 
 		std::vector<VkDynamicState> dyn_states;
@@ -1740,6 +2084,87 @@ bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout,
 			create_info.renderPass = render_pass;
 		}
 
+		// Split pipeline creation into a library part and a fast-link part when supported, so that the expensive shader compilation is shared between pipelines that only differ in their fragment output state (e.g. after the swap chain was resized to a different format)
+		if (_graphics_pipeline_library_ext && _dynamic_rendering_ext && libraries.empty() && vs_desc.code_size != 0 && as_desc.code_size == 0 && ms_desc.code_size == 0)
+		{
+			// Hash all state that feeds the vertex input, pre-rasterization and fragment shader subsets
+			size_t library_hash = 2166136261;
+			hash_combine(library_hash, layout.handle);
+			for (const api::shader_desc *shader_desc : { &vs_desc, &hs_desc, &ds_desc, &gs_desc, &ps_desc })
+			{
+				hash_combine_data(library_hash, shader_desc->code, shader_desc->code_size);
+				if (shader_desc->entry_point != nullptr)
+					hash_combine_data(library_hash, shader_desc->entry_point, std::strlen(shader_desc->entry_point));
+				hash_combine_data(library_hash, shader_desc->spec_constant_ids, shader_desc->spec_constants * sizeof(uint32_t));
+				hash_combine_data(library_hash, shader_desc->spec_constant_values, shader_desc->spec_constants * sizeof(uint32_t));
+			}
+			hash_combine_data(library_hash, vertex_bindings.data(), vertex_bindings.size() * sizeof(VkVertexInputBindingDescription));
+			hash_combine_data(library_hash, vertex_attributes.data(), vertex_attributes.size() * sizeof(VkVertexInputAttributeDescription));
+			hash_combine_data(library_hash, dyn_states.data(), dyn_states.size() * sizeof(VkDynamicState));
+			hash_combine(library_hash, static_cast<uint32_t>(input_assembly_state_info.topology));
+			hash_combine(library_hash, tessellation_state_info.patchControlPoints);
+			hash_combine(library_hash, viewport_count);
+			hash_combine_data(library_hash, &rasterizer_desc, sizeof(rasterizer_desc));
+			hash_combine_data(library_hash, &depth_stencil_desc, sizeof(depth_stencil_desc));
+			hash_combine_data(library_hash, &stream_output_desc, sizeof(stream_output_desc));
+			hash_combine(library_hash, sample_mask);
+			hash_combine(library_hash, sample_count);
+
+			VkPipeline library = VK_NULL_HANDLE;
+			{
+				const std::unique_lock<std::mutex> lock(_pipeline_library_mutex);
+
+				if (const auto it = _pipeline_libraries.find(library_hash);
+					it != _pipeline_libraries.end())
+				{
+					library = it->second;
+				}
+				else
+				{
+					// Graphics pipeline library creation ignores all state outside of the declared subsets, so can simply reuse the already filled out creation info
+					VkGraphicsPipelineLibraryCreateInfoEXT library_subsets_info { VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT };
+					library_subsets_info.pNext = create_info.pNext;
+					library_subsets_info.flags = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT | VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT | VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+
+					VkGraphicsPipelineCreateInfo library_create_info = create_info;
+					library_create_info.pNext = &library_subsets_info;
+					library_create_info.flags |= VK_PIPELINE_CREATE_LIBRARY_BIT_KHR;
+
+					if (vk.CreateGraphicsPipelines(_orig, pipeline_cache, 1, &library_create_info, nullptr, &library) == VK_SUCCESS)
+						_pipeline_libraries.emplace(library_hash, library);
+					else
+						library = VK_NULL_HANDLE;
+				}
+			}
+
+			if (library != VK_NULL_HANDLE)
+			{
+				// Link the library against the fragment output state without link-time optimization, which is fast since no shader compilation is involved
+				VkGraphicsPipelineLibraryCreateInfoEXT fragment_output_info { VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT };
+				fragment_output_info.pNext = create_info.pNext;
+				fragment_output_info.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+
+				VkPipelineLibraryCreateInfoKHR linked_library_info { VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR };
+				linked_library_info.pNext = &fragment_output_info;
+				linked_library_info.libraryCount = 1;
+				linked_library_info.pLibraries = &library;
+
+				VkGraphicsPipelineCreateInfo linked_create_info = create_info;
+				linked_create_info.pNext = &linked_library_info;
+				linked_create_info.stageCount = 0;
+				linked_create_info.pStages = nullptr;
+
+				if (VkPipeline object = VK_NULL_HANDLE;
+					vk.CreateGraphicsPipelines(_orig, pipeline_cache, 1, &linked_create_info, nullptr, &object) == VK_SUCCESS)
+				{
+					*out_pipeline = { (uint64_t)object };
+					return true;
+				}
+
+				// Fall through to monolithic pipeline creation below in case linking failed
+			}
+		}
+
 		VkPipelineLibraryCreateInfoKHR library_info;
 		if (!libraries.empty())
 		{
@@ -1752,14 +2177,11 @@ bool reshade::vulkan::device_impl::create_pipeline(api::pipeline_layout layout,
 		}
 
 		if (VkPipeline object = VK_NULL_HANDLE;
-			vk.CreateGraphicsPipelines(_orig, VK_NULL_HANDLE, 1, &create_info, nullptr, &object) == VK_SUCCESS)
+			vk.CreateGraphicsPipelines(_orig, pipeline_cache, 1, &create_info, nullptr, &object) == VK_SUCCESS)
 		{
 			if (render_pass != VK_NULL_HANDLE)
 				vk.DestroyRenderPass(_orig, render_pass, nullptr);
 
-			for (const VkShaderModule shader : shaders)
-				vk.DestroyShaderModule(_orig, shader, nullptr);
-
 			*out_pipeline = { (uint64_t)object };
 			return true;
 		}
@@ -1769,9 +2191,6 @@ exit_failure:
 	if (render_pass != VK_NULL_HANDLE)
 		vk.DestroyRenderPass(_orig, render_pass, nullptr);
 
-	for (const VkShaderModule shader : shaders)
-		vk.DestroyShaderModule(_orig, shader, nullptr);
-
 	*out_pipeline = { 0 };
 	return false;
 }
@@ -2041,6 +2460,24 @@ void reshade::vulkan::device_impl::copy_descriptor_tables(uint32_t count, const
 }
 void reshade::vulkan::device_impl::update_descriptor_tables(uint32_t count, const api::descriptor_table_update *updates)
 {
+	// Prefer descriptor update templates when supported, so that the recurring updates with the same shape that happen every frame (like those done for effect texture bindings) skip the write marshaling below
+	if (vk.CreateDescriptorUpdateTemplate != nullptr && vk.UpdateDescriptorSetWithTemplate != nullptr)
+	{
+		uint32_t i = 0;
+		for (; i < count; ++i)
+		{
+			// Acceleration structure descriptors are not supported by update templates
+			if (updates[i].type == api::descriptor_type::acceleration_structure)
+				break;
+			// Fall back to the generic write path below in case of failure (updating the preceding descriptors a second time with the same data is harmless)
+			if (updates[i].count != 0 && !update_descriptor_table_with_template(updates[i]))
+				break;
+		}
+
+		if (i == count)
+			return;
+	}
+
 	std::vector<VkWriteDescriptorSet> writes_internal;
 	writes_internal.reserve(count);
 
@@ -2132,6 +2569,138 @@ void reshade::vulkan::device_impl::update_descriptor_tables(uint32_t count, cons
 
 	vk.UpdateDescriptorSets(_orig, static_cast<uint32_t>(writes_internal.size()), writes_internal.data(), 0, nullptr);
 }
+bool reshade::vulkan::device_impl::update_descriptor_table_with_template(const api::descriptor_table_update &update)
+{
+	assert(update.count != 0 && update.type != api::descriptor_type::acceleration_structure);
+
+	const auto set_data = get_private_data_for_object<VK_OBJECT_TYPE_DESCRIPTOR_SET, true>((VkDescriptorSet)update.table.handle);
+	if (set_data == nullptr || set_data->layout == VK_NULL_HANDLE)
+		return false;
+
+	// Look up the cached update template matching the shape of this update (the updates done every frame recur with the same set layout, binding, offset and count)
+	size_t hash = 0xFFFFFFFF;
+	hash_combine(hash, (uint64_t)set_data->layout);
+	hash_combine(hash, update.binding);
+	hash_combine(hash, update.array_offset);
+	hash_combine(hash, update.count);
+	hash_combine(hash, static_cast<uint32_t>(update.type));
+
+	VkDescriptorUpdateTemplate descriptor_template = VK_NULL_HANDLE;
+
+	std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	if (const auto it = _descriptor_template_lookup.find(hash);
+		it != _descriptor_template_lookup.end())
+	{
+		descriptor_template = it->second;
+
+		lock.unlock();
+	}
+	else
+	{
+		lock.unlock();
+
+		VkDescriptorUpdateTemplateEntry entry;
+		entry.dstBinding = update.binding;
+		entry.dstArrayElement = update.array_offset;
+		entry.descriptorCount = update.count;
+		entry.descriptorType = convert_descriptor_type(update.type);
+		entry.offset = 0;
+
+		switch (update.type)
+		{
+		case api::descriptor_type::buffer_shader_resource_view:
+		case api::descriptor_type::buffer_unordered_access_view:
+			entry.stride = sizeof(VkBufferView);
+			break;
+		case api::descriptor_type::constant_buffer:
+		case api::descriptor_type::shader_storage_buffer:
+			entry.stride = sizeof(VkDescriptorBufferInfo);
+			break;
+		default:
+			entry.stride = sizeof(VkDescriptorImageInfo);
+			break;
+		}
+
+		VkDescriptorUpdateTemplateCreateInfo create_info { VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO };
+		create_info.descriptorUpdateEntryCount = 1;
+		create_info.pDescriptorUpdateEntries = &entry;
+		create_info.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+		// The set layout is only used during creation of the template, so it is fine for the cached template to outlive it
+		create_info.descriptorSetLayout = set_data->layout;
+
+		if (vk.CreateDescriptorUpdateTemplate(_orig, &create_info, nullptr, &descriptor_template) != VK_SUCCESS)
+			return false;
+
+		lock.lock();
+
+		if (const auto insert = _descriptor_template_lookup.emplace(hash, descriptor_template);
+			!insert.second)
+		{
+			// Another thread raced ahead and already created a template with the same shape, so use that one instead
+			vk.DestroyDescriptorUpdateTemplate(_orig, descriptor_template, nullptr);
+			descriptor_template = insert.first->second;
+		}
+
+		lock.unlock();
+	}
+
+	switch (update.type)
+	{
+	case api::descriptor_type::sampler:
+	{
+		temp_mem<VkDescriptorImageInfo> image_info(update.count);
+		for (uint32_t k = 0; k < update.count; ++k)
+		{
+			const auto &descriptor = static_cast<const api::sampler *>(update.descriptors)[k];
+			image_info[k].sampler = (VkSampler)descriptor.handle;
+			image_info[k].imageView = VK_NULL_HANDLE;
+			image_info[k].imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		}
+		vk.UpdateDescriptorSetWithTemplate(_orig, (VkDescriptorSet)update.table.handle, descriptor_template, image_info.p);
+		break;
+	}
+	case api::descriptor_type::sampler_with_resource_view:
+	{
+		temp_mem<VkDescriptorImageInfo> image_info(update.count);
+		for (uint32_t k = 0; k < update.count; ++k)
+		{
+			const auto &descriptor = static_cast<const api::sampler_with_resource_view *>(update.descriptors)[k];
+			image_info[k].sampler = (VkSampler)descriptor.sampler.handle;
+			image_info[k].imageView = (VkImageView)descriptor.view.handle;
+			image_info[k].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
+		vk.UpdateDescriptorSetWithTemplate(_orig, (VkDescriptorSet)update.table.handle, descriptor_template, image_info.p);
+		break;
+	}
+	case api::descriptor_type::texture_shader_resource_view:
+	case api::descriptor_type::texture_unordered_access_view:
+	{
+		temp_mem<VkDescriptorImageInfo> image_info(update.count);
+		for (uint32_t k = 0; k < update.count; ++k)
+		{
+			const auto &descriptor = static_cast<const api::resource_view *>(update.descriptors)[k];
+			image_info[k].sampler = VK_NULL_HANDLE;
+			image_info[k].imageView = (VkImageView)descriptor.handle;
+			image_info[k].imageLayout = (update.type == api::descriptor_type::texture_unordered_access_view) ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
+		vk.UpdateDescriptorSetWithTemplate(_orig, (VkDescriptorSet)update.table.handle, descriptor_template, image_info.p);
+		break;
+	}
+	case api::descriptor_type::buffer_shader_resource_view:
+	case api::descriptor_type::buffer_unordered_access_view:
+	case api::descriptor_type::constant_buffer:
+	case api::descriptor_type::shader_storage_buffer:
+		// The descriptor data is already laid out the way the template expects it, so no marshaling is necessary at all
+		vk.UpdateDescriptorSetWithTemplate(_orig, (VkDescriptorSet)update.table.handle, descriptor_template, update.descriptors);
+		break;
+	default:
+		assert(false);
+		return false;
+	}
+
+	return true;
+}
 
 bool reshade::vulkan::device_impl::create_query_heap(api::query_type type, uint32_t count, api::query_heap *out_heap)
 {
@@ -12,7 +12,9 @@
 #include <vk_layer_dispatch_table.h>
 
 #include "reshade_api_object_impl.hpp"
+#include <mutex>
 #include <shared_mutex>
+#include <filesystem>
 #include <unordered_map>
 
 namespace reshade::vulkan
@@ -38,7 +40,9 @@ namespace reshade::vulkan
 			bool custom_border_color_ext = false,
 			bool extended_dynamic_state_ext = false,
 			bool conservative_rasterization_ext = false,
-			bool ray_tracing_ext = false);
+			bool ray_tracing_ext = false,
+			bool graphics_pipeline_library_ext = false,
+			bool host_image_copy_ext = false);
 		~device_impl();
 
 		api::device_api get_api() const final { return api::device_api::vulkan; }
@@ -164,19 +168,53 @@ namespace reshade::vulkan
 		const bool _extended_dynamic_state_ext;
 		const bool _conservative_rasterization_ext;
 		const bool _ray_tracing_ext;
+		const bool _graphics_pipeline_library_ext;
+		const bool _host_image_copy_ext;
 		const VkPhysicalDeviceFeatures _enabled_features;
 
 	private:
 		bool create_shader_module(VkShaderStageFlagBits stage, const api::shader_desc &desc, VkPipelineShaderStageCreateInfo &stage_info, VkSpecializationInfo &spec_info, std::vector<VkSpecializationMapEntry> &spec_map);
 
+		bool update_descriptor_table_with_template(const api::descriptor_table_update &update);
+
+		VkPipelineCache open_pipeline_cache();
+
+		const VkImageView *get_mipmap_chain_views(VkImage image);
+
+		VmaPool get_memory_pool(uint32_t memory_type_index);
+
 		VmaAllocator _alloc = nullptr;
+		// Lazily created memory pools dedicated to the allocations made through this device implementation, one per memory type (see 'get_memory_pool')
+		std::mutex _memory_pool_mutex;
+		VmaPool _memory_pools[VK_MAX_MEMORY_TYPES] = {};
 		VkDescriptorPool _descriptor_pool = VK_NULL_HANDLE;
 		VkDescriptorPool _transient_descriptor_pool[4] = {};
 		uint32_t _transient_index = 0;
 
 		VkPrivateDataSlot _private_data_slot = VK_NULL_HANDLE;
 
+		// Mipmap generation states used in the 'command_list_impl::generate_mipmaps' implementation
+		VkDescriptorSetLayout _mipmap_set_layout = VK_NULL_HANDLE;
+		VkPipelineLayout _mipmap_pipeline_layout = VK_NULL_HANDLE;
+		VkPipeline _mipmap_pipeline = VK_NULL_HANDLE;
+
+		// Pipeline cache that is serialized to disk, so that pipeline compilation done for the effects of previous runs can be reused (see 'open_pipeline_cache')
+		std::mutex _pipeline_cache_mutex;
+		bool _pipeline_cache_opened = false;
+		VkPipelineCache _pipeline_cache = VK_NULL_HANDLE;
+		size_t _pipeline_cache_initial_data_size = 0;
+		std::filesystem::path _pipeline_cache_path;
+
+		// Graphics pipeline libraries containing the shader and vertex input state, which survive render target format changes, so that pipeline re-creation after a swapchain resize only has to fast-link against the new fragment output state (see 'create_pipeline')
+		std::mutex _pipeline_library_mutex;
+		std::unordered_map<size_t, VkPipeline> _pipeline_libraries;
+
+		// Shader modules deduplicated by a hash of their SPIR-V code, so that pipelines sharing the same entry points (e.g. the vertex shader shared by all passes of an effect) reuse a single module (see 'create_shader_module')
+		std::mutex _shader_module_mutex;
+		std::unordered_map<size_t, VkShaderModule> _shader_modules;
+
 		std::shared_mutex _mutex;
 		std::unordered_map<size_t, VkRenderPassBeginInfo> _render_pass_lookup;
+		std::unordered_map<size_t, VkDescriptorUpdateTemplate> _descriptor_template_lookup;
 	};
 }
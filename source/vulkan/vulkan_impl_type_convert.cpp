@@ -7,466 +7,433 @@
 #include "vulkan_impl_device.hpp"
 #include "vulkan_impl_type_convert.hpp"
 #include <algorithm> // std::copy_n, std::fill_n, std::find_if
+#include <array> // Used for static lookup tables
+#ifdef _MSC_VER
+	#include <intrin.h> // _BitScanForward
+#endif
+
+static inline unsigned int first_bit_set(unsigned int mask)
+{
+	assert(mask != 0);
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+// The 'api::format' values mirror DXGI_FORMAT ordinals, so all formats in that dense range can be converted with a bounds check and an indexed load from a lookup table generated at compile time (FourCC-based formats outside that range are handled separately in 'convert_format')
+static constexpr auto s_format_to_vk_format_lookup = []() {
+	using reshade::api::format;
+	std::array<VkFormat, static_cast<uint32_t>(format::b4g4r4a4_unorm) + 1> lookup = {}; // Formats not assigned below translate to 'VK_FORMAT_UNDEFINED'
+	lookup[static_cast<uint32_t>(format::a8_unorm)] = VK_FORMAT_R8_UNORM;
+	lookup[static_cast<uint32_t>(format::r8_typeless)] = VK_FORMAT_R8_UNORM;
+	lookup[static_cast<uint32_t>(format::r8_uint)] = VK_FORMAT_R8_UINT;
+	lookup[static_cast<uint32_t>(format::r8_sint)] = VK_FORMAT_R8_SINT;
+	lookup[static_cast<uint32_t>(format::r8_unorm)] = VK_FORMAT_R8_UNORM;
+	lookup[static_cast<uint32_t>(format::r8_snorm)] = VK_FORMAT_R8_SNORM;
+	lookup[static_cast<uint32_t>(format::r8g8_typeless)] = VK_FORMAT_R8G8_UNORM;
+	lookup[static_cast<uint32_t>(format::r8g8_uint)] = VK_FORMAT_R8G8_UINT;
+	lookup[static_cast<uint32_t>(format::r8g8_sint)] = VK_FORMAT_R8G8_SINT;
+	lookup[static_cast<uint32_t>(format::r8g8_unorm)] = VK_FORMAT_R8G8_UNORM;
+	lookup[static_cast<uint32_t>(format::r8g8_snorm)] = VK_FORMAT_R8G8_SNORM;
+	lookup[static_cast<uint32_t>(format::r8g8b8a8_typeless)] = VK_FORMAT_R8G8B8A8_UNORM;
+	lookup[static_cast<uint32_t>(format::r8g8b8a8_uint)] = VK_FORMAT_R8G8B8A8_UINT;
+	lookup[static_cast<uint32_t>(format::r8g8b8a8_sint)] = VK_FORMAT_R8G8B8A8_SINT;
+	lookup[static_cast<uint32_t>(format::r8g8b8a8_unorm)] = VK_FORMAT_R8G8B8A8_UNORM;
+	lookup[static_cast<uint32_t>(format::r8g8b8a8_unorm_srgb)] = VK_FORMAT_R8G8B8A8_SRGB;
+	lookup[static_cast<uint32_t>(format::r8g8b8a8_snorm)] = VK_FORMAT_R8G8B8A8_SNORM;
+	lookup[static_cast<uint32_t>(format::b8g8r8a8_typeless)] = VK_FORMAT_B8G8R8A8_UNORM;
+	lookup[static_cast<uint32_t>(format::b8g8r8a8_unorm)] = VK_FORMAT_B8G8R8A8_UNORM;
+	lookup[static_cast<uint32_t>(format::b8g8r8a8_unorm_srgb)] = VK_FORMAT_B8G8R8A8_SRGB;
+	lookup[static_cast<uint32_t>(format::b8g8r8x8_typeless)] = VK_FORMAT_B8G8R8A8_UNORM;
+	lookup[static_cast<uint32_t>(format::b8g8r8x8_unorm)] = VK_FORMAT_B8G8R8A8_UNORM;
+	lookup[static_cast<uint32_t>(format::b8g8r8x8_unorm_srgb)] = VK_FORMAT_B8G8R8A8_SRGB;
+	lookup[static_cast<uint32_t>(format::r10g10b10a2_typeless)] = VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+	lookup[static_cast<uint32_t>(format::r10g10b10a2_uint)] = VK_FORMAT_A2B10G10R10_UINT_PACK32;
+	lookup[static_cast<uint32_t>(format::r10g10b10a2_unorm)] = VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+	lookup[static_cast<uint32_t>(format::r16_typeless)] = VK_FORMAT_R16_SFLOAT;
+	lookup[static_cast<uint32_t>(format::r16_uint)] = VK_FORMAT_R16_UINT;
+	lookup[static_cast<uint32_t>(format::r16_sint)] = VK_FORMAT_R16_SINT;
+	lookup[static_cast<uint32_t>(format::r16_unorm)] = VK_FORMAT_R16_UNORM;
+	lookup[static_cast<uint32_t>(format::r16_snorm)] = VK_FORMAT_R16_SNORM;
+	lookup[static_cast<uint32_t>(format::r16_float)] = VK_FORMAT_R16_SFLOAT;
+	lookup[static_cast<uint32_t>(format::r16g16_typeless)] = VK_FORMAT_R16G16_SFLOAT;
+	lookup[static_cast<uint32_t>(format::r16g16_uint)] = VK_FORMAT_R16G16_UINT;
+	lookup[static_cast<uint32_t>(format::r16g16_sint)] = VK_FORMAT_R16G16_SINT;
+	lookup[static_cast<uint32_t>(format::r16g16_unorm)] = VK_FORMAT_R16G16_UNORM;
+	lookup[static_cast<uint32_t>(format::r16g16_snorm)] = VK_FORMAT_R16G16_SNORM;
+	lookup[static_cast<uint32_t>(format::r16g16_float)] = VK_FORMAT_R16G16_SFLOAT;
+	lookup[static_cast<uint32_t>(format::r16g16b16a16_typeless)] = VK_FORMAT_R16G16B16A16_SFLOAT;
+	lookup[static_cast<uint32_t>(format::r16g16b16a16_uint)] = VK_FORMAT_R16G16B16A16_UINT;
+	lookup[static_cast<uint32_t>(format::r16g16b16a16_sint)] = VK_FORMAT_R16G16B16A16_SINT;
+	lookup[static_cast<uint32_t>(format::r16g16b16a16_unorm)] = VK_FORMAT_R16G16B16A16_UNORM;
+	lookup[static_cast<uint32_t>(format::r16g16b16a16_snorm)] = VK_FORMAT_R16G16B16A16_SNORM;
+	lookup[static_cast<uint32_t>(format::r16g16b16a16_float)] = VK_FORMAT_R16G16B16A16_SFLOAT;
+	lookup[static_cast<uint32_t>(format::r32_typeless)] = VK_FORMAT_R32_SFLOAT;
+	lookup[static_cast<uint32_t>(format::r32_uint)] = VK_FORMAT_R32_UINT;
+	lookup[static_cast<uint32_t>(format::r32_sint)] = VK_FORMAT_R32_SINT;
+	lookup[static_cast<uint32_t>(format::r32_float)] = VK_FORMAT_R32_SFLOAT;
+	lookup[static_cast<uint32_t>(format::r32g32_typeless)] = VK_FORMAT_R32G32_SFLOAT;
+	lookup[static_cast<uint32_t>(format::r32g32_uint)] = VK_FORMAT_R32G32_UINT;
+	lookup[static_cast<uint32_t>(format::r32g32_sint)] = VK_FORMAT_R32G32_SINT;
+	lookup[static_cast<uint32_t>(format::r32g32_float)] = VK_FORMAT_R32G32_SFLOAT;
+	lookup[static_cast<uint32_t>(format::r32g32b32_typeless)] = VK_FORMAT_R32G32B32_SFLOAT;
+	lookup[static_cast<uint32_t>(format::r32g32b32_uint)] = VK_FORMAT_R32G32B32_UINT;
+	lookup[static_cast<uint32_t>(format::r32g32b32_sint)] = VK_FORMAT_R32G32B32_SINT;
+	lookup[static_cast<uint32_t>(format::r32g32b32_float)] = VK_FORMAT_R32G32B32_SFLOAT;
+	lookup[static_cast<uint32_t>(format::r32g32b32a32_typeless)] = VK_FORMAT_R32G32B32A32_SFLOAT;
+	lookup[static_cast<uint32_t>(format::r32g32b32a32_uint)] = VK_FORMAT_R32G32B32A32_UINT;
+	lookup[static_cast<uint32_t>(format::r32g32b32a32_sint)] = VK_FORMAT_R32G32B32A32_SINT;
+	lookup[static_cast<uint32_t>(format::r32g32b32a32_float)] = VK_FORMAT_R32G32B32A32_SFLOAT;
+	lookup[static_cast<uint32_t>(format::r9g9b9e5)] = VK_FORMAT_E5B9G9R9_UFLOAT_PACK32;
+	lookup[static_cast<uint32_t>(format::r11g11b10_float)] = VK_FORMAT_B10G11R11_UFLOAT_PACK32;
+	lookup[static_cast<uint32_t>(format::b5g6r5_unorm)] = VK_FORMAT_R5G6B5_UNORM_PACK16;
+	lookup[static_cast<uint32_t>(format::b5g5r5a1_unorm)] = VK_FORMAT_A1R5G5B5_UNORM_PACK16;
+	lookup[static_cast<uint32_t>(format::b4g4r4a4_unorm)] = VK_FORMAT_A4R4G4B4_UNORM_PACK16;
+	lookup[static_cast<uint32_t>(format::d16_unorm)] = VK_FORMAT_D16_UNORM;
+	lookup[static_cast<uint32_t>(format::d24_unorm_s8_uint)] = VK_FORMAT_D24_UNORM_S8_UINT;
+	lookup[static_cast<uint32_t>(format::r24_g8_typeless)] = VK_FORMAT_D24_UNORM_S8_UINT;
+	lookup[static_cast<uint32_t>(format::r24_unorm_x8_uint)] = VK_FORMAT_D24_UNORM_S8_UINT;
+	lookup[static_cast<uint32_t>(format::x24_unorm_g8_uint)] = VK_FORMAT_D24_UNORM_S8_UINT;
+	lookup[static_cast<uint32_t>(format::d32_float)] = VK_FORMAT_D32_SFLOAT;
+	lookup[static_cast<uint32_t>(format::d32_float_s8_uint)] = VK_FORMAT_D32_SFLOAT_S8_UINT;
+	lookup[static_cast<uint32_t>(format::r32_g8_typeless)] = VK_FORMAT_D32_SFLOAT_S8_UINT;
+	lookup[static_cast<uint32_t>(format::r32_float_x8_uint)] = VK_FORMAT_D32_SFLOAT_S8_UINT;
+	lookup[static_cast<uint32_t>(format::x32_float_g8_uint)] = VK_FORMAT_D32_SFLOAT_S8_UINT;
+	lookup[static_cast<uint32_t>(format::bc1_typeless)] = VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc1_unorm)] = VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc1_unorm_srgb)] = VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc2_typeless)] = VK_FORMAT_BC2_UNORM_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc2_unorm)] = VK_FORMAT_BC2_UNORM_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc2_unorm_srgb)] = VK_FORMAT_BC2_SRGB_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc3_typeless)] = VK_FORMAT_BC3_UNORM_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc3_unorm)] = VK_FORMAT_BC3_UNORM_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc3_unorm_srgb)] = VK_FORMAT_BC3_SRGB_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc4_typeless)] = VK_FORMAT_BC4_UNORM_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc4_unorm)] = VK_FORMAT_BC4_UNORM_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc4_snorm)] = VK_FORMAT_BC4_SNORM_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc5_typeless)] = VK_FORMAT_BC5_UNORM_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc5_unorm)] = VK_FORMAT_BC5_UNORM_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc5_snorm)] = VK_FORMAT_BC5_SNORM_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc6h_typeless)] = VK_FORMAT_BC6H_UFLOAT_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc6h_ufloat)] = VK_FORMAT_BC6H_UFLOAT_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc6h_sfloat)] = VK_FORMAT_BC6H_SFLOAT_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc7_typeless)] = VK_FORMAT_BC7_UNORM_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc7_unorm)] = VK_FORMAT_BC7_UNORM_BLOCK;
+	lookup[static_cast<uint32_t>(format::bc7_unorm_srgb)] = VK_FORMAT_BC7_SRGB_BLOCK;
+	lookup[static_cast<uint32_t>(format::r8g8_b8g8_unorm)] = VK_FORMAT_B8G8R8G8_422_UNORM;
+	lookup[static_cast<uint32_t>(format::g8r8_g8b8_unorm)] = VK_FORMAT_G8B8G8R8_422_UNORM;
+	return lookup;
+}();
+// The same applies in the opposite direction, since the relevant Vulkan format values are dense as well (promoted extension formats with values outside that range are again handled separately)
+static constexpr auto s_vk_format_to_format_lookup = []() {
+	using reshade::api::format;
+	std::array<format, VK_FORMAT_BC7_SRGB_BLOCK + 1> lookup = {}; // Formats not assigned below translate to 'api::format::unknown'
+	lookup[VK_FORMAT_R8_UINT] = format::r8_uint;
+	lookup[VK_FORMAT_R8_SINT] = format::r8_sint;
+	lookup[VK_FORMAT_R8_UNORM] = format::r8_unorm;
+	lookup[VK_FORMAT_R8_SNORM] = format::r8_snorm;
+	lookup[VK_FORMAT_R8G8_UINT] = format::r8g8_uint;
+	lookup[VK_FORMAT_R8G8_SINT] = format::r8g8_sint;
+	lookup[VK_FORMAT_R8G8_UNORM] = format::r8g8_unorm;
+	lookup[VK_FORMAT_R8G8_SNORM] = format::r8g8_snorm;
+	lookup[VK_FORMAT_R8G8B8A8_UINT] = format::r8g8b8a8_uint;
+	lookup[VK_FORMAT_A8B8G8R8_UINT_PACK32] = format::r8g8b8a8_uint;
+	lookup[VK_FORMAT_R8G8B8A8_SINT] = format::r8g8b8a8_sint;
+	lookup[VK_FORMAT_A8B8G8R8_SINT_PACK32] = format::r8g8b8a8_sint;
+	lookup[VK_FORMAT_R8G8B8A8_UNORM] = format::r8g8b8a8_unorm;
+	lookup[VK_FORMAT_A8B8G8R8_UNORM_PACK32] = format::r8g8b8a8_unorm;
+	lookup[VK_FORMAT_R8G8B8A8_SRGB] = format::r8g8b8a8_unorm_srgb;
+	lookup[VK_FORMAT_A8B8G8R8_SRGB_PACK32] = format::r8g8b8a8_unorm_srgb;
+	lookup[VK_FORMAT_R8G8B8A8_SNORM] = format::r8g8b8a8_snorm;
+	lookup[VK_FORMAT_A8B8G8R8_SNORM_PACK32] = format::r8g8b8a8_snorm;
+	lookup[VK_FORMAT_B8G8R8A8_UNORM] = format::b8g8r8a8_unorm;
+	lookup[VK_FORMAT_B8G8R8A8_SRGB] = format::b8g8r8a8_unorm_srgb;
+	lookup[VK_FORMAT_A2B10G10R10_UINT_PACK32] = format::r10g10b10a2_uint;
+	lookup[VK_FORMAT_A2B10G10R10_UNORM_PACK32] = format::r10g10b10a2_unorm;
+	lookup[VK_FORMAT_A2R10G10B10_UINT_PACK32] = format::b10g10r10a2_uint;
+	lookup[VK_FORMAT_A2R10G10B10_UNORM_PACK32] = format::b10g10r10a2_unorm;
+	lookup[VK_FORMAT_R16_UINT] = format::r16_uint;
+	lookup[VK_FORMAT_R16_SINT] = format::r16_sint;
+	lookup[VK_FORMAT_R16_UNORM] = format::r16_unorm;
+	lookup[VK_FORMAT_R16_SNORM] = format::r16_snorm;
+	lookup[VK_FORMAT_R16_SFLOAT] = format::r16_float;
+	lookup[VK_FORMAT_R16G16_UINT] = format::r16g16_uint;
+	lookup[VK_FORMAT_R16G16_SINT] = format::r16g16_sint;
+	lookup[VK_FORMAT_R16G16_UNORM] = format::r16g16_unorm;
+	lookup[VK_FORMAT_R16G16_SNORM] = format::r16g16_snorm;
+	lookup[VK_FORMAT_R16G16_SFLOAT] = format::r16g16_float;
+	lookup[VK_FORMAT_R16G16B16A16_UINT] = format::r16g16b16a16_uint;
+	lookup[VK_FORMAT_R16G16B16A16_SINT] = format::r16g16b16a16_sint;
+	lookup[VK_FORMAT_R16G16B16A16_UNORM] = format::r16g16b16a16_unorm;
+	lookup[VK_FORMAT_R16G16B16A16_SNORM] = format::r16g16b16a16_snorm;
+	lookup[VK_FORMAT_R16G16B16A16_SFLOAT] = format::r16g16b16a16_float;
+	lookup[VK_FORMAT_R32_UINT] = format::r32_uint;
+	lookup[VK_FORMAT_R32_SINT] = format::r32_sint;
+	lookup[VK_FORMAT_R32_SFLOAT] = format::r32_float;
+	lookup[VK_FORMAT_R32G32_UINT] = format::r32g32_uint;
+	lookup[VK_FORMAT_R32G32_SINT] = format::r32g32_sint;
+	lookup[VK_FORMAT_R32G32_SFLOAT] = format::r32g32_float;
+	lookup[VK_FORMAT_R32G32B32_UINT] = format::r32g32b32_uint;
+	lookup[VK_FORMAT_R32G32B32_SINT] = format::r32g32b32_sint;
+	lookup[VK_FORMAT_R32G32B32_SFLOAT] = format::r32g32b32_float;
+	lookup[VK_FORMAT_R32G32B32A32_UINT] = format::r32g32b32a32_uint;
+	lookup[VK_FORMAT_R32G32B32A32_SINT] = format::r32g32b32a32_sint;
+	lookup[VK_FORMAT_R32G32B32A32_SFLOAT] = format::r32g32b32a32_float;
+	lookup[VK_FORMAT_E5B9G9R9_UFLOAT_PACK32] = format::r9g9b9e5;
+	lookup[VK_FORMAT_B10G11R11_UFLOAT_PACK32] = format::r11g11b10_float;
+	lookup[VK_FORMAT_R5G6B5_UNORM_PACK16] = format::b5g6r5_unorm;
+	lookup[VK_FORMAT_A1R5G5B5_UNORM_PACK16] = format::b5g5r5a1_unorm;
+	lookup[VK_FORMAT_D16_UNORM] = format::d16_unorm;
+	lookup[VK_FORMAT_X8_D24_UNORM_PACK32] = format::d24_unorm_x8_uint;
+	lookup[VK_FORMAT_S8_UINT] = format::s8_uint;
+	lookup[VK_FORMAT_D16_UNORM_S8_UINT] = format::d16_unorm_s8_uint;
+	lookup[VK_FORMAT_D24_UNORM_S8_UINT] = format::d24_unorm_s8_uint;
+	lookup[VK_FORMAT_D32_SFLOAT] = format::d32_float;
+	lookup[VK_FORMAT_D32_SFLOAT_S8_UINT] = format::d32_float_s8_uint;
+	lookup[VK_FORMAT_BC1_RGBA_UNORM_BLOCK] = format::bc1_unorm;
+	lookup[VK_FORMAT_BC1_RGBA_SRGB_BLOCK] = format::bc1_unorm_srgb;
+	lookup[VK_FORMAT_BC2_UNORM_BLOCK] = format::bc2_unorm;
+	lookup[VK_FORMAT_BC2_SRGB_BLOCK] = format::bc2_unorm_srgb;
+	lookup[VK_FORMAT_BC3_UNORM_BLOCK] = format::bc3_unorm;
+	lookup[VK_FORMAT_BC3_SRGB_BLOCK] = format::bc3_unorm_srgb;
+	lookup[VK_FORMAT_BC4_UNORM_BLOCK] = format::bc4_unorm;
+	lookup[VK_FORMAT_BC4_SNORM_BLOCK] = format::bc4_snorm;
+	lookup[VK_FORMAT_BC5_UNORM_BLOCK] = format::bc5_unorm;
+	lookup[VK_FORMAT_BC5_SNORM_BLOCK] = format::bc5_snorm;
+	lookup[VK_FORMAT_BC6H_UFLOAT_BLOCK] = format::bc6h_ufloat;
+	lookup[VK_FORMAT_BC6H_SFLOAT_BLOCK] = format::bc6h_sfloat;
+	lookup[VK_FORMAT_BC7_UNORM_BLOCK] = format::bc7_unorm;
+	lookup[VK_FORMAT_BC7_SRGB_BLOCK] = format::bc7_unorm_srgb;
+	return lookup;
+}();
+
+// Translate between 'api::resource_usage' flags and Vulkan access flags with per-bit lookup tables as well, rather than a long chain of conditional bit tests
+static constexpr auto s_usage_to_access_lookup = []() {
+	using reshade::api::resource_usage;
+	const auto bit_index = [](resource_usage usage) {
+		unsigned int index = 0;
+		for (uint32_t value = static_cast<uint32_t>(usage); (value >>= 1) != 0;)
+			++index;
+		return index;
+	};
+	std::array<VkAccessFlags, 32> lookup = {};
+	lookup[bit_index(resource_usage::vertex_buffer)] = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+	lookup[bit_index(resource_usage::index_buffer)] = VK_ACCESS_INDEX_READ_BIT;
+	lookup[bit_index(resource_usage::constant_buffer)] = VK_ACCESS_UNIFORM_READ_BIT;
+	lookup[bit_index(resource_usage::stream_output)] = VK_ACCESS_TRANSFORM_FEEDBACK_WRITE_BIT_EXT;
+	lookup[bit_index(resource_usage::indirect_argument)] = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+	lookup[bit_index(resource_usage::depth_stencil_read)] = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+	lookup[bit_index(resource_usage::depth_stencil_write)] = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	lookup[bit_index(resource_usage::render_target)] = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	lookup[bit_index(resource_usage::shader_resource_pixel)] = VK_ACCESS_SHADER_READ_BIT;
+	lookup[bit_index(resource_usage::shader_resource_non_pixel)] = VK_ACCESS_SHADER_READ_BIT;
+	lookup[bit_index(resource_usage::unordered_access)] = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	lookup[bit_index(resource_usage::copy_dest)] = VK_ACCESS_TRANSFER_WRITE_BIT;
+	lookup[bit_index(resource_usage::copy_source)] = VK_ACCESS_TRANSFER_READ_BIT;
+	lookup[bit_index(resource_usage::resolve_dest)] = VK_ACCESS_TRANSFER_WRITE_BIT;
+	lookup[bit_index(resource_usage::resolve_source)] = VK_ACCESS_TRANSFER_READ_BIT;
+	lookup[bit_index(resource_usage::acceleration_structure)] = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	return lookup;
+}();
+static constexpr auto s_access_to_usage_lookup = []() {
+	using reshade::api::resource_usage;
+	const auto bit_index = [](uint32_t value) {
+		unsigned int index = 0;
+		while ((value >>= 1) != 0)
+			++index;
+		return index;
+	};
+	std::array<resource_usage, 32> lookup = {};
+	lookup[bit_index(VK_ACCESS_INDIRECT_COMMAND_READ_BIT)] = resource_usage::indirect_argument;
+	lookup[bit_index(VK_ACCESS_INDEX_READ_BIT)] = resource_usage::index_buffer;
+	lookup[bit_index(VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT)] = resource_usage::vertex_buffer;
+	lookup[bit_index(VK_ACCESS_UNIFORM_READ_BIT)] = resource_usage::constant_buffer;
+	lookup[bit_index(VK_ACCESS_SHADER_READ_BIT)] = resource_usage::shader_resource;
+	lookup[bit_index(VK_ACCESS_SHADER_WRITE_BIT)] = resource_usage::unordered_access;
+	lookup[bit_index(VK_ACCESS_COLOR_ATTACHMENT_READ_BIT)] = resource_usage::render_target;
+	lookup[bit_index(VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT)] = resource_usage::render_target;
+	lookup[bit_index(VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT)] = resource_usage::depth_stencil_read;
+	lookup[bit_index(VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT)] = resource_usage::depth_stencil_write;
+	lookup[bit_index(VK_ACCESS_TRANSFER_READ_BIT)] = resource_usage::copy_source;
+	lookup[bit_index(VK_ACCESS_TRANSFER_WRITE_BIT)] = resource_usage::copy_dest;
+	lookup[bit_index(VK_ACCESS_TRANSFORM_FEEDBACK_WRITE_BIT_EXT)] = resource_usage::stream_output;
+	lookup[bit_index(VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR)] = resource_usage::acceleration_structure;
+	lookup[bit_index(VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR)] = resource_usage::acceleration_structure;
+	return lookup;
+}();
 
 auto reshade::vulkan::convert_format(api::format format, VkComponentMapping *components) -> VkFormat
 {
-	switch (format)
+	if (components != nullptr)
 	{
-	default:
-		assert(false);
-		[[fallthrough]];
-	case api::format::unknown:
-		break;
-	case api::format::r1_unorm:
-		break; // Unsupported
-	case api::format::l8_unorm:
-		if (components != nullptr)
+		// Only a handful of formats are emulated with a component swizzle, so handle those up front
+		switch (format)
+		{
+		case api::format::l8_unorm:
+		case api::format::l16_unorm:
 			*components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_ONE };
-		return VK_FORMAT_R8_UNORM;
-	case api::format::a8_unorm:
-		if (components != nullptr)
+			break;
+		case api::format::a8_unorm:
 			*components = { VK_COMPONENT_SWIZZLE_ZERO, VK_COMPONENT_SWIZZLE_ZERO, VK_COMPONENT_SWIZZLE_ZERO, VK_COMPONENT_SWIZZLE_R };
+			break;
+		case api::format::l8a8_unorm:
+		case api::format::l16a16_unorm:
+			*components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G };
+			break;
+		case api::format::r8g8b8x8_unorm:
+		case api::format::r8g8b8x8_unorm_srgb:
+		case api::format::b8g8r8x8_typeless:
+		case api::format::b8g8r8x8_unorm:
+		case api::format::b8g8r8x8_unorm_srgb:
+		case api::format::b5g5r5x1_unorm:
+			*components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_ONE };
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (const uint32_t format_index = static_cast<uint32_t>(format);
+		format_index < s_format_to_vk_format_lookup.size())
+		return s_format_to_vk_format_lookup[format_index];
+
+	switch (format)
+	{
+	case api::format::l8_unorm:
 		return VK_FORMAT_R8_UNORM;
-	case api::format::r8_uint:
-		return VK_FORMAT_R8_UINT;
-	case api::format::r8_sint:
-		return VK_FORMAT_R8_SINT;
-	case api::format::r8_typeless:
-	case api::format::r8_unorm:
-		return VK_FORMAT_R8_UNORM;
-	case api::format::r8_snorm:
-		return VK_FORMAT_R8_SNORM;
 	case api::format::l8a8_unorm:
-		if (components != nullptr)
-			*components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G };
-		return VK_FORMAT_R8G8_UNORM;
-	case api::format::r8g8_uint:
-		return VK_FORMAT_R8G8_UINT;
-	case api::format::r8g8_sint:
-		return VK_FORMAT_R8G8_SINT;
-	case api::format::r8g8_typeless:
-	case api::format::r8g8_unorm:
 		return VK_FORMAT_R8G8_UNORM;
-	case api::format::r8g8_snorm:
-		return VK_FORMAT_R8G8_SNORM;
-	case api::format::r8g8b8a8_uint:
-		return VK_FORMAT_R8G8B8A8_UINT;
-	case api::format::r8g8b8a8_sint:
-		return VK_FORMAT_R8G8B8A8_SINT;
 	case api::format::r8g8b8x8_unorm:
-		if (components != nullptr)
-			*components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_ONE };
-		[[fallthrough]];
-	case api::format::r8g8b8a8_typeless:
-	case api::format::r8g8b8a8_unorm:
 		return VK_FORMAT_R8G8B8A8_UNORM;
 	case api::format::r8g8b8x8_unorm_srgb:
-		if (components != nullptr)
-			*components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_ONE };
-		[[fallthrough]];
-	case api::format::r8g8b8a8_unorm_srgb:
 		return VK_FORMAT_R8G8B8A8_SRGB;
-	case api::format::r8g8b8a8_snorm:
-		return VK_FORMAT_R8G8B8A8_SNORM;
-	case api::format::b8g8r8x8_typeless:
-	case api::format::b8g8r8x8_unorm:
-		if (components != nullptr)
-			*components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_ONE };
-		[[fallthrough]];
-	case api::format::b8g8r8a8_typeless:
-	case api::format::b8g8r8a8_unorm:
-		return VK_FORMAT_B8G8R8A8_UNORM;
-	case api::format::b8g8r8x8_unorm_srgb:
-		if (components != nullptr)
-			*components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_ONE };
-		[[fallthrough]];
-	case api::format::b8g8r8a8_unorm_srgb:
-		return VK_FORMAT_B8G8R8A8_SRGB;
-	case api::format::r10g10b10a2_uint:
-		return VK_FORMAT_A2B10G10R10_UINT_PACK32;
-	case api::format::r10g10b10a2_typeless:
-	case api::format::r10g10b10a2_unorm:
-		return VK_FORMAT_A2B10G10R10_UNORM_PACK32;
-	case api::format::r10g10b10a2_xr_bias:
-		break; // Unsupported
 	case api::format::b10g10r10a2_uint:
 		return VK_FORMAT_A2R10G10B10_UINT_PACK32;
 	case api::format::b10g10r10a2_typeless:
 	case api::format::b10g10r10a2_unorm:
 		return VK_FORMAT_A2R10G10B10_UNORM_PACK32;
 	case api::format::l16_unorm:
-		if (components != nullptr)
-			*components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_ONE };
 		return VK_FORMAT_R16_UNORM;
-	case api::format::r16_uint:
-		return VK_FORMAT_R16_UINT;
-	case api::format::r16_sint:
-		return VK_FORMAT_R16_SINT;
-	case api::format::r16_unorm:
-		return VK_FORMAT_R16_UNORM;
-	case api::format::r16_snorm:
-		return VK_FORMAT_R16_SNORM;
-	case api::format::r16_typeless:
-	case api::format::r16_float:
-		return VK_FORMAT_R16_SFLOAT;
 	case api::format::l16a16_unorm:
-		if (components != nullptr)
-			*components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G };
-		return VK_FORMAT_R16G16_UNORM;
-	case api::format::r16g16_uint:
-		return VK_FORMAT_R16G16_UINT;
-	case api::format::r16g16_sint:
-		return VK_FORMAT_R16G16_SINT;
-	case api::format::r16g16_unorm:
 		return VK_FORMAT_R16G16_UNORM;
-	case api::format::r16g16_snorm:
-		return VK_FORMAT_R16G16_SNORM;
-	case api::format::r16g16_typeless:
-	case api::format::r16g16_float:
-		return VK_FORMAT_R16G16_SFLOAT;
-	case api::format::r16g16b16a16_uint:
-		return VK_FORMAT_R16G16B16A16_UINT;
-	case api::format::r16g16b16a16_sint:
-		return VK_FORMAT_R16G16B16A16_SINT;
-	case api::format::r16g16b16a16_unorm:
-		return VK_FORMAT_R16G16B16A16_UNORM;
-	case api::format::r16g16b16a16_snorm:
-		return VK_FORMAT_R16G16B16A16_SNORM;
-	case api::format::r16g16b16a16_typeless:
-	case api::format::r16g16b16a16_float:
-		return VK_FORMAT_R16G16B16A16_SFLOAT;
-	case api::format::r32_uint:
-		return VK_FORMAT_R32_UINT;
-	case api::format::r32_sint:
-		return VK_FORMAT_R32_SINT;
-	case api::format::r32_typeless:
-	case api::format::r32_float:
-		return VK_FORMAT_R32_SFLOAT;
-	case api::format::r32g32_uint:
-		return VK_FORMAT_R32G32_UINT;
-	case api::format::r32g32_sint:
-		return VK_FORMAT_R32G32_SINT;
-	case api::format::r32g32_typeless:
-	case api::format::r32g32_float:
-		return VK_FORMAT_R32G32_SFLOAT;
-	case api::format::r32g32b32_uint:
-		return VK_FORMAT_R32G32B32_UINT;
-	case api::format::r32g32b32_sint:
-		return VK_FORMAT_R32G32B32_SINT;
-	case api::format::r32g32b32_typeless:
-	case api::format::r32g32b32_float:
-		return VK_FORMAT_R32G32B32_SFLOAT;
-	case api::format::r32g32b32a32_uint:
-		return VK_FORMAT_R32G32B32A32_UINT;
-	case api::format::r32g32b32a32_sint:
-		return VK_FORMAT_R32G32B32A32_SINT;
-	case api::format::r32g32b32a32_typeless:
-	case api::format::r32g32b32a32_float:
-		return VK_FORMAT_R32G32B32A32_SFLOAT;
-	case api::format::r9g9b9e5:
-		return VK_FORMAT_E5B9G9R9_UFLOAT_PACK32;
-	case api::format::r11g11b10_float:
-		return VK_FORMAT_B10G11R11_UFLOAT_PACK32;
-	case api::format::b5g6r5_unorm:
-		return VK_FORMAT_R5G6B5_UNORM_PACK16;
 	case api::format::b5g5r5x1_unorm:
-		if (components != nullptr)
-			*components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_ONE };
-		[[fallthrough]];
-	case api::format::b5g5r5a1_unorm:
 		return VK_FORMAT_A1R5G5B5_UNORM_PACK16;
-	case api::format::b4g4r4a4_unorm:
-		return VK_FORMAT_A4R4G4B4_UNORM_PACK16;
 	case api::format::a4b4g4r4_unorm:
 		return VK_FORMAT_A4B4G4R4_UNORM_PACK16;
 	case api::format::s8_uint:
 		return VK_FORMAT_S8_UINT;
-	case api::format::d16_unorm:
-		return VK_FORMAT_D16_UNORM;
 	case api::format::d16_unorm_s8_uint:
 		return VK_FORMAT_D16_UNORM_S8_UINT;
 	case api::format::d24_unorm_x8_uint:
 		return VK_FORMAT_X8_D24_UNORM_PACK32;
-	case api::format::r24_g8_typeless:
-	case api::format::r24_unorm_x8_uint:
-	case api::format::x24_unorm_g8_uint:
-	case api::format::d24_unorm_s8_uint:
-		return VK_FORMAT_D24_UNORM_S8_UINT;
-	case api::format::d32_float:
-		return VK_FORMAT_D32_SFLOAT;
-	case api::format::r32_g8_typeless:
-	case api::format::r32_float_x8_uint:
-	case api::format::x32_float_g8_uint:
-	case api::format::d32_float_s8_uint:
-		return VK_FORMAT_D32_SFLOAT_S8_UINT;
-	case api::format::bc1_typeless:
-	case api::format::bc1_unorm:
-		return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
-	case api::format::bc1_unorm_srgb:
-		return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
-	case api::format::bc2_typeless:
-	case api::format::bc2_unorm:
-		return VK_FORMAT_BC2_UNORM_BLOCK;
-	case api::format::bc2_unorm_srgb:
-		return VK_FORMAT_BC2_SRGB_BLOCK;
-	case api::format::bc3_typeless:
-	case api::format::bc3_unorm:
-		return VK_FORMAT_BC3_UNORM_BLOCK;
-	case api::format::bc3_unorm_srgb:
-		return VK_FORMAT_BC3_SRGB_BLOCK;
-	case api::format::bc4_typeless:
-	case api::format::bc4_unorm:
-		return VK_FORMAT_BC4_UNORM_BLOCK;
-	case api::format::bc4_snorm:
-		return VK_FORMAT_BC4_SNORM_BLOCK;
-	case api::format::bc5_typeless:
-	case api::format::bc5_unorm:
-		return VK_FORMAT_BC5_UNORM_BLOCK;
-	case api::format::bc5_snorm:
-		return VK_FORMAT_BC5_SNORM_BLOCK;
-	case api::format::bc6h_typeless:
-	case api::format::bc6h_ufloat:
-		return VK_FORMAT_BC6H_UFLOAT_BLOCK;
-	case api::format::bc6h_sfloat:
-		return VK_FORMAT_BC6H_SFLOAT_BLOCK;
-	case api::format::bc7_typeless:
-	case api::format::bc7_unorm:
-		return VK_FORMAT_BC7_UNORM_BLOCK;
-	case api::format::bc7_unorm_srgb:
-		return VK_FORMAT_BC7_SRGB_BLOCK;
-	case api::format::r8g8_b8g8_unorm:
-		return VK_FORMAT_B8G8R8G8_422_UNORM;
-	case api::format::g8r8_g8b8_unorm:
-		return VK_FORMAT_G8B8G8R8_422_UNORM;
+	default:
+		assert(false);
+		return VK_FORMAT_UNDEFINED;
 	}
-
-	return VK_FORMAT_UNDEFINED;
 }
 auto reshade::vulkan::convert_format(VkFormat vk_format, const VkComponentMapping *components) -> api::format
 {
+	if (components != nullptr)
+	{
+		// Check the component swizzles that are used to emulate a handful of formats Vulkan has no direct equivalent for
+		switch (vk_format)
+		{
+		case VK_FORMAT_R8_UNORM:
+			if (components->r == VK_COMPONENT_SWIZZLE_R &&
+				components->g == VK_COMPONENT_SWIZZLE_R &&
+				components->b == VK_COMPONENT_SWIZZLE_R &&
+				components->a == VK_COMPONENT_SWIZZLE_ONE)
+				return api::format::l8_unorm;
+			if (components->r == VK_COMPONENT_SWIZZLE_ZERO &&
+				components->g == VK_COMPONENT_SWIZZLE_ZERO &&
+				components->b == VK_COMPONENT_SWIZZLE_ZERO &&
+				components->a == VK_COMPONENT_SWIZZLE_R)
+				return api::format::a8_unorm;
+			break;
+		case VK_FORMAT_R8G8_UNORM:
+			if (components->r == VK_COMPONENT_SWIZZLE_R &&
+				components->g == VK_COMPONENT_SWIZZLE_R &&
+				components->b == VK_COMPONENT_SWIZZLE_R &&
+				components->a == VK_COMPONENT_SWIZZLE_G)
+				return api::format::l8a8_unorm;
+			break;
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
+			if (components->r == VK_COMPONENT_SWIZZLE_R &&
+				components->g == VK_COMPONENT_SWIZZLE_G &&
+				components->b == VK_COMPONENT_SWIZZLE_B &&
+				components->a == VK_COMPONENT_SWIZZLE_ONE)
+				return api::format::r8g8b8x8_unorm;
+			break;
+		case VK_FORMAT_R8G8B8A8_SRGB:
+		case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
+			if (components->r == VK_COMPONENT_SWIZZLE_R &&
+				components->g == VK_COMPONENT_SWIZZLE_G &&
+				components->b == VK_COMPONENT_SWIZZLE_B &&
+				components->a == VK_COMPONENT_SWIZZLE_ONE)
+				return api::format::r8g8b8x8_unorm_srgb;
+			break;
+		case VK_FORMAT_B8G8R8A8_UNORM:
+			if (components->r == VK_COMPONENT_SWIZZLE_R &&
+				components->g == VK_COMPONENT_SWIZZLE_G &&
+				components->b == VK_COMPONENT_SWIZZLE_B &&
+				components->a == VK_COMPONENT_SWIZZLE_ONE)
+				return api::format::b8g8r8x8_unorm;
+			break;
+		case VK_FORMAT_B8G8R8A8_SRGB:
+			if (components->r == VK_COMPONENT_SWIZZLE_R &&
+				components->g == VK_COMPONENT_SWIZZLE_G &&
+				components->b == VK_COMPONENT_SWIZZLE_B &&
+				components->a == VK_COMPONENT_SWIZZLE_ONE)
+				return api::format::b8g8r8x8_unorm_srgb;
+			break;
+		case VK_FORMAT_R16_UNORM:
+			if (components->r == VK_COMPONENT_SWIZZLE_R &&
+				components->g == VK_COMPONENT_SWIZZLE_R &&
+				components->b == VK_COMPONENT_SWIZZLE_R &&
+				components->a == VK_COMPONENT_SWIZZLE_ONE)
+				return api::format::l16_unorm;
+			break;
+		case VK_FORMAT_R16G16_UNORM:
+			if (components->r == VK_COMPONENT_SWIZZLE_R &&
+				components->g == VK_COMPONENT_SWIZZLE_R &&
+				components->b == VK_COMPONENT_SWIZZLE_R &&
+				components->a == VK_COMPONENT_SWIZZLE_G)
+				return api::format::l16a16_unorm;
+			break;
+		case VK_FORMAT_A1R5G5B5_UNORM_PACK16:
+			if (components->r == VK_COMPONENT_SWIZZLE_R &&
+				components->g == VK_COMPONENT_SWIZZLE_G &&
+				components->b == VK_COMPONENT_SWIZZLE_B &&
+				components->a == VK_COMPONENT_SWIZZLE_ONE)
+				return api::format::b5g5r5x1_unorm;
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (static_cast<uint32_t>(vk_format) < s_vk_format_to_format_lookup.size())
+		return s_vk_format_to_format_lookup[vk_format];
+
 	switch (vk_format)
 	{
-	default:
-	case VK_FORMAT_UNDEFINED:
-		return api::format::unknown;
-	case VK_FORMAT_R8_UINT:
-		return api::format::r8_uint;
-	case VK_FORMAT_R8_SINT:
-		return api::format::r8_sint;
-	case VK_FORMAT_R8_UNORM:
-		if (components != nullptr &&
-			components->r == VK_COMPONENT_SWIZZLE_R &&
-			components->g == VK_COMPONENT_SWIZZLE_R &&
-			components->b == VK_COMPONENT_SWIZZLE_R &&
-			components->a == VK_COMPONENT_SWIZZLE_ONE)
-			return api::format::l8_unorm;
-		if (components != nullptr &&
-			components->r == VK_COMPONENT_SWIZZLE_ZERO &&
-			components->g == VK_COMPONENT_SWIZZLE_ZERO &&
-			components->b == VK_COMPONENT_SWIZZLE_ZERO &&
-			components->a == VK_COMPONENT_SWIZZLE_R)
-			return api::format::a8_unorm;
-		return api::format::r8_unorm;
-	case VK_FORMAT_R8_SNORM:
-		return api::format::r8_snorm;
-	case VK_FORMAT_R8G8_UINT:
-		return api::format::r8g8_uint;
-	case VK_FORMAT_R8G8_SINT:
-		return api::format::r8g8_sint;
-	case VK_FORMAT_R8G8_UNORM:
-		if (components != nullptr &&
-			components->r == VK_COMPONENT_SWIZZLE_R &&
-			components->g == VK_COMPONENT_SWIZZLE_R &&
-			components->b == VK_COMPONENT_SWIZZLE_R &&
-			components->a == VK_COMPONENT_SWIZZLE_G)
-			return api::format::l8a8_unorm;
-		return api::format::r8g8_unorm;
-	case VK_FORMAT_R8G8_SNORM:
-		return api::format::r8g8_snorm;
-	case VK_FORMAT_R8G8B8A8_UINT:
-	case VK_FORMAT_A8B8G8R8_UINT_PACK32:
-		return api::format::r8g8b8a8_uint;
-	case VK_FORMAT_R8G8B8A8_SINT:
-	case VK_FORMAT_A8B8G8R8_SINT_PACK32:
-		return api::format::r8g8b8a8_sint;
-	case VK_FORMAT_R8G8B8A8_UNORM:
-	case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
-		if (components != nullptr &&
-			components->r == VK_COMPONENT_SWIZZLE_R &&
-			components->g == VK_COMPONENT_SWIZZLE_G &&
-			components->b == VK_COMPONENT_SWIZZLE_B &&
-			components->a == VK_COMPONENT_SWIZZLE_ONE)
-			return api::format::r8g8b8x8_unorm;
-		return api::format::r8g8b8a8_unorm;
-	case VK_FORMAT_R8G8B8A8_SRGB:
-	case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
-		if (components != nullptr &&
-			components->r == VK_COMPONENT_SWIZZLE_R &&
-			components->g == VK_COMPONENT_SWIZZLE_G &&
-			components->b == VK_COMPONENT_SWIZZLE_B &&
-			components->a == VK_COMPONENT_SWIZZLE_ONE)
-			return api::format::r8g8b8x8_unorm_srgb;
-		return api::format::r8g8b8a8_unorm_srgb;
-	case VK_FORMAT_R8G8B8A8_SNORM:
-	case VK_FORMAT_A8B8G8R8_SNORM_PACK32:
-		return api::format::r8g8b8a8_snorm;
-	case VK_FORMAT_B8G8R8A8_UNORM:
-		if (components != nullptr &&
-			components->r == VK_COMPONENT_SWIZZLE_R &&
-			components->g == VK_COMPONENT_SWIZZLE_G &&
-			components->b == VK_COMPONENT_SWIZZLE_B &&
-			components->a == VK_COMPONENT_SWIZZLE_ONE)
-			return api::format::b8g8r8x8_unorm;
-		return api::format::b8g8r8a8_unorm;
-	case VK_FORMAT_B8G8R8A8_SRGB:
-		if (components != nullptr &&
-			components->r == VK_COMPONENT_SWIZZLE_R &&
-			components->g == VK_COMPONENT_SWIZZLE_G &&
-			components->b == VK_COMPONENT_SWIZZLE_B &&
-			components->a == VK_COMPONENT_SWIZZLE_ONE)
-			return api::format::b8g8r8x8_unorm_srgb;
-		return api::format::b8g8r8a8_unorm_srgb;
-	case VK_FORMAT_A2B10G10R10_UINT_PACK32:
-		return api::format::r10g10b10a2_uint;
-	case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
-		return api::format::r10g10b10a2_unorm;
-	case VK_FORMAT_A2R10G10B10_UINT_PACK32:
-		return api::format::b10g10r10a2_uint;
-	case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
-		return api::format::b10g10r10a2_unorm;
-	case VK_FORMAT_R16_UINT:
-		return api::format::r16_uint;
-	case VK_FORMAT_R16_SINT:
-		return api::format::r16_sint;
-	case VK_FORMAT_R16_UNORM:
-		if (components != nullptr &&
-			components->r == VK_COMPONENT_SWIZZLE_R &&
-			components->g == VK_COMPONENT_SWIZZLE_R &&
-			components->b == VK_COMPONENT_SWIZZLE_R &&
-			components->a == VK_COMPONENT_SWIZZLE_ONE)
-			return api::format::l16_unorm;
-		return api::format::r16_unorm;
-	case VK_FORMAT_R16_SNORM:
-		return api::format::r16_snorm;
-	case VK_FORMAT_R16_SFLOAT:
-		return api::format::r16_float;
-	case VK_FORMAT_R16G16_UINT:
-		return api::format::r16g16_uint;
-	case VK_FORMAT_R16G16_SINT:
-		return api::format::r16g16_sint;
-	case VK_FORMAT_R16G16_UNORM:
-		if (components != nullptr &&
-			components->r == VK_COMPONENT_SWIZZLE_R &&
-			components->g == VK_COMPONENT_SWIZZLE_R &&
-			components->b == VK_COMPONENT_SWIZZLE_R &&
-			components->a == VK_COMPONENT_SWIZZLE_G)
-			return api::format::l16a16_unorm;
-		return api::format::r16g16_unorm;
-	case VK_FORMAT_R16G16_SNORM:
-		return api::format::r16g16_snorm;
-	case VK_FORMAT_R16G16_SFLOAT:
-		return api::format::r16g16_float;
-	case VK_FORMAT_R16G16B16A16_UINT:
-		return api::format::r16g16b16a16_uint;
-	case VK_FORMAT_R16G16B16A16_SINT:
-		return api::format::r16g16b16a16_sint;
-	case VK_FORMAT_R16G16B16A16_UNORM:
-		return api::format::r16g16b16a16_unorm;
-	case VK_FORMAT_R16G16B16A16_SNORM:
-		return api::format::r16g16b16a16_snorm;
-	case VK_FORMAT_R16G16B16A16_SFLOAT:
-		return api::format::r16g16b16a16_float;
-	case VK_FORMAT_R32_UINT:
-		return api::format::r32_uint;
-	case VK_FORMAT_R32_SINT:
-		return api::format::r32_sint;
-	case VK_FORMAT_R32_SFLOAT:
-		return api::format::r32_float;
-	case VK_FORMAT_R32G32_UINT:
-		return api::format::r32g32_uint;
-	case VK_FORMAT_R32G32_SINT:
-		return api::format::r32g32_sint;
-	case VK_FORMAT_R32G32_SFLOAT:
-		return api::format::r32g32_float;
-	case VK_FORMAT_R32G32B32_UINT:
-		return api::format::r32g32b32_uint;
-	case VK_FORMAT_R32G32B32_SINT:
-		return api::format::r32g32b32_sint;
-	case VK_FORMAT_R32G32B32_SFLOAT:
-		return api::format::r32g32b32_float;
-	case VK_FORMAT_R32G32B32A32_UINT:
-		return api::format::r32g32b32a32_uint;
-	case VK_FORMAT_R32G32B32A32_SINT:
-		return api::format::r32g32b32a32_sint;
-	case VK_FORMAT_R32G32B32A32_SFLOAT:
-		return api::format::r32g32b32a32_float;
-	case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
-		return api::format::r9g9b9e5;
-	case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
-		return api::format::r11g11b10_float;
-	case VK_FORMAT_R5G6B5_UNORM_PACK16:
-		return api::format::b5g6r5_unorm;
-	case VK_FORMAT_A1R5G5B5_UNORM_PACK16:
-		if (components != nullptr &&
-			components->r == VK_COMPONENT_SWIZZLE_R &&
-			components->g == VK_COMPONENT_SWIZZLE_G &&
-			components->b == VK_COMPONENT_SWIZZLE_B &&
-			components->a == VK_COMPONENT_SWIZZLE_ONE)
-			return api::format::b5g5r5x1_unorm;
-		return api::format::b5g5r5a1_unorm;
 	case VK_FORMAT_A4R4G4B4_UNORM_PACK16:
 		return api::format::b4g4r4a4_unorm;
 	case VK_FORMAT_A4B4G4R4_UNORM_PACK16:
 		return api::format::a4b4g4r4_unorm;
-	case VK_FORMAT_D16_UNORM:
-		return api::format::d16_unorm;
-	case VK_FORMAT_X8_D24_UNORM_PACK32:
-		return api::format::d24_unorm_x8_uint;
-	case VK_FORMAT_S8_UINT:
-		return api::format::s8_uint;
-	case VK_FORMAT_D16_UNORM_S8_UINT:
-		return api::format::d16_unorm_s8_uint;
-	case VK_FORMAT_D24_UNORM_S8_UINT:
-		return api::format::d24_unorm_s8_uint;
-	case VK_FORMAT_D32_SFLOAT:
-		return api::format::d32_float;
-	case VK_FORMAT_D32_SFLOAT_S8_UINT:
-		return api::format::d32_float_s8_uint;
-	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
-		return api::format::bc1_unorm;
-	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
-		return api::format::bc1_unorm_srgb;
-	case VK_FORMAT_BC2_UNORM_BLOCK:
-		return api::format::bc2_unorm;
-	case VK_FORMAT_BC2_SRGB_BLOCK:
-		return api::format::bc2_unorm_srgb;
-	case VK_FORMAT_BC3_UNORM_BLOCK:
-		return api::format::bc3_unorm;
-	case VK_FORMAT_BC3_SRGB_BLOCK:
-		return api::format::bc3_unorm_srgb;
-	case VK_FORMAT_BC4_UNORM_BLOCK:
-		return api::format::bc4_unorm;
-	case VK_FORMAT_BC4_SNORM_BLOCK:
-		return api::format::bc4_snorm;
-	case VK_FORMAT_BC5_UNORM_BLOCK:
-		return api::format::bc5_unorm;
-	case VK_FORMAT_BC5_SNORM_BLOCK:
-		return api::format::bc5_snorm;
-	case VK_FORMAT_BC6H_UFLOAT_BLOCK:
-		return api::format::bc6h_ufloat;
-	case VK_FORMAT_BC6H_SFLOAT_BLOCK:
-		return api::format::bc6h_sfloat;
-	case VK_FORMAT_BC7_UNORM_BLOCK:
-		return api::format::bc7_unorm;
-	case VK_FORMAT_BC7_SRGB_BLOCK:
-		return api::format::bc7_unorm_srgb;
 	case VK_FORMAT_G8B8G8R8_422_UNORM:
 		return api::format::g8r8_g8b8_unorm;
 	case VK_FORMAT_B8G8R8G8_422_UNORM:
 		return api::format::r8g8_b8g8_unorm;
+	default:
+		return api::format::unknown;
 	}
 }
-
 auto reshade::vulkan::convert_color_space(api::color_space color_space) -> VkColorSpaceKHR
 {
 	switch (color_space)
@@ -522,32 +489,9 @@ auto reshade::vulkan::convert_access_to_usage(VkAccessFlags2 flags) -> api::reso
 		VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR == VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR);
 
 	api::resource_usage result = api::resource_usage::undefined;
-	if ((flags & VK_ACCESS_INDIRECT_COMMAND_READ_BIT) != 0)
-		result |= api::resource_usage::indirect_argument;
-	if ((flags & VK_ACCESS_INDEX_READ_BIT) != 0)
-		result |= api::resource_usage::index_buffer;
-	if ((flags & VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT) != 0)
-		result |= api::resource_usage::vertex_buffer;
-	if ((flags & VK_ACCESS_UNIFORM_READ_BIT) != 0)
-		result |= api::resource_usage::constant_buffer;
-	if ((flags & VK_ACCESS_SHADER_READ_BIT) != 0)
-		result |= api::resource_usage::shader_resource;
-	if ((flags & VK_ACCESS_SHADER_WRITE_BIT) != 0)
-		result |= api::resource_usage::unordered_access;
-	if ((flags & (VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT)) != 0)
-		result |= api::resource_usage::render_target;
-	if ((flags & VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT) != 0)
-		result |= api::resource_usage::depth_stencil_read;
-	if ((flags & VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT) != 0)
-		result |= api::resource_usage::depth_stencil_write;
-	if ((flags & VK_ACCESS_TRANSFER_READ_BIT) != 0)
-		result |= api::resource_usage::copy_source;
-	if ((flags & VK_ACCESS_TRANSFER_WRITE_BIT) != 0)
-		result |= api::resource_usage::copy_dest;
-	if ((flags & VK_ACCESS_TRANSFORM_FEEDBACK_WRITE_BIT_EXT) != 0)
-		result |= api::resource_usage::stream_output;
-	if ((flags & (VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR)) != 0)
-		result |= api::resource_usage::acceleration_structure;
+	// All the translated access flags lie in the lower 32-bit of the extended access flags
+	for (uint32_t bits = static_cast<uint32_t>(flags); bits != 0; bits &= bits - 1)
+		result |= s_access_to_usage_lookup[first_bit_set(bits)];
 
 	return result;
 }
@@ -594,32 +538,8 @@ auto reshade::vulkan::convert_usage_to_access(api::resource_usage state) -> VkAc
 		return VK_ACCESS_HOST_READ_BIT | VK_ACCESS_HOST_WRITE_BIT;
 
 	VkAccessFlags result = 0;
-	if ((state & api::resource_usage::index_buffer) != 0)
-		result |= VK_ACCESS_INDEX_READ_BIT;
-	if ((state & api::resource_usage::vertex_buffer) != 0)
-		result |= VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
-	if ((state & api::resource_usage::constant_buffer) != 0)
-		result |= VK_ACCESS_UNIFORM_READ_BIT;
-	if ((state & api::resource_usage::stream_output) != 0)
-		result |= VK_ACCESS_TRANSFORM_FEEDBACK_WRITE_BIT_EXT;
-	if ((state & api::resource_usage::indirect_argument) != 0)
-		result |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
-	if ((state & api::resource_usage::depth_stencil_read) != 0)
-		result |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
-	if ((state & api::resource_usage::depth_stencil_write) != 0)
-		result |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-	if ((state & api::resource_usage::render_target) != 0)
-		result |= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-	if ((state & api::resource_usage::shader_resource) != 0)
-		result |= VK_ACCESS_SHADER_READ_BIT;
-	if ((state & api::resource_usage::unordered_access) != 0)
-		result |= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
-	if ((state & (api::resource_usage::copy_dest | api::resource_usage::resolve_dest)) != 0)
-		result |= VK_ACCESS_TRANSFER_WRITE_BIT;
-	if ((state & (api::resource_usage::copy_source | api::resource_usage::resolve_source)) != 0)
-		result |= VK_ACCESS_TRANSFER_READ_BIT;
-	if ((state & api::resource_usage::acceleration_structure) != 0)
-		result |= VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+	for (uint32_t bits = static_cast<uint32_t>(state); bits != 0; bits &= bits - 1)
+		result |= s_usage_to_access_lookup[first_bit_set(bits)];
 
 	return result;
 }
@@ -1169,7 +1089,7 @@ void reshade::vulkan::convert_resource_desc(const api::resource_desc &desc, VkIm
 	else
 		create_info.flags &= ~VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
 
-	// Mipmap generation is using 'vkCmdBlitImage' and therefore needs transfer usage flags (see 'command_list_impl::generate_mipmaps')
+	// Mipmap generation needs transfer usage flags for its 'vkCmdBlitImage' fallback path (see 'command_list_impl::generate_mipmaps')
 	if ((desc.flags & api::resource_flags::generate_mipmaps) != 0)
 		create_info.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 
@@ -35,6 +35,8 @@ namespace reshade::vulkan
 		uint64_t memory_offset = 0;
 		VkImageCreateInfo create_info;
 		VkImageView default_view = VK_NULL_HANDLE;
+		// Per-level image views used by the compute shader based mipmap generation (see 'device_impl::get_mipmap_chain_views')
+		std::vector<VkImageView> mipmap_views;
 	};
 
 	template <>
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2025 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "burst_capture.hpp"
+#include "version.h"
+#include <cstdio> // fwrite, printf
+#include <cstring> // std::strcmp
+#include <vector>
+#include <filesystem>
+#include <Windows.h>
+#include <fpng.h>
+
+static void print_usage(const char *path)
+{
+	printf(R"(usage: %s [options] <capture file>
+
+Converts a burst capture file recorded with the "Burst capture key" shortcut into individual PNG images.
+
+Options:
+  -h, --help                Print this help.
+  --version                 Print ReShade version.
+
+  -o <path>                 Output directory for the images (defaults to the directory of the capture file).
+  --keep-alpha              Keep the alpha channel instead of writing opaque images.
+)", path);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *input_path_string = nullptr;
+	const char *output_path_string = nullptr;
+	bool keep_alpha = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *const arg = argv[i];
+
+		if (arg[0] == '-')
+		{
+			if (0 == std::strcmp(arg, "-h") || 0 == std::strcmp(arg, "--help"))
+			{
+				print_usage(argv[0]);
+				return 0;
+			}
+			if (0 == std::strcmp(arg, "--version"))
+			{
+				printf("%s\n", VERSION_STRING_PRODUCT);
+				return 0;
+			}
+
+			if (0 == std::strcmp(arg, "-o") && i + 1 < argc)
+				output_path_string = argv[++i];
+			else if (0 == std::strcmp(arg, "--keep-alpha"))
+				keep_alpha = true;
+			else
+				printf("warning: Unknown command-line option '%s'\n", arg);
+		}
+		else
+		{
+			input_path_string = arg;
+		}
+	}
+
+	if (input_path_string == nullptr)
+	{
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	const std::filesystem::path input_path = std::filesystem::u8path(input_path_string);
+
+	// Map the capture file instead of reading it into memory, since it can be multiple gigabytes in size
+	const HANDLE file = CreateFileW(input_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		printf("error: Failed to open capture file '%s'\n", input_path.u8string().c_str());
+		return 1;
+	}
+
+	LARGE_INTEGER file_size = {};
+	GetFileSizeEx(file, &file_size);
+
+	const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file); // The mapping keeps its own reference to the file
+	const auto view = mapping != nullptr ? static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+	if (view == nullptr)
+	{
+		printf("error: Failed to map capture file '%s'\n", input_path.u8string().c_str());
+		return 1;
+	}
+
+	reshade::burst_capture_header header = {};
+	if (static_cast<uint64_t>(file_size.QuadPart) >= sizeof(header))
+		std::memcpy(&header, view, sizeof(header));
+
+	if (header.magic != reshade::burst_capture_header::signature ||
+		header.version != reshade::burst_capture_header::latest_version ||
+		header.frame_capacity == 0 ||
+		header.frame_size != uint64_t(header.width) * header.height * 4 ||
+		static_cast<uint64_t>(file_size.QuadPart) < sizeof(header) + header.frame_capacity * (sizeof(uint64_t) + uint64_t(header.frame_size)))
+	{
+		printf("error: '%s' is not a valid capture file\n", input_path.u8string().c_str());
+		return 1;
+	}
+
+	const auto timestamps = reinterpret_cast<const uint64_t *>(view + sizeof(header));
+	const uint8_t *const frame_data = view + sizeof(header) + header.frame_capacity * sizeof(uint64_t);
+
+	const std::filesystem::path output_path = output_path_string != nullptr ? std::filesystem::u8path(output_path_string) : input_path.parent_path();
+
+	std::error_code ec;
+	std::filesystem::create_directories(output_path, ec);
+
+	fpng::fpng_init();
+
+	// When the ring wrapped around, the oldest frame is in the slot the next frame would have been written to
+	const uint32_t frame_count = header.frame_count < header.frame_capacity ? header.frame_count : header.frame_capacity;
+	const uint32_t first_frame = header.frame_count - frame_count;
+
+	std::vector<uint8_t> pixels;
+	std::vector<uint8_t> encoded_data;
+
+	for (uint32_t i = 0; i < frame_count; ++i)
+	{
+		const uint32_t slot = (first_frame + i) % header.frame_capacity;
+		const uint8_t *frame = frame_data + uint64_t(slot) * header.frame_size;
+
+		if (!keep_alpha)
+		{
+			// Replace the alpha channel with full opacity, since back buffer contents commonly contain meaningless alpha values
+			pixels.assign(frame, frame + header.frame_size);
+			for (size_t pixel_offset = 3; pixel_offset < pixels.size(); pixel_offset += 4)
+				pixels[pixel_offset] = 0xFF;
+			frame = pixels.data();
+		}
+
+		encoded_data.clear();
+		if (!fpng::fpng_encode_image_to_memory(frame, header.width, header.height, 4, encoded_data))
+		{
+			printf("error: Failed to encode frame %u\n", i);
+			return 1;
+		}
+
+		char frame_name[64];
+		std::snprintf(frame_name, sizeof(frame_name), "_%04u.png", i);
+
+		std::filesystem::path frame_path = output_path / input_path.stem();
+		frame_path += frame_name;
+
+		bool write_success = false;
+		if (FILE *const frame_file = _wfsopen(frame_path.c_str(), L"wb", SH_DENYNO))
+		{
+			write_success = fwrite(encoded_data.data(), 1, encoded_data.size(), frame_file) == encoded_data.size();
+			fclose(frame_file);
+		}
+
+		if (!write_success)
+		{
+			printf("error: Failed to write '%s'\n", frame_path.u8string().c_str());
+			return 1;
+		}
+	}
+
+	if (frame_count > 1 && header.ticks_per_second != 0)
+	{
+		const uint64_t first_time = timestamps[first_frame % header.frame_capacity];
+		const uint64_t last_time = timestamps[(first_frame + frame_count - 1) % header.frame_capacity];
+		const double duration = static_cast<double>(last_time - first_time) / static_cast<double>(header.ticks_per_second);
+
+		printf("Wrote %u frames (%ux%u, %.1f fps average) to '%s'\n", frame_count, header.width, header.height, duration != 0 ? (frame_count - 1) / duration : 0.0, output_path.u8string().c_str());
+	}
+	else
+	{
+		printf("Wrote %u frames (%ux%u) to '%s'\n", frame_count, header.width, header.height, output_path.u8string().c_str());
+	}
+
+	return 0;
+}
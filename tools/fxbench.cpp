@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2025 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "effect_lexer.hpp"
+#include "effect_parser.hpp"
+#include "effect_codegen.hpp"
+#include "effect_preprocessor.hpp"
+#include "version.h"
+#include <cstdio>
+#include <cstdlib> // std::malloc, std::free, std::strtoul
+#include <cstring> // std::strcmp
+#include <malloc.h> // _msize
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm> // std::max, std::min
+#include <filesystem>
+
+// Track heap usage of the compiler stages by routing all allocations through the global 'operator new'
+static std::atomic<size_t> s_current_allocated = { 0 };
+static std::atomic<size_t> s_peak_allocated = { 0 };
+
+void *operator new(size_t size)
+{
+	void *const p = std::malloc(size);
+	if (p == nullptr)
+		std::abort();
+	const size_t current = s_current_allocated.fetch_add(_msize(p)) + _msize(p);
+	size_t peak = s_peak_allocated.load();
+	while (current > peak && !s_peak_allocated.compare_exchange_weak(peak, current))
+		continue;
+	return p;
+}
+void operator delete(void *p) noexcept
+{
+	if (p == nullptr)
+		return;
+	s_current_allocated.fetch_sub(_msize(p));
+	std::free(p);
+}
+void operator delete(void *p, size_t) noexcept
+{
+	operator delete(p);
+}
+
+struct stage_result
+{
+	double best_time_ms = 0.0;
+	size_t peak_allocated = 0;
+	size_t output_size = 0;
+};
+
+template <typename F>
+static stage_result measure_stage(unsigned int runs, F &&stage)
+{
+	stage_result result;
+	result.best_time_ms = 1e30;
+
+	for (unsigned int run = 0; run < runs; ++run)
+	{
+		s_peak_allocated = s_current_allocated.load();
+
+		const auto time_begin = std::chrono::high_resolution_clock::now();
+		const size_t output_size = stage();
+		const auto time_end = std::chrono::high_resolution_clock::now();
+
+		result.best_time_ms = std::min(result.best_time_ms, std::chrono::duration_cast<std::chrono::nanoseconds>(time_end - time_begin).count() * 1e-6);
+		result.peak_allocated = std::max(result.peak_allocated, s_peak_allocated.load() - s_current_allocated.load());
+		result.output_size = output_size;
+	}
+
+	return result;
+}
+
+static void print_stage(const char *name, const stage_result &result)
+{
+	printf("  %-18s %10.3f ms %10.1f KiB peak %10zu out\n", name, result.best_time_ms, result.peak_allocated / 1024.0, result.output_size);
+}
+
+static bool benchmark_file(const char *name, std::string source, const std::filesystem::path &path, unsigned int runs, unsigned int shader_model)
+{
+	const auto create_preprocessor = [&]() {
+		reshadefx::preprocessor pp;
+		pp.add_macro_definition("__RESHADE__", std::to_string(VERSION_MAJOR * 10000 + VERSION_MINOR * 100 + VERSION_REVISION));
+		pp.add_macro_definition("__RESHADE_PERFORMANCE_MODE__", "0");
+		pp.add_macro_definition("BUFFER_WIDTH", "1920");
+		pp.add_macro_definition("BUFFER_HEIGHT", "1080");
+		pp.add_macro_definition("BUFFER_RCP_WIDTH", "(1.0 / BUFFER_WIDTH)");
+		pp.add_macro_definition("BUFFER_RCP_HEIGHT", "(1.0 / BUFFER_HEIGHT)");
+		pp.add_macro_definition("BUFFER_COLOR_BIT_DEPTH", "8");
+		if (!path.empty())
+			pp.add_include_path(path.parent_path());
+		return pp;
+	};
+
+	// Run the preprocessor once up front to get the input for the later stages (and to report errors before timing anything)
+	std::string preprocessed;
+	{
+		reshadefx::preprocessor pp = create_preprocessor();
+		if (!source.empty() ? !pp.append_string(source, "synthetic.fx") : !pp.append_file(path))
+		{
+			printf("%s: skipped (preprocessing failed)\n%s\n", name, pp.errors().c_str());
+			return false;
+		}
+		preprocessed = pp.output();
+	}
+
+	printf("%s (%zu bytes preprocessed):\n", name, preprocessed.size());
+
+	print_stage("preprocess", measure_stage(runs, [&]() {
+		reshadefx::preprocessor pp = create_preprocessor();
+		if (!path.empty())
+			pp.append_file(path);
+		else
+			pp.append_string(source, "synthetic.fx");
+		return pp.output().size();
+	}));
+
+	print_stage("lex", measure_stage(runs, [&]() {
+		reshadefx::lexer lexer(preprocessed);
+		size_t num_tokens = 0;
+		while (lexer.lex().id != reshadefx::tokenid::end_of_file)
+			++num_tokens;
+		return num_tokens;
+	}));
+
+	const std::pair<const char *, reshadefx::codegen *(*)(unsigned int)> backends[] = {
+		{ "hlsl", [](unsigned int shader_model) { return reshadefx::create_codegen_hlsl(shader_model, false, false); } },
+		{ "glsl", [](unsigned int) { return reshadefx::create_codegen_glsl(false, false, false, false); } },
+		{ "spirv", [](unsigned int) { return reshadefx::create_codegen_spirv(true, false, false, false); } },
+	};
+
+	for (const auto &[backend_name, create_backend] : backends)
+	{
+		std::unique_ptr<reshadefx::codegen> backend;
+
+		char stage_name[32];
+		std::snprintf(stage_name, sizeof(stage_name), "parse (%s)", backend_name);
+
+		print_stage(stage_name, measure_stage(runs, [&]() {
+			backend.reset(create_backend(shader_model));
+			reshadefx::parser parser;
+			if (!parser.parse(preprocessed, backend.get()))
+				printf("%s\n", parser.errors().c_str());
+			return backend->module().entry_points.size();
+		}));
+
+		std::snprintf(stage_name, sizeof(stage_name), "finalize (%s)", backend_name);
+
+		print_stage(stage_name, measure_stage(runs, [&]() {
+			return backend->finalize_code().size();
+		}));
+	}
+
+	return true;
+}
+
+// Generate a synthetic effect file with the specified number of functions and techniques, so the benchmark can run without an external corpus
+static std::string generate_synthetic_effect(unsigned int num_functions, unsigned int num_techniques)
+{
+	std::string source;
+	source +=
+		"uniform float2 PixelSize < ui_type = \"drag\"; > = float2(BUFFER_RCP_WIDTH, BUFFER_RCP_HEIGHT);\n"
+		"uniform int FrameCount < source = \"framecount\"; >;\n"
+		"texture BackBufferTex : COLOR;\n"
+		"sampler BackBuffer { Texture = BackBufferTex; };\n"
+		"void PostProcessVS(in uint id : SV_VertexID, out float4 pos : SV_Position, out float2 texcoord : TEXCOORD)\n"
+		"{\n"
+		"	texcoord.x = (id == 2) ? 2.0 : 0.0;\n"
+		"	texcoord.y = (id == 1) ? 2.0 : 0.0;\n"
+		"	pos = float4(texcoord * float2(2.0, -2.0) + float2(-1.0, 1.0), 0.0, 1.0);\n"
+		"}\n";
+
+	for (unsigned int i = 0; i < num_functions; ++i)
+	{
+		const std::string index = std::to_string(i);
+		source +=
+			"float3 Filter" + index + "(float2 texcoord)\n"
+			"{\n"
+			"	float3 color = 0.0;\n"
+			"	[unroll]\n"
+			"	for (int x = -2; x <= 2; ++x)\n"
+			"		for (int y = -2; y <= 2; ++y)\n"
+			"			color += tex2Dlod(BackBuffer, float4(texcoord + float2(x, y) * PixelSize * " + std::to_string(1 + i % 7) + ".0, 0.0, 0.0)).rgb * (1.0 / 25.0);\n"
+			"	return lerp(color, saturate(color * color * (3.0 - 2.0 * color)), " + std::to_string((i % 10) * 0.1) + ");\n"
+			"}\n";
+	}
+
+	for (unsigned int i = 0; i < num_techniques; ++i)
+	{
+		const std::string index = std::to_string(i);
+		source +=
+			"float4 MainPS" + index + "(float4 pos : SV_Position, float2 texcoord : TEXCOORD) : SV_Target\n"
+			"{\n"
+			"	return float4(Filter" + std::to_string(i % num_functions) + "(texcoord), 1.0);\n"
+			"}\n"
+			"technique Synthetic" + index + "\n"
+			"{\n"
+			"	pass { VertexShader = PostProcessVS; PixelShader = MainPS" + index + "; }\n"
+			"}\n";
+	}
+
+	return source;
+}
+
+static void print_usage(const char *path)
+{
+	printf(R"(usage: %s [options] [<filename or directory> ...]
+
+Runs each ReShade FX compiler stage (preprocess, lex, parse and code
+generation per backend) in isolation over the specified effect files and
+reports the best wall time, peak heap allocation and output size per stage.
+When no input is specified, a built-in synthetic corpus of small, medium and
+large effect files is used instead.
+
+Options:
+  -h, --help                Print this help.
+  --version                 Print ReShade version.
+
+  --runs <value>            Number of times to repeat each stage (defaults to 5).
+  --shader-model <value>    HLSL shader model version. Can be 30, 40, 41, 50, ...
+	)", path);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int runs = 5;
+	unsigned int shader_model = 50;
+	std::vector<std::filesystem::path> inputs;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (const char *arg = argv[i]; arg[0] == '-')
+		{
+			if (0 == std::strcmp(arg, "-h") || 0 == std::strcmp(arg, "--help"))
+			{
+				print_usage(argv[0]);
+				return 0;
+			}
+			if (0 == std::strcmp(arg, "--version"))
+			{
+				printf("%s\n", VERSION_STRING_PRODUCT);
+				return 0;
+			}
+
+			if (i + 1 >= argc)
+				continue;
+			else if (0 == std::strcmp(arg, "--runs"))
+				runs = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+			else if (0 == std::strcmp(arg, "--shader-model"))
+				shader_model = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else
+		{
+			std::error_code ec;
+			if (std::filesystem::is_directory(arg, ec))
+			{
+				for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator(arg, std::filesystem::directory_options::skip_permission_denied, ec))
+					if (entry.path().extension() == L".fx")
+						inputs.push_back(entry.path());
+			}
+			else
+			{
+				inputs.push_back(arg);
+			}
+		}
+	}
+
+	if (runs == 0)
+		runs = 1;
+
+	int exit_code = 0;
+
+	if (inputs.empty())
+	{
+		// No corpus specified, so fall back to the synthetic one (roughly matching a trivial, an average and a qUINT-sized effect file)
+		if (!benchmark_file("synthetic-small", generate_synthetic_effect(1, 1), {}, runs, shader_model) ||
+			!benchmark_file("synthetic-medium", generate_synthetic_effect(20, 10), {}, runs, shader_model) ||
+			!benchmark_file("synthetic-large", generate_synthetic_effect(150, 50), {}, runs, shader_model))
+			exit_code = 1;
+	}
+	else
+	{
+		for (const std::filesystem::path &input : inputs)
+			if (!benchmark_file(input.filename().u8string().c_str(), std::string(), input, runs, shader_model))
+				exit_code = 1;
+	}
+
+	return exit_code;
+}
@@ -6,13 +6,477 @@
 #include "effect_parser.hpp"
 #include "effect_codegen.hpp"
 #include "effect_preprocessor.hpp"
+#include "effect_serialization.hpp"
+#include "effect_cache.hpp"
 #include "version.h"
+#include <set>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdio> // fwrite
+#include <cstring> // std::strcmp, std::strchr
+#include <charconv> // std::to_chars
+#include <algorithm> // std::max, std::min, std::sort
 #include <fstream>
 #include <iostream>
+#include <filesystem>
+#include <Windows.h>
+#include <d3dcompiler.h>
+
+struct compile_options
+{
+	std::vector<std::pair<std::string, std::string>> macros;
+	std::vector<std::filesystem::path> include_paths;
+	const char *buffer_width = "800";
+	const char *buffer_height = "600";
+	bool debug_info = false;
+	bool invert_y_axis = false;
+	bool performance_mode = false;
+	bool vulkan_semantics = false;
+	unsigned int shader_model = 50;
+
+	// Cache priming options (see 'prime_effect_cache' below)
+	std::filesystem::path cache_path;
+	std::string app_name;
+	unsigned int renderer_id = 0xb000;
+	unsigned int vendor_id = 0;
+	unsigned int device_id = 0;
+	unsigned int color_space = 0;
+	unsigned int color_format = 28;
+	unsigned int color_bit_depth = 8;
+};
+
+static void add_builtin_macros(reshadefx::preprocessor &pp, const compile_options &options)
+{
+	pp.add_macro_definition("__RESHADE__", std::to_string(VERSION_MAJOR * 10000 + VERSION_MINOR * 100 + VERSION_REVISION));
+	pp.add_macro_definition("__RESHADE_PERFORMANCE_MODE__", options.performance_mode ? "1" : "0");
+	pp.add_macro_definition("__VENDOR__", std::to_string(options.vendor_id));
+	pp.add_macro_definition("__DEVICE__", std::to_string(options.device_id));
+	pp.add_macro_definition("__RENDERER__", std::to_string(options.renderer_id));
+	pp.add_macro_definition("__APPLICATION__", std::to_string( // Truncate hash to 32-bit, since lexer currently only supports 32-bit numbers anyway
+		std::hash<std::string>()(options.app_name) & 0xFFFFFFFF));
+	pp.add_macro_definition("BUFFER_WIDTH", options.buffer_width);
+	pp.add_macro_definition("BUFFER_HEIGHT", options.buffer_height);
+	pp.add_macro_definition("BUFFER_RCP_WIDTH", "(1.0 / BUFFER_WIDTH)");
+	pp.add_macro_definition("BUFFER_RCP_HEIGHT", "(1.0 / BUFFER_HEIGHT)");
+	pp.add_macro_definition("BUFFER_COLOR_SPACE", std::to_string(options.color_space));
+	pp.add_macro_definition("BUFFER_COLOR_FORMAT", std::to_string(options.color_format));
+	pp.add_macro_definition("BUFFER_COLOR_BIT_DEPTH", std::to_string(options.color_bit_depth));
+
+	for (const std::pair<std::string, std::string> &macro : options.macros)
+		pp.add_macro_definition(macro.first, macro.second);
+}
+
+static reshadefx::codegen *create_codegen_for_renderer(const compile_options &options)
+{
+	// Mirrors the backend selection in 'runtime::load_effect'
+	unsigned int shader_model;
+	if (options.renderer_id == 0x9000)
+		shader_model = 30; // D3D9
+	else if (options.renderer_id < 0xa100)
+		shader_model = 40; // D3D10 (including feature level 9)
+	else if (options.renderer_id < 0xb000)
+		shader_model = 41; // D3D10.1
+	else if (options.renderer_id < 0xc000)
+		shader_model = 50; // D3D11
+	else
+		shader_model = 51; // D3D12
+
+	if ((options.renderer_id & 0xF0000) == 0)
+		return reshadefx::create_codegen_hlsl(shader_model, options.debug_info, options.performance_mode);
+	else if (options.renderer_id < 0x20000)
+		return reshadefx::create_codegen_glsl(false, options.debug_info, options.performance_mode, false, true);
+	else // Vulkan uses SPIR-V input
+		return reshadefx::create_codegen_spirv(true, options.debug_info, options.performance_mode, false, false);
+}
+
+// Preprocesses and compiles the specified effect file and writes the resulting artifacts to the effect cache in the same format and under the same IDs as 'runtime::save_effect_cache' would.
+// This has to match the behavior of 'runtime::load_effect' exactly, or the runtime will compute different cache IDs and never find the primed entries!
+static bool prime_effect_cache(const std::filesystem::path &source_file, const compile_options &options, std::string &output)
+{
+	// Generate the unique string identifying this effect (see 'runtime::load_effect')
+	std::string attributes;
+	attributes += "app=" + options.app_name + ';';
+	attributes += "width=" + std::string(options.buffer_width) + ';';
+	attributes += "height=" + std::string(options.buffer_height) + ';';
+	attributes += "color_space=" + std::to_string(options.color_space) + ';';
+	attributes += "color_bit_depth=" + std::to_string(options.color_bit_depth) + ';';
+	attributes += "version=" + std::to_string(VERSION_MAJOR * 10000 + VERSION_MINOR * 100 + VERSION_REVISION) + ';';
+	attributes += "performance_mode=" + std::string(options.performance_mode ? "1" : "0") + ';';
+	attributes += "vendor=" + std::to_string(options.vendor_id) + ';';
+	attributes += "device=" + std::to_string(options.device_id) + ';';
+
+	const std::string effect_name = source_file.filename().u8string();
+
+	for (const std::pair<std::string, std::string> &macro : options.macros)
+		attributes += macro.first + '=' + macro.second + ';';
+
+	std::error_code ec;
+	std::set<std::filesystem::path> include_paths;
+	if (source_file.is_absolute())
+		include_paths.emplace(source_file.parent_path());
+	for (std::filesystem::path include_path : options.include_paths)
+	{
+		const bool recursive_search = include_path.filename() == L"**";
+		if (recursive_search)
+			include_path.remove_filename();
+
+		if (include_path.is_relative())
+			include_path = std::filesystem::absolute(include_path, ec);
+		if (std::filesystem::path canonical_path = std::filesystem::canonical(include_path, ec); !ec)
+			include_path = std::move(canonical_path);
+		else
+			continue; // The canonicalization step fails if the path does not exist
+
+		include_paths.emplace(include_path);
+
+		if (recursive_search)
+		{
+			for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator(include_path, std::filesystem::directory_options::skip_permission_denied, ec))
+				if (entry.is_directory(ec))
+					include_paths.emplace(entry);
+		}
+	}
+
+	attributes += effect_name;
+	attributes += '?';
+	attributes += std::to_string(std::filesystem::last_write_time(source_file, ec).time_since_epoch().count());
+	attributes += ';';
+
+	// The actual included files are not known at this point, so detect changes to any ".fxh" files in the search paths
+	for (const std::filesystem::path &include_path : include_paths)
+	{
+		for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(include_path, std::filesystem::directory_options::skip_permission_denied, ec))
+		{
+			if (entry.path().extension() == L".fxh")
+			{
+				attributes += entry.path().filename().u8string();
+				attributes += '?';
+				attributes += std::to_string(entry.last_write_time(ec).time_since_epoch().count());
+				attributes += ';';
+			}
+		}
+	}
+
+	const size_t source_hash = std::hash<std::string>()(attributes);
+
+	reshadefx::preprocessor pp;
+	add_builtin_macros(pp, options);
+
+	for (const std::filesystem::path &include_path : include_paths)
+		pp.add_include_path(include_path);
+
+	// Add some conversion macros for compatibility with older versions of ReShade
+	pp.append_string(
+		"#define tex2Doffset(s, coords, offset) tex2D(s, coords, offset)\n"
+		"#define tex2Dlodoffset(s, coords, offset) tex2Dlod(s, coords, offset)\n"
+		"#define tex2Dgather(s, t, c) tex2Dgather##c(s, t)\n"
+		"#define tex2Dgatheroffset(s, t, o, c) tex2Dgather##c(s, t, o)\n"
+		"#define tex2Dgather0 tex2DgatherR\n"
+		"#define tex2Dgather1 tex2DgatherG\n"
+		"#define tex2Dgather2 tex2DgatherB\n"
+		"#define tex2Dgather3 tex2DgatherA\n");
+
+	if (!pp.append_file(source_file))
+	{
+		output += pp.errors();
+		return false;
+	}
+
+	output += pp.errors(); // There may be warnings
+
+	std::string source = pp.output();
+	std::string code_preamble;
+	bool skip_optimization = false;
+
+	for (const std::pair<std::string, std::string> &pragma : pp.used_pragma_directives())
+	{
+		if (pragma.first == "reshade")
+		{
+			if (pragma.second == "skipoptimization" || pragma.second == "nooptimization")
+				skip_optimization = true;
+			continue;
+		}
+
+		const std::string pragma_directive = "#pragma " + pragma.first + ' ' + pragma.second + '\n';
+
+		code_preamble += pragma_directive;
+		source = "// " + pragma_directive + source;
+	}
+
+	// Write used preprocessor definitions to the cached source (see 'runtime::load_effect')
+	for (const std::pair<std::string, std::string> &definition : pp.used_macro_definitions())
+	{
+		if (definition.first.size() < 8 ||
+			definition.first[0] == '_' ||
+			definition.first.compare(0, 7, "BUFFER_") == 0 ||
+			definition.first.compare(0, 8, "RESHADE_") == 0 ||
+			definition.first.find("INCLUDE_") != std::string::npos)
+			continue;
+
+		source = "// " + definition.first + '=' + definition.second + '\n' + source;
+	}
+
+	// Write queried definition names to the cached source as well
+	std::vector<std::string> used_definitions = pp.used_macro_names();
+	std::sort(used_definitions.begin(), used_definitions.end());
+	for (const std::string &used_definition : used_definitions)
+		source = "// ?" + used_definition + '\n' + source;
+
+	// The runtime does not cache effects using special pragma directives either, to ensure they are read again next time
+	if (skip_optimization)
+	{
+		output += "warning: " + effect_name + ": uses '#pragma reshade skipoptimization' and cannot be cached\n";
+		return true;
+	}
+
+	reshade::effect_cache::save(options.cache_path, source_file.stem().u8string() + '-' + std::to_string(options.renderer_id) + '-' + std::to_string(source_hash), "i", source);
+
+	std::unique_ptr<reshadefx::codegen> codegen(create_codegen_for_renderer(options));
+
+	reshadefx::parser parser;
+	if (!parser.parse(std::move(source), codegen.get()))
+	{
+		output += parser.errors();
+		return false;
+	}
+
+	output += parser.errors();
+
+	const reshadefx::effect_module module = codegen->module();
+	std::string generated_code;
+	if (options.renderer_id < 0x20000) // Vulkan does not need the combined code (see 'runtime::load_effect')
+		generated_code = codegen->finalize_code();
+
+	std::unordered_map<std::string, std::string> entry_point_code;
+	entry_point_code.reserve(module.entry_points.size());
+	for (const std::pair<std::string, reshadefx::shader_type> &entry_point : module.entry_points)
+		entry_point_code[entry_point.first] = codegen->finalize_code_for_entry_point(entry_point.first);
+
+	// The serialized module additionally depends on the code generation options, so include them in the cache ID alongside the source hash (see 'runtime::load_effect')
+	const std::string module_cache_id =
+		source_file.stem().u8string() + '-' + std::to_string(options.renderer_id) + '-' +
+		std::to_string((options.performance_mode ? 1u : 0u) | (options.debug_info ? 0u : 2u)) + '-' + std::to_string(source_hash);
+
+	std::string module_data;
+	reshadefx::serialize_effect_module(module, generated_code, entry_point_code, module_data);
+	reshade::effect_cache::save(options.cache_path, module_cache_id, "mod", module_data);
+
+	// D3D runtimes additionally cache the compiled shader modules, so prime those with D3DCompiler as well
+	if ((options.renderer_id & 0xF0000) != 0)
+		return true;
+
+	static const HMODULE d3d_compiler_module = LoadLibraryW(L"d3dcompiler_47.dll");
+	if (d3d_compiler_module == nullptr)
+	{
+		output += "warning: failed to load d3dcompiler_47.dll, skipping shader module cache entries\n";
+		return true;
+	}
+
+	const auto D3DCompile = reinterpret_cast<pD3DCompile>(GetProcAddress(d3d_compiler_module, "D3DCompile"));
+	const auto D3DDisassemble = reinterpret_cast<pD3DDisassemble>(GetProcAddress(d3d_compiler_module, "D3DDisassemble"));
+
+	// Fill specialization constants with their initializer values, which is what the runtime does when the preset does not override them (see 'runtime::load_effect')
+	if (options.performance_mode)
+	{
+		for (reshadefx::uniform constant : module.spec_constants)
+		{
+			// Check if this is a split specialization constant and move data accordingly
+			if (constant.type.is_scalar() && constant.offset != 0)
+				constant.initializer_value.as_uint[0] = constant.initializer_value.as_uint[constant.offset];
+
+			code_preamble += "#define SPEC_CONSTANT_" + constant.name + ' ';
+
+			for (unsigned int i = 0; i < constant.type.components(); ++i)
+			{
+				switch (constant.type.base)
+				{
+				case reshadefx::type::t_bool:
+					code_preamble += constant.initializer_value.as_uint[i] ? "true" : "false";
+					break;
+				case reshadefx::type::t_int:
+					code_preamble += std::to_string(constant.initializer_value.as_int[i]);
+					break;
+				case reshadefx::type::t_uint:
+					code_preamble += std::to_string(constant.initializer_value.as_uint[i]);
+					break;
+				case reshadefx::type::t_float:
+					char temp[64];
+					const std::to_chars_result res = std::to_chars(temp, temp + sizeof(temp), constant.initializer_value.as_float[i], std::chars_format::scientific, 8);
+					if (res.ec == std::errc())
+						code_preamble.append(temp, res.ptr);
+					break;
+				}
+
+				if (i + 1 < constant.type.components())
+					code_preamble += ", ";
+			}
+
+			code_preamble += '\n';
+		}
+	}
+
+	bool success = true;
+
+	for (const std::pair<std::string, reshadefx::shader_type> &entry_point : module.entry_points)
+	{
+		// Compute shaders are not supported in D3D9/D3D10, so the runtime never compiles these entry points there
+		if (entry_point.second == reshadefx::shader_type::compute && options.renderer_id < 0xb000)
+			continue;
+
+		// Assemble the HLSL exactly like 'runtime::compile_effect_entry_point' does
+		std::string hlsl = code_preamble;
+
+		if (options.renderer_id == 0x9000)
+		{
+			// Create SEMANTIC_PIXEL_SIZE constants
+			hlsl += "#define COLOR_PIXEL_SIZE 1.0 / " + std::string(options.buffer_width) + ", 1.0 / " + std::string(options.buffer_height) + '\n';
+
+			uint32_t semantic_index = 0;
+			for (const reshadefx::texture &tex : module.textures)
+			{
+				if (tex.semantic.empty() || tex.semantic == "COLOR")
+					continue;
+
+				semantic_index++;
+
+				// Avoid duplicate declarations if the semantic was used multiple times
+				if (hlsl.find(tex.semantic + "_PIXEL_SIZE") == std::string::npos)
+					hlsl += "uniform float2 " + tex.semantic + "_PIXEL_SIZE : register(c" + std::to_string(255 - semantic_index) + ");\n";
+			}
+		}
+
+		hlsl += "#line 1\n"; // Reset line number, so it matches what is shown when viewing the generated code
+		hlsl += entry_point_code[entry_point.first];
+
+		std::string profile;
+		switch (entry_point.second)
+		{
+		case reshadefx::shader_type::vertex:
+			profile = "vs";
+			break;
+		case reshadefx::shader_type::pixel:
+			profile = "ps";
+			break;
+		case reshadefx::shader_type::compute:
+			profile = "cs";
+			break;
+		}
+
+		switch (options.renderer_id)
+		{
+		default:
+		case D3D_FEATURE_LEVEL_11_0:
+			profile += "_5_0";
+			break;
+		case D3D_FEATURE_LEVEL_10_1:
+			profile += "_4_1";
+			break;
+		case D3D_FEATURE_LEVEL_10_0:
+			profile += "_4_0";
+			break;
+		case D3D_FEATURE_LEVEL_9_1:
+		case D3D_FEATURE_LEVEL_9_2:
+			profile += "_4_0_level_9_1";
+			break;
+		case D3D_FEATURE_LEVEL_9_3:
+			profile += "_4_0_level_9_3";
+			break;
+		case 0x9000:
+			profile += "_3_0";
+			break;
+		}
+
+		UINT compile_flags = 0;
+		if (options.performance_mode)
+			compile_flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
+		if (options.renderer_id >= D3D_FEATURE_LEVEL_10_0)
+			compile_flags |= D3DCOMPILE_ENABLE_STRICTNESS;
+#ifndef NDEBUG
+		compile_flags |= D3DCOMPILE_DEBUG;
+#endif
+
+		std::string hlsl_attributes;
+		hlsl_attributes += "entrypoint=" + entry_point.first + ';';
+		hlsl_attributes += "profile=" + profile + ';';
+		hlsl_attributes += "flags=" + std::to_string(compile_flags) + ';';
+
+		const std::string cache_id =
+			source_file.stem().u8string() + '-' + entry_point.first + '-' + std::to_string(options.renderer_id) + '-' +
+			std::to_string(std::hash<std::string_view>()(hlsl_attributes) ^ std::hash<std::string_view>()(hlsl));
+
+		ID3DBlob *d3d_compiled = nullptr, *d3d_errors = nullptr;
+		const HRESULT hr = D3DCompile(
+			hlsl.data(), hlsl.size(),
+			nullptr, nullptr, nullptr,
+			entry_point.first.c_str(),
+			profile.c_str(),
+			compile_flags, 0,
+			&d3d_compiled, &d3d_errors);
+
+		if (d3d_errors != nullptr)
+		{
+			output.append(static_cast<const char *>(d3d_errors->GetBufferPointer()), d3d_errors->GetBufferSize() - 1); // Subtracting one to not append the null-terminator as well
+			d3d_errors->Release();
+		}
+
+		if (FAILED(hr))
+		{
+			output += "error: " + entry_point.first + ": failed to compile entry point\n";
+			success = false;
+			continue;
+		}
+
+		const std::string cso(static_cast<const char *>(d3d_compiled->GetBufferPointer()), d3d_compiled->GetBufferSize());
+		d3d_compiled->Release();
+
+		reshade::effect_cache::save(options.cache_path, cache_id, "cso", cso);
+
+		std::string cso_text;
+		if (ID3DBlob *d3d_disassembled = nullptr;
+			D3DDisassemble != nullptr && SUCCEEDED(D3DDisassemble(cso.data(), cso.size(), 0, nullptr, &d3d_disassembled)))
+		{
+			cso_text.assign(static_cast<const char *>(d3d_disassembled->GetBufferPointer()), d3d_disassembled->GetBufferSize() - 1);
+			d3d_disassembled->Release();
+		}
+
+		reshade::effect_cache::save(options.cache_path, cache_id, "asm", cso_text);
+	}
+
+	return success;
+}
+
+// Compiles the specified effect file without writing any output, to validate that it builds
+static bool check_effect(const std::filesystem::path &source_file, const compile_options &options, std::string &output)
+{
+	reshadefx::preprocessor pp;
+	add_builtin_macros(pp, options);
+
+	for (const std::filesystem::path &include_path : options.include_paths)
+		pp.add_include_path(include_path);
+
+	if (!pp.append_file(source_file))
+	{
+		output += pp.errors();
+		return false;
+	}
+
+	std::unique_ptr<reshadefx::codegen> codegen(create_codegen_for_renderer(options));
+
+	reshadefx::parser parser;
+	if (!parser.parse(pp.output(), codegen.get()))
+	{
+		output += pp.errors() + parser.errors();
+		return false;
+	}
+
+	output += pp.errors() + parser.errors();
+	return true;
+}
 
 static void print_usage(const char *path)
 {
-	printf(R"(usage: %s [options] <filename>
+	printf(R"(usage: %s [options] <filename or directory or @<response file>> ...
 
 Options:
   -h, --help                Print this help.
@@ -36,28 +500,37 @@ Options:
   --vulkan-semantics        Generate GLSL/SPIR-V code under Vulkan semantics, instead of OpenGL semantics.
 
   -Zi                       Enable debug information.
+
+Batch mode (enabled when multiple inputs, a directory or a response file is specified):
+  --threads <value>         Number of effect files to compile in parallel (defaults to the number of processors).
+
+Cache priming (writes entries to the effect cache used by the ReShade runtime):
+  --cache <path>            Directory of the effect cache to write entries to.
+  --app <name>              Name of the application executable (without extension) the cache is primed for.
+  --renderer <value>        Renderer ID the runtime will report (e.g. 0x9000 for D3D9, 0xb000 for D3D11, 0x20000 for Vulkan).
+  --vendor <value>          GPU vendor ID of the target machine.
+  --device <value>          GPU device ID of the target machine.
+  --color-space <value>     Color space value the runtime will report for the swapchain.
+  --color-format <value>    Value of the 'BUFFER_COLOR_FORMAT' preprocessor macro.
+  --color-bit-depth <value> Bit depth of the swapchain color format (must match '--color-format').
+  --performance-mode        Prime the cache for a runtime running in performance mode.
+
+  All values above, the dimensions and the preprocessor macros (in the order the
+  runtime would define them) have to match the target machine, since they are part
+  of the cache entry IDs the runtime computes.
 	)", path);
 }
 
 int main(int argc, char *argv[])
 {
-	const char *filename = nullptr;
 	const char *preprocess = nullptr;
 	const char *errorfile = nullptr;
 	const char *objectfile = nullptr;
-	const char *buffer_width = "800";
-	const char *buffer_height = "600";
 	bool print_glsl = false;
 	bool print_hlsl = false;
-	bool debug_info = false;
-	bool invert_y_axis = false;
-	bool spec_constants = false;
-	bool vulkan_semantics = false;
-	unsigned int shader_model = 50;
-
-	reshadefx::preprocessor pp;
-	pp.add_macro_definition("__RESHADE__", std::to_string(VERSION_MAJOR * 10000 + VERSION_MINOR * 100 + VERSION_REVISION));
-	pp.add_macro_definition("__RESHADE_PERFORMANCE_MODE__", "0");
+	unsigned int num_threads = 0;
+	compile_options options;
+	std::vector<std::filesystem::path> inputs;
 
 	// Parse command-line arguments
 	for (int i = 1; i < argc; ++i)
@@ -80,28 +553,28 @@ int main(int argc, char *argv[])
 				char *macro = argv[++i];
 				char *value = std::strchr(macro, '=');
 				if (value) *value++ = '\0';
-				pp.add_macro_definition(macro, value ? value : "1");
+				options.macros.emplace_back(macro, value ? value : "1");
 				continue;
 			}
 
 			if (0 == std::strcmp(arg, "-I"))
 			{
-				pp.add_include_path(argv[++i]);
+				options.include_paths.push_back(argv[++i]);
 				continue;
 			}
 
 			if (0 == std::strcmp(arg, "-Zi"))
-				debug_info = true;
+				options.debug_info = true;
 			else if (0 == std::strcmp(arg, "--glsl"))
 				print_glsl = true;
 			else if (0 == std::strcmp(arg, "--hlsl"))
 				print_hlsl = true;
 			else if (0 == std::strcmp(arg, "--invert-y"))
-				invert_y_axis = true;
-			else if (0 == std::strcmp(arg, "--spec-constants"))
-				spec_constants = true;
+				options.invert_y_axis = true;
+			else if (0 == std::strcmp(arg, "--spec-constants") || 0 == std::strcmp(arg, "--performance-mode"))
+				options.performance_mode = true;
 			else if (0 == std::strcmp(arg, "--vulkan-semantics"))
-				vulkan_semantics = true;
+				options.vulkan_semantics = true;
 
 			if (i + 1 >= argc)
 				continue;
@@ -112,36 +585,121 @@ int main(int argc, char *argv[])
 			else if (0 == std::strcmp(arg, "-Fo"))
 				objectfile = argv[++i];
 			else if (0 == std::strcmp(arg, "--shader-model"))
-				shader_model = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+				options.shader_model = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
 			else if (0 == std::strcmp(arg, "--width"))
-				buffer_width = argv[++i];
+				options.buffer_width = argv[++i];
 			else if (0 == std::strcmp(arg, "--height"))
-				buffer_height = argv[++i];
+				options.buffer_height = argv[++i];
+			else if (0 == std::strcmp(arg, "--threads"))
+				num_threads = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+			else if (0 == std::strcmp(arg, "--cache"))
+				options.cache_path = argv[++i];
+			else if (0 == std::strcmp(arg, "--app"))
+				options.app_name = argv[++i];
+			else if (0 == std::strcmp(arg, "--renderer"))
+				options.renderer_id = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 0));
+			else if (0 == std::strcmp(arg, "--vendor"))
+				options.vendor_id = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 0));
+			else if (0 == std::strcmp(arg, "--device"))
+				options.device_id = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 0));
+			else if (0 == std::strcmp(arg, "--color-space"))
+				options.color_space = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 0));
+			else if (0 == std::strcmp(arg, "--color-format"))
+				options.color_format = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 0));
+			else if (0 == std::strcmp(arg, "--color-bit-depth"))
+				options.color_bit_depth = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 0));
 		}
-		else
+		else if (arg[0] == '@')
 		{
-			if (filename != nullptr)
+			// Read input file names from a response file (one per line)
+			std::ifstream response_file(arg + 1);
+			if (!response_file)
 			{
-				std::cout << "error: More than one input file specified" << std::endl;
+				std::cout << "error: Failed to open response file '" << (arg + 1) << "'" << std::endl;
 				return 1;
 			}
 
-			filename = arg;
+			for (std::string line; std::getline(response_file, line);)
+				if (!line.empty() && line[0] != '#')
+					inputs.push_back(std::filesystem::u8path(line));
+		}
+		else
+		{
+			std::error_code ec;
+			if (std::filesystem::is_directory(arg, ec))
+			{
+				for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator(arg, std::filesystem::directory_options::skip_permission_denied, ec))
+					if (entry.path().extension() == L".fx")
+						inputs.push_back(entry.path());
+			}
+			else
+			{
+				inputs.push_back(std::filesystem::u8path(arg));
+			}
 		}
 	}
 
-	if (filename == nullptr)
+	if (inputs.empty())
 	{
 		print_usage(argv[0]);
 		return 1;
 	}
 
-	pp.add_macro_definition("BUFFER_WIDTH", buffer_width);
-	pp.add_macro_definition("BUFFER_HEIGHT", buffer_height);
-	pp.add_macro_definition("BUFFER_RCP_WIDTH", "(1.0 / BUFFER_WIDTH)");
-	pp.add_macro_definition("BUFFER_RCP_HEIGHT", "(1.0 / BUFFER_HEIGHT)");
+	// Compile multiple input files (and optionally prime the effect cache) across a thread pool
+	if (inputs.size() > 1 || !options.cache_path.empty())
+	{
+		// Cache entry IDs are computed from absolute source paths, so resolve them up front
+		std::error_code ec;
+		for (std::filesystem::path &input : inputs)
+			if (std::filesystem::path absolute_path = std::filesystem::absolute(input, ec); !ec)
+				input = std::move(absolute_path);
+
+		if (!options.cache_path.empty())
+			std::filesystem::create_directories(options.cache_path, ec);
+
+		if (num_threads == 0)
+			num_threads = std::thread::hardware_concurrency();
+		num_threads = std::max(1u, std::min(num_threads, static_cast<unsigned int>(inputs.size())));
+
+		std::atomic<size_t> next_input = { 0 };
+		std::atomic<int> exit_code = { 0 };
+
+		const auto worker = [&]() {
+			for (size_t input_index; (input_index = next_input.fetch_add(1)) < inputs.size();)
+			{
+				const std::filesystem::path &input = inputs[input_index];
+
+				std::string output = input.filename().u8string() + ":\n";
+				const bool success = options.cache_path.empty() ?
+					check_effect(input, options, output) :
+					prime_effect_cache(input, options, output);
+				output += success ? "  succeeded\n" : "  failed\n";
+
+				// Write the entire output with a single call, so it is not interleaved with that of other worker threads
+				fwrite(output.data(), 1, output.size(), stdout);
+
+				if (!success)
+					exit_code = 1;
+			}
+		};
+
+		std::vector<std::thread> worker_threads;
+		worker_threads.reserve(num_threads);
+		for (unsigned int thread_index = 0; thread_index < num_threads; ++thread_index)
+			worker_threads.emplace_back(worker);
+		for (std::thread &thread : worker_threads)
+			thread.join();
+
+		return exit_code;
+	}
+
+	reshadefx::preprocessor pp;
+	add_builtin_macros(pp, options);
+
+	for (const std::filesystem::path &include_path : options.include_paths)
+		pp.add_include_path(include_path);
 
-	if (!pp.append_file(filename))
+	if (!pp.append_file(inputs[0]))
 	{
 		if (errorfile == nullptr)
 			std::cout << pp.errors() << std::endl;
@@ -161,11 +719,11 @@ int main(int argc, char *argv[])
 
 	std::unique_ptr<reshadefx::codegen> backend;
 	if (print_glsl)
-		backend.reset(reshadefx::create_codegen_glsl(vulkan_semantics, debug_info, spec_constants, invert_y_axis));
+		backend.reset(reshadefx::create_codegen_glsl(options.vulkan_semantics, options.debug_info, options.performance_mode, options.invert_y_axis));
 	else if (print_hlsl)
-		backend.reset(reshadefx::create_codegen_hlsl(shader_model, debug_info, spec_constants));
+		backend.reset(reshadefx::create_codegen_hlsl(options.shader_model, options.debug_info, options.performance_mode));
 	else
-		backend.reset(reshadefx::create_codegen_spirv(vulkan_semantics, debug_info, spec_constants, invert_y_axis));
+		backend.reset(reshadefx::create_codegen_spirv(options.vulkan_semantics, options.debug_info, options.performance_mode, options.invert_y_axis));
 
 	reshadefx::parser parser;
 	if (!parser.parse(pp.output(), backend.get()))
@@ -4,10 +4,13 @@
  */
 
 #include <stdio.h>
+#include <vector>
 #include <Windows.h>
 #include <sddl.h>
 #include <AclAPI.h>
 #include <TlHelp32.h>
+#include <evntrace.h>
+#include <evntcons.h>
 
 #define RESHADE_LOADING_THREAD_FUNC 1
 
@@ -92,41 +95,15 @@ static DWORD WINAPI loading_thread_func(loading_data *arg)
 }
 #endif
 
-int wmain(int argc, wchar_t *argv[])
-{
-	if (argc != 2)
-	{
-		wprintf(L"usage: %s <exe name>\n", argv[0]);
-		return 0;
-	}
-
-	wprintf(L"Waiting for a '%s' process to spawn ...\n", argv[1]);
-
-	DWORD pid = 0;
-
-	// Wait for a process with the target name to spawn
-	while (!pid)
-	{
-		const scoped_handle snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-
-		PROCESSENTRY32W process = { sizeof(process) };
-		for (BOOL next = Process32FirstW(snapshot, &process); next; next = Process32NextW(snapshot, &process))
-		{
-			if (wcscmp(process.szExeFile, argv[1]) == 0)
-			{
-				pid = process.th32ProcessID;
-				break;
-			}
-		}
-
-		Sleep(1); // Sleep a bit to not overburden the CPU
-	}
-
-	wprintf(L"Found a matching process with PID %lu! Injecting ReShade ... ", pid);
-
-	// Wait just a little bit for the application to initialize
-	Sleep(50);
+static int s_target_count = 0;
+static wchar_t **s_target_names = nullptr;
+static bool s_single_target = false;
+static bool s_finished = false;
+static DWORD s_exit_code = ERROR_SUCCESS;
+static std::vector<DWORD> s_handled_pids;
 
+static DWORD inject_into_process(DWORD pid)
+{
 	// Open target application process
 	const scoped_handle remote_process = OpenProcess(PROCESS_CREATE_THREAD | PROCESS_VM_OPERATION | PROCESS_VM_READ | PROCESS_VM_WRITE | PROCESS_QUERY_INFORMATION, FALSE, pid);
 	if (remote_process == nullptr)
@@ -225,3 +202,182 @@ int wmain(int argc, wchar_t *argv[])
 #endif
 	}
 }
+
+static void check_process(DWORD pid, const WCHAR *exe_file)
+{
+	if (s_finished)
+		return;
+
+	bool is_target = false;
+	for (int i = 0; i < s_target_count && !is_target; ++i)
+		is_target = _wcsicmp(exe_file, s_target_names[i]) == 0;
+	if (!is_target)
+		return;
+
+	// Only attempt to inject into each process once
+	for (const DWORD handled_pid : s_handled_pids)
+		if (handled_pid == pid)
+			return;
+	s_handled_pids.push_back(pid);
+
+	wprintf(L"Found a matching '%s' process with PID %lu! Injecting ReShade ... ", exe_file, pid);
+
+	// Wait just a little bit for the application to initialize
+	Sleep(50);
+
+	const DWORD exit_code = inject_into_process(pid);
+
+	// Keep running and waiting for more processes when multiple targets were specified
+	if (s_single_target)
+	{
+		s_exit_code = exit_code;
+		s_finished = true;
+	}
+}
+
+static void check_existing_processes()
+{
+	const scoped_handle snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+
+	PROCESSENTRY32W process = { sizeof(process) };
+	for (BOOL next = Process32FirstW(snapshot, &process); next && !s_finished; next = Process32NextW(snapshot, &process))
+		check_process(process.th32ProcessID, process.szExeFile);
+}
+
+// Name of the real-time trace session used to receive process creation events
+static const WCHAR s_trace_session_name[] = L"ReShade Injector";
+
+struct trace_session_properties
+{
+	EVENT_TRACE_PROPERTIES props;
+	// Session properties have to be followed by space for the session name, which is copied there by the trace APIs
+	WCHAR session_name[ARRAYSIZE(s_trace_session_name)];
+};
+
+static void CALLBACK process_event_record_callback(EVENT_RECORD *record)
+{
+	// Only handle process start events (ID 1), which carry the ID of the new process as their first field
+	if (record->EventHeader.EventDescriptor.Id != 1 || record->UserDataLength < sizeof(ULONG))
+		return;
+
+	const DWORD pid = *static_cast<const ULONG *>(record->UserData);
+
+	// Resolve the executable name of the new process
+	WCHAR image_path[MAX_PATH];
+	DWORD image_path_size = ARRAYSIZE(image_path);
+	if (const scoped_handle process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+		process == nullptr || !QueryFullProcessImageNameW(process, 0, image_path, &image_path_size))
+		return;
+
+	const WCHAR *exe_file = wcsrchr(image_path, L'\\');
+	exe_file = (exe_file != nullptr) ? exe_file + 1 : image_path;
+
+	check_process(pid, exe_file);
+
+	if (s_finished)
+	{
+		// Stop the trace session, which causes 'ProcessTrace' below to return
+		trace_session_properties stop_properties = {};
+		stop_properties.props.Wnode.BufferSize = sizeof(stop_properties);
+		stop_properties.props.LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+		ControlTraceW(0, s_trace_session_name, &stop_properties.props, EVENT_TRACE_CONTROL_STOP);
+	}
+}
+
+static bool wait_for_processes_event_driven()
+{
+	// GUID of the 'Microsoft-Windows-Kernel-Process' event provider
+	static const GUID process_provider_guid = { 0x22fb2cd6, 0x0e7b, 0x422b, { 0xa0, 0xc7, 0x2f, 0xad, 0x1f, 0xd0, 0xe7, 0x16 } };
+
+	trace_session_properties session_properties = {};
+	session_properties.props.Wnode.BufferSize = sizeof(session_properties);
+	session_properties.props.Wnode.ClientContext = 1; // Use query performance counter time stamps
+	session_properties.props.Wnode.Flags = WNODE_FLAG_TRACED_GUID;
+	session_properties.props.LogFileMode = EVENT_TRACE_REAL_TIME_MODE;
+	session_properties.props.LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+
+	TRACEHANDLE session = 0;
+	ULONG result = StartTraceW(&session, s_trace_session_name, &session_properties.props);
+	if (result == ERROR_ALREADY_EXISTS)
+	{
+		// Stop a stale session left behind by a previous instance and try again
+		ControlTraceW(0, s_trace_session_name, &session_properties.props, EVENT_TRACE_CONTROL_STOP);
+		result = StartTraceW(&session, s_trace_session_name, &session_properties.props);
+	}
+	if (result != ERROR_SUCCESS)
+		return false; // This usually means the current process lacks administrative privileges
+
+	// Subscribe to process events from the kernel process provider
+	if (EnableTraceEx2(session, &process_provider_guid, EVENT_CONTROL_CODE_ENABLE_PROVIDER, TRACE_LEVEL_INFORMATION, 0x10 /* WINEVENT_KEYWORD_PROCESS */, 0, 0, nullptr) != ERROR_SUCCESS)
+	{
+		ControlTraceW(session, nullptr, &session_properties.props, EVENT_TRACE_CONTROL_STOP);
+		return false;
+	}
+
+	EVENT_TRACE_LOGFILEW logfile = {};
+	logfile.LoggerName = const_cast<LPWSTR>(s_trace_session_name);
+	logfile.ProcessTraceMode = PROCESS_TRACE_MODE_REAL_TIME | PROCESS_TRACE_MODE_EVENT_RECORD;
+	logfile.EventRecordCallback = process_event_record_callback;
+
+	TRACEHANDLE trace = OpenTraceW(&logfile);
+	if (trace == INVALID_PROCESSTRACE_HANDLE)
+	{
+		ControlTraceW(session, nullptr, &session_properties.props, EVENT_TRACE_CONTROL_STOP);
+		return false;
+	}
+
+	// Check processes that spawned between the snapshot in 'wmain' and the session starting to deliver events
+	check_existing_processes();
+
+	// This blocks and dispatches process creation events to the callback above until the session is stopped
+	ProcessTrace(&trace, 1, nullptr, nullptr);
+
+	CloseTrace(trace);
+	ControlTraceW(session, nullptr, &session_properties.props, EVENT_TRACE_CONTROL_STOP);
+
+	return true;
+}
+
+static void wait_for_processes_polling()
+{
+	while (!s_finished)
+	{
+		check_existing_processes();
+
+		Sleep(1); // Sleep a bit to not overburden the CPU
+	}
+}
+
+int wmain(int argc, wchar_t *argv[])
+{
+	if (argc < 2)
+	{
+		wprintf(L"usage: %s <exe name> [<exe name> ...]\n", argv[0]);
+		return 0;
+	}
+
+	s_target_count = argc - 1;
+	s_target_names = argv + 1;
+	// With a single target the injector exits after the first injection, with multiple targets it keeps running and injects into every matching process as it appears
+	s_single_target = (s_target_count == 1);
+
+	if (s_single_target)
+		wprintf(L"Waiting for a '%s' process to spawn ...\n", argv[1]);
+	else
+		wprintf(L"Waiting for any of the %d target processes to spawn ... Press Ctrl+C to stop.\n", s_target_count);
+
+	// Check processes that already exist before subscribing to process creation events
+	check_existing_processes();
+
+	if (!s_finished)
+	{
+		// Prefer waiting on process creation events over polling the process list, since that neither burns CPU nor misses processes that exit quickly (e.g. launchers spawning the actual game)
+		if (!wait_for_processes_event_driven())
+		{
+			wprintf(L"Process creation events are unavailable (this usually requires administrative privileges), falling back to polling ...\n");
+			wait_for_processes_polling();
+		}
+	}
+
+	return s_exit_code;
+}